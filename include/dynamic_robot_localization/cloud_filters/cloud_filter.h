@@ -11,6 +11,7 @@
 // std includes
 #include <memory>
 #include <string>
+#include <vector>
 
 // ROS includes
 #include <ros/ros.h>
@@ -19,7 +20,10 @@
 // PCL includes
 #include <pcl/point_cloud.h>
 #include <pcl/point_types.h>
+#include <pcl/common/io.h>
 #include <pcl/filters/filter.h>
+#include <pcl/filters/filter_indices.h>
+#include <pcl/search/kdtree.h>
 #include <pcl_conversions/pcl_conversions.h>
 
 // project includes
@@ -52,27 +56,41 @@ class CloudFilter : public ConfigurableObject {
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <CloudFilter-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 		virtual void setupConfigurationFromParameterServer(ros::NodeHandlePtr& node_handle, ros::NodeHandlePtr& private_node_handle, const std::string& configuration_namespace);
 		virtual void filter(const typename pcl::PointCloud<PointT>::Ptr& input_cloud, typename pcl::PointCloud<PointT>::Ptr& output_cloud);
+
+		/*! True for filters that only select points from the input cloud (they can be chained with filterIndices without copying the points). */
+		virtual bool isSelectionFilter() { return false; }
+
+		/*! Selects the points of input_indices that pass the filter (by default uses the pcl::FilterIndices interface of the filter). */
+		virtual void filterIndices(const typename pcl::PointCloud<PointT>::Ptr& input_cloud, const pcl::IndicesPtr& input_indices, std::vector<int>& output_indices);
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </CloudFilter-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <gets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 		typename pcl::Filter<PointT>::Ptr getFilter() { return filter_; }
 		typename CloudPublisher<PointT>::Ptr getCloudPublisher() { return cloud_publisher_; }
 		laserscan_to_pointcloud::TFCollector* getTfCollector() { return tf_collector_; }
+		typename pcl::search::KdTree<PointT>::Ptr getSearchMethod() { return search_method_; }
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </gets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <sets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 		void setFilter(typename pcl::Filter<PointT>::Ptr& filter) { filter_ = filter; }
 		void setCloudPublisher(typename CloudPublisher<PointT>::Ptr& cloud_publisher) { cloud_publisher_ = cloud_publisher; }
-		void setTfCollector(laserscan_to_pointcloud::TFCollector* tf_collector) { tf_collector_ = tf_collector; }
+		virtual void setTfCollector(laserscan_to_pointcloud::TFCollector* tf_collector) { tf_collector_ = tf_collector; }
+		/*! Search method already built for the cloud that will be filtered (allows filters that search neighbors to avoid rebuilding the k-d tree). */
+		void setSearchMethod(const typename pcl::search::KdTree<PointT>::Ptr& search_method) { search_method_ = search_method; }
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </sets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 	// ========================================================================   </public-section>  ===========================================================================
 
 	// ========================================================================   <protected-section>   ========================================================================
 	protected:
+		void publishFilteredIndices(const typename pcl::PointCloud<PointT>::Ptr& input_cloud, const std::vector<int>& output_indices);
+		/*! Returns search_method_ if it was built for input_cloud, or a new k-d tree otherwise. */
+		typename pcl::search::KdTree<PointT>::Ptr getSearchMethodForCloud(const typename pcl::PointCloud<PointT>::Ptr& input_cloud);
+
 		std::string filter_name_;
 		typename pcl::Filter<PointT>::Ptr filter_;
 		typename CloudPublisher<PointT>::Ptr cloud_publisher_;
 		laserscan_to_pointcloud::TFCollector* tf_collector_;
+		typename pcl::search::KdTree<PointT>::Ptr search_method_;
 	// ========================================================================   </protected-section>  ========================================================================
 };
 
@@ -0,0 +1,94 @@
+#pragma once
+
+/**\file cloud_filter_chain.h
+ * \brief Applies a sequence of cloud filters composing the indices of the selection filters and materializing point clouds from a pool
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>  <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// std includes
+#include <memory>
+#include <string>
+#include <vector>
+
+// ROS includes
+#include <ros/ros.h>
+
+// PCL includes
+#include <pcl/common/io.h>
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+
+// project includes
+#include <dynamic_robot_localization/cloud_filters/cloud_filter.h>
+#include <dynamic_robot_localization/common/memory_usage.h>
+#include <dynamic_robot_localization/common/tracer.h>
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+namespace dynamic_robot_localization {
+// ###########################################################################   CloudFilterChain   ###########################################################################
+/**
+ * \brief Applies a sequence of CloudFilter.
+ * Consecutive filters that only select points (CloudFilter::isSelectionFilter) are chained through index sets, without copying the points,
+ * and the selected points are only copied once, before a filter that creates new points (voxel grids, scale, clustering...) or at the end of the chain.
+ * The point clouds are taken from a pool (a point cloud is only reused after the localization pipeline releases all its references, which avoids reallocating the points in each scan).
+ * Not thread safe (each thread applying filters should have its own instance).
+ */
+template <typename PointT>
+class CloudFilterChain {
+	// ========================================================================   <public-section>   ===========================================================================
+	public:
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <usings>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		using Ptr = std::shared_ptr< CloudFilterChain<PointT> >;
+		using ConstPtr = std::shared_ptr< const CloudFilterChain<PointT> >;
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </usings>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <constructors-destructor>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		explicit CloudFilterChain(size_t pool_size = 8);
+		virtual ~CloudFilterChain() {}
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </constructors-destructor>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <CloudFilterChain-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		void setupConfigurationFromParameterServer(ros::NodeHandlePtr& private_node_handle, const std::string& configuration_namespace);
+
+		/*! Replaces pointcloud with the filtered cloud (stops when it has minimum_number_of_points or less, and in that case returns false).
+		 * The search_method (if it was built for pointcloud) is given to the filters that are applied to pointcloud, to avoid rebuilding the k-d tree. */
+		bool applyFilters(std::vector< typename CloudFilter<PointT>::Ptr >& cloud_filters, typename pcl::PointCloud<PointT>::Ptr& pointcloud, size_t minimum_number_of_points,
+				const typename pcl::search::KdTree<PointT>::Ptr& search_method = typename pcl::search::KdTree<PointT>::Ptr());
+		void clearPool() { pointclouds_pool_.clear(); }
+		size_t accountMemoryUsage(MemoryUsage& memory_usage) const;
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </CloudFilterChain-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <gets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		inline bool isIndexBasedSelectionEnabled() const { return index_based_selection_enabled_; }
+		inline size_t getPoolSize() const { return pool_size_; }
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </gets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <sets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		inline void setIndexBasedSelectionEnabled(bool index_based_selection_enabled) { index_based_selection_enabled_ = index_based_selection_enabled; }
+		inline void setPoolSize(size_t pool_size) { pool_size_ = pool_size; if (pointclouds_pool_.size() > pool_size) { pointclouds_pool_.resize(pool_size); } }
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </sets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+	// ========================================================================   </public-section>  ===========================================================================
+
+	// ========================================================================   <protected-section>   ========================================================================
+	protected:
+		/*! Empty point cloud with the header, sensor origin and sensor orientation of reference_pointcloud. */
+		typename pcl::PointCloud<PointT>::Ptr getPointCloudFromPool(const pcl::PointCloud<PointT>& reference_pointcloud);
+		typename pcl::PointCloud<PointT>::Ptr extractSelectedPoints(const typename pcl::PointCloud<PointT>::Ptr& pointcloud);
+
+		bool index_based_selection_enabled_;
+		size_t pool_size_;
+		std::vector< typename pcl::PointCloud<PointT>::Ptr > pointclouds_pool_;
+		pcl::IndicesPtr selected_indices_;
+		pcl::IndicesPtr filtered_indices_;
+	// ========================================================================   </protected-section>  ========================================================================
+};
+
+} /* namespace dynamic_robot_localization */
+
+
+#ifdef DRL_NO_PRECOMPILE
+#include <dynamic_robot_localization/cloud_filters/impl/cloud_filter_chain.hpp>
+#endif
@@ -19,11 +19,12 @@
 // PCL includes
 #include <pcl/point_cloud.h>
 #include <pcl/point_types.h>
-#include <pcl/kdtree/kdtree.h>
-#include <pcl/segmentation/extract_clusters.h>
+#include <pcl/common/io.h>
+#include <pcl/search/kdtree.h>
 
 // project includes
 #include <dynamic_robot_localization/common/cloud_publisher.h>
+#include <dynamic_robot_localization/common/parallel_cluster_extraction.h>
 #include <dynamic_robot_localization/common/pointcloud_utils.h>
 #include <dynamic_robot_localization/cloud_filters/cloud_filter.h>
 #include <dynamic_robot_localization/cluster_selectors/cluster_selector.h>
@@ -33,7 +34,9 @@
 namespace dynamic_robot_localization {
 // #########################################################################   euclidean_clustering   ##########################################################################
 /**
- * \brief Description...
+ * \brief Selects the points of the euclidean clusters chosen by the cluster selector.
+ * The clusters are extracted in parallel (ParallelClusterExtraction) and they are kept as indices of the input cloud,
+ * which allows to chain this filter with the other selection filters and to reuse the k-d tree of the input cloud (CloudFilter::setSearchMethod).
  */
 template <typename PointT>
 class EuclideanClustering : public CloudFilter<PointT> {
@@ -52,19 +55,28 @@ class EuclideanClustering : public CloudFilter<PointT> {
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <EuclideanClustering-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 		virtual void setupConfigurationFromParameterServer(ros::NodeHandlePtr& node_handle, ros::NodeHandlePtr& private_node_handle, const std::string& configuration_namespace);
 		virtual void filter(const typename pcl::PointCloud<PointT>::Ptr& input_cloud, typename pcl::PointCloud<PointT>::Ptr& output_cloud);
+		virtual bool isSelectionFilter() { return true; }
+		virtual void filterIndices(const typename pcl::PointCloud<PointT>::Ptr& input_cloud, const pcl::IndicesPtr& input_indices, std::vector<int>& output_indices);
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </EuclideanClustering-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <gets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </gets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <sets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		/*! Also updates the tf collector of the cluster selector (which is given to it during the setup). */
+		virtual void setTfCollector(laserscan_to_pointcloud::TFCollector* tf_collector) { CloudFilter<PointT>::setTfCollector(tf_collector); cluster_selector_.setTfCollector(tf_collector); }
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </sets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 	// ========================================================================   </public-section>  ===========================================================================
 
 	// ========================================================================   <protected-section>   ========================================================================
 	protected:
-		pcl::EuclideanClusterExtraction<PointT> euclidean_cluster_extraction_;
+		/*! Returns the number of clusters found. */
+		size_t selectClustersIndices(const typename pcl::PointCloud<PointT>::Ptr& input_cloud, const pcl::IndicesPtr& input_indices, std::vector<int>& output_indices);
+
+		ParallelClusterExtraction<PointT> cluster_extraction_;
 		ClusterSelector<PointT> cluster_selector_;
+		std::vector<pcl::PointIndices> cluster_indices_;
+		std::vector<size_t> selected_clusters_;
 	// ========================================================================   </protected-section>  ========================================================================
 };
 
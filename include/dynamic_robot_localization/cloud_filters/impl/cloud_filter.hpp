@@ -36,10 +36,48 @@ void CloudFilter<PointT>::filter(const typename pcl::PointCloud<PointT>::Ptr& in
 	if (cloud_publisher_ && output_cloud) { cloud_publisher_->publishPointCloud(*output_cloud); }
 	ROS_DEBUG_STREAM(filter_name_ << " filter reduced point cloud from " << number_of_points_in_input_cloud << " points to " << output_cloud->size() << " points");
 }
+
+template<typename PointT>
+void CloudFilter<PointT>::filterIndices(const typename pcl::PointCloud<PointT>::Ptr& input_cloud, const pcl::IndicesPtr& input_indices, std::vector<int>& output_indices) {
+	typename pcl::FilterIndices<PointT>::Ptr filter_indices = std::dynamic_pointer_cast< pcl::FilterIndices<PointT> >(filter_);
+	if (!filter_indices) {
+		ROS_WARN_STREAM(filter_name_ << " filter does not support filtering by indices");
+		output_indices = *input_indices;
+		return;
+	}
+
+	filter_indices->setInputCloud(input_cloud);
+	filter_indices->setIndices(input_indices);
+	filter_indices->filter(output_indices);
+	filter_indices->setIndices(pcl::IndicesPtr()); // input_indices is reused by the caller and filter() should process the whole cloud
+
+	publishFilteredIndices(input_cloud, output_indices);
+	ROS_DEBUG_STREAM(filter_name_ << " filter reduced point cloud from " << input_indices->size() << " points to " << output_indices.size() << " points");
+}
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </CloudFilter-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 // =============================================================================  </public-section>  ===========================================================================
 
 // =============================================================================   <protected-section>   =======================================================================
+template<typename PointT>
+void CloudFilter<PointT>::publishFilteredIndices(const typename pcl::PointCloud<PointT>::Ptr& input_cloud, const std::vector<int>& output_indices) {
+	if (cloud_publisher_ && cloud_publisher_->isPublishingPointClouds()) {
+		pcl::PointCloud<PointT> filtered_cloud;
+		pcl::copyPointCloud(*input_cloud, output_indices, filtered_cloud);
+		cloud_publisher_->publishPointCloud(filtered_cloud);
+	}
+}
+
+
+template<typename PointT>
+typename pcl::search::KdTree<PointT>::Ptr CloudFilter<PointT>::getSearchMethodForCloud(const typename pcl::PointCloud<PointT>::Ptr& input_cloud) {
+	if (search_method_ && search_method_->getInputCloud() == input_cloud && (!search_method_->getIndices() || search_method_->getIndices()->empty())) {
+		return search_method_;
+	}
+
+	typename pcl::search::KdTree<PointT>::Ptr search_method(new pcl::search::KdTree<PointT>());
+	search_method->setInputCloud(input_cloud);
+	return search_method;
+}
 // =============================================================================   </protected-section>  =======================================================================
 
 } /* namespace dynamic_robot_localization */
@@ -0,0 +1,139 @@
+/**\file cloud_filter_chain.hpp
+ * \brief Description...
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+#include <dynamic_robot_localization/cloud_filters/cloud_filter_chain.h>
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+namespace dynamic_robot_localization {
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <imports>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </imports>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+// =============================================================================  <public-section>  ============================================================================
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <constructors-destructor>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+template<typename PointT>
+CloudFilterChain<PointT>::CloudFilterChain(size_t pool_size) :
+	index_based_selection_enabled_(true),
+	pool_size_(pool_size),
+	selected_indices_(new std::vector<int>()),
+	filtered_indices_(new std::vector<int>()) {}
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </constructors-destructor>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <CloudFilterChain-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+template<typename PointT>
+void CloudFilterChain<PointT>::setupConfigurationFromParameterServer(ros::NodeHandlePtr& private_node_handle, const std::string& configuration_namespace) {
+	private_node_handle->param(configuration_namespace + "index_based_selection", index_based_selection_enabled_, true);
+
+	int pool_size;
+	private_node_handle->param(configuration_namespace + "pool_size", pool_size, 8);
+	setPoolSize(pool_size > 0 ? (size_t)pool_size : 0);
+}
+
+
+template<typename PointT>
+bool CloudFilterChain<PointT>::applyFilters(std::vector< typename CloudFilter<PointT>::Ptr >& cloud_filters, typename pcl::PointCloud<PointT>::Ptr& pointcloud, size_t minimum_number_of_points,
+		const typename pcl::search::KdTree<PointT>::Ptr& search_method) {
+	typename pcl::PointCloud<PointT>::Ptr current_pointcloud = pointcloud;
+	bool using_selected_indices = false;
+	size_t number_of_points = current_pointcloud->size();
+
+	for (size_t i = 0; i < cloud_filters.size(); ++i) {
+		DRL_TRACE_SCOPE_OBJECT("cloud_filters", *cloud_filters[i]);
+		cloud_filters[i]->setSearchMethod((current_pointcloud == pointcloud) ? search_method : typename pcl::search::KdTree<PointT>::Ptr());
+		if (index_based_selection_enabled_ && cloud_filters[i]->isSelectionFilter()) {
+			if (!using_selected_indices) {
+				selected_indices_->resize(current_pointcloud->size());
+				for (size_t j = 0; j < selected_indices_->size(); ++j) {
+					(*selected_indices_)[j] = (int)j;
+				}
+				using_selected_indices = true;
+			}
+
+			cloud_filters[i]->filterIndices(current_pointcloud, selected_indices_, *filtered_indices_);
+			selected_indices_.swap(filtered_indices_);
+			number_of_points = selected_indices_->size();
+		} else {
+			if (using_selected_indices) {
+				current_pointcloud = extractSelectedPoints(current_pointcloud);
+				using_selected_indices = false;
+			}
+
+			typename pcl::PointCloud<PointT>::Ptr filtered_pointcloud = getPointCloudFromPool(*current_pointcloud);
+			cloud_filters[i]->filter(current_pointcloud, filtered_pointcloud);
+			current_pointcloud = filtered_pointcloud; // switch pointers
+			number_of_points = current_pointcloud->size();
+		}
+
+		cloud_filters[i]->setSearchMethod(typename pcl::search::KdTree<PointT>::Ptr()); // the filters should not keep the clouds alive
+
+		if (number_of_points <= minimum_number_of_points)
+			break;
+	}
+
+	if (using_selected_indices) {
+		current_pointcloud = extractSelectedPoints(current_pointcloud);
+	}
+
+	pointcloud = current_pointcloud;
+	return pointcloud->size() > minimum_number_of_points;
+}
+
+
+template<typename PointT>
+size_t CloudFilterChain<PointT>::accountMemoryUsage(MemoryUsage& memory_usage) const {
+	if (!memory_usage.addObject(this)) { return 0; }
+	size_t bytes = sizeof(*this);
+	if (selected_indices_) { bytes += MemoryUsage::s_getVectorBytes(*selected_indices_); }
+	if (filtered_indices_) { bytes += MemoryUsage::s_getVectorBytes(*filtered_indices_); }
+	bytes = memory_usage.addBytes(bytes);
+	for (size_t i = 0; i < pointclouds_pool_.size(); ++i) {
+		bytes += memory_usage.addPointCloud(pointclouds_pool_[i].get());
+	}
+	return bytes;
+}
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </CloudFilterChain-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// =============================================================================  </public-section>  ===========================================================================
+
+// =============================================================================   <protected-section>   =======================================================================
+template<typename PointT>
+typename pcl::PointCloud<PointT>::Ptr CloudFilterChain<PointT>::getPointCloudFromPool(const pcl::PointCloud<PointT>& reference_pointcloud) {
+	typename pcl::PointCloud<PointT>::Ptr pointcloud;
+	for (size_t i = 0; i < pointclouds_pool_.size(); ++i) {
+		if (pointclouds_pool_[i].use_count() == 1) {
+			pointcloud = pointclouds_pool_[i];
+			break;
+		}
+	}
+
+	if (!pointcloud) {
+		pointcloud.reset(new pcl::PointCloud<PointT>());
+		if (pointclouds_pool_.size() < pool_size_) {
+			pointclouds_pool_.push_back(pointcloud);
+		}
+	}
+
+	pointcloud->clear(); // keeps the memory of the points
+	pointcloud->header = reference_pointcloud.header;
+	pointcloud->sensor_origin_ = reference_pointcloud.sensor_origin_;
+	pointcloud->sensor_orientation_ = reference_pointcloud.sensor_orientation_;
+	return pointcloud;
+}
+
+
+template<typename PointT>
+typename pcl::PointCloud<PointT>::Ptr CloudFilterChain<PointT>::extractSelectedPoints(const typename pcl::PointCloud<PointT>::Ptr& pointcloud) {
+	if (selected_indices_->size() == pointcloud->size()) { return pointcloud; } // the selection filters keep the order of the points
+
+	typename pcl::PointCloud<PointT>::Ptr selected_pointcloud = getPointCloudFromPool(*pointcloud);
+	pcl::copyPointCloud(*pointcloud, *selected_indices_, *selected_pointcloud);
+	return selected_pointcloud;
+}
+// =============================================================================   </protected-section>  =======================================================================
+
+} /* namespace dynamic_robot_localization */
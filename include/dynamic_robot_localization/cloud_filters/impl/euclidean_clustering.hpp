@@ -22,14 +22,17 @@ namespace dynamic_robot_localization {
 template<typename PointT>
 void EuclideanClustering<PointT>::setupConfigurationFromParameterServer(ros::NodeHandlePtr& node_handle, ros::NodeHandlePtr& private_node_handle, const std::string& configuration_namespace) {
 	double cluster_tolerance;
-	int min_cluster_size, max_cluster_size;
+	int min_cluster_size, max_cluster_size, number_of_threads;
 	private_node_handle->param(configuration_namespace + "cluster_tolerance", cluster_tolerance, 0.02);
 	private_node_handle->param(configuration_namespace + "min_cluster_size", min_cluster_size, 25);
 	private_node_handle->param(configuration_namespace + "max_cluster_size", max_cluster_size, std::numeric_limits<int>::max());
+	private_node_handle->param(configuration_namespace + "number_of_threads", number_of_threads, 0);
 
-	euclidean_cluster_extraction_.setClusterTolerance(cluster_tolerance);
-	euclidean_cluster_extraction_.setMinClusterSize(min_cluster_size);
-	euclidean_cluster_extraction_.setMaxClusterSize(max_cluster_size);
+	cluster_extraction_.setSearchRadius(cluster_tolerance);
+	cluster_extraction_.setNumberOfNeighbors(0);
+	cluster_extraction_.setMinClusterSize(min_cluster_size > 0 ? (size_t)min_cluster_size : 1);
+	cluster_extraction_.setMaxClusterSize(max_cluster_size > 0 ? (size_t)max_cluster_size : 0);
+	cluster_extraction_.setNumberOfThreads(number_of_threads);
 
 	cluster_selector_.setTfCollector(CloudFilter<PointT>::getTfCollector());
 	cluster_selector_.setupConfigurationFromParameterServer(node_handle, private_node_handle, configuration_namespace + "cluster_selector/");
@@ -39,27 +42,32 @@ void EuclideanClustering<PointT>::setupConfigurationFromParameterServer(ros::Nod
 
 template<typename PointT>
 void EuclideanClustering<PointT>::filter(const typename pcl::PointCloud<PointT>::Ptr& input_cloud, typename pcl::PointCloud<PointT>::Ptr& output_cloud) {
-	size_t number_of_points_in_input_cloud = input_cloud->size();
+	std::vector<int> selected_indices;
+	size_t number_of_clusters = selectClustersIndices(input_cloud, pcl::IndicesPtr(), selected_indices);
+	pcl::copyPointCloud(*input_cloud, selected_indices, *output_cloud);
 
-	typename pcl::search::KdTree<PointT>::Ptr search_tree(new pcl::search::KdTree<PointT>());
-	search_tree->setInputCloud(input_cloud);
-	euclidean_cluster_extraction_.setSearchMethod(search_tree);
-	euclidean_cluster_extraction_.setInputCloud(input_cloud);
-
-	std::vector<pcl::PointIndices> cluster_indices;
-	euclidean_cluster_extraction_.extract(cluster_indices);
+	if (CloudFilter<PointT>::getCloudPublisher() && output_cloud) { CloudFilter<PointT>::getCloudPublisher()->publishPointCloud(*output_cloud); }
+	ROS_DEBUG_STREAM(CloudFilter<PointT>::filter_name_ << " filter found " << number_of_clusters << " clusters and reduced point cloud from " << input_cloud->size() << " points to " << output_cloud->size() << " points");
+}
 
-	std::vector<size_t> selected_clusters;
-	cluster_selector_.selectClusters(input_cloud, cluster_indices, selected_clusters);
-	pointcloud_utils::extractPointCloudClusters(*input_cloud, cluster_indices, selected_clusters, *output_cloud);
 
-	if (CloudFilter<PointT>::getCloudPublisher() && output_cloud) { CloudFilter<PointT>::getCloudPublisher()->publishPointCloud(*output_cloud); }
-	ROS_DEBUG_STREAM(CloudFilter<PointT>::filter_name_ << " filter found " << cluster_indices.size() << " clusters and reduced point cloud from " << number_of_points_in_input_cloud << " points to " << output_cloud->size() << " points");
+template<typename PointT>
+void EuclideanClustering<PointT>::filterIndices(const typename pcl::PointCloud<PointT>::Ptr& input_cloud, const pcl::IndicesPtr& input_indices, std::vector<int>& output_indices) {
+	size_t number_of_clusters = selectClustersIndices(input_cloud, input_indices, output_indices);
+	CloudFilter<PointT>::publishFilteredIndices(input_cloud, output_indices);
+	ROS_DEBUG_STREAM(CloudFilter<PointT>::filter_name_ << " filter found " << number_of_clusters << " clusters and reduced point cloud from " << input_indices->size() << " points to " << output_indices.size() << " points");
 }
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </EuclideanClustering-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 // =============================================================================  </public-section>  ===========================================================================
 
 // =============================================================================   <protected-section>   =======================================================================
+template<typename PointT>
+size_t EuclideanClustering<PointT>::selectClustersIndices(const typename pcl::PointCloud<PointT>::Ptr& input_cloud, const pcl::IndicesPtr& input_indices, std::vector<int>& output_indices) {
+	cluster_extraction_.extract(input_cloud, input_indices, CloudFilter<PointT>::getSearchMethodForCloud(input_cloud), cluster_indices_);
+	cluster_selector_.selectClusters(input_cloud, cluster_indices_, selected_clusters_);
+	pointcloud_utils::extractPointCloudClustersIndices(cluster_indices_, selected_clusters_, output_indices);
+	return cluster_indices_.size();
+}
 // =============================================================================   </protected-section>  =======================================================================
 
 } /* namespace dynamic_robot_localization */
@@ -36,34 +36,50 @@ void HSVSegmentation<PointT>::filter(const typename pcl::PointCloud<PointT>::Ptr
 	size_t number_of_points_in_input_cloud = input_cloud->size();
 
 	for (size_t i = 0; i < input_cloud->size(); ++i) {
-		PointT& point = (*input_cloud)[i];
-		float h = 0.0f, s = 0.0f, v = 0.0f;
-		pcl::RGBtoHSV(point.r, point.g, point.b, h, s, v);
-
-		bool valid_hue;
-		if (minimum_hue_ < maximum_hue_) {
-			valid_hue = (h >= minimum_hue_) && (h <= maximum_hue_);
-		} else {
-			// hue wrap around in the HSV cylinder
-			valid_hue = (h <= maximum_hue_) || (h >= minimum_hue_);
+		if (isPointSelected((*input_cloud)[i])) {
+			output_cloud->push_back((*input_cloud)[i]);
 		}
+	}
 
-		bool valid_saturation = (s >= minimum_saturation_) && (s <= maximum_saturation_);
-		bool valid_value = (v >= minimum_value_) && (v <= maximum_value_);
-		bool valid_point = valid_hue && valid_saturation && valid_value;
+	if (CloudFilter<PointT>::cloud_publisher_ && output_cloud) { CloudFilter<PointT>::cloud_publisher_->publishPointCloud(*output_cloud); }
+	ROS_DEBUG_STREAM(CloudFilter<PointT>::filter_name_ << " filter reduced point cloud from " << number_of_points_in_input_cloud << " points to " << output_cloud->size() << " points");
+}
 
-		if ((valid_point && !invert_segmentation_) || (!valid_point && invert_segmentation_)) {
-			output_cloud->push_back(point);
+template<typename PointT>
+void HSVSegmentation<PointT>::filterIndices(const typename pcl::PointCloud<PointT>::Ptr& input_cloud, const pcl::IndicesPtr& input_indices, std::vector<int>& output_indices) {
+	output_indices.clear();
+	for (size_t i = 0; i < input_indices->size(); ++i) {
+		if (isPointSelected((*input_cloud)[(*input_indices)[i]])) {
+			output_indices.push_back((*input_indices)[i]);
 		}
 	}
 
-	if (CloudFilter<PointT>::cloud_publisher_ && output_cloud) { CloudFilter<PointT>::cloud_publisher_->publishPointCloud(*output_cloud); }
-	ROS_DEBUG_STREAM(CloudFilter<PointT>::filter_name_ << " filter reduced point cloud from " << number_of_points_in_input_cloud << " points to " << output_cloud->size() << " points");
+	CloudFilter<PointT>::publishFilteredIndices(input_cloud, output_indices);
+	ROS_DEBUG_STREAM(CloudFilter<PointT>::filter_name_ << " filter reduced point cloud from " << input_indices->size() << " points to " << output_indices.size() << " points");
 }
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </HSVSegmentation-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 // =============================================================================  </public-section>  ===========================================================================
 
 // =============================================================================   <protected-section>   =======================================================================
+template<typename PointT>
+bool HSVSegmentation<PointT>::isPointSelected(const PointT& point) {
+	float h = 0.0f, s = 0.0f, v = 0.0f;
+	pcl::RGBtoHSV(point.r, point.g, point.b, h, s, v);
+
+	bool valid_hue;
+	if (minimum_hue_ < maximum_hue_) {
+		valid_hue = (h >= minimum_hue_) && (h <= maximum_hue_);
+	} else {
+		// hue wrap around in the HSV cylinder
+		valid_hue = (h <= maximum_hue_) || (h >= minimum_hue_);
+	}
+
+	bool valid_saturation = (s >= minimum_saturation_) && (s <= maximum_saturation_);
+	bool valid_value = (v >= minimum_value_) && (v <= maximum_value_);
+	bool valid_point = valid_hue && valid_saturation && valid_value;
+
+	return (valid_point && !invert_segmentation_) || (!valid_point && invert_segmentation_);
+}
 // =============================================================================   </protected-section>  =======================================================================
 
 } /* namespace dynamic_robot_localization */
@@ -64,6 +64,27 @@ void RandomSample<PointT>::filter(const typename pcl::PointCloud<PointT>::Ptr& i
 	if (CloudFilter<PointT>::getCloudPublisher() && output_cloud) { CloudFilter<PointT>::getCloudPublisher()->publishPointCloud(*output_cloud); }
 	ROS_DEBUG_STREAM(CloudFilter<PointT>::filter_name_ << " filter reduced point cloud from " << number_of_points_in_input_cloud << " points to " << output_cloud->size() << " points");
 }
+
+template<typename PointT>
+void RandomSample<PointT>::filterIndices(const typename pcl::PointCloud<PointT>::Ptr& input_cloud, const pcl::IndicesPtr& input_indices, std::vector<int>& output_indices) {
+	typename pcl::RandomSample<PointT>::Ptr filter = std::static_pointer_cast< typename pcl::RandomSample<PointT> >(CloudFilter<PointT>::filter_);
+
+	if (filter->getSample() >= input_indices->size()) {
+		if (filter->getNegative()) {
+			output_indices.clear();
+		} else {
+			output_indices = *input_indices;
+		}
+
+		CloudFilter<PointT>::publishFilteredIndices(input_cloud, output_indices);
+		ROS_DEBUG_STREAM(CloudFilter<PointT>::filter_name_ << " filter reduced point cloud from " << input_indices->size() << " points to " << output_indices.size() << " points");
+	} else {
+		if (reinitialize_seed_before_filtering_) {
+			filter->setSeed(time(NULL));
+		}
+		CloudFilter<PointT>::filterIndices(input_cloud, input_indices, output_indices);
+	}
+}
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </RandomSample-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 // =============================================================================  </public-section>  ===========================================================================
 
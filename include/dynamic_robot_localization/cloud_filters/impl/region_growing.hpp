@@ -83,6 +83,13 @@ void RegionGrowing<PointT>::setupConfigurationFromParameterServer(ros::NodeHandl
 	private_node_handle->param(configuration_namespace + "number_of_neighbors", number_of_neighbors, 50);
 	region_growing_->setNumberOfNeighbours(number_of_neighbors);
 
+	int number_of_threads;
+	private_node_handle->param(configuration_namespace + "use_parallel_region_growing", use_parallel_region_growing_, false);
+	private_node_handle->param(configuration_namespace + "number_of_threads", number_of_threads, 0);
+	use_parallel_region_growing_ = use_parallel_region_growing_ && !use_pointcloud_rgb_information && use_smoothness_constraint;
+	parallel_region_growing_.setNumberOfThreads(number_of_threads);
+	setupParallelRegionGrowing();
+
 	cluster_selector_.setTfCollector(CloudFilter<PointT>::getTfCollector());
 	cluster_selector_.setupConfigurationFromParameterServer(node_handle, private_node_handle, configuration_namespace + "cluster_selector/");
 	CloudFilter<PointT>::setupConfigurationFromParameterServer(node_handle, private_node_handle, configuration_namespace);
@@ -91,28 +98,74 @@ void RegionGrowing<PointT>::setupConfigurationFromParameterServer(ros::NodeHandl
 
 template<typename PointT>
 void RegionGrowing<PointT>::filter(const typename pcl::PointCloud<PointT>::Ptr& input_cloud, typename pcl::PointCloud<PointT>::Ptr& output_cloud) {
-	size_t number_of_points_in_input_cloud = input_cloud->size();
-
-	typename pcl::search::KdTree<PointT>::Ptr search_tree(new pcl::search::KdTree<PointT>());
-	search_tree->setInputCloud(input_cloud);
-	region_growing_->setSearchMethod(search_tree);
-	region_growing_->setInputCloud(input_cloud);
-	region_growing_->setInputNormals(input_cloud);
+	std::vector<int> selected_indices;
+	size_t number_of_clusters = selectClustersIndices(input_cloud, pcl::IndicesPtr(), selected_indices);
+	pcl::copyPointCloud(*input_cloud, selected_indices, *output_cloud);
 
-	std::vector<pcl::PointIndices> cluster_indices;
-	region_growing_->extract(cluster_indices);
+	if (CloudFilter<PointT>::getCloudPublisher() && output_cloud) { CloudFilter<PointT>::getCloudPublisher()->publishPointCloud(*output_cloud); }
+	ROS_DEBUG_STREAM(CloudFilter<PointT>::filter_name_ << " filter found " << number_of_clusters << " clusters and reduced point cloud from " << input_cloud->size() << " points to " << output_cloud->size() << " points");
+}
 
-	std::vector<size_t> selected_clusters;
-	cluster_selector_.selectClusters(input_cloud, cluster_indices, selected_clusters);
-	pointcloud_utils::extractPointCloudClusters(*input_cloud, cluster_indices, selected_clusters, *output_cloud);
 
-	if (CloudFilter<PointT>::getCloudPublisher() && output_cloud) { CloudFilter<PointT>::getCloudPublisher()->publishPointCloud(*output_cloud); }
-	ROS_DEBUG_STREAM(CloudFilter<PointT>::filter_name_ << " filter found " << cluster_indices.size() << " clusters and reduced point cloud from " << number_of_points_in_input_cloud << " points to " << output_cloud->size() << " points");
+template<typename PointT>
+void RegionGrowing<PointT>::filterIndices(const typename pcl::PointCloud<PointT>::Ptr& input_cloud, const pcl::IndicesPtr& input_indices, std::vector<int>& output_indices) {
+	size_t number_of_clusters = selectClustersIndices(input_cloud, input_indices, output_indices);
+	CloudFilter<PointT>::publishFilteredIndices(input_cloud, output_indices);
+	ROS_DEBUG_STREAM(CloudFilter<PointT>::filter_name_ << " filter found " << number_of_clusters << " clusters and reduced point cloud from " << input_indices->size() << " points to " << output_indices.size() << " points");
 }
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </RegionGrowing-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 // =============================================================================  </public-section>  ===========================================================================
 
 // =============================================================================   <protected-section>   =======================================================================
+template<typename PointT>
+size_t RegionGrowing<PointT>::selectClustersIndices(const typename pcl::PointCloud<PointT>::Ptr& input_cloud, const pcl::IndicesPtr& input_indices, std::vector<int>& output_indices) {
+	if (use_parallel_region_growing_) {
+		parallel_region_growing_.extract(input_cloud, input_indices, CloudFilter<PointT>::getSearchMethodForCloud(input_cloud), cluster_indices_);
+	} else {
+		region_growing_->setSearchMethod(typename pcl::search::KdTree<PointT>::Ptr(new pcl::search::KdTree<PointT>())); // pcl::RegionGrowing builds the k-d tree for the input indices
+		region_growing_->setInputCloud(input_cloud);
+		region_growing_->setIndices(input_indices); // null for using all the points
+		region_growing_->setInputNormals(input_cloud);
+		region_growing_->extract(cluster_indices_);
+	}
+
+	cluster_selector_.selectClusters(input_cloud, cluster_indices_, selected_clusters_);
+	pointcloud_utils::extractPointCloudClustersIndices(cluster_indices_, selected_clusters_, output_indices);
+	return cluster_indices_.size();
+}
+
+
+template<typename PointT>
+void RegionGrowing<PointT>::setupParallelRegionGrowing() {
+	parallel_region_growing_.setSearchRadius(0.0);
+	parallel_region_growing_.setNumberOfNeighbors(region_growing_->getNumberOfNeighbours());
+	parallel_region_growing_.setMinClusterSize((size_t)std::max((int)region_growing_->getMinClusterSize(), 1));
+	parallel_region_growing_.setMaxClusterSize((size_t)std::max((int)region_growing_->getMaxClusterSize(), 0));
+
+	// same thresholds as pcl::RegionGrowing::validatePoint
+	const float cosine_threshold = std::cos(region_growing_->getSmoothnessThreshold());
+	parallel_region_growing_.setNeighborPredicate([cosine_threshold](const PointT& seed_point, const PointT& neighbor_point) {
+		float dot_product = seed_point.normal_x * neighbor_point.normal_x + seed_point.normal_y * neighbor_point.normal_y + seed_point.normal_z * neighbor_point.normal_z;
+		return std::fabs(dot_product) >= cosine_threshold;
+	});
+
+	if (region_growing_->getResidualTestFlag()) {
+		const float residual_threshold = region_growing_->getResidualThreshold();
+		parallel_region_growing_.setPropagationPredicate([residual_threshold](const PointT& seed_point, const PointT& neighbor_point) {
+			float residual = seed_point.normal_x * (seed_point.x - neighbor_point.x) + seed_point.normal_y * (seed_point.y - neighbor_point.y) + seed_point.normal_z * (seed_point.z - neighbor_point.z);
+			return std::fabs(residual) <= residual_threshold;
+		});
+	} else {
+		parallel_region_growing_.setPropagationPredicate(typename ParallelClusterExtraction<PointT>::PropagationPredicate());
+	}
+
+	if (region_growing_->getCurvatureTestFlag()) {
+		const float curvature_threshold = region_growing_->getCurvatureThreshold();
+		parallel_region_growing_.setSeedPredicate([curvature_threshold](const PointT& point) { return point.curvature <= curvature_threshold; });
+	} else {
+		parallel_region_growing_.setSeedPredicate(typename ParallelClusterExtraction<PointT>::SeedPredicate());
+	}
+}
 // =============================================================================   </protected-section>  =======================================================================
 
 } /* namespace dynamic_robot_localization */
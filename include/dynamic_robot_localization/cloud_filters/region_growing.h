@@ -9,6 +9,7 @@
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>  <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 // std includes
+#include <algorithm>
 #include <cmath>
 #include <limits>
 #include <memory>
@@ -20,12 +21,14 @@
 // PCL includes
 #include <pcl/point_cloud.h>
 #include <pcl/point_types.h>
+#include <pcl/common/io.h>
 #include <pcl/search/kdtree.h>
 #include <pcl/segmentation/impl/region_growing.hpp>
 #include <pcl/segmentation/impl/region_growing_rgb.hpp>
 
 // project includes
 #include <dynamic_robot_localization/common/cloud_publisher.h>
+#include <dynamic_robot_localization/common/parallel_cluster_extraction.h>
 #include <dynamic_robot_localization/common/pointcloud_utils.h>
 #include <dynamic_robot_localization/cloud_filters/cloud_filter.h>
 #include <dynamic_robot_localization/cluster_selectors/cluster_selector.h>
@@ -35,7 +38,11 @@
 namespace dynamic_robot_localization {
 // #############################################################################   region_growing   ############################################################################
 /**
- * \brief Description...
+ * \brief Selects the points of the regions chosen by the cluster selector.
+ * When the smoothness constraint is used without rgb information, the regions are grown in parallel (ParallelClusterExtraction) reusing the k-d tree of the input cloud.
+ * In that case, two seeds are merged if their normals are within the smoothness threshold (and pass the residual test, if enabled), and the points
+ * that are not seeds (due to the curvature test) are added to the region of the closest seed with similar normal.
+ * This does not depend on the order in which pcl::RegionGrowing visits the seeds, but it usually gives the same regions.
  */
 template <typename PointT>
 class RegionGrowing : public CloudFilter<PointT> {
@@ -47,26 +54,38 @@ class RegionGrowing : public CloudFilter<PointT> {
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </usings>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <constructors-destructor>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
-		RegionGrowing() : CloudFilter<PointT>("RegionGrowing") {}
+		RegionGrowing() : CloudFilter<PointT>("RegionGrowing"), use_parallel_region_growing_(false) {}
 		virtual ~RegionGrowing() {}
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </constructors-destructor>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <RegionGrowing-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 		virtual void setupConfigurationFromParameterServer(ros::NodeHandlePtr& node_handle, ros::NodeHandlePtr& private_node_handle, const std::string& configuration_namespace);
 		virtual void filter(const typename pcl::PointCloud<PointT>::Ptr& input_cloud, typename pcl::PointCloud<PointT>::Ptr& output_cloud);
+		virtual bool isSelectionFilter() { return true; }
+		virtual void filterIndices(const typename pcl::PointCloud<PointT>::Ptr& input_cloud, const pcl::IndicesPtr& input_indices, std::vector<int>& output_indices);
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </RegionGrowing-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <gets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </gets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <sets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		/*! Also updates the tf collector of the cluster selector (which is given to it during the setup). */
+		virtual void setTfCollector(laserscan_to_pointcloud::TFCollector* tf_collector) { CloudFilter<PointT>::setTfCollector(tf_collector); cluster_selector_.setTfCollector(tf_collector); }
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </sets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 	// ========================================================================   </public-section>  ===========================================================================
 
 	// ========================================================================   <protected-section>   ========================================================================
 	protected:
+		/*! Returns the number of clusters found. */
+		size_t selectClustersIndices(const typename pcl::PointCloud<PointT>::Ptr& input_cloud, const pcl::IndicesPtr& input_indices, std::vector<int>& output_indices);
+		void setupParallelRegionGrowing();
+
 		typename std::shared_ptr< pcl::RegionGrowing<PointT, PointT> > region_growing_;
+		bool use_parallel_region_growing_;
+		ParallelClusterExtraction<PointT> parallel_region_growing_;
 		ClusterSelector<PointT> cluster_selector_;
+		std::vector<pcl::PointIndices> cluster_indices_;
+		std::vector<size_t> selected_clusters_;
 	// ========================================================================   </protected-section>  ========================================================================
 };
 
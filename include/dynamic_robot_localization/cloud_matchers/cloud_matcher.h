@@ -38,7 +38,9 @@
 #include <dynamic_robot_localization/common/cumulative_static_transform_broadcaster.h>
 #include <dynamic_robot_localization/common/configurable_object.h>
 #include <dynamic_robot_localization/common/cloud_publisher.h>
+#include <dynamic_robot_localization/common/reference_map_publisher.h>
 #include <dynamic_robot_localization/common/math_utils.h>
+#include <dynamic_robot_localization/common/memory_usage.h>
 #include <dynamic_robot_localization/common/performance_timer.h>
 #include <dynamic_robot_localization/common/registration_visualizer.h>
 #include <dynamic_robot_localization/cloud_matchers/correspondence_estimation.h>
@@ -94,6 +96,14 @@ class CloudMatcher : public ConfigurableObject {
 		virtual void resetTransformationEstimationElapsedTime();
 		virtual double getTransformCloudElapsedTimeMS() { return -1.0; }
 		virtual void resetTransformCloudElapsedTime() {}
+
+		/*! Removes the aligned / reference point cloud publishers and the tf broadcasters (used when the matcher is a stage of another matcher, that publishes only the final result). */
+		void clearPublishers();
+		/*! Publishes the reference point cloud changes allowed by the throttling of the reference_pointcloud_publisher (called after successful registrations). */
+		void publishReferenceCloud(std::uint64_t pcl_time_stamp);
+		/*! Accounts the reference point clouds, search trees and caches used by the matcher (objects shared with other modules are only counted once by memory_usage).
+		 * @return number of bytes added to memory_usage */
+		virtual size_t accountMemoryUsage(MemoryUsage& memory_usage);
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </CloudMatcher-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <gets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
@@ -108,6 +118,10 @@ class CloudMatcher : public ConfigurableObject {
 		virtual std::string getMatcherConvergenceState() { return ""; }
 		virtual double getRootMeanSquareErrorOfRegistrationCorrespondences() { return -1.0; }
 		virtual int getNumberCorrespondencesInLastRegistrationIteration() { return -1; }
+		inline bool getForceNoRecomputeReciprocal() const { return force_no_recompute_reciprocal_; }
+		inline Eigen::Matrix4f getRegistrationInitialGuess() const { return Eigen::Matrix4f(registration_initial_guess_); }
+		/*! Returns the grid of the CorrespondenceEstimationIncrementalLookupTable approach (nullptr if other approach is used). */
+		typename CorrespondencesLookupTableGrid<PointT>::Ptr getCorrespondencesLookupTableGrid();
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </gets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <sets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
@@ -116,7 +130,11 @@ class CloudMatcher : public ConfigurableObject {
 		inline void setCloudPublisher(typename CloudPublisher<PointT>::Ptr& cloud_publisher) { cloud_publisher_ = cloud_publisher; }
 		inline void setDisplayCloudAligment(bool display_cloud_aligment) { display_cloud_aligment_ = display_cloud_aligment; }
 		inline void setForceNoRecomputeReciprocal (bool force_no_recompute_reciprocal) { force_no_recompute_reciprocal_ = force_no_recompute_reciprocal; }
+		/*! Transform given to pcl::Registration::align (the registered point cloud and the pose correction include it). */
+		inline void setRegistrationInitialGuess(const Eigen::Matrix4f& registration_initial_guess) { registration_initial_guess_ = registration_initial_guess; }
 		inline void setRegistrationVisualizer(const std::shared_ptr<RegistrationVisualizer<PointT, PointT> >& registration_visualizer) { registration_visualizer_ = registration_visualizer; }
+		/*! Allows matchers with the same grid configuration to share the grid (ignored if the CorrespondenceEstimationIncrementalLookupTable approach is not used). */
+		void setCorrespondencesLookupTableGrid(const typename CorrespondencesLookupTableGrid<PointT>::Ptr& correspondences_lookup_table_grid);
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </sets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 	// ========================================================================   </public-section>  ===========================================================================
 
@@ -129,7 +147,7 @@ class CloudMatcher : public ConfigurableObject {
 		typename pcl::registration::TransformationEstimation<PointT, PointT, float>::Ptr transformation_estimation_ptr_;
 		double cloud_align_time_ms_;
 		typename CloudPublisher<PointT>::Ptr cloud_publisher_;
-		typename CloudPublisher<PointT>::Ptr reference_cloud_publisher_;
+		typename ReferenceMapPublisher<PointT>::Ptr reference_cloud_publisher_;
 		bool match_only_keypoints_;
 		typename pcl::PointCloud<PointT>::Ptr reference_cloud_;
 		typename pcl::PointCloud<PointT>::Ptr reference_cloud_keypoints_;
@@ -139,6 +157,7 @@ class CloudMatcher : public ConfigurableObject {
 		bool display_cloud_aligment_;
 		int maximum_number_of_displayed_correspondences_;
 		bool force_no_recompute_reciprocal_;
+		Eigen::Matrix<float, 4, 4, Eigen::DontAlign> registration_initial_guess_;
 
 		std::shared_ptr< tf2_ros::TransformBroadcaster > tf_broadcaster_;
 		std::shared_ptr< CumulativeStaticTransformBroadcaster > static_tf_broadcaster_;
@@ -19,10 +19,13 @@
 #include <pcl/registration/correspondence_estimation_backprojection.h>
 #include <pcl/registration/correspondence_estimation_normal_shooting.h>
 #include <pcl/registration/correspondence_estimation_organized_projection.h>
+#include <pcl/common/copy_point.h>
 
 // project includes
 #include <dynamic_robot_localization/common/common.h>
 #include <dynamic_robot_localization/common/performance_timer.h>
+#include <dynamic_robot_localization/common/tracer.h>
+#include <dynamic_robot_localization/cloud_matchers/correspondences_lookup_table_grid.h>
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 namespace dynamic_robot_localization {
@@ -32,7 +35,8 @@ enum CorrepondenceEstimationApproach {
 	CorrespondenceEstimationLookupTable,
 	CorrespondenceEstimationBackProjection,
 	CorrespondenceEstimationNormalShooting,
-	CorrespondenceEstimationOrganizedProjection
+	CorrespondenceEstimationOrganizedProjection,
+	CorrespondenceEstimationIncrementalLookupTable
 };
 
 
@@ -48,6 +52,7 @@ class BaseClass##Suffix : public pcl::registration::BaseClass< DRL_UNPACK_ARGS T
 		virtual ~BaseClass##Suffix() {} \
 \
 		virtual void determineCorrespondences(pcl::Correspondences &correspondences, double max_distance = std::numeric_limits<double>::max()) { \
+			DRL_TRACE_SCOPE("correspondence_estimation/" #BaseClass); \
 			PerformanceTimer timer_; \
 			timer_.start(); \
 			pcl::registration::BaseClass< DRL_UNPACK_ARGS TemplatesUsage >::determineCorrespondences(correspondences, max_distance); \
@@ -55,6 +60,7 @@ class BaseClass##Suffix : public pcl::registration::BaseClass< DRL_UNPACK_ARGS T
 		} \
 \
 		virtual void determineReciprocalCorrespondences(pcl::Correspondences &correspondences, double max_distance = std::numeric_limits<double>::max()) { \
+			DRL_TRACE_SCOPE("correspondence_estimation/" #BaseClass); \
 			PerformanceTimer timer_; \
 			timer_.start(); \
 			pcl::registration::BaseClass< DRL_UNPACK_ARGS TemplatesUsage >::determineReciprocalCorrespondences(correspondences, max_distance); \
@@ -76,5 +82,95 @@ GenerateCorrespondenceEstimationTimed(CorrespondenceEstimationOrganizedProjectio
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </macros>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 
+/**
+ * \brief Correspondence estimation using a CorrespondencesLookupTableGrid, that is updated incrementally when the reference point cloud changes (instead of being rebuilt in setInputTarget).
+ * The grid is updated by the CloudMatcher when the reference point cloud changes, and can be shared by several matchers.
+ * Query points without a cell in the grid are searched in the target k-d tree if use_search_tree_when_query_point_is_outside_lookup_table is true
+ * (only useful if the max correspondence distance is larger than the grid influence radius).
+ * Reciprocal correspondences are estimated with the k-d trees of the base class.
+ */
+template <typename PointSource, typename PointTarget, typename Scalar = float>
+class CorrespondenceEstimationIncrementalLookupTableTimed : public pcl::registration::CorrespondenceEstimation<PointSource, PointTarget, Scalar> {
+	public:
+		using Ptr = std::shared_ptr< CorrespondenceEstimationIncrementalLookupTableTimed<PointSource, PointTarget, Scalar> >;
+		using ConstPtr = std::shared_ptr< const CorrespondenceEstimationIncrementalLookupTableTimed<PointSource, PointTarget, Scalar> >;
+		using pcl::registration::CorrespondenceEstimation<PointSource, PointTarget, Scalar>::input_;
+		using pcl::registration::CorrespondenceEstimation<PointSource, PointTarget, Scalar>::indices_;
+		using pcl::registration::CorrespondenceEstimation<PointSource, PointTarget, Scalar>::target_;
+		using pcl::registration::CorrespondenceEstimation<PointSource, PointTarget, Scalar>::tree_;
+
+		CorrespondenceEstimationIncrementalLookupTableTimed() : use_search_tree_when_query_point_is_outside_lookup_table_(true), correspondence_estimation_elapsed_time_(0) {
+			this->corr_name_ = "CorrespondenceEstimationIncrementalLookupTable";
+		}
+		virtual ~CorrespondenceEstimationIncrementalLookupTableTimed() {}
+
+		virtual void determineCorrespondences(pcl::Correspondences &correspondences, double max_distance = std::numeric_limits<double>::max()) {
+			PerformanceTimer timer_;
+			timer_.start();
+
+			if (!correspondences_lookup_table_grid_ || !target_ || !pcl::PCLBase<PointSource>::initCompute()) { // the target k-d tree is not rebuilt
+				correspondences.clear();
+				return;
+			}
+
+			double max_squared_distance = max_distance * max_distance;
+			bool search_outside_lookup_table = use_search_tree_when_query_point_is_outside_lookup_table_ && tree_ && max_distance > correspondences_lookup_table_grid_->getInfluenceRadius();
+			std::vector<int> k_indices(1);
+			std::vector<float> k_squared_distances(1);
+			PointTarget query_point;
+			correspondences.resize(indices_->size());
+			size_t number_of_correspondences = 0;
+
+			for (size_t i = 0; i < indices_->size(); ++i) {
+				const PointSource& point = (*input_)[(*indices_)[i]];
+				int target_index;
+				float squared_distance;
+				if (!correspondences_lookup_table_grid_->getCorrespondence(point.x, point.y, point.z, target_index, squared_distance)) {
+					if (!search_outside_lookup_table) { continue; }
+					pcl::copyPoint(point, query_point);
+					if (tree_->nearestKSearch(query_point, 1, k_indices, k_squared_distances) == 0) { continue; }
+					target_index = k_indices[0];
+					squared_distance = k_squared_distances[0];
+				}
+
+				if (squared_distance > max_squared_distance) { continue; }
+
+				pcl::Correspondence& correspondence = correspondences[number_of_correspondences++];
+				correspondence.index_query = (*indices_)[i];
+				correspondence.index_match = target_index;
+				correspondence.distance = squared_distance;
+			}
+
+			correspondences.resize(number_of_correspondences);
+			pcl::PCLBase<PointSource>::deinitCompute();
+			correspondence_estimation_elapsed_time_ += timer_.getElapsedTimeInMilliSec();
+		}
+
+		virtual void determineReciprocalCorrespondences(pcl::Correspondences &correspondences, double max_distance = std::numeric_limits<double>::max()) {
+			PerformanceTimer timer_;
+			timer_.start();
+			pcl::registration::CorrespondenceEstimation<PointSource, PointTarget, Scalar>::determineReciprocalCorrespondences(correspondences, max_distance);
+			correspondence_estimation_elapsed_time_ += timer_.getElapsedTimeInMilliSec();
+		}
+
+		virtual typename pcl::registration::CorrespondenceEstimationBase<PointSource, PointTarget, Scalar>::Ptr clone() const {
+			Ptr copy(new CorrespondenceEstimationIncrementalLookupTableTimed<PointSource, PointTarget, Scalar>(*this));
+			return copy;
+		}
+
+		inline double getCorrespondenceEstimationElapsedTime() { return correspondence_estimation_elapsed_time_; }
+		inline void resetCorrespondenceEstimationElapsedTime() { correspondence_estimation_elapsed_time_ = 0; }
+		inline typename CorrespondencesLookupTableGrid<PointTarget>::Ptr getCorrespondencesLookupTableGrid() { return correspondences_lookup_table_grid_; }
+		inline void setCorrespondencesLookupTableGrid(const typename CorrespondencesLookupTableGrid<PointTarget>::Ptr& correspondences_lookup_table_grid) { correspondences_lookup_table_grid_ = correspondences_lookup_table_grid; }
+		inline bool getUseSearchTreeWhenQueryPointIsOutsideLookupTable() const { return use_search_tree_when_query_point_is_outside_lookup_table_; }
+		inline void setUseSearchTreeWhenQueryPointIsOutsideLookupTable(bool use_search_tree) { use_search_tree_when_query_point_is_outside_lookup_table_ = use_search_tree; }
+
+	protected:
+		typename CorrespondencesLookupTableGrid<PointTarget>::Ptr correspondences_lookup_table_grid_;
+		bool use_search_tree_when_query_point_is_outside_lookup_table_;
+		double correspondence_estimation_elapsed_time_;
+};
+
+
 } /* namespace dynamic_robot_localization */
 
@@ -0,0 +1,212 @@
+#pragma once
+
+/**\file correspondences_lookup_table_grid.h
+ * \brief Sparse grid with the closest reference point of each cell, that is updated incrementally when the reference point cloud changes
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>  <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// std includes
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+// ROS includes
+#include <ros/ros.h>
+
+// PCL includes
+#include <pcl/common/point_tests.h>
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+#include <pcl/search/kdtree.h>
+
+// external libs includes
+#include <Eigen/Core>
+
+// project includes
+#include <dynamic_robot_localization/common/memory_usage.h>
+#include <dynamic_robot_localization/common/performance_timer.h>
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+namespace dynamic_robot_localization {
+// ###################################################################   CorrespondencesLookupTableGrid   ####################################################################
+/**
+ * \brief Lookup table with the closest reference point of the cells that are within influence_radius of at least one reference point.
+ * The cells are allocated in blocks of s_block_size^3 cells only where they are needed, which allows the table to grow with the map without reallocating the existing cells.
+ * When the reference point cloud changes, its points are matched by position with the points already in the table, and only the cells
+ * within influence_radius of the removed and inserted points are updated (the table is only rebuilt when most of the points changed).
+ * When the caller knows which points changed (for example, the points appended by VoxelHashSearch::insertPoints), insertPoints and removePoints
+ * update the table without matching all the points of the reference point cloud (update is only needed after the reference point cloud is replaced, such as in a map reload).
+ * The same grid can be shared by several matchers (the update is skipped if the grid was already updated with the same reference point cloud).
+ * Not thread safe.
+ */
+template <typename PointT>
+class CorrespondencesLookupTableGrid {
+	// ========================================================================   <public-section>   ===========================================================================
+	public:
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <usings>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		using Ptr = std::shared_ptr< CorrespondencesLookupTableGrid<PointT> >;
+		using ConstPtr = std::shared_ptr< const CorrespondencesLookupTableGrid<PointT> >;
+		using BlockKey = std::uint64_t;
+
+		struct Cell {
+			std::uint32_t point_id;
+			float squared_distance; // between the cell center and the point
+		};
+
+		struct PointPositionKey {
+			float x, y, z;
+			bool operator==(const PointPositionKey& other) const { return x == other.x && y == other.y && z == other.z; }
+		};
+
+		struct PointPositionKeyHash {
+			size_t operator()(const PointPositionKey& key) const {
+				std::uint32_t bits[3];
+				std::memcpy(bits, &key, sizeof(bits));
+				return (size_t)((std::uint64_t)bits[0] * 73856093u ^ (std::uint64_t)bits[1] * 19349663u ^ (std::uint64_t)bits[2] * 83492791u);
+			}
+		};
+
+		static const int s_block_size = 16;
+		static const std::uint32_t s_invalid_point_id = std::numeric_limits<std::uint32_t>::max();
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </usings>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <constructors-destructor>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		explicit CorrespondencesLookupTableGrid(float cell_resolution = 0.05f, float influence_radius = 0.2f);
+		virtual ~CorrespondencesLookupTableGrid() {}
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </constructors-destructor>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <CorrespondencesLookupTableGrid-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		/*! Updates the table with the new reference point cloud (the search method must have the new reference point cloud as input and is used to recompute the cells whose closest point was removed).
+		 * Returns false if the update was skipped because the grid was already updated with this point cloud. */
+		bool update(const typename pcl::PointCloud<PointT>::Ptr& reference_pointcloud, const typename pcl::search::KdTree<PointT>::Ptr& search_method);
+		/*! Adds the points with the given indices, which must have been appended to the reference point cloud given in the last update / insertPoints / removePoints.
+		 * Returns false if the table is not in sync with the reference point cloud (and update must be used instead). */
+		bool insertPoints(const typename pcl::PointCloud<PointT>::Ptr& reference_pointcloud, const std::vector<int>& inserted_points_indices);
+		/*! Removes the points with the positions of removed_points, which must have been removed from the reference point cloud given in the last update / insertPoints / removePoints
+		 * without changing the indices of the remaining points (the search method must have the reference point cloud as input and is used to recompute the cells whose closest point was removed).
+		 * Returns false if the table is not in sync with the reference point cloud (and update must be used instead). */
+		bool removePoints(const typename pcl::PointCloud<PointT>::Ptr& reference_pointcloud, const pcl::PointCloud<PointT>& removed_points, const typename pcl::search::KdTree<PointT>::Ptr& search_method);
+		void clear();
+		bool hasSameConfiguration(const CorrespondencesLookupTableGrid<PointT>& other) const;
+		/*! New empty grid with the same configuration (allows to prepare the grid of a new reference point cloud while this one is still being used by the matchers). */
+		Ptr cloneConfiguration() const;
+		/*! @return number of bytes added to memory_usage (0 if this grid was already accounted by another matcher) */
+		size_t accountMemoryUsage(MemoryUsage& memory_usage) const;
+
+		/*! Returns false if there is no reference point within influence_radius of the cell center. */
+		inline bool getCorrespondence(float x, float y, float z, int& reference_point_index, float& squared_distance) const {
+			Eigen::Vector3i cell_coordinates = computeCellCoordinates(x, y, z);
+			typename std::unordered_map< BlockKey, std::vector<Cell> >::const_iterator block_it = blocks_.find(computeBlockKey(computeBlockCoordinates(cell_coordinates)));
+			if (block_it == blocks_.end()) { return false; }
+
+			const Cell& cell = block_it->second[computeCellOffsetInBlock(cell_coordinates)];
+			if (cell.point_id == s_invalid_point_id) { return false; }
+
+			reference_point_index = point_indices_[cell.point_id];
+			if (compute_distance_from_query_point_to_closest_point_) {
+				squared_distance = (point_positions_[cell.point_id] - Eigen::Vector3f(x, y, z)).squaredNorm();
+			} else {
+				squared_distance = cell.squared_distance;
+			}
+			return true;
+		}
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </CorrespondencesLookupTableGrid-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <gets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		inline float getCellResolution() const { return cell_resolution_; }
+		inline float getInfluenceRadius() const { return influence_radius_; }
+		inline double getFullRebuildRatio() const { return full_rebuild_ratio_; }
+		inline bool getComputeDistanceFromQueryPointToClosestPoint() const { return compute_distance_from_query_point_to_closest_point_; }
+		inline size_t getNumberOfBlocks() const { return blocks_.size(); }
+		inline size_t getNumberOfPoints() const { return point_ids_.size(); }
+		inline size_t getNumberOfUpdatedCellsInLastUpdate() const { return number_of_updated_cells_in_last_update_; }
+		inline bool getLastUpdateWasFullRebuild() const { return last_update_was_full_rebuild_; }
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </gets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <sets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		/*! Changing the cell resolution or influence radius clears the table. */
+		inline void setCellResolution(float cell_resolution) { cell_resolution_ = cell_resolution; inverse_cell_resolution_ = 1.0f / cell_resolution; clear(); }
+		inline void setInfluenceRadius(float influence_radius) { influence_radius_ = influence_radius; clear(); }
+		/*! The table is rebuilt instead of updated when the number of inserted and removed points is higher than this ratio of the number of points in the table. */
+		inline void setFullRebuildRatio(double full_rebuild_ratio) { full_rebuild_ratio_ = full_rebuild_ratio; }
+		inline void setComputeDistanceFromQueryPointToClosestPoint(bool compute_distance_from_query_point_to_closest_point) { compute_distance_from_query_point_to_closest_point_ = compute_distance_from_query_point_to_closest_point; }
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </sets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+	// ========================================================================   </public-section>  ===========================================================================
+
+	// ========================================================================   <protected-section>   ========================================================================
+	protected:
+		static inline int s_floorDivision(int value, int divisor) { return (value >= 0 ? value / divisor : -((-value + divisor - 1) / divisor)); }
+
+		inline Eigen::Vector3i computeCellCoordinates(float x, float y, float z) const {
+			return Eigen::Vector3i((int)std::floor(x * inverse_cell_resolution_), (int)std::floor(y * inverse_cell_resolution_), (int)std::floor(z * inverse_cell_resolution_));
+		}
+
+		inline Eigen::Vector3i computeBlockCoordinates(const Eigen::Vector3i& cell_coordinates) const {
+			return Eigen::Vector3i(s_floorDivision(cell_coordinates.x(), s_block_size), s_floorDivision(cell_coordinates.y(), s_block_size), s_floorDivision(cell_coordinates.z(), s_block_size));
+		}
+
+		inline BlockKey computeBlockKey(const Eigen::Vector3i& block_coordinates) const {
+			return ((BlockKey)(block_coordinates.x() & 0x1FFFFF) << 42) | ((BlockKey)(block_coordinates.y() & 0x1FFFFF) << 21) | (BlockKey)(block_coordinates.z() & 0x1FFFFF);
+		}
+
+		inline size_t computeCellOffsetInBlock(const Eigen::Vector3i& cell_coordinates) const {
+			return (size_t)((cell_coordinates.x() - s_floorDivision(cell_coordinates.x(), s_block_size) * s_block_size) +
+					s_block_size * ((cell_coordinates.y() - s_floorDivision(cell_coordinates.y(), s_block_size) * s_block_size) +
+					s_block_size * (cell_coordinates.z() - s_floorDivision(cell_coordinates.z(), s_block_size) * s_block_size)));
+		}
+
+		inline Eigen::Vector3f computeCellCenter(const Eigen::Vector3i& cell_coordinates) const {
+			return (cell_coordinates.cast<float>() + Eigen::Vector3f::Constant(0.5f)) * cell_resolution_;
+		}
+
+		static inline PointPositionKey s_computePointPositionKey(const PointT& point) {
+			PointPositionKey key = { point.x + 0.0f, point.y + 0.0f, point.z + 0.0f }; // + 0.0f converts -0.0f to 0.0f (both must have the same hash)
+			return key;
+		}
+
+		/*! Calls cell_function(cell, squared_distance_to_cell_center, cell_center) for the cells whose center is within influence_radius of the position, iterating block by block. */
+		template <typename CellFunction>
+		void forEachCellWithinInfluenceRadius(const Eigen::Vector3f& position, bool allocate_missing_blocks, CellFunction cell_function);
+
+		std::uint32_t addPoint(const PointPositionKey& key, int reference_point_index);
+		void removePoint(std::uint32_t point_id);
+		void rebuild(const pcl::PointCloud<PointT>& reference_pointcloud);
+		/*! Sets the point as the closest point of the cells within influence_radius that have a farther closest point. */
+		void propagatePoint(std::uint32_t point_id);
+		/*! Clears the cells within influence_radius whose closest point is point_id and adds them to dirty_cells. */
+		void invalidatePointCells(std::uint32_t point_id, std::vector<Cell*>& dirty_cells, std::vector<Eigen::Vector3f>& dirty_cells_centers);
+		void recomputeCells(const std::vector<Cell*>& dirty_cells, const std::vector<Eigen::Vector3f>& dirty_cells_centers,
+				const pcl::PointCloud<PointT>& reference_pointcloud, const typename pcl::search::KdTree<PointT>::Ptr& search_method);
+		void setReferencePointCloud(const typename pcl::PointCloud<PointT>::Ptr& reference_pointcloud);
+
+		float cell_resolution_;
+		float inverse_cell_resolution_;
+		float influence_radius_;
+		double full_rebuild_ratio_;
+		bool compute_distance_from_query_point_to_closest_point_;
+		std::unordered_map< BlockKey, std::vector<Cell> > blocks_;
+		std::unordered_map< PointPositionKey, std::uint32_t, PointPositionKeyHash > point_ids_;
+		std::vector<int> point_indices_;
+		std::vector<Eigen::Vector3f> point_positions_;
+		std::vector<std::uint32_t> free_point_ids_;
+		typename pcl::PointCloud<PointT>::Ptr reference_pointcloud_;
+		size_t reference_pointcloud_size_;
+		std::uint64_t reference_pointcloud_stamp_;
+		size_t number_of_updated_cells_in_last_update_;
+		bool last_update_was_full_rebuild_;
+	// ========================================================================   </protected-section>  ========================================================================
+};
+
+} /* namespace dynamic_robot_localization */
+
+
+#ifdef DRL_NO_PRECOMPILE
+#include <dynamic_robot_localization/cloud_matchers/impl/correspondences_lookup_table_grid.hpp>
+#endif
@@ -0,0 +1,131 @@
+#pragma once
+
+/**\file descriptor_index.h
+ * \brief Approximate nearest neighbor index for keypoint descriptors (randomized kd-forest or hierarchical k-means) that can be saved to disk
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>  <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// std includes
+#include <algorithm>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// ROS includes
+#include <ros/ros.h>
+
+// PCL includes
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+#include <pcl/kdtree/kdtree_flann.h>
+
+// external libs includes
+#include <flann/flann.hpp>
+
+// project includes
+#include <dynamic_robot_localization/common/memory_usage.h>
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+namespace dynamic_robot_localization {
+// ###########################################################################   DescriptorIndex   ############################################################################
+/**
+ * \brief Nearest neighbor search for keypoint descriptors using the approximate indexes of FLANN.
+ * Derives from pcl::KdTreeFLANN in order to be a drop in replacement for the feature trees of the feature matchers.
+ * The randomized kd-forest and the hierarchical k-means tree only inspect number_of_checks leafs per query, which trades recall for search time
+ * and makes the matching time grow sublinearly with the number of reference descriptors (unlike the single kd-tree, which degenerates to brute force in high dimensional spaces).
+ * The index can be loaded from / saved to a file, which must be built from the same descriptors (the FLANN file only stores the tree structure).
+ */
+template <typename FeatureT>
+class DescriptorIndex : public pcl::KdTreeFLANN<FeatureT> {
+	// ========================================================================   <public-section>   ===========================================================================
+	public:
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <usings>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		using Ptr = std::shared_ptr< DescriptorIndex<FeatureT> >;
+		using ConstPtr = std::shared_ptr< const DescriptorIndex<FeatureT> >;
+		using PointCloudConstPtr = typename pcl::KdTreeFLANN<FeatureT>::PointCloudConstPtr;
+		using IndicesConstPtr = typename pcl::KdTreeFLANN<FeatureT>::IndicesConstPtr;
+		using FLANNIndex = flann::Index< flann::L2_Simple<float> >;
+		using pcl::KdTreeFLANN<FeatureT>::nearestKSearch;
+		using pcl::KdTreeFLANN<FeatureT>::radiusSearch;
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </usings>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <enums>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		enum IndexType {
+			ExactKdTree,
+			RandomizedKdForest,
+			HierarchicalKMeans
+		};
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </enums>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <constructors-destructor>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		explicit DescriptorIndex(IndexType index_type = RandomizedKdForest, int number_of_trees = 4, int branching_factor = 32, int number_of_kmeans_iterations = 11, int number_of_checks = 128);
+		virtual ~DescriptorIndex() {}
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </constructors-destructor>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <DescriptorIndex-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		static bool s_parseIndexType(const std::string& index_type_name, IndexType& index_type_out);
+
+		/*! Builds the index (or loads it from the index load filename, if it was built for the same descriptors) and saves it to the index save filename (if not empty). */
+		virtual void setInputCloud(const PointCloudConstPtr& cloud, const IndicesConstPtr& indices = IndicesConstPtr());
+		bool saveIndex(const std::string& filename) const;
+		/*! Accounts the copy of the descriptors and the FLANN index (the descriptors point cloud is accounted by the feature matcher). */
+		size_t accountMemoryUsage(MemoryUsage& memory_usage) const;
+
+		virtual int nearestKSearch(const FeatureT& point, int k, std::vector<int>& k_indices, std::vector<float>& k_sqr_distances) const;
+		virtual int radiusSearch(const FeatureT& point, double radius, std::vector<int>& k_indices, std::vector<float>& k_sqr_distances, unsigned int max_nn = 0) const;
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </DescriptorIndex-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <gets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		inline IndexType getIndexType() const { return index_type_; }
+		inline int getNumberOfTrees() const { return number_of_trees_; }
+		inline int getBranchingFactor() const { return branching_factor_; }
+		inline int getNumberOfKMeansIterations() const { return number_of_kmeans_iterations_; }
+		inline int getNumberOfChecks() const { return number_of_checks_; }
+		inline size_t getNumberOfIndexedDescriptors() const { return index_mapping_.size(); }
+		inline const std::string& getIndexLoadFilename() const { return index_load_filename_; }
+		inline const std::string& getIndexSaveFilename() const { return index_save_filename_; }
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </gets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <sets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		inline void setIndexType(IndexType index_type) { index_type_ = index_type; }
+		inline void setNumberOfTrees(int number_of_trees) { number_of_trees_ = number_of_trees; }
+		inline void setBranchingFactor(int branching_factor) { branching_factor_ = branching_factor; }
+		inline void setNumberOfKMeansIterations(int number_of_kmeans_iterations) { number_of_kmeans_iterations_ = number_of_kmeans_iterations; }
+		inline void setNumberOfChecks(int number_of_checks) { number_of_checks_ = number_of_checks; }
+		inline void setIndexLoadFilename(const std::string& index_load_filename) { index_load_filename_ = index_load_filename; }
+		inline void setIndexSaveFilename(const std::string& index_save_filename) { index_save_filename_ = index_save_filename; }
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </sets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+	// ========================================================================   </public-section>  ===========================================================================
+
+	// ========================================================================   <protected-section>   ========================================================================
+	protected:
+		flann::flann_algorithm_t getFLANNAlgorithm() const;
+		flann::IndexParams getFLANNIndexParams() const;
+		flann::SearchParams getFLANNSearchParams() const;
+		bool loadIndex(const std::string& filename);
+		bool convertQuery(const FeatureT& point, std::vector<float>& query) const;
+
+		IndexType index_type_;
+		int number_of_trees_;
+		int branching_factor_;
+		int number_of_kmeans_iterations_;
+		int number_of_checks_;
+		std::string index_load_filename_;
+		std::string index_save_filename_;
+		int number_of_dimensions_;
+		std::vector<float> descriptors_data_;
+		std::vector<int> index_mapping_;
+		std::shared_ptr<FLANNIndex> flann_index_;
+	// ========================================================================   </protected-section>  ========================================================================
+};
+
+} /* namespace dynamic_robot_localization */
+
+
+#ifdef DRL_NO_PRECOMPILE
+#include <dynamic_robot_localization/cloud_matchers/feature_matchers/impl/descriptor_index.hpp>
+#endif
@@ -21,7 +21,9 @@
 
 // project includes
 #include <dynamic_robot_localization/common/pointcloud_conversions.h>
+#include <dynamic_robot_localization/common/tracer.h>
 #include <dynamic_robot_localization/cloud_matchers/cloud_matcher.h>
+#include <dynamic_robot_localization/cloud_matchers/feature_matchers/descriptor_index.h>
 #include <dynamic_robot_localization/cloud_matchers/feature_matchers/keypoint_descriptors/keypoint_descriptor.h>
 #include <dynamic_robot_localization/cloud_matchers/feature_matchers/keypoint_descriptors/fpfh.h>
 #include <dynamic_robot_localization/cloud_matchers/feature_matchers/keypoint_descriptors/shot.h>
@@ -54,13 +56,17 @@ class FeatureMatcher : public CloudMatcher<PointT> {
 		virtual void processKeypoints(typename pcl::PointCloud<PointT>::Ptr& pointcloud_keypoints,
 				typename pcl::PointCloud<PointT>::Ptr& surface,
 				typename pcl::search::KdTree<PointT>::Ptr& surface_search_method);
+		/*! Besides the base accounting, includes the reference descriptors and their index. */
+		virtual size_t accountMemoryUsage(MemoryUsage& memory_usage);
 
 		virtual void setMatcherReferenceDescriptors(typename pcl::PointCloud<FeatureT>::Ptr& reference_descriptors) = 0;
 		virtual void setMatcherAmbientDescriptors(typename pcl::PointCloud<FeatureT>::Ptr& ambient_descriptors) = 0;
+		virtual void setMatcherDescriptorsSearchMethod(typename pcl::KdTreeFLANN<FeatureT>::Ptr& descriptors_search_method) {}
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </FeatureMatcher-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <gets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 		const typename KeypointDescriptor<PointT, FeatureT>::Ptr getKeypointDescriptor() { return keypoint_descriptor_; }
+		const typename DescriptorIndex<FeatureT>::Ptr getDescriptorIndex() { return descriptor_index_; }
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </gets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <sets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
@@ -71,6 +77,8 @@ class FeatureMatcher : public CloudMatcher<PointT> {
 	// ========================================================================   <protected-section>   ========================================================================
 	protected:
 		typename KeypointDescriptor<PointT, FeatureT>::Ptr keypoint_descriptor_;
+		typename DescriptorIndex<FeatureT>::Ptr descriptor_index_;
+		typename pcl::PointCloud<FeatureT>::Ptr reference_descriptors_;
 		std::string reference_pointclouds_database_folder_path_;
 		std::string reference_pointcloud_descriptors_filename_;
 		std::string reference_pointcloud_descriptors_save_filename_;
@@ -171,6 +171,12 @@ namespace dynamic_robot_localization
       inline FeatureCloudConstPtr const 
       getTargetFeatures () { return (target_features_); }
 
+      /** \brief Set the search method used to find the target features similar to the source features (must be set before setTargetFeatures)
+        * \param feature_tree the feature search method
+        */
+      inline void
+      setFeatureSearchMethod (const FeatureKdTreePtr &feature_tree) { feature_tree_ = feature_tree; }
+
       /** \brief Set the minimum distances between samples
         * \param min_sample_distance the minimum distances between samples
         */
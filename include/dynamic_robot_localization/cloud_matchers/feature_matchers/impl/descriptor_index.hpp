@@ -0,0 +1,224 @@
+/**\file descriptor_index.hpp
+ * \brief Description...
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+#include <dynamic_robot_localization/cloud_matchers/feature_matchers/descriptor_index.h>
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+namespace dynamic_robot_localization {
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <imports>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </imports>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+// =============================================================================  <public-section>  ============================================================================
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <constructors-destructor>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+template<typename FeatureT>
+DescriptorIndex<FeatureT>::DescriptorIndex(IndexType index_type, int number_of_trees, int branching_factor, int number_of_kmeans_iterations, int number_of_checks) :
+	pcl::KdTreeFLANN<FeatureT>(true),
+	index_type_(index_type),
+	number_of_trees_(number_of_trees),
+	branching_factor_(branching_factor),
+	number_of_kmeans_iterations_(number_of_kmeans_iterations),
+	number_of_checks_(number_of_checks),
+	number_of_dimensions_(0) {}
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </constructors-destructor>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <DescriptorIndex-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+template<typename FeatureT>
+bool DescriptorIndex<FeatureT>::s_parseIndexType(const std::string& index_type_name, IndexType& index_type_out) {
+	if (index_type_name == "ExactKdTree") {
+		index_type_out = ExactKdTree;
+	} else if (index_type_name == "RandomizedKdForest") {
+		index_type_out = RandomizedKdForest;
+	} else if (index_type_name == "HierarchicalKMeans") {
+		index_type_out = HierarchicalKMeans;
+	} else {
+		return false;
+	}
+	return true;
+}
+
+
+template<typename FeatureT>
+size_t DescriptorIndex<FeatureT>::accountMemoryUsage(MemoryUsage& memory_usage) const {
+	if (!memory_usage.addObject(this)) { return 0; }
+	size_t bytes = memory_usage.addBytes(sizeof(*this) + MemoryUsage::s_getVectorBytes(descriptors_data_) + MemoryUsage::s_getVectorBytes(index_mapping_));
+	if (flann_index_) { bytes += memory_usage.addBytes(flann_index_.get(), (size_t)flann_index_->usedMemory()); }
+	return bytes;
+}
+
+
+template<typename FeatureT>
+void DescriptorIndex<FeatureT>::setInputCloud(const PointCloudConstPtr& cloud, const IndicesConstPtr& indices) {
+	this->input_ = cloud;
+	this->indices_ = indices;
+	flann_index_.reset();
+	descriptors_data_.clear();
+	index_mapping_.clear();
+	if (!cloud || cloud->empty() || !this->point_representation_) { return; }
+
+	number_of_dimensions_ = this->point_representation_->getNumberOfDimensions();
+	size_t number_of_descriptors = (indices ? indices->size() : cloud->size());
+	descriptors_data_.reserve(number_of_descriptors * number_of_dimensions_);
+	index_mapping_.reserve(number_of_descriptors);
+
+	std::vector<float> descriptor_data(number_of_dimensions_);
+	for (size_t i = 0; i < number_of_descriptors; ++i) {
+		int descriptor_index = (indices ? (*indices)[i] : (int)i);
+		const FeatureT& descriptor = (*cloud)[descriptor_index];
+		if (!this->point_representation_->isValid(descriptor)) { continue; }
+		this->point_representation_->vectorize(descriptor, descriptor_data);
+		descriptors_data_.insert(descriptors_data_.end(), descriptor_data.begin(), descriptor_data.end());
+		index_mapping_.push_back(descriptor_index);
+	}
+
+	if (index_mapping_.empty()) { return; }
+
+	flann::Matrix<float> dataset(descriptors_data_.data(), index_mapping_.size(), number_of_dimensions_);
+	if (!index_load_filename_.empty() && loadIndex(index_load_filename_)) {
+		ROS_DEBUG_STREAM("Loaded descriptor index with " << index_mapping_.size() << " descriptors from file " << index_load_filename_);
+		return;
+	}
+
+	flann_index_ = std::make_shared<FLANNIndex>(dataset, getFLANNIndexParams());
+	flann_index_->buildIndex();
+	ROS_DEBUG_STREAM("Built descriptor index with " << index_mapping_.size() << " descriptors");
+
+	if (!index_save_filename_.empty()) {
+		if (saveIndex(index_save_filename_)) {
+			ROS_INFO_STREAM("Saved descriptor index with " << index_mapping_.size() << " descriptors to file " << index_save_filename_);
+		} else {
+			ROS_WARN_STREAM("Failed to save descriptor index to file " << index_save_filename_);
+		}
+	}
+}
+
+
+template<typename FeatureT>
+bool DescriptorIndex<FeatureT>::saveIndex(const std::string& filename) const {
+	if (!flann_index_ || filename.empty()) { return false; }
+	try {
+		flann_index_->save(filename);
+	} catch (const std::exception& exception) {
+		ROS_WARN_STREAM("Exception when saving descriptor index: " << exception.what());
+		return false;
+	}
+	return true;
+}
+
+
+template<typename FeatureT>
+int DescriptorIndex<FeatureT>::nearestKSearch(const FeatureT& point, int k, std::vector<int>& k_indices, std::vector<float>& k_sqr_distances) const {
+	k_indices.clear();
+	k_sqr_distances.clear();
+	std::vector<float> query;
+	if (!flann_index_ || k <= 0 || !convertQuery(point, query)) { return 0; }
+
+	k = std::min(k, (int)index_mapping_.size());
+	k_indices.resize(k);
+	k_sqr_distances.resize(k);
+	flann::Matrix<float> query_matrix(query.data(), 1, number_of_dimensions_);
+	flann::Matrix<int> k_indices_matrix(k_indices.data(), 1, k);
+	flann::Matrix<float> k_sqr_distances_matrix(k_sqr_distances.data(), 1, k);
+	int number_of_neighbors = flann_index_->knnSearch(query_matrix, k_indices_matrix, k_sqr_distances_matrix, k, getFLANNSearchParams());
+
+	k_indices.resize(number_of_neighbors);
+	k_sqr_distances.resize(number_of_neighbors);
+	for (size_t i = 0; i < k_indices.size(); ++i) {
+		k_indices[i] = index_mapping_[k_indices[i]];
+	}
+	return number_of_neighbors;
+}
+
+
+template<typename FeatureT>
+int DescriptorIndex<FeatureT>::radiusSearch(const FeatureT& point, double radius, std::vector<int>& k_indices, std::vector<float>& k_sqr_distances, unsigned int max_nn) const {
+	k_indices.clear();
+	k_sqr_distances.clear();
+	std::vector<float> query;
+	if (!flann_index_ || !convertQuery(point, query)) { return 0; }
+
+	flann::SearchParams search_params = getFLANNSearchParams();
+	search_params.max_neighbors = (max_nn > 0 ? (int)max_nn : -1);
+	flann::Matrix<float> query_matrix(query.data(), 1, number_of_dimensions_);
+	std::vector< std::vector<int> > indices(1);
+	std::vector< std::vector<float> > sqr_distances(1);
+	int number_of_neighbors = flann_index_->radiusSearch(query_matrix, indices, sqr_distances, static_cast<float>(radius * radius), search_params);
+
+	k_indices.swap(indices[0]);
+	k_sqr_distances.swap(sqr_distances[0]);
+	for (size_t i = 0; i < k_indices.size(); ++i) {
+		k_indices[i] = index_mapping_[k_indices[i]];
+	}
+	return number_of_neighbors;
+}
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </DescriptorIndex-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// =============================================================================  </public-section>  ===========================================================================
+
+// =============================================================================   <protected-section>   =======================================================================
+template<typename FeatureT>
+flann::flann_algorithm_t DescriptorIndex<FeatureT>::getFLANNAlgorithm() const {
+	switch (index_type_) {
+		case RandomizedKdForest: return flann::FLANN_INDEX_KDTREE;
+		case HierarchicalKMeans: return flann::FLANN_INDEX_KMEANS;
+		default: return flann::FLANN_INDEX_KDTREE_SINGLE;
+	}
+}
+
+
+template<typename FeatureT>
+flann::IndexParams DescriptorIndex<FeatureT>::getFLANNIndexParams() const {
+	switch (index_type_) {
+		case RandomizedKdForest: return flann::KDTreeIndexParams(std::max(1, number_of_trees_));
+		case HierarchicalKMeans: return flann::KMeansIndexParams(std::max(2, branching_factor_), number_of_kmeans_iterations_);
+		default: return flann::KDTreeSingleIndexParams(15);
+	}
+}
+
+
+template<typename FeatureT>
+flann::SearchParams DescriptorIndex<FeatureT>::getFLANNSearchParams() const {
+	// the exact kd-tree must inspect all the leafs that may have closer neighbors
+	int number_of_checks = (index_type_ == ExactKdTree || number_of_checks_ <= 0) ? flann::FLANN_CHECKS_UNLIMITED : number_of_checks_;
+	flann::SearchParams search_params(number_of_checks, this->epsilon_, this->sorted_);
+	return search_params;
+}
+
+
+template<typename FeatureT>
+bool DescriptorIndex<FeatureT>::loadIndex(const std::string& filename) {
+	std::ifstream index_file(filename.c_str());
+	if (!index_file.good()) { return false; }
+	index_file.close();
+
+	flann::Matrix<float> dataset(descriptors_data_.data(), index_mapping_.size(), number_of_dimensions_);
+	try {
+		// FLANN checks if the number and size of the descriptors match the ones used to build the saved index
+		std::shared_ptr<FLANNIndex> flann_index = std::make_shared<FLANNIndex>(dataset, flann::SavedIndexParams(filename));
+		if (flann_index->getType() != getFLANNAlgorithm()) {
+			ROS_INFO_STREAM("Descriptor index in file " << filename << " was built with a different algorithm");
+			return false;
+		}
+		flann_index_ = flann_index;
+	} catch (const std::exception& exception) {
+		ROS_WARN_STREAM("Failed to load descriptor index from file " << filename << ": " << exception.what());
+		return false;
+	}
+	return true;
+}
+
+
+template<typename FeatureT>
+bool DescriptorIndex<FeatureT>::convertQuery(const FeatureT& point, std::vector<float>& query) const {
+	if (!this->point_representation_ || !this->point_representation_->isValid(point)) { return false; }
+	query.resize(number_of_dimensions_);
+	this->point_representation_->vectorize(point, query);
+	return true;
+}
+// =============================================================================   </protected-section>  =======================================================================
+
+} /* namespace dynamic_robot_localization */
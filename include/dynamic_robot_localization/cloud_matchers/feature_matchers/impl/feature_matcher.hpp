@@ -30,6 +30,22 @@ void FeatureMatcher<PointT, FeatureT>::setupConfigurationFromParameterServer(ros
 	if (ros::param::search(search_namespace, "reference_pointcloud_descriptors_save_filename", final_param_name)) { private_node_handle->param(final_param_name, reference_pointcloud_descriptors_save_filename_, std::string("")); }
 	if (ros::param::search(search_namespace, "save_descriptors_in_binary_format", final_param_name)) { private_node_handle->param(final_param_name, save_descriptors_in_binary_format_, true); }
 
+	std::string descriptor_index_type_name;
+	private_node_handle->param(configuration_namespace + "descriptor_index/type", descriptor_index_type_name, std::string(""));
+	typename DescriptorIndex<FeatureT>::IndexType descriptor_index_type;
+	if (DescriptorIndex<FeatureT>::s_parseIndexType(descriptor_index_type_name, descriptor_index_type)) {
+		int number_of_trees, branching_factor, number_of_kmeans_iterations, number_of_checks;
+		private_node_handle->param(configuration_namespace + "descriptor_index/number_of_trees", number_of_trees, 4);
+		private_node_handle->param(configuration_namespace + "descriptor_index/branching_factor", branching_factor, 32);
+		private_node_handle->param(configuration_namespace + "descriptor_index/number_of_kmeans_iterations", number_of_kmeans_iterations, 11);
+		private_node_handle->param(configuration_namespace + "descriptor_index/number_of_checks", number_of_checks, 128);
+		descriptor_index_ = typename DescriptorIndex<FeatureT>::Ptr(new DescriptorIndex<FeatureT>(descriptor_index_type, number_of_trees, branching_factor, number_of_kmeans_iterations, number_of_checks));
+		typename pcl::KdTreeFLANN<FeatureT>::Ptr descriptors_search_method = descriptor_index_;
+		setMatcherDescriptorsSearchMethod(descriptors_search_method);
+	} else if (!descriptor_index_type_name.empty()) {
+		ROS_WARN_STREAM("Descriptor index type [" << descriptor_index_type_name << "] is not supported (using exact kd-tree from PCL)");
+	}
+
 	CloudMatcher<PointT>::setDisplayCloudAligment(display_feature_matching);
 
 	CloudMatcher<PointT>::setupConfigurationFromParameterServer(node_handle, private_node_handle, configuration_namespace);
@@ -47,6 +63,10 @@ void FeatureMatcher<PointT, FeatureT>::setupReferenceCloud(typename pcl::PointCl
 	CloudMatcher<PointT>::reference_cloud_keypoints_ = reference_cloud_keypoints;
 	CloudMatcher<PointT>::search_method_ = search_method;
 
+	if (CloudMatcher<PointT>::reference_cloud_publisher_ && reference_cloud) {
+		CloudMatcher<PointT>::reference_cloud_publisher_->setReferencePointCloud(reference_cloud);
+	}
+
 	typename pcl::PointCloud<PointT>::Ptr& reference_cloud_final = reference_cloud_keypoints->empty() ? reference_cloud : reference_cloud_keypoints;
 
 	// subclass must set cloud_matcher_ ptr
@@ -60,18 +80,32 @@ void FeatureMatcher<PointT, FeatureT>::setupReferenceCloud(typename pcl::PointCl
 	}
 
 	typename pcl::PointCloud<FeatureT>::Ptr reference_descriptors(new pcl::PointCloud<FeatureT>());
+	bool reference_descriptors_loaded_from_file = false;
 	if (reference_pointcloud_descriptors_filename_.empty() || !pointcloud_conversions::fromFile(*reference_descriptors, reference_pointcloud_descriptors_filename_, reference_pointclouds_database_folder_path_)) {
-		if (keypoint_descriptor_) // must be set previously
+		if (keypoint_descriptor_) { // must be set previously
+			DRL_TRACE_SCOPE_OBJECT("keypoint_descriptors", *keypoint_descriptor_);
 			reference_descriptors = keypoint_descriptor_->computeKeypointsDescriptors(reference_cloud_final, reference_cloud, search_method);
+		}
 	} else {
 		ROS_INFO_STREAM("Loaded " << reference_descriptors->size() << " keypoint descriptors from file " << reference_pointcloud_descriptors_filename_);
+		reference_descriptors_loaded_from_file = true;
 	}
 
-	if (!reference_pointcloud_descriptors_save_filename_.empty() && !reference_descriptors->empty()) {
-		ROS_INFO_STREAM("Saving " << reference_descriptors->size() << " reference pointcloud keypoint descriptors to file " << reference_pointcloud_descriptors_save_filename_);
-		pcl::io::savePCDFile<FeatureT>(reference_pointcloud_descriptors_save_filename_, *reference_descriptors, save_descriptors_in_binary_format_);
+	// the saved descriptors are resolved against the database folder in the same way as the loaded ones, in order to be found again with the same relative filename
+	std::string reference_pointcloud_descriptors_save_filepath = pointcloud_utils::parseFilePath(reference_pointcloud_descriptors_save_filename_, reference_pointclouds_database_folder_path_);
+
+	if (descriptor_index_) {
+		// the index is saved next to the descriptors and can only be reused with the descriptors it was built from
+		descriptor_index_->setIndexLoadFilename(reference_descriptors_loaded_from_file ? pointcloud_utils::parseFilePath(reference_pointcloud_descriptors_filename_, reference_pointclouds_database_folder_path_) + ".flann_index" : std::string(""));
+		descriptor_index_->setIndexSaveFilename(reference_pointcloud_descriptors_save_filepath.empty() ? std::string("") : reference_pointcloud_descriptors_save_filepath + ".flann_index");
 	}
 
+	if (!reference_pointcloud_descriptors_save_filepath.empty() && !reference_descriptors->empty()) {
+		ROS_INFO_STREAM("Saving " << reference_descriptors->size() << " reference pointcloud keypoint descriptors to file " << reference_pointcloud_descriptors_save_filepath);
+		pcl::io::savePCDFile<FeatureT>(reference_pointcloud_descriptors_save_filepath, *reference_descriptors, save_descriptors_in_binary_format_);
+	}
+
+	reference_descriptors_ = reference_descriptors;
 	setMatcherReferenceDescriptors(reference_descriptors);
 }
 
@@ -82,11 +116,20 @@ void FeatureMatcher<PointT, FeatureT>::initializeKeypointProcessing() {
 }
 
 
+template<typename PointT, typename FeatureT>
+size_t FeatureMatcher<PointT, FeatureT>::accountMemoryUsage(MemoryUsage& memory_usage) {
+	size_t bytes = CloudMatcher<PointT>::accountMemoryUsage(memory_usage) + memory_usage.addPointCloud(reference_descriptors_.get());
+	if (descriptor_index_) { bytes += descriptor_index_->accountMemoryUsage(memory_usage); }
+	return bytes;
+}
+
+
 template<typename PointT, typename FeatureT>
 void FeatureMatcher<PointT, FeatureT>::processKeypoints(typename pcl::PointCloud<PointT>::Ptr& pointcloud_keypoints,
 		typename pcl::PointCloud<PointT>::Ptr& surface,
 		typename pcl::search::KdTree<PointT>::Ptr& surface_search_method) {
 
+	DRL_TRACE_SCOPE_OBJECT("keypoint_descriptors", *keypoint_descriptor_);
 	typename pcl::PointCloud<FeatureT>::Ptr ambient_descriptors = keypoint_descriptor_->computeKeypointsDescriptors(pointcloud_keypoints, surface, surface_search_method);
 	setMatcherAmbientDescriptors(ambient_descriptors);
 	CloudMatcher<PointT>::setMatchOnlyKeypoints(true);
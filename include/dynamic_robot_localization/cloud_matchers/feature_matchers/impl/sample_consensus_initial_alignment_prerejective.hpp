@@ -61,6 +61,22 @@ void SampleConsensusInitialAlignmentPrerejective<PointT, FeatureT>::setupConfigu
 	private_node_handle->param(configuration_namespace + "correspondence_randomness", correspondence_randomness, 3);
 	matcher_scia_->setCorrespondenceRandomness(correspondence_randomness);
 
+	int progressive_evaluation_number_of_points;
+	private_node_handle->param(configuration_namespace + "progressive_evaluation_number_of_points", progressive_evaluation_number_of_points, 0);
+	matcher_scia_->setProgressiveEvaluationNumberOfPoints(progressive_evaluation_number_of_points);
+
+	double sprt_bad_hypothesis_inlier_fraction_ratio;
+	private_node_handle->param(configuration_namespace + "sprt_bad_hypothesis_inlier_fraction_ratio", sprt_bad_hypothesis_inlier_fraction_ratio, 0.5);
+	matcher_scia_->setSPRTBadHypothesisInlierFractionRatio(sprt_bad_hypothesis_inlier_fraction_ratio);
+
+	double sprt_rejection_likelihood_ratio;
+	private_node_handle->param(configuration_namespace + "sprt_rejection_likelihood_ratio", sprt_rejection_likelihood_ratio, 100.0);
+	matcher_scia_->setSPRTRejectionLikelihoodRatio(sprt_rejection_likelihood_ratio);
+
+	int number_of_hypotheses_promoted_to_full_evaluation;
+	private_node_handle->param(configuration_namespace + "number_of_hypotheses_promoted_to_full_evaluation", number_of_hypotheses_promoted_to_full_evaluation, 0);
+	matcher_scia_->setNumberOfHypothesesPromotedToFullEvaluation(number_of_hypotheses_promoted_to_full_evaluation);
+
 	FeatureMatcher<PointT, FeatureT>::setupConfigurationFromParameterServer(node_handle, private_node_handle, configuration_namespace);
 }
 
@@ -76,6 +92,22 @@ void SampleConsensusInitialAlignmentPrerejective<PointT, FeatureT>::setMatcherAm
 	matcher_scia_->setSourceFeatures(ambient_descriptors);
 	matcher_scia_->setNumberOfSamples(std::min(number_of_samples_, (int)ambient_descriptors->size()));
 }
+
+
+template<typename PointT, typename FeatureT>
+void SampleConsensusInitialAlignmentPrerejective<PointT, FeatureT>::setMatcherDescriptorsSearchMethod(typename pcl::KdTreeFLANN<FeatureT>::Ptr& descriptors_search_method) {
+	matcher_scia_->setFeatureSearchMethod(descriptors_search_method);
+}
+
+
+template<typename PointT, typename FeatureT>
+std::string SampleConsensusInitialAlignmentPrerejective<PointT, FeatureT>::getMatcherConvergenceState() {
+	std::stringstream convergence_state;
+	convergence_state << "hypotheses [ evaluated: " << matcher_scia_->getNumberOfEvaluatedHypotheses()
+			<< " | early rejected: " << matcher_scia_->getNumberOfEarlyRejectedHypotheses()
+			<< " | promoted: " << matcher_scia_->getNumberOfPromotedHypotheses() << " ]";
+	return convergence_state.str();
+}
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </SampleConsensusInitialAlignmentPrerejective-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 // =============================================================================  </public-section>  ===========================================================================
 
@@ -367,6 +367,25 @@ template<typename PointSource, typename PointTarget, typename FeatureT> void Sam
 
 	//double highest_inlier_fraction = 0.0;
 	accepted_transformations_->clear();
+	number_of_evaluated_hypotheses_ = 0;
+	number_of_early_rejected_hypotheses_ = 0;
+	number_of_promoted_hypotheses_ = 0;
+
+	// random subset of the source points in which the hypotheses are evaluated before the full cloud evaluation
+	bool progressive_evaluation_enabled = progressive_evaluation_number_of_points_ > 0;
+	progressive_evaluation_indices_.clear();
+	if (progressive_evaluation_enabled) {
+		std::vector<int> source_indices(input_->size());
+		std::iota(source_indices.begin(), source_indices.end(), 0);
+		size_t number_of_points = std::min((size_t)progressive_evaluation_number_of_points_, source_indices.size());
+		for (size_t i = 0; i < number_of_points; ++i) {
+			std::swap(source_indices[i], source_indices[i + getRandomIndex(static_cast<int>(source_indices.size() - i))]);
+		}
+		progressive_evaluation_indices_.assign(source_indices.begin(), source_indices.begin() + number_of_points);
+	}
+
+	using HypothesisCandidate = std::pair< double, std::pair< Matrix4, pcl::CorrespondencesPtr > >;
+	std::vector< HypothesisCandidate, Eigen::aligned_allocator<HypothesisCandidate> > hypotheses_candidates;
 
 	#pragma omp parallel for
 	for (int i = 0; i < max_iterations_; ++i) {
@@ -424,49 +443,49 @@ template<typename PointSource, typename PointTarget, typename FeatureT> void Sam
 				//			#pragma omp critical
 				transformation_estimation.estimateRigidTransformation(*input_, *target_, *filtered_corrs, transformation);
 
-				// Transform the input dataset using the final transformation
-				PointCloudSource input_transformed;
-				pcl::transformPointCloudWithNormals(*input_, input_transformed, transformation);
-
-				std::vector<int> inliers;
-				double error;
+				#pragma omp atomic
+				++number_of_evaluated_hypotheses_;
 
-				// Transform the input and compute the error (uses input_ and final_transformation_)
-				getFitness(input_transformed, inliers, error);
-
-				if (inliers.size() > 2) {
-					double current_inlier_fraction = 0.0;
-					if (!input_->empty()) {
-						current_inlier_fraction = static_cast<double>(inliers.size()) / static_cast<double>(input_->size());
-					}
-
-					if (update_visualizer_ != 0) {
-						std::vector<int> sample_indices_filtered, corresponding_indices_filtered;
-						for (size_t i = 0; i < filtered_corrs->size(); ++i) {
-							sample_indices_filtered.push_back((*filtered_corrs)[i].index_query);
-							corresponding_indices_filtered.push_back((*filtered_corrs)[i].index_match);
-						}
+				if (progressive_evaluation_enabled) {
+					double subset_inlier_fraction;
+					if (evaluateHypothesisProgressively(transformation, subset_inlier_fraction)) {
 						#pragma omp critical
-						update_visualizer_(input_transformed, sample_indices_filtered, *target_, corresponding_indices_filtered);
-					}
-
-					// Update result if pose hypothesis is better
-					#pragma omp critical
-					if (current_inlier_fraction >= inlier_fraction_ && error < inlier_rmse_) {
-						accepted_transformations_->push_back(transformation);
-						if (error < lowest_error) {
-							//highest_inlier_fraction = current_inlier_fraction;
-							inliers_ = inliers;
-							lowest_error = error;
-							converged_ = true;
-							final_transformation_ = transformation;
-							transformation_ = transformation;
-						}
+						hypotheses_candidates.push_back(HypothesisCandidate(subset_inlier_fraction, std::make_pair(transformation, filtered_corrs)));
+					} else {
+						#pragma omp atomic
+						++number_of_early_rejected_hypotheses_;
 					}
+				} else {
+					#pragma omp atomic
+					++number_of_promoted_hypotheses_;
+					evaluateHypothesis(transformation, *filtered_corrs, lowest_error);
 				}
 			}
 //		}
 	}
+
+	if (progressive_evaluation_enabled) {
+		// only the hypotheses with the highest inlier fraction in the points subset are evaluated in the full cloud
+		// (sorted in order to evaluate the most promising hypotheses first when the convergence time limit is reached)
+		size_t number_of_promoted_hypotheses = hypotheses_candidates.size();
+		if (number_of_hypotheses_promoted_to_full_evaluation_ > 0 && (size_t)number_of_hypotheses_promoted_to_full_evaluation_ < number_of_promoted_hypotheses) {
+			number_of_promoted_hypotheses = (size_t)number_of_hypotheses_promoted_to_full_evaluation_;
+		}
+		std::partial_sort(hypotheses_candidates.begin(), hypotheses_candidates.begin() + number_of_promoted_hypotheses, hypotheses_candidates.end(),
+				[](const HypothesisCandidate& a, const HypothesisCandidate& b) { return a.first > b.first; });
+		number_of_promoted_hypotheses_ = 0;
+
+		#pragma omp parallel for
+		for (int i = 0; i < (int)number_of_promoted_hypotheses; ++i) {
+			if (convergence_timer_.getTimeSeconds() > convergence_time_limit_seconds_) {
+				continue;
+			}
+
+			#pragma omp atomic
+			++number_of_promoted_hypotheses_;
+			evaluateHypothesis(hypotheses_candidates[i].second.first, *hypotheses_candidates[i].second.second, lowest_error);
+		}
+	}
 #endif //--------------------------------------------------------------------------------------------------------------------------------
 
 
@@ -476,7 +495,97 @@ template<typename PointSource, typename PointTarget, typename FeatureT> void Sam
 	if (converged_) pcl::transformPointCloudWithNormals(*input_, output, final_transformation_);
 
 	// Debug output
-	PCL_DEBUG("[pcl::%s::computeTransformation] Accepted %i out of %i generated pose hypotheses.\n", getClassName().c_str(), accepted_transformations_->size(), max_iterations_);
+	PCL_DEBUG("[pcl::%s::computeTransformation] Accepted %lu out of %i generated pose hypotheses (%lu evaluated | %lu early rejected | %lu promoted to full evaluation).\n", getClassName().c_str(),
+			accepted_transformations_->size(), max_iterations_, number_of_evaluated_hypotheses_, number_of_early_rejected_hypotheses_, number_of_promoted_hypotheses_);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointSource, typename PointTarget, typename FeatureT> bool SampleConsensusPrerejective<PointSource, PointTarget, FeatureT>::evaluateHypothesisProgressively(
+		const Matrix4& transformation, double& subset_inlier_fraction) const {
+	subset_inlier_fraction = 0.0;
+	if (progressive_evaluation_indices_.empty()) { return false; }
+
+	const float max_range = corr_dist_threshold_ * corr_dist_threshold_;
+	bool normals_difference_validation_enabled = max_normals_angular_difference_in_degrees_ > 0.0f;
+	float cos_angle_max_normals_angular_difference_in_radians = normals_difference_validation_enabled ? std::cos(pcl::deg2rad(max_normals_angular_difference_in_degrees_)) : 0.0f;
+
+	// Wald's sequential probability ratio test between a good hypothesis (inlier probability equal to the required inlier fraction)
+	// and a bad hypothesis (inlier probability equal to a fraction of the required inlier fraction)
+	double good_hypothesis_inlier_probability = inlier_fraction_;
+	double bad_hypothesis_inlier_probability = inlier_fraction_ * sprt_bad_hypothesis_inlier_fraction_ratio_;
+	bool sprt_enabled = good_hypothesis_inlier_probability > 0.0 && good_hypothesis_inlier_probability < 1.0
+			&& sprt_bad_hypothesis_inlier_fraction_ratio_ > 0.0f && sprt_bad_hypothesis_inlier_fraction_ratio_ < 1.0f && sprt_rejection_likelihood_ratio_ > 1.0;
+	double log_likelihood_ratio_inlier = sprt_enabled ? std::log(bad_hypothesis_inlier_probability / good_hypothesis_inlier_probability) : 0.0;
+	double log_likelihood_ratio_outlier = sprt_enabled ? std::log((1.0 - bad_hypothesis_inlier_probability) / (1.0 - good_hypothesis_inlier_probability)) : 0.0;
+	double log_rejection_likelihood_ratio = sprt_enabled ? std::log(sprt_rejection_likelihood_ratio_) : 0.0;
+
+	Eigen::Affine3f transform(transformation);
+	std::vector<int> nn_indices;
+	std::vector<float> nn_dists;
+	float squared_distance;
+	size_t number_of_inliers = 0;
+	double log_likelihood_ratio = 0.0;
+	for (size_t i = 0; i < progressive_evaluation_indices_.size(); ++i) {
+		PointSource point = pcl::transformPointWithNormal((*input_)[progressive_evaluation_indices_[i]], transform);
+		if (isInlier(point, max_range, normals_difference_validation_enabled, cos_angle_max_normals_angular_difference_in_radians, nn_indices, nn_dists, squared_distance)) {
+			++number_of_inliers;
+			log_likelihood_ratio += log_likelihood_ratio_inlier;
+		} else {
+			log_likelihood_ratio += log_likelihood_ratio_outlier;
+		}
+
+		if (sprt_enabled && log_likelihood_ratio > log_rejection_likelihood_ratio) {
+			return false;
+		}
+	}
+
+	subset_inlier_fraction = static_cast<double>(number_of_inliers) / static_cast<double>(progressive_evaluation_indices_.size());
+	return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointSource, typename PointTarget, typename FeatureT> void SampleConsensusPrerejective<PointSource, PointTarget, FeatureT>::evaluateHypothesis(
+		const Matrix4& transformation, const pcl::Correspondences& correspondences, double& lowest_error) {
+	// Transform the input dataset using the final transformation
+	PointCloudSource input_transformed;
+	pcl::transformPointCloudWithNormals(*input_, input_transformed, transformation);
+
+	std::vector<int> inliers;
+	double error;
+
+	// Transform the input and compute the error (uses input_ and final_transformation_)
+	getFitness(input_transformed, inliers, error);
+
+	if (inliers.size() > 2) {
+		double current_inlier_fraction = 0.0;
+		if (!input_->empty()) {
+			current_inlier_fraction = static_cast<double>(inliers.size()) / static_cast<double>(input_->size());
+		}
+
+		if (update_visualizer_ != 0) {
+			std::vector<int> sample_indices_filtered, corresponding_indices_filtered;
+			for (size_t i = 0; i < correspondences.size(); ++i) {
+				sample_indices_filtered.push_back(correspondences[i].index_query);
+				corresponding_indices_filtered.push_back(correspondences[i].index_match);
+			}
+			#pragma omp critical
+			update_visualizer_(input_transformed, sample_indices_filtered, *target_, corresponding_indices_filtered);
+		}
+
+		// Update result if pose hypothesis is better
+		#pragma omp critical
+		if (current_inlier_fraction >= inlier_fraction_ && error < inlier_rmse_) {
+			accepted_transformations_->push_back(transformation);
+			if (error < lowest_error) {
+				//highest_inlier_fraction = current_inlier_fraction;
+				inliers_ = inliers;
+				lowest_error = error;
+				converged_ = true;
+				final_transformation_ = transformation;
+				transformation_ = transformation;
+			}
+		}
+	}
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -493,45 +602,17 @@ template<typename PointSource, typename PointTarget, typename FeatureT> void Sam
 	float cos_angle_max_normals_angular_difference_in_radians = normals_difference_validation_enabled ? std::cos(pcl::deg2rad(max_normals_angular_difference_in_degrees_)) : 0.0f;
 
 	// For each point in the source dataset
+	std::vector<int> nn_indices;
+	std::vector<float> nn_dists;
+	float squared_distance;
 	for (size_t i = 0; i < input_transformed.size(); ++i) {
-		// Find its nearest neighbor in the target
-		const PointSource& point = input_transformed.points[i];
-		std::vector<int> nn_indices;
-		std::vector<float> nn_dists;
-		int number_of_neighbors_found = 0;
-
-		if (normals_difference_validation_enabled) {
-			number_of_neighbors_found = tree_->radiusSearch(point, corr_dist_threshold_, nn_indices, nn_dists);
-		} else {
-			nn_indices.resize(1);
-			nn_dists.resize(1);
-			number_of_neighbors_found = tree_->nearestKSearch(point, 1, nn_indices, nn_dists);
-		}
-
 		// Check if point is an inlier
-		if (number_of_neighbors_found > 0 && nn_dists[0] < max_range) {
-			bool valid_normal = false;
-			if (normals_difference_validation_enabled) {
-				for (int j = 0; j < number_of_neighbors_found; ++j) {
-					const PointTarget& point_neighbor = tree_->getInputCloud()->at(nn_indices[j]);
-					float cos_angle =
-						point.normal_x * point_neighbor.normal_x +
-						point.normal_y * point_neighbor.normal_y +
-						point.normal_z * point_neighbor.normal_z;
-					// ROS_DEBUG_STREAM("point.normal_x: " << point.normal_x << " | point.normal_y: " << point.normal_y << " | point.normal_z: " << point.normal_z);
-					// ROS_DEBUG_STREAM("point_neighbor.normal_x: " << point_neighbor.normal_x << " | point_neighbor.normal_y: " << point_neighbor.normal_y << " | point_neighbor.normal_z: " << point_neighbor.normal_z);
-					valid_normal = cos_angle > cos_angle_max_normals_angular_difference_in_radians;
-					if (valid_normal) break;
-				}
-			}
-
-			if (!normals_difference_validation_enabled || (normals_difference_validation_enabled && valid_normal)) {
-				// Update inliers
-				inliers.push_back(static_cast<int>(i));
+		if (isInlier(input_transformed.points[i], max_range, normals_difference_validation_enabled, cos_angle_max_normals_angular_difference_in_radians, nn_indices, nn_dists, squared_distance)) {
+			// Update inliers
+			inliers.push_back(static_cast<int>(i));
 
-				// Update fitness score
-				fitness_score += nn_dists[0];
-			}
+			// Update fitness score
+			fitness_score += squared_distance;
 		}
 	}
 
@@ -544,6 +625,38 @@ template<typename PointSource, typename PointTarget, typename FeatureT> void Sam
 	}
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointSource, typename PointTarget, typename FeatureT> bool SampleConsensusPrerejective<PointSource, PointTarget, FeatureT>::isInlier(
+		const PointSource& point, float max_range, bool normals_difference_validation_enabled, float cos_angle_max_normals_angular_difference,
+		std::vector<int>& nn_indices, std::vector<float>& nn_dists, float& squared_distance) const {
+	// Find its nearest neighbor in the target
+	int number_of_neighbors_found = 0;
+
+	if (normals_difference_validation_enabled) {
+		number_of_neighbors_found = tree_->radiusSearch(point, corr_dist_threshold_, nn_indices, nn_dists);
+	} else {
+		nn_indices.resize(1);
+		nn_dists.resize(1);
+		number_of_neighbors_found = tree_->nearestKSearch(point, 1, nn_indices, nn_dists);
+	}
+
+	if (number_of_neighbors_found > 0 && nn_dists[0] < max_range) {
+		squared_distance = nn_dists[0];
+		if (!normals_difference_validation_enabled) { return true; }
+
+		for (int j = 0; j < number_of_neighbors_found; ++j) {
+			const PointTarget& point_neighbor = tree_->getInputCloud()->at(nn_indices[j]);
+			float cos_angle =
+				point.normal_x * point_neighbor.normal_x +
+				point.normal_y * point_neighbor.normal_y +
+				point.normal_z * point_neighbor.normal_z;
+			if (cos_angle > cos_angle_max_normals_angular_difference) { return true; }
+		}
+	}
+
+	return false;
+}
+
 template<typename PointSource, typename PointTarget, typename FeatureT>
 void SampleConsensusPrerejective<PointSource, PointTarget, FeatureT>::setupCorrespondanceRejectors(std::vector< typename pcl::registration::CorrespondenceRejector::Ptr >& correspondence_rejectors) {
 	typename pcl::registration::CorrespondenceRejectorOneToOne::Ptr corr_rej_o2o(new pcl::registration::CorrespondenceRejectorOneToOne());
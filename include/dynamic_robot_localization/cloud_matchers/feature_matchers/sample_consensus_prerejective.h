@@ -42,8 +42,12 @@
 #define PCL_REGISTRATION_SAMPLE_CONSENSUS_PREREJECTIVE_H_
 
 #include <algorithm>
+#include <cmath>
 #include <limits>
 #include <memory>
+#include <numeric>
+#include <utility>
+#include <vector>
 #include <pcl/registration/registration.h>
 #include <pcl/registration/transformation_estimation_svd.h>
 #include <pcl/registration/transformation_validation.h>
@@ -155,6 +159,13 @@ namespace dynamic_robot_localization
         , max_normals_angular_difference_in_degrees_(10.0f)
         , accepted_transformations_(new std::vector<Matrix4>())
         , convergence_time_limit_seconds_(std::numeric_limits<double>::max())
+        , progressive_evaluation_number_of_points_(0)
+        , sprt_bad_hypothesis_inlier_fraction_ratio_(0.5f)
+        , sprt_rejection_likelihood_ratio_(100.0)
+        , number_of_hypotheses_promoted_to_full_evaluation_(0)
+        , number_of_evaluated_hypotheses_(0)
+        , number_of_early_rejected_hypotheses_(0)
+        , number_of_promoted_hypotheses_(0)
       {
         reg_name_ = "SampleConsensusPrerejective";
         correspondence_rejector_poly_->setSimilarityThreshold (0.6f);
@@ -193,6 +204,15 @@ namespace dynamic_robot_localization
         return (target_features_);
       }
 
+      /** \brief Set the search method used to find the target features similar to the source features (must be set before setTargetFeatures)
+        * \param feature_tree the feature search method
+        */
+      inline void
+      setFeatureSearchMethod (const FeatureKdTreePtr &feature_tree)
+      {
+        feature_tree_ = feature_tree;
+      }
+
       /** \brief Set the number of samples to use during each iteration
         * \param nr_samples the number of samples to use during each iteration
         */
@@ -302,6 +322,36 @@ namespace dynamic_robot_localization
 
       inline void setConvergenceTimeLimitSeconds(double convergence_time_limit_seconds) { convergence_time_limit_seconds_ = convergence_time_limit_seconds; }
 
+      /** \brief Set the number of randomly selected source points in which each pose hypothesis is evaluated before being promoted to the full cloud evaluation
+       * (disabled by default, because the early rejection of the sequential probability ratio test may discard hypotheses that the full evaluation would accept)
+       * \param progressive_evaluation_number_of_points number of points (<= 0 disables the progressive evaluation)
+       */
+      inline void setProgressiveEvaluationNumberOfPoints(int progressive_evaluation_number_of_points) { progressive_evaluation_number_of_points_ = progressive_evaluation_number_of_points; }
+
+      /** \brief Set the inlier fraction of bad hypotheses used in the sequential probability ratio test, as a ratio of the required inlier fraction
+       * \param sprt_bad_hypothesis_inlier_fraction_ratio ratio in ]0,1[ (values outside this range disable the early rejection)
+       */
+      inline void setSPRTBadHypothesisInlierFractionRatio(float sprt_bad_hypothesis_inlier_fraction_ratio) { sprt_bad_hypothesis_inlier_fraction_ratio_ = sprt_bad_hypothesis_inlier_fraction_ratio; }
+
+      /** \brief Set the likelihood ratio (bad over good hypothesis) above which a hypothesis is rejected during the progressive evaluation
+       * \param sprt_rejection_likelihood_ratio likelihood ratio (> 1)
+       */
+      inline void setSPRTRejectionLikelihoodRatio(double sprt_rejection_likelihood_ratio) { sprt_rejection_likelihood_ratio_ = sprt_rejection_likelihood_ratio; }
+
+      /** \brief Set the number of hypotheses with the highest inlier fraction in the progressive evaluation that are evaluated in the full cloud
+       * \param number_of_hypotheses_promoted_to_full_evaluation number of hypotheses (<= 0 promotes all the hypotheses that were not rejected)
+       */
+      inline void setNumberOfHypothesesPromotedToFullEvaluation(int number_of_hypotheses_promoted_to_full_evaluation) { number_of_hypotheses_promoted_to_full_evaluation_ = number_of_hypotheses_promoted_to_full_evaluation; }
+
+      /** \brief Number of pose hypotheses (that survived the correspondence rejectors) evaluated in the last alignment */
+      inline size_t getNumberOfEvaluatedHypotheses() const { return number_of_evaluated_hypotheses_; }
+
+      /** \brief Number of pose hypotheses rejected by the sequential probability ratio test in the last alignment */
+      inline size_t getNumberOfEarlyRejectedHypotheses() const { return number_of_early_rejected_hypotheses_; }
+
+      /** \brief Number of pose hypotheses evaluated in the full cloud in the last alignment */
+      inline size_t getNumberOfPromotedHypotheses() const { return number_of_promoted_hypotheses_; }
+
     protected:
       /** \brief Choose a random index between 0 and n-1
         * \param n the number of possible indices to choose from
@@ -349,6 +399,25 @@ namespace dynamic_robot_localization
       void 
       getFitness (PointCloudSource& input_transformed, std::vector<int>& inliers, double& fitness_score);
 
+      /** \brief Checks if a transformed source point has a neighbor in the target within corr_dist_threshold_ (with similar normal, if enabled)
+        * \param squared_distance squared distance to the closest neighbor
+        */
+      bool
+      isInlier (const PointSource& point, float max_range, bool normals_difference_validation_enabled, float cos_angle_max_normals_angular_difference,
+              std::vector<int>& nn_indices, std::vector<float>& nn_dists, float& squared_distance) const;
+
+      /** \brief Evaluates a pose hypothesis in the progressive_evaluation_indices_ (transforming only these points) and rejects it as soon
+        * as the sequential probability ratio test concludes that its inlier fraction is more likely to be from a bad hypothesis
+        * \param subset_inlier_fraction inlier fraction in the evaluated points
+        * \return false if the hypothesis was rejected
+        */
+      bool
+      evaluateHypothesisProgressively (const Matrix4& transformation, double& subset_inlier_fraction) const;
+
+      /** \brief Evaluates a pose hypothesis in the full source cloud and updates the accepted transformations and the best result */
+      void
+      evaluateHypothesis (const Matrix4& transformation, const pcl::Correspondences& correspondences, double& lowest_error);
+
       /** \brief The source point cloud's feature descriptors. */
       FeatureCloudConstPtr input_features_;
 
@@ -382,6 +451,16 @@ namespace dynamic_robot_localization
 
       pcl::StopWatch convergence_timer_;
       double convergence_time_limit_seconds_;
+
+      /** \brief Progressive evaluation of pose hypotheses */
+      int progressive_evaluation_number_of_points_;
+      float sprt_bad_hypothesis_inlier_fraction_ratio_;
+      double sprt_rejection_likelihood_ratio_;
+      int number_of_hypotheses_promoted_to_full_evaluation_;
+      std::vector<int> progressive_evaluation_indices_;
+      size_t number_of_evaluated_hypotheses_;
+      size_t number_of_early_rejected_hypotheses_;
+      size_t number_of_promoted_hypotheses_;
   };
 
 } /* namespace dynamic_robot_localization */
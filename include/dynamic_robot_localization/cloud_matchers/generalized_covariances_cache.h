@@ -0,0 +1,214 @@
+#pragma once
+
+/**\file generalized_covariances_cache.h
+ * \brief Cache of the point covariances used by Generalized ICP, that is updated incrementally when the reference point cloud changes
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>  <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// std includes
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// ROS includes
+#include <ros/ros.h>
+
+// PCL includes
+#include <pcl/common/point_tests.h>
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+#include <pcl/search/kdtree.h>
+
+// external libs includes
+#include <Eigen/Core>
+#include <Eigen/SVD>
+#include <Eigen/StdVector>
+
+// project includes
+#include <dynamic_robot_localization/common/memory_usage.h>
+#include <dynamic_robot_localization/common/performance_timer.h>
+#include <dynamic_robot_localization/common/reference_map_bundle.h>
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+namespace dynamic_robot_localization {
+// ####################################################################   GeneralizedCovariancesCache   #####################################################################
+/**
+ * \brief Computes the plane-to-plane covariances of Generalized ICP (same computation as pcl::GeneralizedIterativeClosestPoint) and keeps them between registrations.
+ * Reference covariances are only recomputed when the reference point cloud changes. The points are matched by position with the previous reference point cloud
+ * and only the points within the invalidation voxels (and their neighbor voxels) of the inserted and removed points are recomputed (full recomputation when most of the points changed).
+ * Points appended to the reference point cloud (incremental map integration) can be given directly to insertReferencePoints, which avoids matching all the points by position.
+ * When all the reference covariances are computed, they can be loaded from / saved to a file, which is only accepted if it was computed with the same points and configuration.
+ * Ambient covariances are kept for the last registered point clouds and for their aligned point clouds (rotated by the registration transformation),
+ * which allows chained matchers to reuse the covariances computed by the previous matcher.
+ * The same cache can be shared by several matchers (the reference update is skipped if the cache was already updated with the same reference point cloud).
+ * The ambient covariances functions are thread safe, while updateReferenceCovariances and insertReferencePoints are not.
+ */
+template <typename PointT>
+class GeneralizedCovariancesCache {
+	// ========================================================================   <public-section>   ===========================================================================
+	public:
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <usings>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		using Ptr = std::shared_ptr< GeneralizedCovariancesCache<PointT> >;
+		using ConstPtr = std::shared_ptr< const GeneralizedCovariancesCache<PointT> >;
+		using MatricesVector = std::vector< Eigen::Matrix3d, Eigen::aligned_allocator<Eigen::Matrix3d> >; // same types as pcl::GeneralizedIterativeClosestPoint
+		using MatricesVectorPtr = std::shared_ptr< MatricesVector >;
+		using VoxelKey = std::uint64_t;
+
+		struct PointPositionKey {
+			float x, y, z;
+			bool operator==(const PointPositionKey& other) const { return x == other.x && y == other.y && z == other.z; }
+		};
+
+		struct PointPositionKeyHash {
+			size_t operator()(const PointPositionKey& key) const {
+				std::uint32_t bits[3];
+				std::memcpy(bits, &key, sizeof(bits));
+				return (size_t)((std::uint64_t)bits[0] * 73856093u ^ (std::uint64_t)bits[1] * 19349663u ^ (std::uint64_t)bits[2] * 83492791u);
+			}
+		};
+
+		struct CovariancesFileHeader {
+			char magic[8];
+			std::uint32_t format_version;
+			std::int32_t number_of_neighbors;
+			double epsilon;
+			std::uint64_t points_hash;
+			std::uint64_t number_of_points;
+		};
+
+		static const std::uint32_t s_covariances_file_format_version = 1;
+		static const size_t s_maximum_number_of_ambient_entries = 4;
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </usings>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <constructors-destructor>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		explicit GeneralizedCovariancesCache(int number_of_neighbors = 20, double epsilon = 0.001);
+		virtual ~GeneralizedCovariancesCache() {}
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </constructors-destructor>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <GeneralizedCovariancesCache-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		/*! Returns the covariances of the reference point cloud (the search method is only used if it has the reference point cloud as input). */
+		MatricesVectorPtr updateReferenceCovariances(const typename pcl::PointCloud<PointT>::Ptr& reference_pointcloud, const typename pcl::search::KdTree<PointT>::Ptr& search_method);
+		/*! Computes the covariances of the points with the given indices, which must have been appended to the reference point cloud given in the last update,
+		 * and recomputes the covariances of the points within invalidation_voxel_size of them (the search method must have the reference point cloud as input).
+		 * The covariances are extended in place, because the matchers only read them during the registrations (which are not concurrent with the reference updates).
+		 * Returns nullptr if the cache is not in sync with the reference point cloud (and updateReferenceCovariances must be used instead). */
+		MatricesVectorPtr insertReferencePoints(const typename pcl::PointCloud<PointT>::Ptr& reference_pointcloud, const std::vector<int>& inserted_points_indices,
+				const typename pcl::search::KdTree<PointT>::Ptr& search_method);
+
+		/*! Returns the cached covariances of the ambient point cloud or computes them (the search method is only used if it has the ambient point cloud as input). */
+		MatricesVectorPtr getAmbientCovariances(const typename pcl::PointCloud<PointT>::ConstPtr& ambient_pointcloud, const typename pcl::search::KdTree<PointT>::Ptr& search_method);
+		/*! Caches the covariances of the aligned point cloud, computed by rotating the cached covariances of the ambient point cloud (aligned_pointcloud = transformation * ambient_pointcloud). */
+		void addAlignedAmbientCovariances(const pcl::PointCloud<PointT>& ambient_pointcloud, const pcl::PointCloud<PointT>& aligned_pointcloud, const Eigen::Matrix4f& transformation);
+
+		void clear();
+		/*! Releases the covariances cached for the ambient point clouds (they are recomputed on demand). */
+		void clearAmbientCovariances();
+		bool hasSameConfiguration(const GeneralizedCovariancesCache<PointT>& other) const;
+		/*! New empty cache with the same configuration (allows to prepare the cache of a new reference point cloud while this one is still being used by the matchers). */
+		Ptr cloneConfiguration() const;
+		/*! @return number of bytes added to memory_usage (0 if this cache was already accounted by another matcher) */
+		size_t accountMemoryUsage(MemoryUsage& memory_usage);
+		/*! Accounts only the covariances cached for the ambient point clouds (the ones released by clearAmbientCovariances). */
+		size_t accountAmbientCovariancesMemoryUsage(MemoryUsage& memory_usage);
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </GeneralizedCovariancesCache-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <gets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		inline int getNumberOfNeighbors() const { return number_of_neighbors_; }
+		inline double getEpsilon() const { return epsilon_; }
+		inline double getInvalidationVoxelSize() const { return invalidation_voxel_size_; }
+		inline double getFullRecomputationRatio() const { return full_recomputation_ratio_; }
+		inline const std::string& getCovariancesFilename() const { return covariances_filename_; }
+		inline int getNumberOfThreads() const { return number_of_threads_; }
+		inline size_t getNumberOfRecomputedCovariancesInLastUpdate() const { return number_of_recomputed_covariances_in_last_update_; }
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </gets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <sets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		/*! Should be larger than the distance to the farthest of the number_of_neighbors closest points (otherwise the covariances of some points next to the changes will not be updated). */
+		inline void setInvalidationVoxelSize(double invalidation_voxel_size) { invalidation_voxel_size_ = invalidation_voxel_size; }
+		/*! All the reference covariances are recomputed when the number of inserted and removed points is higher than this ratio of the number of points in the cache. */
+		inline void setFullRecomputationRatio(double full_recomputation_ratio) { full_recomputation_ratio_ = full_recomputation_ratio; }
+		/*! If not empty, the reference covariances are loaded from / saved to this file when all of them must be computed. */
+		inline void setCovariancesFilename(const std::string& covariances_filename) { covariances_filename_ = covariances_filename; }
+		/*! If <= 0, omp_get_max_threads() is used. */
+		inline void setNumberOfThreads(int number_of_threads) { number_of_threads_ = number_of_threads; }
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </sets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+	// ========================================================================   </public-section>  ===========================================================================
+
+	// ========================================================================   <protected-section>   ========================================================================
+	protected:
+		/*! The ambient point clouds are identified by their address, header stamp, number of points and the positions of their first, middle and last points. */
+		struct AmbientCovariancesEntry {
+			const pcl::PointCloud<PointT>* pointcloud;
+			std::uint64_t stamp;
+			size_t number_of_points;
+			Eigen::Vector3f sample_positions[3];
+			MatricesVectorPtr covariances;
+		};
+
+		static inline PointPositionKey s_computePointPositionKey(const PointT& point) {
+			PointPositionKey key = { point.x + 0.0f, point.y + 0.0f, point.z + 0.0f }; // + 0.0f converts -0.0f to 0.0f (both must have the same hash)
+			return key;
+		}
+
+		inline VoxelKey computeVoxelKey(int x, int y, int z) const {
+			return ((VoxelKey)(x & 0x1FFFFF) << 42) | ((VoxelKey)(y & 0x1FFFFF) << 21) | (VoxelKey)(z & 0x1FFFFF);
+		}
+
+		inline Eigen::Vector3i computeVoxelCoordinates(const PointT& point) const {
+			double inverse_voxel_size = 1.0 / invalidation_voxel_size_;
+			return Eigen::Vector3i((int)std::floor(point.x * inverse_voxel_size), (int)std::floor(point.y * inverse_voxel_size), (int)std::floor(point.z * inverse_voxel_size));
+		}
+
+		static void s_fillAmbientCovariancesEntry(const pcl::PointCloud<PointT>& pointcloud, const MatricesVectorPtr& covariances, AmbientCovariancesEntry& entry);
+		static bool s_isAmbientCovariancesEntryOf(const AmbientCovariancesEntry& entry, const pcl::PointCloud<PointT>& pointcloud);
+		void addAmbientCovariancesEntry(const AmbientCovariancesEntry& entry);
+
+		/*! Computes the covariances of the points with the given indices (all the points if indices is null). */
+		void computeCovariances(const typename pcl::PointCloud<PointT>::ConstPtr& pointcloud, const typename pcl::search::KdTree<PointT>::Ptr& search_method,
+				const std::vector<int>* indices, MatricesVector& covariances);
+		void computeCovariance(const pcl::PointCloud<PointT>& pointcloud, const std::vector<int>& neighbors_indices, Eigen::Matrix3d& covariance) const;
+		std::uint64_t computePointsHash(const pcl::PointCloud<PointT>& pointcloud) const;
+		bool loadCovariances(const std::string& filename, std::uint64_t points_hash, MatricesVector& covariances) const;
+		bool saveCovariances(const std::string& filename, std::uint64_t points_hash, const MatricesVector& covariances) const;
+
+		int number_of_neighbors_;
+		double epsilon_;
+		double invalidation_voxel_size_;
+		double full_recomputation_ratio_;
+		std::string covariances_filename_;
+		int number_of_threads_;
+
+		MatricesVectorPtr reference_covariances_;
+		std::unordered_map< PointPositionKey, std::uint32_t, PointPositionKeyHash > reference_points_indices_;
+		typename pcl::PointCloud<PointT>::Ptr reference_pointcloud_;
+		size_t reference_pointcloud_size_;
+		std::uint64_t reference_pointcloud_stamp_;
+		size_t number_of_recomputed_covariances_in_last_update_;
+
+		std::mutex ambient_covariances_mutex_;
+		std::deque<AmbientCovariancesEntry> ambient_covariances_entries_; // most recent first
+	// ========================================================================   </protected-section>  ========================================================================
+};
+
+} /* namespace dynamic_robot_localization */
+
+
+#ifdef DRL_NO_PRECOMPILE
+#include <dynamic_robot_localization/cloud_matchers/impl/generalized_covariances_cache.hpp>
+#endif
@@ -22,7 +22,8 @@ CloudMatcher<PointT>::CloudMatcher() :
 		match_only_keypoints_(false),
 		display_cloud_aligment_(false),
 		maximum_number_of_displayed_correspondences_(0),
-		force_no_recompute_reciprocal_(true) {}
+		force_no_recompute_reciprocal_(true),
+		registration_initial_guess_(Eigen::Matrix4f::Identity()) {}
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </constructors-destructor>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <CloudMatcher-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
@@ -121,6 +122,23 @@ void CloudMatcher<PointT>::setupConfigurationFromParameterServer(ros::NodeHandle
 			correspondence_estimation_raw_ptr_->getSourceCorrespondencesLookupTable().setComputeDistanceFromQueryPointToClosestPoint(sensor_compute_distance_from_query_point_to_closest_point);
 			correspondence_estimation_raw_ptr_->getSourceCorrespondencesLookupTable().setInitializeLookupTableUsingEuclideanDistanceTransform(sensor_initialize_lookup_table_using_euclidean_distance_transform);
 			correspondence_estimation_ptr_ = typename pcl::registration::CorrespondenceEstimationBase<PointT, PointT, float>::Ptr(correspondence_estimation_raw_ptr_);
+		} else if(correspondence_estimation_method == "CorrespondenceEstimationIncrementalLookupTable") {
+			correpondence_estimation_approach_ = CorrespondenceEstimationIncrementalLookupTable;
+			CorrespondenceEstimationIncrementalLookupTableTimed<PointT, PointT, float>* correspondence_estimation_raw_ptr_ = new CorrespondenceEstimationIncrementalLookupTableTimed<PointT, PointT, float>();
+			double cell_resolution = 0.05, influence_radius = 0.2, full_rebuild_ratio = 0.5;
+			bool use_search_tree_when_query_point_is_outside_lookup_table = true;
+			bool compute_distance_from_query_point_to_closest_point = true;
+			if (ros::param::search(search_namespace, "correspondence_estimation_incremental_lookup_table/cell_resolution", final_param_name)) { private_node_handle->param(final_param_name, cell_resolution, 0.05); }
+			if (ros::param::search(search_namespace, "correspondence_estimation_incremental_lookup_table/influence_radius", final_param_name)) { private_node_handle->param(final_param_name, influence_radius, 0.2); }
+			if (ros::param::search(search_namespace, "correspondence_estimation_incremental_lookup_table/full_rebuild_ratio", final_param_name)) { private_node_handle->param(final_param_name, full_rebuild_ratio, 0.5); }
+			if (ros::param::search(search_namespace, "correspondence_estimation_incremental_lookup_table/use_search_tree_when_query_point_is_outside_lookup_table", final_param_name)) { private_node_handle->param(final_param_name, use_search_tree_when_query_point_is_outside_lookup_table, true); }
+			if (ros::param::search(search_namespace, "correspondence_estimation_incremental_lookup_table/compute_distance_from_query_point_to_closest_point", final_param_name)) { private_node_handle->param(final_param_name, compute_distance_from_query_point_to_closest_point, true); }
+			typename CorrespondencesLookupTableGrid<PointT>::Ptr correspondences_lookup_table_grid(new CorrespondencesLookupTableGrid<PointT>((float)cell_resolution, (float)influence_radius));
+			correspondences_lookup_table_grid->setFullRebuildRatio(full_rebuild_ratio);
+			correspondences_lookup_table_grid->setComputeDistanceFromQueryPointToClosestPoint(compute_distance_from_query_point_to_closest_point);
+			correspondence_estimation_raw_ptr_->setCorrespondencesLookupTableGrid(correspondences_lookup_table_grid);
+			correspondence_estimation_raw_ptr_->setUseSearchTreeWhenQueryPointIsOutsideLookupTable(use_search_tree_when_query_point_is_outside_lookup_table);
+			correspondence_estimation_ptr_ = typename pcl::registration::CorrespondenceEstimationBase<PointT, PointT, float>::Ptr(correspondence_estimation_raw_ptr_);
 		} else if (correspondence_estimation_method == "CorrespondenceEstimationBackProjection") {
 			correpondence_estimation_approach_ = CorrespondenceEstimationBackProjection;
 			CorrespondenceEstimationBackProjectionTimed<PointT, PointT, PointT, float>* correspondence_estimation_raw_ptr_ = new CorrespondenceEstimationBackProjectionTimed<PointT, PointT, PointT, float>();
@@ -217,10 +235,26 @@ void CloudMatcher<PointT>::setupTFConfigurationsFromParameterServer(ros::NodeHan
 
 template<typename PointT>
 void CloudMatcher<PointT>::setupReferencePointCloudPublisher(ros::NodeHandlePtr& node_handle, ros::NodeHandlePtr& private_node_handle, const std::string& configuration_namespace) {
-	reference_cloud_publisher_ = typename CloudPublisher<PointT>::Ptr(new CloudPublisher<PointT>());
-	reference_cloud_publisher_->setOverrideCloudPublishStamp(true);
-	reference_cloud_publisher_->setParameterServerArgumentToLoadTopicName(configuration_namespace + "reference_cloud_publish_topic");
+	std::string reference_cloud_publish_topic, reference_cloud_publish_frame_id;
+	private_node_handle->param(configuration_namespace + "reference_cloud_publish_topic", reference_cloud_publish_topic, std::string(""));
+	private_node_handle->param(configuration_namespace + "reference_cloud_publish_topic_frame_id", reference_cloud_publish_frame_id, std::string(""));
+	if (reference_cloud_publish_topic.empty()) {
+		reference_cloud_publisher_.reset();
+		return;
+	}
+
+	// the publisher is kept when the configuration is reloaded, to avoid republishing the full reference point cloud
+	double previous_delta_voxel_size = reference_cloud_publisher_ ? reference_cloud_publisher_->getDeltaVoxelSize() : 0.0;
+	bool restart_publishers = !reference_cloud_publisher_ || reference_cloud_publisher_->getPublishTopic() != reference_cloud_publish_topic;
+	if (!reference_cloud_publisher_) { reference_cloud_publisher_ = typename ReferenceMapPublisher<PointT>::Ptr(new ReferenceMapPublisher<PointT>()); }
+	reference_cloud_publisher_->setPublishTopic(reference_cloud_publish_topic);
+	reference_cloud_publisher_->setPublishFrameId(reference_cloud_publish_frame_id);
 	reference_cloud_publisher_->setupConfigurationFromParameterServer(node_handle, private_node_handle, configuration_namespace);
+
+	if (restart_publishers || reference_cloud_publisher_->getDeltaVoxelSize() != previous_delta_voxel_size) {
+		reference_cloud_publisher_->startPublishers(node_handle);
+		if (reference_cloud_) { reference_cloud_publisher_->setReferencePointCloud(reference_cloud_); }
+	}
 }
 
 template<typename PointT>
@@ -238,6 +272,10 @@ void CloudMatcher<PointT>::setupReferenceCloud(typename pcl::PointCloud<PointT>:
 	reference_cloud_keypoints_ = reference_cloud_keypoints;
 	search_method_ = search_method;
 
+	if (reference_cloud_publisher_ && reference_cloud) {
+		reference_cloud_publisher_->setReferencePointCloud(reference_cloud);
+	}
+
 	// subclass must set cloud_matcher_ ptr
 	if (cloud_matcher_) {
 		cloud_matcher_->setInputTarget(reference_cloud);
@@ -246,6 +284,11 @@ void CloudMatcher<PointT>::setupReferenceCloud(typename pcl::PointCloud<PointT>:
 			cloud_matcher_->getCorrespondenceEstimation()->setSearchMethodTarget(search_method, false);
 	}
 
+	typename CorrespondencesLookupTableGrid<PointT>::Ptr correspondences_lookup_table_grid = getCorrespondencesLookupTableGrid();
+	if (correspondences_lookup_table_grid) {
+		correspondences_lookup_table_grid->update(reference_cloud, search_method);
+	}
+
 	if (registration_visualizer_) {
 		registration_visualizer_->setTargetCloud(*reference_cloud);
 	}
@@ -272,7 +315,7 @@ bool CloudMatcher<PointT>::registerCloud(typename pcl::PointCloud<PointT>::Ptr&
 		return false;
 	}
 
-	if (ambient_pointcloud->size() != ambient_pointcloud_search_method->getInputCloud()->size()) {
+	if (ambient_pointcloud_search_method && (!ambient_pointcloud_search_method->getInputCloud() || ambient_pointcloud->size() != ambient_pointcloud_search_method->getInputCloud()->size())) {
 		ambient_pointcloud_search_method->setInputCloud(ambient_pointcloud);
 	}
 
@@ -288,7 +331,7 @@ bool CloudMatcher<PointT>::registerCloud(typename pcl::PointCloud<PointT>::Ptr&
 	} else {
 		ROS_DEBUG_STREAM("Registering cloud with " << ambient_pointcloud->size() << " points against a reference cloud with " << cloud_matcher_->getInputTarget()->size() << " points using " << getCloudMatcherName() << " algorithm");
 		cloud_matcher_->setInputSource(ambient_pointcloud);
-		cloud_matcher_->setSearchMethodSource(ambient_pointcloud_search_method, force_no_recompute_reciprocal_);
+		if (ambient_pointcloud_search_method) { cloud_matcher_->setSearchMethodSource(ambient_pointcloud_search_method, force_no_recompute_reciprocal_); } // otherwise pcl builds its own search method only if reciprocal correspondences are used
 		if (registration_visualizer_) { registration_visualizer_->setSourceCloud(*ambient_pointcloud); }
 	}
 
@@ -300,7 +343,7 @@ bool CloudMatcher<PointT>::registerCloud(typename pcl::PointCloud<PointT>::Ptr&
 	cloud_align_time_ms_ = 0;
 	PerformanceTimer performance_timer;
 	performance_timer.start();
-	cloud_matcher_->align(*pointcloud_registered_out);
+	cloud_matcher_->align(*pointcloud_registered_out, Eigen::Matrix4f(registration_initial_guess_));
 	cloud_align_time_ms_ = performance_timer.getElapsedTimeInMilliSec();
 
 	Eigen::Matrix4f final_transformation = cloud_matcher_->getFinalTransformation();
@@ -342,10 +385,7 @@ bool CloudMatcher<PointT>::registerCloud(typename pcl::PointCloud<PointT>::Ptr&
 			cloud_publisher_->publishPointCloud(*pointcloud_registered_out);
 		}
 
-		if (reference_cloud_publisher_ && reference_cloud_) {
-			reference_cloud_publisher_->setCloudPublishStamp(ambient_pointcloud->header.stamp);
-			reference_cloud_publisher_->publishPointCloud(*reference_cloud_);
-		}
+		publishReferenceCloud(ambient_pointcloud->header.stamp);
 
 		return true;
 	}
@@ -386,6 +426,53 @@ bool CloudMatcher<PointT>::postProcessRegistrationMatrix(typename pcl::PointClou
 	return true;
 }
 
+template<typename PointT>
+void CloudMatcher<PointT>::publishReferenceCloud(std::uint64_t pcl_time_stamp) {
+	if (reference_cloud_publisher_ && reference_cloud_) {
+		reference_cloud_publisher_->publishPendingChanges(pcl_conversions::fromPCL(pcl_time_stamp));
+	}
+}
+
+template<typename PointT>
+size_t CloudMatcher<PointT>::accountMemoryUsage(MemoryUsage& memory_usage) {
+	size_t bytes = memory_usage.addPointCloud(reference_cloud_.get()) + memory_usage.addPointCloud(reference_cloud_keypoints_.get()) + memory_usage.addKdTree(search_method_.get());
+	if (cloud_matcher_) {
+		bytes += memory_usage.addPointCloud(cloud_matcher_->getInputTarget().get());
+		bytes += memory_usage.addKdTree(cloud_matcher_->getSearchMethodTarget().get());
+	}
+
+	typename CorrespondencesLookupTableGrid<PointT>::Ptr correspondences_lookup_table_grid = getCorrespondencesLookupTableGrid();
+	if (correspondences_lookup_table_grid) {
+		bytes += correspondences_lookup_table_grid->accountMemoryUsage(memory_usage);
+	}
+	return bytes;
+}
+
+template<typename PointT>
+void CloudMatcher<PointT>::clearPublishers() {
+	cloud_publisher_.reset();
+	reference_cloud_publisher_.reset();
+	tf_broadcaster_.reset();
+	static_tf_broadcaster_.reset();
+}
+
+template<typename PointT>
+typename CorrespondencesLookupTableGrid<PointT>::Ptr CloudMatcher<PointT>::getCorrespondencesLookupTableGrid() {
+	if (correspondence_estimation_ptr_ && correpondence_estimation_approach_ == CorrespondenceEstimationIncrementalLookupTable) {
+		typename CorrespondenceEstimationIncrementalLookupTableTimed<PointT, PointT, float>::Ptr estimator = std::dynamic_pointer_cast< CorrespondenceEstimationIncrementalLookupTableTimed<PointT, PointT, float> >(correspondence_estimation_ptr_);
+		if (estimator) { return estimator->getCorrespondencesLookupTableGrid(); }
+	}
+	return typename CorrespondencesLookupTableGrid<PointT>::Ptr();
+}
+
+template<typename PointT>
+void CloudMatcher<PointT>::setCorrespondencesLookupTableGrid(const typename CorrespondencesLookupTableGrid<PointT>::Ptr& correspondences_lookup_table_grid) {
+	if (correspondence_estimation_ptr_ && correpondence_estimation_approach_ == CorrespondenceEstimationIncrementalLookupTable) {
+		typename CorrespondenceEstimationIncrementalLookupTableTimed<PointT, PointT, float>::Ptr estimator = std::dynamic_pointer_cast< CorrespondenceEstimationIncrementalLookupTableTimed<PointT, PointT, float> >(correspondence_estimation_ptr_);
+		if (estimator) { estimator->setCorrespondencesLookupTableGrid(correspondences_lookup_table_grid); }
+	}
+}
+
 template<typename PointT>
 void CloudMatcher<PointT>::setupRegistrationVisualizer() {
 	if (cloud_matcher_ && !registration_visualizer_ && display_cloud_aligment_) {
@@ -414,6 +501,12 @@ double CloudMatcher<PointT>::getCorrespondenceEstimationElapsedTimeMS() {
 				break;
 			}
 
+			case CorrespondenceEstimationIncrementalLookupTable: {
+				typename CorrespondenceEstimationIncrementalLookupTableTimed<PointT, PointT, float>::Ptr estimator = std::dynamic_pointer_cast< CorrespondenceEstimationIncrementalLookupTableTimed<PointT, PointT, float> >(correspondence_estimation_ptr_);
+				if (estimator) { return estimator->getCorrespondenceEstimationElapsedTime(); }
+				break;
+			}
+
 			case CorrespondenceEstimationBackProjection: {
 				typename CorrespondenceEstimationBackProjectionTimed<PointT, PointT, PointT, float>::Ptr estimator = std::dynamic_pointer_cast< CorrespondenceEstimationBackProjectionTimed<PointT, PointT, PointT, float> >(correspondence_estimation_ptr_);
 				if (estimator) { return estimator->getCorrespondenceEstimationElapsedTime(); }
@@ -456,6 +549,12 @@ void CloudMatcher<PointT>::resetCorrespondenceEstimationElapsedTime() {
 				break;
 			}
 
+			case CorrespondenceEstimationIncrementalLookupTable: {
+				typename CorrespondenceEstimationIncrementalLookupTableTimed<PointT, PointT, float>::Ptr estimator = std::dynamic_pointer_cast< CorrespondenceEstimationIncrementalLookupTableTimed<PointT, PointT, float> >(correspondence_estimation_ptr_);
+				if (estimator) { estimator->resetCorrespondenceEstimationElapsedTime(); }
+				break;
+			}
+
 			case CorrespondenceEstimationBackProjection: {
 				typename CorrespondenceEstimationBackProjectionTimed<PointT, PointT, PointT, float>::Ptr estimator = std::dynamic_pointer_cast< CorrespondenceEstimationBackProjectionTimed<PointT, PointT, PointT, float> >(correspondence_estimation_ptr_);
 				if (estimator) { estimator->resetCorrespondenceEstimationElapsedTime(); }
@@ -0,0 +1,355 @@
+/**\file correspondences_lookup_table_grid.hpp
+ * \brief Description...
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+#include <dynamic_robot_localization/cloud_matchers/correspondences_lookup_table_grid.h>
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+namespace dynamic_robot_localization {
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <imports>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </imports>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+// =============================================================================  <public-section>  ============================================================================
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <constructors-destructor>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+template<typename PointT>
+CorrespondencesLookupTableGrid<PointT>::CorrespondencesLookupTableGrid(float cell_resolution, float influence_radius) :
+	cell_resolution_(cell_resolution),
+	inverse_cell_resolution_(1.0f / cell_resolution),
+	influence_radius_(influence_radius),
+	full_rebuild_ratio_(0.5),
+	compute_distance_from_query_point_to_closest_point_(true),
+	reference_pointcloud_size_(0),
+	reference_pointcloud_stamp_(0),
+	number_of_updated_cells_in_last_update_(0),
+	last_update_was_full_rebuild_(false) {}
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </constructors-destructor>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <CorrespondencesLookupTableGrid-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+template<typename PointT>
+bool CorrespondencesLookupTableGrid<PointT>::update(const typename pcl::PointCloud<PointT>::Ptr& reference_pointcloud, const typename pcl::search::KdTree<PointT>::Ptr& search_method) {
+	if (!reference_pointcloud) { return false; }
+	if (reference_pointcloud == reference_pointcloud_ && reference_pointcloud->size() == reference_pointcloud_size_ && reference_pointcloud->header.stamp == reference_pointcloud_stamp_) {
+		return false; // already updated by another matcher sharing this grid
+	}
+
+	PerformanceTimer performance_timer;
+	performance_timer.start();
+
+	// match the points of the new reference cloud with the points already in the table
+	std::vector<char> point_id_in_reference_pointcloud(point_indices_.size(), 0);
+	std::vector<size_t> inserted_points_indices;
+	for (size_t i = 0; i < reference_pointcloud->size(); ++i) {
+		const PointT& point = (*reference_pointcloud)[i];
+		if (!pcl::isXYZFinite(point)) { continue; }
+
+		typename std::unordered_map< PointPositionKey, std::uint32_t, PointPositionKeyHash >::iterator point_it = point_ids_.find(s_computePointPositionKey(point));
+		if (point_it != point_ids_.end()) {
+			if (!point_id_in_reference_pointcloud[point_it->second]) {
+				point_id_in_reference_pointcloud[point_it->second] = 1;
+				point_indices_[point_it->second] = (int)i;
+			}
+		} else {
+			inserted_points_indices.push_back(i);
+		}
+	}
+
+	std::vector<std::uint32_t> removed_point_ids;
+	for (size_t point_id = 0; point_id < point_indices_.size(); ++point_id) {
+		if (point_indices_[point_id] >= 0 && !point_id_in_reference_pointcloud[point_id]) {
+			removed_point_ids.push_back((std::uint32_t)point_id);
+		}
+	}
+
+	size_t number_of_changed_points = inserted_points_indices.size() + removed_point_ids.size();
+	bool search_method_has_reference_pointcloud = search_method && search_method->getInputCloud().get() == reference_pointcloud.get();
+	last_update_was_full_rebuild_ = blocks_.empty() || number_of_changed_points > full_rebuild_ratio_ * (double)point_ids_.size() || (!removed_point_ids.empty() && !search_method_has_reference_pointcloud);
+
+	if (last_update_was_full_rebuild_) {
+		rebuild(*reference_pointcloud);
+	} else {
+		number_of_updated_cells_in_last_update_ = 0;
+		std::vector<Cell*> dirty_cells;
+		std::vector<Eigen::Vector3f> dirty_cells_centers;
+		for (size_t i = 0; i < removed_point_ids.size(); ++i) {
+			invalidatePointCells(removed_point_ids[i], dirty_cells, dirty_cells_centers);
+			removePoint(removed_point_ids[i]);
+		}
+
+		for (size_t i = 0; i < inserted_points_indices.size(); ++i) {
+			size_t point_index = inserted_points_indices[i];
+			PointPositionKey key = s_computePointPositionKey((*reference_pointcloud)[point_index]);
+			if (point_ids_.find(key) != point_ids_.end()) { continue; } // duplicated point
+			propagatePoint(addPoint(key, (int)point_index));
+		}
+
+		recomputeCells(dirty_cells, dirty_cells_centers, *reference_pointcloud, search_method);
+	}
+
+	setReferencePointCloud(reference_pointcloud);
+
+	ROS_DEBUG_STREAM("CorrespondencesLookupTableGrid " << (last_update_was_full_rebuild_ ? "rebuilt" : "updated") << " with " << inserted_points_indices.size() << " inserted and " << removed_point_ids.size() << " removed points ("
+			<< number_of_updated_cells_in_last_update_ << " updated cells in " << blocks_.size() << " blocks) in " << performance_timer.getElapsedTimeFormated());
+	return true;
+}
+
+
+template<typename PointT>
+bool CorrespondencesLookupTableGrid<PointT>::insertPoints(const typename pcl::PointCloud<PointT>::Ptr& reference_pointcloud, const std::vector<int>& inserted_points_indices) {
+	if (!reference_pointcloud || reference_pointcloud != reference_pointcloud_ || blocks_.empty() || reference_pointcloud->size() != reference_pointcloud_size_ + inserted_points_indices.size()) {
+		return false;
+	}
+
+	PerformanceTimer performance_timer;
+	performance_timer.start();
+	number_of_updated_cells_in_last_update_ = 0;
+	last_update_was_full_rebuild_ = false;
+	for (size_t i = 0; i < inserted_points_indices.size(); ++i) {
+		int point_index = inserted_points_indices[i];
+		if (point_index < 0 || (size_t)point_index >= reference_pointcloud->size()) { continue; }
+		const PointT& point = (*reference_pointcloud)[point_index];
+		if (!pcl::isXYZFinite(point)) { continue; }
+		PointPositionKey key = s_computePointPositionKey(point);
+		if (point_ids_.find(key) != point_ids_.end()) { continue; } // duplicated point
+		propagatePoint(addPoint(key, point_index));
+	}
+
+	setReferencePointCloud(reference_pointcloud);
+	ROS_DEBUG_STREAM("CorrespondencesLookupTableGrid inserted " << inserted_points_indices.size() << " points (" << number_of_updated_cells_in_last_update_ << " updated cells in " << blocks_.size() << " blocks) in " << performance_timer.getElapsedTimeFormated());
+	return true;
+}
+
+
+template<typename PointT>
+bool CorrespondencesLookupTableGrid<PointT>::removePoints(const typename pcl::PointCloud<PointT>::Ptr& reference_pointcloud, const pcl::PointCloud<PointT>& removed_points,
+		const typename pcl::search::KdTree<PointT>::Ptr& search_method) {
+	if (!reference_pointcloud || reference_pointcloud != reference_pointcloud_ || blocks_.empty() || !search_method || search_method->getInputCloud().get() != reference_pointcloud.get()) {
+		return false;
+	}
+
+	PerformanceTimer performance_timer;
+	performance_timer.start();
+	number_of_updated_cells_in_last_update_ = 0;
+	last_update_was_full_rebuild_ = false;
+	std::vector<Cell*> dirty_cells;
+	std::vector<Eigen::Vector3f> dirty_cells_centers;
+	for (size_t i = 0; i < removed_points.size(); ++i) {
+		if (!pcl::isXYZFinite(removed_points[i])) { continue; }
+		typename std::unordered_map< PointPositionKey, std::uint32_t, PointPositionKeyHash >::iterator point_it = point_ids_.find(s_computePointPositionKey(removed_points[i]));
+		if (point_it == point_ids_.end()) { continue; }
+		std::uint32_t point_id = point_it->second;
+		invalidatePointCells(point_id, dirty_cells, dirty_cells_centers);
+		removePoint(point_id);
+	}
+
+	recomputeCells(dirty_cells, dirty_cells_centers, *reference_pointcloud, search_method);
+	setReferencePointCloud(reference_pointcloud);
+	ROS_DEBUG_STREAM("CorrespondencesLookupTableGrid removed " << removed_points.size() << " points (" << number_of_updated_cells_in_last_update_ << " updated cells in " << blocks_.size() << " blocks) in " << performance_timer.getElapsedTimeFormated());
+	return true;
+}
+
+
+template<typename PointT>
+void CorrespondencesLookupTableGrid<PointT>::clear() {
+	blocks_.clear();
+	point_ids_.clear();
+	point_indices_.clear();
+	point_positions_.clear();
+	free_point_ids_.clear();
+	reference_pointcloud_.reset();
+	reference_pointcloud_size_ = 0;
+	reference_pointcloud_stamp_ = 0;
+}
+
+
+template<typename PointT>
+size_t CorrespondencesLookupTableGrid<PointT>::accountMemoryUsage(MemoryUsage& memory_usage) const {
+	if (!memory_usage.addObject(this)) { return 0; }
+	size_t bytes = sizeof(*this) + MemoryUsage::s_getHashContainerBytes(blocks_) + MemoryUsage::s_getHashContainerBytes(point_ids_)
+			+ MemoryUsage::s_getVectorBytes(point_indices_) + MemoryUsage::s_getVectorBytes(point_positions_) + MemoryUsage::s_getVectorBytes(free_point_ids_);
+	for (typename std::unordered_map< BlockKey, std::vector<Cell> >::const_iterator block_it = blocks_.begin(); block_it != blocks_.end(); ++block_it) {
+		bytes += MemoryUsage::s_getVectorBytes(block_it->second);
+	}
+	return memory_usage.addBytes(bytes) + memory_usage.addPointCloud(reference_pointcloud_.get());
+}
+
+
+template<typename PointT>
+bool CorrespondencesLookupTableGrid<PointT>::hasSameConfiguration(const CorrespondencesLookupTableGrid<PointT>& other) const {
+	return cell_resolution_ == other.cell_resolution_ && influence_radius_ == other.influence_radius_ && full_rebuild_ratio_ == other.full_rebuild_ratio_ &&
+			compute_distance_from_query_point_to_closest_point_ == other.compute_distance_from_query_point_to_closest_point_;
+}
+
+
+template<typename PointT>
+typename CorrespondencesLookupTableGrid<PointT>::Ptr CorrespondencesLookupTableGrid<PointT>::cloneConfiguration() const {
+	Ptr correspondences_lookup_table_grid(new CorrespondencesLookupTableGrid<PointT>(cell_resolution_, influence_radius_));
+	correspondences_lookup_table_grid->full_rebuild_ratio_ = full_rebuild_ratio_;
+	correspondences_lookup_table_grid->compute_distance_from_query_point_to_closest_point_ = compute_distance_from_query_point_to_closest_point_;
+	return correspondences_lookup_table_grid;
+}
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </CorrespondencesLookupTableGrid-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// =============================================================================  </public-section>  ===========================================================================
+
+// =============================================================================   <protected-section>   =======================================================================
+template<typename PointT>
+template<typename CellFunction>
+void CorrespondencesLookupTableGrid<PointT>::forEachCellWithinInfluenceRadius(const Eigen::Vector3f& position, bool allocate_missing_blocks, CellFunction cell_function) {
+	float squared_influence_radius = influence_radius_ * influence_radius_;
+	Eigen::Vector3i min_cell = computeCellCoordinates(position.x() - influence_radius_, position.y() - influence_radius_, position.z() - influence_radius_);
+	Eigen::Vector3i max_cell = computeCellCoordinates(position.x() + influence_radius_, position.y() + influence_radius_, position.z() + influence_radius_);
+	Eigen::Vector3i min_block = computeBlockCoordinates(min_cell);
+	Eigen::Vector3i max_block = computeBlockCoordinates(max_cell);
+
+	for (int block_z = min_block.z(); block_z <= max_block.z(); ++block_z) {
+		for (int block_y = min_block.y(); block_y <= max_block.y(); ++block_y) {
+			for (int block_x = min_block.x(); block_x <= max_block.x(); ++block_x) {
+				Eigen::Vector3i block_origin(block_x * s_block_size, block_y * s_block_size, block_z * s_block_size);
+				Eigen::Vector3i first_cell = min_cell.cwiseMax(block_origin);
+				Eigen::Vector3i last_cell = max_cell.cwiseMin(block_origin + Eigen::Vector3i::Constant(s_block_size - 1));
+				std::vector<Cell>* block = nullptr;
+				BlockKey block_key = computeBlockKey(Eigen::Vector3i(block_x, block_y, block_z));
+
+				if (!allocate_missing_blocks) {
+					typename std::unordered_map< BlockKey, std::vector<Cell> >::iterator block_it = blocks_.find(block_key);
+					if (block_it == blocks_.end()) { continue; }
+					block = &block_it->second;
+				}
+
+				for (int z = first_cell.z(); z <= last_cell.z(); ++z) {
+					for (int y = first_cell.y(); y <= last_cell.y(); ++y) {
+						for (int x = first_cell.x(); x <= last_cell.x(); ++x) {
+							Eigen::Vector3f cell_center = computeCellCenter(Eigen::Vector3i(x, y, z));
+							float squared_distance = (cell_center - position).squaredNorm();
+							if (squared_distance > squared_influence_radius) { continue; }
+
+							if (!block) { // lazy allocation, to avoid blocks without cells within influence_radius
+								std::vector<Cell>& new_block = blocks_[block_key];
+								if (new_block.empty()) {
+									Cell invalid_cell = { s_invalid_point_id, std::numeric_limits<float>::max() };
+									new_block.assign(s_block_size * s_block_size * s_block_size, invalid_cell);
+								}
+								block = &new_block;
+							}
+
+							size_t offset = (size_t)((x - block_origin.x()) + s_block_size * ((y - block_origin.y()) + s_block_size * (z - block_origin.z())));
+							cell_function((*block)[offset], squared_distance, cell_center);
+						}
+					}
+				}
+			}
+		}
+	}
+}
+
+
+template<typename PointT>
+std::uint32_t CorrespondencesLookupTableGrid<PointT>::addPoint(const PointPositionKey& key, int reference_point_index) {
+	std::uint32_t point_id;
+	if (!free_point_ids_.empty()) {
+		point_id = free_point_ids_.back();
+		free_point_ids_.pop_back();
+		point_indices_[point_id] = reference_point_index;
+		point_positions_[point_id] = Eigen::Vector3f(key.x, key.y, key.z);
+	} else {
+		point_id = (std::uint32_t)point_indices_.size();
+		point_indices_.push_back(reference_point_index);
+		point_positions_.push_back(Eigen::Vector3f(key.x, key.y, key.z));
+	}
+	point_ids_[key] = point_id;
+	return point_id;
+}
+
+
+template<typename PointT>
+void CorrespondencesLookupTableGrid<PointT>::removePoint(std::uint32_t point_id) {
+	const Eigen::Vector3f& position = point_positions_[point_id];
+	PointPositionKey key = { position.x(), position.y(), position.z() };
+	point_ids_.erase(key);
+	point_indices_[point_id] = -1;
+	free_point_ids_.push_back(point_id);
+}
+
+
+template<typename PointT>
+void CorrespondencesLookupTableGrid<PointT>::rebuild(const pcl::PointCloud<PointT>& reference_pointcloud) {
+	clear();
+	number_of_updated_cells_in_last_update_ = 0;
+	point_ids_.reserve(reference_pointcloud.size());
+	point_indices_.reserve(reference_pointcloud.size());
+	point_positions_.reserve(reference_pointcloud.size());
+
+	for (size_t i = 0; i < reference_pointcloud.size(); ++i) {
+		const PointT& point = reference_pointcloud[i];
+		if (!pcl::isXYZFinite(point)) { continue; }
+		PointPositionKey key = s_computePointPositionKey(point);
+		if (point_ids_.find(key) != point_ids_.end()) { continue; } // duplicated point
+		propagatePoint(addPoint(key, (int)i));
+	}
+}
+
+
+template<typename PointT>
+void CorrespondencesLookupTableGrid<PointT>::propagatePoint(std::uint32_t point_id) {
+	size_t& number_of_updated_cells = number_of_updated_cells_in_last_update_;
+	forEachCellWithinInfluenceRadius(point_positions_[point_id], true, [&](Cell& cell, float squared_distance, const Eigen::Vector3f&) {
+		if (squared_distance < cell.squared_distance) {
+			cell.point_id = point_id;
+			cell.squared_distance = squared_distance;
+			++number_of_updated_cells;
+		}
+	});
+}
+
+
+template<typename PointT>
+void CorrespondencesLookupTableGrid<PointT>::invalidatePointCells(std::uint32_t point_id, std::vector<Cell*>& dirty_cells, std::vector<Eigen::Vector3f>& dirty_cells_centers) {
+	const Eigen::Vector3f& position = point_positions_[point_id];
+	forEachCellWithinInfluenceRadius(position, false, [&](Cell& cell, float, const Eigen::Vector3f& cell_center) {
+		if (cell.point_id == point_id) {
+			cell.point_id = s_invalid_point_id;
+			cell.squared_distance = std::numeric_limits<float>::max();
+			dirty_cells.push_back(&cell);
+			dirty_cells_centers.push_back(cell_center);
+		}
+	});
+}
+
+
+template<typename PointT>
+void CorrespondencesLookupTableGrid<PointT>::recomputeCells(const std::vector<Cell*>& dirty_cells, const std::vector<Eigen::Vector3f>& dirty_cells_centers,
+		const pcl::PointCloud<PointT>& reference_pointcloud, const typename pcl::search::KdTree<PointT>::Ptr& search_method) {
+	if (dirty_cells.empty()) { return; }
+
+	float squared_influence_radius = influence_radius_ * influence_radius_;
+	std::vector<int> k_indices(1);
+	std::vector<float> k_squared_distances(1);
+	PointT cell_center;
+	for (size_t i = 0; i < dirty_cells.size(); ++i) {
+		Cell& cell = *dirty_cells[i];
+		cell_center.getVector3fMap() = dirty_cells_centers[i];
+		if (search_method->nearestKSearch(cell_center, 1, k_indices, k_squared_distances) > 0 && k_squared_distances[0] <= squared_influence_radius && k_squared_distances[0] < cell.squared_distance) {
+			typename std::unordered_map< PointPositionKey, std::uint32_t, PointPositionKeyHash >::const_iterator point_it = point_ids_.find(s_computePointPositionKey(reference_pointcloud[k_indices[0]]));
+			if (point_it != point_ids_.end()) {
+				cell.point_id = point_it->second;
+				cell.squared_distance = k_squared_distances[0];
+				++number_of_updated_cells_in_last_update_;
+			}
+		}
+	}
+}
+
+
+template<typename PointT>
+void CorrespondencesLookupTableGrid<PointT>::setReferencePointCloud(const typename pcl::PointCloud<PointT>::Ptr& reference_pointcloud) {
+	reference_pointcloud_ = reference_pointcloud;
+	reference_pointcloud_size_ = reference_pointcloud->size();
+	reference_pointcloud_stamp_ = reference_pointcloud->header.stamp;
+}
+// =============================================================================   </protected-section>  =======================================================================
+
+} /* namespace dynamic_robot_localization */
@@ -0,0 +1,493 @@
+/**\file generalized_covariances_cache.hpp
+ * \brief Description...
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+#include <dynamic_robot_localization/cloud_matchers/generalized_covariances_cache.h>
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+namespace dynamic_robot_localization {
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <imports>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </imports>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+// =============================================================================  <public-section>  ============================================================================
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <constructors-destructor>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+template<typename PointT>
+GeneralizedCovariancesCache<PointT>::GeneralizedCovariancesCache(int number_of_neighbors, double epsilon) :
+	number_of_neighbors_(number_of_neighbors),
+	epsilon_(epsilon),
+	invalidation_voxel_size_(0.25),
+	full_recomputation_ratio_(0.5),
+	number_of_threads_(0),
+	reference_pointcloud_size_(0),
+	reference_pointcloud_stamp_(0),
+	number_of_recomputed_covariances_in_last_update_(0) {}
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </constructors-destructor>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <GeneralizedCovariancesCache-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+template<typename PointT>
+typename GeneralizedCovariancesCache<PointT>::MatricesVectorPtr GeneralizedCovariancesCache<PointT>::updateReferenceCovariances(const typename pcl::PointCloud<PointT>::Ptr& reference_pointcloud,
+		const typename pcl::search::KdTree<PointT>::Ptr& search_method) {
+	if (!reference_pointcloud) { return reference_covariances_; }
+	if (reference_covariances_ && reference_pointcloud == reference_pointcloud_ && reference_pointcloud->size() == reference_pointcloud_size_ && reference_pointcloud->header.stamp == reference_pointcloud_stamp_) {
+		return reference_covariances_; // already updated by another matcher sharing this cache
+	}
+
+	PerformanceTimer performance_timer;
+	performance_timer.start();
+
+	// new vector because the previous one may still be used by the matchers
+	MatricesVectorPtr covariances(new MatricesVector(reference_pointcloud->size(), Eigen::Matrix3d::Identity()));
+	std::vector<PointPositionKey> points_keys(reference_pointcloud->size());
+	std::vector<int> recomputed_points_indices;
+	size_t number_of_inserted_points = 0;
+	size_t number_of_removed_points = 0;
+	bool full_recomputation = !reference_covariances_ || reference_points_indices_.empty();
+
+	if (!full_recomputation) {
+		// match the points of the new reference cloud with the points of the previous one
+		std::vector<int> previous_points_indices(reference_pointcloud->size(), -1);
+		std::vector<char> previous_points_kept(reference_covariances_->size(), 0);
+		for (size_t i = 0; i < reference_pointcloud->size(); ++i) {
+			const PointT& point = (*reference_pointcloud)[i];
+			points_keys[i] = s_computePointPositionKey(point);
+			if (!pcl::isXYZFinite(point)) { continue; }
+
+			typename std::unordered_map< PointPositionKey, std::uint32_t, PointPositionKeyHash >::const_iterator point_it = reference_points_indices_.find(points_keys[i]);
+			if (point_it != reference_points_indices_.end()) {
+				previous_points_indices[i] = (int)point_it->second;
+				previous_points_kept[point_it->second] = 1;
+			} else {
+				++number_of_inserted_points;
+			}
+		}
+
+		std::vector<PointPositionKey> removed_points_keys;
+		for (typename std::unordered_map< PointPositionKey, std::uint32_t, PointPositionKeyHash >::const_iterator point_it = reference_points_indices_.begin(); point_it != reference_points_indices_.end(); ++point_it) {
+			if (!previous_points_kept[point_it->second]) {
+				removed_points_keys.push_back(point_it->first);
+			}
+		}
+		number_of_removed_points = removed_points_keys.size();
+
+		full_recomputation = (number_of_inserted_points + number_of_removed_points) > full_recomputation_ratio_ * (double)reference_points_indices_.size();
+		if (!full_recomputation) {
+			// the covariances of the points within the voxels around the changed points are recomputed
+			std::unordered_set<VoxelKey> invalidated_voxels;
+			std::vector<Eigen::Vector3i> changed_voxels;
+			for (size_t i = 0; i < reference_pointcloud->size(); ++i) {
+				if (previous_points_indices[i] < 0 && pcl::isXYZFinite((*reference_pointcloud)[i])) {
+					changed_voxels.push_back(computeVoxelCoordinates((*reference_pointcloud)[i]));
+				}
+			}
+			for (size_t i = 0; i < removed_points_keys.size(); ++i) {
+				PointT removed_point;
+				removed_point.x = removed_points_keys[i].x; removed_point.y = removed_points_keys[i].y; removed_point.z = removed_points_keys[i].z;
+				changed_voxels.push_back(computeVoxelCoordinates(removed_point));
+			}
+			for (size_t i = 0; i < changed_voxels.size(); ++i) {
+				for (int x = -1; x <= 1; ++x) {
+					for (int y = -1; y <= 1; ++y) {
+						for (int z = -1; z <= 1; ++z) {
+							invalidated_voxels.insert(computeVoxelKey(changed_voxels[i].x() + x, changed_voxels[i].y() + y, changed_voxels[i].z() + z));
+						}
+					}
+				}
+			}
+
+			for (size_t i = 0; i < reference_pointcloud->size(); ++i) {
+				const PointT& point = (*reference_pointcloud)[i];
+				if (!pcl::isXYZFinite(point)) { continue; }
+				Eigen::Vector3i voxel_coordinates = computeVoxelCoordinates(point);
+				if (previous_points_indices[i] < 0 || (!invalidated_voxels.empty() && invalidated_voxels.find(computeVoxelKey(voxel_coordinates.x(), voxel_coordinates.y(), voxel_coordinates.z())) != invalidated_voxels.end())) {
+					recomputed_points_indices.push_back((int)i);
+				} else {
+					(*covariances)[i] = (*reference_covariances_)[previous_points_indices[i]];
+				}
+			}
+
+			computeCovariances(reference_pointcloud, search_method, &recomputed_points_indices, *covariances);
+			number_of_recomputed_covariances_in_last_update_ = recomputed_points_indices.size();
+		}
+	} else {
+		for (size_t i = 0; i < reference_pointcloud->size(); ++i) {
+			points_keys[i] = s_computePointPositionKey((*reference_pointcloud)[i]);
+		}
+	}
+
+	bool covariances_loaded_from_file = false;
+	if (full_recomputation) {
+		std::uint64_t points_hash = covariances_filename_.empty() ? 0 : computePointsHash(*reference_pointcloud);
+		covariances_loaded_from_file = !covariances_filename_.empty() && loadCovariances(covariances_filename_, points_hash, *covariances);
+		if (!covariances_loaded_from_file) {
+			computeCovariances(reference_pointcloud, search_method, nullptr, *covariances);
+			if (!covariances_filename_.empty()) {
+				if (saveCovariances(covariances_filename_, points_hash, *covariances))
+					ROS_INFO_STREAM("Saved " << covariances->size() << " GICP covariances to file " << covariances_filename_);
+				else
+					ROS_WARN_STREAM("Failed to save GICP covariances to file " << covariances_filename_);
+			}
+		}
+		number_of_recomputed_covariances_in_last_update_ = covariances_loaded_from_file ? 0 : reference_pointcloud->size();
+	}
+
+	reference_points_indices_.clear();
+	reference_points_indices_.reserve(reference_pointcloud->size());
+	for (size_t i = 0; i < reference_pointcloud->size(); ++i) {
+		if (pcl::isXYZFinite((*reference_pointcloud)[i])) {
+			reference_points_indices_[points_keys[i]] = (std::uint32_t)i;
+		}
+	}
+
+	reference_covariances_ = covariances;
+	reference_pointcloud_ = reference_pointcloud;
+	reference_pointcloud_size_ = reference_pointcloud->size();
+	reference_pointcloud_stamp_ = reference_pointcloud->header.stamp;
+
+	ROS_DEBUG_STREAM("GeneralizedCovariancesCache " << (covariances_loaded_from_file ? "loaded" : (full_recomputation ? "computed" : "updated")) << " the covariances of " << reference_pointcloud->size() << " reference points ("
+			<< number_of_inserted_points << " inserted points, " << number_of_removed_points << " removed points and " << number_of_recomputed_covariances_in_last_update_ << " recomputed covariances) in " << performance_timer.getElapsedTimeFormated());
+	return reference_covariances_;
+}
+
+
+template<typename PointT>
+typename GeneralizedCovariancesCache<PointT>::MatricesVectorPtr GeneralizedCovariancesCache<PointT>::insertReferencePoints(const typename pcl::PointCloud<PointT>::Ptr& reference_pointcloud,
+		const std::vector<int>& inserted_points_indices, const typename pcl::search::KdTree<PointT>::Ptr& search_method) {
+	if (!reference_pointcloud || !reference_covariances_ || reference_pointcloud != reference_pointcloud_ || reference_pointcloud->size() != reference_pointcloud_size_ + inserted_points_indices.size()
+			|| !search_method || search_method->getInputCloud().get() != reference_pointcloud.get()) {
+		return MatricesVectorPtr();
+	}
+
+	PerformanceTimer performance_timer;
+	performance_timer.start();
+	reference_covariances_->resize(reference_pointcloud->size(), Eigen::Matrix3d::Identity());
+
+	// the inserted points can only be in the neighborhoods of the points within invalidation_voxel_size of them
+	std::unordered_set<int> recomputed_points;
+	std::vector<int> neighbors_indices;
+	std::vector<float> neighbors_squared_distances;
+	for (size_t i = 0; i < inserted_points_indices.size(); ++i) {
+		int point_index = inserted_points_indices[i];
+		if (point_index < 0 || (size_t)point_index >= reference_pointcloud->size()) { continue; }
+		const PointT& point = (*reference_pointcloud)[point_index];
+		if (!pcl::isXYZFinite(point)) { continue; }
+		reference_points_indices_[s_computePointPositionKey(point)] = (std::uint32_t)point_index;
+		recomputed_points.insert(point_index);
+		search_method->radiusSearch(point, invalidation_voxel_size_, neighbors_indices, neighbors_squared_distances);
+		recomputed_points.insert(neighbors_indices.begin(), neighbors_indices.end());
+	}
+
+	std::vector<int> recomputed_points_indices(recomputed_points.begin(), recomputed_points.end());
+	computeCovariances(reference_pointcloud, search_method, &recomputed_points_indices, *reference_covariances_);
+	number_of_recomputed_covariances_in_last_update_ = recomputed_points_indices.size();
+	reference_pointcloud_size_ = reference_pointcloud->size();
+	reference_pointcloud_stamp_ = reference_pointcloud->header.stamp;
+
+	ROS_DEBUG_STREAM("GeneralizedCovariancesCache inserted " << inserted_points_indices.size() << " reference points (" << number_of_recomputed_covariances_in_last_update_ << " recomputed covariances) in " << performance_timer.getElapsedTimeFormated());
+	return reference_covariances_;
+}
+
+
+template<typename PointT>
+typename GeneralizedCovariancesCache<PointT>::MatricesVectorPtr GeneralizedCovariancesCache<PointT>::getAmbientCovariances(const typename pcl::PointCloud<PointT>::ConstPtr& ambient_pointcloud,
+		const typename pcl::search::KdTree<PointT>::Ptr& search_method) {
+	if (!ambient_pointcloud) { return MatricesVectorPtr(); }
+
+	{
+		std::lock_guard<std::mutex> lock(ambient_covariances_mutex_);
+		for (size_t i = 0; i < ambient_covariances_entries_.size(); ++i) {
+			if (s_isAmbientCovariancesEntryOf(ambient_covariances_entries_[i], *ambient_pointcloud)) {
+				return ambient_covariances_entries_[i].covariances;
+			}
+		}
+	}
+
+	// computed without holding the mutex, in order to not block the matchers that are using other ambient point clouds
+	MatricesVectorPtr covariances(new MatricesVector(ambient_pointcloud->size(), Eigen::Matrix3d::Identity()));
+	computeCovariances(ambient_pointcloud, search_method, nullptr, *covariances);
+
+	std::lock_guard<std::mutex> lock(ambient_covariances_mutex_);
+	for (size_t i = 0; i < ambient_covariances_entries_.size(); ++i) {
+		if (s_isAmbientCovariancesEntryOf(ambient_covariances_entries_[i], *ambient_pointcloud)) {
+			return ambient_covariances_entries_[i].covariances; // computed meanwhile by another thread
+		}
+	}
+
+	AmbientCovariancesEntry entry;
+	s_fillAmbientCovariancesEntry(*ambient_pointcloud, covariances, entry);
+	addAmbientCovariancesEntry(entry);
+	return covariances;
+}
+
+
+template<typename PointT>
+void GeneralizedCovariancesCache<PointT>::addAlignedAmbientCovariances(const pcl::PointCloud<PointT>& ambient_pointcloud, const pcl::PointCloud<PointT>& aligned_pointcloud, const Eigen::Matrix4f& transformation) {
+	if (ambient_pointcloud.size() != aligned_pointcloud.size()) { return; }
+
+	std::lock_guard<std::mutex> lock(ambient_covariances_mutex_);
+	MatricesVectorPtr ambient_covariances;
+	for (size_t i = 0; i < ambient_covariances_entries_.size(); ++i) {
+		if (s_isAmbientCovariancesEntryOf(ambient_covariances_entries_[i], ambient_pointcloud)) {
+			ambient_covariances = ambient_covariances_entries_[i].covariances;
+			break;
+		}
+	}
+	if (!ambient_covariances) { return; }
+
+	// the covariances of a rigidly transformed point cloud are rotated: R * C * R^T
+	Eigen::Matrix3d rotation = transformation.topLeftCorner<3, 3>().cast<double>();
+	MatricesVectorPtr aligned_covariances(new MatricesVector(ambient_covariances->size()));
+	for (size_t i = 0; i < ambient_covariances->size(); ++i) {
+		(*aligned_covariances)[i] = rotation * (*ambient_covariances)[i] * rotation.transpose();
+	}
+
+	AmbientCovariancesEntry entry;
+	s_fillAmbientCovariancesEntry(aligned_pointcloud, aligned_covariances, entry);
+	addAmbientCovariancesEntry(entry);
+}
+
+
+template<typename PointT>
+void GeneralizedCovariancesCache<PointT>::clear() {
+	reference_covariances_.reset();
+	reference_points_indices_.clear();
+	reference_pointcloud_.reset();
+	reference_pointcloud_size_ = 0;
+	reference_pointcloud_stamp_ = 0;
+	std::lock_guard<std::mutex> lock(ambient_covariances_mutex_);
+	ambient_covariances_entries_.clear();
+}
+
+
+template<typename PointT>
+void GeneralizedCovariancesCache<PointT>::clearAmbientCovariances() {
+	std::lock_guard<std::mutex> lock(ambient_covariances_mutex_);
+	ambient_covariances_entries_.clear();
+}
+
+
+template<typename PointT>
+size_t GeneralizedCovariancesCache<PointT>::accountMemoryUsage(MemoryUsage& memory_usage) {
+	if (!memory_usage.addObject(this)) { return 0; }
+	size_t bytes = memory_usage.addBytes(sizeof(*this) + MemoryUsage::s_getHashContainerBytes(reference_points_indices_));
+	if (reference_covariances_) { bytes += memory_usage.addBytes(reference_covariances_.get(), sizeof(MatricesVector) + MemoryUsage::s_getVectorBytes(*reference_covariances_)); }
+	bytes += memory_usage.addPointCloud(reference_pointcloud_.get());
+	return bytes + accountAmbientCovariancesMemoryUsage(memory_usage);
+}
+
+
+template<typename PointT>
+size_t GeneralizedCovariancesCache<PointT>::accountAmbientCovariancesMemoryUsage(MemoryUsage& memory_usage) {
+	size_t bytes = 0;
+	std::lock_guard<std::mutex> lock(ambient_covariances_mutex_);
+	for (size_t i = 0; i < ambient_covariances_entries_.size(); ++i) {
+		const MatricesVectorPtr& covariances = ambient_covariances_entries_[i].covariances;
+		if (covariances) { bytes += memory_usage.addBytes(covariances.get(), sizeof(MatricesVector) + MemoryUsage::s_getVectorBytes(*covariances)); }
+	}
+	return bytes;
+}
+
+
+template<typename PointT>
+bool GeneralizedCovariancesCache<PointT>::hasSameConfiguration(const GeneralizedCovariancesCache<PointT>& other) const {
+	return number_of_neighbors_ == other.number_of_neighbors_ && epsilon_ == other.epsilon_ && invalidation_voxel_size_ == other.invalidation_voxel_size_ &&
+			full_recomputation_ratio_ == other.full_recomputation_ratio_ && covariances_filename_ == other.covariances_filename_;
+}
+
+
+template<typename PointT>
+typename GeneralizedCovariancesCache<PointT>::Ptr GeneralizedCovariancesCache<PointT>::cloneConfiguration() const {
+	Ptr covariances_cache(new GeneralizedCovariancesCache<PointT>(number_of_neighbors_, epsilon_));
+	covariances_cache->invalidation_voxel_size_ = invalidation_voxel_size_;
+	covariances_cache->full_recomputation_ratio_ = full_recomputation_ratio_;
+	covariances_cache->covariances_filename_ = covariances_filename_;
+	covariances_cache->number_of_threads_ = number_of_threads_;
+	return covariances_cache;
+}
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </GeneralizedCovariancesCache-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// =============================================================================  </public-section>  ===========================================================================
+
+// =============================================================================   <protected-section>   =======================================================================
+template<typename PointT>
+void GeneralizedCovariancesCache<PointT>::s_fillAmbientCovariancesEntry(const pcl::PointCloud<PointT>& pointcloud, const MatricesVectorPtr& covariances, AmbientCovariancesEntry& entry) {
+	entry.pointcloud = &pointcloud;
+	entry.stamp = pointcloud.header.stamp;
+	entry.number_of_points = pointcloud.size();
+	entry.covariances = covariances;
+	if (pointcloud.empty()) { return; }
+	size_t sample_indices[3] = { 0, pointcloud.size() / 2, pointcloud.size() - 1 };
+	for (size_t i = 0; i < 3; ++i) {
+		entry.sample_positions[i] = Eigen::Vector3f(pointcloud[sample_indices[i]].x, pointcloud[sample_indices[i]].y, pointcloud[sample_indices[i]].z);
+	}
+}
+
+
+template<typename PointT>
+bool GeneralizedCovariancesCache<PointT>::s_isAmbientCovariancesEntryOf(const AmbientCovariancesEntry& entry, const pcl::PointCloud<PointT>& pointcloud) {
+	if (entry.pointcloud != &pointcloud || entry.stamp != pointcloud.header.stamp || entry.number_of_points != pointcloud.size() || pointcloud.empty()) { return false; }
+	size_t sample_indices[3] = { 0, pointcloud.size() / 2, pointcloud.size() - 1 };
+	for (size_t i = 0; i < 3; ++i) {
+		const PointT& point = pointcloud[sample_indices[i]];
+		if (entry.sample_positions[i].x() != point.x || entry.sample_positions[i].y() != point.y || entry.sample_positions[i].z() != point.z) { return false; }
+	}
+	return true;
+}
+
+
+template<typename PointT>
+void GeneralizedCovariancesCache<PointT>::addAmbientCovariancesEntry(const AmbientCovariancesEntry& entry) {
+	for (typename std::deque<AmbientCovariancesEntry>::iterator entry_it = ambient_covariances_entries_.begin(); entry_it != ambient_covariances_entries_.end(); ++entry_it) {
+		if (entry_it->pointcloud == entry.pointcloud) {
+			ambient_covariances_entries_.erase(entry_it);
+			break;
+		}
+	}
+
+	ambient_covariances_entries_.push_front(entry);
+	if (ambient_covariances_entries_.size() > s_maximum_number_of_ambient_entries) {
+		ambient_covariances_entries_.pop_back();
+	}
+}
+
+
+template<typename PointT>
+void GeneralizedCovariancesCache<PointT>::computeCovariances(const typename pcl::PointCloud<PointT>::ConstPtr& pointcloud, const typename pcl::search::KdTree<PointT>::Ptr& search_method,
+		const std::vector<int>* indices, MatricesVector& covariances) {
+	int number_of_points = indices ? (int)indices->size() : (int)pointcloud->size();
+	int number_of_neighbors = std::min(number_of_neighbors_, (int)pointcloud->size());
+	if (number_of_points == 0 || number_of_neighbors < 3) { return; }
+
+	typename pcl::search::KdTree<PointT>::Ptr pointcloud_search_method = search_method;
+	if (!pointcloud_search_method || pointcloud_search_method->getInputCloud().get() != pointcloud.get()) {
+		pointcloud_search_method.reset(new pcl::search::KdTree<PointT>());
+		pointcloud_search_method->setInputCloud(pointcloud);
+	}
+
+	int number_of_threads = 1;
+#ifdef _OPENMP
+	number_of_threads = (number_of_threads_ > 0) ? number_of_threads_ : omp_get_max_threads();
+#endif
+	std::vector< std::vector<int> > threads_neighbors_indices(number_of_threads);
+	std::vector< std::vector<float> > threads_neighbors_squared_distances(number_of_threads);
+
+	#pragma omp parallel for schedule(dynamic, 256) num_threads(number_of_threads)
+	for (int i = 0; i < number_of_points; ++i) {
+#ifdef _OPENMP
+		int thread_number = omp_get_thread_num();
+#else
+		int thread_number = 0;
+#endif
+		int point_index = indices ? (*indices)[i] : i;
+		const PointT& point = (*pointcloud)[point_index];
+		if (!pcl::isXYZFinite(point) || pointcloud_search_method->nearestKSearch(point, number_of_neighbors, threads_neighbors_indices[thread_number], threads_neighbors_squared_distances[thread_number]) < 3) {
+			covariances[point_index].setIdentity();
+		} else {
+			computeCovariance(*pointcloud, threads_neighbors_indices[thread_number], covariances[point_index]);
+		}
+	}
+}
+
+
+template<typename PointT>
+void GeneralizedCovariancesCache<PointT>::computeCovariance(const pcl::PointCloud<PointT>& pointcloud, const std::vector<int>& neighbors_indices, Eigen::Matrix3d& covariance) const {
+	Eigen::Vector3d mean = Eigen::Vector3d::Zero();
+	covariance.setZero();
+	for (size_t j = 0; j < neighbors_indices.size(); ++j) {
+		const PointT& point = pointcloud[neighbors_indices[j]];
+		mean[0] += point.x; mean[1] += point.y; mean[2] += point.z;
+		covariance(0, 0) += point.x * point.x;
+		covariance(1, 0) += point.y * point.x; covariance(1, 1) += point.y * point.y;
+		covariance(2, 0) += point.z * point.x; covariance(2, 1) += point.z * point.y; covariance(2, 2) += point.z * point.z;
+	}
+
+	double number_of_neighbors = (double)neighbors_indices.size();
+	mean /= number_of_neighbors;
+	for (int k = 0; k < 3; ++k) {
+		for (int l = 0; l <= k; ++l) {
+			covariance(k, l) /= number_of_neighbors;
+			covariance(k, l) -= mean[k] * mean[l];
+			covariance(l, k) = covariance(k, l);
+		}
+	}
+
+	// plane-to-plane model -> unit variance in the plane of the neighbors and epsilon variance along its normal
+	Eigen::JacobiSVD<Eigen::Matrix3d> svd(covariance, Eigen::ComputeFullU);
+	Eigen::Matrix3d u = svd.matrixU();
+	covariance.setZero();
+	for (int k = 0; k < 3; ++k) {
+		Eigen::Vector3d column = u.col(k);
+		double variance = (k == 2) ? epsilon_ : 1.0;
+		covariance += variance * column * column.transpose();
+	}
+}
+
+
+template<typename PointT>
+std::uint64_t GeneralizedCovariancesCache<PointT>::computePointsHash(const pcl::PointCloud<PointT>& pointcloud) const {
+	std::uint64_t hash = ReferenceMapBundle<PointT>::s_computeHash(&number_of_neighbors_, sizeof(number_of_neighbors_));
+	hash = ReferenceMapBundle<PointT>::s_computeHash(&epsilon_, sizeof(epsilon_), hash);
+	for (size_t i = 0; i < pointcloud.size(); ++i) {
+		float position[3] = { pointcloud[i].x, pointcloud[i].y, pointcloud[i].z };
+		hash = ReferenceMapBundle<PointT>::s_computeHash(position, sizeof(position), hash);
+	}
+	return hash;
+}
+
+
+template<typename PointT>
+bool GeneralizedCovariancesCache<PointT>::loadCovariances(const std::string& filename, std::uint64_t points_hash, MatricesVector& covariances) const {
+	std::ifstream file(filename, std::ios::binary);
+	if (!file.is_open()) { return false; }
+
+	CovariancesFileHeader header;
+	if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) || std::strncmp(header.magic, "DRLGICV", 8) != 0 || header.format_version != s_covariances_file_format_version ||
+			header.number_of_neighbors != number_of_neighbors_ || header.epsilon != epsilon_ || header.points_hash != points_hash || header.number_of_points != covariances.size()) {
+		ROS_WARN_STREAM("Ignoring outdated GICP covariances file " << filename);
+		return false;
+	}
+
+	std::vector<double> upper_triangles(covariances.size() * 6);
+	if (!file.read(reinterpret_cast<char*>(upper_triangles.data()), upper_triangles.size() * sizeof(double))) { return false; }
+	for (size_t i = 0; i < covariances.size(); ++i) {
+		const double* upper_triangle = &upper_triangles[i * 6];
+		covariances[i] << upper_triangle[0], upper_triangle[1], upper_triangle[2],
+		                  upper_triangle[1], upper_triangle[3], upper_triangle[4],
+		                  upper_triangle[2], upper_triangle[4], upper_triangle[5];
+	}
+
+	ROS_INFO_STREAM("Loaded " << covariances.size() << " GICP covariances from file " << filename);
+	return true;
+}
+
+
+template<typename PointT>
+bool GeneralizedCovariancesCache<PointT>::saveCovariances(const std::string& filename, std::uint64_t points_hash, const MatricesVector& covariances) const {
+	std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+	if (!file.is_open()) { return false; }
+
+	CovariancesFileHeader header;
+	std::memset(&header, 0, sizeof(header));
+	std::memcpy(header.magic, "DRLGICV", 8);
+	header.format_version = s_covariances_file_format_version;
+	header.number_of_neighbors = number_of_neighbors_;
+	header.epsilon = epsilon_;
+	header.points_hash = points_hash;
+	header.number_of_points = covariances.size();
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+	std::vector<double> upper_triangles(covariances.size() * 6);
+	for (size_t i = 0; i < covariances.size(); ++i) {
+		double* upper_triangle = &upper_triangles[i * 6];
+		upper_triangle[0] = covariances[i](0, 0); upper_triangle[1] = covariances[i](0, 1); upper_triangle[2] = covariances[i](0, 2);
+		upper_triangle[3] = covariances[i](1, 1); upper_triangle[4] = covariances[i](1, 2); upper_triangle[5] = covariances[i](2, 2);
+	}
+	file.write(reinterpret_cast<const char*>(upper_triangles.data()), upper_triangles.size() * sizeof(double));
+	return file.good();
+}
+// =============================================================================   </protected-section>  =======================================================================
+
+} /* namespace dynamic_robot_localization */
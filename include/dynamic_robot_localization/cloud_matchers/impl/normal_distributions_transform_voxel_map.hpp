@@ -0,0 +1,602 @@
+/**\file normal_distributions_transform_voxel_map.hpp
+ * \brief Description...
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+#include <dynamic_robot_localization/cloud_matchers/normal_distributions_transform_voxel_map.h>
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+namespace dynamic_robot_localization {
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <imports>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </imports>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+// =============================================================================  <public-section>  ============================================================================
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <constructors-destructor>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+template<typename PointT>
+NormalDistributionsTransformVoxelMap<PointT>::NormalDistributionsTransformVoxelMap() :
+	full_recomputation_ratio_(0.5),
+	number_of_threads_(0),
+	reference_pointcloud_size_(0),
+	reference_pointcloud_stamp_(0),
+	number_of_updated_voxels_in_last_update_(0),
+	number_of_built_voxel_grids_(0) {}
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </constructors-destructor>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <NormalDistributionsTransformVoxelMap-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+template<typename PointT>
+size_t NormalDistributionsTransformVoxelMap<PointT>::addLayer(const LayerConfiguration& layer_configuration) {
+	for (size_t i = 0; i < layers_.size(); ++i) {
+		if (layers_[i].configuration == layer_configuration) { return i; }
+	}
+
+	layers_.push_back(Layer());
+	layers_.back().configuration = layer_configuration;
+	if (reference_pointcloud_) {
+		computeLayer(layers_.back(), *reference_pointcloud_);
+	}
+	return layers_.size() - 1;
+}
+
+
+template<typename PointT>
+bool NormalDistributionsTransformVoxelMap<PointT>::update(const typename pcl::PointCloud<PointT>::Ptr& reference_pointcloud) {
+	if (!reference_pointcloud) { return false; }
+	if (reference_pointcloud == reference_pointcloud_ && reference_pointcloud->size() == reference_pointcloud_size_ && reference_pointcloud->header.stamp == reference_pointcloud_stamp_) {
+		return false; // already updated by another matcher sharing this voxel map
+	}
+
+	PerformanceTimer performance_timer;
+	performance_timer.start();
+
+	std::unordered_map< PointPositionKey, std::uint32_t, PointPositionKeyHash > points_counts;
+	points_counts.reserve(reference_pointcloud->size());
+	size_t number_of_valid_points = 0;
+	for (size_t i = 0; i < reference_pointcloud->size(); ++i) {
+		if (pcl::isXYZFinite((*reference_pointcloud)[i])) {
+			++points_counts[s_computePointPositionKey((*reference_pointcloud)[i])];
+			++number_of_valid_points;
+		}
+	}
+
+	size_t number_of_inserted_points = 0;
+	size_t number_of_removed_points = 0;
+	size_t number_of_previous_points = 0;
+	std::vector< std::pair<PointPositionKey, int> > changed_points;
+	bool full_recomputation = !reference_pointcloud_;
+
+	if (!full_recomputation) {
+		for (typename std::unordered_map< PointPositionKey, std::uint32_t, PointPositionKeyHash >::const_iterator point_it = points_counts.begin(); point_it != points_counts.end(); ++point_it) {
+			typename std::unordered_map< PointPositionKey, std::uint32_t, PointPositionKeyHash >::const_iterator previous_point_it = reference_points_counts_.find(point_it->first);
+			std::uint32_t previous_count = (previous_point_it != reference_points_counts_.end()) ? previous_point_it->second : 0;
+			if (point_it->second > previous_count) {
+				changed_points.push_back(std::make_pair(point_it->first, (int)(point_it->second - previous_count)));
+				number_of_inserted_points += point_it->second - previous_count;
+			}
+		}
+
+		for (typename std::unordered_map< PointPositionKey, std::uint32_t, PointPositionKeyHash >::const_iterator previous_point_it = reference_points_counts_.begin(); previous_point_it != reference_points_counts_.end(); ++previous_point_it) {
+			number_of_previous_points += previous_point_it->second;
+			typename std::unordered_map< PointPositionKey, std::uint32_t, PointPositionKeyHash >::const_iterator point_it = points_counts.find(previous_point_it->first);
+			std::uint32_t count = (point_it != points_counts.end()) ? point_it->second : 0;
+			if (previous_point_it->second > count) {
+				changed_points.push_back(std::make_pair(previous_point_it->first, -(int)(previous_point_it->second - count)));
+				number_of_removed_points += previous_point_it->second - count;
+			}
+		}
+
+		full_recomputation = (number_of_inserted_points + number_of_removed_points) > full_recomputation_ratio_ * (double)number_of_previous_points;
+	}
+
+	bool voxel_map_loaded_from_file = false;
+	number_of_updated_voxels_in_last_update_ = 0;
+	if (full_recomputation) {
+		std::uint64_t points_hash = voxel_map_filename_.empty() ? 0 : computePointsHash(*reference_pointcloud);
+		voxel_map_loaded_from_file = !voxel_map_filename_.empty() && loadVoxelMap(voxel_map_filename_, points_hash, number_of_valid_points);
+		if (!voxel_map_loaded_from_file) {
+			int number_of_layers = (int)layers_.size();
+			int number_of_threads = 1;
+#ifdef _OPENMP
+			number_of_threads = std::min(number_of_layers, (number_of_threads_ > 0) ? number_of_threads_ : omp_get_max_threads());
+#endif
+			#pragma omp parallel for schedule(dynamic, 1) num_threads(std::max(number_of_threads, 1))
+			for (int i = 0; i < number_of_layers; ++i) {
+				layers_[i].voxels.clear();
+				computeLayer(layers_[i], *reference_pointcloud);
+			}
+
+			if (!voxel_map_filename_.empty()) {
+				if (saveVoxelMap(voxel_map_filename_, points_hash, number_of_valid_points))
+					ROS_INFO_STREAM("Saved NDT voxel map with " << layers_.size() << " layers to file " << voxel_map_filename_);
+				else
+					ROS_WARN_STREAM("Failed to save NDT voxel map to file " << voxel_map_filename_);
+			}
+		}
+
+		for (size_t i = 0; i < layers_.size(); ++i) {
+			number_of_updated_voxels_in_last_update_ += layers_[i].voxels.size();
+		}
+	} else {
+		updateLayers(changed_points);
+	}
+
+	reference_points_counts_.swap(points_counts);
+	setReferencePointCloud(reference_pointcloud);
+
+	ROS_DEBUG_STREAM("NormalDistributionsTransformVoxelMap " << (voxel_map_loaded_from_file ? "loaded" : (full_recomputation ? "computed" : "updated")) << " " << layers_.size() << " layers for " << reference_pointcloud->size() << " reference points ("
+			<< number_of_inserted_points << " inserted points, " << number_of_removed_points << " removed points and " << number_of_updated_voxels_in_last_update_ << " updated voxels) in " << performance_timer.getElapsedTimeFormated());
+	return true;
+}
+
+
+template<typename PointT>
+bool NormalDistributionsTransformVoxelMap<PointT>::insertPoints(const typename pcl::PointCloud<PointT>::Ptr& reference_pointcloud, const std::vector<int>& inserted_points_indices) {
+	if (!reference_pointcloud || reference_pointcloud != reference_pointcloud_ || reference_pointcloud->size() != reference_pointcloud_size_ + inserted_points_indices.size()) {
+		return false;
+	}
+
+	PerformanceTimer performance_timer;
+	performance_timer.start();
+	std::vector< std::pair<PointPositionKey, int> > changed_points;
+	changed_points.reserve(inserted_points_indices.size());
+	for (size_t i = 0; i < inserted_points_indices.size(); ++i) {
+		int point_index = inserted_points_indices[i];
+		if (point_index < 0 || (size_t)point_index >= reference_pointcloud->size() || !pcl::isXYZFinite((*reference_pointcloud)[point_index])) { continue; }
+		PointPositionKey key = s_computePointPositionKey((*reference_pointcloud)[point_index]);
+		++reference_points_counts_[key];
+		changed_points.push_back(std::make_pair(key, 1));
+	}
+
+	number_of_updated_voxels_in_last_update_ = 0;
+	updateLayers(changed_points);
+	setReferencePointCloud(reference_pointcloud);
+	ROS_DEBUG_STREAM("NormalDistributionsTransformVoxelMap inserted " << changed_points.size() << " points in " << layers_.size() << " layers (" << number_of_updated_voxels_in_last_update_ << " updated voxels) in " << performance_timer.getElapsedTimeFormated());
+	return true;
+}
+
+
+template<typename PointT>
+bool NormalDistributionsTransformVoxelMap<PointT>::removePoints(const typename pcl::PointCloud<PointT>::Ptr& reference_pointcloud, const pcl::PointCloud<PointT>& removed_points) {
+	if (!reference_pointcloud || reference_pointcloud != reference_pointcloud_) { return false; }
+
+	PerformanceTimer performance_timer;
+	performance_timer.start();
+	std::vector< std::pair<PointPositionKey, int> > changed_points;
+	changed_points.reserve(removed_points.size());
+	for (size_t i = 0; i < removed_points.size(); ++i) {
+		if (!pcl::isXYZFinite(removed_points[i])) { continue; }
+		PointPositionKey key = s_computePointPositionKey(removed_points[i]);
+		typename std::unordered_map< PointPositionKey, std::uint32_t, PointPositionKeyHash >::iterator point_it = reference_points_counts_.find(key);
+		if (point_it == reference_points_counts_.end()) { continue; }
+		if (--point_it->second == 0) { reference_points_counts_.erase(point_it); }
+		changed_points.push_back(std::make_pair(key, -1));
+	}
+
+	number_of_updated_voxels_in_last_update_ = 0;
+	updateLayers(changed_points);
+	setReferencePointCloud(reference_pointcloud);
+	ROS_DEBUG_STREAM("NormalDistributionsTransformVoxelMap removed " << changed_points.size() << " points in " << layers_.size() << " layers (" << number_of_updated_voxels_in_last_update_ << " updated voxels) in " << performance_timer.getElapsedTimeFormated());
+	return true;
+}
+
+
+template<typename PointT>
+void NormalDistributionsTransformVoxelMap<PointT>::clear() {
+	for (size_t i = 0; i < layers_.size(); ++i) {
+		layers_[i].voxels.clear();
+		layers_[i].voxel_grid.reset();
+		layers_[i].voxel_grid_generation = 0;
+	}
+	reference_points_counts_.clear();
+	reference_pointcloud_.reset();
+	reference_pointcloud_size_ = 0;
+	reference_pointcloud_stamp_ = 0;
+}
+
+
+template<typename PointT>
+size_t NormalDistributionsTransformVoxelMap<PointT>::accountMemoryUsage(MemoryUsage& memory_usage) {
+	if (!memory_usage.addObject(this)) { return 0; }
+	size_t bytes = memory_usage.addBytes(sizeof(*this) + MemoryUsage::s_getVectorBytes(layers_) + MemoryUsage::s_getHashContainerBytes(reference_points_counts_));
+	for (size_t i = 0; i < layers_.size(); ++i) {
+		bytes += memory_usage.addBytes(MemoryUsage::s_getHashContainerBytes(layers_[i].voxels));
+		if (layers_[i].voxel_grid) {
+			// the pcl::VoxelGridCovariance has one leaf (std::map node), one centroid and one k-d tree entry per voxel
+			size_t number_of_voxels = layers_[i].voxels.size();
+			size_t voxel_grid_bytes = number_of_voxels * (sizeof(typename pcl::VoxelGridCovariance<PointT>::Leaf) + 4 * sizeof(void*) + sizeof(pcl::PointXYZ)) + MemoryUsage::s_estimateKdTreeBytes(number_of_voxels);
+			bytes += memory_usage.addBytes(layers_[i].voxel_grid.get(), voxel_grid_bytes);
+		}
+	}
+	bytes += memory_usage.addPointCloud(reference_pointcloud_.get());
+	return bytes;
+}
+
+
+template<typename PointT>
+bool NormalDistributionsTransformVoxelMap<PointT>::hasSameConfiguration(const NormalDistributionsTransformVoxelMap<PointT>& other) const {
+	return full_recomputation_ratio_ == other.full_recomputation_ratio_ && voxel_map_filename_ == other.voxel_map_filename_;
+}
+
+
+template<typename PointT>
+typename NormalDistributionsTransformVoxelMap<PointT>::Ptr NormalDistributionsTransformVoxelMap<PointT>::cloneConfiguration() const {
+	Ptr voxel_map(new NormalDistributionsTransformVoxelMap<PointT>());
+	voxel_map->full_recomputation_ratio_ = full_recomputation_ratio_;
+	voxel_map->voxel_map_filename_ = voxel_map_filename_;
+	voxel_map->number_of_threads_ = number_of_threads_;
+	for (size_t i = 0; i < layers_.size(); ++i) {
+		voxel_map->addLayer(layers_[i].configuration); // same layer indices (the matchers register themselves as voxel grid users when they start using the new voxel map)
+	}
+	return voxel_map;
+}
+
+
+template<typename PointT>
+void NormalDistributionsTransformVoxelMap<PointT>::addVoxelGridUser(size_t layer_index) {
+	if (layer_index < layers_.size()) { ++layers_[layer_index].number_of_voxel_grid_users; }
+}
+
+
+template<typename PointT>
+void NormalDistributionsTransformVoxelMap<PointT>::removeVoxelGridUser(size_t layer_index) {
+	if (layer_index < layers_.size() && layers_[layer_index].number_of_voxel_grid_users > 0) { --layers_[layer_index].number_of_voxel_grid_users; }
+}
+
+
+template<typename PointT>
+std::shared_ptr< pcl::VoxelGridCovariance<PointT> > NormalDistributionsTransformVoxelMap<PointT>::acquireVoxelGrid(size_t layer_index) {
+	if (layer_index >= layers_.size()) { return nullptr; }
+	Layer& layer = layers_[layer_index];
+	std::shared_ptr< pcl::VoxelGridCovariance<PointT> > voxel_grid = layer.voxel_grid;
+	if (voxel_grid && ++layer.number_of_voxel_grid_acquisitions >= layer.number_of_voxel_grid_users) {
+		layer.voxel_grid.reset(); // the users keep their own copy of the voxel grid (pcl::NormalDistributionsTransform keeps it by value)
+	}
+	return voxel_grid;
+}
+
+
+template<typename PointT>
+const typename NormalDistributionsTransformVoxelMap<PointT>::Voxel* NormalDistributionsTransformVoxelMap<PointT>::findVoxel(size_t layer_index, float x, float y, float z) const {
+	const Layer& layer = layers_[layer_index];
+	typename std::unordered_map<VoxelKey, Voxel>::const_iterator voxel_it = layer.voxels.find(s_computeVoxelKey(s_computeVoxelCoordinates(layer.configuration, x, y, z)));
+	return (voxel_it != layer.voxels.end()) ? &voxel_it->second : nullptr;
+}
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </NormalDistributionsTransformVoxelMap-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// =============================================================================  </public-section>  ===========================================================================
+
+// =============================================================================   <protected-section>   =======================================================================
+template<typename PointT>
+void NormalDistributionsTransformVoxelMap<PointT>::VoxelGridCovarianceFromLayer::setupFromLayer(const Layer& layer) {
+	using VoxelGridCovariance = pcl::VoxelGridCovariance<PointT>;
+	VoxelGridCovariance::setLeafSize((float)layer.configuration.voxel_size.x(), (float)layer.configuration.voxel_size.y(), (float)layer.configuration.voxel_size.z());
+	VoxelGridCovariance::searchable_ = true;
+	VoxelGridCovariance::leaves_.clear();
+	VoxelGridCovariance::voxel_centroids_.reset(new pcl::PointCloud<PointT>());
+	VoxelGridCovariance::voxel_centroids_leaf_indices_.clear();
+
+	Eigen::Vector3i min_coordinates = Eigen::Vector3i::Constant(std::numeric_limits<int>::max());
+	Eigen::Vector3i max_coordinates = Eigen::Vector3i::Constant(std::numeric_limits<int>::min());
+	for (typename std::unordered_map<VoxelKey, Voxel>::const_iterator voxel_it = layer.voxels.begin(); voxel_it != layer.voxels.end(); ++voxel_it) {
+		min_coordinates = min_coordinates.cwiseMin(voxel_it->second.coordinates);
+		max_coordinates = max_coordinates.cwiseMax(voxel_it->second.coordinates);
+	}
+	if (layer.voxels.empty()) { min_coordinates.setZero(); max_coordinates.setZero(); }
+
+	// same leaves layout as pcl::VoxelGridCovariance::applyFilter (allows to use getLeaf)
+	VoxelGridCovariance::min_b_ = Eigen::Vector4i(min_coordinates.x(), min_coordinates.y(), min_coordinates.z(), 0);
+	VoxelGridCovariance::max_b_ = Eigen::Vector4i(max_coordinates.x(), max_coordinates.y(), max_coordinates.z(), 0);
+	VoxelGridCovariance::div_b_ = VoxelGridCovariance::max_b_ - VoxelGridCovariance::min_b_ + Eigen::Vector4i::Ones();
+	VoxelGridCovariance::div_b_[3] = 0;
+	VoxelGridCovariance::divb_mul_ = Eigen::Vector4i(1, VoxelGridCovariance::div_b_[0], VoxelGridCovariance::div_b_[0] * VoxelGridCovariance::div_b_[1], 0);
+
+	for (typename std::unordered_map<VoxelKey, Voxel>::const_iterator voxel_it = layer.voxels.begin(); voxel_it != layer.voxels.end(); ++voxel_it) {
+		const Voxel& voxel = voxel_it->second;
+		if (!voxel.valid) { continue; }
+		Eigen::Vector3i layout_coordinates = voxel.coordinates - min_coordinates;
+		size_t leaf_index = (size_t)layout_coordinates.x() + (size_t)layout_coordinates.y() * (size_t)VoxelGridCovariance::divb_mul_[1] + (size_t)layout_coordinates.z() * (size_t)VoxelGridCovariance::divb_mul_[2];
+		typename VoxelGridCovariance::Leaf& leaf = VoxelGridCovariance::leaves_[leaf_index];
+		leaf.nr_points = (int)voxel.number_of_points;
+		leaf.mean_ = voxel.mean;
+		leaf.centroid = voxel.mean.template cast<float>();
+		leaf.cov_ = voxel.covariance;
+		leaf.icov_ = voxel.inverse_covariance;
+		leaf.evecs_ = voxel.eigenvectors;
+		leaf.evals_ = voxel.eigenvalues;
+	}
+
+	// centroids sorted by leaf index (same order as pcl::VoxelGridCovariance)
+	VoxelGridCovariance::voxel_centroids_->reserve(VoxelGridCovariance::leaves_.size());
+	VoxelGridCovariance::voxel_centroids_leaf_indices_.reserve(VoxelGridCovariance::leaves_.size());
+	for (typename std::map<size_t, typename VoxelGridCovariance::Leaf>::const_iterator leaf_it = VoxelGridCovariance::leaves_.begin(); leaf_it != VoxelGridCovariance::leaves_.end(); ++leaf_it) {
+		PointT centroid;
+		centroid.x = leaf_it->second.centroid[0];
+		centroid.y = leaf_it->second.centroid[1];
+		centroid.z = leaf_it->second.centroid[2];
+		VoxelGridCovariance::voxel_centroids_->push_back(centroid);
+		VoxelGridCovariance::voxel_centroids_leaf_indices_.push_back((int)leaf_it->first);
+	}
+
+	if (!VoxelGridCovariance::voxel_centroids_->empty()) {
+		VoxelGridCovariance::kdtree_.setInputCloud(VoxelGridCovariance::voxel_centroids_);
+	}
+}
+
+
+template<typename PointT>
+void NormalDistributionsTransformVoxelMap<PointT>::updateLayers(const std::vector< std::pair<PointPositionKey, int> >& changed_points) {
+	for (size_t i = 0; i < layers_.size(); ++i) {
+		std::unordered_set<VoxelKey> updated_voxels;
+		for (size_t j = 0; j < changed_points.size(); ++j) {
+			s_updateVoxelStatistics(layers_[i], changed_points[j].first, changed_points[j].second, &updated_voxels);
+		}
+
+		if (!updated_voxels.empty()) {
+			computeNormalDistributions(layers_[i], &updated_voxels);
+			buildVoxelGrid(layers_[i]);
+			number_of_updated_voxels_in_last_update_ += updated_voxels.size();
+		}
+	}
+}
+
+
+template<typename PointT>
+void NormalDistributionsTransformVoxelMap<PointT>::setReferencePointCloud(const typename pcl::PointCloud<PointT>::Ptr& reference_pointcloud) {
+	reference_pointcloud_ = reference_pointcloud;
+	reference_pointcloud_size_ = reference_pointcloud->size();
+	reference_pointcloud_stamp_ = reference_pointcloud->header.stamp;
+}
+
+
+template<typename PointT>
+void NormalDistributionsTransformVoxelMap<PointT>::s_updateVoxelStatistics(Layer& layer, const PointPositionKey& point_position, int number_of_points, std::unordered_set<VoxelKey>* updated_voxels) {
+	Eigen::Vector3i voxel_coordinates = s_computeVoxelCoordinates(layer.configuration, point_position.x, point_position.y, point_position.z);
+	VoxelKey voxel_key = s_computeVoxelKey(voxel_coordinates);
+	typename std::unordered_map<VoxelKey, Voxel>::iterator voxel_it = layer.voxels.find(voxel_key);
+	if (voxel_it == layer.voxels.end()) {
+		if (number_of_points <= 0) { return; }
+		Voxel& voxel = layer.voxels[voxel_key];
+		voxel.coordinates = voxel_coordinates;
+		voxel.number_of_points = 0;
+		voxel.sum_of_points.setZero();
+		voxel.sum_of_outer_products.setZero();
+		voxel.valid = false;
+		voxel_it = layer.voxels.find(voxel_key);
+	}
+
+	Voxel& voxel = voxel_it->second;
+	Eigen::Vector3d point((double)point_position.x, (double)point_position.y, (double)point_position.z);
+	voxel.number_of_points = (std::uint32_t)std::max((int)voxel.number_of_points + number_of_points, 0);
+	voxel.sum_of_points += number_of_points * point;
+	voxel.sum_of_outer_products += number_of_points * (point * point.transpose());
+	if (updated_voxels) { updated_voxels->insert(voxel_key); }
+}
+
+
+template<typename PointT>
+void NormalDistributionsTransformVoxelMap<PointT>::s_computeNormalDistribution(LayerType layer_type, Voxel& voxel) {
+	voxel.valid = false;
+	double number_of_points = (double)voxel.number_of_points;
+
+	if (layer_type == PlanarLayer) {
+		// same estimation as pcl::ndt2d::NormalDist::estimateParams (maximum likelihood covariance, with the smallest eigenvalue limited to 0.001 of the largest one)
+		if (voxel.number_of_points < s_planar_layer_min_number_of_points) { return; }
+		Eigen::Vector2d sum_of_points = voxel.sum_of_points.template head<2>();
+		Eigen::Vector2d mean = sum_of_points / number_of_points;
+		Eigen::Matrix2d covariance = (voxel.sum_of_outer_products.template topLeftCorner<2, 2>() - 2 * (sum_of_points * mean.transpose())) / number_of_points + mean * mean.transpose();
+		Eigen::SelfAdjointEigenSolver<Eigen::Matrix2d> solver(covariance);
+		Eigen::Vector2d eigenvalues = solver.eigenvalues();
+		if (eigenvalues[0] < 0.001 * eigenvalues[1]) {
+			eigenvalues[0] = eigenvalues[1] * 0.001;
+			covariance = solver.eigenvectors() * eigenvalues.asDiagonal() * solver.eigenvectors().transpose();
+		}
+
+		voxel.mean << mean, 0.0;
+		voxel.covariance.setZero();
+		voxel.covariance.template topLeftCorner<2, 2>() = covariance;
+		voxel.inverse_covariance.setZero();
+		voxel.inverse_covariance.template topLeftCorner<2, 2>() = covariance.inverse();
+		voxel.eigenvectors.setIdentity();
+		voxel.eigenvectors.template topLeftCorner<2, 2>() = solver.eigenvectors();
+		voxel.eigenvalues << eigenvalues, 0.0;
+		voxel.valid = voxel.inverse_covariance.allFinite();
+		return;
+	}
+
+	// same estimation as pcl::VoxelGridCovariance::applyFilter (eigenvalues limited to 0.01 of the largest one)
+	if (voxel.number_of_points < s_volumetric_layer_min_number_of_points) { return; }
+	voxel.mean = voxel.sum_of_points / number_of_points;
+	voxel.covariance = (voxel.sum_of_outer_products - 2 * (voxel.sum_of_points * voxel.mean.transpose())) / number_of_points + voxel.mean * voxel.mean.transpose();
+	voxel.covariance *= (number_of_points - 1.0) / number_of_points;
+
+	Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> solver(voxel.covariance);
+	Eigen::Matrix3d eigenvalues = solver.eigenvalues().asDiagonal();
+	voxel.eigenvectors = solver.eigenvectors();
+	if (eigenvalues(0, 0) < 0 || eigenvalues(1, 1) < 0 || eigenvalues(2, 2) <= 0) { return; }
+
+	double min_covariance_eigenvalue = 0.01 * eigenvalues(2, 2);
+	if (eigenvalues(0, 0) < min_covariance_eigenvalue) {
+		eigenvalues(0, 0) = min_covariance_eigenvalue;
+		if (eigenvalues(1, 1) < min_covariance_eigenvalue) {
+			eigenvalues(1, 1) = min_covariance_eigenvalue;
+		}
+		voxel.covariance = voxel.eigenvectors * eigenvalues * voxel.eigenvectors.inverse();
+	}
+	voxel.eigenvalues = eigenvalues.diagonal();
+	voxel.inverse_covariance = voxel.covariance.inverse();
+	voxel.valid = voxel.inverse_covariance.allFinite();
+}
+
+
+template<typename PointT>
+void NormalDistributionsTransformVoxelMap<PointT>::computeLayer(Layer& layer, const pcl::PointCloud<PointT>& pointcloud) {
+	layer.voxels.clear();
+	for (size_t i = 0; i < pointcloud.size(); ++i) {
+		if (pcl::isXYZFinite(pointcloud[i])) {
+			s_updateVoxelStatistics(layer, s_computePointPositionKey(pointcloud[i]), 1, nullptr);
+		}
+	}
+	computeNormalDistributions(layer, nullptr);
+	buildVoxelGrid(layer);
+}
+
+
+template<typename PointT>
+void NormalDistributionsTransformVoxelMap<PointT>::computeNormalDistributions(Layer& layer, const std::unordered_set<VoxelKey>* updated_voxels) {
+	std::vector<Voxel*> voxels;
+	if (updated_voxels) {
+		voxels.reserve(updated_voxels->size());
+		for (typename std::unordered_set<VoxelKey>::const_iterator voxel_key_it = updated_voxels->begin(); voxel_key_it != updated_voxels->end(); ++voxel_key_it) {
+			typename std::unordered_map<VoxelKey, Voxel>::iterator voxel_it = layer.voxels.find(*voxel_key_it);
+			if (voxel_it == layer.voxels.end()) { continue; }
+			if (voxel_it->second.number_of_points == 0) {
+				layer.voxels.erase(voxel_it);
+			} else {
+				voxels.push_back(&voxel_it->second);
+			}
+		}
+	} else {
+		voxels.reserve(layer.voxels.size());
+		for (typename std::unordered_map<VoxelKey, Voxel>::iterator voxel_it = layer.voxels.begin(); voxel_it != layer.voxels.end(); ++voxel_it) {
+			voxels.push_back(&voxel_it->second);
+		}
+	}
+
+	int number_of_voxels = (int)voxels.size();
+	int number_of_threads = 1;
+#ifdef _OPENMP
+	number_of_threads = (number_of_threads_ > 0) ? number_of_threads_ : omp_get_max_threads();
+#endif
+	#pragma omp parallel for schedule(dynamic, 256) num_threads(number_of_threads) if(number_of_voxels > 1024)
+	for (int i = 0; i < number_of_voxels; ++i) {
+		s_computeNormalDistribution(layer.configuration.type, *voxels[i]);
+	}
+}
+
+
+template<typename PointT>
+void NormalDistributionsTransformVoxelMap<PointT>::buildVoxelGrid(Layer& layer) {
+	if (layer.configuration.type != VolumetricLayer) { return; }
+	// new voxel grid because the previous one may still be used by the matchers
+	std::shared_ptr<VoxelGridCovarianceFromLayer> voxel_grid(new VoxelGridCovarianceFromLayer());
+	voxel_grid->setupFromLayer(layer);
+	layer.voxel_grid = voxel_grid;
+	layer.voxel_grid_generation = ++number_of_built_voxel_grids_;
+	layer.number_of_voxel_grid_acquisitions = 0;
+}
+
+
+template<typename PointT>
+std::uint64_t NormalDistributionsTransformVoxelMap<PointT>::computePointsHash(const pcl::PointCloud<PointT>& pointcloud) const {
+	std::uint32_t format_version = s_voxel_map_file_format_version;
+	std::uint64_t hash = ReferenceMapBundle<PointT>::s_computeHash(&format_version, sizeof(format_version));
+	for (size_t i = 0; i < layers_.size(); ++i) {
+		std::int32_t layer_type = (std::int32_t)layers_[i].configuration.type;
+		hash = ReferenceMapBundle<PointT>::s_computeHash(&layer_type, sizeof(layer_type), hash);
+		hash = ReferenceMapBundle<PointT>::s_computeHash(layers_[i].configuration.voxel_size.data(), 3 * sizeof(double), hash);
+		hash = ReferenceMapBundle<PointT>::s_computeHash(layers_[i].configuration.origin.data(), 3 * sizeof(double), hash);
+	}
+	for (size_t i = 0; i < pointcloud.size(); ++i) {
+		float position[3] = { pointcloud[i].x, pointcloud[i].y, pointcloud[i].z };
+		hash = ReferenceMapBundle<PointT>::s_computeHash(position, sizeof(position), hash);
+	}
+	return hash;
+}
+
+
+template<typename PointT>
+bool NormalDistributionsTransformVoxelMap<PointT>::loadVoxelMap(const std::string& filename, std::uint64_t points_hash, size_t number_of_points) {
+	std::ifstream file(filename, std::ios::binary);
+	if (!file.is_open()) { return false; }
+
+	VoxelMapFileHeader header;
+	if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) || std::strncmp(header.magic, "DRLNDTM", 8) != 0 || header.format_version != s_voxel_map_file_format_version ||
+			header.number_of_layers != layers_.size() || header.points_hash != points_hash || header.number_of_points != number_of_points) {
+		ROS_WARN_STREAM("Ignoring outdated NDT voxel map file " << filename);
+		return false;
+	}
+
+	std::vector<Layer> layers(layers_.size());
+	for (size_t i = 0; i < layers.size(); ++i) {
+		layers[i].configuration = layers_[i].configuration;
+		layers[i].number_of_voxel_grid_users = layers_[i].number_of_voxel_grid_users;
+		std::uint64_t number_of_voxels = 0;
+		if (!file.read(reinterpret_cast<char*>(&number_of_voxels), sizeof(number_of_voxels))) { return false; }
+
+		// coordinates (3 int32), number of points (uint32), sum of points (3 doubles) and upper triangle of the sum of outer products (6 doubles)
+		std::vector<char> voxels_data(number_of_voxels * (4 * sizeof(std::int32_t) + 9 * sizeof(double)));
+		if (!file.read(voxels_data.data(), voxels_data.size())) { return false; }
+
+		layers[i].voxels.reserve(number_of_voxels);
+		const char* voxel_data = voxels_data.data();
+		for (std::uint64_t j = 0; j < number_of_voxels; ++j) {
+			std::int32_t coordinates[3];
+			std::uint32_t voxel_number_of_points;
+			double sums[9];
+			std::memcpy(coordinates, voxel_data, sizeof(coordinates)); voxel_data += sizeof(coordinates);
+			std::memcpy(&voxel_number_of_points, voxel_data, sizeof(voxel_number_of_points)); voxel_data += sizeof(voxel_number_of_points);
+			std::memcpy(sums, voxel_data, sizeof(sums)); voxel_data += sizeof(sums);
+
+			Eigen::Vector3i voxel_coordinates(coordinates[0], coordinates[1], coordinates[2]);
+			Voxel& voxel = layers[i].voxels[s_computeVoxelKey(voxel_coordinates)];
+			voxel.coordinates = voxel_coordinates;
+			voxel.number_of_points = voxel_number_of_points;
+			voxel.sum_of_points << sums[0], sums[1], sums[2];
+			voxel.sum_of_outer_products << sums[3], sums[4], sums[5],
+			                               sums[4], sums[6], sums[7],
+			                               sums[5], sums[7], sums[8];
+			voxel.valid = false;
+		}
+	}
+
+	for (size_t i = 0; i < layers.size(); ++i) {
+		computeNormalDistributions(layers[i], nullptr);
+		buildVoxelGrid(layers[i]);
+	}
+	layers_.swap(layers);
+
+	ROS_INFO_STREAM("Loaded NDT voxel map with " << layers_.size() << " layers from file " << filename);
+	return true;
+}
+
+
+template<typename PointT>
+bool NormalDistributionsTransformVoxelMap<PointT>::saveVoxelMap(const std::string& filename, std::uint64_t points_hash, size_t number_of_points) const {
+	std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+	if (!file.is_open()) { return false; }
+
+	VoxelMapFileHeader header;
+	std::memset(&header, 0, sizeof(header));
+	std::memcpy(header.magic, "DRLNDTM", 8);
+	header.format_version = s_voxel_map_file_format_version;
+	header.number_of_layers = (std::uint32_t)layers_.size();
+	header.points_hash = points_hash;
+	header.number_of_points = number_of_points;
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+	for (size_t i = 0; i < layers_.size(); ++i) {
+		std::uint64_t number_of_voxels = layers_[i].voxels.size();
+		file.write(reinterpret_cast<const char*>(&number_of_voxels), sizeof(number_of_voxels));
+
+		std::vector<char> voxels_data(number_of_voxels * (4 * sizeof(std::int32_t) + 9 * sizeof(double)));
+		char* voxel_data = voxels_data.data();
+		for (typename std::unordered_map<VoxelKey, Voxel>::const_iterator voxel_it = layers_[i].voxels.begin(); voxel_it != layers_[i].voxels.end(); ++voxel_it) {
+			const Voxel& voxel = voxel_it->second;
+			std::int32_t coordinates[3] = { voxel.coordinates.x(), voxel.coordinates.y(), voxel.coordinates.z() };
+			double sums[9] = { voxel.sum_of_points.x(), voxel.sum_of_points.y(), voxel.sum_of_points.z(),
+			                   voxel.sum_of_outer_products(0, 0), voxel.sum_of_outer_products(0, 1), voxel.sum_of_outer_products(0, 2),
+			                   voxel.sum_of_outer_products(1, 1), voxel.sum_of_outer_products(1, 2), voxel.sum_of_outer_products(2, 2) };
+			std::memcpy(voxel_data, coordinates, sizeof(coordinates)); voxel_data += sizeof(coordinates);
+			std::memcpy(voxel_data, &voxel.number_of_points, sizeof(voxel.number_of_points)); voxel_data += sizeof(voxel.number_of_points);
+			std::memcpy(voxel_data, sums, sizeof(sums)); voxel_data += sizeof(sums);
+		}
+		file.write(voxels_data.data(), voxels_data.size());
+	}
+
+	return file.good();
+}
+// =============================================================================   </protected-section>  =======================================================================
+
+} /* namespace dynamic_robot_localization */
@@ -0,0 +1,247 @@
+#pragma once
+
+/**\file normal_distributions_transform_voxel_map.h
+ * \brief Multi-resolution voxel map of normal distributions, shared by the normal distributions transform matchers and updated incrementally when the reference point cloud changes
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>  <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// std includes
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// ROS includes
+#include <ros/ros.h>
+
+// PCL includes
+#include <pcl/common/point_tests.h>
+#include <pcl/filters/voxel_grid_covariance.h>
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+
+// external libs includes
+#include <Eigen/Core>
+#include <Eigen/Eigenvalues>
+
+// project includes
+#include <dynamic_robot_localization/common/memory_usage.h>
+#include <dynamic_robot_localization/common/performance_timer.h>
+#include <dynamic_robot_localization/common/reference_map_bundle.h>
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+namespace dynamic_robot_localization {
+// ################################################################   NormalDistributionsTransformVoxelMap   #################################################################
+/**
+ * \brief Keeps the normal distributions of the reference point cloud in several layers of voxels (one for each voxel size and origin requested by the matchers).
+ * Each voxel stores the number of points and the sums of their positions and outer products, which allows to insert and remove points without revisiting the other points.
+ * When the reference point cloud changes, its points are matched by position with the previous reference point cloud and only the voxels with inserted or removed points
+ * have their normal distributions recomputed (full recomputation when most of the points changed).
+ * When the caller knows which points changed (for example, the points appended by VoxelHashSearch::insertPoints), insertPoints and removePoints
+ * update the voxels without matching all the points of the reference point cloud.
+ * Planar layers have 2D distributions (same estimation as pcl::NormalDistributionsTransform2D) and volumetric layers have 3D distributions
+ * (same estimation as the pcl::VoxelGridCovariance of pcl::NormalDistributionsTransform, which is also built for each volumetric layer and handed over to the matchers that use it).
+ * When all the voxels are computed, the layers can be loaded from / saved to a file, which is only accepted if it was computed with the same points and layers.
+ * The voxel map is read only during the registrations, which allows to share it between matchers running in several threads (updates are not thread safe).
+ */
+template <typename PointT>
+class NormalDistributionsTransformVoxelMap {
+	// ========================================================================   <public-section>   ===========================================================================
+	public:
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <usings>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		using Ptr = std::shared_ptr< NormalDistributionsTransformVoxelMap<PointT> >;
+		using ConstPtr = std::shared_ptr< const NormalDistributionsTransformVoxelMap<PointT> >;
+		using VoxelKey = std::uint64_t;
+
+		enum LayerType {
+			PlanarLayer = 0,     // voxels are columns along z (the z voxel size is ignored)
+			VolumetricLayer = 1  // voxels aligned with the origin of the reference point cloud frame (the origin is ignored)
+		};
+
+		struct LayerConfiguration {
+			LayerType type;
+			Eigen::Vector3d voxel_size;
+			Eigen::Vector3d origin;
+			bool operator==(const LayerConfiguration& other) const { return type == other.type && voxel_size == other.voxel_size && origin == other.origin; }
+		};
+
+		struct Voxel {
+			Eigen::Vector3i coordinates;
+			std::uint32_t number_of_points;
+			Eigen::Vector3d sum_of_points;
+			Eigen::Matrix3d sum_of_outer_products;
+			bool valid; // true if the normal distribution was estimated (planar layers only use the top left 2x2 blocks)
+			Eigen::Vector3d mean;
+			Eigen::Matrix3d covariance;
+			Eigen::Matrix3d inverse_covariance;
+			Eigen::Matrix3d eigenvectors;
+			Eigen::Vector3d eigenvalues;
+		};
+
+		struct Layer {
+			LayerConfiguration configuration;
+			std::unordered_map<VoxelKey, Voxel> voxels;
+			std::shared_ptr< pcl::VoxelGridCovariance<PointT> > voxel_grid; // only for volumetric layers (released after being acquired by all its users)
+			std::uint64_t voxel_grid_generation = 0; // 0 -> no voxel grid was built
+			size_t number_of_voxel_grid_users = 0;
+			size_t number_of_voxel_grid_acquisitions = 0;
+		};
+
+		struct PointPositionKey {
+			float x, y, z;
+			bool operator==(const PointPositionKey& other) const { return x == other.x && y == other.y && z == other.z; }
+		};
+
+		struct PointPositionKeyHash {
+			size_t operator()(const PointPositionKey& key) const {
+				std::uint32_t bits[3];
+				std::memcpy(bits, &key, sizeof(bits));
+				return (size_t)((std::uint64_t)bits[0] * 73856093u ^ (std::uint64_t)bits[1] * 19349663u ^ (std::uint64_t)bits[2] * 83492791u);
+			}
+		};
+
+		struct VoxelMapFileHeader {
+			char magic[8];
+			std::uint32_t format_version;
+			std::uint32_t number_of_layers;
+			std::uint64_t points_hash;
+			std::uint64_t number_of_points;
+		};
+
+		static const std::uint32_t s_voxel_map_file_format_version = 1;
+		static const std::uint32_t s_planar_layer_min_number_of_points = 3;      // same as pcl::ndt2d::NormalDist
+		static const std::uint32_t s_volumetric_layer_min_number_of_points = 6;  // same as pcl::VoxelGridCovariance
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </usings>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <constructors-destructor>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		NormalDistributionsTransformVoxelMap();
+		virtual ~NormalDistributionsTransformVoxelMap() {}
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </constructors-destructor>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <NormalDistributionsTransformVoxelMap-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		/*! Returns the index of the layer (layers with the same configuration are reused). If the voxel map already has a reference point cloud, the new layer is computed immediately. */
+		size_t addLayer(const LayerConfiguration& layer_configuration);
+
+		/*! Returns true if the voxel map was updated (false if it was already updated with this reference point cloud by another matcher). */
+		bool update(const typename pcl::PointCloud<PointT>::Ptr& reference_pointcloud);
+		/*! Adds the points with the given indices, which must have been appended to the reference point cloud given in the last update / insertPoints / removePoints.
+		 * Returns false if the voxel map is not in sync with the reference point cloud (and update must be used instead). */
+		bool insertPoints(const typename pcl::PointCloud<PointT>::Ptr& reference_pointcloud, const std::vector<int>& inserted_points_indices);
+		/*! Removes the points with the positions of removed_points, which must have been removed from the reference point cloud given in the last update / insertPoints / removePoints.
+		 * Returns false if the voxel map is not in sync with the reference point cloud (and update must be used instead). */
+		bool removePoints(const typename pcl::PointCloud<PointT>::Ptr& reference_pointcloud, const pcl::PointCloud<PointT>& removed_points);
+		void clear();
+		bool hasSameConfiguration(const NormalDistributionsTransformVoxelMap<PointT>& other) const;
+		/*! New empty voxel map with the same configuration and layers (allows to prepare the voxel map of a new reference point cloud while this one is still being used by the matchers). */
+		Ptr cloneConfiguration() const;
+		/*! @return number of bytes added to memory_usage (0 if this voxel map was already accounted by another matcher) */
+		size_t accountMemoryUsage(MemoryUsage& memory_usage);
+
+		/*! The matchers that copy the voxel grid of a volumetric layer into pcl::NormalDistributionsTransform must be registered as its users (and removed when they stop using the voxel map). */
+		void addVoxelGridUser(size_t layer_index);
+		void removeVoxelGridUser(size_t layer_index);
+		/*! Gives the voxel grid of the layer to one of its users (once per voxel grid generation). After all the users acquired the voxel grid, the voxel map releases it,
+		 * and the last user is its only owner (and can move it instead of copying it). Returns nullptr if the voxel grid was already released. */
+		std::shared_ptr< pcl::VoxelGridCovariance<PointT> > acquireVoxelGrid(size_t layer_index);
+
+		/*! Returns nullptr if the voxel of the point is not in the layer. */
+		const Voxel* findVoxel(size_t layer_index, float x, float y, float z) const;
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </NormalDistributionsTransformVoxelMap-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <gets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		inline size_t getNumberOfLayers() const { return layers_.size(); }
+		inline const Layer& getLayer(size_t layer_index) const { return layers_[layer_index]; }
+		/*! Voxel grid with the same layout as the one built by pcl::NormalDistributionsTransform (nullptr for planar layers and after being acquired by all its users). */
+		inline std::shared_ptr< const pcl::VoxelGridCovariance<PointT> > getVoxelGrid(size_t layer_index) const { return layer_index < layers_.size() ? layers_[layer_index].voxel_grid : nullptr; }
+		/*! Changes every time the voxel grid of the layer is rebuilt (0 if it was never built). */
+		inline std::uint64_t getVoxelGridGeneration(size_t layer_index) const { return layer_index < layers_.size() ? layers_[layer_index].voxel_grid_generation : 0; }
+		inline const typename pcl::PointCloud<PointT>::Ptr& getReferencePointCloud() const { return reference_pointcloud_; }
+		inline double getFullRecomputationRatio() const { return full_recomputation_ratio_; }
+		inline const std::string& getVoxelMapFilename() const { return voxel_map_filename_; }
+		inline int getNumberOfThreads() const { return number_of_threads_; }
+		inline size_t getNumberOfUpdatedVoxelsInLastUpdate() const { return number_of_updated_voxels_in_last_update_; }
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </gets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <sets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		/*! All the voxels are recomputed when the number of inserted and removed points is higher than this ratio of the number of points in the voxel map. */
+		inline void setFullRecomputationRatio(double full_recomputation_ratio) { full_recomputation_ratio_ = full_recomputation_ratio; }
+		/*! If not empty, the layers are loaded from / saved to this file when all the voxels must be computed. */
+		inline void setVoxelMapFilename(const std::string& voxel_map_filename) { voxel_map_filename_ = voxel_map_filename; }
+		/*! If <= 0, omp_get_max_threads() is used. */
+		inline void setNumberOfThreads(int number_of_threads) { number_of_threads_ = number_of_threads; }
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </sets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+	// ========================================================================   </public-section>  ===========================================================================
+
+	// ========================================================================   <protected-section>   ========================================================================
+	protected:
+		/*! Fills the protected members of pcl::VoxelGridCovariance from a volumetric layer (which avoids binning the points and decomposing the covariances of all the voxels again). */
+		class VoxelGridCovarianceFromLayer : public pcl::VoxelGridCovariance<PointT> {
+			public:
+				void setupFromLayer(const Layer& layer);
+		};
+
+		static inline PointPositionKey s_computePointPositionKey(const PointT& point) {
+			PointPositionKey key = { point.x + 0.0f, point.y + 0.0f, point.z + 0.0f }; // + 0.0f converts -0.0f to 0.0f (both must have the same hash)
+			return key;
+		}
+
+		static inline VoxelKey s_computeVoxelKey(const Eigen::Vector3i& voxel_coordinates) {
+			return ((VoxelKey)(voxel_coordinates.x() & 0x1FFFFF) << 42) | ((VoxelKey)(voxel_coordinates.y() & 0x1FFFFF) << 21) | (VoxelKey)(voxel_coordinates.z() & 0x1FFFFF);
+		}
+
+		static inline Eigen::Vector3i s_computeVoxelCoordinates(const LayerConfiguration& layer_configuration, float x, float y, float z) {
+			if (layer_configuration.type == PlanarLayer) {
+				return Eigen::Vector3i((int)std::floor((x - layer_configuration.origin.x()) / layer_configuration.voxel_size.x()), (int)std::floor((y - layer_configuration.origin.y()) / layer_configuration.voxel_size.y()), 0);
+			}
+			return Eigen::Vector3i((int)std::floor(x / layer_configuration.voxel_size.x()), (int)std::floor(y / layer_configuration.voxel_size.y()), (int)std::floor(z / layer_configuration.voxel_size.z()));
+		}
+
+		/*! Adds (number_of_points > 0) or removes (number_of_points < 0) copies of a point from the voxel statistics. */
+		static void s_updateVoxelStatistics(Layer& layer, const PointPositionKey& point_position, int number_of_points, std::unordered_set<VoxelKey>* updated_voxels);
+		static void s_computeNormalDistribution(LayerType layer_type, Voxel& voxel);
+		void computeLayer(Layer& layer, const pcl::PointCloud<PointT>& pointcloud);
+		void computeNormalDistributions(Layer& layer, const std::unordered_set<VoxelKey>* updated_voxels);
+		void buildVoxelGrid(Layer& layer);
+		/*! Applies the changes (number of copies added / removed of each point position) to the voxels of all the layers. */
+		void updateLayers(const std::vector< std::pair<PointPositionKey, int> >& changed_points);
+		void setReferencePointCloud(const typename pcl::PointCloud<PointT>::Ptr& reference_pointcloud);
+
+		std::uint64_t computePointsHash(const pcl::PointCloud<PointT>& pointcloud) const;
+		bool loadVoxelMap(const std::string& filename, std::uint64_t points_hash, size_t number_of_points);
+		bool saveVoxelMap(const std::string& filename, std::uint64_t points_hash, size_t number_of_points) const;
+
+		std::vector<Layer> layers_;
+		double full_recomputation_ratio_;
+		std::string voxel_map_filename_;
+		int number_of_threads_;
+
+		std::unordered_map< PointPositionKey, std::uint32_t, PointPositionKeyHash > reference_points_counts_;
+		typename pcl::PointCloud<PointT>::Ptr reference_pointcloud_;
+		size_t reference_pointcloud_size_;
+		std::uint64_t reference_pointcloud_stamp_;
+		size_t number_of_updated_voxels_in_last_update_;
+		std::uint64_t number_of_built_voxel_grids_;
+	// ========================================================================   </protected-section>  ========================================================================
+};
+
+} /* namespace dynamic_robot_localization */
+
+
+#ifdef DRL_NO_PRECOMPILE
+#include <dynamic_robot_localization/cloud_matchers/impl/normal_distributions_transform_voxel_map.hpp>
+#endif
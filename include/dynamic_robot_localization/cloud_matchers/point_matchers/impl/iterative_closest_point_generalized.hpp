@@ -36,10 +36,47 @@ void IterativeClosestPointGeneralized<PointT>::setupConfigurationFromParameterSe
 	private_node_handle->param(configuration_namespace + "maximum_optimizer_iterations", maximum_optimizer_iterations, 20);
 	matcher->setMaximumOptimizerIterations(maximum_optimizer_iterations);
 
+	bool covariances_cache_enabled;
+	private_node_handle->param(configuration_namespace + "covariances_cache/enabled", covariances_cache_enabled, true);
+	if (covariances_cache_enabled) {
+		covariances_cache_.reset(new GeneralizedCovariancesCache<PointT>(correspondence_randomness, matcher->getGICPEpsilon()));
+
+		double invalidation_voxel_size;
+		private_node_handle->param(configuration_namespace + "covariances_cache/invalidation_voxel_size", invalidation_voxel_size, 0.25);
+		covariances_cache_->setInvalidationVoxelSize(invalidation_voxel_size);
+
+		double full_recomputation_ratio;
+		private_node_handle->param(configuration_namespace + "covariances_cache/full_recomputation_ratio", full_recomputation_ratio, 0.5);
+		covariances_cache_->setFullRecomputationRatio(full_recomputation_ratio);
+
+		std::string covariances_filename;
+		private_node_handle->param(configuration_namespace + "covariances_cache/filename", covariances_filename, std::string(""));
+		covariances_cache_->setCovariancesFilename(covariances_filename);
+
+		int number_of_threads;
+		private_node_handle->param(configuration_namespace + "covariances_cache/number_of_threads", number_of_threads, 0);
+		covariances_cache_->setNumberOfThreads(number_of_threads);
+	} else {
+		covariances_cache_.reset();
+	}
+	matcher->setGeneralizedCovariancesCache(covariances_cache_);
+
 	CloudMatcher<PointT>::setCloudMatcher(matcher_base);
 	IterativeClosestPoint<PointT>::setupConfigurationFromParameterServer(node_handle, private_node_handle, configuration_namespace);
 }
 
+template<typename PointT>
+void IterativeClosestPointGeneralized<PointT>::setupReferenceCloud(typename pcl::PointCloud<PointT>::Ptr& reference_cloud, typename pcl::PointCloud<PointT>::Ptr& reference_cloud_keypoints,
+		typename pcl::search::KdTree<PointT>::Ptr& search_method) {
+	IterativeClosestPoint<PointT>::setupReferenceCloud(reference_cloud, reference_cloud_keypoints, search_method); // resets the target covariances of the matcher
+
+	typename IterativeClosestPointGeneralizedTimeConstrained<PointT, PointT>::Ptr matcher = std::dynamic_pointer_cast< IterativeClosestPointGeneralizedTimeConstrained<PointT, PointT> >(CloudMatcher<PointT>::cloud_matcher_);
+	if (matcher && covariances_cache_ && reference_cloud) {
+		matcher->setTargetCovariances(covariances_cache_->updateReferenceCovariances(reference_cloud, search_method));
+	}
+}
+
+
 template<typename PointT>
 double IterativeClosestPointGeneralized<PointT>::getTransformCloudElapsedTimeMS() {
 	typename IterativeClosestPointGeneralizedTimeConstrained<PointT, PointT>::Ptr matcher = std::dynamic_pointer_cast< IterativeClosestPointGeneralizedTimeConstrained<PointT, PointT> >(CloudMatcher<PointT>::cloud_matcher_);
@@ -53,6 +90,22 @@ void IterativeClosestPointGeneralized<PointT>::resetTransformCloudElapsedTime()
 	typename IterativeClosestPointGeneralizedTimeConstrained<PointT, PointT>::Ptr matcher = std::dynamic_pointer_cast< IterativeClosestPointGeneralizedTimeConstrained<PointT, PointT> >(CloudMatcher<PointT>::cloud_matcher_);
 	if (matcher) { matcher->resetTransformCloudElapsedTime(); }
 }
+
+
+template<typename PointT>
+size_t IterativeClosestPointGeneralized<PointT>::accountMemoryUsage(MemoryUsage& memory_usage) {
+	size_t bytes = CloudMatcher<PointT>::accountMemoryUsage(memory_usage);
+	if (covariances_cache_) { bytes += covariances_cache_->accountMemoryUsage(memory_usage); }
+	return bytes;
+}
+
+
+template<typename PointT>
+void IterativeClosestPointGeneralized<PointT>::setGeneralizedCovariancesCache(const typename GeneralizedCovariancesCache<PointT>::Ptr& covariances_cache) {
+	covariances_cache_ = covariances_cache;
+	typename IterativeClosestPointGeneralizedTimeConstrained<PointT, PointT>::Ptr matcher = std::dynamic_pointer_cast< IterativeClosestPointGeneralizedTimeConstrained<PointT, PointT> >(CloudMatcher<PointT>::cloud_matcher_);
+	if (matcher) { matcher->setGeneralizedCovariancesCache(covariances_cache); }
+}
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </IterativeClosestPointWithNormals-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 // =============================================================================  </public-section>  ===========================================================================
 
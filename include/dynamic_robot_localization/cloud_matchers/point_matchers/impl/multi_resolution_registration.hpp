@@ -0,0 +1,212 @@
+/**\file multi_resolution_registration.hpp
+ * \brief Description...
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+#include <dynamic_robot_localization/cloud_matchers/point_matchers/multi_resolution_registration.h>
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+namespace dynamic_robot_localization {
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <imports>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </imports>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+// =============================================================================  <public-section>  ============================================================================
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <constructors-destructor>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+template<typename PointT>
+MultiResolutionRegistration<PointT>::MultiResolutionRegistration() :
+		empty_pointcloud_keypoints_(new pcl::PointCloud<PointT>()) {
+	resetRegistrationStatistics();
+}
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </constructors-destructor>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <MultiResolutionRegistration-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+template<typename PointT>
+void MultiResolutionRegistration<PointT>::addLevelMatcher(const typename CloudMatcher<PointT>::Ptr& cloud_matcher, double voxel_grid_leaf_size) {
+	if (!cloud_matcher) { return; }
+	if (voxel_grid_leaf_size < 0.0) { voxel_grid_leaf_size = 0.0; }
+	cloud_matcher->clearPublishers();
+
+	// levels sorted from the coarsest to the finest
+	typename std::vector<Level>::iterator level_it = levels_.begin();
+	while (level_it != levels_.end() && level_it->voxel_grid_leaf_size > voxel_grid_leaf_size) { ++level_it; }
+
+	if (level_it == levels_.end() || level_it->voxel_grid_leaf_size != voxel_grid_leaf_size) {
+		Level level;
+		level.voxel_grid_leaf_size = voxel_grid_leaf_size;
+		level_it = levels_.insert(level_it, level);
+	}
+
+	level_it->matchers.push_back(cloud_matcher);
+}
+
+
+template<typename PointT>
+void MultiResolutionRegistration<PointT>::setupReferenceCloud(typename pcl::PointCloud<PointT>::Ptr& reference_cloud, typename pcl::PointCloud<PointT>::Ptr& reference_cloud_keypoints,
+		typename pcl::search::KdTree<PointT>::Ptr& search_method) {
+	CloudMatcher<PointT>::setupReferenceCloud(reference_cloud, reference_cloud_keypoints, search_method);
+
+	for (size_t i = 0; i < levels_.size(); ++i) {
+		Level& level = levels_[i];
+		if (level.voxel_grid_leaf_size > 0.0 && reference_cloud && !reference_cloud->empty()) {
+			level.reference_pointcloud.reset(new pcl::PointCloud<PointT>());
+			pcl::VoxelGrid<PointT> voxel_grid;
+			voxel_grid.setLeafSize(level.voxel_grid_leaf_size, level.voxel_grid_leaf_size, level.voxel_grid_leaf_size);
+			voxel_grid.setInputCloud(reference_cloud);
+			voxel_grid.filter(*level.reference_pointcloud);
+			level.reference_pointcloud_search_method.reset(new pcl::search::KdTree<PointT>());
+			level.reference_pointcloud_search_method->setInputCloud(level.reference_pointcloud);
+			ROS_DEBUG_STREAM("MultiResolutionRegistration level with voxel grid leaf size " << level.voxel_grid_leaf_size << " has a reference point cloud with " << level.reference_pointcloud->size() << " points");
+		} else {
+			level.reference_pointcloud = reference_cloud;
+			level.reference_pointcloud_search_method = search_method;
+		}
+
+		for (size_t j = 0; j < level.matchers.size(); ++j) {
+			level.matchers[j]->setupReferenceCloud(level.reference_pointcloud, reference_cloud_keypoints, level.reference_pointcloud_search_method);
+		}
+	}
+}
+
+
+template<typename PointT>
+bool MultiResolutionRegistration<PointT>::registerCloud(typename pcl::PointCloud<PointT>::Ptr& ambient_pointcloud,
+		typename pcl::search::KdTree<PointT>::Ptr& ambient_pointcloud_search_method,
+		typename pcl::PointCloud<PointT>::Ptr& pointcloud_keypoints,
+		tf2::Transform& best_pose_correction_out, std::vector< tf2::Transform >& accepted_pose_corrections_out, typename pcl::PointCloud<PointT>::Ptr& pointcloud_registered_out, bool return_aligned_keypoints) {
+	resetRegistrationStatistics();
+	this->cloud_align_time_ms_ = 0;
+
+	if (levels_.empty()) {
+		return false;
+	}
+
+	if (ambient_pointcloud->size() < 3) {
+		ROS_WARN("Discarded ambient cloud with less than 3 points before performing registration.");
+		return false;
+	}
+
+	PerformanceTimer performance_timer;
+	performance_timer.start();
+
+	Eigen::Matrix4f registration_transformation = Eigen::Matrix4f::Identity();
+	bool registration_successful = false;
+	bool ambient_pointcloud_registered = false;
+	for (size_t i = 0; i < levels_.size(); ++i) {
+		Level& level = levels_[i];
+		typename pcl::PointCloud<PointT>::Ptr level_ambient_pointcloud = ambient_pointcloud;
+		typename pcl::search::KdTree<PointT>::Ptr level_ambient_pointcloud_search_method = ambient_pointcloud_search_method;
+		typename pcl::PointCloud<PointT>::Ptr level_registered_pointcloud = pointcloud_registered_out;
+
+		if (level.voxel_grid_leaf_size > 0.0) {
+			if (!level.ambient_pointcloud) { level.ambient_pointcloud.reset(new pcl::PointCloud<PointT>()); }
+			if (!level.registered_pointcloud) { level.registered_pointcloud.reset(new pcl::PointCloud<PointT>()); }
+			pcl::VoxelGrid<PointT> voxel_grid;
+			voxel_grid.setLeafSize(level.voxel_grid_leaf_size, level.voxel_grid_leaf_size, level.voxel_grid_leaf_size);
+			voxel_grid.setInputCloud(ambient_pointcloud);
+			voxel_grid.filter(*level.ambient_pointcloud);
+			level_ambient_pointcloud = level.ambient_pointcloud;
+			level_ambient_pointcloud_search_method.reset(); // pcl only builds a search method for the voxelized cloud if the matcher uses reciprocal correspondences
+			level_registered_pointcloud = level.registered_pointcloud;
+		}
+
+		// the keypoints are transformed only once (at the end), because the level matchers return the full transformation (including the initial guess)
+		for (size_t j = 0; j < level.matchers.size(); ++j) {
+			level.matchers[j]->setRegistrationInitialGuess(registration_transformation);
+			tf2::Transform level_pose_correction;
+			registration_successful = level.matchers[j]->registerCloud(level_ambient_pointcloud, level_ambient_pointcloud_search_method, empty_pointcloud_keypoints_,
+					level_pose_correction, accepted_pose_corrections_out, level_registered_pointcloud, false);
+
+			if (registration_successful) {
+				registration_transformation = level.matchers[j]->getCloudMatcher()->getFinalTransformation();
+				ambient_pointcloud_registered = (level_ambient_pointcloud == ambient_pointcloud);
+			} else {
+				ROS_DEBUG_STREAM("MultiResolutionRegistration level with voxel grid leaf size " << level.voxel_grid_leaf_size << " failed with " << level.matchers[j]->getCloudMatcherName());
+			}
+
+			updateRegistrationStatistics(level.matchers[j]);
+		}
+	}
+
+	if (!registration_successful || !this->postProcessRegistrationMatrix(ambient_pointcloud, registration_transformation, best_pose_correction_out)) {
+		this->cloud_align_time_ms_ = performance_timer.getElapsedTimeInMilliSec();
+		return false;
+	}
+
+	if (return_aligned_keypoints && pointcloud_keypoints) {
+		pcl::transformPointCloudWithNormals(*pointcloud_keypoints, *pointcloud_registered_out, registration_transformation);
+	} else if (!ambient_pointcloud_registered) {
+		pcl::transformPointCloudWithNormals(*ambient_pointcloud, *pointcloud_registered_out, registration_transformation);
+	}
+
+	if (pointcloud_keypoints && !pointcloud_keypoints->empty()) {
+		pcl::transformPointCloudWithNormals(*pointcloud_keypoints, *pointcloud_keypoints, registration_transformation);
+	}
+	this->cloud_align_time_ms_ = performance_timer.getElapsedTimeInMilliSec();
+
+	if (pointcloud_registered_out->size() < 5) {
+		return false;
+	}
+
+	pointcloud_registered_out->header = ambient_pointcloud->header;
+	if (pointcloud_keypoints) { pointcloud_keypoints->header = ambient_pointcloud->header; }
+
+	if (this->cloud_publisher_ && pointcloud_registered_out) {
+		this->cloud_publisher_->publishPointCloud(*pointcloud_registered_out);
+	}
+
+	this->publishReferenceCloud(ambient_pointcloud->header.stamp);
+
+	return true;
+}
+
+
+template<typename PointT>
+bool MultiResolutionRegistration<PointT>::registrationRequiresNormalsOnAmbientPointCloud() {
+	for (size_t i = 0; i < levels_.size(); ++i) {
+		for (size_t j = 0; j < levels_[i].matchers.size(); ++j) {
+			if (levels_[i].matchers[j]->registrationRequiresNormalsOnAmbientPointCloud()) { return true; }
+		}
+	}
+	return false;
+}
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </MultiResolutionRegistration-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// =============================================================================  </public-section>  ===========================================================================
+
+// =============================================================================   <protected-section>   =======================================================================
+template<typename PointT>
+void MultiResolutionRegistration<PointT>::resetRegistrationStatistics() {
+	number_of_registration_iterations_ = -1;
+	correspondence_estimation_elapsed_time_ms_ = -1.0;
+	transformation_estimation_elapsed_time_ms_ = -1.0;
+	transform_cloud_elapsed_time_ms_ = -1.0;
+	last_matcher_convergence_state_.clear();
+	root_mean_square_error_of_last_registration_correspondences_ = -1.0;
+	number_correspondences_last_registration_algorithm_ = -1;
+}
+
+
+template<typename PointT>
+void MultiResolutionRegistration<PointT>::updateRegistrationStatistics(const typename CloudMatcher<PointT>::Ptr& cloud_matcher) {
+	int number_of_registration_iterations = cloud_matcher->getNumberOfRegistrationIterations();
+	if (number_of_registration_iterations > 0) { number_of_registration_iterations_ = std::max(number_of_registration_iterations_, 0) + number_of_registration_iterations; }
+
+	double correspondence_estimation_elapsed_time_ms = cloud_matcher->getCorrespondenceEstimationElapsedTimeMS();
+	if (correspondence_estimation_elapsed_time_ms > 0.0) { correspondence_estimation_elapsed_time_ms_ = std::max(correspondence_estimation_elapsed_time_ms_, 0.0) + correspondence_estimation_elapsed_time_ms; }
+
+	double transformation_estimation_elapsed_time_ms = cloud_matcher->getTransformationEstimationElapsedTimeMS();
+	if (transformation_estimation_elapsed_time_ms > 0.0) { transformation_estimation_elapsed_time_ms_ = std::max(transformation_estimation_elapsed_time_ms_, 0.0) + transformation_estimation_elapsed_time_ms; }
+
+	double transform_cloud_elapsed_time_ms = cloud_matcher->getTransformCloudElapsedTimeMS();
+	if (transform_cloud_elapsed_time_ms > 0.0) { transform_cloud_elapsed_time_ms_ = std::max(transform_cloud_elapsed_time_ms_, 0.0) + transform_cloud_elapsed_time_ms; }
+
+	last_matcher_convergence_state_ = cloud_matcher->getMatcherConvergenceState();
+	root_mean_square_error_of_last_registration_correspondences_ = cloud_matcher->getRootMeanSquareErrorOfRegistrationCorrespondences();
+	number_correspondences_last_registration_algorithm_ = cloud_matcher->getNumberCorrespondencesInLastRegistrationIteration();
+}
+// =============================================================================   </protected-section>  =======================================================================
+
+} /* namespace dynamic_robot_localization */
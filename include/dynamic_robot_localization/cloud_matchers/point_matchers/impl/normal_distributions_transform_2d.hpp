@@ -49,11 +49,41 @@ void NormalDistributionsTransform2D<PointT>::setupConfigurationFromParameterServ
 	private_node_handle->param(configuration_namespace + "grid_optimization_step_size_theta", grid_optimization_step_size_theta, 1.0);
 	matcher->setOptimizationStepSize(Eigen::Vector3d(grid_optimization_step_size_x, grid_optimization_step_size_y, grid_optimization_step_size_theta));
 
+	bool voxel_map_enabled;
+	private_node_handle->param(configuration_namespace + "voxel_map/enabled", voxel_map_enabled, true);
+	typename NormalDistributionsTransformVoxelMap<PointT>::Ptr voxel_map;
+	if (voxel_map_enabled) {
+		voxel_map.reset(new NormalDistributionsTransformVoxelMap<PointT>());
+
+		double full_recomputation_ratio;
+		private_node_handle->param(configuration_namespace + "voxel_map/full_recomputation_ratio", full_recomputation_ratio, 0.5);
+		voxel_map->setFullRecomputationRatio(full_recomputation_ratio);
+
+		std::string voxel_map_filename;
+		private_node_handle->param(configuration_namespace + "voxel_map/filename", voxel_map_filename, std::string(""));
+		voxel_map->setVoxelMapFilename(voxel_map_filename);
+
+		int number_of_threads;
+		private_node_handle->param(configuration_namespace + "voxel_map/number_of_threads", number_of_threads, 0);
+		voxel_map->setNumberOfThreads(number_of_threads);
+	}
+
 	CloudMatcher<PointT>::setCloudMatcher(matcher_base);
+	setNormalDistributionsTransformVoxelMap(voxel_map);
 	CloudMatcher<PointT>::setupConfigurationFromParameterServer(node_handle, private_node_handle, configuration_namespace);
 }
 
 
+template<typename PointT>
+void NormalDistributionsTransform2D<PointT>::setupReferenceCloud(typename pcl::PointCloud<PointT>::Ptr& reference_cloud, typename pcl::PointCloud<PointT>::Ptr& reference_cloud_keypoints,
+		typename pcl::search::KdTree<PointT>::Ptr& search_method) {
+	if (voxel_map_ && reference_cloud) {
+		voxel_map_->update(reference_cloud);
+	}
+	CloudMatcher<PointT>::setupReferenceCloud(reference_cloud, reference_cloud_keypoints, search_method);
+}
+
+
 template<typename PointT>
 int NormalDistributionsTransform2D<PointT>::getNumberOfRegistrationIterations() {
 	if (CloudMatcher<PointT>::cloud_matcher_) {
@@ -62,6 +92,22 @@ int NormalDistributionsTransform2D<PointT>::getNumberOfRegistrationIterations()
 	}
 	return -1;
 }
+
+
+template<typename PointT>
+size_t NormalDistributionsTransform2D<PointT>::accountMemoryUsage(MemoryUsage& memory_usage) {
+	size_t bytes = CloudMatcher<PointT>::accountMemoryUsage(memory_usage);
+	if (voxel_map_) { bytes += voxel_map_->accountMemoryUsage(memory_usage); }
+	return bytes;
+}
+
+
+template<typename PointT>
+void NormalDistributionsTransform2D<PointT>::setNormalDistributionsTransformVoxelMap(const typename NormalDistributionsTransformVoxelMap<PointT>::Ptr& voxel_map) {
+	voxel_map_ = voxel_map;
+	typename NormalDistributionsTransform2DDetailed<PointT, PointT>::Ptr matcher = std::dynamic_pointer_cast< NormalDistributionsTransform2DDetailed<PointT, PointT> >(CloudMatcher<PointT>::cloud_matcher_);
+	if (matcher) { matcher->setNormalDistributionsTransformVoxelMap(voxel_map); }
+}
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </NormalDistributionsTransform2D-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 // =============================================================================  </public-section>  ===========================================================================
 
@@ -40,10 +40,40 @@ void NormalDistributionsTransform3D<PointT>::setupConfigurationFromParameterServ
 	private_node_handle->param(configuration_namespace + "outlier_ratio", outlier_ratio, 0.55);
 	matcher->setOulierRatio(outlier_ratio);
 
+	bool voxel_map_enabled;
+	private_node_handle->param(configuration_namespace + "voxel_map/enabled", voxel_map_enabled, true);
+	typename NormalDistributionsTransformVoxelMap<PointT>::Ptr voxel_map;
+	if (voxel_map_enabled) {
+		voxel_map.reset(new NormalDistributionsTransformVoxelMap<PointT>());
+
+		double full_recomputation_ratio;
+		private_node_handle->param(configuration_namespace + "voxel_map/full_recomputation_ratio", full_recomputation_ratio, 0.5);
+		voxel_map->setFullRecomputationRatio(full_recomputation_ratio);
+
+		std::string voxel_map_filename;
+		private_node_handle->param(configuration_namespace + "voxel_map/filename", voxel_map_filename, std::string(""));
+		voxel_map->setVoxelMapFilename(voxel_map_filename);
+
+		int number_of_threads;
+		private_node_handle->param(configuration_namespace + "voxel_map/number_of_threads", number_of_threads, 0);
+		voxel_map->setNumberOfThreads(number_of_threads);
+	}
+
 	CloudMatcher<PointT>::setCloudMatcher(matcher_base);
+	setNormalDistributionsTransformVoxelMap(voxel_map);
 	CloudMatcher<PointT>::setupConfigurationFromParameterServer(node_handle, private_node_handle, configuration_namespace);
 }
 
+
+template<typename PointT>
+void NormalDistributionsTransform3D<PointT>::setupReferenceCloud(typename pcl::PointCloud<PointT>::Ptr& reference_cloud, typename pcl::PointCloud<PointT>::Ptr& reference_cloud_keypoints,
+		typename pcl::search::KdTree<PointT>::Ptr& search_method) {
+	if (voxel_map_ && reference_cloud) {
+		voxel_map_->update(reference_cloud);
+	}
+	CloudMatcher<PointT>::setupReferenceCloud(reference_cloud, reference_cloud_keypoints, search_method);
+}
+
 template<typename PointT>
 int NormalDistributionsTransform3D<PointT>::getNumberOfRegistrationIterations() {
 	if (CloudMatcher<PointT>::cloud_matcher_) {
@@ -52,6 +82,22 @@ int NormalDistributionsTransform3D<PointT>::getNumberOfRegistrationIterations()
 	}
 	return -1;
 }
+
+
+template<typename PointT>
+size_t NormalDistributionsTransform3D<PointT>::accountMemoryUsage(MemoryUsage& memory_usage) {
+	size_t bytes = CloudMatcher<PointT>::accountMemoryUsage(memory_usage);
+	if (voxel_map_) { bytes += voxel_map_->accountMemoryUsage(memory_usage); }
+	return bytes;
+}
+
+
+template<typename PointT>
+void NormalDistributionsTransform3D<PointT>::setNormalDistributionsTransformVoxelMap(const typename NormalDistributionsTransformVoxelMap<PointT>::Ptr& voxel_map) {
+	voxel_map_ = voxel_map;
+	typename NormalDistributionsTransformDetailed<PointT, PointT>::Ptr matcher = std::dynamic_pointer_cast< NormalDistributionsTransformDetailed<PointT, PointT> >(CloudMatcher<PointT>::cloud_matcher_);
+	if (matcher) { matcher->setNormalDistributionsTransformVoxelMap(voxel_map); }
+}
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </NormalDistributionsTransform3D-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 // =============================================================================  </public-section>  ===========================================================================
 
@@ -116,10 +116,7 @@ bool PrincipalComponentAnalysis<PointT>::registerCloud(typename pcl::PointCloud<
 			CloudMatcher<PointT>::cloud_publisher_->publishPointCloud(*pointcloud_registered_out);
 		}
 
-		if (CloudMatcher<PointT>::reference_cloud_publisher_ && CloudMatcher<PointT>::reference_cloud_) {
-			CloudMatcher<PointT>::reference_cloud_publisher_->setCloudPublishStamp(ambient_pointcloud->header.stamp);
-			CloudMatcher<PointT>::reference_cloud_publisher_->publishPointCloud(*CloudMatcher<PointT>::reference_cloud_);
-		}
+		CloudMatcher<PointT>::publishReferenceCloud(ambient_pointcloud->header.stamp);
 
 		return true;
 	}
@@ -17,6 +17,7 @@
 #include <pcl/registration/gicp.h>
 
 // project includes
+#include <dynamic_robot_localization/cloud_matchers/generalized_covariances_cache.h>
 #include <dynamic_robot_localization/cloud_matchers/point_matchers/iterative_closest_point.h>
 #include <dynamic_robot_localization/convergence_estimators/default_convergence_criteria_with_time.h>
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
@@ -42,8 +43,25 @@ class IterativeClosestPointGeneralizedTimeConstrained: public pcl::GeneralizedIt
 
 		inline double getTransformCloudElapsedTime() { return transform_cloud_elapsed_time_ms_; }
 		inline void resetTransformCloudElapsedTime() { transform_cloud_elapsed_time_ms_ = 0; }
+		inline double getGICPEpsilon() const { return pcl::GeneralizedIterativeClosestPoint<PointSource, PointTarget>::gicp_epsilon_; }
+		inline typename GeneralizedCovariancesCache<PointSource>::Ptr getGeneralizedCovariancesCache() { return covariances_cache_; }
+		/*! The source covariances are retrieved from the cache and the covariances of the aligned source are added to it (for reuse in chained matchers). */
+		inline void setGeneralizedCovariancesCache(const typename GeneralizedCovariancesCache<PointSource>::Ptr& covariances_cache) { covariances_cache_ = covariances_cache; }
 
 	protected:
+		virtual void computeTransformation(typename pcl::Registration<PointSource, PointTarget>::PointCloudSource &output, const typename pcl::Registration<PointSource, PointTarget>::Matrix4 &guess) {
+			using GICP = pcl::GeneralizedIterativeClosestPoint<PointSource, PointTarget>;
+			if (covariances_cache_ && (!GICP::input_covariances_ || GICP::input_covariances_->empty())) {
+				GICP::setSourceCovariances(covariances_cache_->getAmbientCovariances(GICP::input_, GICP::tree_reciprocal_));
+			}
+
+			GICP::computeTransformation(output, guess);
+
+			if (covariances_cache_) {
+				covariances_cache_->addAlignedAmbientCovariances(*GICP::input_, output, GICP::final_transformation_);
+			}
+		}
+
 		virtual void transformCloud(const typename pcl::Registration<PointSource, PointTarget>::PointCloudSource &input, typename pcl::Registration<PointSource, PointTarget>::PointCloudSource &output, const typename pcl::Registration<PointSource, PointTarget>::Matrix4 &transform) {
 			PerformanceTimer timer_;
 			timer_.start();
@@ -52,6 +70,7 @@ class IterativeClosestPointGeneralizedTimeConstrained: public pcl::GeneralizedIt
 		}
 
 		double transform_cloud_elapsed_time_ms_;
+		typename GeneralizedCovariancesCache<PointSource>::Ptr covariances_cache_;
 };
 
 
@@ -75,19 +94,28 @@ class IterativeClosestPointGeneralized : public IterativeClosestPoint<PointT> {
 
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <IterativeClosestPointGeneralized-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 		virtual void setupConfigurationFromParameterServer(ros::NodeHandlePtr& node_handle, ros::NodeHandlePtr& private_node_handle, const std::string& configuration_namespace);
+		/*! Besides the base setup, retrieves the reference covariances from the cache (only recomputed for the regions of the reference point cloud that changed). */
+		virtual void setupReferenceCloud(typename pcl::PointCloud<PointT>::Ptr& reference_cloud, typename pcl::PointCloud<PointT>::Ptr& reference_cloud_keypoints,
+				typename pcl::search::KdTree<PointT>::Ptr& search_method);
 		virtual double getTransformCloudElapsedTimeMS();
 		virtual void resetTransformCloudElapsedTime();
+		/*! Besides the base accounting, includes the covariances cache (counted only once if shared with other matchers). */
+		virtual size_t accountMemoryUsage(MemoryUsage& memory_usage);
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </IterativeClosestPointGeneralized-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <gets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		inline typename GeneralizedCovariancesCache<PointT>::Ptr getGeneralizedCovariancesCache() { return covariances_cache_; }
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </gets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <sets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		/*! Allows several matchers to share the same cache (the reference covariances are only computed once per reference point cloud). */
+		void setGeneralizedCovariancesCache(const typename GeneralizedCovariancesCache<PointT>::Ptr& covariances_cache);
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </sets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 	// ========================================================================   </public-section>  ===========================================================================
 
 	// ========================================================================   <protected-section>   ========================================================================
 	protected:
+		typename GeneralizedCovariancesCache<PointT>::Ptr covariances_cache_;
 	// ========================================================================   </protected-section>  ========================================================================
 };
 
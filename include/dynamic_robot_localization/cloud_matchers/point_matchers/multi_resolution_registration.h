@@ -0,0 +1,116 @@
+#pragma once
+
+/**\file multi_resolution_registration.h
+ * \brief Coarse to fine registration over a pyramid of voxelized reference point clouds
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>  <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// std includes
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+// PCL includes
+#include <pcl/common/transforms.h>
+#include <pcl/filters/voxel_grid.h>
+#include <pcl/point_cloud.h>
+#include <pcl/search/kdtree.h>
+
+// external libs includes
+#include <Eigen/Core>
+
+// project includes
+#include <dynamic_robot_localization/cloud_matchers/cloud_matcher.h>
+#include <dynamic_robot_localization/common/performance_timer.h>
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+namespace dynamic_robot_localization {
+// ####################################################################   MultiResolutionRegistration   #####################################################################
+/**
+ * \brief Registers the ambient point cloud coarse to fine, using a pyramid of levels sorted by decreasing voxel grid leaf size.
+ * Each level has its own point matchers (with their own iteration and time limits) and a voxelized copy of the reference point cloud
+ * with its k-d tree, that are built only when the reference point cloud changes (a level with leaf size <= 0 uses the reference point cloud and search method given in setupReferenceCloud).
+ * The pose estimated in a level is given as initial guess to the next one (the voxelized ambient point clouds are never transformed, and no search method is rebuilt during registration).
+ * The registration is successful if the matchers of the finest level succeed.
+ */
+template <typename PointT>
+class MultiResolutionRegistration : public CloudMatcher<PointT> {
+	// ========================================================================   <public-section>   ===========================================================================
+	public:
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <usings>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		using Ptr = std::shared_ptr< MultiResolutionRegistration<PointT> >;
+		using ConstPtr = std::shared_ptr< const MultiResolutionRegistration<PointT> >;
+
+		struct Level {
+			double voxel_grid_leaf_size;
+			std::vector< typename CloudMatcher<PointT>::Ptr > matchers;
+			typename pcl::PointCloud<PointT>::Ptr reference_pointcloud;
+			typename pcl::search::KdTree<PointT>::Ptr reference_pointcloud_search_method;
+			typename pcl::PointCloud<PointT>::Ptr ambient_pointcloud;
+			typename pcl::PointCloud<PointT>::Ptr registered_pointcloud;
+		};
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </usings>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <constructors-destructor>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		MultiResolutionRegistration();
+		virtual ~MultiResolutionRegistration() {}
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </constructors-destructor>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <MultiResolutionRegistration-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		/*! Adds the matcher to the level with the given leaf size (creating it if necessary). The publishers of the matcher are removed (only the final registration is published). */
+		void addLevelMatcher(const typename CloudMatcher<PointT>::Ptr& cloud_matcher, double voxel_grid_leaf_size);
+		void clearLevels() { levels_.clear(); }
+
+		virtual void setupReferenceCloud(typename pcl::PointCloud<PointT>::Ptr& reference_cloud, typename pcl::PointCloud<PointT>::Ptr& reference_cloud_keypoints,
+				typename pcl::search::KdTree<PointT>::Ptr& search_method);
+		virtual bool registerCloud(typename pcl::PointCloud<PointT>::Ptr& ambient_pointcloud,
+				typename pcl::search::KdTree<PointT>::Ptr& ambient_pointcloud_search_method,
+				typename pcl::PointCloud<PointT>::Ptr& pointcloud_keypoints,
+				tf2::Transform& best_pose_correction_out, std::vector< tf2::Transform >& accepted_pose_corrections_out, typename pcl::PointCloud<PointT>::Ptr& pointcloud_registered_out, bool return_aligned_keypoints = false);
+
+		virtual bool registrationRequiresNormalsOnAmbientPointCloud();
+		virtual double getCorrespondenceEstimationElapsedTimeMS() { return correspondence_estimation_elapsed_time_ms_; }
+		virtual void resetCorrespondenceEstimationElapsedTime() { correspondence_estimation_elapsed_time_ms_ = -1.0; }
+		virtual double getTransformationEstimationElapsedTimeMS() { return transformation_estimation_elapsed_time_ms_; }
+		virtual void resetTransformationEstimationElapsedTime() { transformation_estimation_elapsed_time_ms_ = -1.0; }
+		virtual double getTransformCloudElapsedTimeMS() { return transform_cloud_elapsed_time_ms_; }
+		virtual void resetTransformCloudElapsedTime() { transform_cloud_elapsed_time_ms_ = -1.0; }
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </MultiResolutionRegistration-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <gets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		virtual std::string getCloudMatcherName() { return "MultiResolutionRegistration"; }
+		virtual int getNumberOfRegistrationIterations() { return number_of_registration_iterations_; }
+		virtual std::string getMatcherConvergenceState() { return last_matcher_convergence_state_; }
+		virtual double getRootMeanSquareErrorOfRegistrationCorrespondences() { return root_mean_square_error_of_last_registration_correspondences_; }
+		virtual int getNumberCorrespondencesInLastRegistrationIteration() { return number_correspondences_last_registration_algorithm_; }
+		inline const std::vector<Level>& getLevels() const { return levels_; }
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </gets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+	// ========================================================================   </public-section>  ===========================================================================
+
+	// ========================================================================   <protected-section>   ========================================================================
+	protected:
+		void resetRegistrationStatistics();
+		void updateRegistrationStatistics(const typename CloudMatcher<PointT>::Ptr& cloud_matcher);
+
+		std::vector<Level> levels_;
+		typename pcl::PointCloud<PointT>::Ptr empty_pointcloud_keypoints_;
+		int number_of_registration_iterations_;
+		double correspondence_estimation_elapsed_time_ms_;
+		double transformation_estimation_elapsed_time_ms_;
+		double transform_cloud_elapsed_time_ms_;
+		std::string last_matcher_convergence_state_;
+		double root_mean_square_error_of_last_registration_correspondences_;
+		int number_correspondences_last_registration_algorithm_;
+	// ========================================================================   </protected-section>  ========================================================================
+};
+
+} /* namespace dynamic_robot_localization */
+
+
+#ifdef DRL_NO_PRECOMPILE
+#include <dynamic_robot_localization/cloud_matchers/point_matchers/impl/multi_resolution_registration.hpp>
+#endif
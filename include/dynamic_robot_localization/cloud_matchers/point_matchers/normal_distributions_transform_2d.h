@@ -9,18 +9,24 @@
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>  <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 // std includes
+#include <cmath>
 #include <memory>
 #include <string>
+#include <vector>
 
 // PCL includes
+#include <pcl/common/transforms.h>
 #include <pcl/registration/ndt_2d.h>
 #include <pcl/registration/registration.h>
 
 // external libs includes
 #include <Eigen/Core>
+#include <Eigen/Eigenvalues>
+#include <Eigen/Geometry>
 
 // project includes
 #include <dynamic_robot_localization/cloud_matchers/cloud_matcher.h>
+#include <dynamic_robot_localization/cloud_matchers/normal_distributions_transform_voxel_map.h>
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 namespace dynamic_robot_localization {
@@ -34,11 +40,141 @@ class NormalDistributionsTransform2DDetailed: public pcl::NormalDistributionsTra
 		using ConstPtr = std::shared_ptr< const NormalDistributionsTransform2DDetailed<PointSource, PointTarget> >;
 
 		inline int getNumberOfRegistrationIterations() { return pcl::Registration<PointSource, PointTarget>::nr_iterations_; }
+		inline typename NormalDistributionsTransformVoxelMap<PointTarget>::Ptr getNormalDistributionsTransformVoxelMap() { return voxel_map_; }
+
+		/*! Adds to the voxel map the 4 overlapping grids of pcl::NormalDistributionsTransform2D (must be called after setting the grid centre, extent and step).
+		 * The registrations use the voxel map when it has the target point cloud, instead of building the grids of the target point cloud in every registration. */
+		void setNormalDistributionsTransformVoxelMap(const typename NormalDistributionsTransformVoxelMap<PointTarget>::Ptr& voxel_map) {
+			using NDT2D = pcl::NormalDistributionsTransform2D<PointSource, PointTarget>;
+			voxel_map_ = voxel_map;
+			voxel_map_layers_indices_.clear();
+			if (!voxel_map_) { return; }
+
+			Eigen::Vector2f offsets[4] = { Eigen::Vector2f(0.0f, 0.0f), Eigen::Vector2f(NDT2D::grid_step_[0] * 0.5f, 0.0f), Eigen::Vector2f(0.0f, NDT2D::grid_step_[1] * 0.5f), NDT2D::grid_step_ * 0.5f };
+			for (size_t i = 0; i < 4; ++i) {
+				typename NormalDistributionsTransformVoxelMap<PointTarget>::LayerConfiguration layer_configuration;
+				layer_configuration.type = NormalDistributionsTransformVoxelMap<PointTarget>::PlanarLayer;
+				layer_configuration.voxel_size = Eigen::Vector3d(NDT2D::grid_step_[0], NDT2D::grid_step_[1], 0.0);
+				Eigen::Vector2f grid_min = NDT2D::grid_centre_ + offsets[i] - NDT2D::grid_extent_;
+				layer_configuration.origin = Eigen::Vector3d(grid_min[0], grid_min[1], 0.0);
+				voxel_map_layers_indices_.push_back(voxel_map_->addLayer(layer_configuration));
+			}
+		}
+
 		virtual void computeTransformation(pcl::PointCloud<PointSource> &output, const Eigen::Matrix4f &guess) {
 			pcl::Registration<PointSource, PointTarget>::nr_iterations_ = 0;
 			pcl::Registration<PointSource, PointTarget>::converged_ = false;
-			pcl::NormalDistributionsTransform2D<PointSource, PointTarget>::computeTransformation(output, guess);
+			if (voxel_map_ && voxel_map_->getReferencePointCloud().get() == pcl::Registration<PointSource, PointTarget>::target_.get()) {
+				computeTransformationWithVoxelMap(output, guess);
+			} else {
+				pcl::NormalDistributionsTransform2D<PointSource, PointTarget>::computeTransformation(output, guess);
+			}
+		}
+
+	protected:
+		/*! Same optimization as pcl::NormalDistributionsTransform2D::computeTransformation, but with the normal distributions of the shared voxel map. */
+		void computeTransformationWithVoxelMap(pcl::PointCloud<PointSource> &output, const Eigen::Matrix4f &guess) {
+			using Registration = pcl::Registration<PointSource, PointTarget>;
+			pcl::PointCloud<PointSource> intermediate_pointcloud = output;
+			Eigen::Matrix4f& transformation = Registration::transformation_;
+			if (guess != Eigen::Matrix4f::Identity()) {
+				transformation = guess;
+				pcl::transformPointCloud(output, intermediate_pointcloud, transformation);
+			}
+
+			Eigen::Vector3f rotation_x = transformation.block<3, 3>(0, 0) * Eigen::Vector3f::UnitX();
+			Eigen::Vector3d xytheta_transformation(transformation(0, 3), transformation(1, 3), std::atan2(rotation_x[1], rotation_x[0]));
+
+			while (!Registration::converged_) {
+				const double cos_theta = std::cos(xytheta_transformation[2]);
+				const double sin_theta = std::sin(xytheta_transformation[2]);
+				Registration::previous_transformation_ = transformation;
+
+				double score_value = 0.0;
+				Eigen::Vector3d score_gradient = Eigen::Vector3d::Zero();
+				Eigen::Matrix3d score_hessian = Eigen::Matrix3d::Zero();
+				for (size_t i = 0; i < intermediate_pointcloud.size(); ++i) {
+					addVoxelMapScore(intermediate_pointcloud[i], cos_theta, sin_theta, score_value, score_gradient, score_hessian);
+				}
+
+				if (score_value != 0.0) {
+					// ensure that the hessian is positive definite
+					Eigen::EigenSolver<Eigen::Matrix3d> solver;
+					solver.compute(score_hessian, false);
+					double min_eigenvalue = 0.0;
+					for (int i = 0; i < 3; ++i) {
+						if (solver.eigenvalues()[i].real() < min_eigenvalue) { min_eigenvalue = solver.eigenvalues()[i].real(); }
+					}
+					if (min_eigenvalue < 0.0) {
+						double lambda = 1.1 * min_eigenvalue - 1.0;
+						score_hessian += Eigen::Vector3d(-lambda, -lambda, -lambda).asDiagonal();
+					}
+
+					Eigen::Vector3d delta_transformation(-score_hessian.inverse() * score_gradient);
+					xytheta_transformation += pcl::NormalDistributionsTransform2D<PointSource, PointTarget>::newton_lambda_.cwiseProduct(delta_transformation);
+					transformation.block<3, 3>(0, 0) = Eigen::Matrix3f(Eigen::AngleAxisf((float)xytheta_transformation[2], Eigen::Vector3f::UnitZ()));
+					transformation.block<3, 1>(0, 3) = Eigen::Vector3f((float)xytheta_transformation[0], (float)xytheta_transformation[1], 0.0f);
+				} else {
+					PCL_ERROR("[NormalDistributionsTransform2DDetailed::computeTransformation] no overlap: try increasing the size or reducing the step of the grid\n");
+					break;
+				}
+
+				pcl::transformPointCloud(output, intermediate_pointcloud, transformation);
+				++Registration::nr_iterations_;
+				if (Registration::update_visualizer_) {
+					Registration::update_visualizer_(output, *Registration::indices_, *Registration::target_, *Registration::indices_);
+				}
+
+				Eigen::Matrix4f transformation_delta = transformation.inverse() * Registration::previous_transformation_;
+				double cos_angle = 0.5 * (transformation_delta.coeff(0, 0) + transformation_delta.coeff(1, 1) + transformation_delta.coeff(2, 2) - 1);
+				double translation_sqr = transformation_delta.coeff(0, 3) * transformation_delta.coeff(0, 3) + transformation_delta.coeff(1, 3) * transformation_delta.coeff(1, 3) + transformation_delta.coeff(2, 3) * transformation_delta.coeff(2, 3);
+				bool translation_converged = Registration::transformation_epsilon_ > 0 && translation_sqr <= Registration::transformation_epsilon_;
+				bool rotation_converged = Registration::transformation_rotation_epsilon_ > 0 && cos_angle >= Registration::transformation_rotation_epsilon_;
+				if (Registration::nr_iterations_ >= Registration::max_iterations_ ||
+						(translation_converged && rotation_converged) ||
+						(Registration::transformation_epsilon_ <= 0 && rotation_converged) ||
+						(translation_converged && Registration::transformation_rotation_epsilon_ <= 0)) {
+					Registration::converged_ = true;
+				}
+			}
+
+			Registration::final_transformation_ = transformation;
+			output = intermediate_pointcloud;
+		}
+
+		/*! Same cost function as pcl::ndt2d::NormalDist::test, summed over the 4 overlapping grids. */
+		void addVoxelMapScore(const PointSource& point, double cos_theta, double sin_theta, double& score_value, Eigen::Vector3d& score_gradient, Eigen::Matrix3d& score_hessian) const {
+			for (size_t i = 0; i < voxel_map_layers_indices_.size(); ++i) {
+				const typename NormalDistributionsTransformVoxelMap<PointTarget>::Voxel* voxel = voxel_map_->findVoxel(voxel_map_layers_indices_[i], point.x, point.y, point.z);
+				if (!voxel || !voxel->valid) { continue; }
+
+				const double x = point.x;
+				const double y = point.y;
+				const Eigen::Matrix2d inverse_covariance = voxel->inverse_covariance.template topLeftCorner<2, 2>();
+				const Eigen::Vector2d q = Eigen::Vector2d(x, y) - voxel->mean.template head<2>();
+				const Eigen::RowVector2d qt_cvi(q.transpose() * inverse_covariance);
+				const double exp_qt_cvi_q = std::exp(-0.5 * double(qt_cvi * q));
+				score_value -= exp_qt_cvi_q;
+
+				Eigen::Matrix<double, 2, 3> jacobian;
+				jacobian << 1, 0, -(x * sin_theta + y * cos_theta),
+				            0, 1, x * cos_theta - y * sin_theta;
+				const Eigen::Vector2d d2q_didj(y * sin_theta - x * cos_theta, -(x * sin_theta + y * cos_theta));
+
+				for (int j = 0; j < 3; ++j) {
+					score_gradient[j] += double(qt_cvi * jacobian.col(j)) * exp_qt_cvi_q;
+					for (int k = 0; k < 3; ++k) {
+						score_hessian(j, k) += -exp_qt_cvi_q * (
+								double(-qt_cvi * jacobian.col(j)) * double(-qt_cvi * jacobian.col(k)) +
+								((j == 2 && k == 2) ? double(-qt_cvi * d2q_didj) : 0.0) -
+								double(jacobian.col(k).transpose() * inverse_covariance * jacobian.col(j)));
+					}
+				}
+			}
 		}
+
+		typename NormalDistributionsTransformVoxelMap<PointTarget>::Ptr voxel_map_;
+		std::vector<size_t> voxel_map_layers_indices_;
 };
 
 // #####################################################################   NormalDistributionsTransform2D   ####################################################################
@@ -61,18 +197,27 @@ class NormalDistributionsTransform2D : public CloudMatcher<PointT> {
 
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <NormalDistributionsTransform2D-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 		virtual void setupConfigurationFromParameterServer(ros::NodeHandlePtr& node_handle, ros::NodeHandlePtr& private_node_handle, const std::string& configuration_namespace);
+		/*! Updates the voxel map before the base setup (only the voxels with inserted or removed points are recomputed). */
+		virtual void setupReferenceCloud(typename pcl::PointCloud<PointT>::Ptr& reference_cloud, typename pcl::PointCloud<PointT>::Ptr& reference_cloud_keypoints,
+				typename pcl::search::KdTree<PointT>::Ptr& search_method);
 		virtual int getNumberOfRegistrationIterations();
+		/*! Besides the base accounting, includes the voxel map (counted only once if shared with other matchers). */
+		virtual size_t accountMemoryUsage(MemoryUsage& memory_usage);
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </NormalDistributionsTransform2D-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <gets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		inline typename NormalDistributionsTransformVoxelMap<PointT>::Ptr getNormalDistributionsTransformVoxelMap() { return voxel_map_; }
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </gets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <sets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		/*! Allows several matchers to share the same voxel map (its layers are only computed once per reference point cloud). */
+		void setNormalDistributionsTransformVoxelMap(const typename NormalDistributionsTransformVoxelMap<PointT>::Ptr& voxel_map);
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </sets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 	// ========================================================================   </public-section>  ===========================================================================
 
 	// ========================================================================   <protected-section>   ========================================================================
 	protected:
+		typename NormalDistributionsTransformVoxelMap<PointT>::Ptr voxel_map_;
 	// ========================================================================   </protected-section>  ========================================================================
 };
 
@@ -9,14 +9,17 @@
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>  <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 // std includes
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <utility>
 
 // PCL includes
 #include <pcl/registration/ndt.h>
 
 // project includes
 #include <dynamic_robot_localization/cloud_matchers/cloud_matcher.h>
+#include <dynamic_robot_localization/cloud_matchers/normal_distributions_transform_voxel_map.h>
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 namespace dynamic_robot_localization {
@@ -28,7 +31,60 @@ class NormalDistributionsTransformDetailed: public pcl::NormalDistributionsTrans
 		using Ptr = std::shared_ptr< NormalDistributionsTransformDetailed<PointSource, PointTarget> >;
 		using ConstPtr = std::shared_ptr< const NormalDistributionsTransformDetailed<PointSource, PointTarget> >;
 
+		virtual ~NormalDistributionsTransformDetailed() {
+			if (voxel_map_) { voxel_map_->removeVoxelGridUser(voxel_map_layer_index_); }
+		}
+
 		inline int getNumberOfRegistrationIterations() { return pcl::Registration<PointSource, PointTarget>::nr_iterations_; }
+		inline typename NormalDistributionsTransformVoxelMap<PointTarget>::Ptr getNormalDistributionsTransformVoxelMap() { return voxel_map_; }
+
+		/*! Adds to the voxel map a volumetric layer with the resolution of the matcher (must be called after setting the resolution).
+		 * When the voxel map has the target point cloud, the voxel grid of the matcher is taken from the voxel map instead of being built from the target point cloud. */
+		void setNormalDistributionsTransformVoxelMap(const typename NormalDistributionsTransformVoxelMap<PointTarget>::Ptr& voxel_map) {
+			if (voxel_map_) { voxel_map_->removeVoxelGridUser(voxel_map_layer_index_); }
+			voxel_map_ = voxel_map;
+			voxel_grid_generation_ = 0;
+			if (!voxel_map_) { return; }
+			typename NormalDistributionsTransformVoxelMap<PointTarget>::LayerConfiguration layer_configuration;
+			layer_configuration.type = NormalDistributionsTransformVoxelMap<PointTarget>::VolumetricLayer;
+			layer_configuration.voxel_size = Eigen::Vector3d::Constant(pcl::NormalDistributionsTransform<PointSource, PointTarget>::resolution_);
+			layer_configuration.origin = Eigen::Vector3d::Zero();
+			voxel_map_layer_index_ = voxel_map_->addLayer(layer_configuration);
+			voxel_map_->addVoxelGridUser(voxel_map_layer_index_);
+		}
+
+		/*! Reuses the voxel grid of the voxel map layer, which is only copied when other matchers also use the layer (the last matcher to acquire it moves it).
+		 * If the layer was not rebuilt since the last call, target_cells_ already has its voxel grid. */
+		virtual void setInputTarget(const typename pcl::Registration<PointSource, PointTarget>::PointCloudTargetConstPtr& cloud) {
+			using NDT = pcl::NormalDistributionsTransform<PointSource, PointTarget>;
+			if (voxel_map_ && voxel_map_->getReferencePointCloud().get() == cloud.get()) {
+				std::uint64_t voxel_grid_generation = voxel_map_->getVoxelGridGeneration(voxel_map_layer_index_);
+				if (voxel_grid_generation != 0 && voxel_grid_generation == voxel_grid_generation_) {
+					pcl::Registration<PointSource, PointTarget>::setInputTarget(cloud);
+					return;
+				}
+
+				std::shared_ptr< pcl::VoxelGridCovariance<PointTarget> > voxel_grid = voxel_map_->acquireVoxelGrid(voxel_map_layer_index_);
+				if (voxel_grid) {
+					pcl::Registration<PointSource, PointTarget>::setInputTarget(cloud);
+					if (voxel_grid.use_count() == 1) {
+						NDT::target_cells_ = std::move(*voxel_grid); // released by the voxel map
+					} else {
+						NDT::target_cells_ = *voxel_grid; // pcl::NormalDistributionsTransform keeps its voxel grid by value
+					}
+					voxel_grid_generation_ = voxel_grid_generation;
+					return;
+				}
+			}
+
+			voxel_grid_generation_ = 0;
+			NDT::setInputTarget(cloud);
+		}
+
+	protected:
+		typename NormalDistributionsTransformVoxelMap<PointTarget>::Ptr voxel_map_;
+		size_t voxel_map_layer_index_ = 0;
+		std::uint64_t voxel_grid_generation_ = 0; // generation of the voxel map layer copied to target_cells_
 };
 
 
@@ -52,18 +108,27 @@ class NormalDistributionsTransform3D : public CloudMatcher<PointT> {
 
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <NormalDistributionsTransform3D-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 		virtual void setupConfigurationFromParameterServer(ros::NodeHandlePtr& node_handle, ros::NodeHandlePtr& private_node_handle, const std::string& configuration_namespace);
+		/*! Updates the voxel map before the base setup (only the voxels with inserted or removed points are recomputed). */
+		virtual void setupReferenceCloud(typename pcl::PointCloud<PointT>::Ptr& reference_cloud, typename pcl::PointCloud<PointT>::Ptr& reference_cloud_keypoints,
+				typename pcl::search::KdTree<PointT>::Ptr& search_method);
 		virtual int getNumberOfRegistrationIterations();
+		/*! Besides the base accounting, includes the voxel map (counted only once if shared with other matchers). */
+		virtual size_t accountMemoryUsage(MemoryUsage& memory_usage);
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </NormalDistributionsTransform3D-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <gets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		inline typename NormalDistributionsTransformVoxelMap<PointT>::Ptr getNormalDistributionsTransformVoxelMap() { return voxel_map_; }
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </gets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <sets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		/*! Allows several matchers to share the same voxel map (its layers are only computed once per reference point cloud). */
+		void setNormalDistributionsTransformVoxelMap(const typename NormalDistributionsTransformVoxelMap<PointT>::Ptr& voxel_map);
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </sets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 	// ========================================================================   </public-section>  ===========================================================================
 
 	// ========================================================================   <protected-section>   ========================================================================
 	protected:
+		typename NormalDistributionsTransformVoxelMap<PointT>::Ptr voxel_map_;
 	// ========================================================================   </protected-section>  ========================================================================
 };
 
@@ -27,6 +27,7 @@
 // project includes
 #include <dynamic_robot_localization/common/common.h>
 #include <dynamic_robot_localization/common/performance_timer.h>
+#include <dynamic_robot_localization/common/tracer.h>
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 namespace dynamic_robot_localization {
@@ -56,6 +57,7 @@ class BaseClass##Suffix : public pcl::registration::BaseClass< DRL_UNPACK_ARGS T
 		virtual ~BaseClass##Suffix() {} \
 \
 		virtual void estimateRigidTransformation (const pcl::PointCloud<PointSource> &cloud_src, const pcl::PointCloud<PointTarget> &cloud_tgt, const pcl::Correspondences &correspondences, typename pcl::registration::TransformationEstimation< DRL_UNPACK_ARGS TemplatesUsage >::Matrix4 &transformation_matrix) const {\
+			DRL_TRACE_SCOPE("transformation_estimation/" #BaseClass); \
 			PerformanceTimer timer_; \
 			timer_.start(); \
 			pcl::registration::BaseClass< DRL_UNPACK_ARGS TemplatesUsage >::estimateRigidTransformation(cloud_src, cloud_tgt, correspondences, transformation_matrix); \
@@ -66,7 +66,7 @@ class ClusterSelector : public ConfigurableObject {
 
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <sets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 		void setClusterSorter(typename ClusterSorter<PointT>::Ptr& cluster_sorter) { cluster_sorter_ = cluster_sorter; }
-		void setTfCollector(laserscan_to_pointcloud::TFCollector* tfCollector) { tf_collector_ = tfCollector; }
+		void setTfCollector(laserscan_to_pointcloud::TFCollector* tfCollector) { tf_collector_ = tfCollector; if (cluster_sorter_) { cluster_sorter_->setTfCollector(tfCollector); } }
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </sets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 	// ========================================================================   </public-section>  ===========================================================================
 
@@ -0,0 +1,101 @@
+#pragma once
+
+/**\file async_cloud_publisher.h
+ * \brief Publication thread that converts and publishes point clouds outside of the localization callback
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>  <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// std includes
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+// ROS includes
+#include <ros/publisher.h>
+#include <sensor_msgs/PointCloud2.h>
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+namespace dynamic_robot_localization {
+// ############################################################################   AsyncCloudPublisher   ###########################################################################
+/**
+ * \brief Builds and publishes the point cloud msgs in a dedicated thread, removing the conversion and serialization of debug and result clouds from the pose latency.
+ * The message builders must only capture immutable data (usually a shared pointer to a point cloud that is no longer changed by the localization pipeline).
+ * The memory is bounded by the maximum number of queued msgs and by the estimated size of their point clouds (the oldest msgs are dropped when the limits are exceeded).
+ * A msg that is still queued for a topic is replaced by a newer one for the same topic, because only the most recent cloud is relevant for visualization.
+ * When the thread is not running, the msgs are built and published immediately in the thread of the caller.
+ */
+class AsyncCloudPublisher {
+	// ========================================================================   <public-section>   ===========================================================================
+	public:
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <usings>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		using MessageBuilder = std::function< sensor_msgs::PointCloud2Ptr() >;
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </usings>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <constructors-destructor>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		static AsyncCloudPublisher& getInstance();
+		virtual ~AsyncCloudPublisher() { stop(); }
+		AsyncCloudPublisher(const AsyncCloudPublisher&) = delete;
+		AsyncCloudPublisher& operator=(const AsyncCloudPublisher&) = delete;
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </constructors-destructor>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <AsyncCloudPublisher-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		/*! True if the publisher has a topic and (when requested) subscribers, which allows to skip the copies and conversions of clouds that would not be published. */
+		static bool s_isPublishing(const ros::Publisher& publisher, bool publish_only_if_there_is_subscribers);
+
+		void start();
+		/*! Stops the publication thread and discards the queued msgs. */
+		void stop();
+		bool isRunning();
+
+		/*! @return false if the msg was not queued (publisher without topic) or if older msgs had to be dropped */
+		bool publish(const ros::Publisher& publisher, const MessageBuilder& message_builder, size_t estimated_size_in_bytes);
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </AsyncCloudPublisher-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <gets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		size_t getQueueSize();
+		size_t getQueuedBytes();
+		std::uint64_t getNumberOfDroppedMessages();
+		size_t getMaximumQueueSize();
+		size_t getMaximumQueuedBytes();
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </gets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <sets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		void setMaximumQueueSize(size_t maximum_queue_size);
+		/*! The most recent msg is always kept, even if its point cloud is larger than the limit. */
+		void setMaximumQueuedBytes(size_t maximum_queued_bytes);
+		void resetNumberOfDroppedMessages();
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </sets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+	// ========================================================================   </public-section>  ===========================================================================
+
+	// ========================================================================   <protected-section>   ========================================================================
+	protected:
+		struct PublicationRequest {
+			ros::Publisher publisher;
+			MessageBuilder message_builder;
+			size_t estimated_size_in_bytes;
+		};
+
+		AsyncCloudPublisher();
+		void dropExcessRequests();
+		void publicationWorker();
+
+		std::mutex mutex_;
+		std::condition_variable condition_variable_;
+		std::deque<PublicationRequest> requests_;
+		size_t queued_bytes_;
+		size_t maximum_queue_size_;
+		size_t maximum_queued_bytes_;
+		std::uint64_t number_of_dropped_messages_;
+		bool running_;
+		std::thread publication_thread_;
+	// ========================================================================   </protected-section>  ========================================================================
+};
+
+} /* namespace dynamic_robot_localization */
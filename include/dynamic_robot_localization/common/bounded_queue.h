@@ -0,0 +1,115 @@
+#pragma once
+
+/**\file bounded_queue.h
+ * \brief Thread safe FIFO queue with a maximum size that drops the oldest elements when full (used between the stages of the processing pipeline)
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>  <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// std includes
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+namespace dynamic_robot_localization {
+// ##############################################################################   BoundedQueue   ###########################################################################
+/**
+ * \brief FIFO queue shared between a producer and a consumer thread.
+ * When the queue is full, push discards the oldest element (newer sensor data is more relevant for localization) and increments the dropped elements counter.
+ * pop blocks until an element is available or the queue is shutdown.
+ */
+template <typename T>
+class BoundedQueue {
+	// ========================================================================   <public-section>   ===========================================================================
+	public:
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <usings>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		using Ptr = std::shared_ptr< BoundedQueue<T> >;
+		using ConstPtr = std::shared_ptr< const BoundedQueue<T> >;
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </usings>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <constructors-destructor>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		explicit BoundedQueue(size_t capacity = 1) : capacity_(capacity > 0 ? capacity : 1), number_of_dropped_elements_(0), shutdown_(false) {}
+		virtual ~BoundedQueue() { shutdown(); }
+		BoundedQueue(const BoundedQueue&) = delete;
+		BoundedQueue& operator=(const BoundedQueue&) = delete;
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </constructors-destructor>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <BoundedQueue-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		/*! @return false if the oldest element had to be dropped or if the queue was shutdown */
+		bool push(const T& element) {
+			bool element_dropped = false;
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				if (shutdown_) { return false; }
+				while (elements_.size() >= capacity_) {
+					elements_.pop_front();
+					++number_of_dropped_elements_;
+					element_dropped = true;
+				}
+				elements_.push_back(element);
+			}
+			condition_variable_.notify_one();
+			return !element_dropped;
+		}
+
+		/*! @return false if the queue was shutdown */
+		bool pop(T& element) {
+			std::unique_lock<std::mutex> lock(mutex_);
+			condition_variable_.wait(lock, [this] { return shutdown_ || !elements_.empty(); });
+			if (shutdown_) { return false; }
+			element = elements_.front();
+			elements_.pop_front();
+			return true;
+		}
+
+		void shutdown() {
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				shutdown_ = true;
+				elements_.clear();
+			}
+			condition_variable_.notify_all();
+		}
+
+		void restart() {
+			std::lock_guard<std::mutex> lock(mutex_);
+			shutdown_ = false;
+		}
+
+		void clear() {
+			std::lock_guard<std::mutex> lock(mutex_);
+			elements_.clear();
+		}
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </BoundedQueue-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <gets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		size_t size() { std::lock_guard<std::mutex> lock(mutex_); return elements_.size(); }
+		bool empty() { std::lock_guard<std::mutex> lock(mutex_); return elements_.empty(); }
+		size_t getCapacity() { std::lock_guard<std::mutex> lock(mutex_); return capacity_; }
+		size_t getNumberOfDroppedElements() { std::lock_guard<std::mutex> lock(mutex_); return number_of_dropped_elements_; }
+		bool isShutdown() { std::lock_guard<std::mutex> lock(mutex_); return shutdown_; }
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </gets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <sets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		void setCapacity(size_t capacity) { std::lock_guard<std::mutex> lock(mutex_); capacity_ = (capacity > 0 ? capacity : 1); }
+		void resetNumberOfDroppedElements() { std::lock_guard<std::mutex> lock(mutex_); number_of_dropped_elements_ = 0; }
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </sets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+	// ========================================================================   </public-section>  ===========================================================================
+
+	// ========================================================================   <protected-section>   ========================================================================
+	protected:
+		std::deque<T> elements_;
+		size_t capacity_;
+		size_t number_of_dropped_elements_;
+		bool shutdown_;
+		std::mutex mutex_;
+		std::condition_variable condition_variable_;
+	// ========================================================================   </protected-section>  ========================================================================
+};
+
+} /* namespace dynamic_robot_localization */
@@ -0,0 +1,121 @@
+#pragma once
+
+/**\file chunked_circular_buffer_pointcloud.h
+ * \brief Circular buffer of point clouds stored in per scan chunks, each with its own cached k-d tree
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>  <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// std includes
+#include <algorithm>
+#include <deque>
+#include <memory>
+
+// PCL includes
+#include <pcl/common/common.h>
+#include <pcl/common/transforms.h>
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+#include <pcl/search/kdtree.h>
+
+// external libs includes
+#include <Eigen/Core>
+
+// project includes
+#include <dynamic_robot_localization/common/chunked_kdtree_search.h>
+#include <dynamic_robot_localization/common/memory_usage.h>
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+namespace dynamic_robot_localization {
+// ##################################################################   ChunkedCircularBufferPointCloud   ####################################################################
+/**
+ * \brief Circular buffer with a maximum number of points, in which each inserted point cloud is kept in its own chunk with a k-d tree built only once (when it is inserted).
+ * When the buffer is full, the oldest chunks are dropped (only the oldest remaining chunk may need to be trimmed and reindexed).
+ * The points of the chunks are kept in a point cloud used as a ring, in which the points of a new chunk overwrite the slots of the expired points
+ * (inserting a chunk only copies its points, instead of shifting the whole point cloud), and getSearchMethod gives a ChunkedKdTreeSearch over it that reuses the k-d trees of the chunks.
+ * As such, the points are not sorted by age and a chunk may wrap around the end of the point cloud.
+ * If the ring point cloud is transformed in place, applyTransform must be called with the same transform
+ * (the chunks keep their original coordinates and only update the transform used in the searches).
+ */
+template <typename PointT>
+class ChunkedCircularBufferPointCloud {
+	// ========================================================================   <public-section>   ===========================================================================
+	public:
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <usings>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		using Ptr = std::shared_ptr< ChunkedCircularBufferPointCloud<PointT> >;
+		using ConstPtr = std::shared_ptr< const ChunkedCircularBufferPointCloud<PointT> >;
+
+		struct PointCloudChunk {
+			typename pcl::PointCloud<PointT>::Ptr pointcloud;
+			typename pcl::search::KdTree<PointT>::Ptr search_method;
+			Eigen::Matrix<float, 4, 4, Eigen::DontAlign> chunk_to_buffer_transform;
+			Eigen::Vector3f min_point;
+			Eigen::Vector3f max_point;
+			size_t first_point_index; // in the ring point cloud
+		};
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </usings>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <constructors-destructor>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		explicit ChunkedCircularBufferPointCloud(size_t max_buffer_size = 1024);
+		virtual ~ChunkedCircularBufferPointCloud() {}
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </constructors-destructor>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <ChunkedCircularBufferPointCloud-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		/*! Adds a new chunk with the points (if the cloud has more than max_buffer_size points, only the first max_buffer_size points are used) and drops the oldest points that no longer fit in the buffer. */
+		void insert(const pcl::PointCloud<PointT>& new_elements);
+		/*! Erasing points outside insert requires compacting the ring point cloud (which is linear in the number of points in the buffer). */
+		void eraseNewest(size_t count = 1);
+		void eraseOldest(size_t count = 1);
+		void applyTransform(const Eigen::Matrix4f& transform);
+		void clear();
+		/*! Releases the memory reserved for points that were already erased (used after reducing the max buffer size). */
+		void shrinkToFit();
+		/*! Accounts the concatenated point cloud and the point clouds and k-d trees of the chunks. */
+		size_t accountMemoryUsage(MemoryUsage& memory_usage) const;
+
+		/*! Search method over getPointCloudPtr() that only queries the k-d trees of the chunks (falls back to a normal k-d tree if the point cloud was resized outside the buffer). */
+		typename pcl::search::KdTree<PointT>::Ptr getSearchMethod();
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </ChunkedCircularBufferPointCloud-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <gets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		bool empty() const { return number_of_points_ == 0; }
+		size_t size() const { return number_of_points_; }
+		size_t getNumberOfChunks() const { return chunks_.size(); }
+		const std::deque<PointCloudChunk>& getChunks() const { return chunks_; }
+		typename pcl::PointCloud<PointT>& getPointCloud() { return *pointcloud_; }
+		typename pcl::PointCloud<PointT>::Ptr getPointCloudPtr() { return pointcloud_; }
+		size_t getMaxBufferSize() const { return max_buffer_size_; }
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </gets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <sets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		void setMaxBufferSize(size_t max_buffer_size) { max_buffer_size_ = max_buffer_size; if (number_of_points_ > max_buffer_size_) { eraseOldest(number_of_points_ - max_buffer_size_); } }
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </sets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+	// ========================================================================   </public-section>  ===========================================================================
+
+	// ========================================================================   <protected-section>   ========================================================================
+	protected:
+		/*! Rebuilds the ring point cloud from the chunks if it was resized outside the buffer (called before changing the chunks). */
+		void updatePointCloud();
+		/*! Drops the oldest points from the chunks and advances the start of the ring, without moving the points in the ring point cloud (their slots become free). */
+		void expireOldestPoints(size_t count);
+		/*! Rotates the ring point cloud in order to start with the oldest point and removes the free slots. */
+		void compactPointCloud();
+		void updateChunkSearchMethod(PointCloudChunk& chunk);
+		void appendChunkToPointCloud(const PointCloudChunk& chunk);
+
+		std::deque<PointCloudChunk> chunks_;
+		typename pcl::PointCloud<PointT>::Ptr pointcloud_;
+		size_t number_of_points_;
+		size_t max_buffer_size_;
+		size_t ring_start_; // slot of the oldest point (only != 0 after the ring point cloud reached the max buffer size)
+	// ========================================================================   </protected-section>  ========================================================================
+};
+
+} /* namespace dynamic_robot_localization */
+
+
+#ifdef DRL_NO_PRECOMPILE
+#include <dynamic_robot_localization/common/impl/chunked_circular_buffer_pointcloud.hpp>
+#endif
@@ -0,0 +1,131 @@
+#pragma once
+
+/**\file chunked_kdtree_search.h
+ * \brief Search method that queries a set of k-d trees built over the chunks of a point cloud
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>  <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// std includes
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+// PCL includes
+#include <pcl/common/point_tests.h>
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+#include <pcl/search/kdtree.h>
+
+// external libs includes
+#include <Eigen/Core>
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+namespace dynamic_robot_localization {
+// #########################################################################   ChunkedKdTreeSearch   ##########################################################################
+/**
+ * \brief Nearest neighbor search over a point cloud that is the concatenation of several chunks, each with its own (cached) k-d tree.
+ * Derives from pcl::search::KdTree in order to be a drop in replacement for the search methods given to the normal estimators, keypoint detectors, matchers and outlier detectors.
+ * Each chunk has a rigid transform from the coordinates of the concatenated cloud to the coordinates in which its k-d tree was built,
+ * which allows to move the chunks without rebuilding their k-d trees.
+ * The results of the chunks are merged and their indices are offset to the position of the chunk in the concatenated cloud
+ * (a chunk may wrap around the end of the cloud, which allows to use a ring point cloud without reordering its points).
+ * The intermediate results of the queries are kept in thread local buffers, in order to avoid allocations in each query.
+ * If setInputCloud is called with a different cloud, it behaves as a normal pcl::search::KdTree.
+ */
+template <typename PointT>
+class ChunkedKdTreeSearch : public pcl::search::KdTree<PointT> {
+	// ========================================================================   <public-section>   ===========================================================================
+	public:
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <usings>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		using Ptr = std::shared_ptr< ChunkedKdTreeSearch<PointT> >;
+		using ConstPtr = std::shared_ptr< const ChunkedKdTreeSearch<PointT> >;
+		using PointCloudConstPtr = typename pcl::search::KdTree<PointT>::PointCloudConstPtr;
+		using IndicesConstPtr = typename pcl::search::KdTree<PointT>::IndicesConstPtr;
+		using pcl::search::KdTree<PointT>::nearestKSearch;
+		using pcl::search::KdTree<PointT>::radiusSearch;
+
+		struct Chunk {
+			typename pcl::search::KdTree<PointT>::Ptr search_method;
+			size_t first_point_index;
+			size_t number_of_points;
+			size_t number_of_points_before_wrap; // the remaining points are at the start of the cloud
+			Eigen::Matrix3f cloud_to_chunk_rotation;
+			Eigen::Vector3f cloud_to_chunk_translation;
+			Eigen::Vector3f min_point; // bounding box in chunk coordinates
+			Eigen::Vector3f max_point;
+		};
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </usings>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <constructors-destructor>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		explicit ChunkedKdTreeSearch(bool sorted = true);
+		virtual ~ChunkedKdTreeSearch() {}
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </constructors-destructor>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <ChunkedKdTreeSearch-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		/*! The chunks must be added in the order in which their points appear in the concatenated cloud. */
+		void addChunk(const typename pcl::search::KdTree<PointT>::Ptr& chunk_search_method, const Eigen::Matrix4f& chunk_to_cloud_transform, const Eigen::Vector3f& min_point, const Eigen::Vector3f& max_point);
+		/*! Adds a chunk whose points start at first_point_index and continue at the start of the cloud after number_of_points_before_wrap points. */
+		void addChunk(const typename pcl::search::KdTree<PointT>::Ptr& chunk_search_method, const Eigen::Matrix4f& chunk_to_cloud_transform, const Eigen::Vector3f& min_point, const Eigen::Vector3f& max_point,
+				size_t first_point_index, size_t number_of_points_before_wrap);
+
+		/*! Uses the chunks for the searches if the cloud has the same number of points as all the chunks (no k-d tree is built). */
+		void setChunkedInputCloud(const PointCloudConstPtr& cloud);
+
+		virtual void setInputCloud(const PointCloudConstPtr& cloud, const IndicesConstPtr& indices = IndicesConstPtr());
+		virtual int nearestKSearch(const PointT& point, int k, std::vector<int>& k_indices, std::vector<float>& k_sqr_distances) const;
+		virtual int radiusSearch(const PointT& point, double radius, std::vector<int>& k_indices, std::vector<float>& k_sqr_distances, unsigned int max_nn = 0) const;
+		void clearChunks();
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </ChunkedKdTreeSearch-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <gets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		inline bool isUsingChunks() const { return using_chunks_; }
+		inline size_t getNumberOfChunks() const { return chunks_.size(); }
+		inline size_t getNumberOfPointsInChunks() const { return number_of_points_in_chunks_; }
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </gets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+	// ========================================================================   </public-section>  ===========================================================================
+
+	// ========================================================================   <protected-section>   ========================================================================
+	protected:
+		struct SearchBuffers {
+			std::vector< std::pair<float, size_t> > chunks_by_distance;
+			std::vector< std::pair<float, int> > neighbors;
+			std::vector<int> chunk_indices;
+			std::vector<float> chunk_sqr_distances;
+		};
+
+		/*! Scratch buffers reused by the queries of each thread (the k-d trees of the chunks are normal pcl::search::KdTree, so the buffers are never used by nested queries). */
+		static inline SearchBuffers& s_getSearchBuffers() {
+			static thread_local SearchBuffers search_buffers;
+			return search_buffers;
+		}
+
+		inline int convertChunkIndexToCloudIndex(int chunk_index, const Chunk& chunk) const {
+			return ((size_t)chunk_index < chunk.number_of_points_before_wrap) ? chunk_index + (int)chunk.first_point_index : chunk_index - (int)chunk.number_of_points_before_wrap;
+		}
+
+		inline PointT transformPointToChunk(const PointT& point, const Chunk& chunk) const {
+			PointT chunk_point = point;
+			chunk_point.getVector3fMap() = chunk.cloud_to_chunk_rotation * point.getVector3fMap() + chunk.cloud_to_chunk_translation;
+			return chunk_point;
+		}
+
+		inline float computeSquaredDistanceToChunk(const PointT& chunk_point, const Chunk& chunk) const {
+			Eigen::Vector3f distance = (chunk.min_point - chunk_point.getVector3fMap()).cwiseMax(chunk_point.getVector3fMap() - chunk.max_point).cwiseMax(Eigen::Vector3f::Zero());
+			return distance.squaredNorm();
+		}
+
+		std::vector<Chunk> chunks_;
+		size_t number_of_points_in_chunks_;
+		bool using_chunks_;
+	// ========================================================================   </protected-section>  ========================================================================
+};
+
+} /* namespace dynamic_robot_localization */
+
+
+#ifdef DRL_NO_PRECOMPILE
+#include <dynamic_robot_localization/common/impl/chunked_kdtree_search.hpp>
+#endif
@@ -17,6 +17,9 @@
 // PCL includes
 #include <pcl/point_cloud.h>
 #include <pcl/point_types.h>
+
+// project includes
+#include <dynamic_robot_localization/common/memory_usage.h>
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 namespace dynamic_robot_localization {
@@ -68,6 +71,7 @@ class CircularBufferPointCloud {
 		void resize(size_t number_elements) { pointcloud_->resize(number_elements); max_buffer_size_ = number_elements; }
 		void reserve(size_t number_elements) { if (pointcloud_->size() < number_elements) { pointcloud_->reserve(number_elements); max_buffer_size_ = number_elements; } }
 		void clear() { pointcloud_->clear(); }
+		size_t accountMemoryUsage(MemoryUsage& memory_usage) const { return memory_usage.addBytes(this, sizeof(*this)) + memory_usage.addPointCloud(pointcloud_.get()); }
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </CircularBufferPointCloud-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <gets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
@@ -23,6 +23,7 @@
 #include <pcl_conversions/pcl_conversions.h>
 
 // project includes
+#include <dynamic_robot_localization/common/async_cloud_publisher.h>
 #include <dynamic_robot_localization/common/configurable_object.h>
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -50,7 +51,14 @@ class CloudPublisher : public ConfigurableObject {
 
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <CloudPublisher-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 		virtual void setupConfigurationFromParameterServer(ros::NodeHandlePtr& node_handle, ros::NodeHandlePtr& private_node_handle, const std::string& configuration_namespace);
-		void publishPointCloud(const pcl::PointCloud<PointT>& filtered_cloud);
+		/*! Copies the cloud when it has to be published by the AsyncCloudPublisher thread (the caller may change it after this call). */
+		void publishPointCloud(const pcl::PointCloud<PointT>& cloud);
+		/*! Shares the cloud with the AsyncCloudPublisher thread (the cloud must not be changed after this call). */
+		void publishPointCloud(const typename pcl::PointCloud<PointT>::ConstPtr& cloud);
+
+		/*! True if publishPointCloud would publish the point cloud (allows to skip building clouds only needed for publishing). */
+		bool isPublishingPointClouds() const {
+			return !cloud_publisher_.getTopic().empty() && (!publish_pointclouds_only_if_there_is_subscribers_ || cloud_publisher_.getNumSubscribers() > 0); }
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </CloudPublisher-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <gets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
@@ -71,6 +79,8 @@ class CloudPublisher : public ConfigurableObject {
 
 	// ========================================================================   <protected-section>   ========================================================================
 	protected:
+		static sensor_msgs::PointCloud2Ptr s_createPointCloudMsg(const pcl::PointCloud<PointT>& cloud, const std::string& cloud_publish_frame, bool override_cloud_stamp, std::uint64_t cloud_publish_stamp);
+
 		bool publish_pointclouds_only_if_there_is_subscribers_;
 		std::string parameter_server_argument_to_load_topic_name_;
 		std::string parameter_server_argument_to_load_frame_name_;
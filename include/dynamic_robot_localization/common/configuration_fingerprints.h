@@ -0,0 +1,74 @@
+#pragma once
+
+/**\file configuration_fingerprints.h
+ * \brief Fingerprints of the parameters of each module, used to reload only the modules whose configuration changed
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>  <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// std includes
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+
+// ROS includes
+#include <XmlRpcValue.h>
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+namespace dynamic_robot_localization {
+// ##########################################################################   ConfigurationFingerprints   #########################################################################
+/**
+ * \brief Keeps the fingerprint of the parameters that were used to setup each module.
+ * The fingerprints are computed from the xml of the parameters, which allows to compute them from a single parameter server request for the whole configuration namespace.
+ * The parameters of the parent namespaces are also included (without their child namespaces), because the modules search for inherited parameters with ros::param::search.
+ */
+class ConfigurationFingerprints {
+	// ========================================================================   <public-section>   ===========================================================================
+	public:
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <usings>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		using Ptr = std::shared_ptr< ConfigurationFingerprints >;
+		using ConstPtr = std::shared_ptr< const ConfigurationFingerprints >;
+		using FingerprintsMap = std::map< std::string, std::uint64_t >;
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </usings>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <constructors-destructor>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		ConfigurationFingerprints() {}
+		virtual ~ConfigurationFingerprints() {}
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </constructors-destructor>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <ConfigurationFingerprints-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		static std::uint64_t s_computeHash(const std::string& data, std::uint64_t seed = 14695981039346656037ULL);
+
+		/*!
+		 * Fingerprint of the parameters inside parameters_namespace (relative to the configuration namespace whose values are given in configuration).
+		 * The scalar parameters of the parent namespaces are included and missing namespaces contribute only with their name.
+		 */
+		static std::uint64_t s_computeParametersFingerprint(XmlRpc::XmlRpcValue& configuration, const std::string& parameters_namespace, std::uint64_t seed = 14695981039346656037ULL);
+
+		/*! Fingerprint of the size and modification time of the file (allows to detect changes in files with the same name without reading them). */
+		static std::uint64_t s_computeFileFingerprint(const std::string& filepath, std::uint64_t seed = 14695981039346656037ULL);
+
+		/*! @return true if the module has no fingerprint or if it is different from the given one */
+		bool hasChanged(const std::string& module_name, std::uint64_t fingerprint) const;
+
+		/*! Stores the fingerprint of the module. @return true if it changed */
+		bool update(const std::string& module_name, std::uint64_t fingerprint);
+
+		inline void clear() { fingerprints_.clear(); }
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </ConfigurationFingerprints-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <gets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		inline const FingerprintsMap& getFingerprints() const { return fingerprints_; }
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </gets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+	// ========================================================================   </public-section>  ===========================================================================
+
+	// ========================================================================   <protected-section>   ========================================================================
+	protected:
+		FingerprintsMap fingerprints_;
+	// ========================================================================   </protected-section>  ========================================================================
+};
+
+} /* namespace dynamic_robot_localization */
@@ -0,0 +1,233 @@
+/**\file chunked_circular_buffer_pointcloud.hpp
+ * \brief Description...
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+#include <dynamic_robot_localization/common/chunked_circular_buffer_pointcloud.h>
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+namespace dynamic_robot_localization {
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <imports>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </imports>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+// =============================================================================  <public-section>  ============================================================================
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <constructors-destructor>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+template<typename PointT>
+ChunkedCircularBufferPointCloud<PointT>::ChunkedCircularBufferPointCloud(size_t max_buffer_size) :
+	pointcloud_(new pcl::PointCloud<PointT>()),
+	number_of_points_(0),
+	max_buffer_size_(max_buffer_size),
+	ring_start_(0) {}
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </constructors-destructor>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <ChunkedCircularBufferPointCloud-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+template<typename PointT>
+void ChunkedCircularBufferPointCloud<PointT>::insert(const pcl::PointCloud<PointT>& new_elements) {
+	if (new_elements.empty() || max_buffer_size_ == 0) { return; }
+	updatePointCloud();
+
+	PointCloudChunk chunk;
+	chunk.pointcloud.reset(new pcl::PointCloud<PointT>());
+	if (new_elements.size() <= max_buffer_size_) {
+		*chunk.pointcloud = new_elements;
+	} else {
+		chunk.pointcloud->header = new_elements.header;
+		chunk.pointcloud->points.assign(new_elements.begin(), new_elements.begin() + max_buffer_size_);
+		chunk.pointcloud->width = (uint32_t)max_buffer_size_;
+		chunk.pointcloud->height = 1;
+		chunk.pointcloud->is_dense = new_elements.is_dense;
+	}
+	chunk.chunk_to_buffer_transform.setIdentity();
+	updateChunkSearchMethod(chunk);
+
+	size_t number_of_new_points = chunk.pointcloud->size();
+	if (ring_start_ != 0 && pointcloud_->size() < max_buffer_size_) { compactPointCloud(); } // the max buffer size was increased while the ring was wrapped
+	if (number_of_points_ + number_of_new_points > max_buffer_size_) {
+		expireOldestPoints(number_of_points_ + number_of_new_points - max_buffer_size_);
+	}
+
+	// the new points are placed after the newest points, wrapping around to the slots of the expired points
+	size_t pointcloud_size = number_of_points_ + number_of_new_points;
+	if (pointcloud_->size() < pointcloud_size) { pointcloud_->resize(pointcloud_size); }
+	chunk.first_point_index = (ring_start_ + number_of_points_) % pointcloud_size;
+	size_t slot = chunk.first_point_index;
+	for (size_t i = 0; i < number_of_new_points; ++i) {
+		pointcloud_->points[slot] = chunk.pointcloud->points[i];
+		if (++slot == pointcloud_size) { slot = 0; }
+	}
+
+	chunks_.push_back(chunk);
+	number_of_points_ += number_of_new_points;
+}
+
+
+template<typename PointT>
+void ChunkedCircularBufferPointCloud<PointT>::eraseNewest(size_t count) {
+	if (count == 0 || chunks_.empty()) { return; }
+	updatePointCloud();
+	compactPointCloud(); // the newest points must be at the end of the point cloud
+
+	size_t number_of_points_to_erase = std::min(count, number_of_points_);
+	while (count > 0 && !chunks_.empty()) {
+		PointCloudChunk& chunk = chunks_.back();
+		if (chunk.pointcloud->size() <= count) {
+			count -= chunk.pointcloud->size();
+			chunks_.pop_back();
+		} else {
+			chunk.pointcloud->erase(chunk.pointcloud->end() - count, chunk.pointcloud->end());
+			updateChunkSearchMethod(chunk);
+			count = 0;
+		}
+	}
+
+	pointcloud_->erase(pointcloud_->end() - number_of_points_to_erase, pointcloud_->end());
+	number_of_points_ -= number_of_points_to_erase;
+}
+
+
+template<typename PointT>
+void ChunkedCircularBufferPointCloud<PointT>::eraseOldest(size_t count) {
+	if (count == 0 || chunks_.empty()) { return; }
+	updatePointCloud();
+	expireOldestPoints(count);
+	compactPointCloud(); // the free slots are only reused by insert
+}
+
+
+template<typename PointT>
+void ChunkedCircularBufferPointCloud<PointT>::applyTransform(const Eigen::Matrix4f& transform) {
+	for (size_t i = 0; i < chunks_.size(); ++i) {
+		chunks_[i].chunk_to_buffer_transform = transform * Eigen::Matrix4f(chunks_[i].chunk_to_buffer_transform);
+	}
+}
+
+
+template<typename PointT>
+void ChunkedCircularBufferPointCloud<PointT>::clear() {
+	chunks_.clear();
+	pointcloud_->clear();
+	number_of_points_ = 0;
+	ring_start_ = 0;
+}
+
+
+template<typename PointT>
+void ChunkedCircularBufferPointCloud<PointT>::shrinkToFit() {
+	updatePointCloud();
+	pointcloud_->points.shrink_to_fit();
+	for (size_t i = 0; i < chunks_.size(); ++i) {
+		chunks_[i].pointcloud->points.shrink_to_fit(); // the k-d trees have their own copy of the points coordinates
+	}
+}
+
+
+template<typename PointT>
+size_t ChunkedCircularBufferPointCloud<PointT>::accountMemoryUsage(MemoryUsage& memory_usage) const {
+	if (!memory_usage.addObject(this)) { return 0; }
+	size_t bytes = memory_usage.addBytes(sizeof(*this) + chunks_.size() * sizeof(PointCloudChunk)) + memory_usage.addPointCloud(pointcloud_.get());
+	for (size_t i = 0; i < chunks_.size(); ++i) {
+		bytes += memory_usage.addPointCloud(chunks_[i].pointcloud.get()) + memory_usage.addKdTree(chunks_[i].search_method.get());
+	}
+	return bytes;
+}
+
+
+template<typename PointT>
+typename pcl::search::KdTree<PointT>::Ptr ChunkedCircularBufferPointCloud<PointT>::getSearchMethod() {
+	typename ChunkedKdTreeSearch<PointT>::Ptr search_method(new ChunkedKdTreeSearch<PointT>());
+	for (size_t i = 0; i < chunks_.size(); ++i) {
+		const PointCloudChunk& chunk = chunks_[i];
+		size_t number_of_points_before_wrap = std::min(chunk.pointcloud->size(), pointcloud_->size() - chunk.first_point_index);
+		search_method->addChunk(chunk.search_method, Eigen::Matrix4f(chunk.chunk_to_buffer_transform), chunk.min_point, chunk.max_point, chunk.first_point_index, number_of_points_before_wrap);
+	}
+	search_method->setChunkedInputCloud(pointcloud_);
+	return search_method;
+}
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </ChunkedCircularBufferPointCloud-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// =============================================================================  </public-section>  ===========================================================================
+
+// =============================================================================   <protected-section>   =======================================================================
+template<typename PointT>
+void ChunkedCircularBufferPointCloud<PointT>::updatePointCloud() {
+	if (pointcloud_->size() == number_of_points_) { return; }
+
+	pointcloud_->clear();
+	pointcloud_->reserve(number_of_points_);
+	ring_start_ = 0;
+	for (size_t i = 0; i < chunks_.size(); ++i) {
+		chunks_[i].first_point_index = pointcloud_->size();
+		appendChunkToPointCloud(chunks_[i]);
+	}
+}
+
+
+template<typename PointT>
+void ChunkedCircularBufferPointCloud<PointT>::expireOldestPoints(size_t count) {
+	size_t pointcloud_size = pointcloud_->size();
+	size_t number_of_points_to_expire = std::min(count, number_of_points_);
+	count = number_of_points_to_expire;
+	while (count > 0 && !chunks_.empty()) {
+		PointCloudChunk& chunk = chunks_.front();
+		if (chunk.pointcloud->size() <= count) { // expired chunk
+			count -= chunk.pointcloud->size();
+			chunks_.pop_front();
+		} else { // chunk partially expired
+			chunk.pointcloud->erase(chunk.pointcloud->begin(), chunk.pointcloud->begin() + count);
+			chunk.first_point_index = (chunk.first_point_index + count) % pointcloud_size;
+			updateChunkSearchMethod(chunk);
+			count = 0;
+		}
+	}
+
+	if (pointcloud_size > 0) { ring_start_ = (ring_start_ + number_of_points_to_expire) % pointcloud_size; }
+	number_of_points_ -= number_of_points_to_expire;
+}
+
+
+template<typename PointT>
+void ChunkedCircularBufferPointCloud<PointT>::compactPointCloud() {
+	if (ring_start_ == 0 && pointcloud_->size() == number_of_points_) { return; }
+
+	if (ring_start_ != 0) { std::rotate(pointcloud_->points.begin(), pointcloud_->points.begin() + ring_start_, pointcloud_->points.end()); }
+	pointcloud_->resize(number_of_points_);
+	ring_start_ = 0;
+
+	size_t first_point_index = 0;
+	for (size_t i = 0; i < chunks_.size(); ++i) {
+		chunks_[i].first_point_index = first_point_index;
+		first_point_index += chunks_[i].pointcloud->size();
+	}
+}
+
+
+template<typename PointT>
+void ChunkedCircularBufferPointCloud<PointT>::updateChunkSearchMethod(PointCloudChunk& chunk) {
+	if (!chunk.search_method) {
+		chunk.search_method.reset(new pcl::search::KdTree<PointT>());
+	}
+	chunk.search_method->setInputCloud(chunk.pointcloud);
+
+	Eigen::Vector4f min_point, max_point;
+	pcl::getMinMax3D(*chunk.pointcloud, min_point, max_point);
+	chunk.min_point = min_point.head<3>();
+	chunk.max_point = max_point.head<3>();
+}
+
+
+template<typename PointT>
+void ChunkedCircularBufferPointCloud<PointT>::appendChunkToPointCloud(const PointCloudChunk& chunk) {
+	if (Eigen::Matrix4f(chunk.chunk_to_buffer_transform).isIdentity()) {
+		pointcloud_->insert(pointcloud_->end(), chunk.pointcloud->begin(), chunk.pointcloud->end());
+	} else {
+		pcl::PointCloud<PointT> chunk_in_buffer_coordinates;
+		pcl::transformPointCloudWithNormals(*chunk.pointcloud, chunk_in_buffer_coordinates, Eigen::Matrix4f(chunk.chunk_to_buffer_transform));
+		pointcloud_->insert(pointcloud_->end(), chunk_in_buffer_coordinates.begin(), chunk_in_buffer_coordinates.end());
+	}
+}
+// =============================================================================   </protected-section>  =======================================================================
+
+} /* namespace dynamic_robot_localization */
@@ -0,0 +1,186 @@
+/**\file chunked_kdtree_search.hpp
+ * \brief Description...
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+#include <dynamic_robot_localization/common/chunked_kdtree_search.h>
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+namespace dynamic_robot_localization {
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <imports>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </imports>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+// =============================================================================  <public-section>  ============================================================================
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <constructors-destructor>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+template<typename PointT>
+ChunkedKdTreeSearch<PointT>::ChunkedKdTreeSearch(bool sorted) :
+	pcl::search::KdTree<PointT>(sorted),
+	number_of_points_in_chunks_(0),
+	using_chunks_(false) {}
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </constructors-destructor>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <ChunkedKdTreeSearch-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+template<typename PointT>
+void ChunkedKdTreeSearch<PointT>::addChunk(const typename pcl::search::KdTree<PointT>::Ptr& chunk_search_method, const Eigen::Matrix4f& chunk_to_cloud_transform, const Eigen::Vector3f& min_point, const Eigen::Vector3f& max_point) {
+	if (!chunk_search_method || !chunk_search_method->getInputCloud()) { return; }
+	addChunk(chunk_search_method, chunk_to_cloud_transform, min_point, max_point, number_of_points_in_chunks_, chunk_search_method->getInputCloud()->size());
+}
+
+
+template<typename PointT>
+void ChunkedKdTreeSearch<PointT>::addChunk(const typename pcl::search::KdTree<PointT>::Ptr& chunk_search_method, const Eigen::Matrix4f& chunk_to_cloud_transform, const Eigen::Vector3f& min_point, const Eigen::Vector3f& max_point,
+		size_t first_point_index, size_t number_of_points_before_wrap) {
+	if (!chunk_search_method || !chunk_search_method->getInputCloud() || chunk_search_method->getInputCloud()->empty()) { return; }
+
+	Chunk chunk;
+	chunk.search_method = chunk_search_method;
+	chunk.first_point_index = first_point_index;
+	chunk.number_of_points = chunk_search_method->getInputCloud()->size();
+	chunk.number_of_points_before_wrap = std::min(number_of_points_before_wrap, chunk.number_of_points);
+	chunk.cloud_to_chunk_rotation = chunk_to_cloud_transform.block<3, 3>(0, 0).transpose();
+	chunk.cloud_to_chunk_translation = -(chunk.cloud_to_chunk_rotation * chunk_to_cloud_transform.block<3, 1>(0, 3));
+	chunk.min_point = min_point;
+	chunk.max_point = max_point;
+	chunks_.push_back(chunk);
+	number_of_points_in_chunks_ += chunk.number_of_points;
+	using_chunks_ = false;
+}
+
+
+template<typename PointT>
+void ChunkedKdTreeSearch<PointT>::setChunkedInputCloud(const PointCloudConstPtr& cloud) {
+	if (cloud && !chunks_.empty() && cloud->size() == number_of_points_in_chunks_) {
+		this->input_ = cloud;
+		this->indices_.reset();
+		using_chunks_ = true;
+	} else {
+		setInputCloud(cloud);
+	}
+}
+
+
+template<typename PointT>
+void ChunkedKdTreeSearch<PointT>::setInputCloud(const PointCloudConstPtr& cloud, const IndicesConstPtr& indices) {
+	if (using_chunks_ && cloud == this->input_ && !indices && cloud->size() == number_of_points_in_chunks_) { return; }
+	using_chunks_ = false;
+	pcl::search::KdTree<PointT>::setInputCloud(cloud, indices);
+}
+
+
+template<typename PointT>
+int ChunkedKdTreeSearch<PointT>::nearestKSearch(const PointT& point, int k, std::vector<int>& k_indices, std::vector<float>& k_sqr_distances) const {
+	if (!using_chunks_) { return pcl::search::KdTree<PointT>::nearestKSearch(point, k, k_indices, k_sqr_distances); }
+
+	k_indices.clear();
+	k_sqr_distances.clear();
+	if (k <= 0 || !pcl::isFinite(point)) { return 0; }
+
+	SearchBuffers& search_buffers = s_getSearchBuffers();
+	std::vector< std::pair<float, size_t> >& chunks_by_distance = search_buffers.chunks_by_distance;
+	std::vector< std::pair<float, int> >& neighbors = search_buffers.neighbors;
+	std::vector<int>& chunk_indices = search_buffers.chunk_indices;
+	std::vector<float>& chunk_sqr_distances = search_buffers.chunk_sqr_distances;
+	chunks_by_distance.clear();
+	neighbors.clear();
+
+	// closest chunks first, in order to skip the chunks whose bounding box is farther than the k neighbors already found
+	for (size_t i = 0; i < chunks_.size(); ++i) {
+		chunks_by_distance.push_back(std::pair<float, size_t>(computeSquaredDistanceToChunk(transformPointToChunk(point, chunks_[i]), chunks_[i]), i));
+	}
+	std::sort(chunks_by_distance.begin(), chunks_by_distance.end());
+
+	for (size_t i = 0; i < chunks_by_distance.size(); ++i) {
+		if (neighbors.size() >= (size_t)k && chunks_by_distance[i].first > neighbors[k - 1].first) { break; }
+
+		const Chunk& chunk = chunks_[chunks_by_distance[i].second];
+		int number_of_chunk_neighbors = chunk.search_method->nearestKSearch(transformPointToChunk(point, chunk), k, chunk_indices, chunk_sqr_distances);
+		for (int j = 0; j < number_of_chunk_neighbors; ++j) {
+			neighbors.push_back(std::pair<float, int>(chunk_sqr_distances[j], convertChunkIndexToCloudIndex(chunk_indices[j], chunk)));
+		}
+
+		if (neighbors.size() >= (size_t)k) {
+			std::nth_element(neighbors.begin(), neighbors.begin() + (k - 1), neighbors.end());
+			neighbors.resize(k);
+			std::swap(*std::max_element(neighbors.begin(), neighbors.end()), neighbors.back());
+		}
+	}
+
+	size_t number_of_neighbors = std::min(neighbors.size(), (size_t)k);
+	std::partial_sort(neighbors.begin(), neighbors.begin() + number_of_neighbors, neighbors.end());
+
+	k_indices.resize(number_of_neighbors);
+	k_sqr_distances.resize(number_of_neighbors);
+	for (size_t i = 0; i < number_of_neighbors; ++i) {
+		k_sqr_distances[i] = neighbors[i].first;
+		k_indices[i] = neighbors[i].second;
+	}
+
+	return (int)number_of_neighbors;
+}
+
+
+template<typename PointT>
+int ChunkedKdTreeSearch<PointT>::radiusSearch(const PointT& point, double radius, std::vector<int>& k_indices, std::vector<float>& k_sqr_distances, unsigned int max_nn) const {
+	if (!using_chunks_) { return pcl::search::KdTree<PointT>::radiusSearch(point, radius, k_indices, k_sqr_distances, max_nn); }
+
+	k_indices.clear();
+	k_sqr_distances.clear();
+	if (radius <= 0.0 || !pcl::isFinite(point)) { return 0; }
+
+	SearchBuffers& search_buffers = s_getSearchBuffers();
+	std::vector< std::pair<float, int> >& neighbors = search_buffers.neighbors;
+	std::vector<int>& chunk_indices = search_buffers.chunk_indices;
+	std::vector<float>& chunk_sqr_distances = search_buffers.chunk_sqr_distances;
+	neighbors.clear();
+
+	float sqr_radius = (float)(radius * radius);
+	for (size_t i = 0; i < chunks_.size(); ++i) {
+		const Chunk& chunk = chunks_[i];
+		PointT chunk_point = transformPointToChunk(point, chunk);
+		if (computeSquaredDistanceToChunk(chunk_point, chunk) > sqr_radius) { continue; }
+
+		int number_of_chunk_neighbors = chunk.search_method->radiusSearch(chunk_point, radius, chunk_indices, chunk_sqr_distances, max_nn);
+		for (int j = 0; j < number_of_chunk_neighbors; ++j) {
+			neighbors.push_back(std::pair<float, int>(chunk_sqr_distances[j], convertChunkIndexToCloudIndex(chunk_indices[j], chunk)));
+		}
+	}
+
+	size_t number_of_neighbors = neighbors.size();
+	if (max_nn > 0 && number_of_neighbors > max_nn) {
+		number_of_neighbors = max_nn;
+		std::partial_sort(neighbors.begin(), neighbors.begin() + number_of_neighbors, neighbors.end());
+	} else if (this->sorted_results_) {
+		std::sort(neighbors.begin(), neighbors.end());
+	}
+
+	k_indices.resize(number_of_neighbors);
+	k_sqr_distances.resize(number_of_neighbors);
+	for (size_t i = 0; i < number_of_neighbors; ++i) {
+		k_sqr_distances[i] = neighbors[i].first;
+		k_indices[i] = neighbors[i].second;
+	}
+
+	return (int)number_of_neighbors;
+}
+
+
+template<typename PointT>
+void ChunkedKdTreeSearch<PointT>::clearChunks() {
+	chunks_.clear();
+	number_of_points_in_chunks_ = 0;
+	if (using_chunks_) {
+		this->input_.reset();
+		using_chunks_ = false;
+	}
+}
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </ChunkedKdTreeSearch-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// =============================================================================  </public-section>  ===========================================================================
+
+// =============================================================================   <protected-section>   =======================================================================
+// =============================================================================   </protected-section>  =======================================================================
+
+} /* namespace dynamic_robot_localization */
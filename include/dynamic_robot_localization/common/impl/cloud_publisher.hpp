@@ -43,23 +43,49 @@ void CloudPublisher<PointT>::setupConfigurationFromParameterServer(ros::NodeHand
 
 template<typename PointT>
 void CloudPublisher<PointT>::publishPointCloud(const pcl::PointCloud<PointT>& cloud) {
-	if (!cloud_publisher_.getTopic().empty()) {
-		if (publish_pointclouds_only_if_there_is_subscribers_ && cloud_publisher_.getNumSubscribers() == 0) {
-			ROS_DEBUG_STREAM("Avoiding publishing pointcloud on topic " << cloud_publisher_.getTopic() << " because there is no subscribers");
-			return;
-		}
+	if (!isPublishingPointClouds()) {
+		if (!cloud_publisher_.getTopic().empty()) { ROS_DEBUG_STREAM("Avoiding publishing pointcloud on topic " << cloud_publisher_.getTopic() << " because there is no subscribers"); }
+		return;
+	}
 
-		sensor_msgs::PointCloud2Ptr cloud_msg(new sensor_msgs::PointCloud2());
-		pcl::toROSMsg(cloud, *cloud_msg);
+	if (AsyncCloudPublisher::getInstance().isRunning()) {
+		publishPointCloud(typename pcl::PointCloud<PointT>::ConstPtr(new pcl::PointCloud<PointT>(cloud)));
+	} else {
+		cloud_publisher_.publish(s_createPointCloudMsg(cloud, cloud_publish_frame_, override_cloud_stamp_, cloud_publish_stamp_));
+	}
+}
 
-		if (!cloud_publish_frame_.empty())
-			cloud_msg->header.frame_id = cloud_publish_frame_;
 
-		if (override_cloud_stamp_)
-			cloud_msg->header.stamp = pcl_conversions::fromPCL(cloud_publish_stamp_);
+template<typename PointT>
+void CloudPublisher<PointT>::publishPointCloud(const typename pcl::PointCloud<PointT>::ConstPtr& cloud) {
+	if (!cloud) { return; }
 
-		cloud_publisher_.publish(cloud_msg);
+	if (!isPublishingPointClouds()) {
+		if (!cloud_publisher_.getTopic().empty()) { ROS_DEBUG_STREAM("Avoiding publishing pointcloud on topic " << cloud_publisher_.getTopic() << " because there is no subscribers"); }
+		return;
 	}
+
+	std::string cloud_publish_frame = cloud_publish_frame_;
+	bool override_cloud_stamp = override_cloud_stamp_;
+	std::uint64_t cloud_publish_stamp = cloud_publish_stamp_;
+	AsyncCloudPublisher::getInstance().publish(cloud_publisher_, [cloud, cloud_publish_frame, override_cloud_stamp, cloud_publish_stamp]() {
+		return CloudPublisher<PointT>::s_createPointCloudMsg(*cloud, cloud_publish_frame, override_cloud_stamp, cloud_publish_stamp);
+	}, cloud->size() * sizeof(PointT));
+}
+
+
+template<typename PointT>
+sensor_msgs::PointCloud2Ptr CloudPublisher<PointT>::s_createPointCloudMsg(const pcl::PointCloud<PointT>& cloud, const std::string& cloud_publish_frame, bool override_cloud_stamp, std::uint64_t cloud_publish_stamp) {
+	sensor_msgs::PointCloud2Ptr cloud_msg(new sensor_msgs::PointCloud2());
+	pcl::toROSMsg(cloud, *cloud_msg);
+
+	if (!cloud_publish_frame.empty())
+		cloud_msg->header.frame_id = cloud_publish_frame;
+
+	if (override_cloud_stamp)
+		cloud_msg->header.stamp = pcl_conversions::fromPCL(cloud_publish_stamp);
+
+	return cloud_msg;
 }
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </CloudPublisher-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 // =============================================================================  </public-section>  ===========================================================================
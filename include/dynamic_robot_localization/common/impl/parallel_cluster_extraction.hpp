@@ -0,0 +1,164 @@
+/**\file parallel_cluster_extraction.hpp
+ * \brief Description...
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+#include <dynamic_robot_localization/common/parallel_cluster_extraction.h>
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+namespace dynamic_robot_localization {
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <imports>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </imports>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+// =============================================================================  <public-section>  ============================================================================
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <constructors-destructor>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+template<typename PointT>
+ParallelClusterExtraction<PointT>::ParallelClusterExtraction() :
+	search_radius_(0.02),
+	number_of_neighbors_(0),
+	min_cluster_size_(1),
+	max_cluster_size_(std::numeric_limits<int>::max()),
+	number_of_threads_(0),
+	parents_capacity_(0) {}
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </constructors-destructor>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <ParallelClusterExtraction-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+template<typename PointT>
+void ParallelClusterExtraction<PointT>::extract(const typename pcl::PointCloud<PointT>::Ptr& pointcloud, const pcl::IndicesPtr& indices, const typename pcl::search::KdTree<PointT>::Ptr& search_method,
+		std::vector<pcl::PointIndices>& clusters_out) {
+	clusters_out.clear();
+	if (!pointcloud || !search_method) { return; }
+
+	const int pointcloud_size = (int)pointcloud->size();
+	const int number_of_points = indices ? (int)indices->size() : pointcloud_size;
+	if (number_of_points == 0) { return; }
+
+	if (indices) {
+		points_local_indices_.assign(pointcloud_size, -1);
+		for (int i = 0; i < number_of_points; ++i) {
+			points_local_indices_[(*indices)[i]] = i;
+		}
+	}
+
+	if (parents_capacity_ < (size_t)number_of_points) {
+		parents_.reset(new std::atomic<int>[number_of_points]);
+		parents_capacity_ = number_of_points;
+	}
+	seed_points_.resize(number_of_points);
+	attached_points_.resize(number_of_points);
+
+	int number_of_threads = 1;
+#ifdef _OPENMP
+	number_of_threads = (number_of_threads_ > 0) ? number_of_threads_ : omp_get_max_threads();
+#endif
+	threads_search_buffers_.resize(number_of_threads);
+
+	#pragma omp parallel for schedule(static) num_threads(number_of_threads)
+	for (int i = 0; i < number_of_points; ++i) {
+		const PointT& point = pointcloud->points[indices ? (*indices)[i] : i];
+		parents_[i].store(i, std::memory_order_relaxed);
+		attached_points_[i] = -1;
+		seed_points_[i] = (pcl::isFinite(point) && (!seed_predicate_ || seed_predicate_(point))) ? 1 : 0;
+	}
+
+	#pragma omp parallel for schedule(dynamic, 256) num_threads(number_of_threads)
+	for (int i = 0; i < number_of_points; ++i) {
+		const PointT& point = pointcloud->points[indices ? (*indices)[i] : i];
+		if (!pcl::isFinite(point)) { continue; }
+
+#ifdef _OPENMP
+		SearchBuffers& search_buffers = threads_search_buffers_[omp_get_thread_num()];
+#else
+		SearchBuffers& search_buffers = threads_search_buffers_[0];
+#endif
+		int number_of_neighbors_found = searchNeighbors(point, search_buffers, search_method);
+
+		for (int n = 0; n < number_of_neighbors_found; ++n) {
+			int neighbor_cloud_index = search_buffers.search_indices[n];
+			if (neighbor_cloud_index < 0 || neighbor_cloud_index >= pointcloud_size) { continue; } // the search method may index a cloud with more points than pointcloud
+			int neighbor_local_index = indices ? points_local_indices_[neighbor_cloud_index] : neighbor_cloud_index;
+			if (neighbor_local_index < 0 || neighbor_local_index == i || !seed_points_[neighbor_local_index]) { continue; }
+
+			const PointT& neighbor_point = pointcloud->points[neighbor_cloud_index];
+			if (seed_points_[i]) {
+				if ((!neighbor_predicate_ || neighbor_predicate_(point, neighbor_point)) && (!propagation_predicate_ || propagation_predicate_(point, neighbor_point))) {
+					mergeSets(i, neighbor_local_index);
+				}
+			} else if (!neighbor_predicate_ || neighbor_predicate_(neighbor_point, point)) {
+				attached_points_[i] = neighbor_local_index; // neighbors are sorted by distance
+				break;
+			}
+		}
+	}
+
+	roots_clusters_.assign(number_of_points, -1);
+	for (int i = 0; i < number_of_points; ++i) {
+		if (!seed_points_[i] && attached_points_[i] < 0) { continue; }
+		int root = findRoot(seed_points_[i] ? i : attached_points_[i]);
+		if (roots_clusters_[root] < 0) {
+			roots_clusters_[root] = (int)clusters_out.size();
+			clusters_out.push_back(pcl::PointIndices());
+		}
+		clusters_out[roots_clusters_[root]].indices.push_back(indices ? (*indices)[i] : i);
+	}
+
+	clusters_out.erase(std::remove_if(clusters_out.begin(), clusters_out.end(), [&](const pcl::PointIndices& cluster) {
+		return cluster.indices.size() < min_cluster_size_ || cluster.indices.size() > max_cluster_size_; }), clusters_out.end());
+
+	for (size_t i = 0; i < clusters_out.size(); ++i) {
+		clusters_out[i].header = pointcloud->header;
+		if (indices) { std::sort(clusters_out[i].indices.begin(), clusters_out[i].indices.end()); }
+	}
+
+	std::stable_sort(clusters_out.begin(), clusters_out.end(), [](const pcl::PointIndices& first_cluster, const pcl::PointIndices& second_cluster) {
+		return first_cluster.indices.size() > second_cluster.indices.size(); });
+}
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </ParallelClusterExtraction-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// =============================================================================  </public-section>  ===========================================================================
+
+// =============================================================================   <protected-section>   =======================================================================
+template<typename PointT>
+int ParallelClusterExtraction<PointT>::findRoot(int element) {
+	while (true) {
+		int parent = parents_[element].load(std::memory_order_relaxed);
+		if (parent == element) { return element; }
+		int grandparent = parents_[parent].load(std::memory_order_relaxed);
+		if (grandparent != parent) { // path halving (parents only move closer to the root, so a failed exchange can be ignored)
+			parents_[element].compare_exchange_weak(parent, grandparent, std::memory_order_relaxed);
+		}
+		element = grandparent;
+	}
+}
+
+
+template<typename PointT>
+void ParallelClusterExtraction<PointT>::mergeSets(int first_element, int second_element) {
+	while (true) {
+		first_element = findRoot(first_element);
+		second_element = findRoot(second_element);
+		if (first_element == second_element) { return; }
+		if (first_element < second_element) { std::swap(first_element, second_element); }
+
+		// the root with the higher index is linked to the lower one, which keeps the trees acyclic without locks
+		int expected_parent = first_element;
+		if (parents_[first_element].compare_exchange_strong(expected_parent, second_element, std::memory_order_acq_rel)) { return; }
+	}
+}
+
+
+template<typename PointT>
+int ParallelClusterExtraction<PointT>::searchNeighbors(const PointT& point, SearchBuffers& search_buffers, const typename pcl::search::KdTree<PointT>::Ptr& search_method) {
+	if (search_radius_ > 0.0) {
+		return search_method->radiusSearch(point, search_radius_, search_buffers.search_indices, search_buffers.search_sqr_distances, (number_of_neighbors_ > 0) ? (unsigned int)number_of_neighbors_ : 0);
+	} else if (number_of_neighbors_ > 0) {
+		return search_method->nearestKSearch(point, number_of_neighbors_, search_buffers.search_indices, search_buffers.search_sqr_distances);
+	}
+	return 0;
+}
+// =============================================================================   </protected-section>  =======================================================================
+
+} /* namespace dynamic_robot_localization */
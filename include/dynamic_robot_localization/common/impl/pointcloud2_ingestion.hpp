@@ -0,0 +1,191 @@
+/**\file pointcloud2_ingestion.hpp
+ * \brief Description...
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+#include <dynamic_robot_localization/common/pointcloud2_ingestion.h>
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+namespace dynamic_robot_localization {
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <imports>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </imports>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+// =============================================================================  <public-section>  ============================================================================
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <constructors-destructor>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+template<typename PointT>
+PointCloud2Ingestion<PointT>::PointCloud2Ingestion(size_t pool_size) :
+	direct_decoding_enabled_(true),
+	crop_box_enabled_(false),
+	crop_box_min_(-10.0f, -10.0f, -10.0f),
+	crop_box_max_(10.0f, 10.0f, 10.0f),
+	crop_box_invert_selection_(false),
+	voxel_grid_leaf_size_(0.0f),
+	inverse_voxel_grid_leaf_size_(0.0f),
+	pool_size_(pool_size),
+	field_mapping_point_step_(0),
+	field_mapping_has_xyz_(false),
+	offset_x_(0),
+	offset_y_(0),
+	offset_z_(0),
+	number_of_points_in_last_msg_(0),
+	number_of_points_in_last_pointcloud_(0) {}
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </constructors-destructor>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <PointCloud2Ingestion-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+template<typename PointT>
+void PointCloud2Ingestion<PointT>::setupConfigurationFromParameterServer(ros::NodeHandlePtr& private_node_handle, const std::string& configuration_namespace) {
+	private_node_handle->param(configuration_namespace + "direct_decoding", direct_decoding_enabled_, true);
+
+	private_node_handle->param(configuration_namespace + "crop_box/enabled", crop_box_enabled_, false);
+	double box_min_x, box_min_y, box_min_z, box_max_x, box_max_y, box_max_z;
+	private_node_handle->param(configuration_namespace + "crop_box/box_min_x", box_min_x, -10.0);
+	private_node_handle->param(configuration_namespace + "crop_box/box_min_y", box_min_y, -10.0);
+	private_node_handle->param(configuration_namespace + "crop_box/box_min_z", box_min_z, -10.0);
+	private_node_handle->param(configuration_namespace + "crop_box/box_max_x", box_max_x, 10.0);
+	private_node_handle->param(configuration_namespace + "crop_box/box_max_y", box_max_y, 10.0);
+	private_node_handle->param(configuration_namespace + "crop_box/box_max_z", box_max_z, 10.0);
+	private_node_handle->param(configuration_namespace + "crop_box/invert_selection", crop_box_invert_selection_, false);
+	crop_box_min_ = Eigen::Vector3f((float)box_min_x, (float)box_min_y, (float)box_min_z);
+	crop_box_max_ = Eigen::Vector3f((float)box_max_x, (float)box_max_y, (float)box_max_z);
+
+	double voxel_grid_leaf_size;
+	private_node_handle->param(configuration_namespace + "voxel_grid_leaf_size", voxel_grid_leaf_size, 0.0);
+	setVoxelGridLeafSize((float)voxel_grid_leaf_size);
+
+	int pool_size;
+	private_node_handle->param(configuration_namespace + "pool_size", pool_size, 4);
+	setPoolSize((size_t)std::max(pool_size, 0));
+}
+
+
+template<typename PointT>
+typename pcl::PointCloud<PointT>::Ptr PointCloud2Ingestion<PointT>::ingest(const sensor_msgs::PointCloud2& pointcloud_msg) {
+	typename pcl::PointCloud<PointT>::Ptr pointcloud = getPointCloudFromPool();
+	number_of_points_in_last_msg_ = (size_t)pointcloud_msg.width * (size_t)pointcloud_msg.height;
+	bool msg_data_complete = (pointcloud_msg.height == 0 || pointcloud_msg.data.size() >= (size_t)(pointcloud_msg.height - 1) * pointcloud_msg.row_step + (size_t)pointcloud_msg.width * pointcloud_msg.point_step);
+
+	if (!direct_decoding_enabled_ || !msg_data_complete || !updateFieldMapping(pointcloud_msg)) {
+		pcl::fromROSMsg(pointcloud_msg, *pointcloud);
+		pointcloud->is_dense = false;
+		std::vector<int> indexes;
+		pcl::removeNaNFromPointCloud(*pointcloud, *pointcloud, indexes);
+		number_of_points_in_last_pointcloud_ = pointcloud->size();
+		return pointcloud;
+	}
+
+	pcl_conversions::toPCL(pointcloud_msg.header, pointcloud->header);
+	pointcloud->sensor_origin_ = Eigen::Vector4f(0.0f, 0.0f, 0.0f, 0.0f);
+	pointcloud->sensor_orientation_ = Eigen::Quaternionf::Identity();
+	pointcloud->points.clear();
+	pointcloud->points.reserve(number_of_points_in_last_msg_);
+
+	bool voxel_grid_enabled = (voxel_grid_leaf_size_ > 0.0f);
+	if (voxel_grid_enabled) { occupied_voxels_.clear(); }
+
+	const std::uint8_t* msg_row = pointcloud_msg.data.data();
+	for (std::uint32_t row = 0; row < pointcloud_msg.height; ++row, msg_row += pointcloud_msg.row_step) {
+		const std::uint8_t* msg_point = msg_row;
+		for (std::uint32_t column = 0; column < pointcloud_msg.width; ++column, msg_point += pointcloud_msg.point_step) {
+			float x, y, z;
+			std::memcpy(&x, msg_point + offset_x_, sizeof(float));
+			std::memcpy(&y, msg_point + offset_y_, sizeof(float));
+			std::memcpy(&z, msg_point + offset_z_, sizeof(float));
+
+			if (!std::isfinite(x) || !std::isfinite(y) || !std::isfinite(z)) { continue; }
+
+			if (crop_box_enabled_) {
+				bool inside_box = (x >= crop_box_min_(0) && x <= crop_box_max_(0) && y >= crop_box_min_(1) && y <= crop_box_max_(1) && z >= crop_box_min_(2) && z <= crop_box_max_(2));
+				if (inside_box == crop_box_invert_selection_) { continue; }
+			}
+
+			if (voxel_grid_enabled && !occupied_voxels_.insert(computeVoxelKey(x, y, z)).second) { continue; }
+
+			pointcloud->points.push_back(PointT());
+			std::uint8_t* cloud_point = reinterpret_cast<std::uint8_t*>(&pointcloud->points.back());
+			for (size_t i = 0; i < field_mapping_.size(); ++i) {
+				std::memcpy(cloud_point + field_mapping_[i].struct_offset, msg_point + field_mapping_[i].serialized_offset, field_mapping_[i].size);
+			}
+		}
+	}
+
+	pointcloud->width = (std::uint32_t)pointcloud->points.size();
+	pointcloud->height = 1;
+	pointcloud->is_dense = true;
+	number_of_points_in_last_pointcloud_ = pointcloud->size();
+	return pointcloud;
+}
+
+
+template<typename PointT>
+size_t PointCloud2Ingestion<PointT>::accountMemoryUsage(MemoryUsage& memory_usage) const {
+	if (!memory_usage.addObject(this)) { return 0; }
+	size_t bytes = memory_usage.addBytes(sizeof(*this) + MemoryUsage::s_getHashContainerBytes(occupied_voxels_));
+	for (size_t i = 0; i < pointclouds_pool_.size(); ++i) {
+		bytes += memory_usage.addPointCloud(pointclouds_pool_[i].get());
+	}
+	return bytes;
+}
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </PointCloud2Ingestion-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// =============================================================================  </public-section>  ===========================================================================
+
+// =============================================================================   <protected-section>   =======================================================================
+template<typename PointT>
+bool PointCloud2Ingestion<PointT>::updateFieldMapping(const sensor_msgs::PointCloud2& pointcloud_msg) {
+	bool same_layout = (pointcloud_msg.point_step == field_mapping_point_step_ && pointcloud_msg.fields.size() == field_mapping_msg_fields_.size());
+	for (size_t i = 0; same_layout && i < pointcloud_msg.fields.size(); ++i) {
+		const sensor_msgs::PointField& field = pointcloud_msg.fields[i];
+		const sensor_msgs::PointField& mapped_field = field_mapping_msg_fields_[i];
+		same_layout = (field.name == mapped_field.name && field.offset == mapped_field.offset && field.datatype == mapped_field.datatype && field.count == mapped_field.count);
+	}
+
+	if (same_layout) { return field_mapping_has_xyz_; }
+
+	field_mapping_msg_fields_ = pointcloud_msg.fields;
+	field_mapping_point_step_ = pointcloud_msg.point_step;
+	field_mapping_has_xyz_ = false;
+	field_mapping_.clear();
+
+	int number_of_xyz_fields = 0;
+	for (size_t i = 0; i < pointcloud_msg.fields.size(); ++i) {
+		const sensor_msgs::PointField& field = pointcloud_msg.fields[i];
+		if (field.datatype != sensor_msgs::PointField::FLOAT32 || field.offset + sizeof(float) > pointcloud_msg.point_step) { continue; }
+		if (field.name == "x") { offset_x_ = field.offset; ++number_of_xyz_fields; }
+		else if (field.name == "y") { offset_y_ = field.offset; ++number_of_xyz_fields; }
+		else if (field.name == "z") { offset_z_ = field.offset; ++number_of_xyz_fields; }
+	}
+
+	if (number_of_xyz_fields != 3) {
+		ROS_WARN_STREAM("Point cloud messages without float32 xyz fields will be converted with pcl::fromROSMsg");
+		return false;
+	}
+
+	std::vector<pcl::PCLPointField> pcl_fields;
+	pcl_conversions::toPCL(pointcloud_msg.fields, pcl_fields);
+	pcl::createMapping<PointT>(pcl_fields, field_mapping_);
+	field_mapping_has_xyz_ = true;
+	return true;
+}
+
+
+template<typename PointT>
+typename pcl::PointCloud<PointT>::Ptr PointCloud2Ingestion<PointT>::getPointCloudFromPool() {
+	for (size_t i = 0; i < pointclouds_pool_.size(); ++i) {
+		if (pointclouds_pool_[i].use_count() == 1) {
+			return pointclouds_pool_[i];
+		}
+	}
+
+	typename pcl::PointCloud<PointT>::Ptr pointcloud(new pcl::PointCloud<PointT>());
+	if (pointclouds_pool_.size() < pool_size_) {
+		pointclouds_pool_.push_back(pointcloud);
+	}
+	return pointcloud;
+}
+// =============================================================================   </protected-section>  =======================================================================
+
+} /* namespace dynamic_robot_localization */
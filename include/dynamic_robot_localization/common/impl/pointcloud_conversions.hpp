@@ -80,6 +80,26 @@ bool publishPointCloud(pcl::PointCloud<PointT>& pointcloud, ros::Publisher& publ
 }
 
 
+template <typename PointT>
+bool publishPointCloudAsynchronously(const typename pcl::PointCloud<PointT>::ConstPtr& pointcloud, const ros::Publisher& publisher, const std::string& frame_id, bool publish_pointcloud_only_if_there_is_subscribers, const std::string& point_cloud_name_for_logging) {
+	if (!pointcloud || publisher.getTopic().empty()) { return false; }
+
+	if (!AsyncCloudPublisher::s_isPublishing(publisher, publish_pointcloud_only_if_there_is_subscribers)) {
+		ROS_DEBUG_STREAM("Avoiding publishing " << point_cloud_name_for_logging << " on topic " << publisher.getTopic() << " because there is no subscribers");
+		return false;
+	}
+
+	ROS_DEBUG_STREAM("Publishing " << point_cloud_name_for_logging << " with " << pointcloud->size() << " points");
+	AsyncCloudPublisher::getInstance().publish(publisher, [pointcloud, frame_id]() {
+		sensor_msgs::PointCloud2Ptr pointcloud_msg(new sensor_msgs::PointCloud2());
+		pcl::toROSMsg(*pointcloud, *pointcloud_msg);
+		pointcloud_msg->header.frame_id = frame_id;
+		return pointcloud_msg;
+	}, pointcloud->size() * sizeof(PointT));
+	return true;
+}
+
+
 template<typename PointT>
 size_t flipPointCloudNormalsUsingOccpancyGrid(const nav_msgs::OccupancyGrid& occupancy_grid, pcl::PointCloud<PointT>& pointcloud, int search_k, float search_radius, bool show_occupancy_grid_pointcloud) {
 	if (search_k <= 0 && search_radius <= 0) { return 0; }
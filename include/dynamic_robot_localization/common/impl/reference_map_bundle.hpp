@@ -0,0 +1,172 @@
+/**\file reference_map_bundle.hpp
+ * \brief Description...
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+#include <dynamic_robot_localization/common/reference_map_bundle.h>
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+namespace dynamic_robot_localization {
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <imports>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </imports>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+// =============================================================================  <public-section>  ============================================================================
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <ReferenceMapBundle-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+template<typename PointT>
+std::uint64_t ReferenceMapBundle<PointT>::s_computeHash(const void* data, size_t size_in_bytes, std::uint64_t seed) {
+	// FNV-1a applied to 64 bit words (the byte wise version is too slow for maps with several GB)
+	const std::uint64_t fnv_prime = 1099511628211ULL;
+	const char* bytes = static_cast<const char*>(data);
+	std::uint64_t hash = seed;
+	size_t number_of_words = size_in_bytes / sizeof(std::uint64_t);
+	for (size_t i = 0; i < number_of_words; ++i) {
+		std::uint64_t word;
+		std::memcpy(&word, bytes + i * sizeof(std::uint64_t), sizeof(std::uint64_t));
+		hash = (hash ^ word) * fnv_prime;
+	}
+
+	for (size_t i = number_of_words * sizeof(std::uint64_t); i < size_in_bytes; ++i) {
+		hash = (hash ^ (std::uint64_t)(unsigned char)bytes[i]) * fnv_prime;
+	}
+
+	return (hash ^ (std::uint64_t)size_in_bytes) * fnv_prime;
+}
+
+
+template<typename PointT>
+bool ReferenceMapBundle<PointT>::s_computeFileHash(const std::string& filename, std::uint64_t& hash) {
+	int file_descriptor = open(filename.c_str(), O_RDONLY);
+	if (file_descriptor < 0) { return false; }
+
+	struct stat file_status;
+	if (fstat(file_descriptor, &file_status) != 0) {
+		close(file_descriptor);
+		return false;
+	}
+
+	size_t file_size = (size_t)file_status.st_size;
+	if (file_size == 0) {
+		close(file_descriptor);
+		hash = s_computeHash(nullptr, 0);
+		return true;
+	}
+
+	void* file_data = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+	close(file_descriptor);
+	if (file_data == MAP_FAILED) { return false; }
+	madvise(file_data, file_size, MADV_SEQUENTIAL);
+	hash = s_computeHash(file_data, file_size);
+	munmap(file_data, file_size);
+	return true;
+}
+
+
+template<typename PointT>
+bool ReferenceMapBundle<PointT>::s_save(const std::string& filename, std::uint64_t source_hash, std::uint64_t configuration_hash, const pcl::PointCloud<PointT>& pointcloud, const pcl::PointCloud<PointT>& keypoints) {
+	if (filename.empty()) { return false; }
+
+	BundleHeader header;
+	std::memset(&header, 0, sizeof(BundleHeader));
+	s_fillMagic(header.magic);
+	header.format_version = s_format_version;
+	header.point_size = (std::uint32_t)sizeof(PointT);
+	header.source_hash = source_hash;
+	header.configuration_hash = configuration_hash;
+	header.number_of_points = pointcloud.size();
+	header.points_offset = s_computeAlignedOffset(sizeof(BundleHeader));
+	header.number_of_keypoints = keypoints.size();
+	header.keypoints_offset = s_computeAlignedOffset(header.points_offset + header.number_of_points * sizeof(PointT));
+	header.file_size = header.keypoints_offset + header.number_of_keypoints * sizeof(PointT);
+
+	// written to a temporary file and then renamed to avoid leaving a truncated bundle if the node is killed while saving
+	std::string temporary_filename = filename + ".tmp";
+	{
+		std::ofstream file(temporary_filename.c_str(), std::ios::binary | std::ios::trunc);
+		if (!file.is_open()) { return false; }
+		file.write(reinterpret_cast<const char*>(&header), sizeof(BundleHeader));
+		if (!s_writeSection(file, pointcloud, header.points_offset) || !s_writeSection(file, keypoints, header.keypoints_offset)) {
+			file.close();
+			std::remove(temporary_filename.c_str());
+			return false;
+		}
+	}
+
+	if (std::rename(temporary_filename.c_str(), filename.c_str()) != 0) {
+		std::remove(temporary_filename.c_str());
+		return false;
+	}
+
+	return true;
+}
+
+
+template<typename PointT>
+bool ReferenceMapBundle<PointT>::s_load(const std::string& filename, std::uint64_t source_hash, std::uint64_t configuration_hash, pcl::PointCloud<PointT>& pointcloud, pcl::PointCloud<PointT>& keypoints) {
+	std::ifstream file(filename.c_str(), std::ios::binary | std::ios::ate);
+	if (!file.is_open()) { return false; }
+
+	std::uint64_t file_size = (std::uint64_t)file.tellg();
+	if (file_size < sizeof(BundleHeader)) { return false; }
+
+	BundleHeader header;
+	file.seekg(0);
+	if (!file.read(reinterpret_cast<char*>(&header), sizeof(BundleHeader))) { return false; }
+
+	char expected_magic[8];
+	s_fillMagic(expected_magic);
+	bool valid_bundle = true;
+	if (std::memcmp(header.magic, expected_magic, 8) != 0 || header.format_version != s_format_version || header.point_size != sizeof(PointT) || header.file_size != file_size) {
+		ROS_WARN_STREAM("Reference map bundle " << filename << " has an incompatible format and will be ignored");
+		valid_bundle = false;
+	} else if (header.source_hash != source_hash || header.configuration_hash != configuration_hash) {
+		ROS_INFO_STREAM("Reference map bundle " << filename << " is outdated (the map file or the reference point cloud preprocessing configuration changed)");
+		valid_bundle = false;
+	} else if (header.points_offset + header.number_of_points * sizeof(PointT) > file_size || header.keypoints_offset + header.number_of_keypoints * sizeof(PointT) > file_size) {
+		ROS_WARN_STREAM("Reference map bundle " << filename << " is truncated and will be ignored");
+		valid_bundle = false;
+	}
+
+	if (valid_bundle && (!s_readSection(file, header.points_offset, header.number_of_points, pointcloud) || !s_readSection(file, header.keypoints_offset, header.number_of_keypoints, keypoints))) {
+		ROS_WARN_STREAM("Failed to read reference map bundle " << filename);
+		valid_bundle = false;
+	}
+
+	return valid_bundle;
+}
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </ReferenceMapBundle-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// =============================================================================  </public-section>  ===========================================================================
+
+// =============================================================================   <protected-section>   =======================================================================
+template<typename PointT>
+bool ReferenceMapBundle<PointT>::s_writeSection(std::ofstream& file, const pcl::PointCloud<PointT>& pointcloud, std::uint64_t offset) {
+	std::uint64_t current_position = (std::uint64_t)file.tellp();
+	if (current_position > offset) { return false; }
+
+	static const char padding[s_sections_alignment] = { 0 };
+	file.write(padding, (std::streamsize)(offset - current_position));
+	if (!pointcloud.empty()) {
+		file.write(reinterpret_cast<const char*>(&pointcloud.points[0]), (std::streamsize)(pointcloud.size() * sizeof(PointT)));
+	}
+	return file.good();
+}
+
+
+template<typename PointT>
+bool ReferenceMapBundle<PointT>::s_readSection(std::ifstream& file, std::uint64_t offset, std::uint64_t number_of_points, pcl::PointCloud<PointT>& pointcloud) {
+	pointcloud.points.resize(number_of_points);
+	if (number_of_points > 0) {
+		file.seekg((std::streamoff)offset);
+		if (!file.read(reinterpret_cast<char*>(&pointcloud.points[0]), (std::streamsize)(number_of_points * sizeof(PointT)))) { return false; }
+	}
+	pointcloud.width = (std::uint32_t)number_of_points;
+	pointcloud.height = 1;
+	pointcloud.is_dense = false;
+	return true;
+}
+// =============================================================================   </protected-section>  =======================================================================
+
+} /* namespace dynamic_robot_localization */
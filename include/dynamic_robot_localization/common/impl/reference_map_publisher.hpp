@@ -0,0 +1,266 @@
+/**\file reference_map_publisher.hpp
+ * \brief Description...
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+#include <dynamic_robot_localization/common/reference_map_publisher.h>
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+namespace dynamic_robot_localization {
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <imports>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </imports>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+// =============================================================================  <public-section>  ============================================================================
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <constructors-destructor>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </constructors-destructor>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <ReferenceMapPublisher-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+template<typename PointT>
+void ReferenceMapPublisher<PointT>::setupConfigurationFromParameterServer(ros::NodeHandlePtr& node_handle, ros::NodeHandlePtr& private_node_handle, const std::string& configuration_namespace) {
+	std::string final_param_name;
+	std::string search_namespace = private_node_handle->getNamespace() + "/" + configuration_namespace;
+	double delta_voxel_size = delta_voxel_size_;
+	if (ros::param::search(search_namespace, "reference_pointcloud_publisher/delta_voxel_size", final_param_name)) { private_node_handle->param(final_param_name, delta_voxel_size, 0.0); }
+	if (delta_voxel_size != delta_voxel_size_) { setDeltaVoxelSize(delta_voxel_size); }
+	if (ros::param::search(search_namespace, "reference_pointcloud_publisher/full_snapshot_delta_ratio", final_param_name)) { private_node_handle->param(final_param_name, full_snapshot_delta_ratio_, 0.5); }
+	if (ros::param::search(search_namespace, "reference_pointcloud_publisher/full_snapshot_period", final_param_name)) { private_node_handle->param(final_param_name, full_snapshot_period_, 0.0); }
+	if (ros::param::search(search_namespace, "reference_pointcloud_publisher/min_publish_period", final_param_name)) { private_node_handle->param(final_param_name, min_publish_period_, 0.0); }
+	if (ros::param::search(search_namespace, "reference_pointcloud_publisher/max_bytes_per_second", final_param_name)) { private_node_handle->param(final_param_name, max_bytes_per_second_, 0.0); }
+}
+
+
+template<typename PointT>
+void ReferenceMapPublisher<PointT>::startPublishers(ros::NodeHandlePtr& node_handle) {
+	shutdownPublishers();
+	if (publish_topic_.empty()) { return; }
+
+	ros::SubscriberStatusCallback subscriber_connected_callback = std::bind(&ReferenceMapPublisher<PointT>::subscriberConnectedCallback, this, std::placeholders::_1);
+	full_snapshot_publisher_ = node_handle->advertise<sensor_msgs::PointCloud2>(publish_topic_, 1, subscriber_connected_callback, ros::SubscriberStatusCallback(), ros::VoidConstPtr(), true);
+	if (delta_voxel_size_ > 0.0) {
+		delta_updated_publisher_ = node_handle->advertise<sensor_msgs::PointCloud2>(publish_topic_ + "_delta_updated", 10, subscriber_connected_callback);
+		delta_removed_publisher_ = node_handle->advertise<sensor_msgs::PointCloud2>(publish_topic_ + "_delta_removed", 10, subscriber_connected_callback);
+	}
+
+	published_voxels_.clear();
+	last_full_snapshot_time_ = ros::WallTime();
+	full_snapshot_requested_ = true;
+}
+
+
+template<typename PointT>
+void ReferenceMapPublisher<PointT>::shutdownPublishers() {
+	full_snapshot_publisher_.shutdown();
+	delta_updated_publisher_.shutdown();
+	delta_removed_publisher_.shutdown();
+}
+
+
+template<typename PointT>
+void ReferenceMapPublisher<PointT>::setReferencePointCloud(const typename pcl::PointCloud<PointT>::ConstPtr& reference_cloud) {
+	reference_cloud_ = reference_cloud;
+	reference_cloud_changed_ = true;
+	full_snapshot_msg_outdated_ = true;
+}
+
+
+template<typename PointT>
+bool ReferenceMapPublisher<PointT>::publishPendingChanges(const ros::Time& time_stamp, bool force) {
+	if (!isPublishing() || !reference_cloud_) { return false; }
+
+	ros::WallTime now = ros::WallTime::now();
+	refillBytesBudget(now);
+
+	if (full_snapshot_period_ > 0.0 && !last_full_snapshot_time_.isZero() && (now - last_full_snapshot_time_).toSec() >= full_snapshot_period_) {
+		full_snapshot_requested_ = true;
+	}
+
+	if (!hasPendingChanges()) { return false; }
+
+	bool first_publication = last_full_snapshot_time_.isZero();
+	if (!force && !first_publication) {
+		if (min_publish_period_ > 0.0 && (now - last_publish_time_).toSec() < min_publish_period_) { return false; }
+		if (max_bytes_per_second_ > 0.0 && available_bytes_ < 0.0) { return false; }
+		if (full_snapshot_publisher_.getNumSubscribers() + delta_updated_publisher_.getNumSubscribers() + delta_removed_publisher_.getNumSubscribers() == 0) {
+			return false; // the changes are kept and new subscribers request a full snapshot
+		}
+	}
+
+	bool publish_full_snapshot = full_snapshot_requested_ || delta_voxel_size_ <= 0.0 || published_voxels_.empty();
+	long long published_bytes = 0;
+	if (!publish_full_snapshot) {
+		published_bytes = publishDelta(*reference_cloud_, time_stamp);
+		if (published_bytes < 0) { publish_full_snapshot = true; }
+	}
+
+	if (publish_full_snapshot) {
+		full_snapshot_requested_ = false;
+		published_bytes = (long long)publishFullSnapshot(*reference_cloud_, time_stamp);
+		last_full_snapshot_time_ = now;
+	}
+
+	reference_cloud_changed_ = false;
+	last_publish_time_ = now;
+	available_bytes_ -= (double)published_bytes;
+	return true;
+}
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </ReferenceMapPublisher-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// =============================================================================  </public-section>  ===========================================================================
+
+// =============================================================================   <protected-section>   =======================================================================
+template<typename PointT>
+std::uint64_t ReferenceMapPublisher<PointT>::s_computePointHash(const PointT& point) {
+	std::uint32_t coordinates[3];
+	std::memcpy(&coordinates[0], &point.x, sizeof(float));
+	std::memcpy(&coordinates[1], &point.y, sizeof(float));
+	std::memcpy(&coordinates[2], &point.z, sizeof(float));
+	std::uint64_t hash = ((std::uint64_t)coordinates[0] << 32) ^ ((std::uint64_t)coordinates[1] << 16) ^ (std::uint64_t)coordinates[2];
+	hash += 0x9E3779B97F4A7C15ULL; // splitmix64 finalizer
+	hash = (hash ^ (hash >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	hash = (hash ^ (hash >> 27)) * 0x94D049BB133111EBULL;
+	return hash ^ (hash >> 31);
+}
+
+
+template<typename PointT>
+void ReferenceMapPublisher<PointT>::s_decodeVoxelKey(VoxelKey voxel_key, int& x, int& y, int& z) {
+	x = (int)((voxel_key >> 42) & 0x1FFFFF);
+	y = (int)((voxel_key >> 21) & 0x1FFFFF);
+	z = (int)(voxel_key & 0x1FFFFF);
+	if (x & 0x100000) { x -= 0x200000; }
+	if (y & 0x100000) { y -= 0x200000; }
+	if (z & 0x100000) { z -= 0x200000; }
+}
+
+
+template<typename PointT>
+void ReferenceMapPublisher<PointT>::computeVoxelSignatures(const pcl::PointCloud<PointT>& cloud, VoxelSignatures& voxel_signatures) const {
+	voxel_signatures.clear();
+	voxel_signatures.reserve(published_voxels_.size() + published_voxels_.size() / 8);
+	for (size_t i = 0; i < cloud.size(); ++i) {
+		const PointT& point = cloud[i];
+		if (!std::isfinite(point.x) || !std::isfinite(point.y) || !std::isfinite(point.z)) { continue; }
+		VoxelSignature& voxel_signature = voxel_signatures[computeVoxelKey(point)];
+		++voxel_signature.number_of_points;
+		voxel_signature.points_hash += s_computePointHash(point);
+	}
+}
+
+
+template<typename PointT>
+size_t ReferenceMapPublisher<PointT>::publishFullSnapshot(const pcl::PointCloud<PointT>& cloud, const ros::Time& time_stamp) {
+	bool full_snapshot_msg_generated = false;
+	if (!full_snapshot_msg_ || full_snapshot_msg_outdated_) {
+		full_snapshot_msg_ = sensor_msgs::PointCloud2Ptr(new sensor_msgs::PointCloud2());
+		pcl::toROSMsg(cloud, *full_snapshot_msg_);
+		full_snapshot_msg_outdated_ = false;
+		full_snapshot_msg_generated = true;
+	}
+
+	fillMsgHeader(*full_snapshot_msg_, time_stamp);
+	++full_snapshot_msg_->header.seq;
+	full_snapshot_publisher_.publish(full_snapshot_msg_);
+
+	if (delta_voxel_size_ > 0.0 && (full_snapshot_msg_generated || published_voxels_.empty())) {
+		computeVoxelSignatures(cloud, published_voxels_);
+	}
+
+	ROS_DEBUG_STREAM((full_snapshot_msg_generated ? "Published" : "Republished") << " full snapshot of " << publish_topic_ << " with " << cloud.size() << " points (" << full_snapshot_msg_->data.size() << " bytes)");
+	return full_snapshot_msg_->data.size();
+}
+
+
+template<typename PointT>
+long long ReferenceMapPublisher<PointT>::publishDelta(const pcl::PointCloud<PointT>& cloud, const ros::Time& time_stamp) {
+	VoxelSignatures current_voxels;
+	computeVoxelSignatures(cloud, current_voxels);
+
+	std::unordered_set< VoxelKey > updated_voxels;
+	size_t number_of_updated_points = 0;
+	for (typename VoxelSignatures::const_iterator it = current_voxels.begin(); it != current_voxels.end(); ++it) {
+		typename VoxelSignatures::const_iterator published_voxel = published_voxels_.find(it->first);
+		if (published_voxel == published_voxels_.end() || published_voxel->second != it->second) {
+			updated_voxels.insert(it->first);
+			number_of_updated_points += it->second.number_of_points;
+		}
+	}
+
+	if (number_of_updated_points > full_snapshot_delta_ratio_ * cloud.size()) {
+		return -1;
+	}
+
+	pcl::PointCloud<pcl::PointXYZ> removed_voxels;
+	removed_voxels.header = cloud.header;
+	for (typename VoxelSignatures::const_iterator it = published_voxels_.begin(); it != published_voxels_.end(); ++it) {
+		if (current_voxels.find(it->first) == current_voxels.end()) {
+			int x, y, z;
+			s_decodeVoxelKey(it->first, x, y, z);
+			removed_voxels.push_back(pcl::PointXYZ((x + 0.5) * delta_voxel_size_, (y + 0.5) * delta_voxel_size_, (z + 0.5) * delta_voxel_size_));
+		}
+	}
+
+	published_voxels_.swap(current_voxels);
+	if (updated_voxels.empty() && removed_voxels.empty()) { return 0; }
+
+	pcl::PointCloud<PointT> updated_voxels_points;
+	updated_voxels_points.header = cloud.header;
+	updated_voxels_points.reserve(number_of_updated_points);
+	for (size_t i = 0; i < cloud.size(); ++i) {
+		const PointT& point = cloud[i];
+		if (!std::isfinite(point.x) || !std::isfinite(point.y) || !std::isfinite(point.z)) { continue; }
+		if (updated_voxels.find(computeVoxelKey(point)) != updated_voxels.end()) {
+			updated_voxels_points.push_back(point);
+		}
+	}
+
+	sensor_msgs::PointCloud2Ptr updated_voxels_msg(new sensor_msgs::PointCloud2());
+	pcl::toROSMsg(updated_voxels_points, *updated_voxels_msg);
+	fillMsgHeader(*updated_voxels_msg, time_stamp);
+	delta_updated_publisher_.publish(updated_voxels_msg);
+
+	sensor_msgs::PointCloud2Ptr removed_voxels_msg(new sensor_msgs::PointCloud2());
+	pcl::toROSMsg(removed_voxels, *removed_voxels_msg);
+	fillMsgHeader(*removed_voxels_msg, time_stamp);
+	delta_removed_publisher_.publish(removed_voxels_msg);
+
+	ROS_DEBUG_STREAM("Published delta of " << publish_topic_ << " with " << updated_voxels.size() << " updated voxels (" << updated_voxels_points.size() << " points) and " << removed_voxels.size() << " removed voxels");
+	return (long long)(updated_voxels_msg->data.size() + removed_voxels_msg->data.size());
+}
+
+
+template<typename PointT>
+void ReferenceMapPublisher<PointT>::fillMsgHeader(sensor_msgs::PointCloud2& cloud_msg, const ros::Time& time_stamp) const {
+	cloud_msg.header.stamp = time_stamp;
+	if (!publish_frame_id_.empty()) {
+		cloud_msg.header.frame_id = publish_frame_id_;
+	}
+}
+
+
+template<typename PointT>
+void ReferenceMapPublisher<PointT>::refillBytesBudget(const ros::WallTime& now) {
+	if (max_bytes_per_second_ <= 0.0) { return; }
+
+	if (last_bytes_budget_refill_time_.isZero()) {
+		available_bytes_ = max_bytes_per_second_;
+	} else {
+		available_bytes_ = std::min(max_bytes_per_second_, available_bytes_ + (now - last_bytes_budget_refill_time_).toSec() * max_bytes_per_second_);
+	}
+	last_bytes_budget_refill_time_ = now;
+}
+
+
+template<typename PointT>
+void ReferenceMapPublisher<PointT>::subscriberConnectedCallback(const ros::SingleSubscriberPublisher& subscriber) {
+	ROS_DEBUG_STREAM("Subscriber " << subscriber.getSubscriberName() << " connected to " << subscriber.getTopic() << " (requesting full snapshot of the reference point cloud)");
+	full_snapshot_requested_ = true;
+}
+// =============================================================================   </protected-section>  =======================================================================
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <template instantiations>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </template instantiations>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+} /* namespace dynamic_robot_localization */
@@ -0,0 +1,320 @@
+/**\file tiled_reference_map.hpp
+ * \brief Description...
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+#include <dynamic_robot_localization/common/tiled_reference_map.h>
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+namespace dynamic_robot_localization {
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <imports>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </imports>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+// =============================================================================  <public-section>  ============================================================================
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <constructors-destructor>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+template<typename PointT>
+TiledReferenceMap<PointT>::TiledReferenceMap(const std::string& tiles_folder_path, double tile_size, double active_tiles_radius) :
+	tiles_folder_path_(tiles_folder_path),
+	tile_size_(tile_size),
+	active_tiles_radius_(active_tiles_radius),
+	map_hash_(0) {}
+
+template<typename PointT>
+TiledReferenceMap<PointT>::~TiledReferenceMap() {
+	if (tiles_loading_.valid()) { tiles_loading_.wait(); }
+}
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </constructors-destructor>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <TiledReferenceMap-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+template<typename PointT>
+bool TiledReferenceMap<PointT>::build(const pcl::PointCloud<PointT>& pointcloud, const pcl::PointCloud<PointT>& keypoints, std::uint64_t map_hash) {
+	clear();
+	if (tile_size_ <= 0.0 || tiles_folder_path_.empty()) { return false; }
+
+	if (mkdir(tiles_folder_path_.c_str(), 0755) != 0 && errno != EEXIST) {
+		ROS_WARN_STREAM("Failed to create the reference map tiles folder " << tiles_folder_path_);
+		return false;
+	}
+
+	TileMap tiles;
+	for (size_t i = 0; i < pointcloud.size(); ++i) {
+		Tile& tile = tiles[computeTileKey(pointcloud[i].x, pointcloud[i].y)];
+		if (!tile.pointcloud) {
+			tile.pointcloud.reset(new pcl::PointCloud<PointT>());
+			tile.keypoints.reset(new pcl::PointCloud<PointT>());
+		}
+		tile.pointcloud->push_back(pointcloud[i]);
+	}
+
+	for (size_t i = 0; i < keypoints.size(); ++i) {
+		typename TileMap::iterator tile = tiles.find(computeTileKey(keypoints[i].x, keypoints[i].y));
+		if (tile != tiles.end()) { tile->second.keypoints->push_back(keypoints[i]); }
+	}
+
+	// the index is written to a temporary file and only renamed after all the tiles were saved (avoids leaving a truncated index if the node is killed while building the tiles)
+	std::string tiles_index_filename = getTilesIndexFilename();
+	std::string temporary_tiles_index_filename = tiles_index_filename + ".tmp";
+	{
+		std::ofstream tiles_index(temporary_tiles_index_filename.c_str(), std::ios::trunc);
+		if (!tiles_index.is_open()) { return false; }
+		tiles_index << map_hash << " " << tile_size_ << "\n";
+
+		for (typename TileMap::iterator tile = tiles.begin(); tile != tiles.end(); ++tile) {
+			if (!ReferenceMapBundle<PointT>::s_save(getTileFilename(tile->first), map_hash, computeTileHash(tile->first), *tile->second.pointcloud, *tile->second.keypoints)) {
+				ROS_WARN_STREAM("Failed to save reference map tile " << getTileFilename(tile->first));
+				tiles_index.close();
+				std::remove(temporary_tiles_index_filename.c_str());
+				available_tiles_.clear();
+				return false;
+			}
+			tiles_index << tile->first.first << " " << tile->first.second << " " << tile->second.pointcloud->size() << "\n";
+			available_tiles_.insert(tile->first);
+		}
+
+		tiles_index.flush();
+		if (!tiles_index.good()) {
+			tiles_index.close();
+			std::remove(temporary_tiles_index_filename.c_str());
+			available_tiles_.clear();
+			return false;
+		}
+	}
+
+	if (std::rename(temporary_tiles_index_filename.c_str(), tiles_index_filename.c_str()) != 0) {
+		std::remove(temporary_tiles_index_filename.c_str());
+		available_tiles_.clear();
+		return false;
+	}
+
+	map_hash_ = map_hash;
+	ROS_INFO_STREAM("Split reference map with " << pointcloud.size() << " points into " << tiles.size() << " tiles with " << tile_size_ << " meters");
+	return true;
+}
+
+
+template<typename PointT>
+bool TiledReferenceMap<PointT>::loadIndex(std::uint64_t map_hash) {
+	clear();
+	std::ifstream tiles_index(getTilesIndexFilename().c_str());
+	if (!tiles_index.is_open()) { return false; }
+
+	std::uint64_t tiles_map_hash;
+	double tiles_size;
+	if (!(tiles_index >> tiles_map_hash >> tiles_size) || tiles_map_hash != map_hash || std::abs(tiles_size - tile_size_) > 1e-6) {
+		ROS_INFO_STREAM("Reference map tiles in " << tiles_folder_path_ << " are outdated");
+		return false;
+	}
+
+	int tile_x, tile_y;
+	size_t number_of_points;
+	while (tiles_index >> tile_x >> tile_y >> number_of_points) {
+		available_tiles_.insert(TileKey(tile_x, tile_y));
+	}
+
+	map_hash_ = map_hash;
+	ROS_INFO_STREAM("Loaded index of reference map tiles in " << tiles_folder_path_ << " with " << available_tiles_.size() << " tiles");
+	return !available_tiles_.empty();
+}
+
+
+template<typename PointT>
+bool TiledReferenceMap<PointT>::updateResidentTiles(double x, double y, LocalMap& local_map) {
+	if (tiles_loading_.valid()) { tiles_loading_.wait(); }
+	bool resident_tiles_changed = collectResidentTilesUpdate(local_map);
+	ResidentTilesUpdate resident_tiles_update = computeResidentTilesUpdate(resident_tiles_, computeMissingTiles(x, y), x, y, LocalMapPreparation());
+	return applyResidentTilesUpdate(resident_tiles_update, local_map) || resident_tiles_changed;
+}
+
+
+template<typename PointT>
+bool TiledReferenceMap<PointT>::hasMissingTiles(double x, double y) const {
+	return !computeMissingTiles(x, y).empty();
+}
+
+
+template<typename PointT>
+bool TiledReferenceMap<PointT>::requestResidentTilesUpdate(double x, double y, const LocalMapPreparation& local_map_preparation) {
+	if (tiles_loading_.valid()) { return false; }
+
+	std::set<TileKey> missing_tiles = computeMissingTiles(x, y);
+	if (missing_tiles.empty()) { return false; }
+
+	// the resident tiles are copied (only their pointers) in order to allow the current local map to be used while the new one is being prepared
+	tiles_loading_ = std::async(std::launch::async, &TiledReferenceMap<PointT>::computeResidentTilesUpdate, this, resident_tiles_, missing_tiles, x, y, local_map_preparation);
+	return true;
+}
+
+
+template<typename PointT>
+bool TiledReferenceMap<PointT>::collectResidentTilesUpdate(LocalMap& local_map) {
+	if (!tiles_loading_.valid() || tiles_loading_.wait_for(std::chrono::seconds(0)) != std::future_status::ready) { return false; }
+	ResidentTilesUpdate resident_tiles_update = tiles_loading_.get();
+	return applyResidentTilesUpdate(resident_tiles_update, local_map);
+}
+
+
+template<typename PointT>
+void TiledReferenceMap<PointT>::clear() {
+	if (tiles_loading_.valid()) { tiles_loading_.wait(); tiles_loading_.get(); }
+	available_tiles_.clear();
+	resident_tiles_.clear();
+	map_hash_ = 0;
+}
+
+
+template<typename PointT>
+size_t TiledReferenceMap<PointT>::accountMemoryUsage(MemoryUsage& memory_usage) const {
+	if (!memory_usage.addObject(this)) { return 0; }
+	size_t bytes = memory_usage.addBytes(sizeof(*this) + resident_tiles_.size() * (sizeof(typename TileMap::value_type) + 4 * sizeof(void*)));
+	for (typename TileMap::const_iterator tile_it = resident_tiles_.begin(); tile_it != resident_tiles_.end(); ++tile_it) {
+		bytes += memory_usage.addPointCloud(tile_it->second.pointcloud.get()) + memory_usage.addPointCloud(tile_it->second.keypoints.get()) + memory_usage.addKdTree(tile_it->second.search_method.get());
+	}
+	return bytes;
+}
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </TiledReferenceMap-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// =============================================================================  </public-section>  ===========================================================================
+
+// =============================================================================   <protected-section>   =======================================================================
+template<typename PointT>
+std::set<typename TiledReferenceMap<PointT>::TileKey> TiledReferenceMap<PointT>::computeTilesWithinRadius(double x, double y, double radius) const {
+	std::set<TileKey> tiles;
+	TileKey minimum_tile = computeTileKey(x - radius, y - radius);
+	TileKey maximum_tile = computeTileKey(x + radius, y + radius);
+	double radius_squared = radius * radius;
+
+	for (int tile_x = minimum_tile.first; tile_x <= maximum_tile.first; ++tile_x) {
+		for (int tile_y = minimum_tile.second; tile_y <= maximum_tile.second; ++tile_y) {
+			TileKey tile_key(tile_x, tile_y);
+			if (available_tiles_.find(tile_key) == available_tiles_.end()) { continue; }
+
+			// distance from the position to the closest point of the tile
+			double dx = std::max(0.0, std::max(tile_x * tile_size_ - x, x - (tile_x + 1) * tile_size_));
+			double dy = std::max(0.0, std::max(tile_y * tile_size_ - y, y - (tile_y + 1) * tile_size_));
+			if (dx * dx + dy * dy <= radius_squared) {
+				tiles.insert(tile_key);
+			}
+		}
+	}
+
+	return tiles;
+}
+
+
+template<typename PointT>
+std::string TiledReferenceMap<PointT>::getTileFilename(const TileKey& tile_key) const {
+	std::stringstream tile_filename;
+	tile_filename << tiles_folder_path_ << "/tile_" << tile_key.first << "_" << tile_key.second << ".drlmap";
+	return tile_filename.str();
+}
+
+
+template<typename PointT>
+std::set<typename TiledReferenceMap<PointT>::TileKey> TiledReferenceMap<PointT>::computeMissingTiles(double x, double y) const {
+	std::set<TileKey> missing_tiles;
+	std::set<TileKey> active_tiles = computeTilesWithinRadius(x, y, active_tiles_radius_);
+	for (typename std::set<TileKey>::const_iterator tile_key = active_tiles.begin(); tile_key != active_tiles.end(); ++tile_key) {
+		if (resident_tiles_.find(*tile_key) == resident_tiles_.end()) { missing_tiles.insert(*tile_key); }
+	}
+	return missing_tiles;
+}
+
+
+template<typename PointT>
+bool TiledReferenceMap<PointT>::loadTile(const TileKey& tile_key, Tile& tile) const {
+	tile.pointcloud.reset(new pcl::PointCloud<PointT>());
+	tile.keypoints.reset(new pcl::PointCloud<PointT>());
+	if (!ReferenceMapBundle<PointT>::s_load(getTileFilename(tile_key), map_hash_, computeTileHash(tile_key), *tile.pointcloud, *tile.keypoints) || tile.pointcloud->empty()) {
+		ROS_WARN_STREAM("Failed to load reference map tile " << getTileFilename(tile_key));
+		return false;
+	}
+
+	// flann indices can not be saved with the points, so the k-d tree of the tile is built once when it is loaded and reused while the tile is resident
+	tile.search_method.reset(new pcl::search::KdTree<PointT>());
+	tile.search_method->setInputCloud(tile.pointcloud);
+	PointT min_point, max_point;
+	pcl::getMinMax3D(*tile.pointcloud, min_point, max_point);
+	tile.min_point = min_point.getVector3fMap();
+	tile.max_point = max_point.getVector3fMap();
+	return true;
+}
+
+
+template<typename PointT>
+typename TiledReferenceMap<PointT>::ResidentTilesUpdate TiledReferenceMap<PointT>::computeResidentTilesUpdate(const TileMap& resident_tiles, const std::set<TileKey>& missing_tiles, double x, double y,
+		const LocalMapPreparation& local_map_preparation) const {
+	ResidentTilesUpdate resident_tiles_update;
+	resident_tiles_update.number_of_loaded_tiles = 0;
+	resident_tiles_update.number_of_evicted_tiles = 0;
+
+	std::set<TileKey> tiles_to_keep = computeTilesWithinRadius(x, y, active_tiles_radius_ + tile_size_);
+	for (typename TileMap::const_iterator tile = resident_tiles.begin(); tile != resident_tiles.end(); ++tile) {
+		if (tiles_to_keep.find(tile->first) == tiles_to_keep.end()) {
+			++resident_tiles_update.number_of_evicted_tiles;
+		} else {
+			resident_tiles_update.resident_tiles.insert(*tile);
+		}
+	}
+
+	for (typename std::set<TileKey>::const_iterator tile_key = missing_tiles.begin(); tile_key != missing_tiles.end(); ++tile_key) {
+		Tile tile;
+		if (loadTile(*tile_key, tile)) {
+			resident_tiles_update.resident_tiles[*tile_key] = tile;
+			++resident_tiles_update.number_of_loaded_tiles;
+		}
+	}
+
+	if (resident_tiles_update.number_of_loaded_tiles > 0 || resident_tiles_update.number_of_evicted_tiles > 0) {
+		s_assembleLocalMap(resident_tiles_update.resident_tiles, resident_tiles_update.local_map);
+		if (local_map_preparation) { local_map_preparation(resident_tiles_update.local_map); }
+	}
+
+	return resident_tiles_update;
+}
+
+
+template<typename PointT>
+bool TiledReferenceMap<PointT>::applyResidentTilesUpdate(ResidentTilesUpdate& resident_tiles_update, LocalMap& local_map) {
+	if (resident_tiles_update.number_of_loaded_tiles == 0 && resident_tiles_update.number_of_evicted_tiles == 0) { return false; }
+	resident_tiles_.swap(resident_tiles_update.resident_tiles);
+	local_map = resident_tiles_update.local_map;
+	ROS_DEBUG_STREAM("Reference map tiles update: " << resident_tiles_update.number_of_loaded_tiles << " loaded | " << resident_tiles_update.number_of_evicted_tiles << " evicted | " << resident_tiles_.size() << " resident");
+	return true;
+}
+
+
+template<typename PointT>
+void TiledReferenceMap<PointT>::s_assembleLocalMap(const TileMap& tiles, LocalMap& local_map) {
+	size_t number_of_points = 0;
+	size_t number_of_keypoints = 0;
+	for (typename TileMap::const_iterator tile = tiles.begin(); tile != tiles.end(); ++tile) {
+		number_of_points += tile->second.pointcloud->size();
+		number_of_keypoints += tile->second.keypoints->size();
+	}
+
+	local_map.pointcloud.reset(new pcl::PointCloud<PointT>());
+	local_map.keypoints.reset(new pcl::PointCloud<PointT>());
+	local_map.pointcloud->reserve(number_of_points);
+	local_map.keypoints->reserve(number_of_keypoints);
+	typename ChunkedKdTreeSearch<PointT>::Ptr search_method(new ChunkedKdTreeSearch<PointT>());
+	for (typename TileMap::const_iterator tile = tiles.begin(); tile != tiles.end(); ++tile) {
+		*local_map.pointcloud += *tile->second.pointcloud;
+		*local_map.keypoints += *tile->second.keypoints;
+		search_method->addChunk(tile->second.search_method, Eigen::Matrix4f::Identity(), tile->second.min_point, tile->second.max_point);
+	}
+
+	local_map.pointcloud->width = (std::uint32_t)local_map.pointcloud->size();
+	local_map.pointcloud->height = 1;
+	local_map.keypoints->width = (std::uint32_t)local_map.keypoints->size();
+	local_map.keypoints->height = 1;
+	search_method->setChunkedInputCloud(local_map.pointcloud);
+	local_map.search_method = search_method;
+	local_map.number_of_tiles = tiles.size();
+}
+// =============================================================================   </protected-section>  =======================================================================
+
+} /* namespace dynamic_robot_localization */
@@ -0,0 +1,267 @@
+/**\file voxel_hash_search.hpp
+ * \brief Description...
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+#include <dynamic_robot_localization/common/voxel_hash_search.h>
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+namespace dynamic_robot_localization {
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <imports>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </imports>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+// =============================================================================  <public-section>  ============================================================================
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <constructors-destructor>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+template<typename PointT>
+VoxelHashSearch<PointT>::VoxelHashSearch(double voxel_size, int maximum_number_of_points_per_voxel, int maximum_number_of_search_rings, bool sorted) :
+	pcl::search::KdTree<PointT>(sorted),
+	voxel_size_(voxel_size),
+	inverse_voxel_size_(1.0 / voxel_size),
+	maximum_number_of_points_per_voxel_(maximum_number_of_points_per_voxel),
+	maximum_number_of_search_rings_(maximum_number_of_search_rings),
+	number_of_indexed_points_(0) {}
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </constructors-destructor>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <VoxelHashSearch-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+template<typename PointT>
+void VoxelHashSearch<PointT>::setInputCloud(const PointCloudConstPtr& cloud, const IndicesConstPtr& indices) {
+	if (cloud && cloud == this->input_ && !indices && !this->indices_ && cloud->size() >= number_of_indexed_points_) {
+		indexNewPoints();
+	} else {
+		this->input_ = cloud;
+		this->indices_ = indices;
+		rebuildIndex();
+	}
+}
+
+
+template<typename PointT>
+void VoxelHashSearch<PointT>::rebuildIndex() {
+	voxels_.clear();
+	number_of_indexed_points_ = 0;
+	if (!this->input_) { return; }
+
+	if (this->indices_) {
+		for (size_t i = 0; i < this->indices_->size(); ++i) {
+			indexPoint((*this->indices_)[i], false);
+		}
+	} else {
+		for (size_t i = 0; i < this->input_->size(); ++i) {
+			indexPoint((int)i, false);
+		}
+	}
+
+	number_of_indexed_points_ = this->input_->size();
+}
+
+
+template<typename PointT>
+void VoxelHashSearch<PointT>::clear() {
+	voxels_.clear();
+	number_of_indexed_points_ = 0;
+	this->input_.reset();
+	this->indices_.reset();
+}
+
+
+template<typename PointT>
+size_t VoxelHashSearch<PointT>::insertPoints(const pcl::PointCloud<PointT>& new_points, pcl::PointCloud<PointT>& map_cloud, std::vector<int>* inserted_points_indices) {
+	if (this->input_.get() != &map_cloud || this->indices_) { return 0; }
+	indexNewPoints();
+
+	size_t number_of_points_before_insertion = map_cloud.size();
+	map_cloud.reserve(number_of_points_before_insertion + new_points.size());
+
+	for (size_t i = 0; i < new_points.size(); ++i) {
+		const PointT& point = new_points[i];
+		if (!pcl::isFinite(point)) { continue; }
+
+		int x, y, z;
+		computeVoxelCoordinates(point, x, y, z);
+		std::vector<int>& voxel = voxels_[computeVoxelKey(x, y, z)];
+		if (maximum_number_of_points_per_voxel_ <= 0 || voxel.size() < (size_t)maximum_number_of_points_per_voxel_) {
+			if (inserted_points_indices) { inserted_points_indices->push_back((int)map_cloud.size()); }
+			voxel.push_back((int)map_cloud.size());
+			map_cloud.push_back(point);
+		}
+	}
+
+	number_of_indexed_points_ = map_cloud.size();
+	return map_cloud.size() - number_of_points_before_insertion;
+}
+
+
+template<typename PointT>
+int VoxelHashSearch<PointT>::nearestKSearch(const PointT& point, int k, std::vector<int>& k_indices, std::vector<float>& k_sqr_distances) const {
+	k_indices.clear();
+	k_sqr_distances.clear();
+	if (k <= 0 || voxels_.empty() || !pcl::isFinite(point)) { return 0; }
+
+	int center_x, center_y, center_z;
+	computeVoxelCoordinates(point, center_x, center_y, center_z);
+
+	std::vector< std::pair<float, int> > neighbors;
+	bool exact_neighbors_found = false;
+	for (int ring = 0; ring <= maximum_number_of_search_rings_; ++ring) {
+		searchVoxelShell(point, center_x, center_y, center_z, ring, std::numeric_limits<double>::max(), neighbors);
+
+		if (neighbors.size() >= (size_t)k) {
+			std::nth_element(neighbors.begin(), neighbors.begin() + (k - 1), neighbors.end());
+
+			// all points closer than the border of the searched voxel cube were already found
+			double distance_to_border = std::min(std::min(
+					std::min(point.x - (center_x - ring) * voxel_size_, (center_x + ring + 1) * voxel_size_ - point.x),
+					std::min(point.y - (center_y - ring) * voxel_size_, (center_y + ring + 1) * voxel_size_ - point.y)),
+					std::min(point.z - (center_z - ring) * voxel_size_, (center_z + ring + 1) * voxel_size_ - point.z));
+			if (neighbors[k - 1].first <= distance_to_border * distance_to_border) {
+				exact_neighbors_found = true;
+				break;
+			}
+		}
+	}
+
+	if (!exact_neighbors_found) {
+		// some of the k nearest neighbors may be outside the searched rings
+		neighbors.clear();
+		searchAllVoxels(point, std::numeric_limits<double>::max(), neighbors);
+	}
+
+	size_t number_of_neighbors = std::min(neighbors.size(), (size_t)k);
+	std::partial_sort(neighbors.begin(), neighbors.begin() + number_of_neighbors, neighbors.end());
+
+	k_indices.resize(number_of_neighbors);
+	k_sqr_distances.resize(number_of_neighbors);
+	for (size_t i = 0; i < number_of_neighbors; ++i) {
+		k_sqr_distances[i] = neighbors[i].first;
+		k_indices[i] = neighbors[i].second;
+	}
+
+	return (int)number_of_neighbors;
+}
+
+
+template<typename PointT>
+int VoxelHashSearch<PointT>::radiusSearch(const PointT& point, double radius, std::vector<int>& k_indices, std::vector<float>& k_sqr_distances, unsigned int max_nn) const {
+	k_indices.clear();
+	k_sqr_distances.clear();
+	if (radius <= 0.0 || voxels_.empty() || !pcl::isFinite(point)) { return 0; }
+
+	double sqr_radius = radius * radius;
+	std::vector< std::pair<float, int> > neighbors;
+	int number_of_rings = (int)std::ceil(radius * inverse_voxel_size_);
+	double number_of_voxels_in_search_cube = std::pow(2.0 * number_of_rings + 1.0, 3);
+
+	if (number_of_voxels_in_search_cube > (double)voxels_.size()) {
+		// searching all the voxels is cheaper than probing the empty cells of the search cube
+		searchAllVoxels(point, sqr_radius, neighbors);
+	} else {
+		int center_x, center_y, center_z;
+		computeVoxelCoordinates(point, center_x, center_y, center_z);
+		for (int ring = 0; ring <= number_of_rings; ++ring) {
+			searchVoxelShell(point, center_x, center_y, center_z, ring, sqr_radius, neighbors);
+		}
+	}
+
+	size_t number_of_neighbors = neighbors.size();
+	if (max_nn > 0 && number_of_neighbors > max_nn) {
+		number_of_neighbors = max_nn;
+		std::partial_sort(neighbors.begin(), neighbors.begin() + number_of_neighbors, neighbors.end());
+	} else if (this->sorted_results_) {
+		std::sort(neighbors.begin(), neighbors.end());
+	}
+
+	k_indices.resize(number_of_neighbors);
+	k_sqr_distances.resize(number_of_neighbors);
+	for (size_t i = 0; i < number_of_neighbors; ++i) {
+		k_sqr_distances[i] = neighbors[i].first;
+		k_indices[i] = neighbors[i].second;
+	}
+
+	return (int)number_of_neighbors;
+}
+
+
+template<typename PointT>
+size_t VoxelHashSearch<PointT>::accountMemoryUsage(MemoryUsage& memory_usage) const {
+	if (!memory_usage.addObject(this)) { return 0; } // also prevents the accounting of a FLANN index (this search method does not build one)
+	size_t bytes = sizeof(*this) + MemoryUsage::s_getHashContainerBytes(voxels_);
+	for (typename VoxelMap::const_iterator voxel_it = voxels_.begin(); voxel_it != voxels_.end(); ++voxel_it) {
+		bytes += MemoryUsage::s_getVectorBytes(voxel_it->second);
+	}
+	return memory_usage.addBytes(bytes);
+}
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </VoxelHashSearch-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// =============================================================================  </public-section>  ===========================================================================
+
+
+// =============================================================================   <protected-section>   =======================================================================
+template<typename PointT>
+bool VoxelHashSearch<PointT>::indexPoint(int point_index, bool respect_voxel_capacity) {
+	const PointT& point = (*this->input_)[point_index];
+	if (!pcl::isFinite(point)) { return false; }
+
+	int x, y, z;
+	computeVoxelCoordinates(point, x, y, z);
+	std::vector<int>& voxel = voxels_[computeVoxelKey(x, y, z)];
+	if (respect_voxel_capacity && maximum_number_of_points_per_voxel_ > 0 && voxel.size() >= (size_t)maximum_number_of_points_per_voxel_) { return false; }
+
+	voxel.push_back(point_index);
+	return true;
+}
+
+
+template<typename PointT>
+void VoxelHashSearch<PointT>::indexNewPoints() {
+	if (!this->input_) { return; }
+
+	for (size_t i = number_of_indexed_points_; i < this->input_->size(); ++i) {
+		indexPoint((int)i, false);
+	}
+
+	number_of_indexed_points_ = this->input_->size();
+}
+
+
+template<typename PointT>
+void VoxelHashSearch<PointT>::searchVoxelShell(const PointT& point, int center_x, int center_y, int center_z, int ring, double maximum_sqr_distance, std::vector< std::pair<float, int> >& neighbors) const {
+	for (int dx = -ring; dx <= ring; ++dx) {
+		for (int dy = -ring; dy <= ring; ++dy) {
+			bool inner_column = (std::abs(dx) != ring && std::abs(dy) != ring);
+			int dz_step = (inner_column && ring > 0) ? 2 * ring : 1; // inside the shell only the top and bottom voxels belong to the current ring
+			for (int dz = -ring; dz <= ring; dz += dz_step) {
+				typename VoxelMap::const_iterator voxel = voxels_.find(computeVoxelKey(center_x + dx, center_y + dy, center_z + dz));
+				if (voxel == voxels_.end()) { continue; }
+
+				for (size_t i = 0; i < voxel->second.size(); ++i) {
+					const PointT& neighbor = (*this->input_)[voxel->second[i]];
+					float sqr_distance = (neighbor.x - point.x) * (neighbor.x - point.x) + (neighbor.y - point.y) * (neighbor.y - point.y) + (neighbor.z - point.z) * (neighbor.z - point.z);
+					if (sqr_distance <= maximum_sqr_distance) {
+						neighbors.push_back(std::pair<float, int>(sqr_distance, voxel->second[i]));
+					}
+				}
+			}
+		}
+	}
+}
+
+
+template<typename PointT>
+void VoxelHashSearch<PointT>::searchAllVoxels(const PointT& point, double maximum_sqr_distance, std::vector< std::pair<float, int> >& neighbors) const {
+	for (typename VoxelMap::const_iterator voxel = voxels_.begin(); voxel != voxels_.end(); ++voxel) {
+		for (size_t i = 0; i < voxel->second.size(); ++i) {
+			const PointT& neighbor = (*this->input_)[voxel->second[i]];
+			float sqr_distance = (neighbor.x - point.x) * (neighbor.x - point.x) + (neighbor.y - point.y) * (neighbor.y - point.y) + (neighbor.z - point.z) * (neighbor.z - point.z);
+			if (sqr_distance <= maximum_sqr_distance) {
+				neighbors.push_back(std::pair<float, int>(sqr_distance, voxel->second[i]));
+			}
+		}
+	}
+}
+// =============================================================================   </protected-section>  =======================================================================
+
+} /* namespace dynamic_robot_localization */
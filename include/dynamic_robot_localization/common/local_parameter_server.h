@@ -0,0 +1,103 @@
+#pragma once
+
+/**\file local_parameter_server.h
+ * \brief In-process replacement of the ros master, used as parameter server by tools that do not communicate with other nodes
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>  <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// std includes
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ROS includes
+#include <XmlRpcServer.h>
+#include <XmlRpcServerMethod.h>
+#include <XmlRpcValue.h>
+
+// external libs includes
+#include <yaml-cpp/yaml.h>
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+namespace dynamic_robot_localization {
+// ############################################################################   LocalParameterServer   ###########################################################################
+/**
+ * \brief Serves the ros master api in a background thread of the process, keeping the parameters in memory (loaded from yaml files with the same layout used by rosparam load).
+ * Giving its uri to ros::init (__master:=uri) allows to use ros::NodeHandle::param, ros::param::search and the other parameter functions without a ros master.
+ * The topics and services are accepted but never connected (the process can only use them internally), which is enough for tools that call the processing functions directly.
+ * The yaml files are loaded without roslaunch substitution args ($(find ...), $(arg ...)).
+ */
+class LocalParameterServer {
+	// ========================================================================   <public-section>   ===========================================================================
+	public:
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <usings>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		using Ptr = std::shared_ptr< LocalParameterServer >;
+		using ConstPtr = std::shared_ptr< const LocalParameterServer >;
+		using MethodFunction = std::function< void (XmlRpc::XmlRpcValue& params, XmlRpc::XmlRpcValue& result) >;
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </usings>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <constructors-destructor>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		LocalParameterServer();
+		virtual ~LocalParameterServer();
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </constructors-destructor>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <LocalParameterServer-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		/*! Starts serving the master api in a port chosen by the operating system. */
+		bool start();
+		void stop();
+		/*! Uri that must be given to ros::init as master (__master:=uri). */
+		std::string getURI() const;
+
+		/*! Loads the parameters of the yaml file into the namespace (the existing parameters are only replaced if overwrite_existing_parameters is true). */
+		bool loadYAML(const std::string& filename, const std::string& parameters_namespace, bool overwrite_existing_parameters = true);
+		void setParameter(const std::string& key, const XmlRpc::XmlRpcValue& value);
+		bool getParameter(const std::string& key, XmlRpc::XmlRpcValue& value);
+		bool hasParameter(const std::string& key);
+		bool deleteParameter(const std::string& key);
+		/*! Same search as the ros master: looks for the first name of the key in the namespace and in its parents (returns the full key in the namespace in which it was found). */
+		bool searchParameter(const std::string& search_namespace, const std::string& key, std::string& found_key);
+		std::vector<std::string> getParameterNames();
+
+		static bool s_convertYAMLNode(const YAML::Node& yaml_node, XmlRpc::XmlRpcValue& value);
+		/*! Adds the parameters of source to destination, merging the namespaces that exist in both. */
+		static void s_mergeParameters(XmlRpc::XmlRpcValue& destination, XmlRpc::XmlRpcValue& source, bool overwrite_existing_parameters);
+		static std::vector<std::string> s_splitKey(const std::string& key);
+		static XmlRpc::XmlRpcValue s_createEmptyStruct();
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </LocalParameterServer-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+	// ========================================================================   </public-section>  ===========================================================================
+
+	// ========================================================================   <protected-section>   ========================================================================
+	protected:
+		class MasterMethod : public XmlRpc::XmlRpcServerMethod {
+			public:
+				MasterMethod(const std::string& name, XmlRpc::XmlRpcServer* server, const MethodFunction& function) : XmlRpc::XmlRpcServerMethod(name, server), function_(function) {}
+				virtual void execute(XmlRpc::XmlRpcValue& params, XmlRpc::XmlRpcValue& result) { function_(params, result); }
+			protected:
+				MethodFunction function_;
+		};
+
+		void registerMethods();
+		void addMethod(const std::string& name, const MethodFunction& function);
+		/*! Returns nullptr if the parameter does not exist (must be called with parameters_mutex_ locked). */
+		XmlRpc::XmlRpcValue* findParameter(const std::vector<std::string>& key_names);
+		void collectParameterNames(XmlRpc::XmlRpcValue& parameters, const std::string& parameters_namespace, std::vector<std::string>& parameter_names);
+		static void s_setResponse(XmlRpc::XmlRpcValue& result, int status_code, const std::string& status_message, const XmlRpc::XmlRpcValue& value);
+
+		XmlRpc::XmlRpcServer server_;
+		std::vector< std::unique_ptr<MasterMethod> > methods_; // must be destroyed before server_
+		std::thread server_thread_;
+		std::atomic<bool> server_running_;
+		int port_;
+		XmlRpc::XmlRpcValue parameters_;
+		std::mutex parameters_mutex_;
+	// ========================================================================   </protected-section>  ========================================================================
+};
+
+} /* namespace dynamic_robot_localization */
@@ -0,0 +1,97 @@
+#pragma once
+
+/**\file memory_usage.h
+ * \brief Accounting of the memory used by the modules of the localization pipeline
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>  <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// std includes
+#include <cstddef>
+#include <memory>
+#include <unordered_set>
+#include <vector>
+
+// PCL includes
+#include <pcl/point_cloud.h>
+#include <pcl/search/kdtree.h>
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+namespace dynamic_robot_localization {
+// ##############################################################################   MemoryUsage   ###########################################################################
+/**
+ * \brief Accumulates the estimated memory of the objects reported by the modules, counting only once the objects that are shared between modules
+ * (such as the reference point cloud, its k-d tree and the caches shared by matchers with the same configuration).
+ * The estimates use the capacity of the containers and the layout of the FLANN k-d trees, and ignore the overhead of the memory allocator.
+ */
+class MemoryUsage {
+	// ========================================================================   <public-section>   ===========================================================================
+	public:
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <usings>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		using Ptr = std::shared_ptr< MemoryUsage >;
+		using ConstPtr = std::shared_ptr< const MemoryUsage >;
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </usings>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <constructors-destructor>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		MemoryUsage() : total_bytes_(0) {}
+		virtual ~MemoryUsage() {}
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </constructors-destructor>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <MemoryUsage-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		/*! Returns true if the object was not accounted yet (the caller should then report its bytes with addBytes). */
+		inline bool addObject(const void* object) { return object != nullptr && accounted_objects_.insert(object).second; }
+		inline size_t addBytes(size_t bytes) { total_bytes_ += bytes; return bytes; }
+		/*! @return number of bytes added to the total (0 if the object was already accounted) */
+		inline size_t addBytes(const void* object, size_t bytes) { return addObject(object) ? addBytes(bytes) : 0; }
+
+		template <typename PointT>
+		size_t addPointCloud(const pcl::PointCloud<PointT>* pointcloud) { return pointcloud ? addBytes(pointcloud, s_getPointCloudBytes(*pointcloud)) : 0; }
+
+		/*! Accounts the FLANN index of the k-d tree (the point cloud used to build it is accounted separately). */
+		template <typename PointT>
+		size_t addKdTree(const pcl::search::KdTree<PointT>* search_method) {
+			if (!search_method || !search_method->getInputCloud()) { return 0; }
+			size_t number_of_points = search_method->getIndices() ? search_method->getIndices()->size() : search_method->getInputCloud()->size();
+			return addBytes(search_method, s_estimateKdTreeBytes(number_of_points));
+		}
+
+		inline void clear() { accounted_objects_.clear(); total_bytes_ = 0; }
+
+		template <typename PointT>
+		static size_t s_getPointCloudBytes(const pcl::PointCloud<PointT>& pointcloud) { return sizeof(pcl::PointCloud<PointT>) + pointcloud.points.capacity() * sizeof(PointT); }
+
+		template <typename T, typename Allocator>
+		static size_t s_getVectorBytes(const std::vector<T, Allocator>& vector) { return vector.capacity() * sizeof(T); }
+
+		/*! Estimate for the std::unordered_map / std::unordered_set nodes (value, next pointer and cached hash) and buckets. */
+		template <typename HashContainer>
+		static size_t s_getHashContainerBytes(const HashContainer& hash_container) {
+			return hash_container.bucket_count() * sizeof(void*) + hash_container.size() * (sizeof(typename HashContainer::value_type) + sizeof(void*) + sizeof(size_t));
+		}
+
+		/*! Estimate for a FLANN KDTreeSingleIndex with leafs of 15 points, including the copy of the points coordinates and the indices mapping kept by pcl::KdTreeFLANN. */
+		static size_t s_estimateKdTreeBytes(size_t number_of_points, size_t number_of_dimensions = 3);
+
+		/*! Resident set size of the process (0 if /proc/self/statm is not available). */
+		static size_t s_getProcessResidentBytes();
+
+		static inline double s_convertBytesToMegabytes(size_t bytes) { return (double)bytes / (1024.0 * 1024.0); }
+		static inline size_t s_convertMegabytesToBytes(double megabytes) { return megabytes > 0.0 ? (size_t)(megabytes * 1024.0 * 1024.0) : 0; }
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </MemoryUsage-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <gets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		inline size_t getTotalBytes() const { return total_bytes_; }
+		inline size_t getNumberOfAccountedObjects() const { return accounted_objects_.size(); }
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </gets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+	// ========================================================================   </public-section>  ===========================================================================
+
+	// ========================================================================   <protected-section>   ========================================================================
+	protected:
+		std::unordered_set<const void*> accounted_objects_;
+		size_t total_bytes_;
+	// ========================================================================   </protected-section>  ========================================================================
+};
+
+} /* namespace dynamic_robot_localization */
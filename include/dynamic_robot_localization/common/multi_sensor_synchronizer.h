@@ -0,0 +1,310 @@
+#pragma once
+
+/**\file multi_sensor_synchronizer.h
+ * \brief Thread safe per sensor bounded queues that group the scans of several sensors into sets with close timestamps
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>  <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// std includes
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+namespace dynamic_robot_localization {
+// ##########################################################################   MultiSensorSynchronizer   ##########################################################################
+/**
+ * \brief Groups the scans received from several sensors (one queue per sensor, filled by the subscriber callbacks) into synchronized sets consumed by a single thread.
+ * A set is built when all sensors have queued scans, using as anchor the oldest scan that can still be matched with the newest front scan of the other sensors,
+ * and contains the scans with timestamps inside [anchor, anchor + synchronization_window] (all of them or only the latest of each sensor, depending on the merge policy).
+ * If a sensor stops publishing, a set with only the available sensors is built after the maximum wait time elapses since the arrival of the oldest queued scan.
+ * Each discarded scan is counted in the statistics of its sensor with the reason for being dropped.
+ */
+template <typename T>
+class MultiSensorSynchronizer {
+	// ========================================================================   <public-section>   ===========================================================================
+	public:
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <usings>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		using Ptr = std::shared_ptr< MultiSensorSynchronizer<T> >;
+		using ConstPtr = std::shared_ptr< const MultiSensorSynchronizer<T> >;
+		using Clock = std::chrono::steady_clock;
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </usings>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <enums>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		enum MergePolicy {
+			LatestPerSensor,	// the older scans of a sensor inside the window are dropped as SupersededByNewerScan
+			AllWithinWindow
+		};
+
+		enum DropReason {
+			QueueOverflow,						// the queue of the sensor was full (the oldest scan is dropped)
+			OlderThanLastSynchronizedSet,		// the scan arrived after a set with newer scans was already built
+			OutsideSynchronizationWindow,		// no scans of the other sensors were received close enough to the scan
+			SupersededByNewerScan,				// a newer scan of the same sensor was selected for the set (LatestPerSensor policy)
+			NumberOfDropReasons
+		};
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </enums>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <structs>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		struct SensorStatistics {
+			SensorStatistics() : number_of_received_elements(0), number_of_synchronized_elements(0) { std::fill(number_of_dropped_elements, number_of_dropped_elements + NumberOfDropReasons, 0); }
+			size_t number_of_received_elements;
+			size_t number_of_synchronized_elements;
+			size_t number_of_dropped_elements[NumberOfDropReasons];
+		};
+
+		struct SynchronizedSet {
+			std::vector<T> elements;
+			std::vector<size_t> sensor_indexes;		// sensor of each element
+			std::uint64_t timestamp_ns;				// timestamp of the newest element
+			size_t number_of_sensors;				// number of sensors with elements in the set
+		};
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </structs>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <constructors-destructor>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		explicit MultiSensorSynchronizer(size_t number_of_sensors = 1, size_t queue_capacity = 1) :
+			queue_capacity_(queue_capacity > 0 ? queue_capacity : 1), synchronization_window_ns_(0), maximum_wait_time_(std::chrono::milliseconds(100)), merge_policy_(LatestPerSensor),
+			last_synchronized_set_timestamp_ns_(0), number_of_synchronized_sets_(0), number_of_incomplete_sets_(0), shutdown_(false) {
+			setNumberOfSensors(number_of_sensors);
+		}
+		virtual ~MultiSensorSynchronizer() { shutdown(); }
+		MultiSensorSynchronizer(const MultiSensorSynchronizer&) = delete;
+		MultiSensorSynchronizer& operator=(const MultiSensorSynchronizer&) = delete;
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </constructors-destructor>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <MultiSensorSynchronizer-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		/*! @return false if the element or an older one had to be dropped or if the synchronizer was shutdown */
+		bool push(size_t sensor_index, const T& element, std::uint64_t timestamp_ns) {
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				if (shutdown_ || sensor_index >= queues_.size()) { return false; }
+
+				SensorStatistics& sensor_statistics = sensors_statistics_[sensor_index];
+				++sensor_statistics.number_of_received_elements;
+				if (number_of_synchronized_sets_ > 0 && timestamp_ns <= last_synchronized_set_timestamp_ns_) {
+					++sensor_statistics.number_of_dropped_elements[OlderThanLastSynchronizedSet];
+					return false;
+				}
+
+				std::deque<QueuedElement>& queue = queues_[sensor_index];
+				bool element_dropped = false;
+				while (queue.size() >= queue_capacity_) {
+					queue.pop_front();
+					++sensor_statistics.number_of_dropped_elements[QueueOverflow];
+					element_dropped = true;
+				}
+
+				// sorted by timestamp (the scans of a sensor can arrive out of order when they are relayed)
+				QueuedElement queued_element;
+				queued_element.element = element;
+				queued_element.timestamp_ns = timestamp_ns;
+				queued_element.arrival_time = Clock::now();
+				typename std::deque<QueuedElement>::iterator position = queue.end();
+				while (position != queue.begin() && (position - 1)->timestamp_ns > timestamp_ns) { --position; }
+				queue.insert(position, queued_element);
+
+				if (element_dropped) {
+					condition_variable_.notify_one();
+					return false;
+				}
+			}
+			condition_variable_.notify_one();
+			return true;
+		}
+
+		/*! Blocks until a synchronized set is available. @return false if the synchronizer was shutdown */
+		bool pop(SynchronizedSet& synchronized_set) {
+			std::unique_lock<std::mutex> lock(mutex_);
+			while (true) {
+				if (shutdown_) { return false; }
+				if (buildSynchronizedSet(synchronized_set, false)) { return true; }
+
+				Clock::time_point oldest_arrival_time;
+				if (!getOldestArrivalTime(oldest_arrival_time) || maximum_wait_time_.count() <= 0) {
+					condition_variable_.wait(lock);
+				} else {
+					Clock::time_point deadline = oldest_arrival_time + maximum_wait_time_;
+					if (Clock::now() >= deadline) {
+						if (buildSynchronizedSet(synchronized_set, true)) { return true; }
+					} else {
+						condition_variable_.wait_until(lock, deadline);
+					}
+				}
+			}
+		}
+
+		void shutdown() {
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				shutdown_ = true;
+				clearQueues();
+			}
+			condition_variable_.notify_all();
+		}
+
+		void restart() {
+			std::lock_guard<std::mutex> lock(mutex_);
+			shutdown_ = false;
+		}
+
+		void clear() {
+			std::lock_guard<std::mutex> lock(mutex_);
+			clearQueues();
+		}
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </MultiSensorSynchronizer-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <gets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		size_t getNumberOfSensors() { std::lock_guard<std::mutex> lock(mutex_); return queues_.size(); }
+		size_t getQueueSize(size_t sensor_index) { std::lock_guard<std::mutex> lock(mutex_); return sensor_index < queues_.size() ? queues_[sensor_index].size() : 0; }
+		SensorStatistics getSensorStatistics(size_t sensor_index) { std::lock_guard<std::mutex> lock(mutex_); return sensor_index < sensors_statistics_.size() ? sensors_statistics_[sensor_index] : SensorStatistics(); }
+		size_t getNumberOfSynchronizedSets() { std::lock_guard<std::mutex> lock(mutex_); return number_of_synchronized_sets_; }
+		size_t getNumberOfIncompleteSets() { std::lock_guard<std::mutex> lock(mutex_); return number_of_incomplete_sets_; }
+		bool isShutdown() { std::lock_guard<std::mutex> lock(mutex_); return shutdown_; }
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </gets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <sets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		/*! Clears the queues and the statistics */
+		void setNumberOfSensors(size_t number_of_sensors) {
+			std::lock_guard<std::mutex> lock(mutex_);
+			queues_.clear();
+			queues_.resize(number_of_sensors);
+			sensors_statistics_.clear();
+			sensors_statistics_.resize(number_of_sensors);
+			resetStatisticsCounters();
+		}
+
+		void setQueueCapacity(size_t queue_capacity) { std::lock_guard<std::mutex> lock(mutex_); queue_capacity_ = (queue_capacity > 0 ? queue_capacity : 1); }
+		void setSynchronizationWindow(std::uint64_t synchronization_window_ns) { std::lock_guard<std::mutex> lock(mutex_); synchronization_window_ns_ = synchronization_window_ns; }
+		/*! If <= 0, the sets are only built when all sensors have scans */
+		void setMaximumWaitTime(std::chrono::nanoseconds maximum_wait_time) { std::lock_guard<std::mutex> lock(mutex_); maximum_wait_time_ = maximum_wait_time; }
+		void setMergePolicy(MergePolicy merge_policy) { std::lock_guard<std::mutex> lock(mutex_); merge_policy_ = merge_policy; }
+
+		void resetStatistics() {
+			std::lock_guard<std::mutex> lock(mutex_);
+			std::fill(sensors_statistics_.begin(), sensors_statistics_.end(), SensorStatistics());
+			resetStatisticsCounters();
+		}
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </sets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+	// ========================================================================   </public-section>  ===========================================================================
+
+	// ========================================================================   <protected-section>   ========================================================================
+	protected:
+		struct QueuedElement {
+			T element;
+			std::uint64_t timestamp_ns;
+			Clock::time_point arrival_time;
+		};
+
+		/*! Must be called with the mutex locked. */
+		bool buildSynchronizedSet(SynchronizedSet& synchronized_set, bool allow_incomplete_set) {
+			// drop the scans that are too old to be matched with the newest front scan (until the front scans of all sensors are inside the window)
+			std::uint64_t newest_front_timestamp_ns = 0;
+			while (true) {
+				size_t number_of_sensors_with_data = 0;
+				newest_front_timestamp_ns = 0;
+				for (size_t i = 0; i < queues_.size(); ++i) {
+					if (!queues_[i].empty()) {
+						newest_front_timestamp_ns = std::max(newest_front_timestamp_ns, queues_[i].front().timestamp_ns);
+						++number_of_sensors_with_data;
+					}
+				}
+				if (number_of_sensors_with_data == 0 || (number_of_sensors_with_data < queues_.size() && !allow_incomplete_set)) { return false; }
+
+				bool dropped_elements = false;
+				for (size_t i = 0; i < queues_.size(); ++i) {
+					while (!queues_[i].empty() && queues_[i].front().timestamp_ns + synchronization_window_ns_ < newest_front_timestamp_ns) {
+						queues_[i].pop_front();
+						++sensors_statistics_[i].number_of_dropped_elements[OutsideSynchronizationWindow];
+						dropped_elements = true;
+					}
+				}
+				if (!dropped_elements) { break; }
+			}
+
+			std::uint64_t anchor_timestamp_ns = newest_front_timestamp_ns;
+			for (size_t i = 0; i < queues_.size(); ++i) {
+				if (!queues_[i].empty()) { anchor_timestamp_ns = std::min(anchor_timestamp_ns, queues_[i].front().timestamp_ns); }
+			}
+			std::uint64_t window_end_timestamp_ns = anchor_timestamp_ns + synchronization_window_ns_;
+
+			synchronized_set.elements.clear();
+			synchronized_set.sensor_indexes.clear();
+			synchronized_set.timestamp_ns = 0;
+			synchronized_set.number_of_sensors = 0;
+			for (size_t i = 0; i < queues_.size(); ++i) {
+				std::deque<QueuedElement>& queue = queues_[i];
+				size_t number_of_elements_in_window = 0;
+				while (number_of_elements_in_window < queue.size() && queue[number_of_elements_in_window].timestamp_ns <= window_end_timestamp_ns) { ++number_of_elements_in_window; }
+				if (number_of_elements_in_window == 0) { continue; }
+
+				size_t first_selected_element = 0;
+				if (merge_policy_ == LatestPerSensor) {
+					first_selected_element = number_of_elements_in_window - 1;
+					sensors_statistics_[i].number_of_dropped_elements[SupersededByNewerScan] += first_selected_element;
+				}
+
+				for (size_t j = first_selected_element; j < number_of_elements_in_window; ++j) {
+					synchronized_set.elements.push_back(queue[j].element);
+					synchronized_set.sensor_indexes.push_back(i);
+					synchronized_set.timestamp_ns = std::max(synchronized_set.timestamp_ns, queue[j].timestamp_ns);
+				}
+				sensors_statistics_[i].number_of_synchronized_elements += number_of_elements_in_window - first_selected_element;
+				++synchronized_set.number_of_sensors;
+				queue.erase(queue.begin(), queue.begin() + number_of_elements_in_window);
+			}
+
+			last_synchronized_set_timestamp_ns_ = synchronized_set.timestamp_ns;
+			++number_of_synchronized_sets_;
+			if (synchronized_set.number_of_sensors < queues_.size()) { ++number_of_incomplete_sets_; }
+			return true;
+		}
+
+		/*! Must be called with the mutex locked. @return false if there are no queued elements */
+		bool getOldestArrivalTime(Clock::time_point& oldest_arrival_time) {
+			bool found_element = false;
+			for (size_t i = 0; i < queues_.size(); ++i) {
+				for (size_t j = 0; j < queues_[i].size(); ++j) {
+					if (!found_element || queues_[i][j].arrival_time < oldest_arrival_time) {
+						oldest_arrival_time = queues_[i][j].arrival_time;
+						found_element = true;
+					}
+				}
+			}
+			return found_element;
+		}
+
+		void clearQueues() {
+			for (size_t i = 0; i < queues_.size(); ++i) { queues_[i].clear(); }
+		}
+
+		void resetStatisticsCounters() {
+			last_synchronized_set_timestamp_ns_ = 0;
+			number_of_synchronized_sets_ = 0;
+			number_of_incomplete_sets_ = 0;
+		}
+
+		std::vector< std::deque<QueuedElement> > queues_;
+		std::vector< SensorStatistics > sensors_statistics_;
+		size_t queue_capacity_;
+		std::uint64_t synchronization_window_ns_;
+		std::chrono::nanoseconds maximum_wait_time_;
+		MergePolicy merge_policy_;
+		std::uint64_t last_synchronized_set_timestamp_ns_;
+		size_t number_of_synchronized_sets_;
+		size_t number_of_incomplete_sets_;
+		bool shutdown_;
+		std::mutex mutex_;
+		std::condition_variable condition_variable_;
+	// ========================================================================   </protected-section>  ========================================================================
+};
+
+} /* namespace dynamic_robot_localization */
@@ -0,0 +1,127 @@
+#pragma once
+
+/**\file parallel_cluster_extraction.h
+ * \brief Cluster extraction with a concurrent union-find over the neighbors graph of the point cloud
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>  <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// std includes
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// PCL includes
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+#include <pcl/PointIndices.h>
+#include <pcl/common/point_tests.h>
+#include <pcl/search/kdtree.h>
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+namespace dynamic_robot_localization {
+// #######################################################################   ParallelClusterExtraction   #######################################################################
+/**
+ * \brief Extracts the connected components of the neighbors graph of a point cloud (or of a subset of its points).
+ * The neighbors of each point are searched in parallel (radius search if the search radius is > 0, or k nearest neighbors search otherwise)
+ * and the edges are merged in a lock free union-find (union by lower index with path halving), so the result does not depend on the number of threads.
+ * The search method is only used for queries, which allows to reuse the k-d tree that was already built for the point cloud.
+ * Two seed points are merged when the neighbor and propagation predicates accept the edge between them (evaluated from either end).
+ * Points that fail the seed predicate do not grow clusters: they are attached to the cluster of their closest seed neighbor that accepts them (or discarded if there is none).
+ * Clusters with a number of points outside [min_cluster_size, max_cluster_size] are discarded and the others are sorted by decreasing size.
+ */
+template <typename PointT>
+class ParallelClusterExtraction {
+	// ========================================================================   <public-section>   ===========================================================================
+	public:
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <usings>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		using Ptr = std::shared_ptr< ParallelClusterExtraction<PointT> >;
+		using ConstPtr = std::shared_ptr< const ParallelClusterExtraction<PointT> >;
+
+		/*! Returns true if the neighbor can be added to the cluster of the seed point. */
+		using NeighborPredicate = std::function< bool(const PointT& seed_point, const PointT& neighbor_point) >;
+		/*! Returns true if the neighbor (which is also a seed) can continue growing the cluster of the seed point. */
+		using PropagationPredicate = std::function< bool(const PointT& seed_point, const PointT& neighbor_point) >;
+		/*! Returns true if the point can grow its cluster. */
+		using SeedPredicate = std::function< bool(const PointT& point) >;
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </usings>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <constructors-destructor>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		ParallelClusterExtraction();
+		virtual ~ParallelClusterExtraction() {}
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </constructors-destructor>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <ParallelClusterExtraction-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		/*! The search_method must have the pointcloud as input cloud (without indices). If indices is null, all the points are clustered.
+		 * The clusters_out have indices of the pointcloud, sorted in ascending order. */
+		void extract(const typename pcl::PointCloud<PointT>::Ptr& pointcloud, const pcl::IndicesPtr& indices, const typename pcl::search::KdTree<PointT>::Ptr& search_method,
+				std::vector<pcl::PointIndices>& clusters_out);
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </ParallelClusterExtraction-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <gets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		inline double getSearchRadius() const { return search_radius_; }
+		inline int getNumberOfNeighbors() const { return number_of_neighbors_; }
+		inline size_t getMinClusterSize() const { return min_cluster_size_; }
+		inline size_t getMaxClusterSize() const { return max_cluster_size_; }
+		inline int getNumberOfThreads() const { return number_of_threads_; }
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </gets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <sets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		/*! If > 0, the neighbors are searched within this radius (limited to number_of_neighbors if it is > 0). */
+		inline void setSearchRadius(double search_radius) { search_radius_ = search_radius; }
+		inline void setNumberOfNeighbors(int number_of_neighbors) { number_of_neighbors_ = number_of_neighbors; }
+		inline void setMinClusterSize(size_t min_cluster_size) { min_cluster_size_ = min_cluster_size; }
+		inline void setMaxClusterSize(size_t max_cluster_size) { max_cluster_size_ = max_cluster_size; }
+		/*! If <= 0, omp_get_max_threads() is used. */
+		inline void setNumberOfThreads(int number_of_threads) { number_of_threads_ = number_of_threads; }
+		inline void setNeighborPredicate(const NeighborPredicate& neighbor_predicate) { neighbor_predicate_ = neighbor_predicate; }
+		inline void setPropagationPredicate(const PropagationPredicate& propagation_predicate) { propagation_predicate_ = propagation_predicate; }
+		inline void setSeedPredicate(const SeedPredicate& seed_predicate) { seed_predicate_ = seed_predicate; }
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </sets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+	// ========================================================================   </public-section>  ===========================================================================
+
+	// ========================================================================   <protected-section>   ========================================================================
+	protected:
+		struct SearchBuffers {
+			std::vector<int> search_indices;
+			std::vector<float> search_sqr_distances;
+		};
+
+		int findRoot(int element);
+		void mergeSets(int first_element, int second_element);
+		int searchNeighbors(const PointT& point, SearchBuffers& search_buffers, const typename pcl::search::KdTree<PointT>::Ptr& search_method);
+
+		double search_radius_;
+		int number_of_neighbors_;
+		size_t min_cluster_size_;
+		size_t max_cluster_size_;
+		int number_of_threads_;
+		NeighborPredicate neighbor_predicate_;
+		PropagationPredicate propagation_predicate_;
+		SeedPredicate seed_predicate_;
+
+		std::unique_ptr< std::atomic<int>[] > parents_; // std::atomic is not movable, so it can not be stored in a std::vector that is resized
+		size_t parents_capacity_;
+		std::vector<SearchBuffers> threads_search_buffers_;
+		std::vector<int> points_local_indices_; // -1 for the points of the cloud that are not being clustered
+		std::vector<char> seed_points_;
+		std::vector<int> attached_points_;
+		std::vector<int> roots_clusters_;
+	// ========================================================================   </protected-section>  ========================================================================
+};
+
+} /* namespace dynamic_robot_localization */
+
+
+#ifdef DRL_NO_PRECOMPILE
+#include <dynamic_robot_localization/common/impl/parallel_cluster_extraction.hpp>
+#endif
@@ -2,12 +2,7 @@
 
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>  <includes> <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
-#ifdef _WIN32   // Windows system specific
-	#include <windows.h>
-#else           // Unix based system specific
-	#include <sys/time.h>
-#endif
-
+#include <chrono>
 #include <cstdlib>
 #include <sstream>
 #include <string>
@@ -38,14 +33,8 @@ class PerformanceTimer {
 		double elapsedTimeMicroSec;               // starting time in micro-second
 		bool stopped;                             // stop flag
 
-		#ifdef _WIN32
-			LARGE_INTEGER frequencyWin;           // ticks per second
-			LARGE_INTEGER startCountWin;
-			LARGE_INTEGER endCountWin;
-		#else
-			timeval startCount;
-			timeval endCount;
-		#endif
+		std::chrono::steady_clock::time_point startCount;   // monotonic clock (not affected by system time adjustments)
+		std::chrono::steady_clock::time_point endCount;
 
 		void calculateElapsedTimeMicroSec();
 };
@@ -0,0 +1,133 @@
+#pragma once
+
+/**\file pointcloud2_ingestion.h
+ * \brief Decoder of sensor_msgs::PointCloud2 that filters the points while reading the message buffer and materializes only the valid ones into pooled point clouds
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>  <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// std includes
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+// ROS includes
+#include <ros/ros.h>
+#include <sensor_msgs/PointCloud2.h>
+#include <sensor_msgs/PointField.h>
+
+// PCL includes
+#include <pcl/conversions.h>
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+#include <pcl/filters/filter.h>
+#include <pcl_conversions/pcl_conversions.h>
+
+// external libs includes
+#include <Eigen/Core>
+
+// project includes
+#include <dynamic_robot_localization/common/memory_usage.h>
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+namespace dynamic_robot_localization {
+// #########################################################################   PointCloud2Ingestion   #########################################################################
+/**
+ * \brief Converts sensor_msgs::PointCloud2 messages to pcl::PointCloud<PointT> reading the xyz coordinates directly from the message buffer
+ * and copying the remaining fields only for the points that are finite, inside / outside the crop box and (optionally) the first of their voxel.
+ * This avoids the full copy of pcl::fromROSMsg followed by the copy of pcl::removeNaNFromPointCloud, and the output point clouds are taken from a pool
+ * (a point cloud is only reused after the localization pipeline releases all its references, which avoids reallocating the points of large scans).
+ * The mapping between the message fields and the PointT fields is cached and only recomputed when the layout of the messages changes.
+ * The crop box and the voxel grid are applied in the frame of the message (usually the sensor frame).
+ * Not thread safe (each ingestion thread should have its own instance).
+ */
+template <typename PointT>
+class PointCloud2Ingestion {
+	// ========================================================================   <public-section>   ===========================================================================
+	public:
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <usings>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		using Ptr = std::shared_ptr< PointCloud2Ingestion<PointT> >;
+		using ConstPtr = std::shared_ptr< const PointCloud2Ingestion<PointT> >;
+		using VoxelKey = std::uint64_t;
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </usings>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <constructors-destructor>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		explicit PointCloud2Ingestion(size_t pool_size = 4);
+		virtual ~PointCloud2Ingestion() {}
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </constructors-destructor>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <PointCloud2Ingestion-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		void setupConfigurationFromParameterServer(ros::NodeHandlePtr& private_node_handle, const std::string& configuration_namespace);
+
+		/*! Decodes the selected points of the message into a point cloud from the pool (falls back to pcl::fromROSMsg if the message does not have float xyz fields). */
+		typename pcl::PointCloud<PointT>::Ptr ingest(const sensor_msgs::PointCloud2& pointcloud_msg);
+		void clearPool() { pointclouds_pool_.clear(); }
+		/*! Accounts the point clouds of the pool (the one returned by the last ingest may also be used by the localization pipeline). */
+		size_t accountMemoryUsage(MemoryUsage& memory_usage) const;
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </PointCloud2Ingestion-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <gets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		inline bool isDirectDecodingEnabled() const { return direct_decoding_enabled_; }
+		inline bool isCropBoxEnabled() const { return crop_box_enabled_; }
+		inline const Eigen::Vector3f& getCropBoxMin() const { return crop_box_min_; }
+		inline const Eigen::Vector3f& getCropBoxMax() const { return crop_box_max_; }
+		inline bool getCropBoxInvertSelection() const { return crop_box_invert_selection_; }
+		inline float getVoxelGridLeafSize() const { return voxel_grid_leaf_size_; }
+		inline size_t getPoolSize() const { return pool_size_; }
+		inline size_t getNumberOfPointsInLastMsg() const { return number_of_points_in_last_msg_; }
+		inline size_t getNumberOfPointsInLastPointCloud() const { return number_of_points_in_last_pointcloud_; }
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </gets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <sets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		inline void setDirectDecodingEnabled(bool direct_decoding_enabled) { direct_decoding_enabled_ = direct_decoding_enabled; }
+		inline void setCropBox(const Eigen::Vector3f& crop_box_min, const Eigen::Vector3f& crop_box_max, bool invert_selection = false) { crop_box_min_ = crop_box_min; crop_box_max_ = crop_box_max; crop_box_invert_selection_ = invert_selection; crop_box_enabled_ = true; }
+		inline void setCropBoxEnabled(bool crop_box_enabled) { crop_box_enabled_ = crop_box_enabled; }
+		inline void setVoxelGridLeafSize(float voxel_grid_leaf_size) { voxel_grid_leaf_size_ = voxel_grid_leaf_size; inverse_voxel_grid_leaf_size_ = (voxel_grid_leaf_size > 0.0f ? 1.0f / voxel_grid_leaf_size : 0.0f); }
+		inline void setPoolSize(size_t pool_size) { pool_size_ = pool_size; if (pointclouds_pool_.size() > pool_size) { pointclouds_pool_.resize(pool_size); } }
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </sets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+	// ========================================================================   </public-section>  ===========================================================================
+
+	// ========================================================================   <protected-section>   ========================================================================
+	protected:
+		inline VoxelKey computeVoxelKey(float x, float y, float z) const {
+			return ((VoxelKey)((int)std::floor(x * inverse_voxel_grid_leaf_size_) & 0x1FFFFF) << 42) | ((VoxelKey)((int)std::floor(y * inverse_voxel_grid_leaf_size_) & 0x1FFFFF) << 21) | (VoxelKey)((int)std::floor(z * inverse_voxel_grid_leaf_size_) & 0x1FFFFF);
+		}
+
+		bool updateFieldMapping(const sensor_msgs::PointCloud2& pointcloud_msg);
+		typename pcl::PointCloud<PointT>::Ptr getPointCloudFromPool();
+
+		bool direct_decoding_enabled_;
+		bool crop_box_enabled_;
+		Eigen::Vector3f crop_box_min_;
+		Eigen::Vector3f crop_box_max_;
+		bool crop_box_invert_selection_;
+		float voxel_grid_leaf_size_;
+		float inverse_voxel_grid_leaf_size_;
+		size_t pool_size_;
+		std::vector< typename pcl::PointCloud<PointT>::Ptr > pointclouds_pool_;
+		std::vector<sensor_msgs::PointField> field_mapping_msg_fields_;
+		std::uint32_t field_mapping_point_step_;
+		bool field_mapping_has_xyz_;
+		std::uint32_t offset_x_;
+		std::uint32_t offset_y_;
+		std::uint32_t offset_z_;
+		pcl::MsgFieldMap field_mapping_;
+		std::unordered_set<VoxelKey> occupied_voxels_;
+		size_t number_of_points_in_last_msg_;
+		size_t number_of_points_in_last_pointcloud_;
+	// ========================================================================   </protected-section>  ========================================================================
+};
+
+} /* namespace dynamic_robot_localization */
+
+
+#ifdef DRL_NO_PRECOMPILE
+#include <dynamic_robot_localization/common/impl/pointcloud2_ingestion.hpp>
+#endif
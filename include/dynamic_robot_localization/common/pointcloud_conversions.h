@@ -37,6 +37,7 @@
 #include <Eigen/Geometry>
 
 // project includes
+#include <dynamic_robot_localization/common/async_cloud_publisher.h>
 #include <dynamic_robot_localization/common/math_utils.h>
 #include <dynamic_robot_localization/common/pointcloud_utils.h>
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
@@ -58,6 +59,10 @@ bool fromROSMsg(const nav_msgs::OccupancyGrid& occupancy_grid, pcl::PointCloud<P
 template <typename PointT>
 bool publishPointCloud(pcl::PointCloud<PointT>& pointcloud, ros::Publisher& publisher, const std::string& frame_id, bool publish_pointcloud_only_if_there_is_subscribers, const std::string& point_cloud_name_for_logging);
 
+/*! Converts and publishes the point cloud in the AsyncCloudPublisher thread (the point cloud must not be changed after this call). */
+template <typename PointT>
+bool publishPointCloudAsynchronously(const typename pcl::PointCloud<PointT>::ConstPtr& pointcloud, const ros::Publisher& publisher, const std::string& frame_id, bool publish_pointcloud_only_if_there_is_subscribers, const std::string& point_cloud_name_for_logging);
+
 template <typename PointT>
 size_t flipPointCloudNormalsUsingOccpancyGrid(const nav_msgs::OccupancyGrid& occupancy_grid, pcl::PointCloud<PointT>& pointcloud, int search_k, float search_radius, bool show_occupancy_grid_pointcloud = false);
 
@@ -9,6 +9,7 @@
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>  <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 // std includes
+#include <algorithm>
 #include <limits>
 #include <vector>
 
@@ -43,6 +44,9 @@ void colorizePointCloudClusters(const pcl::PointCloud<PointT>& pointcloud, const
 template <typename PointT>
 void extractPointCloudClusters(const pcl::PointCloud<PointT>& pointcloud, const std::vector<pcl::PointIndices>& cluster_indices, const std::vector<size_t>& selected_clusters, pcl::PointCloud<PointT>& pointcloud_out);
 
+/*! Merges the indices of the selected clusters, sorted in ascending order (keeps the order of the points in the cloud). */
+void extractPointCloudClustersIndices(const std::vector<pcl::PointIndices>& cluster_indices, const std::vector<size_t>& selected_clusters, std::vector<int>& indices_out);
+
 template <typename PointT>
 float distanceSquaredToOrigin(const PointT& point);
 
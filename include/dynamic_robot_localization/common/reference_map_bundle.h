@@ -0,0 +1,98 @@
+#pragma once
+
+/**\file reference_map_bundle.h
+ * \brief Versioned binary cache of a preprocessed reference map (points with normals / curvature and keypoints) that is loaded without parsing
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>  <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// std includes
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+
+// linux includes
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// ROS includes
+#include <ros/ros.h>
+
+// PCL includes
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+namespace dynamic_robot_localization {
+// ##########################################################################   ReferenceMapBundle   ##########################################################################
+/**
+ * \brief Binary file with the reference point cloud after the filters, normal / curvature estimation and keypoint detection.
+ * The file starts with a fixed size header (magic, format version, point size, hashes and section offsets) followed by the raw points of each section aligned to 64 bytes.
+ * A bundle is only accepted if the hash of the source map file and the hash of the configuration used to preprocess it match the ones stored in the header.
+ * The sections are read directly into the points of the clouds (pcl::PointCloud owns its points, so a memory map of the file could not be used without copying them).
+ */
+template <typename PointT>
+class ReferenceMapBundle {
+	// ========================================================================   <public-section>   ===========================================================================
+	public:
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <usings>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		using Ptr = std::shared_ptr< ReferenceMapBundle<PointT> >;
+		using ConstPtr = std::shared_ptr< const ReferenceMapBundle<PointT> >;
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </usings>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <constants>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		static const std::uint32_t s_format_version = 1;
+		static const std::uint64_t s_sections_alignment = 64;
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </constants>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <structs>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		struct BundleHeader {
+			char magic[8];
+			std::uint32_t format_version;
+			std::uint32_t point_size;
+			std::uint64_t source_hash;
+			std::uint64_t configuration_hash;
+			std::uint64_t number_of_points;
+			std::uint64_t points_offset;
+			std::uint64_t number_of_keypoints;
+			std::uint64_t keypoints_offset;
+			std::uint64_t file_size;
+		};
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </structs>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <constructors-destructor>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		ReferenceMapBundle() {}
+		virtual ~ReferenceMapBundle() {}
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </constructors-destructor>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <ReferenceMapBundle-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		static std::uint64_t s_computeHash(const void* data, size_t size_in_bytes, std::uint64_t seed = 14695981039346656037ULL);
+		static bool s_computeFileHash(const std::string& filename, std::uint64_t& hash);
+
+		static bool s_save(const std::string& filename, std::uint64_t source_hash, std::uint64_t configuration_hash, const pcl::PointCloud<PointT>& pointcloud, const pcl::PointCloud<PointT>& keypoints);
+		static bool s_load(const std::string& filename, std::uint64_t source_hash, std::uint64_t configuration_hash, pcl::PointCloud<PointT>& pointcloud, pcl::PointCloud<PointT>& keypoints);
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </ReferenceMapBundle-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+	// ========================================================================   </public-section>  ===========================================================================
+
+	// ========================================================================   <protected-section>   ========================================================================
+	protected:
+		static std::uint64_t s_computeAlignedOffset(std::uint64_t offset) { return ((offset + s_sections_alignment - 1) / s_sections_alignment) * s_sections_alignment; }
+		static void s_fillMagic(char magic[8]) { std::memcpy(magic, "DRLMAPB", 8); }
+		static bool s_writeSection(std::ofstream& file, const pcl::PointCloud<PointT>& pointcloud, std::uint64_t offset);
+		static bool s_readSection(std::ifstream& file, std::uint64_t offset, std::uint64_t number_of_points, pcl::PointCloud<PointT>& pointcloud);
+	// ========================================================================   </protected-section>  ========================================================================
+};
+
+} /* namespace dynamic_robot_localization */
+
+
+#ifdef DRL_NO_PRECOMPILE
+#include <dynamic_robot_localization/common/impl/reference_map_bundle.hpp>
+#endif
@@ -0,0 +1,173 @@
+#pragma once
+
+/**\file reference_map_publisher.h
+ * \brief Throttled publisher of reference point clouds that sends full snapshots only on subscription / on demand and voxel deltas in between
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>  <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// std includes
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+// ROS includes
+#include <ros/ros.h>
+#include <sensor_msgs/PointCloud2.h>
+
+// PCL includes
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+#include <pcl/pcl_macros.h>
+#include <pcl_conversions/pcl_conversions.h>
+
+// project includes
+#include <dynamic_robot_localization/common/configurable_object.h>
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+namespace dynamic_robot_localization {
+// ########################################################################   ReferenceMapPublisher   #########################################################################
+/**
+ * \brief Publishes a reference point cloud without serializing the whole map after every change.
+ * Full snapshots are published in the latched topic when the map is first published, when a subscriber connects, on demand (requestFullSnapshot) and periodically (if full_snapshot_period > 0).
+ * In between, when delta_voxel_size > 0, only the voxels whose points changed are published:
+ *   - <topic>_delta_updated -> all the points of the voxels that were added or whose points changed (clients should replace the contents of these voxels)
+ *   - <topic>_delta_removed -> centers of the voxels that no longer have points
+ * Publications are throttled by min_publish_period and max_bytes_per_second (the changes are accumulated until the next allowed publication).
+ */
+template <typename PointT>
+class ReferenceMapPublisher : public ConfigurableObject {
+	// ========================================================================   <public-section>   ===========================================================================
+	public:
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <usings>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		using Ptr = std::shared_ptr< ReferenceMapPublisher<PointT> >;
+		using ConstPtr = std::shared_ptr< const ReferenceMapPublisher<PointT> >;
+		using VoxelKey = std::uint64_t;
+
+		struct VoxelSignature {
+			std::uint32_t number_of_points = 0;
+			std::uint64_t points_hash = 0; // order independent sum of the hashes of the points positions
+
+			inline bool operator==(const VoxelSignature& other) const { return number_of_points == other.number_of_points && points_hash == other.points_hash; }
+			inline bool operator!=(const VoxelSignature& other) const { return !(*this == other); }
+		};
+
+		using VoxelSignatures = std::unordered_map< VoxelKey, VoxelSignature >;
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </usings>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <constructors-destructor>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		ReferenceMapPublisher() :
+			delta_voxel_size_(0.0),
+			full_snapshot_delta_ratio_(0.5),
+			full_snapshot_period_(0.0),
+			min_publish_period_(0.0),
+			max_bytes_per_second_(0.0),
+			available_bytes_(0.0),
+			reference_cloud_changed_(false),
+			full_snapshot_requested_(true),
+			full_snapshot_msg_outdated_(true) {}
+		virtual ~ReferenceMapPublisher() {}
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </constructors-destructor>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <ReferenceMapPublisher-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		/*! Loads the parameters with ros::param::search (starting in configuration_namespace + "reference_pointcloud_publisher/"), which allows the matchers to inherit the localization configuration. */
+		virtual void setupConfigurationFromParameterServer(ros::NodeHandlePtr& node_handle, ros::NodeHandlePtr& private_node_handle, const std::string& configuration_namespace);
+		void startPublishers(ros::NodeHandlePtr& node_handle);
+		void shutdownPublishers();
+
+		/*! Marks the reference point cloud as changed (the voxel deltas and the full snapshot msg are only computed when publishing). */
+		void setReferencePointCloud(const typename pcl::PointCloud<PointT>::ConstPtr& reference_cloud);
+
+		/*! Publishes the pending changes (or the requested full snapshot) if allowed by the throttling parameters (or if force is true).
+		 * Must be called from the thread that changes the reference point cloud.
+		 * @return true if a full snapshot or delta was published */
+		bool publishPendingChanges(const ros::Time& time_stamp, bool force = false);
+
+		inline void requestFullSnapshot() { full_snapshot_requested_ = true; }
+		inline bool hasPendingChanges() const { return reference_cloud_changed_ || full_snapshot_requested_; }
+
+		/*! True if the full snapshot topic is configured. */
+		inline bool isPublishing() const { return !full_snapshot_publisher_.getTopic().empty(); }
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </ReferenceMapPublisher-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <gets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		inline const std::string& getPublishTopic() const { return publish_topic_; }
+		inline const std::string& getPublishFrameId() const { return publish_frame_id_; }
+		inline double getDeltaVoxelSize() const { return delta_voxel_size_; }
+		inline double getFullSnapshotDeltaRatio() const { return full_snapshot_delta_ratio_; }
+		inline double getFullSnapshotPeriod() const { return full_snapshot_period_; }
+		inline double getMinPublishPeriod() const { return min_publish_period_; }
+		inline double getMaxBytesPerSecond() const { return max_bytes_per_second_; }
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </gets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <sets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		inline void setPublishTopic(const std::string& publish_topic) { publish_topic_ = publish_topic; }
+		/*! If not empty, overrides the frame_id of the published point clouds. */
+		inline void setPublishFrameId(const std::string& publish_frame_id) { publish_frame_id_ = publish_frame_id; }
+		inline void setDeltaVoxelSize(double delta_voxel_size) { delta_voxel_size_ = delta_voxel_size; published_voxels_.clear(); }
+		inline void setFullSnapshotDeltaRatio(double full_snapshot_delta_ratio) { full_snapshot_delta_ratio_ = full_snapshot_delta_ratio; }
+		inline void setFullSnapshotPeriod(double full_snapshot_period) { full_snapshot_period_ = full_snapshot_period; }
+		inline void setMinPublishPeriod(double min_publish_period) { min_publish_period_ = min_publish_period; }
+		inline void setMaxBytesPerSecond(double max_bytes_per_second) { max_bytes_per_second_ = max_bytes_per_second; }
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </sets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+	// ========================================================================   </public-section>  ===========================================================================
+
+	// ========================================================================   <protected-section>   ========================================================================
+	protected:
+		inline VoxelKey computeVoxelKey(const PointT& point) const {
+			int x = (int)std::floor(point.x / delta_voxel_size_);
+			int y = (int)std::floor(point.y / delta_voxel_size_);
+			int z = (int)std::floor(point.z / delta_voxel_size_);
+			return ((VoxelKey)(x & 0x1FFFFF) << 42) | ((VoxelKey)(y & 0x1FFFFF) << 21) | (VoxelKey)(z & 0x1FFFFF);
+		}
+
+		static std::uint64_t s_computePointHash(const PointT& point);
+		static void s_decodeVoxelKey(VoxelKey voxel_key, int& x, int& y, int& z);
+		void computeVoxelSignatures(const pcl::PointCloud<PointT>& cloud, VoxelSignatures& voxel_signatures) const;
+		/*! Reuses the full snapshot msg (only updating its header) if the reference point cloud did not change since it was generated. */
+		size_t publishFullSnapshot(const pcl::PointCloud<PointT>& cloud, const ros::Time& time_stamp);
+		/*! @return number of bytes published or -1 if the delta was too large (and a full snapshot should be published instead) */
+		long long publishDelta(const pcl::PointCloud<PointT>& cloud, const ros::Time& time_stamp);
+		void fillMsgHeader(sensor_msgs::PointCloud2& cloud_msg, const ros::Time& time_stamp) const;
+		void refillBytesBudget(const ros::WallTime& now);
+		void subscriberConnectedCallback(const ros::SingleSubscriberPublisher& subscriber);
+
+		std::string publish_topic_;
+		std::string publish_frame_id_;
+		double delta_voxel_size_;
+		double full_snapshot_delta_ratio_;
+		double full_snapshot_period_;
+		double min_publish_period_;
+		double max_bytes_per_second_;
+		double available_bytes_;
+		ros::WallTime last_publish_time_;
+		ros::WallTime last_full_snapshot_time_;
+		ros::WallTime last_bytes_budget_refill_time_;
+		typename pcl::PointCloud<PointT>::ConstPtr reference_cloud_;
+		bool reference_cloud_changed_;
+		std::atomic<bool> full_snapshot_requested_; // set by the ros spinner threads when subscribers connect
+		VoxelSignatures published_voxels_;
+		sensor_msgs::PointCloud2Ptr full_snapshot_msg_;
+		bool full_snapshot_msg_outdated_;
+		ros::Publisher full_snapshot_publisher_;
+		ros::Publisher delta_updated_publisher_;
+		ros::Publisher delta_removed_publisher_;
+	// ========================================================================   </protected-section>  ========================================================================
+};
+
+} /* namespace dynamic_robot_localization */
+
+
+
+#ifdef DRL_NO_PRECOMPILE
+#include <dynamic_robot_localization/common/impl/reference_map_publisher.hpp>
+#endif
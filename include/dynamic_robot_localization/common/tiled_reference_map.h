@@ -0,0 +1,156 @@
+#pragma once
+
+/**\file tiled_reference_map.h
+ * \brief Reference map split in square tiles stored in disk, from which only the tiles around the robot are kept in memory
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>  <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// std includes
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <string>
+#include <utility>
+
+// ROS includes
+#include <ros/ros.h>
+
+// PCL includes
+#include <pcl/common/common.h>
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+#include <pcl/search/kdtree.h>
+
+// project includes
+#include <dynamic_robot_localization/common/chunked_kdtree_search.h>
+#include <dynamic_robot_localization/common/memory_usage.h>
+#include <dynamic_robot_localization/common/reference_map_bundle.h>
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+namespace dynamic_robot_localization {
+// ##########################################################################   TiledReferenceMap   ###########################################################################
+/**
+ * \brief Splits a preprocessed reference map (and its keypoints) in square tiles in the xy plane, saving each tile as a ReferenceMapBundle inside a folder.
+ * The tiles that intersect a circle around the robot are loaded in a background thread and the tiles that are farther than the active radius plus one tile size are evicted,
+ * which bounds the memory usage and the size of the local map given to the matchers (the extra tile size avoids loading and evicting the same tiles when the robot moves near a tile border).
+ * Each resident tile keeps the k-d tree of its points, and the background thread also assembles the local map and its search method (a ChunkedKdTreeSearch over the k-d trees of the tiles),
+ * so that the thread that uses the local map only has to swap it.
+ */
+template <typename PointT>
+class TiledReferenceMap {
+	// ========================================================================   <public-section>   ===========================================================================
+	public:
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <usings>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		using Ptr = std::shared_ptr< TiledReferenceMap<PointT> >;
+		using ConstPtr = std::shared_ptr< const TiledReferenceMap<PointT> >;
+		using TileKey = std::pair<int, int>;
+		struct Tile {
+			typename pcl::PointCloud<PointT>::Ptr pointcloud;
+			typename pcl::PointCloud<PointT>::Ptr keypoints;
+			typename pcl::search::KdTree<PointT>::Ptr search_method;
+			Eigen::Vector3f min_point;
+			Eigen::Vector3f max_point;
+		};
+		using TileMap = std::map<TileKey, Tile>;
+
+		/*! Concatenation of the resident tiles. */
+		struct LocalMap {
+			typename pcl::PointCloud<PointT>::Ptr pointcloud;
+			typename pcl::PointCloud<PointT>::Ptr keypoints;
+			typename pcl::search::KdTree<PointT>::Ptr search_method; // ChunkedKdTreeSearch using the k-d trees of the tiles
+			size_t number_of_tiles = 0;
+		};
+		/*! Called in the background thread after assembling the local map (allows to build other structures for the local map outside the thread that uses the current one). */
+		using LocalMapPreparation = std::function< void (LocalMap& local_map) >;
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </usings>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <constructors-destructor>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		TiledReferenceMap(const std::string& tiles_folder_path, double tile_size = 50.0, double active_tiles_radius = 100.0);
+		virtual ~TiledReferenceMap();
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </constructors-destructor>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <TiledReferenceMap-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		/*! Splits the map in tiles and saves them (along with the tiles index) in the tiles folder. The tiles are not kept in memory. */
+		bool build(const pcl::PointCloud<PointT>& pointcloud, const pcl::PointCloud<PointT>& keypoints, std::uint64_t map_hash);
+
+		/*! Loads the list of available tiles if the tiles index was built with the same map hash and tile size. */
+		bool loadIndex(std::uint64_t map_hash);
+
+		/*! Loads (in the calling thread) the tiles around the given position, evicts the ones that are far away and assembles the local map. @return true if the resident tiles changed */
+		bool updateResidentTiles(double x, double y, LocalMap& local_map);
+
+		/*! @return true if some of the tiles around the given position are not resident */
+		bool hasMissingTiles(double x, double y) const;
+
+		/*! Starts loading the missing tiles around the given position and assembling the new local map in a background thread
+		 * (does nothing if they are already resident or if a previous request is still being processed). */
+		bool requestResidentTilesUpdate(double x, double y, const LocalMapPreparation& local_map_preparation = LocalMapPreparation());
+
+		/*! Swaps in the resident tiles and the local map prepared in the background thread (if they are ready). @return true if the resident tiles changed */
+		bool collectResidentTilesUpdate(LocalMap& local_map);
+		void clear();
+		/*! Accounts the point clouds and k-d trees of the resident tiles. */
+		size_t accountMemoryUsage(MemoryUsage& memory_usage) const;
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </TiledReferenceMap-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <gets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		inline const std::string& getTilesFolderPath() const { return tiles_folder_path_; }
+		inline double getTileSize() const { return tile_size_; }
+		inline double getActiveTilesRadius() const { return active_tiles_radius_; }
+		inline size_t getNumberOfTiles() const { return available_tiles_.size(); }
+		inline size_t getNumberOfResidentTiles() const { return resident_tiles_.size(); }
+		inline bool isLoadingTiles() const { return tiles_loading_.valid(); }
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </gets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+	// ========================================================================   </public-section>  ===========================================================================
+
+	// ========================================================================   <protected-section>   ========================================================================
+	protected:
+		struct ResidentTilesUpdate {
+			TileMap resident_tiles;
+			LocalMap local_map;
+			size_t number_of_loaded_tiles;
+			size_t number_of_evicted_tiles;
+		};
+
+		inline TileKey computeTileKey(double x, double y) const { return TileKey((int)std::floor(x / tile_size_), (int)std::floor(y / tile_size_)); }
+		inline std::uint64_t computeTileHash(const TileKey& tile_key) const { return ((std::uint64_t)(std::uint32_t)tile_key.first << 32) | (std::uint64_t)(std::uint32_t)tile_key.second; }
+		std::set<TileKey> computeTilesWithinRadius(double x, double y, double radius) const;
+		std::string getTileFilename(const TileKey& tile_key) const;
+		std::string getTilesIndexFilename() const { return tiles_folder_path_ + "/tiles_index.txt"; }
+		std::set<TileKey> computeMissingTiles(double x, double y) const;
+		/*! Loads the tile and builds the k-d tree of its points. */
+		bool loadTile(const TileKey& tile_key, Tile& tile) const;
+		/*! Adds the missing tiles to the resident tiles, removes the ones that are far away and assembles the local map (runs in the background thread). */
+		ResidentTilesUpdate computeResidentTilesUpdate(const TileMap& resident_tiles, const std::set<TileKey>& missing_tiles, double x, double y, const LocalMapPreparation& local_map_preparation) const;
+		bool applyResidentTilesUpdate(ResidentTilesUpdate& resident_tiles_update, LocalMap& local_map);
+		static void s_assembleLocalMap(const TileMap& tiles, LocalMap& local_map);
+
+		std::string tiles_folder_path_;
+		double tile_size_;
+		double active_tiles_radius_;
+		std::uint64_t map_hash_;
+		std::set<TileKey> available_tiles_;
+		TileMap resident_tiles_;
+		std::future<ResidentTilesUpdate> tiles_loading_;
+	// ========================================================================   </protected-section>  ========================================================================
+};
+
+} /* namespace dynamic_robot_localization */
+
+
+#ifdef DRL_NO_PRECOMPILE
+#include <dynamic_robot_localization/common/impl/tiled_reference_map.hpp>
+#endif
@@ -0,0 +1,170 @@
+#pragma once
+
+/**\file tracer.h
+ * \brief Low overhead tracing of the time spent in each module of the localization pipeline
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>  <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// std includes
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <typeindex>
+#include <typeinfo>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <macros>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+#define DRL_TRACE_CONCATENATE_IMPL(first, second) first##second
+#define DRL_TRACE_CONCATENATE(first, second) DRL_TRACE_CONCATENATE_IMPL(first, second)
+
+/*! Traces the scope in which it is declared (span_name must be a string literal). */
+#define DRL_TRACE_SCOPE(span_name) dynamic_robot_localization::TraceSpan DRL_TRACE_CONCATENATE(drl_trace_span_, __COUNTER__)(span_name)
+
+/*! Traces the scope in which it is declared, using a span name with the category and the class of the object (the class name is only computed once). */
+#define DRL_TRACE_SCOPE_OBJECT(span_category, object) dynamic_robot_localization::TraceSpan DRL_TRACE_CONCATENATE(drl_trace_span_, __COUNTER__)(span_category, typeid(object))
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </macros>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+namespace dynamic_robot_localization {
+// ###############################################################################   Tracer   ##############################################################################
+/**
+ * \brief Records the spans of time spent in each module into a lock free ring buffer (the oldest spans are overwritten when the buffer is full).
+ * The spans can be exported to the Chrome trace format (chrome://tracing or https://ui.perfetto.dev) or summarized into percentiles.
+ * The tracer is shared by all the modules of the process and when it is disabled a span only costs a relaxed atomic load.
+ */
+class Tracer {
+	// ========================================================================   <public-section>   ===========================================================================
+	public:
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <usings>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		struct Span {
+			const char* name;
+			std::uint64_t start_time_ns;
+			std::uint64_t duration_ns;
+			std::uint32_t thread_id;
+		};
+
+		struct SpanStatistics {
+			std::string name;
+			size_t number_of_spans;
+			double mean_duration_ms;
+			double p50_duration_ms;
+			double p95_duration_ms;
+			double p99_duration_ms;
+			double max_duration_ms;
+		};
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </usings>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <constructors-destructor>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		static Tracer& getInstance();
+		Tracer(const Tracer&) = delete;
+		Tracer& operator=(const Tracer&) = delete;
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </constructors-destructor>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <Tracer-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		/*! Monotonic clock used for the spans. */
+		static inline std::uint64_t s_getTimeInNanoseconds() { return (std::uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count(); }
+
+		/*! The ring buffer is allocated the first time the tracer is enabled (later changes of its size are ignored, because other threads may be recording spans). */
+		void setEnabled(bool enabled);
+		inline bool isEnabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+		void recordSpan(const char* name, std::uint64_t start_time_ns, std::uint64_t duration_ns);
+
+		/*! Returns a pointer that remains valid until the end of the process. */
+		const char* internSpanName(const std::string& span_name);
+		/*! Returns the interned name "span_category/ClassName" (without namespaces and template arguments). */
+		const char* getSpanName(const char* span_category, const std::type_info& type_info);
+
+		/*! Copies the spans that started after min_start_time_ns (sorted by start time). */
+		size_t getSpans(std::vector<Span>& spans_out, std::uint64_t min_start_time_ns = 0) const;
+		/*! Computes the statistics of the spans that started in the last time_window_in_seconds (sorted by name). */
+		void computeSpansStatistics(std::vector<SpanStatistics>& spans_statistics_out, double time_window_in_seconds) const;
+
+		void exportChromeTrace(std::ostream& output_stream, std::uint64_t min_start_time_ns = 0) const;
+		bool saveChromeTrace(const std::string& filename, std::uint64_t min_start_time_ns = 0) const;
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </Tracer-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <gets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		inline size_t getRingBufferSize() const { return ring_buffer_size_; }
+		inline std::uint64_t getNumberOfRecordedSpans() const { return write_index_.load(std::memory_order_relaxed); }
+		std::uint64_t getNumberOfOverwrittenSpans() const;
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </gets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <sets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		/*! Rounded up to a power of 2. */
+		void setRingBufferSize(size_t ring_buffer_size);
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </sets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+	// ========================================================================   </public-section>  ===========================================================================
+
+	// ========================================================================   <protected-section>   ========================================================================
+	protected:
+		/*! Each slot is protected by a sequence number (odd while it is being written), which allows the readers to discard slots that were being overwritten. */
+		struct Slot {
+			std::atomic<std::uint64_t> sequence;
+			std::atomic<const char*> name;
+			std::atomic<std::uint64_t> start_time_ns;
+			std::atomic<std::uint64_t> duration_ns;
+			std::atomic<std::uint32_t> thread_id;
+		};
+
+		Tracer();
+		static std::uint32_t s_getThreadId();
+
+		std::atomic<bool> enabled_;
+		size_t ring_buffer_size_;
+		std::atomic<Slot*> slots_;
+		std::unique_ptr<Slot[]> slots_storage_;
+		std::atomic<std::uint64_t> write_index_;
+
+		std::mutex configuration_mutex_;
+		std::mutex span_names_mutex_;
+		std::unordered_set<std::string> span_names_;
+		std::map< std::pair<const char*, std::type_index>, const char* > class_span_names_; // the categories are string literals
+	// ========================================================================   </protected-section>  ========================================================================
+};
+
+
+// #############################################################################   TraceSpan   #############################################################################
+/**
+ * \brief Records into the Tracer the time between its construction and destruction (if the tracer was enabled when it was constructed).
+ */
+class TraceSpan {
+	public:
+		/*! The name must remain valid until the end of the process (string literal or Tracer::internSpanName). */
+		explicit TraceSpan(const char* name) : name_(name), start_time_ns_(0) {
+			if (Tracer::getInstance().isEnabled()) { start_time_ns_ = Tracer::s_getTimeInNanoseconds(); }
+		}
+
+		TraceSpan(const char* span_category, const std::type_info& type_info) : name_(nullptr), start_time_ns_(0) {
+			Tracer& tracer = Tracer::getInstance();
+			if (tracer.isEnabled()) {
+				name_ = tracer.getSpanName(span_category, type_info);
+				start_time_ns_ = Tracer::s_getTimeInNanoseconds();
+			}
+		}
+
+		~TraceSpan() {
+			if (start_time_ns_ != 0) { Tracer::getInstance().recordSpan(name_, start_time_ns_, Tracer::s_getTimeInNanoseconds() - start_time_ns_); }
+		}
+
+		TraceSpan(const TraceSpan&) = delete;
+		TraceSpan& operator=(const TraceSpan&) = delete;
+
+	protected:
+		const char* name_;
+		std::uint64_t start_time_ns_;
+};
+
+} /* namespace dynamic_robot_localization */
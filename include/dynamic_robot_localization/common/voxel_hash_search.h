@@ -0,0 +1,131 @@
+#pragma once
+
+/**\file voxel_hash_search.h
+ * \brief Search method backed by a voxel hash map that can be updated incrementally (for SLAM with large maps)
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>  <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// std includes
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// PCL includes
+#include <pcl/common/point_tests.h>
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+#include <pcl/search/kdtree.h>
+
+// project includes
+#include <dynamic_robot_localization/common/memory_usage.h>
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+namespace dynamic_robot_localization {
+// ###########################################################################   VoxelHashSearch   ###########################################################################
+/**
+ * \brief Nearest neighbor search using a hash map of voxels with the indices of the points inside them.
+ * Derives from pcl::search::KdTree in order to be a drop in replacement for the search methods given to the matchers, outlier detectors and covariance estimators.
+ * When setInputCloud is called again with the same cloud pointer and the cloud only had points appended, only the new points are indexed.
+ * The insertPoints function allows to add points to the indexed cloud while discarding the ones that fall in voxels that are already full,
+ * which keeps the integration cost of a new scan proportional to the scan size and not to the map size.
+ * Clouds that are changed in place (without being reallocated) must be reindexed with rebuildIndex.
+ * The searches return the same neighbors as the k-d tree. The k nearest neighbors search probes at most maximum_number_of_search_rings rings of voxels around the query point
+ * and falls back to an exhaustive search of the indexed points when the k neighbors were not found or when closer points may exist outside the probed rings
+ * (which is slow for query points far away from the cloud, so the voxel size should be close to the distance of the expected neighbors).
+ */
+template <typename PointT>
+class VoxelHashSearch : public pcl::search::KdTree<PointT> {
+	// ========================================================================   <public-section>   ===========================================================================
+	public:
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <usings>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		using Ptr = std::shared_ptr< VoxelHashSearch<PointT> >;
+		using ConstPtr = std::shared_ptr< const VoxelHashSearch<PointT> >;
+		using PointCloudConstPtr = typename pcl::search::KdTree<PointT>::PointCloudConstPtr;
+		using IndicesConstPtr = typename pcl::search::KdTree<PointT>::IndicesConstPtr;
+		using VoxelKey = std::uint64_t;
+		using VoxelMap = std::unordered_map< VoxelKey, std::vector<int> >;
+		using pcl::search::KdTree<PointT>::nearestKSearch;
+		using pcl::search::KdTree<PointT>::radiusSearch;
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </usings>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <constructors-destructor>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		explicit VoxelHashSearch(double voxel_size = 0.1, int maximum_number_of_points_per_voxel = 0, int maximum_number_of_search_rings = 3, bool sorted = true);
+		virtual ~VoxelHashSearch() {}
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </constructors-destructor>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <VoxelHashSearch-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		virtual void setInputCloud(const PointCloudConstPtr& cloud, const IndicesConstPtr& indices = IndicesConstPtr());
+		void rebuildIndex();
+		void clear();
+		/*! Accounts the voxels index (the indexed point cloud is accounted separately). */
+		size_t accountMemoryUsage(MemoryUsage& memory_usage) const;
+
+		/*!
+		 * Appends to map_cloud the points that fall in voxels that are not full and indexes them.
+		 * map_cloud must be the cloud given in setInputCloud.
+		 * The indices in map_cloud of the added points are appended to inserted_points_indices (if not null), which allows the structures built over map_cloud
+		 * to be updated only with the added points (no points are removed from map_cloud, so the indices of the previous points do not change).
+		 * @return Number of points added
+		 */
+		size_t insertPoints(const pcl::PointCloud<PointT>& new_points, pcl::PointCloud<PointT>& map_cloud, std::vector<int>* inserted_points_indices = nullptr);
+
+		/*! Exact search (the voxels outside the search rings are only analyzed when the k nearest neighbors can not be confirmed inside the rings). */
+		virtual int nearestKSearch(const PointT& point, int k, std::vector<int>& k_indices, std::vector<float>& k_sqr_distances) const;
+		virtual int radiusSearch(const PointT& point, double radius, std::vector<int>& k_indices, std::vector<float>& k_sqr_distances, unsigned int max_nn = 0) const;
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </VoxelHashSearch-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <gets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		inline double getVoxelSize() const { return voxel_size_; }
+		inline int getMaximumNumberOfPointsPerVoxel() const { return maximum_number_of_points_per_voxel_; }
+		inline int getMaximumNumberOfSearchRings() const { return maximum_number_of_search_rings_; }
+		inline size_t getNumberOfVoxels() const { return voxels_.size(); }
+		inline size_t getNumberOfIndexedPoints() const { return number_of_indexed_points_; }
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </gets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <sets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		inline void setVoxelSize(double voxel_size) { voxel_size_ = voxel_size; inverse_voxel_size_ = 1.0 / voxel_size; rebuildIndex(); }
+		inline void setMaximumNumberOfPointsPerVoxel(int maximum_number_of_points_per_voxel) { maximum_number_of_points_per_voxel_ = maximum_number_of_points_per_voxel; }
+		inline void setMaximumNumberOfSearchRings(int maximum_number_of_search_rings) { maximum_number_of_search_rings_ = maximum_number_of_search_rings; }
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </sets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+	// ========================================================================   </public-section>  ===========================================================================
+
+	// ========================================================================   <protected-section>   ========================================================================
+	protected:
+		inline void computeVoxelCoordinates(const PointT& point, int& x, int& y, int& z) const {
+			x = (int)std::floor(point.x * inverse_voxel_size_);
+			y = (int)std::floor(point.y * inverse_voxel_size_);
+			z = (int)std::floor(point.z * inverse_voxel_size_);
+		}
+
+		inline VoxelKey computeVoxelKey(int x, int y, int z) const {
+			return ((VoxelKey)(x & 0x1FFFFF) << 42) | ((VoxelKey)(y & 0x1FFFFF) << 21) | (VoxelKey)(z & 0x1FFFFF);
+		}
+
+		bool indexPoint(int point_index, bool respect_voxel_capacity);
+		void indexNewPoints();
+		void searchVoxelShell(const PointT& point, int center_x, int center_y, int center_z, int ring, double maximum_sqr_distance, std::vector< std::pair<float, int> >& neighbors) const;
+		void searchAllVoxels(const PointT& point, double maximum_sqr_distance, std::vector< std::pair<float, int> >& neighbors) const;
+
+		double voxel_size_;
+		double inverse_voxel_size_;
+		int maximum_number_of_points_per_voxel_;
+		int maximum_number_of_search_rings_;
+		VoxelMap voxels_;
+		size_t number_of_indexed_points_;
+	// ========================================================================   </protected-section>  ========================================================================
+};
+
+} /* namespace dynamic_robot_localization */
+
+
+#ifdef DRL_NO_PRECOMPILE
+#include <dynamic_robot_localization/common/impl/voxel_hash_search.hpp>
+#endif
@@ -19,6 +19,10 @@ namespace dynamic_robot_localization {
 template<typename PointT>
 Localization<PointT>::Localization() :
 	ambient_pointcloud_topic_disabled_on_startup_(false),
+	reference_pointcloud_bundle_save_(true),
+	tiled_map_tile_size_(0.0),
+	tiled_map_active_tiles_radius_(100.0),
+	reference_pointcloud_tiles_build_(false),
 	ambient_pointcloud_integration_filters_preprocessed_pointcloud_save_original_pointcloud_(true),
 	filtered_pointcloud_save_frame_id_with_cloud_time_(false),
 	stop_processing_after_saving_filtered_pointcloud_(true),
@@ -93,6 +97,7 @@ Localization<PointT>::Localization() :
 	number_of_processed_pointclouds_(0),
 	reference_pointcloud_(new pcl::PointCloud<PointT>()),
 	reference_pointcloud_keypoints_(new pcl::PointCloud<PointT>()),
+	initial_pose_estimators_feature_matchers_reference_pointcloud_outdated_(false),
 	circular_buffer_require_reception_of_pointcloud_msgs_from_all_topics_before_doing_registration_(false),
 	circular_buffer_clear_inserted_points_if_registration_fails_(false),
 	minimum_number_points_ambient_pointcloud_circular_buffer_(0),
@@ -112,10 +117,38 @@ Localization<PointT>::Localization() :
 	number_inliers_reference_pointcloud_(0),
 	root_mean_square_error_inliers_reference_pointcloud_(0.0),
 	publish_filtered_pointcloud_only_if_there_is_subscribers_(true),
-	publish_aligned_pointcloud_only_if_there_is_subscribers_(true) {}
+	publish_aligned_pointcloud_only_if_there_is_subscribers_(true),
+	tracing_statistics_time_window_in_seconds_(10.0),
+	tracing_slow_processing_time_threshold_ms_(0.0),
+	configuration_reload_instance_(false),
+	memory_budget_total_bytes_(0),
+	memory_budget_reference_pointcloud_bytes_(0),
+	memory_budget_circular_buffer_bytes_(0),
+	memory_budget_caches_bytes_(0),
+	reference_pointcloud_downsampling_leaf_size_(0.0),
+	reference_pointcloud_downsampling_leaf_size_growth_factor_(1.25),
+	circular_buffer_minimum_number_of_points_(0),
+	processing_pipeline_enabled_(false),
+	processing_pipeline_running_(false),
+	multi_sensor_synchronization_enabled_(false),
+	ambient_pointcloud_subscriber_queue_size_(1) {}
 
 template<typename PointT>
-Localization<PointT>::~Localization() {}
+Localization<PointT>::~Localization() {
+	stopMultiSensorSynchronization();
+	stopProcessingPipeline();
+	if (configuration_reload_instance_) { return; } // the publication thread and the tracer belong to the active instance
+
+	AsyncCloudPublisher::getInstance().stop();
+
+	Tracer& tracer = Tracer::getInstance();
+	if (tracer.isEnabled() && !tracing_chrome_trace_filename_.empty()) {
+		if (tracer.saveChromeTrace(tracing_chrome_trace_filename_))
+			ROS_INFO_STREAM("Saved " << std::min(tracer.getNumberOfRecordedSpans(), (std::uint64_t)tracer.getRingBufferSize()) << " trace spans to file " << tracing_chrome_trace_filename_);
+		else
+			ROS_WARN_STREAM("Failed to save the trace spans to file " << tracing_chrome_trace_filename_);
+	}
+}
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </constructors-destructor>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 
@@ -155,13 +188,44 @@ void Localization<PointT>::setupConfigurationFromParameterServer(ros::NodeHandle
 	setupTransformationValidatorsForTrackingRecoveryFromParameterServer(configuration_namespace);
 	setupRegistrationCovarianceEstimatorsFromParameterServer(configuration_namespace);
 	setupTFPublisherFromParameterServer(configuration_namespace);
+	setupTracingFromParameterServer(configuration_namespace);
+	setupMemoryManagementFromParameterServer(configuration_namespace);
 	updateNormalsEstimatorsFlags();
+
+	// fingerprints of the loaded configuration, for skipping the reloading of the modules that were not changed
+	dynamic_robot_localization::LocalizationConfiguration localization_configuration;
+	s_setLocalizationConfigurationNamespaces(localization_configuration, configuration_namespace);
+	ConfigurationFingerprints::FingerprintsMap configuration_fingerprints;
+	computeConfigurationFingerprints(localization_configuration, configuration_fingerprints);
+	configuration_fingerprints["reference_pointcloud_preprocessing"] = computeReferencePointCloudConfigurationHash(reference_pointcloud_configuration_namespace_, filters_configuration_namespace_,
+			normal_estimators_configuration_namespace_, curvature_estimators_configuration_namespace_, keypoint_detectors_configuration_namespace_);
+	configuration_fingerprints_.clear();
+	for (ConfigurationFingerprints::FingerprintsMap::const_iterator it = configuration_fingerprints.begin(); it != configuration_fingerprints.end(); ++it) {
+		configuration_fingerprints_.update(it->first, it->second);
+	}
+
+	std::vector< std::pair<std::string, std::string> > modules_namespaces;
+	s_getConfigurationModulesNamespaces(localization_configuration, modules_namespaces);
+	modules_configuration_namespaces_.clear();
+	for (size_t i = 0; i < modules_namespaces.size(); ++i) {
+		modules_configuration_namespaces_[modules_namespaces[i].first] = configuration_namespace;
+	}
 }
 
 
 template<typename PointT>
 bool Localization<PointT>::reloadConfigurationFromParameterServerServiceCallback(dynamic_robot_localization::ReloadLocalizationConfiguration::Request& request, dynamic_robot_localization::ReloadLocalizationConfiguration::Response& response) {
-	bool status = reloadConfigurationFromParameterServer(request.localization_configuration);
+	ConfigurationFingerprints::FingerprintsMap configuration_fingerprints;
+	computeConfigurationFingerprints(request.localization_configuration, configuration_fingerprints); // the localization keeps running while the parameter server is queried
+
+	bool status = reloadConfigurationFromParameterServer(request.localization_configuration, configuration_fingerprints); // only locks the mutexes of the processing for swapping the reloaded modules
+
+	// the workers of the processing pipeline need the mutexes for finishing their current point cloud, so they can only be joined after releasing them
+	if (!processing_pipeline_enabled_)
+		stopProcessingPipeline();
+	else if (ambient_pointcloud_subscribers_active_)
+		startProcessingPipeline();
+
 	response.status = status;
 	return status;
 }
@@ -169,6 +233,7 @@ bool Localization<PointT>::reloadConfigurationFromParameterServerServiceCallback
 
 template<typename PointT>
 bool Localization<PointT>::startProcessingSensorDataServiceCallback(dynamic_robot_localization::StartProcessingSensorData::Request& request, dynamic_robot_localization::StartProcessingSensorData::Response& response) {
+	std::lock_guard<std::mutex> localization_lock(localization_mutex_);
 	bool status = false;
 	if (request.set_initial_pose) {
 		status = setInitialPose(request.initial_pose.pose, request.initial_pose.header.frame_id, request.initial_pose.header.stamp);
@@ -184,113 +249,636 @@ bool Localization<PointT>::startProcessingSensorDataServiceCallback(dynamic_robo
 
 template<typename PointT>
 bool Localization<PointT>::stopProcessingSensorDataServiceCallback(dynamic_robot_localization::StopProcessingSensorData::Request& request, dynamic_robot_localization::StopProcessingSensorData::Response& response) {
+	std::lock_guard<std::mutex> localization_lock(localization_mutex_);
 	stopProcessingSensorData();
 	response.status = true;
 	return true;
 }
 
 
+template<typename PointT>
+bool Localization<PointT>::publishReferencePointCloudServiceCallback(dynamic_robot_localization::PublishReferencePointCloud::Request& request, dynamic_robot_localization::PublishReferencePointCloud::Response& response) {
+	std::lock_guard<std::mutex> localization_lock(localization_mutex_);
+	response.status = false;
+	if (reference_pointcloud_ && reference_pointcloud_publisher_) {
+		ros::Time time_stamp = pcl_conversions::fromPCL(reference_pointcloud_->header.stamp);
+		reference_pointcloud_publisher_->requestFullSnapshot();
+		response.status = reference_pointcloud_publisher_->publishPendingChanges(time_stamp, true);
+		if (reference_pointcloud_keypoints_ && reference_pointcloud_keypoints_publisher_) {
+			reference_pointcloud_keypoints_publisher_->requestFullSnapshot();
+			reference_pointcloud_keypoints_publisher_->publishPendingChanges(time_stamp, true);
+		}
+	}
+	return true;
+}
+
+
 template<typename PointT>
 bool Localization<PointT>::reloadConfigurationFromParameterServer(const dynamic_robot_localization::LocalizationConfiguration& localization_configuration) {
-	std::string parsed_string;
+	ConfigurationFingerprints::FingerprintsMap configuration_fingerprints;
+	computeConfigurationFingerprints(localization_configuration, configuration_fingerprints);
+	return reloadConfigurationFromParameterServer(localization_configuration, configuration_fingerprints);
+}
 
-	if (s_parseConfigurationNamespaceFromParameterServer(localization_configuration.message_management, parsed_string))
-		setupMessageManagementFromParameterServer(parsed_string);
 
-	if (s_parseConfigurationNamespaceFromParameterServer(localization_configuration.general_configurations, parsed_string))
-		setupGeneralConfigurationsFromParameterServer(parsed_string);
+template<typename PointT>
+bool Localization<PointT>::reloadConfigurationFromParameterServer(const dynamic_robot_localization::LocalizationConfiguration& localization_configuration, const ConfigurationFingerprints::FingerprintsMap& configuration_fingerprints) {
+	std::lock_guard<std::mutex> configuration_reload_lock(configuration_reload_mutex_);
+	PerformanceTimer performance_timer;
+	performance_timer.start();
+	bool reload_all = localization_configuration.reload_unchanged_modules;
+
+	std::vector< std::pair<std::string, std::string> > modules_namespaces;
+	s_getConfigurationModulesNamespaces(localization_configuration, modules_namespaces);
+	std::map<std::string, std::string> reloaded_modules_namespaces;
+	for (size_t i = 0; i < modules_namespaces.size(); ++i) {
+		std::string parsed_string;
+		if (checkIfConfigurationMustBeReloaded(modules_namespaces[i].first, modules_namespaces[i].second, configuration_fingerprints, reload_all, parsed_string))
+			reloaded_modules_namespaces[modules_namespaces[i].first] = parsed_string;
+	}
 
-	bool setup_subscribe_topic_names = s_parseConfigurationNamespaceFromParameterServer(localization_configuration.subscribe_topic_names, parsed_string);
-	if (setup_subscribe_topic_names)
-		setupSubscribeTopicNamesFromParameterServer(parsed_string);
+	// modules that preprocess the reference point cloud (the namespaces of the modules that were skipped have the same parameters as the requested ones)
+	bool setup_reference_cloud = (reloaded_modules_namespaces.count("reference_pointcloud") > 0);
+	bool setup_reference_cloud_preprocessing = (reloaded_modules_namespaces.count("filters") > 0 || reloaded_modules_namespaces.count("normal_estimators") > 0
+			|| reloaded_modules_namespaces.count("curvature_estimators") > 0 || reloaded_modules_namespaces.count("keypoint_detectors") > 0);
+	std::uint64_t reference_pointcloud_preprocessing_hash = computeReferencePointCloudConfigurationHash(getConfigurationModuleNamespace("reference_pointcloud", reloaded_modules_namespaces),
+			getConfigurationModuleNamespace("filters", reloaded_modules_namespaces), getConfigurationModuleNamespace("normal_estimators", reloaded_modules_namespaces),
+			getConfigurationModuleNamespace("curvature_estimators", reloaded_modules_namespaces), getConfigurationModuleNamespace("keypoint_detectors", reloaded_modules_namespaces));
+	if (setup_reference_cloud_preprocessing && configuration_fingerprints_.hasChanged("reference_pointcloud_preprocessing", reference_pointcloud_preprocessing_hash)) {
+		setup_reference_cloud = true; // changes in the filters, normal / curvature estimators or keypoint detectors of the ambient point cloud do not require to preprocess the reference point cloud again
+	}
 
-	bool setup_service_servers_names = s_parseConfigurationNamespaceFromParameterServer(localization_configuration.service_servers_names, parsed_string);
-	if (setup_service_servers_names)
-		setupServiceServersNamesFromParameterServer(parsed_string);
+	// modules that keep structures built from the reference point cloud (they are all rebuilt together, because the matchers share their lookup tables, caches and voxel maps)
+	const char* reference_cloud_structures_modules_names[] = { "initial_pose_estimators_feature_matchers", "initial_pose_estimators_point_matchers", "tracking_matchers", "tracking_recovery_matchers",
+			"outlier_detectors", "registration_covariance_estimators" };
+	const size_t number_of_reference_cloud_structures_modules = sizeof(reference_cloud_structures_modules_names) / sizeof(reference_cloud_structures_modules_names[0]);
+	bool setup_reference_cloud_structures = setup_reference_cloud;
+	for (size_t i = 0; i < number_of_reference_cloud_structures_modules; ++i) {
+		if (reloaded_modules_namespaces.count(reference_cloud_structures_modules_names[i]) > 0) { setup_reference_cloud_structures = true; }
+	}
 
-	bool setup_publish_topic_names = s_parseConfigurationNamespaceFromParameterServer(localization_configuration.publish_topic_names, parsed_string);
-	if (setup_publish_topic_names)
-		setupPublishTopicNamesFromParameterServer(parsed_string);
+	// the modules that configure objects shared with the workers (TF publisher, tracer, ingestion, synchronizer and publication thread) are setup in the active instance
+	std::set<std::string> reload_instance_modules_names;
+	for (std::map<std::string, std::string>::const_iterator it = reloaded_modules_namespaces.begin(); it != reloaded_modules_namespaces.end(); ++it) {
+		if (it->first != "message_management" && it->first != "tf_publisher" && it->first != "tracing") { reload_instance_modules_names.insert(it->first); }
+	}
+	if (setup_reference_cloud_structures) {
+		reload_instance_modules_names.insert(reference_cloud_structures_modules_names, reference_cloud_structures_modules_names + number_of_reference_cloud_structures_modules);
+		reload_instance_modules_names.insert("frame_ids"); // frame id of the reference point cloud
+		reload_instance_modules_names.insert("reference_pointcloud"); // search method of the reference point cloud
+	}
+	if (setup_reference_cloud) {
+		const char* reference_cloud_preprocessing_modules_names[] = { "filters", "normal_estimators", "curvature_estimators", "keypoint_detectors" };
+		reload_instance_modules_names.insert(reference_cloud_preprocessing_modules_names, reference_cloud_preprocessing_modules_names + sizeof(reference_cloud_preprocessing_modules_names) / sizeof(reference_cloud_preprocessing_modules_names[0]));
+	}
 
-	if (s_parseConfigurationNamespaceFromParameterServer(localization_configuration.frame_ids, parsed_string))
-		setupFrameIdsFromParameterServer(parsed_string);
+	// the reload_instance is destroyed (with the previous modules and reference data) after releasing the processing mutexes
+	// the configuration_reload_mutex_ ensures that no other reload changes the members that are read below without the processing mutexes
+	std::unique_ptr< Localization<PointT> > reload_instance(new Localization<PointT>());
+	reload_instance->configuration_reload_instance_ = true;
+	reload_instance->node_handle_ = node_handle_;
+	reload_instance->private_node_handle_ = private_node_handle_;
+	reload_instance->configuration_namespace_ = configuration_namespace_;
+	reload_instance->pose_to_tf_publisher_ = pose_to_tf_publisher_; // TF collector given to the filters
+	reload_instance->minimum_number_of_points_in_ambient_pointcloud_ = minimum_number_of_points_in_ambient_pointcloud_; // used by the tracking recovery portfolio
+	for (size_t i = 0; i < modules_namespaces.size(); ++i) {
+		if (reload_instance_modules_names.count(modules_namespaces[i].first) > 0)
+			reload_instance->setupConfigurationModuleFromParameterServer(modules_namespaces[i].first, getConfigurationModuleNamespace(modules_namespaces[i].first, reloaded_modules_namespaces));
+	}
 
-	bool setup_reference_cloud = s_parseConfigurationNamespaceFromParameterServer(localization_configuration.reference_pointcloud, parsed_string);
-	if (setup_reference_cloud)
-		setupReferencePointCloudFromParameterServer(parsed_string);
+	bool status = true;
+	bool reference_pointcloud_loaded_from_file = false;
+	if (setup_reference_cloud && reload_instance->reference_pointcloud_required_ && reload_instance->reference_pointcloud_available_ && !reload_instance->reference_pointcloud_filename_.empty()) {
+		status = reload_instance->loadReferencePointCloud();
+		reference_pointcloud_loaded_from_file = status;
+	}
 
-	if (s_parseConfigurationNamespaceFromParameterServer(localization_configuration.filters, parsed_string))
-		setupCloudFiltersFromParameterServer(parsed_string);
+	// the reference point cloud that was not loaded from a file is copied (the registration may be changing it), for building the structures of the matchers without the processing mutexes
+	const pcl::PointCloud<PointT>* reference_pointcloud_copied = nullptr;
+	size_t reference_pointcloud_copied_size = 0;
+	std::uint64_t reference_pointcloud_copied_stamp = 0;
+	if (setup_reference_cloud_structures && !reference_pointcloud_loaded_from_file) {
+		{
+			std::lock_guard<std::mutex> localization_lock(localization_mutex_);
+			if (reference_pointcloud_loaded_ && reference_pointcloud_) {
+				reference_pointcloud_copied = reference_pointcloud_.get();
+				reference_pointcloud_copied_size = reference_pointcloud_->size();
+				reference_pointcloud_copied_stamp = reference_pointcloud_->header.stamp;
+				reload_instance->reference_pointcloud_ = typename pcl::PointCloud<PointT>::Ptr(new pcl::PointCloud<PointT>(*reference_pointcloud_));
+				reload_instance->reference_pointcloud_keypoints_ = (reference_pointcloud_keypoints_ ? typename pcl::PointCloud<PointT>::Ptr(new pcl::PointCloud<PointT>(*reference_pointcloud_keypoints_)) : reference_pointcloud_keypoints_);
+				reload_instance->reference_pointcloud_for_outlier_detection_ = reference_pointcloud_for_outlier_detection_; // loaded from file and never changed
+				reload_instance->reference_pointcloud_search_method_for_outlier_detection_ = reference_pointcloud_search_method_for_outlier_detection_;
+				reload_instance->tiled_reference_map_ = tiled_reference_map_;
+				reload_instance->last_map_received_time_ = last_map_received_time_;
+				reload_instance->reference_pointcloud_loaded_ = true;
+			}
+		}
 
-	if (s_parseConfigurationNamespaceFromParameterServer(localization_configuration.normal_estimators, parsed_string))
-		setupNormalEstimatorsFromParameterServer(parsed_string);
+		if (reload_instance->reference_pointcloud_loaded_) {
+			reload_instance->reference_pointcloud_search_method_->setInputCloud(reload_instance->reference_pointcloud_);
+			if (reload_instance->registration_covariance_estimator_)
+				reload_instance->registration_covariance_estimator_->setReferenceCloud(reload_instance->reference_pointcloud_, reload_instance->reference_pointcloud_search_method_);
+			reload_instance->updateMatchersReferenceCloud();
+		}
+	}
 
-	if (s_parseConfigurationNamespaceFromParameterServer(localization_configuration.curvature_estimators, parsed_string))
-		setupCurvatureEstimatorsFromParameterServer(parsed_string);
+	{
+		// the ingestion and multi sensor synchronization workers use the frame ids, TF collector and ingestion configurations without the localization mutex
+		std::lock_guard<std::mutex> sensor_data_ingestion_lock(sensor_data_ingestion_mutex_);
+		std::lock_guard<std::mutex> localization_lock(localization_mutex_);
+
+		swapConfigurationModules(*reload_instance, reload_instance_modules_names);
+
+		if (reference_pointcloud_loaded_from_file) {
+			swapReferencePointCloud(*reload_instance);
+			localization_diagnostics_msg_.number_points_reference_pointcloud = reload_instance->localization_diagnostics_msg_.number_points_reference_pointcloud;
+			localization_diagnostics_msg_.number_points_reference_pointcloud_after_filtering = reload_instance->localization_diagnostics_msg_.number_points_reference_pointcloud_after_filtering;
+			localization_diagnostics_msg_.number_keypoints_reference_pointcloud = reload_instance->localization_diagnostics_msg_.number_keypoints_reference_pointcloud;
+		} else if (reference_pointcloud_copied) {
+			if (reference_pointcloud_.get() == reference_pointcloud_copied && reference_pointcloud_->size() == reference_pointcloud_copied_size && reference_pointcloud_->header.stamp == reference_pointcloud_copied_stamp) {
+				swapReferencePointCloud(*reload_instance);
+			} else if (reference_pointcloud_loaded_ && reference_pointcloud_) {
+				ROS_DEBUG("Reference point cloud changed while reloading the configuration (the matchers will be setup with the current reference point cloud)");
+				std::swap(reference_pointcloud_search_method_, reload_instance->reference_pointcloud_search_method_);
+				reference_pointcloud_search_method_->setInputCloud(reference_pointcloud_);
+				reference_pointcloud_keypoints_voxel_hash_search_.reset();
+				if (registration_covariance_estimator_)
+					registration_covariance_estimator_->setReferenceCloud(reference_pointcloud_, reference_pointcloud_search_method_);
+				updateMatchersReferenceCloud();
+			}
+		}
 
-	if (s_parseConfigurationNamespaceFromParameterServer(localization_configuration.keypoint_detectors, parsed_string))
-		setupKeypointDetectorsFromParameterServer(parsed_string);
+		if (reload_instance_modules_names.count("reference_pointcloud") > 0 && reference_pointcloud_) { reference_pointcloud_->header.frame_id = map_frame_id_for_publishing_pointclouds_; }
 
-	if (s_parseConfigurationNamespaceFromParameterServer(localization_configuration.cloud_matchers_configurations, parsed_string))
-		setupCloudMatchersFromParameterServer(parsed_string);
+		if (reloaded_modules_namespaces.count("message_management") > 0) {
+			setupMessageManagementFromParameterServer(reloaded_modules_namespaces["message_management"]);
+			updateCloudFiltersTfCollector();
+			if (tracking_recovery_portfolio_) { tracking_recovery_portfolio_->setMinimumNumberOfPointsInAmbientPointCloud(minimum_number_of_points_in_ambient_pointcloud_); }
+		}
 
-	if (s_parseConfigurationNamespaceFromParameterServer(localization_configuration.initial_pose_estimators_feature_matchers, parsed_string))
-		setupInitialPoseEstimatorsFeatureMatchersFromParameterServer(parsed_string);
+		if (reloaded_modules_namespaces.count("tf_publisher") > 0)
+			setupTFPublisherFromParameterServer(reloaded_modules_namespaces["tf_publisher"]);
 
-	if (s_parseConfigurationNamespaceFromParameterServer(localization_configuration.initial_pose_estimators_point_matchers, parsed_string))
-		setupInitialPoseEstimatorsPointMatchersFromParameterServer(parsed_string);
+		if (reloaded_modules_namespaces.count("tracing") > 0)
+			setupTracingFromParameterServer(reloaded_modules_namespaces["tracing"]);
 
-	if (s_parseConfigurationNamespaceFromParameterServer(localization_configuration.tracking_matchers, parsed_string))
-		setupTrackingMatchersFromParameterServer(parsed_string);
+		updateNormalsEstimatorsFlags();
 
-	if (s_parseConfigurationNamespaceFromParameterServer(localization_configuration.tracking_recovery_matchers, parsed_string))
-		setupTrackingRecoveryMatchersFromParameterServer(parsed_string);
+		if (reference_pointcloud_loaded_from_file && reference_pointcloud_) {
+			publishReferencePointCloud(pcl_conversions::fromPCL(reference_pointcloud_->header.stamp), true);
+		}
 
-	if (s_parseConfigurationNamespaceFromParameterServer(localization_configuration.transformation_aligner, parsed_string))
-		setupTransformationAlignerFromParameterServer(parsed_string);
+		if (reloaded_modules_namespaces.count("publish_topic_names") > 0) {
+			startPublishers();
+			startReferenceCloudSubscribers();
+		}
 
-	if (s_parseConfigurationNamespaceFromParameterServer(localization_configuration.outlier_detectors, parsed_string))
-		setupOutlierDetectorsFromParameterServer(parsed_string);
+		if (reloaded_modules_namespaces.count("subscribe_topic_names") > 0)
+			startSubscribers();
 
-	if (s_parseConfigurationNamespaceFromParameterServer(localization_configuration.outlier_detectors_reference_pointcloud, parsed_string))
-		setupOutlierDetectorsReferencePointCloudFromParameterServer(parsed_string);
+		if (reloaded_modules_namespaces.count("service_servers_names") > 0)
+			startServiceServers();
 
-	if (s_parseConfigurationNamespaceFromParameterServer(localization_configuration.cloud_analyzers, parsed_string))
-		setupCloudAnalyzersFromParameterServer(parsed_string);
+		for (std::map<std::string, std::string>::const_iterator it = reloaded_modules_namespaces.begin(); it != reloaded_modules_namespaces.end(); ++it) {
+			modules_configuration_namespaces_[it->first] = it->second;
+		}
 
-	if (s_parseConfigurationNamespaceFromParameterServer(localization_configuration.transformation_validators_for_initial_alignment, parsed_string))
-		setupTransformationValidatorsForInitialAlignmentFromParameterServer(parsed_string);
+		// the fingerprints are only committed after a successful reload, otherwise the next request retries the same modules
+		if (status) {
+			for (ConfigurationFingerprints::FingerprintsMap::const_iterator it = configuration_fingerprints.begin(); it != configuration_fingerprints.end(); ++it) {
+				configuration_fingerprints_.update(it->first, it->second);
+			}
+			configuration_fingerprints_.update("reference_pointcloud_preprocessing", reference_pointcloud_preprocessing_hash);
+		}
+	}
 
-	if (s_parseConfigurationNamespaceFromParameterServer(localization_configuration.transformation_validators_for_tracking, parsed_string))
-		setupTransformationValidatorsForTrackingFromParameterServer(parsed_string);
+	ROS_INFO_STREAM("Reloaded localization configuration in " << performance_timer.getElapsedTimeFormated() << (reference_pointcloud_loaded_from_file ? " (including the reference point cloud)" : ""));
+	return status;
+}
 
-	if (s_parseConfigurationNamespaceFromParameterServer(localization_configuration.transformation_validators_for_tracking_recovery, parsed_string))
-		setupTransformationValidatorsForTrackingRecoveryFromParameterServer(parsed_string);
 
-	if (s_parseConfigurationNamespaceFromParameterServer(localization_configuration.registration_covariance_estimators, parsed_string))
-		setupRegistrationCovarianceEstimatorsFromParameterServer(parsed_string);
+template<typename PointT>
+void Localization<PointT>::s_getConfigurationModulesNamespaces(const dynamic_robot_localization::LocalizationConfiguration& localization_configuration, std::vector< std::pair<std::string, std::string> >& modules_namespaces) {
+	modules_namespaces.clear();
+	modules_namespaces.push_back(std::make_pair("message_management", localization_configuration.message_management));
+	modules_namespaces.push_back(std::make_pair("general_configurations", localization_configuration.general_configurations));
+	modules_namespaces.push_back(std::make_pair("subscribe_topic_names", localization_configuration.subscribe_topic_names));
+	modules_namespaces.push_back(std::make_pair("service_servers_names", localization_configuration.service_servers_names));
+	modules_namespaces.push_back(std::make_pair("publish_topic_names", localization_configuration.publish_topic_names));
+	modules_namespaces.push_back(std::make_pair("frame_ids", localization_configuration.frame_ids));
+	modules_namespaces.push_back(std::make_pair("reference_pointcloud", localization_configuration.reference_pointcloud));
+	modules_namespaces.push_back(std::make_pair("filters", localization_configuration.filters));
+	modules_namespaces.push_back(std::make_pair("normal_estimators", localization_configuration.normal_estimators));
+	modules_namespaces.push_back(std::make_pair("curvature_estimators", localization_configuration.curvature_estimators));
+	modules_namespaces.push_back(std::make_pair("keypoint_detectors", localization_configuration.keypoint_detectors));
+	modules_namespaces.push_back(std::make_pair("cloud_matchers_configurations", localization_configuration.cloud_matchers_configurations));
+	modules_namespaces.push_back(std::make_pair("initial_pose_estimators_feature_matchers", localization_configuration.initial_pose_estimators_feature_matchers));
+	modules_namespaces.push_back(std::make_pair("initial_pose_estimators_point_matchers", localization_configuration.initial_pose_estimators_point_matchers));
+	modules_namespaces.push_back(std::make_pair("tracking_matchers", localization_configuration.tracking_matchers));
+	modules_namespaces.push_back(std::make_pair("tracking_recovery_matchers", localization_configuration.tracking_recovery_matchers));
+	modules_namespaces.push_back(std::make_pair("transformation_aligner", localization_configuration.transformation_aligner));
+	modules_namespaces.push_back(std::make_pair("outlier_detectors", localization_configuration.outlier_detectors));
+	modules_namespaces.push_back(std::make_pair("outlier_detectors_reference_pointcloud", localization_configuration.outlier_detectors_reference_pointcloud));
+	modules_namespaces.push_back(std::make_pair("cloud_analyzers", localization_configuration.cloud_analyzers));
+	modules_namespaces.push_back(std::make_pair("transformation_validators_for_initial_alignment", localization_configuration.transformation_validators_for_initial_alignment));
+	modules_namespaces.push_back(std::make_pair("transformation_validators_for_tracking", localization_configuration.transformation_validators_for_tracking));
+	modules_namespaces.push_back(std::make_pair("transformation_validators_for_tracking_recovery", localization_configuration.transformation_validators_for_tracking_recovery));
+	modules_namespaces.push_back(std::make_pair("registration_covariance_estimators", localization_configuration.registration_covariance_estimators));
+	modules_namespaces.push_back(std::make_pair("tf_publisher", localization_configuration.tf_publisher));
+	modules_namespaces.push_back(std::make_pair("tracing", localization_configuration.tracing));
+	modules_namespaces.push_back(std::make_pair("memory_management", localization_configuration.memory_management));
+}
 
-	if (s_parseConfigurationNamespaceFromParameterServer(localization_configuration.tf_publisher, parsed_string))
-		setupTFPublisherFromParameterServer(parsed_string);
 
-	updateNormalsEstimatorsFlags();
+template<typename PointT>
+bool Localization<PointT>::setupConfigurationModuleFromParameterServer(const std::string& module_name, const std::string& configuration_namespace) {
+	if (module_name == "message_management") { setupMessageManagementFromParameterServer(configuration_namespace); }
+	else if (module_name == "general_configurations") { setupGeneralConfigurationsFromParameterServer(configuration_namespace); }
+	else if (module_name == "subscribe_topic_names") { setupSubscribeTopicNamesFromParameterServer(configuration_namespace); }
+	else if (module_name == "service_servers_names") { setupServiceServersNamesFromParameterServer(configuration_namespace); }
+	else if (module_name == "publish_topic_names") { setupPublishTopicNamesFromParameterServer(configuration_namespace); }
+	else if (module_name == "frame_ids") { setupFrameIdsFromParameterServer(configuration_namespace); }
+	else if (module_name == "reference_pointcloud") { setupReferencePointCloudFromParameterServer(configuration_namespace); }
+	else if (module_name == "filters") { setupCloudFiltersFromParameterServer(configuration_namespace); }
+	else if (module_name == "normal_estimators") { setupNormalEstimatorsFromParameterServer(configuration_namespace); }
+	else if (module_name == "curvature_estimators") { setupCurvatureEstimatorsFromParameterServer(configuration_namespace); }
+	else if (module_name == "keypoint_detectors") { setupKeypointDetectorsFromParameterServer(configuration_namespace); }
+	else if (module_name == "cloud_matchers_configurations") { setupCloudMatchersFromParameterServer(configuration_namespace); }
+	else if (module_name == "initial_pose_estimators_feature_matchers") { setupInitialPoseEstimatorsFeatureMatchersFromParameterServer(configuration_namespace); }
+	else if (module_name == "initial_pose_estimators_point_matchers") { setupInitialPoseEstimatorsPointMatchersFromParameterServer(configuration_namespace); }
+	else if (module_name == "tracking_matchers") { setupTrackingMatchersFromParameterServer(configuration_namespace); }
+	else if (module_name == "tracking_recovery_matchers") { setupTrackingRecoveryMatchersFromParameterServer(configuration_namespace); }
+	else if (module_name == "transformation_aligner") { setupTransformationAlignerFromParameterServer(configuration_namespace); }
+	else if (module_name == "outlier_detectors") { setupOutlierDetectorsFromParameterServer(configuration_namespace); }
+	else if (module_name == "outlier_detectors_reference_pointcloud") { setupOutlierDetectorsReferencePointCloudFromParameterServer(configuration_namespace); }
+	else if (module_name == "cloud_analyzers") { setupCloudAnalyzersFromParameterServer(configuration_namespace); }
+	else if (module_name == "transformation_validators_for_initial_alignment") { setupTransformationValidatorsForInitialAlignmentFromParameterServer(configuration_namespace); }
+	else if (module_name == "transformation_validators_for_tracking") { setupTransformationValidatorsForTrackingFromParameterServer(configuration_namespace); }
+	else if (module_name == "transformation_validators_for_tracking_recovery") { setupTransformationValidatorsForTrackingRecoveryFromParameterServer(configuration_namespace); }
+	else if (module_name == "registration_covariance_estimators") { setupRegistrationCovarianceEstimatorsFromParameterServer(configuration_namespace); }
+	else if (module_name == "tf_publisher") { setupTFPublisherFromParameterServer(configuration_namespace); }
+	else if (module_name == "tracing") { setupTracingFromParameterServer(configuration_namespace); }
+	else if (module_name == "memory_management") { setupMemoryManagementFromParameterServer(configuration_namespace); }
+	else { return false; }
+	return true;
+}
 
-	bool status = true;
-	if (setup_reference_cloud)
-		status = loadReferencePointCloud();
 
-	if (setup_publish_topic_names) {
-		startPublishers();
-		startReferenceCloudSubscribers();
+template<typename PointT>
+std::string Localization<PointT>::getConfigurationModuleNamespace(const std::string& module_name, const std::map<std::string, std::string>& reloaded_modules_namespaces) {
+	std::map<std::string, std::string>::const_iterator module_namespace = reloaded_modules_namespaces.find(module_name);
+	if (module_namespace != reloaded_modules_namespaces.end()) { return module_namespace->second; }
+	module_namespace = modules_configuration_namespaces_.find(module_name);
+	if (module_namespace != modules_configuration_namespaces_.end()) { return module_namespace->second; }
+	return configuration_namespace_;
+}
+
+
+template<typename PointT>
+void Localization<PointT>::swapConfigurationModules(Localization<PointT>& reload_instance, const std::set<std::string>& modules_names) {
+	if (modules_names.count("general_configurations") > 0) {
+		std::swap(publish_tf_map_odom_, reload_instance.publish_tf_map_odom_);
+		std::swap(publish_tf_when_resetting_initial_pose_, reload_instance.publish_tf_when_resetting_initial_pose_);
+		std::swap(add_odometry_displacement_, reload_instance.add_odometry_displacement_);
 	}
 
-	if (setup_subscribe_topic_names)
-		startSubscribers();
+	if (modules_names.count("subscribe_topic_names") > 0) {
+		std::swap(pose_topic_, reload_instance.pose_topic_);
+		std::swap(pose_stamped_topic_, reload_instance.pose_stamped_topic_);
+		std::swap(pose_with_covariance_stamped_topic_, reload_instance.pose_with_covariance_stamped_topic_);
+		std::swap(ambient_pointcloud_topics_, reload_instance.ambient_pointcloud_topics_);
+		std::swap(ambient_pointcloud_topic_disabled_on_startup_, reload_instance.ambient_pointcloud_topic_disabled_on_startup_);
+		std::swap(reference_costmap_topic_, reload_instance.reference_costmap_topic_);
+		std::swap(reference_pointcloud_topic_, reload_instance.reference_pointcloud_topic_);
+	}
 
-	if (setup_service_servers_names)
-		startServiceServers();
+	if (modules_names.count("service_servers_names") > 0) {
+		std::swap(reload_localization_configuration_service_server_name_, reload_instance.reload_localization_configuration_service_server_name_);
+		std::swap(start_processing_sensor_data_service_server_name_, reload_instance.start_processing_sensor_data_service_server_name_);
+		std::swap(stop_processing_sensor_data_service_server_name_, reload_instance.stop_processing_sensor_data_service_server_name_);
+		std::swap(publish_reference_pointcloud_service_server_name_, reload_instance.publish_reference_pointcloud_service_server_name_);
+	}
 
-	return status;
+	if (modules_names.count("publish_topic_names") > 0) {
+		std::swap(publish_filtered_pointcloud_only_if_there_is_subscribers_, reload_instance.publish_filtered_pointcloud_only_if_there_is_subscribers_);
+		std::swap(publish_aligned_pointcloud_only_if_there_is_subscribers_, reload_instance.publish_aligned_pointcloud_only_if_there_is_subscribers_);
+		std::swap(reference_pointcloud_publish_topic_, reload_instance.reference_pointcloud_publish_topic_);
+		std::swap(reference_pointcloud_keypoints_publish_topic_, reload_instance.reference_pointcloud_keypoints_publish_topic_);
+		std::swap(filtered_pointcloud_publish_topic_, reload_instance.filtered_pointcloud_publish_topic_);
+		std::swap(aligned_pointcloud_publish_topic_, reload_instance.aligned_pointcloud_publish_topic_);
+		std::swap(pose_with_covariance_stamped_publish_topic_, reload_instance.pose_with_covariance_stamped_publish_topic_);
+		std::swap(pose_with_covariance_stamped_tracking_reset_publish_topic_, reload_instance.pose_with_covariance_stamped_tracking_reset_publish_topic_);
+		std::swap(pose_stamped_publish_topic_, reload_instance.pose_stamped_publish_topic_);
+		std::swap(pose_array_publish_topic_, reload_instance.pose_array_publish_topic_);
+		std::swap(localization_detailed_publish_topic_, reload_instance.localization_detailed_publish_topic_);
+		std::swap(localization_diagnostics_publish_topic_, reload_instance.localization_diagnostics_publish_topic_);
+		std::swap(localization_times_publish_topic_, reload_instance.localization_times_publish_topic_);
+		std::swap(localization_tracing_publish_topic_, reload_instance.localization_tracing_publish_topic_);
+	}
+
+	if (modules_names.count("frame_ids") > 0) {
+		std::swap(map_frame_id_, reload_instance.map_frame_id_);
+		std::swap(map_frame_id_for_transforming_pointclouds_, reload_instance.map_frame_id_for_transforming_pointclouds_);
+		std::swap(map_frame_id_for_publishing_pointclouds_, reload_instance.map_frame_id_for_publishing_pointclouds_);
+		std::swap(odom_frame_id_, reload_instance.odom_frame_id_);
+		std::swap(base_link_frame_id_, reload_instance.base_link_frame_id_);
+		std::swap(sensor_frame_id_, reload_instance.sensor_frame_id_);
+	}
+
+	if (modules_names.count("reference_pointcloud") > 0) { // the search method is swapped with the reference point cloud
+		std::swap(reference_pointcloud_configuration_namespace_, reload_instance.reference_pointcloud_configuration_namespace_);
+		std::swap(reference_pointclouds_database_folder_path_, reload_instance.reference_pointclouds_database_folder_path_);
+		std::swap(reference_pointcloud_filename_, reload_instance.reference_pointcloud_filename_);
+		std::swap(reference_pointcloud_normalize_normals_, reload_instance.reference_pointcloud_normalize_normals_);
+		std::swap(reference_pointcloud_preprocessed_save_filename_, reload_instance.reference_pointcloud_preprocessed_save_filename_);
+		std::swap(reference_pointcloud_bundle_filename_, reload_instance.reference_pointcloud_bundle_filename_);
+		std::swap(reference_pointcloud_bundle_save_, reload_instance.reference_pointcloud_bundle_save_);
+		std::swap(save_reference_pointclouds_in_binary_format_, reload_instance.save_reference_pointclouds_in_binary_format_);
+		std::swap(republish_reference_pointcloud_after_successful_registration_, reload_instance.republish_reference_pointcloud_after_successful_registration_);
+		std::swap(minimum_number_of_points_in_reference_pointcloud_, reload_instance.minimum_number_of_points_in_reference_pointcloud_);
+		std::swap(reference_pointcloud_2d_, reload_instance.reference_pointcloud_2d_);
+		std::swap(reference_pointcloud_available_, reload_instance.reference_pointcloud_available_);
+		std::swap(reference_pointcloud_required_, reload_instance.reference_pointcloud_required_);
+		std::swap(map_update_mode_, reload_instance.map_update_mode_);
+		std::swap(use_incremental_map_update_, reload_instance.use_incremental_map_update_);
+		std::swap(tiled_map_tile_size_, reload_instance.tiled_map_tile_size_);
+		std::swap(tiled_map_active_tiles_radius_, reload_instance.tiled_map_active_tiles_radius_);
+		std::swap(tiled_map_tiles_folder_path_, reload_instance.tiled_map_tiles_folder_path_);
+	}
+
+	if (modules_names.count("filters") > 0) {
+		std::swap(filters_configuration_namespace_, reload_instance.filters_configuration_namespace_);
+		std::swap(reference_cloud_filters_, reload_instance.reference_cloud_filters_);
+		std::swap(ambient_pointcloud_integration_filters_, reload_instance.ambient_pointcloud_integration_filters_);
+		std::swap(ambient_pointcloud_integration_filters_map_frame_, reload_instance.ambient_pointcloud_integration_filters_map_frame_);
+		std::swap(ambient_pointcloud_feature_registration_filters_, reload_instance.ambient_pointcloud_feature_registration_filters_);
+		std::swap(ambient_pointcloud_map_frame_feature_registration_filters_, reload_instance.ambient_pointcloud_map_frame_feature_registration_filters_);
+		std::swap(ambient_pointcloud_filters_, reload_instance.ambient_pointcloud_filters_);
+		std::swap(ambient_pointcloud_filters_for_outlier_detection_, reload_instance.ambient_pointcloud_filters_for_outlier_detection_);
+		std::swap(ambient_pointcloud_filters_custom_frame_, reload_instance.ambient_pointcloud_filters_custom_frame_);
+		std::swap(ambient_pointcloud_filters_custom_frame_id_, reload_instance.ambient_pointcloud_filters_custom_frame_id_);
+		std::swap(ambient_pointcloud_filters_map_frame_, reload_instance.ambient_pointcloud_filters_map_frame_);
+		std::swap(ambient_pointcloud_filters_after_normal_estimation_, reload_instance.ambient_pointcloud_filters_after_normal_estimation_);
+		std::swap(ambient_pointcloud_integration_filters_preprocessed_pointcloud_save_filename_, reload_instance.ambient_pointcloud_integration_filters_preprocessed_pointcloud_save_filename_);
+		std::swap(ambient_pointcloud_integration_filters_preprocessed_pointcloud_save_original_pointcloud_, reload_instance.ambient_pointcloud_integration_filters_preprocessed_pointcloud_save_original_pointcloud_);
+		std::swap(filtered_pointcloud_save_filename_, reload_instance.filtered_pointcloud_save_filename_);
+		std::swap(filtered_pointcloud_save_frame_id_, reload_instance.filtered_pointcloud_save_frame_id_);
+		std::swap(filtered_pointcloud_save_frame_id_with_cloud_time_, reload_instance.filtered_pointcloud_save_frame_id_with_cloud_time_);
+		std::swap(stop_processing_after_saving_filtered_pointcloud_, reload_instance.stop_processing_after_saving_filtered_pointcloud_);
+		cloud_filter_chain_.setIndexBasedSelectionEnabled(reload_instance.cloud_filter_chain_.isIndexBasedSelectionEnabled());
+		cloud_filter_chain_.setPoolSize(reload_instance.cloud_filter_chain_.getPoolSize());
+	}
+
+	if (modules_names.count("normal_estimators") > 0) {
+		std::swap(normal_estimators_configuration_namespace_, reload_instance.normal_estimators_configuration_namespace_);
+		std::swap(compute_normals_when_tracking_pose_, reload_instance.compute_normals_when_tracking_pose_);
+		std::swap(compute_normals_when_recovering_pose_tracking_, reload_instance.compute_normals_when_recovering_pose_tracking_);
+		std::swap(compute_normals_when_estimating_initial_pose_, reload_instance.compute_normals_when_estimating_initial_pose_);
+		std::swap(use_filtered_cloud_as_normal_estimation_surface_reference_, reload_instance.use_filtered_cloud_as_normal_estimation_surface_reference_);
+		std::swap(flip_normals_using_occupancy_grid_analysis_, reload_instance.flip_normals_using_occupancy_grid_analysis_);
+		std::swap(use_filtered_cloud_as_normal_estimation_surface_ambient_, reload_instance.use_filtered_cloud_as_normal_estimation_surface_ambient_);
+		std::swap(reference_cloud_normal_estimator_, reload_instance.reference_cloud_normal_estimator_);
+		std::swap(ambient_cloud_normal_estimator_, reload_instance.ambient_cloud_normal_estimator_);
+	}
+
+	if (modules_names.count("curvature_estimators") > 0) {
+		std::swap(curvature_estimators_configuration_namespace_, reload_instance.curvature_estimators_configuration_namespace_);
+		std::swap(reference_cloud_curvature_estimator_, reload_instance.reference_cloud_curvature_estimator_);
+		std::swap(ambient_cloud_curvature_estimator_, reload_instance.ambient_cloud_curvature_estimator_);
+	}
+
+	if (modules_names.count("keypoint_detectors") > 0) {
+		std::swap(keypoint_detectors_configuration_namespace_, reload_instance.keypoint_detectors_configuration_namespace_);
+		std::swap(reference_cloud_keypoint_detectors_, reload_instance.reference_cloud_keypoint_detectors_);
+		std::swap(ambient_cloud_keypoint_detectors_, reload_instance.ambient_cloud_keypoint_detectors_);
+		std::swap(reference_pointcloud_keypoints_filename_, reload_instance.reference_pointcloud_keypoints_filename_);
+		std::swap(reference_pointcloud_keypoints_save_filename_, reload_instance.reference_pointcloud_keypoints_save_filename_);
+		std::swap(compute_keypoints_when_tracking_pose_, reload_instance.compute_keypoints_when_tracking_pose_);
+		std::swap(compute_keypoints_when_recovering_pose_tracking_, reload_instance.compute_keypoints_when_recovering_pose_tracking_);
+		std::swap(compute_keypoints_when_estimating_initial_pose_, reload_instance.compute_keypoints_when_estimating_initial_pose_);
+	}
+
+	if (modules_names.count("cloud_matchers_configurations") > 0) {
+		std::swap(ignore_height_corrections_, reload_instance.ignore_height_corrections_);
+		std::swap(use_internal_tracking_, reload_instance.use_internal_tracking_);
+		std::swap(last_pose_weighted_mean_filter_, reload_instance.last_pose_weighted_mean_filter_);
+		std::swap(pose_tracking_timeout_, reload_instance.pose_tracking_timeout_);
+		std::swap(pose_tracking_recovery_timeout_, reload_instance.pose_tracking_recovery_timeout_);
+		std::swap(initial_pose_estimation_timeout_, reload_instance.initial_pose_estimation_timeout_);
+		std::swap(pose_tracking_minimum_number_of_failed_registrations_since_last_valid_pose_, reload_instance.pose_tracking_minimum_number_of_failed_registrations_since_last_valid_pose_);
+		std::swap(pose_tracking_maximum_number_of_failed_registrations_since_last_valid_pose_, reload_instance.pose_tracking_maximum_number_of_failed_registrations_since_last_valid_pose_);
+		std::swap(pose_tracking_recovery_minimum_number_of_failed_registrations_since_last_valid_pose_, reload_instance.pose_tracking_recovery_minimum_number_of_failed_registrations_since_last_valid_pose_);
+		std::swap(pose_tracking_recovery_maximum_number_of_failed_registrations_since_last_valid_pose_, reload_instance.pose_tracking_recovery_maximum_number_of_failed_registrations_since_last_valid_pose_);
+	}
+
+	if (modules_names.count("initial_pose_estimators_feature_matchers") > 0) {
+		std::swap(initial_pose_estimators_feature_matchers_, reload_instance.initial_pose_estimators_feature_matchers_);
+		initial_pose_estimators_feature_matchers_reference_pointcloud_outdated_ = reload_instance.initial_pose_estimators_feature_matchers_reference_pointcloud_outdated_;
+	}
+
+	if (modules_names.count("initial_pose_estimators_point_matchers") > 0)
+		std::swap(initial_pose_estimators_point_matchers_, reload_instance.initial_pose_estimators_point_matchers_);
+
+	if (modules_names.count("tracking_matchers") > 0)
+		std::swap(tracking_matchers_, reload_instance.tracking_matchers_);
+
+	if (modules_names.count("tracking_recovery_matchers") > 0) {
+		std::swap(tracking_recovery_matchers_, reload_instance.tracking_recovery_matchers_);
+		std::swap(tracking_recovery_portfolio_, reload_instance.tracking_recovery_portfolio_);
+	}
+
+	if (modules_names.count("transformation_aligner") > 0)
+		std::swap(transformation_aligner_, reload_instance.transformation_aligner_);
+
+	if (modules_names.count("outlier_detectors") > 0) {
+		std::swap(outlier_detectors_, reload_instance.outlier_detectors_);
+		std::swap(aligned_pointcloud_global_outliers_publish_topic_, reload_instance.aligned_pointcloud_global_outliers_publish_topic_);
+		std::swap(aligned_pointcloud_global_inliers_publish_topic_, reload_instance.aligned_pointcloud_global_inliers_publish_topic_);
+		std::swap(aligned_pointcloud_global_inliers_and_outliers_publish_topic_, reload_instance.aligned_pointcloud_global_inliers_and_outliers_publish_topic_);
+	}
+
+	if (modules_names.count("outlier_detectors_reference_pointcloud") > 0) {
+		std::swap(outlier_detectors_reference_pointcloud_, reload_instance.outlier_detectors_reference_pointcloud_);
+		std::swap(reference_pointcloud_global_outliers_publish_topic_, reload_instance.reference_pointcloud_global_outliers_publish_topic_);
+		std::swap(reference_pointcloud_global_inliers_publish_topic_, reload_instance.reference_pointcloud_global_inliers_publish_topic_);
+		std::swap(reference_pointcloud_global_inliers_and_outliers_publish_topic_, reload_instance.reference_pointcloud_global_inliers_and_outliers_publish_topic_);
+	}
+
+	if (modules_names.count("cloud_analyzers") > 0) {
+		std::swap(compute_inliers_angular_distribution_, reload_instance.compute_inliers_angular_distribution_);
+		std::swap(compute_outliers_angular_distribution_, reload_instance.compute_outliers_angular_distribution_);
+		std::swap(cloud_analyzer_, reload_instance.cloud_analyzer_);
+	}
+
+	if (modules_names.count("transformation_validators_for_initial_alignment") > 0)
+		std::swap(transformation_validators_initial_alignment_, reload_instance.transformation_validators_initial_alignment_);
+
+	if (modules_names.count("transformation_validators_for_tracking") > 0)
+		std::swap(transformation_validators_, reload_instance.transformation_validators_);
+
+	if (modules_names.count("transformation_validators_for_tracking_recovery") > 0)
+		std::swap(transformation_validators_tracking_recovery_, reload_instance.transformation_validators_tracking_recovery_);
+
+	if (modules_names.count("registration_covariance_estimators") > 0)
+		std::swap(registration_covariance_estimator_, reload_instance.registration_covariance_estimator_);
+
+	if (modules_names.count("memory_management") > 0) {
+		std::swap(memory_management_check_period_, reload_instance.memory_management_check_period_);
+		std::swap(memory_budget_total_bytes_, reload_instance.memory_budget_total_bytes_);
+		std::swap(memory_budget_reference_pointcloud_bytes_, reload_instance.memory_budget_reference_pointcloud_bytes_);
+		std::swap(memory_budget_circular_buffer_bytes_, reload_instance.memory_budget_circular_buffer_bytes_);
+		std::swap(memory_budget_caches_bytes_, reload_instance.memory_budget_caches_bytes_);
+		std::swap(reference_pointcloud_downsampling_leaf_size_, reload_instance.reference_pointcloud_downsampling_leaf_size_);
+		std::swap(reference_pointcloud_downsampling_leaf_size_growth_factor_, reload_instance.reference_pointcloud_downsampling_leaf_size_growth_factor_);
+		std::swap(circular_buffer_minimum_number_of_points_, reload_instance.circular_buffer_minimum_number_of_points_);
+	}
+}
+
+
+template<typename PointT>
+void Localization<PointT>::swapReferencePointCloud(Localization<PointT>& reload_instance) {
+	std::swap(reference_pointcloud_, reload_instance.reference_pointcloud_);
+	std::swap(reference_pointcloud_keypoints_, reload_instance.reference_pointcloud_keypoints_);
+	std::swap(reference_pointcloud_search_method_, reload_instance.reference_pointcloud_search_method_);
+	std::swap(reference_pointcloud_for_outlier_detection_, reload_instance.reference_pointcloud_for_outlier_detection_);
+	std::swap(reference_pointcloud_search_method_for_outlier_detection_, reload_instance.reference_pointcloud_search_method_for_outlier_detection_);
+	std::swap(tiled_reference_map_, reload_instance.tiled_reference_map_);
+	std::swap(tiled_reference_map_correspondences_lookup_table_grids_, reload_instance.tiled_reference_map_correspondences_lookup_table_grids_);
+	std::swap(tiled_reference_map_covariances_caches_, reload_instance.tiled_reference_map_covariances_caches_);
+	std::swap(tiled_reference_map_voxel_maps_, reload_instance.tiled_reference_map_voxel_maps_);
+	std::swap(reference_pointcloud_loaded_, reload_instance.reference_pointcloud_loaded_);
+	std::swap(last_map_received_time_, reload_instance.last_map_received_time_);
+	reference_pointcloud_keypoints_voxel_hash_search_.reset();
+}
+
+
+template<typename PointT>
+void Localization<PointT>::updateCloudFiltersTfCollector() {
+	std::vector< typename CloudFilter<PointT>::Ptr >* filters_containers[] = { &reference_cloud_filters_, &ambient_pointcloud_integration_filters_, &ambient_pointcloud_integration_filters_map_frame_,
+			&ambient_pointcloud_feature_registration_filters_, &ambient_pointcloud_map_frame_feature_registration_filters_, &ambient_pointcloud_filters_, &ambient_pointcloud_filters_for_outlier_detection_,
+			&ambient_pointcloud_filters_custom_frame_, &ambient_pointcloud_filters_map_frame_, &ambient_pointcloud_filters_after_normal_estimation_ };
+	for (size_t i = 0; i < sizeof(filters_containers) / sizeof(filters_containers[0]); ++i) {
+		for (size_t j = 0; j < filters_containers[i]->size(); ++j) {
+			if ((*filters_containers[i])[j]) { (*filters_containers[i])[j]->setTfCollector(&(pose_to_tf_publisher_->getTfCollector())); }
+		}
+	}
+}
+
+
+template<typename PointT>
+void Localization<PointT>::computeConfigurationFingerprints(const dynamic_robot_localization::LocalizationConfiguration& localization_configuration, ConfigurationFingerprints::FingerprintsMap& configuration_fingerprints) {
+	std::map<std::string, XmlRpc::XmlRpcValue> configurations; // one parameter server request for each configuration namespace
+	computeConfigurationFingerprint("message_management", localization_configuration.message_management, { "message_management" }, configurations, configuration_fingerprints);
+	computeConfigurationFingerprint("general_configurations", localization_configuration.general_configurations, { "general_configurations" }, configurations, configuration_fingerprints);
+	computeConfigurationFingerprint("subscribe_topic_names", localization_configuration.subscribe_topic_names, { "subscribe_topic_names" }, configurations, configuration_fingerprints);
+	computeConfigurationFingerprint("service_servers_names", localization_configuration.service_servers_names, { "service_servers_names" }, configurations, configuration_fingerprints);
+	computeConfigurationFingerprint("publish_topic_names", localization_configuration.publish_topic_names, { "publish_topic_names", "reference_pointcloud_publisher" }, configurations, configuration_fingerprints);
+	computeConfigurationFingerprint("frame_ids", localization_configuration.frame_ids, { "frame_ids" }, configurations, configuration_fingerprints);
+	computeConfigurationFingerprint("reference_pointcloud", localization_configuration.reference_pointcloud, { "reference_pointclouds_database_folder_path", "reference_pointclouds" }, configurations, configuration_fingerprints);
+	computeConfigurationFingerprint("filters", localization_configuration.filters, { "filters" }, configurations, configuration_fingerprints);
+	computeConfigurationFingerprint("normal_estimators", localization_configuration.normal_estimators, { "normal_estimators" }, configurations, configuration_fingerprints);
+	computeConfigurationFingerprint("curvature_estimators", localization_configuration.curvature_estimators, { "curvature_estimators" }, configurations, configuration_fingerprints);
+	computeConfigurationFingerprint("keypoint_detectors", localization_configuration.keypoint_detectors, { "keypoint_detectors" }, configurations, configuration_fingerprints);
+	computeConfigurationFingerprint("cloud_matchers_configurations", localization_configuration.cloud_matchers_configurations, { "tracking_matchers", "initial_pose_estimators_matchers" }, configurations, configuration_fingerprints);
+	computeConfigurationFingerprint("initial_pose_estimators_feature_matchers", localization_configuration.initial_pose_estimators_feature_matchers, { "initial_pose_estimators_matchers/feature_matchers" }, configurations, configuration_fingerprints);
+	computeConfigurationFingerprint("initial_pose_estimators_point_matchers", localization_configuration.initial_pose_estimators_point_matchers, { "initial_pose_estimators_matchers/point_matchers" }, configurations, configuration_fingerprints);
+	computeConfigurationFingerprint("tracking_matchers", localization_configuration.tracking_matchers, { "tracking_matchers" }, configurations, configuration_fingerprints);
+	computeConfigurationFingerprint("tracking_recovery_matchers", localization_configuration.tracking_recovery_matchers, { "tracking_recovery_matchers", "tracking_recovery_portfolio" }, configurations, configuration_fingerprints);
+	computeConfigurationFingerprint("transformation_aligner", localization_configuration.transformation_aligner, { "transformation_aligner" }, configurations, configuration_fingerprints);
+	computeConfigurationFingerprint("outlier_detectors", localization_configuration.outlier_detectors, { "outlier_detectors" }, configurations, configuration_fingerprints);
+	computeConfigurationFingerprint("outlier_detectors_reference_pointcloud", localization_configuration.outlier_detectors_reference_pointcloud, { "outlier_detectors_reference_pointcloud" }, configurations, configuration_fingerprints);
+	computeConfigurationFingerprint("cloud_analyzers", localization_configuration.cloud_analyzers, { "cloud_analyzers" }, configurations, configuration_fingerprints);
+	computeConfigurationFingerprint("transformation_validators_for_initial_alignment", localization_configuration.transformation_validators_for_initial_alignment, { "transformation_validators_initial_alignment" }, configurations, configuration_fingerprints);
+	computeConfigurationFingerprint("transformation_validators_for_tracking", localization_configuration.transformation_validators_for_tracking, { "transformation_validators" }, configurations, configuration_fingerprints);
+	computeConfigurationFingerprint("transformation_validators_for_tracking_recovery", localization_configuration.transformation_validators_for_tracking_recovery, { "transformation_validators_tracking_recovery" }, configurations, configuration_fingerprints);
+	computeConfigurationFingerprint("registration_covariance_estimators", localization_configuration.registration_covariance_estimators, { "registration_covariance_estimator" }, configurations, configuration_fingerprints);
+	computeConfigurationFingerprint("tf_publisher", localization_configuration.tf_publisher, { "pose_to_tf_publisher" }, configurations, configuration_fingerprints);
+	computeConfigurationFingerprint("tracing", localization_configuration.tracing, { "tracing" }, configurations, configuration_fingerprints);
+	computeConfigurationFingerprint("memory_management", localization_configuration.memory_management, { "memory_management" }, configurations, configuration_fingerprints);
+
+	// the reference point cloud must also be reloaded when its file changes
+	std::string parsed_string;
+	ConfigurationFingerprints::FingerprintsMap::iterator reference_pointcloud_fingerprint = configuration_fingerprints.find("reference_pointcloud");
+	if (reference_pointcloud_fingerprint != configuration_fingerprints.end() && s_parseConfigurationNamespaceFromParameterServer(localization_configuration.reference_pointcloud, parsed_string)) {
+		std::string reference_pointcloud_filename, reference_pointclouds_database_folder_path;
+		private_node_handle_->param(parsed_string + "reference_pointclouds/reference_pointcloud_filename", reference_pointcloud_filename, std::string(""));
+		private_node_handle_->param(parsed_string + "reference_pointclouds_database_folder_path", reference_pointclouds_database_folder_path, std::string(""));
+		if (!reference_pointcloud_filename.empty()) {
+			std::string reference_pointcloud_filepath = pointcloud_utils::parseFilePath(reference_pointcloud_filename, reference_pointclouds_database_folder_path);
+			if (pointcloud_utils::getFileExtension(reference_pointcloud_filename).empty()) { reference_pointcloud_filepath += ".ply"; }
+			reference_pointcloud_fingerprint->second = ConfigurationFingerprints::s_computeFileFingerprint(reference_pointcloud_filepath, reference_pointcloud_fingerprint->second);
+		}
+	}
+}
+
+
+template<typename PointT>
+void Localization<PointT>::computeConfigurationFingerprint(const std::string& module_name, const std::string& configuration_namespace, const std::vector<std::string>& parameters_namespaces,
+		std::map<std::string, XmlRpc::XmlRpcValue>& configurations, ConfigurationFingerprints::FingerprintsMap& configuration_fingerprints) {
+	std::string parsed_string;
+	if (!s_parseConfigurationNamespaceFromParameterServer(configuration_namespace, parsed_string)) { return; }
+
+	std::map<std::string, XmlRpc::XmlRpcValue>::iterator configuration = configurations.find(parsed_string);
+	if (configuration == configurations.end()) {
+		configuration = configurations.insert(std::make_pair(parsed_string, XmlRpc::XmlRpcValue())).first;
+		std::string parameter_server_namespace = parsed_string;
+		if (!parameter_server_namespace.empty()) { parameter_server_namespace.pop_back(); } // removes the '/' added when parsing
+		private_node_handle_->getParam(parameter_server_namespace, configuration->second);
+	}
+
+	std::uint64_t fingerprint = ConfigurationFingerprints::s_computeHash(module_name);
+	for (size_t i = 0; i < parameters_namespaces.size(); ++i) {
+		fingerprint = ConfigurationFingerprints::s_computeParametersFingerprint(configuration->second, parameters_namespaces[i], fingerprint);
+	}
+	configuration_fingerprints[module_name] = fingerprint;
+}
+
+
+template<typename PointT>
+bool Localization<PointT>::checkIfConfigurationMustBeReloaded(const std::string& module_name, const std::string& configuration_namespace, const ConfigurationFingerprints::FingerprintsMap& configuration_fingerprints,
+		bool reload_unchanged_modules, std::string& configuration_namespace_parsed_out) {
+	if (!s_parseConfigurationNamespaceFromParameterServer(configuration_namespace, configuration_namespace_parsed_out)) { return false; }
+
+	ConfigurationFingerprints::FingerprintsMap::const_iterator fingerprint = configuration_fingerprints.find(module_name);
+	if (fingerprint == configuration_fingerprints.end()) { return true; }
+
+	if (reload_unchanged_modules || configuration_fingerprints_.hasChanged(module_name, fingerprint->second)) { return true; }
+
+	ROS_DEBUG_STREAM("Skipped reloading of [" << module_name << "] because its configuration did not change");
+	return false;
+}
+
+
+template<typename PointT>
+void Localization<PointT>::s_setLocalizationConfigurationNamespaces(dynamic_robot_localization::LocalizationConfiguration& localization_configuration, const std::string& configuration_namespace) {
+	std::string localization_configuration_namespace = (configuration_namespace.empty() ? "~" : configuration_namespace);
+	localization_configuration.message_management = localization_configuration_namespace;
+	localization_configuration.general_configurations = localization_configuration_namespace;
+	localization_configuration.subscribe_topic_names = localization_configuration_namespace;
+	localization_configuration.service_servers_names = localization_configuration_namespace;
+	localization_configuration.publish_topic_names = localization_configuration_namespace;
+	localization_configuration.frame_ids = localization_configuration_namespace;
+	localization_configuration.reference_pointcloud = localization_configuration_namespace;
+	localization_configuration.filters = localization_configuration_namespace;
+	localization_configuration.normal_estimators = localization_configuration_namespace;
+	localization_configuration.curvature_estimators = localization_configuration_namespace;
+	localization_configuration.keypoint_detectors = localization_configuration_namespace;
+	localization_configuration.cloud_matchers_configurations = localization_configuration_namespace;
+	localization_configuration.initial_pose_estimators_feature_matchers = localization_configuration_namespace;
+	localization_configuration.initial_pose_estimators_point_matchers = localization_configuration_namespace;
+	localization_configuration.tracking_matchers = localization_configuration_namespace;
+	localization_configuration.tracking_recovery_matchers = localization_configuration_namespace;
+	localization_configuration.transformation_aligner = localization_configuration_namespace;
+	localization_configuration.outlier_detectors = localization_configuration_namespace;
+	localization_configuration.outlier_detectors_reference_pointcloud = localization_configuration_namespace;
+	localization_configuration.cloud_analyzers = localization_configuration_namespace;
+	localization_configuration.transformation_validators_for_initial_alignment = localization_configuration_namespace;
+	localization_configuration.transformation_validators_for_tracking = localization_configuration_namespace;
+	localization_configuration.transformation_validators_for_tracking_recovery = localization_configuration_namespace;
+	localization_configuration.registration_covariance_estimators = localization_configuration_namespace;
+	localization_configuration.tf_publisher = localization_configuration_namespace;
+	localization_configuration.tracing = localization_configuration_namespace;
+	localization_configuration.memory_management = localization_configuration_namespace;
 }
 
 
@@ -321,6 +909,7 @@ void Localization<PointT>::setupServiceServersNamesFromParameterServer(const std
 	private_node_handle_->param(configuration_namespace + "service_servers_names/reload_localization_configuration_service_server_name", reload_localization_configuration_service_server_name_, std::string("reload_localization_configuration"));
 	private_node_handle_->param(configuration_namespace + "service_servers_names/start_processing_sensor_data_service_server_name", start_processing_sensor_data_service_server_name_, std::string("start_processing_sensor_data"));	
 	private_node_handle_->param(configuration_namespace + "service_servers_names/stop_processing_sensor_data_service_server_name", stop_processing_sensor_data_service_server_name_, std::string("stop_processing_sensor_data"));
+	private_node_handle_->param(configuration_namespace + "service_servers_names/publish_reference_pointcloud_service_server_name", publish_reference_pointcloud_service_server_name_, std::string("publish_reference_pointcloud"));
 }
 
 template<typename PointT>
@@ -339,6 +928,7 @@ void Localization<PointT>::setupPublishTopicNamesFromParameterServer(const std::
 	private_node_handle_->param(configuration_namespace + "publish_topic_names/localization_detailed_publish_topic", localization_detailed_publish_topic_, std::string("localization_detailed"));
 	private_node_handle_->param(configuration_namespace + "publish_topic_names/localization_diagnostics_publish_topic", localization_diagnostics_publish_topic_, std::string("diagnostics"));
 	private_node_handle_->param(configuration_namespace + "publish_topic_names/localization_times_publish_topic", localization_times_publish_topic_, std::string("localization_times"));
+	private_node_handle_->param(configuration_namespace + "publish_topic_names/localization_tracing_publish_topic", localization_tracing_publish_topic_, std::string("localization_tracing"));
 }
 
 
@@ -451,6 +1041,59 @@ void Localization<PointT>::setupTFPublisherFromParameterServer(const std::string
 }
 
 
+template<typename PointT>
+void Localization<PointT>::setupTracingFromParameterServer(const std::string& configuration_namespace) {
+	ROS_DEBUG_STREAM("Loading [tracing] configurations from parameter server namespace [" << (configuration_namespace.empty() ? "~" : configuration_namespace) << "]");
+	Tracer& tracer = Tracer::getInstance();
+
+	int ring_buffer_size;
+	private_node_handle_->param(configuration_namespace + "tracing/ring_buffer_size", ring_buffer_size, 65536);
+	if (ring_buffer_size > 0) tracer.setRingBufferSize((size_t)ring_buffer_size);
+
+	private_node_handle_->param(configuration_namespace + "tracing/statistics_time_window_in_seconds", tracing_statistics_time_window_in_seconds_, 10.0);
+
+	double statistics_publish_period_in_seconds;
+	private_node_handle_->param(configuration_namespace + "tracing/statistics_publish_period_in_seconds", statistics_publish_period_in_seconds, 1.0);
+	tracing_statistics_publish_period_.fromSec(statistics_publish_period_in_seconds);
+
+	private_node_handle_->param(configuration_namespace + "tracing/chrome_trace_filename", tracing_chrome_trace_filename_, std::string(""));
+	private_node_handle_->param(configuration_namespace + "tracing/slow_processing_chrome_trace_filename", tracing_slow_processing_chrome_trace_filename_, std::string(""));
+	private_node_handle_->param(configuration_namespace + "tracing/slow_processing_time_threshold_ms", tracing_slow_processing_time_threshold_ms_, 0.0);
+
+	bool enabled;
+	private_node_handle_->param(configuration_namespace + "tracing/enabled", enabled, false);
+	tracer.setEnabled(enabled);
+}
+
+
+template<typename PointT>
+void Localization<PointT>::setupMemoryManagementFromParameterServer(const std::string& configuration_namespace) {
+	ROS_DEBUG_STREAM("Loading [memory_management] configurations from parameter server namespace [" << (configuration_namespace.empty() ? "~" : configuration_namespace) << "]");
+
+	double check_period_in_seconds;
+	private_node_handle_->param(configuration_namespace + "memory_management/check_period_in_seconds", check_period_in_seconds, 5.0);
+	memory_management_check_period_.fromSec(check_period_in_seconds);
+
+	double budget_megabytes;
+	private_node_handle_->param(configuration_namespace + "memory_management/total_budget_megabytes", budget_megabytes, 0.0);
+	memory_budget_total_bytes_ = MemoryUsage::s_convertMegabytesToBytes(budget_megabytes);
+	private_node_handle_->param(configuration_namespace + "memory_management/reference_pointcloud_budget_megabytes", budget_megabytes, 0.0);
+	memory_budget_reference_pointcloud_bytes_ = MemoryUsage::s_convertMegabytesToBytes(budget_megabytes);
+	private_node_handle_->param(configuration_namespace + "memory_management/circular_buffer_budget_megabytes", budget_megabytes, 0.0);
+	memory_budget_circular_buffer_bytes_ = MemoryUsage::s_convertMegabytesToBytes(budget_megabytes);
+	private_node_handle_->param(configuration_namespace + "memory_management/caches_budget_megabytes", budget_megabytes, 0.0);
+	memory_budget_caches_bytes_ = MemoryUsage::s_convertMegabytesToBytes(budget_megabytes);
+
+	private_node_handle_->param(configuration_namespace + "memory_management/reference_pointcloud_downsampling_leaf_size", reference_pointcloud_downsampling_leaf_size_, 0.05);
+	private_node_handle_->param(configuration_namespace + "memory_management/reference_pointcloud_downsampling_leaf_size_growth_factor", reference_pointcloud_downsampling_leaf_size_growth_factor_, 1.25);
+	if (reference_pointcloud_downsampling_leaf_size_growth_factor_ < 1.0) reference_pointcloud_downsampling_leaf_size_growth_factor_ = 1.0;
+
+	int circular_buffer_minimum_number_of_points;
+	private_node_handle_->param(configuration_namespace + "memory_management/circular_buffer_minimum_number_of_points", circular_buffer_minimum_number_of_points, 1000);
+	circular_buffer_minimum_number_of_points_ = (size_t)std::max(circular_buffer_minimum_number_of_points, 0);
+}
+
+
 template<typename PointT>
 void Localization<PointT>::setupMessageManagementFromParameterServer(const std::string& configuration_namespace) {
 	ROS_DEBUG_STREAM("Loading [message_management] configurations from parameter server namespace [" << (configuration_namespace.empty() ? "~" : configuration_namespace) << "]");
@@ -492,10 +1135,54 @@ void Localization<PointT>::setupMessageManagementFromParameterServer(const std::
 	private_node_handle_->param(configuration_namespace + "message_management/maximum_number_points_ambient_pointcloud_circular_buffer", maximum_number_points_ambient_pointcloud_circular_buffer, 0);
 	ambient_pointcloud_with_circular_buffer_.reset();
 	if (maximum_number_points_ambient_pointcloud_circular_buffer > 0) {
-		ambient_pointcloud_with_circular_buffer_.reset(new CircularBufferPointCloud<PointT>(maximum_number_points_ambient_pointcloud_circular_buffer));
+		ambient_pointcloud_with_circular_buffer_.reset(new ChunkedCircularBufferPointCloud<PointT>(maximum_number_points_ambient_pointcloud_circular_buffer));
 	}
 	private_node_handle_->param(configuration_namespace + "message_management/limit_of_pointclouds_to_process", limit_of_pointclouds_to_process_, -1);
 
+	private_node_handle_->param(configuration_namespace + "message_management/processing_pipeline/enabled", processing_pipeline_enabled_, false);
+	int processing_pipeline_ingest_queue_size, processing_pipeline_registration_queue_size;
+	private_node_handle_->param(configuration_namespace + "message_management/processing_pipeline/ingest_queue_size", processing_pipeline_ingest_queue_size, 2);
+	private_node_handle_->param(configuration_namespace + "message_management/processing_pipeline/registration_queue_size", processing_pipeline_registration_queue_size, 2);
+	processing_pipeline_ingest_queue_.setCapacity((size_t)std::max(processing_pipeline_ingest_queue_size, 1));
+	processing_pipeline_registration_queue_.setCapacity((size_t)std::max(processing_pipeline_registration_queue_size, 1));
+
+	private_node_handle_->param(configuration_namespace + "message_management/multi_sensor_synchronization/enabled", multi_sensor_synchronization_enabled_, false);
+	int multi_sensor_synchronization_queue_size, ambient_pointcloud_subscriber_queue_size;
+	double multi_sensor_synchronization_window, multi_sensor_synchronization_maximum_wait_time;
+	std::string multi_sensor_synchronization_merge_policy;
+	private_node_handle_->param(configuration_namespace + "message_management/multi_sensor_synchronization/queue_size", multi_sensor_synchronization_queue_size, 4);
+	private_node_handle_->param(configuration_namespace + "message_management/multi_sensor_synchronization/subscriber_queue_size", ambient_pointcloud_subscriber_queue_size, 2);
+	private_node_handle_->param(configuration_namespace + "message_management/multi_sensor_synchronization/synchronization_window", multi_sensor_synchronization_window, 0.05);
+	private_node_handle_->param(configuration_namespace + "message_management/multi_sensor_synchronization/maximum_wait_time", multi_sensor_synchronization_maximum_wait_time, 0.2);
+	private_node_handle_->param(configuration_namespace + "message_management/multi_sensor_synchronization/merge_policy", multi_sensor_synchronization_merge_policy, std::string("LatestPerSensor"));
+	private_node_handle_->param(configuration_namespace + "message_management/multi_sensor_synchronization/merge_frame_id", multi_sensor_synchronization_merge_frame_id_, std::string(""));
+	ambient_pointcloud_subscriber_queue_size_ = (multi_sensor_synchronization_enabled_ ? std::max(ambient_pointcloud_subscriber_queue_size, 1) : 1);
+	multi_sensor_synchronizer_.setQueueCapacity((size_t)std::max(multi_sensor_synchronization_queue_size, 1));
+	multi_sensor_synchronizer_.setSynchronizationWindow(ros::Duration(std::max(multi_sensor_synchronization_window, 0.0)).toNSec());
+	multi_sensor_synchronizer_.setMaximumWaitTime(std::chrono::nanoseconds(ros::Duration(multi_sensor_synchronization_maximum_wait_time).toNSec()));
+	if (multi_sensor_synchronization_merge_policy == "AllWithinWindow") {
+		multi_sensor_synchronizer_.setMergePolicy(PointCloud2Synchronizer::AllWithinWindow);
+	} else {
+		multi_sensor_synchronizer_.setMergePolicy(PointCloud2Synchronizer::LatestPerSensor);
+	}
+
+	bool async_cloud_publisher_enabled;
+	int async_cloud_publisher_queue_size;
+	double async_cloud_publisher_max_queued_megabytes;
+	private_node_handle_->param(configuration_namespace + "message_management/async_cloud_publisher/enabled", async_cloud_publisher_enabled, true);
+	private_node_handle_->param(configuration_namespace + "message_management/async_cloud_publisher/queue_size", async_cloud_publisher_queue_size, 8);
+	private_node_handle_->param(configuration_namespace + "message_management/async_cloud_publisher/max_queued_megabytes", async_cloud_publisher_max_queued_megabytes, 64.0);
+	AsyncCloudPublisher& async_cloud_publisher = AsyncCloudPublisher::getInstance();
+	async_cloud_publisher.setMaximumQueueSize((size_t)std::max(async_cloud_publisher_queue_size, 1));
+	async_cloud_publisher.setMaximumQueuedBytes((size_t)(std::max(async_cloud_publisher_max_queued_megabytes, 0.0) * 1024.0 * 1024.0));
+	if (async_cloud_publisher_enabled) {
+		async_cloud_publisher.start();
+	} else {
+		async_cloud_publisher.stop();
+	}
+
+	ambient_pointcloud_ingestion_.setupConfigurationFromParameterServer(private_node_handle_, configuration_namespace + "message_management/ambient_pointcloud_ingestion/");
+
 	private_node_handle_->param(configuration_namespace + "message_management/localization_detailed_use_millimeters_in_root_mean_square_error_inliers", localization_detailed_use_millimeters_in_root_mean_square_error_inliers_, false);
 	private_node_handle_->param(configuration_namespace + "message_management/localization_detailed_use_millimeters_in_root_mean_square_error_of_last_registration_correspondences", localization_detailed_use_millimeters_in_root_mean_square_error_of_last_registration_correspondences_, false);
 	private_node_handle_->param(configuration_namespace + "message_management/localization_detailed_use_millimeters_in_translation_corrections", localization_detailed_use_millimeters_in_translation_corrections_, false);
@@ -518,10 +1205,13 @@ void Localization<PointT>::setupMessageManagementFromParameterServer(const std::
 template<typename PointT>
 void Localization<PointT>::setupReferencePointCloudFromParameterServer(const std::string& configuration_namespace) {
 	ROS_DEBUG_STREAM("Loading [reference_pointcloud] configurations from parameter server namespace [" << (configuration_namespace.empty() ? "~" : configuration_namespace) << "]");
+	reference_pointcloud_configuration_namespace_ = configuration_namespace;
 	private_node_handle_->param(configuration_namespace + "reference_pointclouds_database_folder_path", reference_pointclouds_database_folder_path_, std::string(""));
 	private_node_handle_->param(configuration_namespace + "reference_pointclouds/reference_pointcloud_filename", reference_pointcloud_filename_, std::string(""));
 	private_node_handle_->param(configuration_namespace + "reference_pointclouds/normalize_normals", reference_pointcloud_normalize_normals_, true);
 	private_node_handle_->param(configuration_namespace + "reference_pointclouds/reference_pointcloud_preprocessed_save_filename", reference_pointcloud_preprocessed_save_filename_, std::string(""));
+	private_node_handle_->param(configuration_namespace + "reference_pointclouds/reference_pointcloud_bundle/filename", reference_pointcloud_bundle_filename_, std::string(""));
+	private_node_handle_->param(configuration_namespace + "reference_pointclouds/reference_pointcloud_bundle/save_when_missing_or_outdated", reference_pointcloud_bundle_save_, true);
 	private_node_handle_->param(configuration_namespace + "reference_pointclouds/save_reference_pointclouds_in_binary_format", save_reference_pointclouds_in_binary_format_, true);
 	private_node_handle_->param(configuration_namespace + "reference_pointclouds/republish_reference_pointcloud_after_successful_registration", republish_reference_pointcloud_after_successful_registration_, false);
 	private_node_handle_->param(configuration_namespace + "reference_pointclouds/minimum_number_of_points_in_reference_pointcloud", minimum_number_of_points_in_reference_pointcloud_, 10);
@@ -550,6 +1240,25 @@ void Localization<PointT>::setupReferencePointCloudFromParameterServer(const std
 	}
 
 	private_node_handle_->param(configuration_namespace + "reference_pointclouds/use_incremental_map_update", use_incremental_map_update_, false);
+
+	private_node_handle_->param(configuration_namespace + "reference_pointclouds/tiled_map/tile_size", tiled_map_tile_size_, 0.0);
+	private_node_handle_->param(configuration_namespace + "reference_pointclouds/tiled_map/active_tiles_radius", tiled_map_active_tiles_radius_, 100.0);
+	private_node_handle_->param(configuration_namespace + "reference_pointclouds/tiled_map/tiles_folder_path", tiled_map_tiles_folder_path_, std::string(""));
+	if (tiled_map_tile_size_ > 0.0 && map_update_mode_ != NoIntegration) {
+		ROS_WARN("Tiled reference map is only supported with reference_pointcloud_update_mode NoIntegration (the full reference map will be used)");
+		tiled_map_tile_size_ = 0.0;
+	}
+
+	double voxel_hash_search_voxel_size;
+	private_node_handle_->param(configuration_namespace + "reference_pointclouds/voxel_hash_search/voxel_size", voxel_hash_search_voxel_size, 0.0);
+	if (voxel_hash_search_voxel_size > 0.0) {
+		int maximum_number_of_points_per_voxel, maximum_number_of_search_rings;
+		private_node_handle_->param(configuration_namespace + "reference_pointclouds/voxel_hash_search/maximum_number_of_points_per_voxel", maximum_number_of_points_per_voxel, 0);
+		private_node_handle_->param(configuration_namespace + "reference_pointclouds/voxel_hash_search/maximum_number_of_search_rings", maximum_number_of_search_rings, 3);
+		reference_pointcloud_search_method_ = typename pcl::search::KdTree<PointT>::Ptr(new VoxelHashSearch<PointT>(voxel_hash_search_voxel_size, maximum_number_of_points_per_voxel, maximum_number_of_search_rings));
+	} else if (std::dynamic_pointer_cast< VoxelHashSearch<PointT> >(reference_pointcloud_search_method_)) {
+		reference_pointcloud_search_method_ = typename pcl::search::KdTree<PointT>::Ptr(new pcl::search::KdTree<PointT>());
+	}
 	reference_pointcloud_->header.frame_id = map_frame_id_for_publishing_pointclouds_;
 }
 
@@ -557,6 +1266,7 @@ void Localization<PointT>::setupReferencePointCloudFromParameterServer(const std
 template<typename PointT>
 void Localization<PointT>::setupCloudFiltersFromParameterServer(const std::string& configuration_namespace) {
 	ROS_DEBUG_STREAM("Loading [filters] configurations from parameter server namespace [" << (configuration_namespace.empty() ? "~" : configuration_namespace) << "]");
+	filters_configuration_namespace_ = configuration_namespace;
 
 	reference_cloud_filters_.clear();
 	ambient_pointcloud_integration_filters_.clear();
@@ -577,6 +1287,8 @@ void Localization<PointT>::setupCloudFiltersFromParameterServer(const std::strin
 	private_node_handle_->param(configuration_namespace + "filters/filtered_pointcloud_save_frame_id_with_cloud_time", filtered_pointcloud_save_frame_id_with_cloud_time_, false);
 	private_node_handle_->param(configuration_namespace + "filters/stop_processing_after_saving_filtered_pointcloud", stop_processing_after_saving_filtered_pointcloud_, true);
 
+	cloud_filter_chain_.setupConfigurationFromParameterServer(private_node_handle_, configuration_namespace + "filters/filter_chain/");
+
 	setupCloudFiltersFromParameterServer(reference_cloud_filters_, configuration_namespace + "filters/reference_pointcloud/");
 	setupCloudFiltersFromParameterServer(ambient_pointcloud_integration_filters_, configuration_namespace + "filters/ambient_pointcloud_integration_filters/");
 	setupCloudFiltersFromParameterServer(ambient_pointcloud_integration_filters_map_frame_, configuration_namespace + "filters/ambient_pointcloud_integration_filters_map_frame/");
@@ -646,6 +1358,7 @@ void Localization<PointT>::s_setupCloudFiltersFromParameterServer(std::vector< t
 template<typename PointT>
 void Localization<PointT>::setupNormalEstimatorsFromParameterServer(const std::string& configuration_namespace) {
 	ROS_DEBUG_STREAM("Loading [normal_estimators] configurations from parameter server namespace [" << (configuration_namespace.empty() ? "~" : configuration_namespace) << "]");
+	normal_estimators_configuration_namespace_ = configuration_namespace;
 	private_node_handle_->param(configuration_namespace + "normal_estimators/ambient_pointcloud/compute_normals_when_tracking_pose", compute_normals_when_tracking_pose_, false);
 	private_node_handle_->param(configuration_namespace + "normal_estimators/ambient_pointcloud/compute_normals_when_recovering_pose_tracking", compute_normals_when_recovering_pose_tracking_, false);
 	private_node_handle_->param(configuration_namespace + "normal_estimators/ambient_pointcloud/compute_normals_when_estimating_initial_pose", compute_normals_when_estimating_initial_pose_, true);
@@ -702,6 +1415,10 @@ void Localization<PointT>::updateNormalsEstimatorsFlags() {
 		}
 	}
 
+	if (tracking_recovery_portfolio_ && tracking_recovery_portfolio_->registrationRequiresNormalsOnAmbientPointCloud()) {
+		compute_normals_when_recovering_pose_tracking_ = true;
+	}
+
 	for (size_t i = 0; i < initial_pose_estimators_point_matchers_.size(); ++i) {
 		if (initial_pose_estimators_point_matchers_[i]->registrationRequiresNormalsOnAmbientPointCloud()) {
 			compute_normals_when_estimating_initial_pose_ = true;
@@ -719,6 +1436,7 @@ void Localization<PointT>::updateNormalsEstimatorsFlags() {
 template<typename PointT>
 void Localization<PointT>::setupCurvatureEstimatorsFromParameterServer(const std::string& configuration_namespace) {
 	ROS_DEBUG_STREAM("Loading [curvature_estimators] configurations from parameter server namespace [" << (configuration_namespace.empty() ? "~" : configuration_namespace) << "]");
+	curvature_estimators_configuration_namespace_ = configuration_namespace;
 	setupCurvatureEstimatorFromParameterServer(reference_cloud_curvature_estimator_, configuration_namespace + "curvature_estimators/reference_pointcloud/");
 	setupCurvatureEstimatorFromParameterServer(ambient_cloud_curvature_estimator_, configuration_namespace + "curvature_estimators/ambient_pointcloud/");
 }
@@ -755,6 +1473,7 @@ void Localization<PointT>::s_setupCurvatureEstimatorFromParameterServer(typename
 template<typename PointT>
 void Localization<PointT>::setupKeypointDetectorsFromParameterServer(const std::string& configuration_namespace) {
 	ROS_DEBUG_STREAM("Loading [keypoint_detectors] configurations from parameter server namespace [" << (configuration_namespace.empty() ? "~" : configuration_namespace) << "]");
+	keypoint_detectors_configuration_namespace_ = configuration_namespace;
 
 	reference_cloud_keypoint_detectors_.clear();
 	ambient_cloud_keypoint_detectors_.clear();
@@ -857,6 +1576,73 @@ void Localization<PointT>::setupTrackingRecoveryMatchersFromParameterServer(cons
 	tracking_recovery_matchers_.clear();
 	setupFeatureCloudMatchersFromParameterServer(tracking_recovery_matchers_, "tracking_recovery_matchers/feature_matchers/");
 	setupCloudMatchersFromParameterServer(tracking_recovery_matchers_, "tracking_recovery_matchers/point_matchers/");
+	setupTrackingRecoveryPortfolioFromParameterServer(configuration_namespace);
+}
+
+
+template<typename PointT>
+void Localization<PointT>::setupTrackingRecoveryPortfolioFromParameterServer(const std::string& configuration_namespace) {
+	tracking_recovery_portfolio_.reset();
+	std::string portfolio_configuration_namespace = configuration_namespace + "tracking_recovery_portfolio/";
+	bool use_tracking_recovery_portfolio = false;
+	private_node_handle_->param(portfolio_configuration_namespace + "use_tracking_recovery_portfolio", use_tracking_recovery_portfolio, false);
+	if (!use_tracking_recovery_portfolio) { return; }
+
+	ROS_DEBUG_STREAM("Loading [tracking_recovery_portfolio] configurations from parameter server namespace [" << (configuration_namespace.empty() ? "~" : configuration_namespace) << "]");
+	typename TrackingRecoveryPortfolio<PointT>::Ptr tracking_recovery_portfolio(new TrackingRecoveryPortfolio<PointT>());
+
+	int number_of_threads, number_of_initial_guesses_from_last_accepted_poses;
+	double minimum_translation_between_initial_guesses, minimum_rotation_between_initial_guesses, max_inliers_distance;
+	private_node_handle_->param(portfolio_configuration_namespace + "number_of_threads", number_of_threads, 0);
+	private_node_handle_->param(portfolio_configuration_namespace + "number_of_initial_guesses_from_last_accepted_poses", number_of_initial_guesses_from_last_accepted_poses, 0);
+	private_node_handle_->param(portfolio_configuration_namespace + "minimum_translation_between_initial_guesses", minimum_translation_between_initial_guesses, 0.5);
+	private_node_handle_->param(portfolio_configuration_namespace + "minimum_rotation_between_initial_guesses", minimum_rotation_between_initial_guesses, 0.3);
+	private_node_handle_->param(portfolio_configuration_namespace + "max_inliers_distance", max_inliers_distance, 0.1);
+	number_of_initial_guesses_from_last_accepted_poses = std::max(0, number_of_initial_guesses_from_last_accepted_poses);
+
+	tracking_recovery_portfolio->setNumberOfThreads(number_of_threads);
+	tracking_recovery_portfolio->setMaximumNumberOfAcceptedPoses((size_t)number_of_initial_guesses_from_last_accepted_poses);
+	tracking_recovery_portfolio->setMinimumTranslationBetweenInitialGuesses(minimum_translation_between_initial_guesses);
+	tracking_recovery_portfolio->setMinimumRotationBetweenInitialGuesses(minimum_rotation_between_initial_guesses);
+	tracking_recovery_portfolio->setMaxInliersDistance(max_inliers_distance);
+	tracking_recovery_portfolio->setMinimumNumberOfPointsInAmbientPointCloud(minimum_number_of_points_in_ambient_pointcloud_);
+
+	// the tracking_recovery_matchers_ are used for the current pose estimate and new instances are created for the other initial guesses (the matchers are not thread safe)
+	if (!tracking_recovery_matchers_.empty()) {
+		std::vector< std::vector< typename CloudMatcher<PointT>::Ptr > > matchers_per_initial_guess(1, tracking_recovery_matchers_);
+		for (int i = 0; i < number_of_initial_guesses_from_last_accepted_poses; ++i) {
+			std::vector< typename CloudMatcher<PointT>::Ptr > matchers;
+			setupFeatureCloudMatchersFromParameterServer(matchers, "tracking_recovery_matchers/feature_matchers/");
+			setupCloudMatchersFromParameterServer(matchers, "tracking_recovery_matchers/point_matchers/");
+			matchers_per_initial_guess.push_back(matchers);
+		}
+		tracking_recovery_portfolio->addStrategy("tracking_recovery_matchers", matchers_per_initial_guess);
+	}
+
+	XmlRpc::XmlRpcValue strategies;
+	if (private_node_handle_->getParam(portfolio_configuration_namespace + "strategies", strategies) && strategies.getType() == XmlRpc::XmlRpcValue::TypeStruct) {
+		for (XmlRpc::XmlRpcValue::iterator it = strategies.begin(); it != strategies.end(); ++it) {
+			if (it->second.getType() != XmlRpc::XmlRpcValue::TypeStruct) { continue; }
+			std::string strategy_configuration_namespace = portfolio_configuration_namespace + "strategies/" + it->first + "/";
+			bool use_initial_guesses_from_last_accepted_poses = true;
+			private_node_handle_->param(strategy_configuration_namespace + "use_initial_guesses_from_last_accepted_poses", use_initial_guesses_from_last_accepted_poses, true);
+			int number_of_instances = use_initial_guesses_from_last_accepted_poses ? number_of_initial_guesses_from_last_accepted_poses + 1 : 1;
+
+			std::vector< std::vector< typename CloudMatcher<PointT>::Ptr > > matchers_per_initial_guess;
+			for (int i = 0; i < number_of_instances; ++i) {
+				std::vector< typename CloudMatcher<PointT>::Ptr > matchers;
+				setupFeatureCloudMatchersFromParameterServer(matchers, strategy_configuration_namespace + "feature_matchers/");
+				setupCloudMatchersFromParameterServer(matchers, strategy_configuration_namespace + "point_matchers/");
+				if (matchers.empty()) { break; }
+				matchers_per_initial_guess.push_back(matchers);
+			}
+			tracking_recovery_portfolio->addStrategy(it->first, matchers_per_initial_guess);
+		}
+	}
+
+	if (!tracking_recovery_portfolio->empty()) {
+		tracking_recovery_portfolio_ = tracking_recovery_portfolio;
+	}
 }
 
 
@@ -874,7 +1660,25 @@ void Localization<PointT>::s_setupCloudMatchersFromParameterServer(std::vector<
 		for (XmlRpc::XmlRpcValue::iterator it = matchers.begin(); it != matchers.end(); ++it) {
 			std::string matcher_name = it->first;
 			typename CloudMatcher<PointT>::Ptr cloud_matcher;
-			if (matcher_name.find("iterative_closest_point_generalized") != std::string::npos) {
+			if (matcher_name.find("multi_resolution_registration") != std::string::npos) {
+				typename MultiResolutionRegistration<PointT>::Ptr multi_resolution_registration(new MultiResolutionRegistration<PointT>());
+				std::string levels_configuration_namespace = configuration_namespace + matcher_name + "/levels/";
+				XmlRpc::XmlRpcValue levels;
+				if (private_node_handle->getParam(levels_configuration_namespace, levels) && levels.getType() == XmlRpc::XmlRpcValue::TypeStruct) {
+					for (XmlRpc::XmlRpcValue::iterator level_it = levels.begin(); level_it != levels.end(); ++level_it) {
+						if (level_it->second.getType() != XmlRpc::XmlRpcValue::TypeStruct) { continue; }
+						std::string level_configuration_namespace = levels_configuration_namespace + level_it->first + "/";
+						double voxel_grid_leaf_size = 0.0;
+						private_node_handle->param(level_configuration_namespace + "voxel_grid_leaf_size", voxel_grid_leaf_size, 0.0);
+						std::vector< typename CloudMatcher<PointT>::Ptr > level_matchers;
+						s_setupCloudMatchersFromParameterServer(level_matchers, level_configuration_namespace, node_handle, private_node_handle);
+						for (size_t i = 0; i < level_matchers.size(); ++i) {
+							multi_resolution_registration->addLevelMatcher(level_matchers[i], voxel_grid_leaf_size);
+						}
+					}
+				}
+				cloud_matcher = multi_resolution_registration;
+			} else if (matcher_name.find("iterative_closest_point_generalized") != std::string::npos) {
 				cloud_matcher.reset(new IterativeClosestPointGeneralized<PointT>());
 			} else if (matcher_name.find("iterative_closest_point_with_normals") != std::string::npos) {
 				cloud_matcher.reset(new IterativeClosestPointWithNormals<PointT>());
@@ -1204,16 +2008,70 @@ template<typename PointT>
 bool Localization<PointT>::loadReferencePointCloudFromFile(const std::string& reference_pointcloud_filename, const std::string& reference_pointclouds_database_folder_path) {
 	PerformanceTimer performance_timer;
 	performance_timer.start();
-	if (pointcloud_conversions::fromFile(*reference_pointcloud_, reference_pointcloud_filename, (reference_pointclouds_database_folder_path.empty() ? reference_pointclouds_database_folder_path_ : reference_pointclouds_database_folder_path))) {
+	std::string reference_pointclouds_folder_path = (reference_pointclouds_database_folder_path.empty() ? reference_pointclouds_database_folder_path_ : reference_pointclouds_database_folder_path);
+
+	std::string reference_pointcloud_bundle_filepath;
+	std::uint64_t reference_pointcloud_source_hash = 0;
+	std::uint64_t reference_pointcloud_configuration_hash = 0;
+	bool reference_pointcloud_hashes_available = false;
+	bool reference_pointcloud_loaded_from_bundle = false;
+
+	tiled_reference_map_.reset();
+	if (tiled_map_tile_size_ > 0.0) {
+		std::string tiles_folder_path = (tiled_map_tiles_folder_path_.empty() ? reference_pointcloud_filename + "_tiles" : tiled_map_tiles_folder_path_);
+		tiled_reference_map_ = typename TiledReferenceMap<PointT>::Ptr(new TiledReferenceMap<PointT>(pointcloud_utils::parseFilePath(tiles_folder_path, reference_pointclouds_folder_path), tiled_map_tile_size_, tiled_map_active_tiles_radius_));
+	}
+
+	if (!reference_pointcloud_bundle_filename_.empty() || tiled_reference_map_) {
+		std::string reference_pointcloud_filepath = pointcloud_utils::parseFilePath(reference_pointcloud_filename, reference_pointclouds_folder_path);
+		if (pointcloud_utils::getFileExtension(reference_pointcloud_filename).empty()) { reference_pointcloud_filepath += ".ply"; }
+		if (ReferenceMapBundle<PointT>::s_computeFileHash(reference_pointcloud_filepath, reference_pointcloud_source_hash)) {
+			reference_pointcloud_configuration_hash = computeReferencePointCloudConfigurationHash(reference_pointcloud_configuration_namespace_, filters_configuration_namespace_,
+					normal_estimators_configuration_namespace_, curvature_estimators_configuration_namespace_, keypoint_detectors_configuration_namespace_);
+			reference_pointcloud_hashes_available = true;
+		} else {
+			ROS_WARN_STREAM("Failed to compute the hash of the reference point cloud file " << reference_pointcloud_filepath << " (the reference map bundle and tiles will not be used)");
+			tiled_reference_map_.reset();
+		}
+	}
+
+	std::uint64_t reference_pointcloud_tiles_hash = ReferenceMapBundle<PointT>::s_computeHash(&reference_pointcloud_configuration_hash, sizeof(reference_pointcloud_configuration_hash), reference_pointcloud_source_hash);
+	if (tiled_reference_map_ && !reference_pointcloud_tiles_build_ && tiled_reference_map_->loadIndex(reference_pointcloud_tiles_hash)) {
+		double x, y;
+		private_node_handle_->param(configuration_namespace_ + "initial_pose/position/x", x, 0.0);
+		private_node_handle_->param(configuration_namespace_ + "initial_pose/position/y", y, 0.0);
+		last_map_received_time_ = ros::Time::now();
+		reference_pointcloud_for_outlier_detection_ = typename pcl::PointCloud<PointT>::Ptr();
+		reference_pointcloud_search_method_for_outlier_detection_ = typename pcl::search::KdTree<PointT>::Ptr();
+		bool reference_pointcloud_updated = updateReferencePointCloudTiles(x, y, last_map_received_time_, true);
+		ROS_INFO_STREAM("Loaded " << tiled_reference_map_->getNumberOfResidentTiles() << " reference map tiles around [ x: " << x << " | y: " << y << " ] with " << reference_pointcloud_->size() << " points and " << reference_pointcloud_keypoints_->size() << " keypoints in " << performance_timer.getElapsedTimeFormated());
+		return reference_pointcloud_updated;
+	}
+
+	if (tiled_reference_map_ && !reference_pointcloud_tiles_build_) {
+		ROS_WARN_STREAM("Reference map tiles in " << tiled_reference_map_->getTilesFolderPath() << " are missing or outdated and must be built offline with drl_reference_map_bundle_builder (the full reference map will be used)");
+		tiled_reference_map_.reset();
+	}
+
+	if (!reference_pointcloud_bundle_filename_.empty() && reference_pointcloud_hashes_available) {
+		reference_pointcloud_bundle_filepath = pointcloud_utils::parseFilePath(reference_pointcloud_bundle_filename_, reference_pointclouds_folder_path);
+		reference_pointcloud_loaded_from_bundle = ReferenceMapBundle<PointT>::s_load(reference_pointcloud_bundle_filepath, reference_pointcloud_source_hash, reference_pointcloud_configuration_hash, *reference_pointcloud_, *reference_pointcloud_keypoints_);
+	}
+
+	if (reference_pointcloud_loaded_from_bundle || pointcloud_conversions::fromFile(*reference_pointcloud_, reference_pointcloud_filename, reference_pointclouds_folder_path)) {
 		if (reference_pointcloud_->size() > (size_t)minimum_number_of_points_in_reference_pointcloud_) {
-			ROS_INFO_STREAM("Loaded reference point cloud from file " << reference_pointcloud_filename << " with " << reference_pointcloud_->size() << " points in " << performance_timer.getElapsedTimeFormated());
+			if (reference_pointcloud_loaded_from_bundle) {
+				ROS_INFO_STREAM("Loaded preprocessed reference point cloud from bundle " << reference_pointcloud_bundle_filepath << " with " << reference_pointcloud_->size() << " points and " << reference_pointcloud_keypoints_->size() << " keypoints in " << performance_timer.getElapsedTimeFormated());
+			} else {
+				ROS_INFO_STREAM("Loaded reference point cloud from file " << reference_pointcloud_filename << " with " << reference_pointcloud_->size() << " points in " << performance_timer.getElapsedTimeFormated());
+			}
 			reference_pointcloud_->header.frame_id = map_frame_id_for_publishing_pointclouds_;
 
 			last_map_received_time_ = ros::Time::now();
 			if (reference_cloud_normal_estimator_) reference_cloud_normal_estimator_->resetOccupancyGridMsg();
 
 			reference_pointcloud_for_outlier_detection_ = typename pcl::PointCloud<PointT>::Ptr(new pcl::PointCloud<PointT>());
-			if (pointcloud_conversions::fromFile(*reference_pointcloud_for_outlier_detection_, reference_pointcloud_filename + "_outlier_detection", (reference_pointclouds_database_folder_path.empty() ? reference_pointclouds_database_folder_path_ : reference_pointclouds_database_folder_path))) {
+			if (pointcloud_conversions::fromFile(*reference_pointcloud_for_outlier_detection_, reference_pointcloud_filename + "_outlier_detection", reference_pointclouds_folder_path)) {
 				reference_pointcloud_search_method_for_outlier_detection_ = typename pcl::search::KdTree<PointT>::Ptr(new pcl::search::KdTree<PointT>());
 				reference_pointcloud_search_method_for_outlier_detection_->setInputCloud(reference_pointcloud_for_outlier_detection_);
 				ROS_DEBUG_STREAM("Loaded a different point cloud for outlier detection with " << reference_pointcloud_for_outlier_detection_->size() << " points");
@@ -1222,7 +2080,27 @@ bool Localization<PointT>::loadReferencePointCloudFromFile(const std::string& re
 				reference_pointcloud_search_method_for_outlier_detection_ = typename pcl::search::KdTree<PointT>::Ptr();
 			}
 
-			return updateLocalizationPipelineWithNewReferenceCloud(ros::Time::now());
+			bool reference_pointcloud_updated = updateLocalizationPipelineWithNewReferenceCloud(ros::Time::now(), reference_pointcloud_loaded_from_bundle);
+			if (reference_pointcloud_updated && !reference_pointcloud_loaded_from_bundle && reference_pointcloud_bundle_save_ && !reference_pointcloud_bundle_filepath.empty()) {
+				performance_timer.restart();
+				if (ReferenceMapBundle<PointT>::s_save(reference_pointcloud_bundle_filepath, reference_pointcloud_source_hash, reference_pointcloud_configuration_hash, *reference_pointcloud_, *reference_pointcloud_keypoints_)) {
+					ROS_INFO_STREAM("Saved reference map bundle " << reference_pointcloud_bundle_filepath << " with " << reference_pointcloud_->size() << " points and " << reference_pointcloud_keypoints_->size() << " keypoints in " << performance_timer.getElapsedTimeFormated());
+				} else {
+					ROS_WARN_STREAM("Failed to save reference map bundle " << reference_pointcloud_bundle_filepath);
+				}
+			}
+
+			if (reference_pointcloud_updated && tiled_reference_map_) {
+				performance_timer.restart();
+				if (tiled_reference_map_->build(*reference_pointcloud_, *reference_pointcloud_keypoints_, reference_pointcloud_tiles_hash)) {
+					ROS_INFO_STREAM("Saved " << tiled_reference_map_->getNumberOfTiles() << " reference map tiles in " << tiled_reference_map_->getTilesFolderPath() << " in " << performance_timer.getElapsedTimeFormated());
+				} else {
+					ROS_WARN_STREAM("Failed to save reference map tiles in " << tiled_reference_map_->getTilesFolderPath());
+					reference_pointcloud_updated = false;
+				}
+				tiled_reference_map_.reset(); // the tiles are only used after being loaded from the tiles folder
+			}
+			return reference_pointcloud_updated;
 		}
 	}
 
@@ -1234,6 +2112,7 @@ bool Localization<PointT>::loadReferencePointCloudFromFile(const std::string& re
 
 template<typename PointT>
 void Localization<PointT>::loadReferencePointCloudFromROSPointCloud(const sensor_msgs::PointCloud2ConstPtr& reference_pointcloud_msg) {
+	std::lock_guard<std::mutex> localization_lock(localization_mutex_);
 	PerformanceTimer performance_timer;
 	performance_timer.start();
 	if ((reference_pointcloud_msg->width * reference_pointcloud_msg->height > (size_t)minimum_number_of_points_in_reference_pointcloud_) && (!reference_pointcloud_loaded_ || (ros::Time::now() - last_map_received_time_) > min_seconds_between_reference_pointcloud_update_)) {
@@ -1272,6 +2151,7 @@ void Localization<PointT>::loadReferencePointCloudFromROSPointCloud(const sensor
 
 template<typename PointT>
 void Localization<PointT>::loadReferencePointCloudFromROSOccupancyGrid(const nav_msgs::OccupancyGridConstPtr& occupancy_grid_msg) {
+	std::lock_guard<std::mutex> localization_lock(localization_mutex_);
 	PerformanceTimer performance_timer;
 	performance_timer.start();
 	size_t number_points_in_occupancy_grid = occupancy_grid_msg->info.width * occupancy_grid_msg->info.height;
@@ -1300,122 +2180,437 @@ void Localization<PointT>::loadReferencePointCloudFromROSOccupancyGrid(const nav
 
 template<typename PointT>
 void Localization<PointT>::publishReferencePointCloud(const ros::Time& time_stamp, bool update_msg) {
-	if (!reference_pointcloud_publisher_.getTopic().empty()) {
-		if (!reference_pointcloud_msg_ || update_msg) {
-			reference_pointcloud_msg_ = sensor_msgs::PointCloud2Ptr(new sensor_msgs::PointCloud2());
-			pcl::toROSMsg(*reference_pointcloud_, *reference_pointcloud_msg_);
+	if (reference_pointcloud_publisher_ && reference_pointcloud_) {
+		if (update_msg) { reference_pointcloud_publisher_->setReferencePointCloud(reference_pointcloud_); }
+		if (reference_pointcloud_publisher_->publishPendingChanges(time_stamp)) {
+			ROS_DEBUG_STREAM("Published reference point cloud with " << reference_pointcloud_->size() << " points and frame_id [" << reference_pointcloud_->header.frame_id << "]");
 		}
-
-		reference_pointcloud_msg_->header.frame_id = reference_pointcloud_->header.frame_id;
-		reference_pointcloud_msg_->header.stamp = time_stamp;
-		++reference_pointcloud_msg_->header.seq;
-		reference_pointcloud_publisher_.publish(reference_pointcloud_msg_);
-		ROS_DEBUG_STREAM("Published reference point cloud with " << reference_pointcloud_->size() << " points and frame_id [" << reference_pointcloud_msg_->header.frame_id << "]");
 	}
 
-	if (!reference_pointcloud_keypoints_publisher_.getTopic().empty()) {
-		if (!reference_pointcloud_keypoints_msg_ || update_msg) {
-			reference_pointcloud_keypoints_msg_ = sensor_msgs::PointCloud2Ptr(new sensor_msgs::PointCloud2());
-			pcl::toROSMsg(*reference_pointcloud_keypoints_, *reference_pointcloud_keypoints_msg_);
+	if (reference_pointcloud_keypoints_publisher_ && reference_pointcloud_keypoints_) {
+		if (reference_pointcloud_) { reference_pointcloud_keypoints_publisher_->setPublishFrameId(reference_pointcloud_->header.frame_id); }
+		if (update_msg) { reference_pointcloud_keypoints_publisher_->setReferencePointCloud(reference_pointcloud_keypoints_); }
+		if (reference_pointcloud_keypoints_publisher_->publishPendingChanges(time_stamp)) {
+			ROS_DEBUG_STREAM("Published reference point cloud keypoints with " << reference_pointcloud_keypoints_->size() << " points");
 		}
-
-		reference_pointcloud_keypoints_msg_->header.frame_id = reference_pointcloud_->header.frame_id;
-		reference_pointcloud_keypoints_msg_->header.stamp = time_stamp;
-		++reference_pointcloud_keypoints_msg_->header.seq;
-		reference_pointcloud_keypoints_publisher_.publish(reference_pointcloud_keypoints_msg_);
-		ROS_DEBUG_STREAM("Published reference point cloud keypoints with " << reference_pointcloud_keypoints_->size() << " points and frame_id [" << reference_pointcloud_keypoints_msg_->header.frame_id << "]");
 	}
 }
 
 
 template<typename PointT>
-bool Localization<PointT>::updateLocalizationPipelineWithNewReferenceCloud(const ros::Time& time_stamp) {
+bool Localization<PointT>::updateLocalizationPipelineWithNewReferenceCloud(const ros::Time& time_stamp, bool reference_pointcloud_preprocessed) {
 	reference_pointcloud_->header.stamp = pcl_conversions::toPCL(time_stamp);
 	localization_diagnostics_msg_.number_points_reference_pointcloud = reference_pointcloud_->size();
 
-	std::vector<int> indexes;
-	pcl::removeNaNFromPointCloud(*reference_pointcloud_, *reference_pointcloud_, indexes);
-	indexes.clear();
-	pcl::removeNaNNormalsFromPointCloud(*reference_pointcloud_, *reference_pointcloud_, indexes);
-	indexes.clear();
+	if (!reference_pointcloud_preprocessed) {
+		std::vector<int> indexes;
+		pcl::removeNaNFromPointCloud(*reference_pointcloud_, *reference_pointcloud_, indexes);
+		indexes.clear();
+		pcl::removeNaNNormalsFromPointCloud(*reference_pointcloud_, *reference_pointcloud_, indexes);
+		indexes.clear();
+	}
 
 	typename pcl::PointCloud<PointT>::Ptr reference_pointcloud_raw;
-	if (!use_filtered_cloud_as_normal_estimation_surface_reference_) {
+	if (!reference_pointcloud_preprocessed && !use_filtered_cloud_as_normal_estimation_surface_reference_) {
 		reference_pointcloud_raw = typename pcl::PointCloud<PointT>::Ptr(new pcl::PointCloud<PointT>(*reference_pointcloud_));
 	}
 
-	if (!applyCloudFilters(reference_cloud_filters_, reference_pointcloud_)) { return false; }
+	if (!reference_pointcloud_preprocessed && !applyCloudFilters(reference_cloud_filters_, reference_pointcloud_)) { return false; }
 	localization_diagnostics_msg_.number_points_reference_pointcloud_after_filtering = reference_pointcloud_->size();
 
 	if (reference_pointcloud_->size() > (size_t)minimum_number_of_points_in_reference_pointcloud_) {
+		typename VoxelHashSearch<PointT>::Ptr reference_pointcloud_voxel_hash_search = std::dynamic_pointer_cast< VoxelHashSearch<PointT> >(reference_pointcloud_search_method_);
+		if (reference_pointcloud_voxel_hash_search) { reference_pointcloud_voxel_hash_search->clear(); } // reference cloud may have been changed in place
 		reference_pointcloud_search_method_->setInputCloud(reference_pointcloud_);
-		if (reference_cloud_normal_estimator_ || reference_cloud_curvature_estimator_) {
+		if (!reference_pointcloud_preprocessed && (reference_cloud_normal_estimator_ || reference_cloud_curvature_estimator_)) {
 			if (!applyNormalEstimator(reference_cloud_normal_estimator_, reference_cloud_curvature_estimator_, reference_pointcloud_, reference_pointcloud_raw, reference_pointcloud_search_method_,true)) { return false; }
 		}
 
 		if (reference_pointcloud_->size() > (size_t)minimum_number_of_points_in_reference_pointcloud_) {
-			if (reference_pointcloud_normalize_normals_) {
+			if (!reference_pointcloud_preprocessed && reference_pointcloud_normalize_normals_) {
 				ROS_DEBUG_STREAM("Normalizing normals of reference point cloud with " << reference_pointcloud_->size() << " points");
 				pointcloud_utils::normalizePointCloudNormals(*reference_pointcloud_);
 				ROS_DEBUG_STREAM("Finished normalizing normals");
 			}
 
-			if (!reference_pointcloud_preprocessed_save_filename_.empty()) {
+			if (!reference_pointcloud_preprocessed && !reference_pointcloud_preprocessed_save_filename_.empty()) {
 				ROS_INFO_STREAM("Saving reference pointcloud preprocessed with " << reference_pointcloud_->size() << " points to file " << reference_pointcloud_preprocessed_save_filename_);
 				pointcloud_conversions::toFile(reference_pointcloud_preprocessed_save_filename_, *reference_pointcloud_, save_reference_pointclouds_in_binary_format_, reference_pointclouds_database_folder_path_);
 			}
 
-			if (!reference_cloud_keypoint_detectors_.empty()) {
-				if (reference_pointcloud_keypoints_filename_.empty() || !pointcloud_conversions::fromFile(*reference_pointcloud_keypoints_, reference_pointcloud_keypoints_filename_, reference_pointclouds_database_folder_path_)) {
-					applyKeypointDetectors(reference_cloud_keypoint_detectors_, reference_pointcloud_, reference_pointcloud_search_method_, reference_pointcloud_keypoints_);
+			if (!reference_pointcloud_preprocessed && !reference_cloud_keypoint_detectors_.empty()) {
+				if (reference_pointcloud_keypoints_filename_.empty() || !pointcloud_conversions::fromFile(*reference_pointcloud_keypoints_, reference_pointcloud_keypoints_filename_, reference_pointclouds_database_folder_path_)) {
+					applyKeypointDetectors(reference_cloud_keypoint_detectors_, reference_pointcloud_, reference_pointcloud_search_method_, reference_pointcloud_keypoints_);
+
+					if (!reference_pointcloud_keypoints_save_filename_.empty()) {
+						ROS_INFO_STREAM("Saving reference pointcloud keypoints with " << reference_pointcloud_keypoints_->size() << " points to file " << reference_pointcloud_keypoints_save_filename_);
+						pcl::io::savePCDFile<PointT>(reference_pointcloud_keypoints_save_filename_, *reference_pointcloud_keypoints_, save_reference_pointclouds_in_binary_format_);
+					}
+				} else {
+					ROS_INFO_STREAM("Loaded " << reference_pointcloud_keypoints_->size() << " keypoints from file " << reference_pointcloud_keypoints_filename_);
+				}
+			}
+			localization_diagnostics_msg_.number_keypoints_reference_pointcloud = reference_pointcloud_keypoints_->size();
+
+			if (registration_covariance_estimator_) {
+				registration_covariance_estimator_->setReferenceCloud(reference_pointcloud_, reference_pointcloud_search_method_);
+			}
+
+			updateMatchersReferenceCloud();
+			publishReferencePointCloud(time_stamp, true);
+			reference_pointcloud_loaded_ = true;
+			return true;
+		}
+	}
+
+	reference_pointcloud_loaded_ = false;
+	return false;
+}
+
+
+template<typename PointT>
+std::uint64_t Localization<PointT>::computeReferencePointCloudConfigurationHash(const std::string& reference_pointcloud_configuration_namespace, const std::string& filters_configuration_namespace,
+		const std::string& normal_estimators_configuration_namespace, const std::string& curvature_estimators_configuration_namespace, const std::string& keypoint_detectors_configuration_namespace) {
+	// parameters that change the reference point cloud and its keypoints (the matchers are always rebuilt from the preprocessed cloud)
+	// the normal estimators and keypoint detectors namespaces include use_filtered_cloud_as_normal_estimation_surface, flip_normals_using_occupancy_grid_analysis and reference_pointcloud_keypoints_filename
+	const std::pair<const std::string*, const char*> preprocessing_configuration_namespaces[] = {
+			{ &reference_pointcloud_configuration_namespace, "reference_pointclouds/reference_pointcloud_type" },
+			{ &reference_pointcloud_configuration_namespace, "reference_pointclouds/normalize_normals" },
+			{ &reference_pointcloud_configuration_namespace, "reference_pointclouds/voxel_hash_search" }, // search method used in the normal estimation and keypoint detection
+			{ &filters_configuration_namespace, "filters/reference_pointcloud" },
+			{ &normal_estimators_configuration_namespace, "normal_estimators/reference_pointcloud" },
+			{ &curvature_estimators_configuration_namespace, "curvature_estimators/reference_pointcloud" },
+			{ &keypoint_detectors_configuration_namespace, "keypoint_detectors/reference_pointcloud" }
+	};
+
+	std::stringstream preprocessing_configuration;
+	for (size_t i = 0; i < sizeof(preprocessing_configuration_namespaces) / sizeof(preprocessing_configuration_namespaces[0]); ++i) {
+		XmlRpc::XmlRpcValue parameter_value;
+		preprocessing_configuration << "|" << preprocessing_configuration_namespaces[i].second << "=";
+		if (private_node_handle_->getParam(*preprocessing_configuration_namespaces[i].first + preprocessing_configuration_namespaces[i].second, parameter_value)) {
+			preprocessing_configuration << parameter_value.toXml();
+		}
+	}
+
+	std::string preprocessing_configuration_str = preprocessing_configuration.str();
+	std::uint64_t preprocessing_configuration_hash = ReferenceMapBundle<PointT>::s_computeHash(preprocessing_configuration_str.data(), preprocessing_configuration_str.size());
+
+	// keypoints loaded from a file instead of being detected
+	std::string reference_pointcloud_keypoints_filename, reference_pointclouds_database_folder_path;
+	private_node_handle_->param(keypoint_detectors_configuration_namespace + "keypoint_detectors/reference_pointcloud/reference_pointcloud_keypoints_filename", reference_pointcloud_keypoints_filename, std::string(""));
+	private_node_handle_->param(reference_pointcloud_configuration_namespace + "reference_pointclouds_database_folder_path", reference_pointclouds_database_folder_path, std::string(""));
+	if (!reference_pointcloud_keypoints_filename.empty()) {
+		std::string reference_pointcloud_keypoints_filepath = pointcloud_utils::parseFilePath(reference_pointcloud_keypoints_filename, reference_pointclouds_database_folder_path);
+		if (pointcloud_utils::getFileExtension(reference_pointcloud_keypoints_filename).empty()) { reference_pointcloud_keypoints_filepath += ".ply"; }
+		std::uint64_t reference_pointcloud_keypoints_file_hash = 0;
+		if (ReferenceMapBundle<PointT>::s_computeFileHash(reference_pointcloud_keypoints_filepath, reference_pointcloud_keypoints_file_hash)) {
+			preprocessing_configuration_hash = ReferenceMapBundle<PointT>::s_computeHash(&reference_pointcloud_keypoints_file_hash, sizeof(reference_pointcloud_keypoints_file_hash), preprocessing_configuration_hash);
+		}
+	}
+
+	return preprocessing_configuration_hash;
+}
+
+
+template<typename PointT>
+bool Localization<PointT>::updateReferencePointCloudTiles(double x, double y, const ros::Time& time_stamp, bool wait_for_tiles) {
+	if (!tiled_reference_map_) { return false; }
+
+	bool reference_pointcloud_updated = false;
+	typename TiledReferenceMap<PointT>::LocalMap local_map;
+	if (wait_for_tiles) {
+		if (tiled_reference_map_->updateResidentTiles(x, y, local_map)) {
+			reference_pointcloud_updated = swapReferencePointCloudTilesLocalMap(local_map, time_stamp, false);
+		}
+	} else if (tiled_reference_map_->collectResidentTilesUpdate(local_map)) {
+		reference_pointcloud_updated = swapReferencePointCloudTilesLocalMap(local_map, time_stamp, true);
+	}
+
+	if (!tiled_reference_map_->isLoadingTiles() && tiled_reference_map_->hasMissingTiles(x, y)) {
+		// new structures are built for the next local map in the tiles loading thread, because the current ones are used by the matchers until the local map is swapped
+		std::vector< typename CorrespondencesLookupTableGrid<PointT>::Ptr > correspondences_lookup_table_grids;
+		std::vector< typename GeneralizedCovariancesCache<PointT>::Ptr > covariances_caches;
+		std::vector< typename NormalDistributionsTransformVoxelMap<PointT>::Ptr > voxel_maps;
+		collectMatchersReferenceCloudStructures(correspondences_lookup_table_grids, covariances_caches, voxel_maps);
+
+		tiled_reference_map_correspondences_lookup_table_grids_.clear();
+		for (size_t i = 0; i < correspondences_lookup_table_grids.size(); ++i) {
+			tiled_reference_map_correspondences_lookup_table_grids_.push_back(correspondences_lookup_table_grids[i]->cloneConfiguration());
+		}
+
+		tiled_reference_map_covariances_caches_.clear();
+		for (size_t i = 0; i < covariances_caches.size(); ++i) {
+			tiled_reference_map_covariances_caches_.push_back(covariances_caches[i]->cloneConfiguration());
+		}
+
+		tiled_reference_map_voxel_maps_.clear();
+		for (size_t i = 0; i < voxel_maps.size(); ++i) {
+			tiled_reference_map_voxel_maps_.push_back(voxel_maps[i]->cloneConfiguration());
+		}
+
+		std::uint64_t local_map_stamp = pcl_conversions::toPCL(time_stamp);
+		std::string local_map_frame_id = map_frame_id_for_publishing_pointclouds_;
+		correspondences_lookup_table_grids = tiled_reference_map_correspondences_lookup_table_grids_;
+		covariances_caches = tiled_reference_map_covariances_caches_;
+		voxel_maps = tiled_reference_map_voxel_maps_;
+		tiled_reference_map_->requestResidentTilesUpdate(x, y, [local_map_stamp, local_map_frame_id, correspondences_lookup_table_grids, covariances_caches, voxel_maps](typename TiledReferenceMap<PointT>::LocalMap& local_map) {
+			// the stamp must not be changed after the structures are built (it is used to check if they are in sync with the reference point cloud)
+			local_map.pointcloud->header.stamp = local_map_stamp;
+			local_map.pointcloud->header.frame_id = local_map_frame_id;
+			local_map.keypoints->header = local_map.pointcloud->header;
+			for (size_t i = 0; i < correspondences_lookup_table_grids.size(); ++i) {
+				correspondences_lookup_table_grids[i]->update(local_map.pointcloud, local_map.search_method);
+			}
+			for (size_t i = 0; i < covariances_caches.size(); ++i) {
+				covariances_caches[i]->updateReferenceCovariances(local_map.pointcloud, local_map.search_method);
+			}
+			for (size_t i = 0; i < voxel_maps.size(); ++i) {
+				voxel_maps[i]->update(local_map.pointcloud);
+			}
+		});
+	}
+
+	return reference_pointcloud_updated;
+}
+
+
+template<typename PointT>
+bool Localization<PointT>::swapReferencePointCloudTilesLocalMap(const typename TiledReferenceMap<PointT>::LocalMap& local_map, const ros::Time& time_stamp, bool local_map_prepared) {
+	std::vector< typename CorrespondencesLookupTableGrid<PointT>::Ptr > correspondences_lookup_table_grids;
+	std::vector< typename GeneralizedCovariancesCache<PointT>::Ptr > covariances_caches;
+	std::vector< typename NormalDistributionsTransformVoxelMap<PointT>::Ptr > voxel_maps;
+	correspondences_lookup_table_grids.swap(tiled_reference_map_correspondences_lookup_table_grids_);
+	covariances_caches.swap(tiled_reference_map_covariances_caches_);
+	voxel_maps.swap(tiled_reference_map_voxel_maps_);
+
+	if (!local_map.pointcloud || local_map.pointcloud->size() <= (size_t)minimum_number_of_points_in_reference_pointcloud_) {
+		ROS_WARN_STREAM("Local reference map with " << local_map.number_of_tiles << " tiles does not have enough points");
+		reference_pointcloud_loaded_ = false;
+		return false;
+	}
+
+	// the previous clouds and search method are replaced instead of changed in place because they may still be referenced by the matchers and publishers
+	reference_pointcloud_ = local_map.pointcloud;
+	reference_pointcloud_keypoints_ = local_map.keypoints;
+	reference_pointcloud_search_method_ = local_map.search_method;
+	if (!local_map_prepared) {
+		reference_pointcloud_->header.stamp = pcl_conversions::toPCL(time_stamp);
+		reference_pointcloud_->header.frame_id = map_frame_id_for_publishing_pointclouds_;
+		reference_pointcloud_keypoints_->header = reference_pointcloud_->header;
+	}
+
+	localization_diagnostics_msg_.number_points_reference_pointcloud = reference_pointcloud_->size();
+	localization_diagnostics_msg_.number_points_reference_pointcloud_after_filtering = reference_pointcloud_->size();
+	localization_diagnostics_msg_.number_keypoints_reference_pointcloud = reference_pointcloud_keypoints_->size();
+
+	if (registration_covariance_estimator_) {
+		registration_covariance_estimator_->setReferenceCloud(reference_pointcloud_, reference_pointcloud_search_method_);
+	}
+
+	if (local_map_prepared) {
+		// the matchers with the same configuration start using the structures built in the tiles loading thread (which are already in sync with the local map)
+		collectMatchersReferenceCloudStructures(correspondences_lookup_table_grids, covariances_caches, voxel_maps);
+		initial_pose_estimators_feature_matchers_reference_pointcloud_outdated_ = true;
+		updateMatchersReferenceCloud(false, true, true, true);
+	} else {
+		updateMatchersReferenceCloud();
+	}
+
+	publishReferencePointCloud(time_stamp, true);
+	reference_pointcloud_loaded_ = true;
+	ROS_DEBUG_STREAM("Updated local reference map with " << local_map.number_of_tiles << " tiles, " << reference_pointcloud_->size() << " points and " << reference_pointcloud_keypoints_->size() << " keypoints");
+	return true;
+}
+
+
+template<typename PointT>
+void Localization<PointT>::updateMatchersReferenceCloud(bool update_initial_pose_estimators_feature_matchers, bool update_initial_pose_estimators_point_matchers,
+		bool update_tracking_matchers, bool update_tracking_recovery_matchers) {
+	ROS_DEBUG("Updating matchers reference point cloud");
+
+	std::vector< typename CorrespondencesLookupTableGrid<PointT>::Ptr > correspondences_lookup_table_grids;
+	std::vector< typename GeneralizedCovariancesCache<PointT>::Ptr > covariances_caches;
+	std::vector< typename NormalDistributionsTransformVoxelMap<PointT>::Ptr > voxel_maps;
+	collectMatchersReferenceCloudStructures(correspondences_lookup_table_grids, covariances_caches, voxel_maps);
+
+	for (size_t i = 0; update_initial_pose_estimators_feature_matchers && i < initial_pose_estimators_feature_matchers_.size(); ++i) {
+		initial_pose_estimators_feature_matchers_[i]->setupReferenceCloud(reference_pointcloud_, reference_pointcloud_keypoints_, reference_pointcloud_search_method_);
+	}
+	if (update_initial_pose_estimators_feature_matchers) { initial_pose_estimators_feature_matchers_reference_pointcloud_outdated_ = false; }
+
+	for (size_t i = 0; update_initial_pose_estimators_point_matchers && i < initial_pose_estimators_point_matchers_.size(); ++i) {
+		initial_pose_estimators_point_matchers_[i]->setupReferenceCloud(reference_pointcloud_, reference_pointcloud_keypoints_, reference_pointcloud_search_method_);
+	}
+
+	for (size_t i = 0; update_tracking_matchers && i < tracking_matchers_.size(); ++i) {
+		tracking_matchers_[i]->setupReferenceCloud(reference_pointcloud_, reference_pointcloud_keypoints_, reference_pointcloud_search_method_);
+	}
+
+	if (update_tracking_recovery_matchers) {
+		if (tracking_recovery_portfolio_) {
+			tracking_recovery_portfolio_->setupReferenceCloud(reference_pointcloud_, reference_pointcloud_keypoints_, reference_pointcloud_search_method_); // includes the tracking_recovery_matchers_
+		} else {
+			for (size_t i = 0; i < tracking_recovery_matchers_.size(); ++i) {
+				tracking_recovery_matchers_[i]->setupReferenceCloud(reference_pointcloud_, reference_pointcloud_keypoints_, reference_pointcloud_search_method_);
+			}
+		}
+	}
+
+	updateOutlierDetectorsReferenceCloud();
+
+	ROS_DEBUG("Finished updating matchers reference point cloud");
+}
+
+
+template<typename PointT>
+void Localization<PointT>::updateMatchersReferenceCloudWithInsertedPoints(const std::vector<int>& inserted_points_indices) {
+	std::vector< typename CorrespondencesLookupTableGrid<PointT>::Ptr > correspondences_lookup_table_grids;
+	std::vector< typename GeneralizedCovariancesCache<PointT>::Ptr > covariances_caches;
+	std::vector< typename NormalDistributionsTransformVoxelMap<PointT>::Ptr > voxel_maps;
+	collectMatchersReferenceCloudStructures(correspondences_lookup_table_grids, covariances_caches, voxel_maps);
+
+	// the structures that are not in sync with the reference point cloud are fully updated when the matchers are setup below
+	for (size_t i = 0; i < correspondences_lookup_table_grids.size(); ++i) {
+		correspondences_lookup_table_grids[i]->insertPoints(reference_pointcloud_, inserted_points_indices);
+	}
+
+	for (size_t i = 0; i < covariances_caches.size(); ++i) {
+		covariances_caches[i]->insertReferencePoints(reference_pointcloud_, inserted_points_indices, reference_pointcloud_search_method_);
+	}
+
+	for (size_t i = 0; i < voxel_maps.size(); ++i) {
+		voxel_maps[i]->insertPoints(reference_pointcloud_, inserted_points_indices);
+	}
+
+	// the feature matchers recompute the descriptors of the whole reference point cloud and are only used when the tracking is lost
+	initial_pose_estimators_feature_matchers_reference_pointcloud_outdated_ = true;
+	updateMatchersReferenceCloud(false, true, true, true);
+}
+
+
+template<typename PointT>
+void Localization<PointT>::collectMatchersReferenceCloudStructures(std::vector< typename CorrespondencesLookupTableGrid<PointT>::Ptr >& correspondences_lookup_table_grids,
+		std::vector< typename GeneralizedCovariancesCache<PointT>::Ptr >& covariances_caches, std::vector< typename NormalDistributionsTransformVoxelMap<PointT>::Ptr >& voxel_maps) {
+	s_shareCorrespondencesLookupTableGrids(initial_pose_estimators_point_matchers_, correspondences_lookup_table_grids);
+	s_shareCorrespondencesLookupTableGrids(tracking_matchers_, correspondences_lookup_table_grids);
+	s_shareCorrespondencesLookupTableGrids(tracking_recovery_matchers_, correspondences_lookup_table_grids);
+
+	s_shareGeneralizedCovariancesCaches(initial_pose_estimators_point_matchers_, covariances_caches);
+	s_shareGeneralizedCovariancesCaches(tracking_matchers_, covariances_caches);
+	s_shareGeneralizedCovariancesCaches(tracking_recovery_matchers_, covariances_caches);
+
+	s_shareNormalDistributionsTransformVoxelMaps(initial_pose_estimators_point_matchers_, voxel_maps);
+	s_shareNormalDistributionsTransformVoxelMaps(tracking_matchers_, voxel_maps);
+	s_shareNormalDistributionsTransformVoxelMaps(tracking_recovery_matchers_, voxel_maps);
+
+	if (tracking_recovery_portfolio_) {
+		std::vector< typename TrackingRecoveryPortfolio<PointT>::Strategy > strategies = tracking_recovery_portfolio_->getStrategies();
+		for (size_t i = 0; i < strategies.size(); ++i) {
+			for (size_t j = 0; j < strategies[i].matchers_per_initial_guess.size(); ++j) {
+				s_shareCorrespondencesLookupTableGrids(strategies[i].matchers_per_initial_guess[j], correspondences_lookup_table_grids);
+				s_shareGeneralizedCovariancesCaches(strategies[i].matchers_per_initial_guess[j], covariances_caches);
+				s_shareNormalDistributionsTransformVoxelMaps(strategies[i].matchers_per_initial_guess[j], voxel_maps);
+			}
+		}
+	}
+}
+
+
+template<typename PointT>
+void Localization<PointT>::updateOutlierDetectorsReferenceCloud() {
+	typename pcl::PointCloud<PointT>::Ptr reference_pointcloud = reference_pointcloud_for_outlier_detection_ ? reference_pointcloud_for_outlier_detection_ : reference_pointcloud_;
+	for (size_t i = 0; i < outlier_detectors_.size(); ++i) {
+		if (outlier_detectors_[i]) outlier_detectors_[i]->setupReferenceCloud(reference_pointcloud);
+	}
+}
 
-					if (!reference_pointcloud_keypoints_save_filename_.empty()) {
-						ROS_INFO_STREAM("Saving reference pointcloud keypoints with " << reference_pointcloud_keypoints_->size() << " points to file " << reference_pointcloud_keypoints_save_filename_);
-						pcl::io::savePCDFile<PointT>(reference_pointcloud_keypoints_save_filename_, *reference_pointcloud_keypoints_, save_reference_pointclouds_in_binary_format_);
-					}
-				} else {
-					ROS_INFO_STREAM("Loaded " << reference_pointcloud_keypoints_->size() << " keypoints from file " << reference_pointcloud_keypoints_filename_);
-				}
-			}
-			localization_diagnostics_msg_.number_keypoints_reference_pointcloud = reference_pointcloud_keypoints_->size();
 
-			if (registration_covariance_estimator_) {
-				registration_covariance_estimator_->setReferenceCloud(reference_pointcloud_, reference_pointcloud_search_method_);
+template<typename PointT>
+void Localization<PointT>::s_shareCorrespondencesLookupTableGrids(std::vector< typename CloudMatcher<PointT>::Ptr >& matchers, std::vector< typename CorrespondencesLookupTableGrid<PointT>::Ptr >& correspondences_lookup_table_grids) {
+	for (size_t i = 0; i < matchers.size(); ++i) {
+		typename CorrespondencesLookupTableGrid<PointT>::Ptr matcher_grid = matchers[i]->getCorrespondencesLookupTableGrid();
+		if (!matcher_grid) { continue; }
+
+		bool grid_shared = false;
+		for (size_t j = 0; j < correspondences_lookup_table_grids.size(); ++j) {
+			if (correspondences_lookup_table_grids[j] == matcher_grid) {
+				grid_shared = true;
+				break;
+			} else if (correspondences_lookup_table_grids[j]->hasSameConfiguration(*matcher_grid)) {
+				matchers[i]->setCorrespondencesLookupTableGrid(correspondences_lookup_table_grids[j]);
+				grid_shared = true;
+				break;
 			}
+		}
 
-			updateMatchersReferenceCloud();
-			publishReferencePointCloud(time_stamp, true);
-			reference_pointcloud_loaded_ = true;
-			return true;
+		if (!grid_shared) {
+			correspondences_lookup_table_grids.push_back(matcher_grid);
 		}
 	}
-
-	reference_pointcloud_loaded_ = false;
-	return false;
 }
 
 
 template<typename PointT>
-void Localization<PointT>::updateMatchersReferenceCloud() {
-	ROS_DEBUG("Updating matchers reference point cloud");
+void Localization<PointT>::s_shareGeneralizedCovariancesCaches(std::vector< typename CloudMatcher<PointT>::Ptr >& matchers, std::vector< typename GeneralizedCovariancesCache<PointT>::Ptr >& covariances_caches) {
+	for (size_t i = 0; i < matchers.size(); ++i) {
+		typename IterativeClosestPointGeneralized<PointT>::Ptr gicp_matcher = std::dynamic_pointer_cast< IterativeClosestPointGeneralized<PointT> >(matchers[i]);
+		if (!gicp_matcher) { continue; }
+		typename GeneralizedCovariancesCache<PointT>::Ptr matcher_cache = gicp_matcher->getGeneralizedCovariancesCache();
+		if (!matcher_cache) { continue; }
+
+		bool cache_shared = false;
+		for (size_t j = 0; j < covariances_caches.size(); ++j) {
+			if (covariances_caches[j] == matcher_cache) {
+				cache_shared = true;
+				break;
+			} else if (covariances_caches[j]->hasSameConfiguration(*matcher_cache)) {
+				gicp_matcher->setGeneralizedCovariancesCache(covariances_caches[j]);
+				cache_shared = true;
+				break;
+			}
+		}
 
-	for (size_t i = 0; i < initial_pose_estimators_feature_matchers_.size(); ++i) {
-		initial_pose_estimators_feature_matchers_[i]->setupReferenceCloud(reference_pointcloud_, reference_pointcloud_keypoints_, reference_pointcloud_search_method_);
+		if (!cache_shared) {
+			covariances_caches.push_back(matcher_cache);
+		}
 	}
+}
 
-	for (size_t i = 0; i < initial_pose_estimators_point_matchers_.size(); ++i) {
-		initial_pose_estimators_point_matchers_[i]->setupReferenceCloud(reference_pointcloud_, reference_pointcloud_keypoints_, reference_pointcloud_search_method_);
-	}
 
-	for (size_t i = 0; i < tracking_matchers_.size(); ++i) {
-		tracking_matchers_[i]->setupReferenceCloud(reference_pointcloud_, reference_pointcloud_keypoints_, reference_pointcloud_search_method_);
-	}
+template<typename PointT>
+void Localization<PointT>::s_shareNormalDistributionsTransformVoxelMaps(std::vector< typename CloudMatcher<PointT>::Ptr >& matchers, std::vector< typename NormalDistributionsTransformVoxelMap<PointT>::Ptr >& voxel_maps) {
+	for (size_t i = 0; i < matchers.size(); ++i) {
+		typename NormalDistributionsTransform2D<PointT>::Ptr ndt_2d_matcher = std::dynamic_pointer_cast< NormalDistributionsTransform2D<PointT> >(matchers[i]);
+		typename NormalDistributionsTransform3D<PointT>::Ptr ndt_3d_matcher = std::dynamic_pointer_cast< NormalDistributionsTransform3D<PointT> >(matchers[i]);
+
+		typename NormalDistributionsTransformVoxelMap<PointT>::Ptr matcher_voxel_map;
+		if (ndt_2d_matcher) {
+			matcher_voxel_map = ndt_2d_matcher->getNormalDistributionsTransformVoxelMap();
+		} else if (ndt_3d_matcher) {
+			matcher_voxel_map = ndt_3d_matcher->getNormalDistributionsTransformVoxelMap();
+		}
+		if (!matcher_voxel_map) { continue; }
+
+		bool voxel_map_shared = false;
+		for (size_t j = 0; j < voxel_maps.size(); ++j) {
+			if (voxel_maps[j] == matcher_voxel_map) {
+				voxel_map_shared = true;
+				break;
+			} else if (voxel_maps[j]->hasSameConfiguration(*matcher_voxel_map)) {
+				if (ndt_2d_matcher) {
+					ndt_2d_matcher->setNormalDistributionsTransformVoxelMap(voxel_maps[j]);
+				} else {
+					ndt_3d_matcher->setNormalDistributionsTransformVoxelMap(voxel_maps[j]);
+				}
+				voxel_map_shared = true;
+				break;
+			}
+		}
 
-	for (size_t i = 0; i < tracking_recovery_matchers_.size(); ++i) {
-		tracking_recovery_matchers_[i]->setupReferenceCloud(reference_pointcloud_, reference_pointcloud_keypoints_, reference_pointcloud_search_method_);
+		if (!voxel_map_shared) {
+			voxel_maps.push_back(matcher_voxel_map);
+		}
 	}
-
-	ROS_DEBUG("Finished updating matchers reference point cloud");
 }
 
 
@@ -1493,33 +2688,40 @@ void Localization<PointT>::setInitialPoseFromPose(const geometry_msgs::Pose& pos
 
 template<typename PointT>
 void Localization<PointT>::setInitialPoseFromPose(const geometry_msgs::PoseConstPtr& pose) {
+	std::lock_guard<std::mutex> localization_lock(localization_mutex_);
 	setInitialPose(*pose, map_frame_id_, ros::Time::now());
 }
 
 
 template<typename PointT>
 void Localization<PointT>::setInitialPoseFromPoseStamped(const geometry_msgs::PoseStampedConstPtr& pose) {
+	std::lock_guard<std::mutex> localization_lock(localization_mutex_);
 	setInitialPose(pose->pose, pose->header.frame_id, pose->header.stamp);
 }
 
 
 template<typename PointT>
 void Localization<PointT>::setInitialPoseFromPoseWithCovarianceStamped(const geometry_msgs::PoseWithCovarianceStampedConstPtr& pose) {
+	std::lock_guard<std::mutex> localization_lock(localization_mutex_);
 	setInitialPose(pose->pose.pose, pose->header.frame_id, pose->header.stamp);
 }
 
 
 template<typename PointT>
 void Localization<PointT>::startPublishers() {
-	if (!reference_pointcloud_publish_topic_.empty())
-		reference_pointcloud_publisher_ = node_handle_->advertise<sensor_msgs::PointCloud2>(reference_pointcloud_publish_topic_, 1, true);
-	else
-		reference_pointcloud_publisher_.shutdown();
-
-	if (!reference_pointcloud_keypoints_publish_topic_.empty())
-		reference_pointcloud_keypoints_publisher_ = node_handle_->advertise<sensor_msgs::PointCloud2>(reference_pointcloud_keypoints_publish_topic_, 1, true);
-	else
-		reference_pointcloud_keypoints_publisher_.shutdown();
+	if (!reference_pointcloud_publisher_) { reference_pointcloud_publisher_.reset(new ReferenceMapPublisher<PointT>()); }
+	reference_pointcloud_publisher_->setPublishTopic(reference_pointcloud_publish_topic_);
+	reference_pointcloud_publisher_->setupConfigurationFromParameterServer(node_handle_, private_node_handle_, configuration_namespace_);
+	reference_pointcloud_publisher_->startPublishers(node_handle_);
+
+	if (!reference_pointcloud_keypoints_publisher_) { reference_pointcloud_keypoints_publisher_.reset(new ReferenceMapPublisher<PointT>()); }
+	reference_pointcloud_keypoints_publisher_->setPublishTopic(reference_pointcloud_keypoints_publish_topic_);
+	reference_pointcloud_keypoints_publisher_->setupConfigurationFromParameterServer(node_handle_, private_node_handle_, configuration_namespace_);
+	reference_pointcloud_keypoints_publisher_->startPublishers(node_handle_);
+
+	if (reference_pointcloud_loaded_ && reference_pointcloud_) {
+		publishReferencePointCloud(pcl_conversions::fromPCL(reference_pointcloud_->header.stamp), true);
+	}
 
 	if (!filtered_pointcloud_publish_topic_.empty())
 		filtered_pointcloud_publisher_ = node_handle_->advertise<sensor_msgs::PointCloud2>(filtered_pointcloud_publish_topic_, 1, true);
@@ -1595,6 +2797,11 @@ void Localization<PointT>::startPublishers() {
 		localization_times_publisher_ = node_handle_->advertise<dynamic_robot_localization::LocalizationTimes>(localization_times_publish_topic_, 5, true);
 	else
 		localization_times_publisher_.shutdown();
+
+	if (!localization_tracing_publish_topic_.empty())
+		localization_tracing_publisher_ = node_handle_->advertise<dynamic_robot_localization::LocalizationTracing>(localization_tracing_publish_topic_, 5, true);
+	else
+		localization_tracing_publisher_.shutdown();
 }
 
 
@@ -1679,6 +2886,12 @@ void Localization<PointT>::startServiceServers() {
 	} else {
 		stop_processing_sensor_data_service_server_.shutdown();
 	}
+
+	if (!publish_reference_pointcloud_service_server_name_.empty()) {
+		publish_reference_pointcloud_service_server_ = node_handle_->advertiseService(publish_reference_pointcloud_service_server_name_, &dynamic_robot_localization::Localization<PointT>::publishReferencePointCloudServiceCallback, this);
+	} else {
+		publish_reference_pointcloud_service_server_.shutdown();
+	}
 }
 
 
@@ -1726,6 +2939,7 @@ void Localization<PointT>::stopProcessingSensorData() {
 		ambient_pointcloud_subscribers_[i].shutdown();
 	}
 	ambient_pointcloud_subscribers_.clear();
+	clearProcessingPipelineQueues();
 }
 
 
@@ -1735,9 +2949,12 @@ void Localization<PointT>::restartProcessingSensorData() {
 	resetNumberOfProcessedPointclouds();
 	ambient_pointcloud_subscribers_active_ = true;
 	sensor_data_processing_status_ = WaitingForSensorData;
+	startProcessingPipeline();
+	startMultiSensorSynchronization();
 
 	for (size_t i = 0; i < ambient_pointcloud_topic_names_.size(); ++i) {
-		ambient_pointcloud_subscribers_.push_back(node_handle_->subscribe(ambient_pointcloud_topic_names_[i], 1, &dynamic_robot_localization::Localization<PointT>::processAmbientPointCloud, this));
+		boost::function<void (const sensor_msgs::PointCloud2ConstPtr&)> ambient_pointcloud_callback = std::bind(&dynamic_robot_localization::Localization<PointT>::processAmbientPointCloudFromSensor, this, std::placeholders::_1, i);
+		ambient_pointcloud_subscribers_.push_back(node_handle_->subscribe<sensor_msgs::PointCloud2>(ambient_pointcloud_topic_names_[i], ambient_pointcloud_subscriber_queue_size_, ambient_pointcloud_callback));
 	}
 }
 
@@ -1748,6 +2965,161 @@ void Localization<PointT>::resetNumberOfProcessedPointclouds() {
 }
 
 
+template<typename PointT>
+void Localization<PointT>::startProcessingPipeline() {
+	if (!processing_pipeline_enabled_ || !processing_pipeline_threads_.empty()) { return; }
+
+	processing_pipeline_ingest_queue_.restart();
+	processing_pipeline_registration_queue_.restart();
+	processing_pipeline_ingest_queue_.resetNumberOfDroppedElements();
+	processing_pipeline_registration_queue_.resetNumberOfDroppedElements();
+
+	// one thread per stage in order to keep the scans and poses ordered while allowing the preprocessing of a scan to overlap with the registration of the previous one
+	// (the point clouds are published by the AsyncCloudPublisher thread)
+	processing_pipeline_threads_.push_back(std::thread(&Localization<PointT>::processingPipelineIngestWorker, this));
+	processing_pipeline_threads_.push_back(std::thread(&Localization<PointT>::processingPipelineRegistrationWorker, this));
+	processing_pipeline_running_ = true;
+	ROS_INFO_STREAM("Started processing pipeline with ingest and registration queues with sizes [" << processing_pipeline_ingest_queue_.getCapacity() << ", " << processing_pipeline_registration_queue_.getCapacity() << "]");
+}
+
+
+template<typename PointT>
+void Localization<PointT>::stopProcessingPipeline() {
+	processing_pipeline_running_ = false;
+	processing_pipeline_ingest_queue_.shutdown();
+	processing_pipeline_registration_queue_.shutdown();
+	for (size_t i = 0; i < processing_pipeline_threads_.size(); ++i) {
+		if (processing_pipeline_threads_[i].joinable()) {
+			processing_pipeline_threads_[i].join();
+		}
+	}
+	processing_pipeline_threads_.clear();
+}
+
+
+template<typename PointT>
+void Localization<PointT>::clearProcessingPipelineQueues() {
+	processing_pipeline_ingest_queue_.clear();
+	processing_pipeline_registration_queue_.clear();
+	multi_sensor_synchronizer_.clear();
+}
+
+
+template<typename PointT>
+void Localization<PointT>::processingPipelineIngestWorker() {
+	sensor_msgs::PointCloud2ConstPtr ambient_cloud_msg;
+	while (processing_pipeline_ingest_queue_.pop(ambient_cloud_msg)) {
+		typename pcl::PointCloud<PointT>::Ptr ambient_pointcloud;
+		{
+			std::lock_guard<std::mutex> sensor_data_ingestion_lock(sensor_data_ingestion_mutex_);
+			ambient_pointcloud = ambient_pointcloud_ingestion_.ingest(*ambient_cloud_msg);
+			if (ambient_pointcloud && override_pointcloud_timestamp_to_current_time_) { ambient_pointcloud->header.stamp = pcl_conversions::toPCL(ros::Time::now()); } // at ingest time, like the synchronous processing
+		}
+		processing_pipeline_registration_queue_.push(ambient_pointcloud);
+	}
+}
+
+
+template<typename PointT>
+void Localization<PointT>::processingPipelineRegistrationWorker() {
+	typename pcl::PointCloud<PointT>::Ptr ambient_pointcloud;
+	while (processing_pipeline_registration_queue_.pop(ambient_pointcloud)) {
+		std::lock_guard<std::mutex> localization_lock(localization_mutex_);
+		processAmbientPointCloud(ambient_pointcloud, true, true, false);
+	}
+}
+
+
+template<typename PointT>
+void Localization<PointT>::startMultiSensorSynchronization() {
+	if (!multi_sensor_synchronization_enabled_) { return; }
+
+	multi_sensor_synchronizer_.setNumberOfSensors(ambient_pointcloud_topic_names_.size());
+	multi_sensor_synchronizer_.restart();
+	if (multi_sensor_synchronization_thread_.joinable()) { return; }
+
+	// the thread is only stopped in the destructor because the sensor data processing is restarted while holding the localization mutex (which the worker needs when the processing pipeline is disabled)
+	multi_sensor_synchronization_thread_ = std::thread(&Localization<PointT>::multiSensorSynchronizationWorker, this);
+	ROS_INFO_STREAM("Started multi sensor synchronization of " << ambient_pointcloud_topic_names_.size() << " point cloud topics");
+}
+
+
+template<typename PointT>
+void Localization<PointT>::stopMultiSensorSynchronization() {
+	multi_sensor_synchronizer_.shutdown();
+	if (multi_sensor_synchronization_thread_.joinable()) {
+		multi_sensor_synchronization_thread_.join();
+	}
+}
+
+
+template<typename PointT>
+void Localization<PointT>::multiSensorSynchronizationWorker() {
+	PointCloud2Synchronizer::SynchronizedSet synchronized_set;
+	while (multi_sensor_synchronizer_.pop(synchronized_set)) {
+		typename pcl::PointCloud<PointT>::Ptr ambient_pointcloud;
+		{
+			std::lock_guard<std::mutex> sensor_data_ingestion_lock(sensor_data_ingestion_mutex_);
+			ambient_pointcloud = mergeSynchronizedPointClouds(synchronized_set);
+		}
+		if (!ambient_pointcloud) { continue; }
+
+		if (processing_pipeline_running_) {
+			processing_pipeline_registration_queue_.push(ambient_pointcloud);
+		} else {
+			std::lock_guard<std::mutex> localization_lock(localization_mutex_);
+			processAmbientPointCloud(ambient_pointcloud, true, true, false);
+		}
+	}
+}
+
+
+template<typename PointT>
+typename pcl::PointCloud<PointT>::Ptr Localization<PointT>::mergeSynchronizedPointClouds(const PointCloud2Synchronizer::SynchronizedSet& synchronized_set) {
+	if (synchronized_set.elements.empty()) { return typename pcl::PointCloud<PointT>::Ptr(); }
+	if (synchronized_set.elements.size() == 1) {
+		typename pcl::PointCloud<PointT>::Ptr ambient_pointcloud = ambient_pointcloud_ingestion_.ingest(*synchronized_set.elements[0]);
+		if (ambient_pointcloud && override_pointcloud_timestamp_to_current_time_) {
+			ros::Time ambient_cloud_time;
+			ambient_cloud_time.fromNSec(synchronized_set.timestamp_ns); // overridden when the point cloud was received
+			ambient_pointcloud->header.stamp = pcl_conversions::toPCL(ambient_cloud_time);
+		}
+		return ambient_pointcloud;
+	}
+
+	// each point cloud is transformed using the TF at its own timestamp (with the odom frame as merge frame, the motion of the robot between the scans is compensated)
+	const std::string& merge_frame_id = multi_sensor_synchronization_merge_frame_id_.empty() ? base_link_frame_id_ : multi_sensor_synchronization_merge_frame_id_;
+	typename pcl::PointCloud<PointT>::Ptr merged_pointcloud(new pcl::PointCloud<PointT>());
+	for (size_t i = 0; i < synchronized_set.elements.size(); ++i) {
+		const sensor_msgs::PointCloud2& ambient_cloud_msg = *synchronized_set.elements[i];
+		typename pcl::PointCloud<PointT>::Ptr ambient_pointcloud = ambient_pointcloud_ingestion_.ingest(ambient_cloud_msg);
+		ros::Time ambient_cloud_time = (override_pointcloud_timestamp_to_current_time_ ? ros::Time::now() : ambient_cloud_msg.header.stamp);
+		if (!ambient_pointcloud) { continue; }
+
+		bool ambient_pointcloud_transformed = false;
+		if (merge_frame_id == map_frame_id_ || merge_frame_id == map_frame_id_for_transforming_pointclouds_) {
+			// the last accepted poses are updated by the registration while holding the localization mutex
+			std::lock_guard<std::mutex> localization_lock(localization_mutex_);
+			ambient_pointcloud_transformed = transformCloudToTFFrame(ambient_pointcloud, ambient_cloud_time, merge_frame_id);
+		} else {
+			ambient_pointcloud_transformed = transformCloudToTFFrame(ambient_pointcloud, ambient_cloud_time, merge_frame_id);
+		}
+		if (!ambient_pointcloud_transformed) { continue; }
+		merged_pointcloud->points.insert(merged_pointcloud->points.end(), ambient_pointcloud->points.begin(), ambient_pointcloud->points.end());
+	}
+
+	ros::Time merged_pointcloud_time;
+	merged_pointcloud_time.fromNSec(synchronized_set.timestamp_ns);
+	merged_pointcloud->header.stamp = pcl_conversions::toPCL(merged_pointcloud_time);
+	merged_pointcloud->header.frame_id = merge_frame_id;
+	merged_pointcloud->width = (std::uint32_t)merged_pointcloud->size();
+	merged_pointcloud->height = 1;
+	merged_pointcloud->is_dense = true;
+	ROS_DEBUG_STREAM("Merged " << synchronized_set.elements.size() << " point clouds from " << synchronized_set.number_of_sensors << " sensors into a point cloud with " << merged_pointcloud->size() << " points in frame " << merge_frame_id);
+	return merged_pointcloud;
+}
+
+
 template<typename PointT>
 bool Localization<PointT>::transformCloudToTFFrame(typename pcl::PointCloud<PointT>::Ptr& ambient_pointcloud, const ros::Time& timestamp, const std::string& target_frame_id) {
 	if (ambient_pointcloud->header.frame_id != target_frame_id) {
@@ -1905,17 +3277,37 @@ void Localization<PointT>::processAmbientPointCloud(const sensor_msgs::PointClou
 	ros::Time ambient_cloud_time = (override_pointcloud_timestamp_to_current_time_ ? ros::Time::now() : ambient_cloud_msg->header.stamp);
 	size_t number_points_ambient_pointcloud = ambient_cloud_msg->width * ambient_cloud_msg->height;
 
+	if (processing_pipeline_running_) {
+		if (!processing_pipeline_ingest_queue_.push(ambient_cloud_msg)) {
+			ROS_DEBUG("Dropped oldest point cloud from the ingest queue of the processing pipeline");
+		}
+		return;
+	}
+
+	std::lock_guard<std::mutex> localization_lock(localization_mutex_);
 	if (checkIfAmbientPointCloudShouldBeProcessed(ambient_cloud_time, number_points_ambient_pointcloud, true, true))
 	{
-		typename pcl::PointCloud<PointT>::Ptr ambient_pointcloud(new pcl::PointCloud<PointT>());
-		pcl::fromROSMsg(*ambient_cloud_msg, *ambient_pointcloud);
-		ambient_pointcloud->header.frame_id = ambient_cloud_msg->header.frame_id;
+		typename pcl::PointCloud<PointT>::Ptr ambient_pointcloud = ambient_pointcloud_ingestion_.ingest(*ambient_cloud_msg);
 		processAmbientPointCloud(ambient_pointcloud, false, false);
 	}
 }
 
+
+template<typename PointT>
+void Localization<PointT>::processAmbientPointCloudFromSensor(const sensor_msgs::PointCloud2ConstPtr& ambient_cloud_msg, size_t sensor_index) {
+	if (!multi_sensor_synchronization_enabled_ || !multi_sensor_synchronization_thread_.joinable()) {
+		processAmbientPointCloud(ambient_cloud_msg);
+		return;
+	}
+
+	ros::Time ambient_cloud_time = (override_pointcloud_timestamp_to_current_time_ ? ros::Time::now() : ambient_cloud_msg->header.stamp);
+	if (!multi_sensor_synchronizer_.push(sensor_index, ambient_cloud_msg, ambient_cloud_time.toNSec())) {
+		ROS_DEBUG_STREAM("Dropped point cloud of sensor " << sensor_index << " with timestamp " << ambient_cloud_time << " in the multi sensor synchronizer (the drop reasons of each sensor are published in the localization diagnostics)");
+	}
+}
+
 template<typename PointT>
-bool Localization<PointT>::processAmbientPointCloud(typename pcl::PointCloud<PointT>::Ptr& ambient_pointcloud, bool check_if_pointcloud_should_be_processed, bool check_if_pointcloud_subscribers_are_active) {
+bool Localization<PointT>::processAmbientPointCloud(typename pcl::PointCloud<PointT>::Ptr& ambient_pointcloud, bool check_if_pointcloud_should_be_processed, bool check_if_pointcloud_subscribers_are_active, bool override_pointcloud_timestamp) {
 	try {
 		if (limit_of_pointclouds_to_process_ >= 0 && number_of_processed_pointclouds_ >= (size_t)limit_of_pointclouds_to_process_) {
 			ROS_DEBUG("Discarding point cloud because [number_of_processed_pointclouds >= limit_of_pointclouds_to_process]");
@@ -1925,9 +3317,10 @@ bool Localization<PointT>::processAmbientPointCloud(typename pcl::PointCloud<Poi
 		PerformanceTimer performance_timer;
 		performance_timer.start();
 		localization_times_msg_ = LocalizationTimes();
+		std::uint64_t processing_start_time_ns = Tracer::s_getTimeInNanoseconds();
 
 		ros::Time original_pointcloud_time = pcl_conversions::fromPCL(ambient_pointcloud->header.stamp);
-		ros::Time ambient_cloud_time = (override_pointcloud_timestamp_to_current_time_ ? ros::Time::now() : original_pointcloud_time);
+		ros::Time ambient_cloud_time = ((override_pointcloud_timestamp && override_pointcloud_timestamp_to_current_time_) ? ros::Time::now() : original_pointcloud_time);
 		ros::Time ambient_cloud_time_with_increment;
 		ambient_cloud_time_with_increment.fromNSec(ambient_cloud_time.toNSec() + 1000 * number_of_times_that_the_same_point_cloud_was_processed_);
 		if (original_pointcloud_time.toNSec() == last_pointcloud_time_.toNSec()) {
@@ -1997,6 +3390,10 @@ bool Localization<PointT>::processAmbientPointCloud(typename pcl::PointCloud<Poi
 			ROS_DEBUG_STREAM("Removed " << number_of_points_in_sensor_origin_in_ambient_pointcloud << " points in sensor origin from ambient cloud with " << number_of_points_in_ambient_pointcloud_before_sensor_origin_removal << " points");
 		}
 
+		if (tiled_reference_map_) {
+			updateReferencePointCloudTiles(pose_tf_initial_guess.getOrigin().getX(), pose_tf_initial_guess.getOrigin().getY(), ambient_cloud_time);
+		}
+
 		tf2::Quaternion pose_tf_initial_guess_q = pose_tf_initial_guess.getRotation().normalize();
 		ROS_DEBUG_STREAM("Initial pose:" \
 				<< "\tTF position -> [ x: " << pose_tf_initial_guess.getOrigin().getX() << " | y: " << pose_tf_initial_guess.getOrigin().getY() << " | z: " << pose_tf_initial_guess.getOrigin().getZ() << " ]" \
@@ -2050,19 +3447,19 @@ bool Localization<PointT>::processAmbientPointCloud(typename pcl::PointCloud<Poi
 
 		if (localizationUpdateSuccess) {
 			ambient_pointcloud->header.stamp = (std::uint64_t)(ambient_cloud_time.toNSec() / 1000.0);
-			if (republish_reference_pointcloud_after_successful_registration_ && map_update_mode_ == NoIntegration)
-				publishReferencePointCloud(ambient_cloud_time, false);
+			if (republish_reference_pointcloud_after_successful_registration_ && map_update_mode_ == NoIntegration) {
+				if (reference_pointcloud_publisher_) { reference_pointcloud_publisher_->requestFullSnapshot(); }
+				if (reference_pointcloud_keypoints_publisher_) { reference_pointcloud_keypoints_publisher_->requestFullSnapshot(); }
+			}
+			publishReferencePointCloud(ambient_cloud_time, false); // publishes the changes that were delayed by the throttling
 
 			last_scan_time_ = pose_time;
 
 			if (!localization_times_publisher_.getTopic().empty()) {
+				localization_times_msg_ = getLocalizationTimes();
 				localization_times_msg_.header.frame_id = map_frame_id_;
 				localization_times_msg_.header.stamp = ambient_cloud_time;
 				localization_times_msg_.global_time = performance_timer.getElapsedTimeInMilliSec();
-				localization_times_msg_.correspondence_estimation_time_for_all_matchers = correspondence_estimation_time_for_all_matchers_;
-				localization_times_msg_.transformation_estimation_time_for_all_matchers = transformation_estimation_time_for_all_matchers_;
-				localization_times_msg_.transform_cloud_time_for_all_matchers = transform_cloud_time_for_all_matchers_;
-				localization_times_msg_.cloud_align_time_for_all_matchers = cloud_align_time_for_all_matchers_;
 				localization_times_publisher_.publish(localization_times_msg_);
 			}
 
@@ -2071,6 +3468,9 @@ bool Localization<PointT>::processAmbientPointCloud(typename pcl::PointCloud<Poi
 			}
 
 			last_accepted_pose_odom_to_map_ = pose_tf2_transform_corrected_ * transform_base_link_to_odom.inverse();
+			if (tracking_recovery_portfolio_) {
+				tracking_recovery_portfolio_->addAcceptedPose(last_accepted_pose_odom_to_map_);
+			}
 
 			tf2::Quaternion pose_tf_corrected_q = pose_tf_corrected_to_publish.getRotation().normalize();
 			ROS_DEBUG_STREAM("Corrected pose:" \
@@ -2181,10 +3581,23 @@ bool Localization<PointT>::processAmbientPointCloud(typename pcl::PointCloud<Poi
 				localization_diagnostics_msg_.header.frame_id = map_frame_id_;
 				localization_diagnostics_msg_.header.stamp = ambient_cloud_time;
 				localization_diagnostics_msg_.number_correspondences_last_registration_algorithm = number_correspondences_last_registration_algorithm_;
+				localization_diagnostics_msg_.ingest_queue_depth = processing_pipeline_ingest_queue_.size();
+				localization_diagnostics_msg_.ingest_queue_dropped_pointclouds = processing_pipeline_ingest_queue_.getNumberOfDroppedElements();
+				localization_diagnostics_msg_.registration_queue_depth = processing_pipeline_registration_queue_.size();
+				localization_diagnostics_msg_.registration_queue_dropped_pointclouds = processing_pipeline_registration_queue_.getNumberOfDroppedElements();
+				localization_diagnostics_msg_.publish_queue_depth = AsyncCloudPublisher::getInstance().getQueueSize();
+				localization_diagnostics_msg_.publish_queue_dropped_pointclouds = AsyncCloudPublisher::getInstance().getNumberOfDroppedMessages();
+				updateMultiSensorSynchronizationDiagnostics();
 				localization_diagnostics_publisher_.publish(localization_diagnostics_msg_);
 			}
 
-			pointcloud_conversions::publishPointCloud(*ambient_pointcloud, aligned_pointcloud_publisher_, map_frame_id_, publish_aligned_pointcloud_only_if_there_is_subscribers_, "registered ambient pointcloud");
+			if (AsyncCloudPublisher::s_isPublishing(aligned_pointcloud_publisher_, publish_aligned_pointcloud_only_if_there_is_subscribers_)) {
+				typename pcl::PointCloud<PointT>::ConstPtr aligned_pointcloud = ambient_pointcloud;
+				if (ambient_pointcloud_with_circular_buffer_ && ambient_pointcloud == ambient_pointcloud_with_circular_buffer_->getPointCloudPtr() && AsyncCloudPublisher::getInstance().isRunning()) {
+					aligned_pointcloud.reset(new pcl::PointCloud<PointT>(*ambient_pointcloud)); // the circular buffer is changed when the next scans arrive
+				}
+				pointcloud_conversions::publishPointCloudAsynchronously<PointT>(aligned_pointcloud, aligned_pointcloud_publisher_, map_frame_id_, false, "registered ambient pointcloud");
+			}
 
 			performance_timer.restart();
 
@@ -2202,6 +3615,7 @@ bool Localization<PointT>::processAmbientPointCloud(typename pcl::PointCloud<Poi
 			}
 
 			localization_times_msg_.map_update_time = performance_timer.getElapsedTimeInMilliSec();
+			enforceMemoryBudgets(ambient_cloud_time); // after the map update, because the circular buffer cloud may be the integrated ambient cloud
 		} else {
 			if (ambient_pointcloud_with_circular_buffer_ && circular_buffer_clear_inserted_points_if_registration_fails_) {
 				ambient_pointcloud_with_circular_buffer_->eraseNewest(last_number_points_inserted_in_circular_buffer_);
@@ -2212,6 +3626,9 @@ bool Localization<PointT>::processAmbientPointCloud(typename pcl::PointCloud<Poi
 
 		received_external_initial_pose_estimation_ = false;
 		accepted_pose_corrections_.clear();
+		if (Tracer::getInstance().isEnabled()) // recorded before publishing the tracing, in order to include the processing span in the slow processing trace
+			Tracer::getInstance().recordSpan("localization/process_ambient_pointcloud", processing_start_time_ns, Tracer::s_getTimeInNanoseconds() - processing_start_time_ns);
+		publishLocalizationTracing(ambient_cloud_time, processing_start_time_ns, performance_timer.getElapsedTimeInMilliSec());
 	} catch (std::exception& e) {
 		ROS_ERROR_STREAM("Exception caught in ambient pointcloud callback! Info: [" << e.what() <<"]");
 		sensor_data_processing_status_ = ExceptionRaised;
@@ -2235,6 +3652,249 @@ bool Localization<PointT>::processAmbientPointCloud(typename pcl::PointCloud<Poi
 }
 
 
+template<typename PointT>
+void Localization<PointT>::publishLocalizationTracing(const ros::Time& time_stamp, std::uint64_t processing_start_time_ns, double processing_time_ms) {
+	Tracer& tracer = Tracer::getInstance();
+	if (!tracer.isEnabled()) return;
+
+	if (!tracing_slow_processing_chrome_trace_filename_.empty() && tracing_slow_processing_time_threshold_ms_ > 0.0 && processing_time_ms > tracing_slow_processing_time_threshold_ms_) {
+		if (tracer.saveChromeTrace(tracing_slow_processing_chrome_trace_filename_, processing_start_time_ns))
+			ROS_WARN_STREAM("Point cloud processing took " << processing_time_ms << " ms and its trace spans were saved to file " << tracing_slow_processing_chrome_trace_filename_);
+	}
+
+	if (localization_tracing_publisher_.getTopic().empty() || localization_tracing_publisher_.getNumSubscribers() == 0) return;
+
+	ros::Time now = ros::Time::now();
+	if (!tracing_statistics_last_publish_time_.isZero() && (now - tracing_statistics_last_publish_time_) < tracing_statistics_publish_period_) return;
+	tracing_statistics_last_publish_time_ = now;
+
+	std::vector<Tracer::SpanStatistics> spans_statistics;
+	tracer.computeSpansStatistics(spans_statistics, tracing_statistics_time_window_in_seconds_);
+
+	localization_tracing_msg_.header.frame_id = map_frame_id_;
+	localization_tracing_msg_.header.stamp = time_stamp;
+	localization_tracing_msg_.number_of_recorded_spans = tracer.getNumberOfRecordedSpans();
+	localization_tracing_msg_.number_of_overwritten_spans = tracer.getNumberOfOverwrittenSpans();
+	localization_tracing_msg_.spans.resize(spans_statistics.size());
+	for (size_t i = 0; i < spans_statistics.size(); ++i) {
+		TraceSpanStatistics& span_statistics_msg = localization_tracing_msg_.spans[i];
+		span_statistics_msg.name = spans_statistics[i].name;
+		span_statistics_msg.number_of_spans = spans_statistics[i].number_of_spans;
+		span_statistics_msg.mean_duration_ms = spans_statistics[i].mean_duration_ms;
+		span_statistics_msg.p50_duration_ms = spans_statistics[i].p50_duration_ms;
+		span_statistics_msg.p95_duration_ms = spans_statistics[i].p95_duration_ms;
+		span_statistics_msg.p99_duration_ms = spans_statistics[i].p99_duration_ms;
+		span_statistics_msg.max_duration_ms = spans_statistics[i].max_duration_ms;
+	}
+	localization_tracing_publisher_.publish(localization_tracing_msg_);
+}
+
+
+template<typename PointT>
+void Localization<PointT>::collectPointMatchers(std::vector< typename CloudMatcher<PointT>::Ptr >& matchers) {
+	matchers.insert(matchers.end(), initial_pose_estimators_point_matchers_.begin(), initial_pose_estimators_point_matchers_.end());
+	matchers.insert(matchers.end(), tracking_matchers_.begin(), tracking_matchers_.end());
+	matchers.insert(matchers.end(), tracking_recovery_matchers_.begin(), tracking_recovery_matchers_.end());
+	if (tracking_recovery_portfolio_) {
+		const std::vector<typename TrackingRecoveryPortfolio<PointT>::Strategy>& strategies = tracking_recovery_portfolio_->getStrategies();
+		for (size_t i = 0; i < strategies.size(); ++i) {
+			for (size_t j = 0; j < strategies[i].matchers_per_initial_guess.size(); ++j) {
+				matchers.insert(matchers.end(), strategies[i].matchers_per_initial_guess[j].begin(), strategies[i].matchers_per_initial_guess[j].end());
+			}
+		}
+	}
+}
+
+
+template<typename PointT>
+void Localization<PointT>::updateMultiSensorSynchronizationDiagnostics() {
+	localization_diagnostics_msg_.sensor_synchronization_statistics.clear();
+	if (!multi_sensor_synchronization_enabled_) { return; }
+
+	localization_diagnostics_msg_.number_of_synchronized_pointcloud_sets = multi_sensor_synchronizer_.getNumberOfSynchronizedSets();
+	localization_diagnostics_msg_.number_of_incomplete_pointcloud_sets = multi_sensor_synchronizer_.getNumberOfIncompleteSets();
+	size_t number_of_sensors = std::min(multi_sensor_synchronizer_.getNumberOfSensors(), ambient_pointcloud_topic_names_.size());
+	localization_diagnostics_msg_.sensor_synchronization_statistics.resize(number_of_sensors);
+	for (size_t i = 0; i < number_of_sensors; ++i) {
+		PointCloud2Synchronizer::SensorStatistics sensor_statistics = multi_sensor_synchronizer_.getSensorStatistics(i);
+		SensorSynchronizationStatistics& sensor_statistics_msg = localization_diagnostics_msg_.sensor_synchronization_statistics[i];
+		sensor_statistics_msg.topic = ambient_pointcloud_topic_names_[i];
+		sensor_statistics_msg.queue_depth = multi_sensor_synchronizer_.getQueueSize(i);
+		sensor_statistics_msg.number_of_received_pointclouds = sensor_statistics.number_of_received_elements;
+		sensor_statistics_msg.number_of_synchronized_pointclouds = sensor_statistics.number_of_synchronized_elements;
+		sensor_statistics_msg.number_of_dropped_pointclouds_queue_overflow = sensor_statistics.number_of_dropped_elements[PointCloud2Synchronizer::QueueOverflow];
+		sensor_statistics_msg.number_of_dropped_pointclouds_older_than_last_synchronized_set = sensor_statistics.number_of_dropped_elements[PointCloud2Synchronizer::OlderThanLastSynchronizedSet];
+		sensor_statistics_msg.number_of_dropped_pointclouds_outside_synchronization_window = sensor_statistics.number_of_dropped_elements[PointCloud2Synchronizer::OutsideSynchronizationWindow];
+		sensor_statistics_msg.number_of_dropped_pointclouds_superseded_by_newer_pointcloud = sensor_statistics.number_of_dropped_elements[PointCloud2Synchronizer::SupersededByNewerScan];
+	}
+}
+
+
+template<typename PointT>
+size_t Localization<PointT>::updateMemoryUsageDiagnostics() {
+	// the shared objects are assigned to the first group that accounts them, so the reference data and the caches are accounted before the modules that use them
+	MemoryUsage memory_usage;
+
+	size_t bytes = memory_usage.addPointCloud(reference_pointcloud_.get()) + memory_usage.addPointCloud(reference_pointcloud_keypoints_.get());
+	typename VoxelHashSearch<PointT>::Ptr reference_pointcloud_voxel_hash_search = std::dynamic_pointer_cast< VoxelHashSearch<PointT> >(reference_pointcloud_search_method_);
+	if (reference_pointcloud_voxel_hash_search) { bytes += reference_pointcloud_voxel_hash_search->accountMemoryUsage(memory_usage); }
+	bytes += memory_usage.addKdTree(reference_pointcloud_search_method_.get());
+	bytes += memory_usage.addPointCloud(reference_pointcloud_for_outlier_detection_.get());
+	bytes += memory_usage.addKdTree(reference_pointcloud_search_method_for_outlier_detection_.get());
+	if (tiled_reference_map_) { bytes += tiled_reference_map_->accountMemoryUsage(memory_usage); }
+	localization_diagnostics_msg_.memory_reference_pointcloud_bytes = bytes;
+
+	std::vector< typename CloudMatcher<PointT>::Ptr > point_matchers;
+	collectPointMatchers(point_matchers);
+
+	bytes = cloud_filter_chain_.accountMemoryUsage(memory_usage);
+	if (!processing_pipeline_enabled_ && !multi_sensor_synchronization_enabled_) { bytes += ambient_pointcloud_ingestion_.accountMemoryUsage(memory_usage); } // otherwise the pool is being changed by the ingest / synchronization worker
+	for (size_t i = 0; i < point_matchers.size(); ++i) {
+		typename IterativeClosestPointGeneralized<PointT>::Ptr gicp_matcher = std::dynamic_pointer_cast< IterativeClosestPointGeneralized<PointT> >(point_matchers[i]);
+		if (gicp_matcher && gicp_matcher->getGeneralizedCovariancesCache()) { bytes += gicp_matcher->getGeneralizedCovariancesCache()->accountAmbientCovariancesMemoryUsage(memory_usage); }
+	}
+	localization_diagnostics_msg_.memory_caches_bytes = bytes;
+
+	localization_diagnostics_msg_.memory_circular_buffer_bytes = (ambient_pointcloud_with_circular_buffer_ ? ambient_pointcloud_with_circular_buffer_->accountMemoryUsage(memory_usage) : 0);
+
+	bytes = 0;
+	for (size_t i = 0; i < point_matchers.size(); ++i) { bytes += point_matchers[i]->accountMemoryUsage(memory_usage); }
+	localization_diagnostics_msg_.memory_point_matchers_bytes = bytes;
+
+	bytes = 0;
+	for (size_t i = 0; i < initial_pose_estimators_feature_matchers_.size(); ++i) { bytes += initial_pose_estimators_feature_matchers_[i]->accountMemoryUsage(memory_usage); }
+	localization_diagnostics_msg_.memory_feature_matchers_bytes = bytes;
+
+	bytes = 0;
+	for (size_t i = 0; i < outlier_detectors_.size(); ++i) { bytes += outlier_detectors_[i]->accountMemoryUsage(memory_usage); }
+	for (size_t i = 0; i < outlier_detectors_reference_pointcloud_.size(); ++i) { bytes += outlier_detectors_reference_pointcloud_[i]->accountMemoryUsage(memory_usage); }
+	localization_diagnostics_msg_.memory_outlier_detectors_bytes = bytes;
+
+	localization_diagnostics_msg_.memory_covariance_estimators_bytes = (registration_covariance_estimator_ ? registration_covariance_estimator_->accountMemoryUsage(memory_usage) : 0);
+
+	bytes = memory_usage.addBytes(this, sizeof(*this));
+	bytes += memory_usage.addPointCloud(registered_inliers_.get()) + memory_usage.addPointCloud(registered_outliers_.get());
+	bytes += memory_usage.addPointCloud(registered_inliers_reference_pointcloud_.get()) + memory_usage.addPointCloud(registered_outliers_reference_pointcloud_.get());
+	for (size_t i = 0; i < detected_outliers_.size(); ++i) { bytes += memory_usage.addPointCloud(detected_outliers_[i].get()); }
+	for (size_t i = 0; i < detected_inliers_.size(); ++i) { bytes += memory_usage.addPointCloud(detected_inliers_[i].get()); }
+	for (size_t i = 0; i < detected_outliers_reference_pointcloud_.size(); ++i) { bytes += memory_usage.addPointCloud(detected_outliers_reference_pointcloud_[i].get()); }
+	for (size_t i = 0; i < detected_inliers_reference_pointcloud_.size(); ++i) { bytes += memory_usage.addPointCloud(detected_inliers_reference_pointcloud_[i].get()); }
+	localization_diagnostics_msg_.memory_localization_bytes = bytes;
+
+	localization_diagnostics_msg_.memory_total_bytes = memory_usage.getTotalBytes();
+	localization_diagnostics_msg_.memory_process_resident_bytes = MemoryUsage::s_getProcessResidentBytes();
+	return memory_usage.getTotalBytes();
+}
+
+
+template<typename PointT>
+void Localization<PointT>::enforceMemoryBudgets(const ros::Time& time_stamp) {
+	bool budgets_enabled = (memory_budget_total_bytes_ > 0 || memory_budget_reference_pointcloud_bytes_ > 0 || memory_budget_circular_buffer_bytes_ > 0 || memory_budget_caches_bytes_ > 0);
+	if (!budgets_enabled && localization_diagnostics_publisher_.getTopic().empty()) return;
+
+	ros::Time now = ros::Time::now();
+	if (!memory_management_last_check_time_.isZero() && (now - memory_management_last_check_time_) < memory_management_check_period_) return;
+	memory_management_last_check_time_ = now;
+
+	size_t total_bytes = updateMemoryUsageDiagnostics();
+	if (!budgets_enabled) return;
+
+	if (memory_budget_caches_bytes_ > 0 && localization_diagnostics_msg_.memory_caches_bytes > memory_budget_caches_bytes_) {
+		ROS_WARN_STREAM("Memory of caches (" << MemoryUsage::s_convertBytesToMegabytes(localization_diagnostics_msg_.memory_caches_bytes) << " MB) exceeded its budget -> clearing caches");
+		total_bytes -= std::min(total_bytes, clearMemoryCaches());
+	}
+
+	if (memory_budget_circular_buffer_bytes_ > 0 && localization_diagnostics_msg_.memory_circular_buffer_bytes > memory_budget_circular_buffer_bytes_) {
+		ROS_WARN_STREAM("Memory of circular buffer (" << MemoryUsage::s_convertBytesToMegabytes(localization_diagnostics_msg_.memory_circular_buffer_bytes) << " MB) exceeded its budget -> shrinking circular buffer");
+		total_bytes -= std::min(total_bytes, shrinkCircularBuffer(localization_diagnostics_msg_.memory_circular_buffer_bytes - memory_budget_circular_buffer_bytes_));
+	}
+
+	bool reference_pointcloud_downsampled = false;
+	if (memory_budget_reference_pointcloud_bytes_ > 0 && localization_diagnostics_msg_.memory_reference_pointcloud_bytes > memory_budget_reference_pointcloud_bytes_) {
+		ROS_WARN_STREAM("Memory of reference point cloud (" << MemoryUsage::s_convertBytesToMegabytes(localization_diagnostics_msg_.memory_reference_pointcloud_bytes) << " MB) exceeded its budget -> downsampling reference point cloud");
+		reference_pointcloud_downsampled = downsampleReferencePointCloud(time_stamp);
+	}
+
+	if (memory_budget_total_bytes_ > 0 && total_bytes > memory_budget_total_bytes_ && !reference_pointcloud_downsampled) {
+		// escalates from the data that is cheaper to rebuild to the one that affects the most the localization accuracy
+		ROS_WARN_STREAM("Memory of localization (" << MemoryUsage::s_convertBytesToMegabytes(total_bytes) << " MB) exceeded its total budget");
+		size_t number_of_bytes_to_release = total_bytes - memory_budget_total_bytes_;
+		size_t number_of_released_bytes = clearMemoryCaches();
+		if (number_of_released_bytes < number_of_bytes_to_release) { number_of_released_bytes += shrinkCircularBuffer(number_of_bytes_to_release - number_of_released_bytes); }
+		if (number_of_released_bytes < number_of_bytes_to_release) { downsampleReferencePointCloud(time_stamp); }
+	}
+}
+
+
+template<typename PointT>
+size_t Localization<PointT>::clearMemoryCaches() {
+	size_t number_of_released_bytes = localization_diagnostics_msg_.memory_caches_bytes;
+	localization_diagnostics_msg_.memory_caches_bytes = 0;
+
+	cloud_filter_chain_.clearPool();
+	if (!processing_pipeline_enabled_ && !multi_sensor_synchronization_enabled_) { ambient_pointcloud_ingestion_.clearPool(); }
+
+	std::vector< typename CloudMatcher<PointT>::Ptr > point_matchers;
+	collectPointMatchers(point_matchers);
+	for (size_t i = 0; i < point_matchers.size(); ++i) {
+		typename IterativeClosestPointGeneralized<PointT>::Ptr gicp_matcher = std::dynamic_pointer_cast< IterativeClosestPointGeneralized<PointT> >(point_matchers[i]);
+		if (gicp_matcher && gicp_matcher->getGeneralizedCovariancesCache()) { gicp_matcher->getGeneralizedCovariancesCache()->clearAmbientCovariances(); }
+	}
+
+	return number_of_released_bytes;
+}
+
+
+template<typename PointT>
+size_t Localization<PointT>::shrinkCircularBuffer(size_t number_of_bytes_to_release) {
+	if (!ambient_pointcloud_with_circular_buffer_ || ambient_pointcloud_with_circular_buffer_->size() <= circular_buffer_minimum_number_of_points_) return 0;
+
+	size_t number_of_points = ambient_pointcloud_with_circular_buffer_->size();
+	size_t bytes_per_point = std::max((size_t)(localization_diagnostics_msg_.memory_circular_buffer_bytes / number_of_points), (size_t)1);
+	size_t number_of_points_to_remove = std::max(number_of_bytes_to_release / bytes_per_point + 1, number_of_points / 2); // halving avoids shrinking the buffer on every check
+	size_t max_buffer_size = std::max(number_of_points - std::min(number_of_points_to_remove, number_of_points), circular_buffer_minimum_number_of_points_);
+	if (max_buffer_size >= ambient_pointcloud_with_circular_buffer_->getMaxBufferSize()) return 0;
+
+	ROS_WARN_STREAM("Reducing circular buffer size from " << ambient_pointcloud_with_circular_buffer_->getMaxBufferSize() << " to " << max_buffer_size << " points");
+	ambient_pointcloud_with_circular_buffer_->setMaxBufferSize(max_buffer_size);
+	ambient_pointcloud_with_circular_buffer_->shrinkToFit();
+
+	size_t number_of_released_bytes = (number_of_points - ambient_pointcloud_with_circular_buffer_->size()) * bytes_per_point;
+	localization_diagnostics_msg_.memory_circular_buffer_bytes -= std::min((size_t)localization_diagnostics_msg_.memory_circular_buffer_bytes, number_of_released_bytes);
+	return number_of_released_bytes;
+}
+
+
+template<typename PointT>
+bool Localization<PointT>::downsampleReferencePointCloud(const ros::Time& time_stamp) {
+	if (tiled_reference_map_) {
+		ROS_WARN("Reference point cloud downsampling is not applied to tiled reference maps (their memory is bounded by the number of resident tiles)");
+		return false;
+	}
+
+	if (!reference_pointcloud_ || reference_pointcloud_->empty() || reference_pointcloud_downsampling_leaf_size_ <= 0.0) return false;
+
+	float leaf_size = (float)reference_pointcloud_downsampling_leaf_size_;
+	typename pcl::PointCloud<PointT>::Ptr downsampled_reference_pointcloud(new pcl::PointCloud<PointT>()); // new cloud because the previous one may still be referenced by the matchers and publishers
+	pcl::VoxelGrid<PointT> voxel_grid;
+	voxel_grid.setLeafSize(leaf_size, leaf_size, leaf_size);
+	voxel_grid.setDownsampleAllData(true);
+	voxel_grid.setInputCloud(reference_pointcloud_);
+	voxel_grid.filter(*downsampled_reference_pointcloud);
+	reference_pointcloud_downsampling_leaf_size_ *= reference_pointcloud_downsampling_leaf_size_growth_factor_; // the next downsampling must be coarser to release memory
+
+	if (downsampled_reference_pointcloud->size() >= reference_pointcloud_->size() || downsampled_reference_pointcloud->size() <= (size_t)minimum_number_of_points_in_reference_pointcloud_) {
+		ROS_WARN_STREAM("Reference point cloud downsampling with leaf size " << leaf_size << " did not reduce the number of points (" << reference_pointcloud_->size() << " -> " << downsampled_reference_pointcloud->size() << ")");
+		return false;
+	}
+
+	ROS_WARN_STREAM("Downsampled reference point cloud with leaf size " << leaf_size << " from " << reference_pointcloud_->size() << " to " << downsampled_reference_pointcloud->size() << " points");
+	if (reference_pointcloud_normalize_normals_) { pointcloud_utils::normalizePointCloudNormals(*downsampled_reference_pointcloud); } // averaged normals are no longer unit vectors
+	reference_pointcloud_ = downsampled_reference_pointcloud;
+	return updateLocalizationPipelineWithNewReferenceCloud(time_stamp, true);
+}
+
+
 template<typename PointT>
 void Localization<PointT>::resetPointCloudHeight(pcl::PointCloud<PointT>& pointcloud, float height) {
 	for (size_t i = 0; i < pointcloud.size(); ++i) {
@@ -2244,10 +3904,11 @@ void Localization<PointT>::resetPointCloudHeight(pcl::PointCloud<PointT>& pointc
 
 
 template<typename PointT>
-bool Localization<PointT>::applyCloudFilters(std::vector< typename CloudFilter<PointT>::Ptr >& cloud_filters, typename pcl::PointCloud<PointT>::Ptr& pointcloud) {
+bool Localization<PointT>::applyCloudFilters(std::vector< typename CloudFilter<PointT>::Ptr >& cloud_filters, typename pcl::PointCloud<PointT>::Ptr& pointcloud,
+		const typename pcl::search::KdTree<PointT>::Ptr& pointcloud_search_method) {
 	PerformanceTimer performance_timer;
 	performance_timer.start();
-	bool status = s_applyCloudFilters(cloud_filters, pointcloud, minimum_number_of_points_in_ambient_pointcloud_);
+	bool status = s_applyCloudFilters(cloud_filters, pointcloud, minimum_number_of_points_in_ambient_pointcloud_, cloud_filter_chain_, pointcloud_search_method);
 	localization_times_msg_.filtering_time += performance_timer.getElapsedTimeInMilliSec();
 	return status;
 }
@@ -2255,20 +3916,16 @@ bool Localization<PointT>::applyCloudFilters(std::vector< typename CloudFilter<P
 
 template<typename PointT>
 bool Localization<PointT>::s_applyCloudFilters(std::vector< typename CloudFilter<PointT>::Ptr >& cloud_filters, typename pcl::PointCloud<PointT>::Ptr& pointcloud, int minimum_number_of_points_in_ambient_pointcloud) {
-	ROS_DEBUG_STREAM("Filtering cloud in " << pointcloud->header.frame_id << " frame with " << pointcloud->size() << " points");
+	CloudFilterChain<PointT> cloud_filter_chain(0);
+	return s_applyCloudFilters(cloud_filters, pointcloud, minimum_number_of_points_in_ambient_pointcloud, cloud_filter_chain);
+}
 
-	for (size_t i = 0; i < cloud_filters.size(); ++i) {
-		typename pcl::PointCloud<PointT>::Ptr filtered_ambient_pointcloud(new pcl::PointCloud<PointT>());
-		filtered_ambient_pointcloud->header = pointcloud->header;
-		filtered_ambient_pointcloud->sensor_origin_ = pointcloud->sensor_origin_;
-		filtered_ambient_pointcloud->sensor_orientation_ = pointcloud->sensor_orientation_;
-		cloud_filters[i]->filter(pointcloud, filtered_ambient_pointcloud);
-		pointcloud = filtered_ambient_pointcloud; // switch pointers
-		if (pointcloud->size() <= (size_t)minimum_number_of_points_in_ambient_pointcloud)
-			break;
-	}
 
-	return pointcloud->size() > (size_t)minimum_number_of_points_in_ambient_pointcloud;
+template<typename PointT>
+bool Localization<PointT>::s_applyCloudFilters(std::vector< typename CloudFilter<PointT>::Ptr >& cloud_filters, typename pcl::PointCloud<PointT>::Ptr& pointcloud, int minimum_number_of_points_in_ambient_pointcloud, CloudFilterChain<PointT>& cloud_filter_chain,
+		const typename pcl::search::KdTree<PointT>::Ptr& pointcloud_search_method) {
+	ROS_DEBUG_STREAM("Filtering cloud in " << pointcloud->header.frame_id << " frame with " << pointcloud->size() << " points");
+	return cloud_filter_chain.applyFilters(cloud_filters, pointcloud, (size_t)minimum_number_of_points_in_ambient_pointcloud, pointcloud_search_method);
 }
 
 
@@ -2323,15 +3980,15 @@ bool Localization<PointT>::s_applyNormalEstimator(typename NormalEstimator<Point
 		typename pcl::search::KdTree<PointT>::Ptr surface_search_method(new pcl::search::KdTree<PointT>());
 		surface_search_method->setInputCloud(surface);
 		size_t number_surface_points = surface_search_method->getInputCloud()->size();
-		if (normal_estimator) normal_estimator->estimateNormals(pointcloud, surface, surface_search_method, sensor_pose_tf_guess, pointcloud);
-		if (curvature_estimator) curvature_estimator->estimatePointsCurvature(pointcloud, surface_search_method);
+		if (normal_estimator) { DRL_TRACE_SCOPE_OBJECT("normal_estimators", *normal_estimator); normal_estimator->estimateNormals(pointcloud, surface, surface_search_method, sensor_pose_tf_guess, pointcloud); }
+		if (curvature_estimator) { DRL_TRACE_SCOPE_OBJECT("curvature_estimators", *curvature_estimator); curvature_estimator->estimatePointsCurvature(pointcloud, surface_search_method); }
 
 		if (number_surface_points != surface_search_method->getInputCloud()->size()) {
 			pointcloud_search_method = surface_search_method; // normal estimator changed the number of pointcloud points and updated the search kd tree
 		}
 	} else {
-		if (normal_estimator) normal_estimator->estimateNormals(pointcloud, pointcloud, pointcloud_search_method, sensor_pose_tf_guess, pointcloud);
-		if (curvature_estimator) curvature_estimator->estimatePointsCurvature(pointcloud, pointcloud_search_method);
+		if (normal_estimator) { DRL_TRACE_SCOPE_OBJECT("normal_estimators", *normal_estimator); normal_estimator->estimateNormals(pointcloud, pointcloud, pointcloud_search_method, sensor_pose_tf_guess, pointcloud); }
+		if (curvature_estimator) { DRL_TRACE_SCOPE_OBJECT("curvature_estimators", *curvature_estimator); curvature_estimator->estimatePointsCurvature(pointcloud, pointcloud_search_method); }
 	}
 
 	return pointcloud->size() > (size_t)minimum_number_of_points_in_ambient_pointcloud;
@@ -2356,6 +4013,7 @@ template<typename PointT>
 bool Localization<PointT>::s_applyKeypointDetectors(std::vector< typename KeypointDetector<PointT>::Ptr >& keypoint_detectors, typename pcl::PointCloud<PointT>::Ptr& pointcloud, typename pcl::search::KdTree<PointT>::Ptr& surface_search_method, typename pcl::PointCloud<PointT>::Ptr& keypoints) {
 	keypoints->clear();
 	for (size_t i = 0; i < keypoint_detectors.size(); ++i) {
+		DRL_TRACE_SCOPE_OBJECT("keypoint_detectors", *keypoint_detectors[i]);
 		if (i == 0) {
 			keypoint_detectors[i]->findKeypoints(pointcloud, keypoints, pointcloud, surface_search_method);
 		} else {
@@ -2397,6 +4055,7 @@ bool Localization<PointT>::s_applyCloudMatchers(std::vector< typename CloudMatch
 	for (size_t i = 0; i < matchers.size(); ++i) {
 		typename pcl::PointCloud<PointT>::Ptr ambient_pointcloud_aligned(new pcl::PointCloud<PointT>());
 		tf2::Transform pose_correction;
+		DRL_TRACE_SCOPE_OBJECT("cloud_matchers", *matchers[i]);
 		if (matchers[i]->registerCloud(ambient_pointcloud, surface_search_method, pointcloud_keypoints, pose_correction, accepted_pose_corrections, ambient_pointcloud_aligned, false)) {
 			pose_corrections_in_out = pose_correction * pose_corrections_in_out;
 			registration_successful = true;
@@ -2430,6 +4089,67 @@ bool Localization<PointT>::s_applyCloudMatchers(std::vector< typename CloudMatch
 }
 
 
+template<typename PointT>
+bool Localization<PointT>::applyTrackingRecovery(typename pcl::PointCloud<PointT>::Ptr& ambient_pointcloud,
+												 typename pcl::search::KdTree<PointT>::Ptr& surface_search_method,
+												 typename pcl::PointCloud<PointT>::Ptr& pointcloud_keypoints,
+												 const tf2::Transform& pointcloud_pose_initial_guess, tf2::Transform& pose_corrections_in_out) {
+	if (!tracking_recovery_portfolio_) {
+		return applyCloudMatchers(tracking_recovery_matchers_, ambient_pointcloud, surface_search_method, pointcloud_keypoints, pose_corrections_in_out);
+	}
+
+	// the ambient point cloud was transformed to the map frame with the pointcloud_pose_initial_guess (computed from the last_accepted_pose_odom_to_map_) and then corrected with the pose_corrections_in_out
+	tf2::Transform current_pose_odom_to_map = pose_corrections_in_out * last_accepted_pose_odom_to_map_;
+	tf2::Transform pose_corrections = pose_corrections_in_out;
+	typename TrackingRecoveryPortfolio<PointT>::AttemptResult attempt_result;
+	bool attempt_accepted = tracking_recovery_portfolio_->recoverTracking(ambient_pointcloud, pointcloud_keypoints, current_pose_odom_to_map, reference_pointcloud_search_method_,
+			[&](const typename TrackingRecoveryPortfolio<PointT>::AttemptResult& result) { return validateTrackingRecoveryAttempt(result, pointcloud_pose_initial_guess, pose_corrections); },
+			attempt_result);
+
+	if (attempt_result.registration_successful) {
+		if (attempt_result.registered_pointcloud_keypoints && pointcloud_keypoints != ambient_pointcloud) {
+			*pointcloud_keypoints = *attempt_result.registered_pointcloud_keypoints;
+		}
+		ambient_pointcloud = attempt_result.registered_pointcloud;
+		surface_search_method = attempt_result.registered_pointcloud_search_method;
+		pose_corrections_in_out = attempt_result.pose_correction * pose_corrections_in_out;
+		accepted_pose_corrections_.insert(accepted_pose_corrections_.end(), attempt_result.accepted_pose_corrections.begin(), attempt_result.accepted_pose_corrections.end());
+		ROS_DEBUG_STREAM("Tracking recovery portfolio " << (attempt_accepted ? "accepted" : "did not accept any attempt and is using") << " the registration of strategy [" << attempt_result.strategy_name
+				<< "] with initial guess " << attempt_result.initial_guess_index << " (outliers percentage: " << attempt_result.outliers_percentage << ")");
+	}
+
+	if (attempt_result.number_of_registration_iterations > 0) number_of_registration_iterations_for_all_matchers_ += attempt_result.number_of_registration_iterations;
+	correspondence_estimation_time_for_all_matchers_ += attempt_result.correspondence_estimation_time;
+	transformation_estimation_time_for_all_matchers_ += attempt_result.transformation_estimation_time;
+	transform_cloud_time_for_all_matchers_ += attempt_result.transform_cloud_time;
+	cloud_align_time_for_all_matchers_ += attempt_result.cloud_align_time;
+	last_matcher_convergence_state_ = attempt_result.last_matcher_convergence_state;
+	root_mean_square_error_of_last_registration_correspondences_ = attempt_result.root_mean_square_error_of_last_registration_correspondences;
+	number_correspondences_last_registration_algorithm_ = attempt_result.number_correspondences_last_registration_algorithm;
+
+	return attempt_result.registration_successful;
+}
+
+
+template<typename PointT>
+bool Localization<PointT>::validateTrackingRecoveryAttempt(const typename TrackingRecoveryPortfolio<PointT>::AttemptResult& attempt_result,
+														   const tf2::Transform& pointcloud_pose_initial_guess, const tf2::Transform& pose_corrections) {
+	// called concurrently by the portfolio threads -> uses the inliers statistics of the attempt instead of the outlier detectors and cloud analyzers (that store their results in the localization)
+	tf2::Transform pointcloud_pose_corrected = attempt_result.pose_correction * pose_corrections * pointcloud_pose_initial_guess;
+	bool tracking_valid = last_accepted_pose_valid_ && (ros::Time::now() - last_accepted_pose_time_ < pose_tracking_timeout_);
+	for (size_t i = 0; i < transformation_validators_tracking_recovery_.size(); ++i) {
+		DRL_TRACE_SCOPE_OBJECT("transformation_validators", *transformation_validators_tracking_recovery_[i]);
+		if (!transformation_validators_tracking_recovery_[i]->validateNewLocalizationPose(tracking_valid ? last_accepted_pose_base_link_to_map_ : pointcloud_pose_corrected,
+				tracking_valid ? pointcloud_pose_initial_guess : pointcloud_pose_corrected, pointcloud_pose_corrected,
+				attempt_result.root_mean_square_error_inliers, -1.0, attempt_result.outliers_percentage, -1.0, 1.0, 0.0)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
 template<typename PointT>
 bool Localization<PointT>::applyTransformationAligner(const tf2::Transform& pointcloud_pose_initial_guess, const tf2::Transform& pointcloud_pose_corrected, tf2::Transform& new_pose_corrections_out, const ros::Time& pointcloud_time) {
 	SensorDataProcessingStatus sensor_data_processing_status;
@@ -2525,6 +4245,7 @@ double Localization<PointT>::s_applyOutlierDetectors(typename pcl::PointCloud<Po
 		}
 
 		double rmse = 0.0;
+		DRL_TRACE_SCOPE_OBJECT("outlier_detectors", *detectors[i]);
 		number_outliers += detectors[i]->detectOutliers(reference_pointcloud_search_method, *pointcloud, outliers, inliers, rmse);
 		root_mean_square_error_inliers += rmse;
 		detected_outliers.push_back(outliers);
@@ -2613,7 +4334,7 @@ void Localization<PointT>::publishDetectedOutliers() {
 	}
 
 	if(registered_outliers_)
-		pointcloud_conversions::publishPointCloud(*registered_outliers_, aligned_pointcloud_global_outliers_publisher_, map_frame_id_, publish_global_inliers_and_outliers_pointclouds_only_if_there_is_subscribers_, "aligned pointcloud global outliers");
+		pointcloud_conversions::publishPointCloudAsynchronously<PointT>(registered_outliers_, aligned_pointcloud_global_outliers_publisher_, map_frame_id_, publish_global_inliers_and_outliers_pointclouds_only_if_there_is_subscribers_, "aligned pointcloud global outliers");
 
 	if (outlier_detectors_reference_pointcloud_.size() == detected_outliers_reference_pointcloud_.size()) {
 		for (size_t i = 0; i < detected_outliers_reference_pointcloud_.size(); ++i) {
@@ -2622,7 +4343,7 @@ void Localization<PointT>::publishDetectedOutliers() {
 	}
 	
 	if (registered_outliers_reference_pointcloud_)
-		pointcloud_conversions::publishPointCloud(*registered_outliers_reference_pointcloud_, reference_pointcloud_global_outliers_publisher_, map_frame_id_, publish_global_inliers_and_outliers_pointclouds_only_if_there_is_subscribers_, "reference pointcloud global outliers");
+		pointcloud_conversions::publishPointCloudAsynchronously<PointT>(registered_outliers_reference_pointcloud_, reference_pointcloud_global_outliers_publisher_, map_frame_id_, publish_global_inliers_and_outliers_pointclouds_only_if_there_is_subscribers_, "reference pointcloud global outliers");
 
 	detected_outliers_.clear();
 	detected_outliers_reference_pointcloud_.clear();
@@ -2638,7 +4359,7 @@ void Localization<PointT>::publishDetectedInliers() {
 	}
 	
 	if (registered_inliers_)
-		pointcloud_conversions::publishPointCloud(*registered_inliers_, aligned_pointcloud_global_inliers_publisher_, map_frame_id_, publish_global_inliers_and_outliers_pointclouds_only_if_there_is_subscribers_, "aligned pointcloud global inliers");
+		pointcloud_conversions::publishPointCloudAsynchronously<PointT>(registered_inliers_, aligned_pointcloud_global_inliers_publisher_, map_frame_id_, publish_global_inliers_and_outliers_pointclouds_only_if_there_is_subscribers_, "aligned pointcloud global inliers");
 
 	if (outlier_detectors_reference_pointcloud_.size() == detected_inliers_reference_pointcloud_.size()) {
 		for (size_t i = 0; i < detected_inliers_reference_pointcloud_.size(); ++i) {
@@ -2647,7 +4368,7 @@ void Localization<PointT>::publishDetectedInliers() {
 	}
 
 	if (registered_inliers_reference_pointcloud_)
-		pointcloud_conversions::publishPointCloud(*registered_inliers_reference_pointcloud_, reference_pointcloud_global_inliers_publisher_, map_frame_id_, publish_global_inliers_and_outliers_pointclouds_only_if_there_is_subscribers_, "reference pointcloud global inliers");
+		pointcloud_conversions::publishPointCloudAsynchronously<PointT>(registered_inliers_reference_pointcloud_, reference_pointcloud_global_inliers_publisher_, map_frame_id_, publish_global_inliers_and_outliers_pointclouds_only_if_there_is_subscribers_, "reference pointcloud global inliers");
 
 	detected_inliers_.clear();
 	detected_inliers_reference_pointcloud_.clear();
@@ -2656,6 +4377,11 @@ void Localization<PointT>::publishDetectedInliers() {
 
 template<typename PointT>
 void Localization<PointT>::publishDetectedInliersAndOutliers() {
+	if (!AsyncCloudPublisher::s_isPublishing(aligned_pointcloud_global_inliers_and_outliers_publisher_, publish_global_inliers_and_outliers_pointclouds_only_if_there_is_subscribers_) &&
+		!AsyncCloudPublisher::s_isPublishing(reference_pointcloud_global_inliers_and_outliers_publisher_, publish_global_inliers_and_outliers_pointclouds_only_if_there_is_subscribers_)) {
+		return;
+	}
+
 	typename pcl::PointCloud<PointT>::Ptr registered_inliers_and_outliers(new pcl::PointCloud<PointT>());
 	typename pcl::PointCloud<PointT>::Ptr registered_inliers_and_outliers_reference_pointcloud(new pcl::PointCloud<PointT>());
 
@@ -2665,8 +4391,8 @@ void Localization<PointT>::publishDetectedInliersAndOutliers() {
 	if (registered_inliers_reference_pointcloud_) *registered_inliers_and_outliers_reference_pointcloud += *registered_inliers_reference_pointcloud_;
 	if (registered_outliers_reference_pointcloud_) *registered_inliers_and_outliers_reference_pointcloud += *registered_outliers_reference_pointcloud_;
 
-	pointcloud_conversions::publishPointCloud(*registered_inliers_and_outliers, aligned_pointcloud_global_inliers_and_outliers_publisher_, map_frame_id_, publish_global_inliers_and_outliers_pointclouds_only_if_there_is_subscribers_, "aligned pointcloud global inliers and outliers");
-	pointcloud_conversions::publishPointCloud(*registered_inliers_and_outliers_reference_pointcloud, reference_pointcloud_global_inliers_and_outliers_publisher_, map_frame_id_, publish_global_inliers_and_outliers_pointclouds_only_if_there_is_subscribers_, "reference pointcloud global inliers and outliers");
+	pointcloud_conversions::publishPointCloudAsynchronously<PointT>(registered_inliers_and_outliers, aligned_pointcloud_global_inliers_and_outliers_publisher_, map_frame_id_, publish_global_inliers_and_outliers_pointclouds_only_if_there_is_subscribers_, "aligned pointcloud global inliers and outliers");
+	pointcloud_conversions::publishPointCloudAsynchronously<PointT>(registered_inliers_and_outliers_reference_pointcloud, reference_pointcloud_global_inliers_and_outliers_publisher_, map_frame_id_, publish_global_inliers_and_outliers_pointclouds_only_if_there_is_subscribers_, "reference pointcloud global inliers and outliers");
 }
 
 
@@ -2677,6 +4403,7 @@ bool Localization<PointT>::applyCloudAnalyzers(const tf2::Transform& estimated_p
 	outliers_angular_distribution_ = -2.0;
 
 	if (cloud_analyzer_) {
+		DRL_TRACE_SCOPE_OBJECT("cloud_analyzers", *cloud_analyzer_);
 		if (compute_outliers_angular_distribution_ && registered_outliers_ && !detected_outliers_.empty()) {
 			std::vector<size_t> analysis_histogram;
 			outliers_angular_distribution_ = cloud_analyzer_->analyzeCloud(estimated_pose, *registered_outliers_, analysis_histogram);
@@ -2697,6 +4424,7 @@ bool Localization<PointT>::applyCloudAnalyzers(const tf2::Transform& estimated_p
 template<typename PointT>
 bool Localization<PointT>::applyTransformationValidator(std::vector< TransformationValidator::Ptr >& transformation_validators, const tf2::Transform& pointcloud_pose_initial_guess, tf2::Transform& pointcloud_pose_corrected_in_out, double max_outlier_percentage, double max_outlier_percentage_reference_pointcloud) {
 	for (size_t i = 0; i < transformation_validators.size(); ++i) {
+		DRL_TRACE_SCOPE_OBJECT("transformation_validators", *transformation_validators[i]);
 		if (last_accepted_pose_valid_ && (ros::Time::now() - last_accepted_pose_time_ < pose_tracking_timeout_)) {
 			if (!transformation_validators[i]->validateNewLocalizationPose(last_accepted_pose_base_link_to_map_, pointcloud_pose_initial_guess, pointcloud_pose_corrected_in_out, root_mean_square_error_inliers_, root_mean_square_error_inliers_reference_pointcloud_, max_outlier_percentage, max_outlier_percentage_reference_pointcloud, inliers_angular_distribution_, outliers_angular_distribution_)) {
 				return false;
@@ -2731,6 +4459,17 @@ void Localization<PointT>::fillPoseCovariance(geometry_msgs::PoseWithCovarianceS
 }
 
 
+template<typename PointT>
+LocalizationTimes Localization<PointT>::getLocalizationTimes() const {
+	LocalizationTimes localization_times = localization_times_msg_;
+	localization_times.correspondence_estimation_time_for_all_matchers = correspondence_estimation_time_for_all_matchers_;
+	localization_times.transformation_estimation_time_for_all_matchers = transformation_estimation_time_for_all_matchers_;
+	localization_times.transform_cloud_time_for_all_matchers = transform_cloud_time_for_all_matchers_;
+	localization_times.cloud_align_time_for_all_matchers = cloud_align_time_for_all_matchers_;
+	return localization_times;
+}
+
+
 template<typename PointT>
 bool Localization<PointT>::updateLocalizationWithAmbientPointCloud(typename pcl::PointCloud<PointT>::Ptr& ambient_pointcloud, const ros::Time& pointcloud_time, const tf2::Transform& pointcloud_pose_initial_guess,
 		tf2::Transform& pointcloud_pose_corrected_out, tf2::Transform& pose_corrections_out, typename pcl::PointCloud<PointT>::Ptr ambient_pointcloud_keypoints_out) {
@@ -2840,7 +4579,7 @@ bool Localization<PointT>::updateLocalizationWithAmbientPointCloud(typename pcl:
 			}
 		}
 
-		if (!applyCloudFilters(ambient_pointcloud_filters_after_normal_estimation_, ambient_pointcloud_integration)) {
+		if (!applyCloudFilters(ambient_pointcloud_filters_after_normal_estimation_, ambient_pointcloud_integration, ambient_integration_search_method)) {
 			sensor_data_processing_status_ = PointCloudFilteringFailed;
 			return false;
 		}
@@ -2921,7 +4660,7 @@ bool Localization<PointT>::updateLocalizationWithAmbientPointCloud(typename pcl:
 	}
 
 	// ==============================================================  check point cloud size
-	if (ambient_pointcloud_with_circular_buffer_ && circular_buffer_require_reception_of_pointcloud_msgs_from_all_topics_before_doing_registration_) {
+	if (ambient_pointcloud_with_circular_buffer_ && circular_buffer_require_reception_of_pointcloud_msgs_from_all_topics_before_doing_registration_ && !multi_sensor_synchronization_enabled_) {
 		msg_frame_ids_with_data_in_circular_buffer_.insert(ambient_point_cloud_original_frame_id);
 		if (msg_frame_ids_with_data_in_circular_buffer_.size() < ambient_pointcloud_subscribers_.size()) {
 			ROS_DEBUG_STREAM("Added frame_id " << ambient_point_cloud_original_frame_id << " to the set containing the received frame_ids with data in the circular buffer");
@@ -2941,8 +4680,13 @@ bool Localization<PointT>::updateLocalizationWithAmbientPointCloud(typename pcl:
 	PerformanceTimer performance_timer;
 	performance_timer.start();
 	ROS_DEBUG_STREAM("Creating k-d tree for ambient point cloud with " << ambient_pointcloud->size() << " points");
-	typename pcl::search::KdTree<PointT>::Ptr ambient_search_method(new pcl::search::KdTree<PointT>());
-	ambient_search_method->setInputCloud(ambient_pointcloud);
+	typename pcl::search::KdTree<PointT>::Ptr ambient_search_method;
+	if (ambient_pointcloud_with_circular_buffer_ && ambient_pointcloud == ambient_pointcloud_with_circular_buffer_->getPointCloudPtr()) {
+		ambient_search_method = ambient_pointcloud_with_circular_buffer_->getSearchMethod(); // reuses the k-d trees of the scans already in the buffer
+	} else {
+		ambient_search_method.reset(new pcl::search::KdTree<PointT>());
+		ambient_search_method->setInputCloud(ambient_pointcloud);
+	}
 	ROS_DEBUG_STREAM("Finished creating ambient point cloud k-d tree (elapsed time in milliseconds: " << performance_timer.getElapsedTimeInMilliSec() << ")");
 
 	bool computed_normals = false;
@@ -2955,18 +4699,30 @@ bool Localization<PointT>::updateLocalizationWithAmbientPointCloud(typename pcl:
 		computed_normals = true;
 	}
 
-	if (!applyCloudFilters(ambient_pointcloud_filters_after_normal_estimation_, ambient_pointcloud)) {
+	if (!applyCloudFilters(ambient_pointcloud_filters_after_normal_estimation_, ambient_pointcloud, ambient_search_method)) {
 		sensor_data_processing_status_ = PointCloudFilteringFailed;
 		return false;
 	}
 
+	size_t number_of_points_before_nan_removal = ambient_pointcloud->size();
 	std::vector<int> indexes;
 	pcl::removeNaNFromPointCloud(*ambient_pointcloud, *ambient_pointcloud, indexes);
 	indexes.clear();
 	pcl::removeNaNNormalsFromPointCloud(*ambient_pointcloud, *ambient_pointcloud, indexes);
 	indexes.clear();
 
-	pointcloud_conversions::publishPointCloud(*ambient_pointcloud, filtered_pointcloud_publisher_, map_frame_id_for_publishing_pointclouds_, publish_filtered_pointcloud_only_if_there_is_subscribers_, "filtered ambient pointcloud");
+	if (ambient_search_method->getInputCloud() != ambient_pointcloud || ambient_pointcloud->size() != number_of_points_before_nan_removal) {
+		// the k-d tree (or the chunks of the circular buffer) index the points before the filtering / compaction (with a size mismatch the ChunkedKdTreeSearch falls back to a single k-d tree)
+		ambient_search_method->setInputCloud(ambient_pointcloud);
+	}
+
+	if (AsyncCloudPublisher::s_isPublishing(filtered_pointcloud_publisher_, publish_filtered_pointcloud_only_if_there_is_subscribers_)) {
+		typename pcl::PointCloud<PointT>::ConstPtr filtered_pointcloud = ambient_pointcloud;
+		if (AsyncCloudPublisher::getInstance().isRunning()) {
+			filtered_pointcloud.reset(new pcl::PointCloud<PointT>(*ambient_pointcloud)); // the ambient point cloud is transformed in place during registration
+		}
+		pointcloud_conversions::publishPointCloudAsynchronously<PointT>(filtered_pointcloud, filtered_pointcloud_publisher_, map_frame_id_for_publishing_pointclouds_, false, "filtered ambient pointcloud");
+	}
 
 	if (!filtered_pointcloud_save_filename_.empty()) {
 		if (!filtered_pointcloud_save_frame_id_.empty() && filtered_pointcloud_save_frame_id_ != ambient_pointcloud->header.frame_id) {
@@ -3033,6 +4789,13 @@ bool Localization<PointT>::updateLocalizationWithAmbientPointCloud(typename pcl:
 					computed_keypoints = true;
 				}
 
+				if (initial_pose_estimators_feature_matchers_reference_pointcloud_outdated_) {
+					for (size_t i = 0; i < initial_pose_estimators_feature_matchers_.size(); ++i) {
+						initial_pose_estimators_feature_matchers_[i]->setupReferenceCloud(reference_pointcloud_, reference_pointcloud_keypoints_, reference_pointcloud_search_method_);
+					}
+					initial_pose_estimators_feature_matchers_reference_pointcloud_outdated_ = false;
+				}
+
 				ambient_pointcloud->header.frame_id = map_frame_id_;
 				applyCloudMatchers(initial_pose_estimators_feature_matchers_, ambient_pointcloud, ambient_search_method,
 								   (ambient_pointcloud_keypoints_out->size() < (size_t) minimum_number_of_points_in_ambient_pointcloud_) ? ambient_pointcloud : ambient_pointcloud_keypoints_out,
@@ -3085,10 +4848,10 @@ bool Localization<PointT>::updateLocalizationWithAmbientPointCloud(typename pcl:
 
 				performance_timer.restart();
 				ambient_pointcloud->header.frame_id = map_frame_id_;
-				if (applyCloudMatchers(tracking_recovery_matchers_, ambient_pointcloud, ambient_search_method,
-									   (ambient_pointcloud_keypoints_out->size() < (size_t) minimum_number_of_points_in_ambient_pointcloud_) ? ambient_pointcloud
-																																			 : ambient_pointcloud_keypoints_out,
-									   pose_corrections_out)) {
+				if (applyTrackingRecovery(ambient_pointcloud, ambient_search_method,
+										  (ambient_pointcloud_keypoints_out->size() < (size_t) minimum_number_of_points_in_ambient_pointcloud_) ? ambient_pointcloud
+																																				: ambient_pointcloud_keypoints_out,
+										  pointcloud_pose_initial_guess, pose_corrections_out)) {
 					ROS_INFO("Successfully performed registration recovery");
 					performed_recovery = true;
 					localization_times_msg_.pointcloud_registration_time += performance_timer.getElapsedTimeInMilliSec();
@@ -3106,6 +4869,9 @@ bool Localization<PointT>::updateLocalizationWithAmbientPointCloud(typename pcl:
 	tf2::Transform post_process_cloud_registration_pose_corrections;
 	if (!applyTransformationAligner(pointcloud_pose_initial_guess, pointcloud_pose_corrected_out, post_process_cloud_registration_pose_corrections, pointcloud_time)) { return false; }
 	pcl::transformPointCloudWithNormals(*ambient_pointcloud, *ambient_pointcloud, laserscan_to_pointcloud::tf_rosmsg_eigen_conversions::transformTF2ToTransform<double>(post_process_cloud_registration_pose_corrections));
+	if (ambient_pointcloud_with_circular_buffer_ && ambient_pointcloud == ambient_pointcloud_with_circular_buffer_->getPointCloudPtr()) {
+		ambient_pointcloud_with_circular_buffer_->applyTransform(laserscan_to_pointcloud::tf_rosmsg_eigen_conversions::transformTF2ToTransform<double>(post_process_cloud_registration_pose_corrections).matrix().cast<float>());
+	}
 	pcl::transformPointCloudWithNormals(*ambient_pointcloud_keypoints_out, *ambient_pointcloud_keypoints_out, laserscan_to_pointcloud::tf_rosmsg_eigen_conversions::transformTF2ToTransform<double>(post_process_cloud_registration_pose_corrections));
 	pose_corrections_out = post_process_cloud_registration_pose_corrections * pose_corrections_out;
 	pointcloud_pose_corrected_out = pose_corrections_out * pointcloud_pose_initial_guess;
@@ -3172,13 +4938,16 @@ bool Localization<PointT>::updateLocalizationWithAmbientPointCloud(typename pcl:
 				}
 
 				ambient_pointcloud->header.frame_id = map_frame_id_;
-				if (applyCloudMatchers(tracking_recovery_matchers_, ambient_pointcloud, ambient_search_method,
-									   (ambient_pointcloud_keypoints_out->size() < (size_t) minimum_number_of_points_in_ambient_pointcloud_) ? ambient_pointcloud
-																																			 : ambient_pointcloud_keypoints_out,
-									   pose_corrections_out)) {
+				if (applyTrackingRecovery(ambient_pointcloud, ambient_search_method,
+										  (ambient_pointcloud_keypoints_out->size() < (size_t) minimum_number_of_points_in_ambient_pointcloud_) ? ambient_pointcloud
+																																				: ambient_pointcloud_keypoints_out,
+										  pointcloud_pose_initial_guess, pose_corrections_out)) {
 					pointcloud_pose_corrected_out = pose_corrections_out * pointcloud_pose_initial_guess;
 					if (!applyTransformationAligner(pointcloud_pose_initial_guess, pointcloud_pose_corrected_out, post_process_cloud_registration_pose_corrections, pointcloud_time)) { return false; }
 					pcl::transformPointCloudWithNormals(*ambient_pointcloud, *ambient_pointcloud, laserscan_to_pointcloud::tf_rosmsg_eigen_conversions::transformTF2ToTransform<double>(post_process_cloud_registration_pose_corrections));
+					if (ambient_pointcloud_with_circular_buffer_ && ambient_pointcloud == ambient_pointcloud_with_circular_buffer_->getPointCloudPtr()) {
+						ambient_pointcloud_with_circular_buffer_->applyTransform(laserscan_to_pointcloud::tf_rosmsg_eigen_conversions::transformTF2ToTransform<double>(post_process_cloud_registration_pose_corrections).matrix().cast<float>());
+					}
 					pcl::transformPointCloudWithNormals(*ambient_pointcloud_keypoints_out, *ambient_pointcloud_keypoints_out, laserscan_to_pointcloud::tf_rosmsg_eigen_conversions::transformTF2ToTransform<double>(post_process_cloud_registration_pose_corrections));
 					pose_corrections_out = post_process_cloud_registration_pose_corrections * pose_corrections_out;
 					pointcloud_pose_corrected_out = pose_corrections_out * pointcloud_pose_initial_guess;
@@ -3243,6 +5012,7 @@ bool Localization<PointT>::updateLocalizationWithAmbientPointCloud(typename pcl:
 
 	performance_timer.restart();
 	if (registration_covariance_estimator_) {
+		DRL_TRACE_SCOPE_OBJECT("registration_covariance_estimators", *registration_covariance_estimator_);
 		double opengl_matrix[16];
 		pose_corrections_out.getOpenGLMatrix(opengl_matrix);
 		Eigen::Matrix4d registration_corrections(opengl_matrix);
@@ -3284,20 +5054,44 @@ template<typename PointT>
 bool Localization<PointT>::updateReferencePointCloudWithAmbientPointCloud(typename pcl::PointCloud<PointT>::Ptr& pointcloud, typename pcl::PointCloud<PointT>::Ptr pointcloud_keypoints) {
 	ROS_DEBUG_STREAM("Adding " << pointcloud->size() << " points to a reference cloud with " << reference_pointcloud_->size() << " points");
 
-	*reference_pointcloud_ += *pointcloud;
-	*reference_pointcloud_keypoints_ += *pointcloud_keypoints;
-
 	if (use_incremental_map_update_) {
+		std::vector<int> inserted_points_indices;
+		typename VoxelHashSearch<PointT>::Ptr reference_pointcloud_voxel_hash_search = std::dynamic_pointer_cast< VoxelHashSearch<PointT> >(reference_pointcloud_search_method_);
+		if (reference_pointcloud_voxel_hash_search && reference_pointcloud_voxel_hash_search->getInputCloud().get() == reference_pointcloud_.get()) {
+			size_t number_of_points_added = reference_pointcloud_voxel_hash_search->insertPoints(*pointcloud, *reference_pointcloud_, &inserted_points_indices);
+			ROS_DEBUG_STREAM("Voxel hash search integrated " << number_of_points_added << " points in " << reference_pointcloud_voxel_hash_search->getNumberOfVoxels() << " voxels");
+
+			// the keypoints are capped with the same voxels as the reference point cloud
+			if (!reference_pointcloud_keypoints_voxel_hash_search_) {
+				reference_pointcloud_keypoints_voxel_hash_search_ = typename VoxelHashSearch<PointT>::Ptr(new VoxelHashSearch<PointT>(reference_pointcloud_voxel_hash_search->getVoxelSize(),
+						reference_pointcloud_voxel_hash_search->getMaximumNumberOfPointsPerVoxel(), reference_pointcloud_voxel_hash_search->getMaximumNumberOfSearchRings()));
+			}
+			if (reference_pointcloud_keypoints_voxel_hash_search_->getInputCloud().get() != reference_pointcloud_keypoints_.get()
+					|| reference_pointcloud_keypoints_voxel_hash_search_->getNumberOfIndexedPoints() > reference_pointcloud_keypoints_->size()) {
+				reference_pointcloud_keypoints_voxel_hash_search_->setInputCloud(reference_pointcloud_keypoints_);
+			}
+			reference_pointcloud_keypoints_voxel_hash_search_->insertPoints(*pointcloud_keypoints, *reference_pointcloud_keypoints_);
+		} else {
+			size_t number_of_points_before_integration = reference_pointcloud_->size();
+			*reference_pointcloud_ += *pointcloud;
+			*reference_pointcloud_keypoints_ += *pointcloud_keypoints;
+			reference_pointcloud_search_method_->setInputCloud(reference_pointcloud_);
+			for (size_t i = number_of_points_before_integration; i < reference_pointcloud_->size(); ++i) {
+				inserted_points_indices.push_back((int)i);
+			}
+		}
+
 		localization_diagnostics_msg_.number_points_reference_pointcloud = reference_pointcloud_->size();
 		localization_diagnostics_msg_.number_points_reference_pointcloud_after_filtering = reference_pointcloud_->size();
 		localization_diagnostics_msg_.number_keypoints_reference_pointcloud = reference_pointcloud_keypoints_->size();
-		reference_pointcloud_search_method_->setInputCloud(reference_pointcloud_);
 
-		updateMatchersReferenceCloud();
+		updateMatchersReferenceCloudWithInsertedPoints(inserted_points_indices);
 		publishReferencePointCloud(pcl_conversions::fromPCL(pointcloud->header).stamp, true);
 
 		return true;
 	} else {
+		*reference_pointcloud_ += *pointcloud;
+		*reference_pointcloud_keypoints_ += *pointcloud_keypoints;
 		return updateLocalizationPipelineWithNewReferenceCloud(pcl_conversions::fromPCL(pointcloud->header).stamp);
 	}
 
@@ -0,0 +1,292 @@
+/**\file tracking_recovery_portfolio.hpp
+ * \brief Description...
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+#include <dynamic_robot_localization/localization/tracking_recovery_portfolio.h>
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+namespace dynamic_robot_localization {
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <imports>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </imports>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+// =============================================================================  <public-section>  ============================================================================
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <constructors-destructor>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+template<typename PointT>
+TrackingRecoveryPortfolio<PointT>::TrackingRecoveryPortfolio() :
+	number_of_threads_(0),
+	maximum_number_of_accepted_poses_(0),
+	minimum_translation_between_initial_guesses_(0.2),
+	minimum_rotation_between_initial_guesses_(0.2),
+	max_inliers_distance_(0.1),
+	minimum_number_of_points_in_ambient_pointcloud_(10) {}
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </constructors-destructor>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <TrackingRecoveryPortfolio-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+template<typename PointT>
+void TrackingRecoveryPortfolio<PointT>::addStrategy(const std::string& name, const std::vector< std::vector< typename CloudMatcher<PointT>::Ptr > >& matchers_per_initial_guess) {
+	Strategy strategy;
+	strategy.name = name;
+	for (size_t i = 0; i < matchers_per_initial_guess.size(); ++i) {
+		if (matchers_per_initial_guess[i].empty()) { break; }
+		for (size_t j = 0; j < matchers_per_initial_guess[i].size(); ++j) {
+			matchers_per_initial_guess[i][j]->clearPublishers();
+			matchers_per_initial_guess[i][j]->setRegistrationVisualizer(std::shared_ptr< RegistrationVisualizer<PointT, PointT> >()); // the visualizer is not thread safe
+		}
+		strategy.matchers_per_initial_guess.push_back(matchers_per_initial_guess[i]);
+	}
+
+	if (!strategy.matchers_per_initial_guess.empty()) {
+		strategies_.push_back(strategy);
+	}
+}
+
+
+template<typename PointT>
+void TrackingRecoveryPortfolio<PointT>::addAcceptedPose(const tf2::Transform& pose_odom_to_map) {
+	if (maximum_number_of_accepted_poses_ == 0) { return; }
+
+	if (!accepted_poses_odom_to_map_.empty()) {
+		const tf2::Transform& last_pose = accepted_poses_odom_to_map_.front();
+		if ((pose_odom_to_map.getOrigin() - last_pose.getOrigin()).length() < minimum_translation_between_initial_guesses_ &&
+				std::abs(pose_odom_to_map.getRotation().normalize().angleShortestPath(last_pose.getRotation().normalize())) < minimum_rotation_between_initial_guesses_) {
+			accepted_poses_odom_to_map_.front() = pose_odom_to_map; // keeps the newest pose of each region
+			return;
+		}
+	}
+
+	accepted_poses_odom_to_map_.push_front(pose_odom_to_map);
+	while (accepted_poses_odom_to_map_.size() > maximum_number_of_accepted_poses_) {
+		accepted_poses_odom_to_map_.pop_back();
+	}
+}
+
+
+template<typename PointT>
+void TrackingRecoveryPortfolio<PointT>::setupReferenceCloud(typename pcl::PointCloud<PointT>::Ptr& reference_cloud, typename pcl::PointCloud<PointT>::Ptr& reference_cloud_keypoints,
+		typename pcl::search::KdTree<PointT>::Ptr& search_method) {
+	for (size_t i = 0; i < strategies_.size(); ++i) {
+		for (size_t j = 0; j < strategies_[i].matchers_per_initial_guess.size(); ++j) {
+			for (size_t k = 0; k < strategies_[i].matchers_per_initial_guess[j].size(); ++k) {
+				strategies_[i].matchers_per_initial_guess[j][k]->setupReferenceCloud(reference_cloud, reference_cloud_keypoints, search_method);
+			}
+		}
+	}
+}
+
+
+template<typename PointT>
+bool TrackingRecoveryPortfolio<PointT>::registrationRequiresNormalsOnAmbientPointCloud() {
+	for (size_t i = 0; i < strategies_.size(); ++i) {
+		for (size_t j = 0; j < strategies_[i].matchers_per_initial_guess.size(); ++j) {
+			for (size_t k = 0; k < strategies_[i].matchers_per_initial_guess[j].size(); ++k) {
+				if (strategies_[i].matchers_per_initial_guess[j][k]->registrationRequiresNormalsOnAmbientPointCloud()) { return true; }
+			}
+		}
+	}
+	return false;
+}
+
+
+template<typename PointT>
+bool TrackingRecoveryPortfolio<PointT>::recoverTracking(const typename pcl::PointCloud<PointT>::Ptr& ambient_pointcloud, const typename pcl::PointCloud<PointT>::Ptr& ambient_pointcloud_keypoints,
+		const tf2::Transform& current_pose_odom_to_map, const typename pcl::search::KdTree<PointT>::Ptr& reference_pointcloud_search_method,
+		const AttemptValidator& attempt_validator, AttemptResult& result_out) {
+	result_out = AttemptResult();
+	if (strategies_.empty() || !ambient_pointcloud || ambient_pointcloud->size() < (size_t)minimum_number_of_points_in_ambient_pointcloud_) { return false; }
+
+	PerformanceTimer performance_timer;
+	performance_timer.start();
+
+	std::vector<tf2::Transform> initial_guesses_corrections(1, tf2::Transform::getIdentity());
+	tf2::Transform current_pose_odom_to_map_inverse = current_pose_odom_to_map.inverse();
+	for (size_t i = 0; i < accepted_poses_odom_to_map_.size(); ++i) {
+		tf2::Transform initial_guess_correction = accepted_poses_odom_to_map_[i] * current_pose_odom_to_map_inverse;
+		if (isFarFromInitialGuesses(initial_guess_correction, initial_guesses_corrections)) {
+			initial_guesses_corrections.push_back(initial_guess_correction);
+		}
+	}
+
+	// the attempts from the current pose estimate start first
+	std::vector<Attempt> attempts;
+	for (size_t initial_guess_index = 0; initial_guess_index < initial_guesses_corrections.size(); ++initial_guess_index) {
+		for (size_t i = 0; i < strategies_.size(); ++i) {
+			if (initial_guess_index < strategies_[i].matchers_per_initial_guess.size()) {
+				Attempt attempt;
+				attempt.strategy = &strategies_[i];
+				attempt.initial_guess_index = initial_guess_index;
+				attempt.initial_guess_correction = initial_guesses_corrections[initial_guess_index];
+				attempts.push_back(attempt);
+			}
+		}
+	}
+
+	size_t number_of_threads = (number_of_threads_ > 0 ? (size_t)number_of_threads_ : (size_t)std::max(1u, std::thread::hardware_concurrency()));
+	number_of_threads = std::min(number_of_threads, attempts.size());
+
+	std::vector<AttemptResult> results(attempts.size());
+	std::atomic<size_t> next_attempt(0);
+	std::atomic<bool> attempt_accepted(false);
+	auto worker = [&]() {
+		size_t attempt_index;
+		while (!attempt_accepted && (attempt_index = next_attempt++) < attempts.size()) {
+			runAttempt(attempts[attempt_index], ambient_pointcloud, ambient_pointcloud_keypoints, reference_pointcloud_search_method, results[attempt_index]);
+			if (results[attempt_index].registration_successful && (!attempt_validator || attempt_validator(results[attempt_index]))) {
+				results[attempt_index].accepted = true;
+				attempt_accepted = true;
+			}
+		}
+	};
+
+	std::vector<std::thread> threads;
+	for (size_t i = 1; i < number_of_threads; ++i) {
+		threads.push_back(std::thread(worker));
+	}
+	worker();
+	for (size_t i = 0; i < threads.size(); ++i) {
+		threads[i].join();
+	}
+
+	// several attempts may have been accepted by the threads that were already running
+	size_t number_of_started_attempts = std::min(next_attempt.load(), attempts.size());
+	int best_result_index = -1;
+	for (size_t i = 0; i < number_of_started_attempts; ++i) {
+		if (!results[i].registration_successful) { continue; }
+		if (best_result_index < 0 ||
+				(results[i].accepted && !results[best_result_index].accepted) ||
+				(results[i].accepted == results[best_result_index].accepted && results[i].outliers_percentage < results[best_result_index].outliers_percentage)) {
+			best_result_index = (int)i;
+		}
+	}
+
+	if (best_result_index >= 0) {
+		result_out = results[best_result_index];
+	}
+
+	ROS_DEBUG_STREAM("TrackingRecoveryPortfolio ran " << number_of_started_attempts << " of " << attempts.size() << " attempts (" << initial_guesses_corrections.size() << " initial guesses and "
+			<< strategies_.size() << " strategies) using " << number_of_threads << " threads in " << performance_timer.getElapsedTimeFormated()
+			<< (best_result_index >= 0 ? " | best attempt: [" + result_out.strategy_name + "] with initial guess " + std::to_string(result_out.initial_guess_index) + (result_out.accepted ? " (accepted)" : " (not accepted)") : std::string(" | all attempts failed")));
+	return result_out.accepted;
+}
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </TrackingRecoveryPortfolio-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// =============================================================================  </public-section>  ===========================================================================
+
+// =============================================================================   <protected-section>   =======================================================================
+template<typename PointT>
+bool TrackingRecoveryPortfolio<PointT>::isFarFromInitialGuesses(const tf2::Transform& pose_correction, const std::vector<tf2::Transform>& initial_guesses_corrections) const {
+	for (size_t i = 0; i < initial_guesses_corrections.size(); ++i) {
+		if ((pose_correction.getOrigin() - initial_guesses_corrections[i].getOrigin()).length() < minimum_translation_between_initial_guesses_ &&
+				std::abs(pose_correction.getRotation().normalize().angleShortestPath(initial_guesses_corrections[i].getRotation().normalize())) < minimum_rotation_between_initial_guesses_) {
+			return false;
+		}
+	}
+	return true;
+}
+
+
+template<typename PointT>
+void TrackingRecoveryPortfolio<PointT>::runAttempt(const Attempt& attempt, const typename pcl::PointCloud<PointT>::Ptr& ambient_pointcloud, const typename pcl::PointCloud<PointT>::Ptr& ambient_pointcloud_keypoints,
+		const typename pcl::search::KdTree<PointT>::Ptr& reference_pointcloud_search_method, AttemptResult& result) {
+	PerformanceTimer performance_timer;
+	performance_timer.start();
+	result.strategy_name = attempt.strategy->name;
+	result.initial_guess_index = attempt.initial_guess_index;
+
+	// the ambient point cloud is shared (registerCloud does not change it), but the keypoints are transformed in place by the matchers
+	typename pcl::PointCloud<PointT>::Ptr pointcloud = ambient_pointcloud;
+	typename pcl::PointCloud<PointT>::Ptr keypoints(new pcl::PointCloud<PointT>());
+	if (attempt.initial_guess_index == 0) {
+		if (ambient_pointcloud_keypoints) { *keypoints = *ambient_pointcloud_keypoints; }
+	} else {
+		Eigen::Transform<float, 3, Eigen::Affine> initial_guess_correction = laserscan_to_pointcloud::tf_rosmsg_eigen_conversions::transformTF2ToTransform<float>(attempt.initial_guess_correction);
+		pointcloud.reset(new pcl::PointCloud<PointT>());
+		pcl::transformPointCloudWithNormals(*ambient_pointcloud, *pointcloud, initial_guess_correction);
+		if (ambient_pointcloud_keypoints) { pcl::transformPointCloudWithNormals(*ambient_pointcloud_keypoints, *keypoints, initial_guess_correction); }
+	}
+
+	typename pcl::search::KdTree<PointT>::Ptr search_method(new pcl::search::KdTree<PointT>());
+	search_method->setInputCloud(pointcloud);
+
+	tf2::Transform pose_correction = attempt.initial_guess_correction;
+	const std::vector< typename CloudMatcher<PointT>::Ptr >& matchers = attempt.strategy->matchers_per_initial_guess[attempt.initial_guess_index];
+	bool registration_successful = false;
+	for (size_t i = 0; i < matchers.size(); ++i) {
+		typename pcl::PointCloud<PointT>::Ptr pointcloud_aligned(new pcl::PointCloud<PointT>());
+		tf2::Transform matcher_pose_correction;
+		size_t number_of_accepted_pose_corrections = result.accepted_pose_corrections.size();
+		if (matchers[i]->registerCloud(pointcloud, search_method, keypoints, matcher_pose_correction, result.accepted_pose_corrections, pointcloud_aligned, false)) {
+			pose_correction = matcher_pose_correction * pose_correction;
+			registration_successful = true;
+			pointcloud = pointcloud_aligned;
+			search_method->setInputCloud(pointcloud);
+		} else {
+			registration_successful = false;
+		}
+
+		for (size_t j = number_of_accepted_pose_corrections; j < result.accepted_pose_corrections.size(); ++j) {
+			result.accepted_pose_corrections[j] = result.accepted_pose_corrections[j] * attempt.initial_guess_correction;
+		}
+
+		int number_registration_iterations = matchers[i]->getNumberOfRegistrationIterations();
+		if (number_registration_iterations > 0) result.number_of_registration_iterations += number_registration_iterations;
+
+		double correspondence_estimation_time = matchers[i]->getCorrespondenceEstimationElapsedTimeMS();
+		if (correspondence_estimation_time > 0) result.correspondence_estimation_time += correspondence_estimation_time;
+
+		double transformation_estimation_time = matchers[i]->getTransformationEstimationElapsedTimeMS();
+		if (transformation_estimation_time > 0) result.transformation_estimation_time += transformation_estimation_time;
+
+		double transform_cloud_time = matchers[i]->getTransformCloudElapsedTimeMS();
+		if (transform_cloud_time > 0) result.transform_cloud_time += transform_cloud_time;
+
+		double cloud_align_time = matchers[i]->getCloudAlignTimeMS();
+		if (cloud_align_time > 0) result.cloud_align_time += cloud_align_time;
+
+		result.last_matcher_convergence_state = matchers[i]->getMatcherConvergenceState();
+		result.root_mean_square_error_of_last_registration_correspondences = matchers[i]->getRootMeanSquareErrorOfRegistrationCorrespondences();
+		result.number_correspondences_last_registration_algorithm = matchers[i]->getNumberCorrespondencesInLastRegistrationIteration();
+	}
+
+	result.registration_successful = registration_successful;
+	if (registration_successful) {
+		result.pose_correction = pose_correction;
+		result.registered_pointcloud = pointcloud;
+		result.registered_pointcloud_keypoints = keypoints;
+		result.registered_pointcloud_search_method = search_method;
+		computeInliersStatistics(reference_pointcloud_search_method, result);
+	}
+
+	result.elapsed_time_ms = performance_timer.getElapsedTimeInMilliSec();
+}
+
+
+template<typename PointT>
+void TrackingRecoveryPortfolio<PointT>::computeInliersStatistics(const typename pcl::search::KdTree<PointT>::Ptr& reference_pointcloud_search_method, AttemptResult& result) {
+	result.root_mean_square_error_inliers = -1.0;
+	result.outliers_percentage = 1.0;
+	if (!reference_pointcloud_search_method || !result.registered_pointcloud || result.registered_pointcloud->empty()) { return; }
+
+	double max_inliers_squared_distance = max_inliers_distance_ * max_inliers_distance_;
+	double inliers_squared_distances_sum = 0.0;
+	size_t number_of_inliers = 0;
+	std::vector<int> k_indices(1);
+	std::vector<float> k_squared_distances(1);
+	for (size_t i = 0; i < result.registered_pointcloud->size(); ++i) {
+		if (reference_pointcloud_search_method->nearestKSearch((*result.registered_pointcloud)[i], 1, k_indices, k_squared_distances) > 0 && k_squared_distances[0] <= max_inliers_squared_distance) {
+			inliers_squared_distances_sum += k_squared_distances[0];
+			++number_of_inliers;
+		}
+	}
+
+	if (number_of_inliers > 0) {
+		result.root_mean_square_error_inliers = std::sqrt(inliers_squared_distances_sum / (double)number_of_inliers);
+	}
+	result.outliers_percentage = 1.0 - (double)number_of_inliers / (double)result.registered_pointcloud->size();
+}
+// =============================================================================   </protected-section>  =======================================================================
+
+} /* namespace dynamic_robot_localization */
@@ -10,11 +10,16 @@
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>  <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 // std includes
 #include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <functional>
 #include <limits>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <string>
+#include <thread>
 #include <vector>
 #include <utility>
 
@@ -58,6 +63,7 @@
 #include <laserscan_to_pointcloud/tf_rosmsg_eigen_conversions.h>
 
 #include <dynamic_robot_localization/cloud_filters/cloud_filter.h>
+#include <dynamic_robot_localization/cloud_filters/cloud_filter_chain.h>
 #include <dynamic_robot_localization/cloud_filters/voxel_grid.h>
 #include <dynamic_robot_localization/cloud_filters/approximate_voxel_grid.h>
 #include <dynamic_robot_localization/cloud_filters/pass_through.h>
@@ -97,6 +103,7 @@
 #include <dynamic_robot_localization/cloud_matchers/point_matchers/iterative_closest_point_non_linear.h>
 #include <dynamic_robot_localization/cloud_matchers/point_matchers/iterative_closest_point_with_normals.h>
 #include <dynamic_robot_localization/cloud_matchers/point_matchers/iterative_closest_point_generalized.h>
+#include <dynamic_robot_localization/cloud_matchers/point_matchers/multi_resolution_registration.h>
 #include <dynamic_robot_localization/cloud_matchers/point_matchers/normal_distributions_transform_2d.h>
 #include <dynamic_robot_localization/cloud_matchers/point_matchers/normal_distributions_transform_3d.h>
 #include <dynamic_robot_localization/cloud_matchers/point_matchers/principal_component_analysis.h>
@@ -118,14 +125,30 @@
 #include <dynamic_robot_localization/registration_covariance_estimators/registration_covariance_point_to_point_pm_3d.h>
 #include <dynamic_robot_localization/registration_covariance_estimators/registration_covariance_point_to_plane_pm_3d.h>
 
+#include <dynamic_robot_localization/common/async_cloud_publisher.h>
+#include <dynamic_robot_localization/common/bounded_queue.h>
+#include <dynamic_robot_localization/common/chunked_circular_buffer_pointcloud.h>
 #include <dynamic_robot_localization/common/circular_buffer_pointcloud.h>
+#include <dynamic_robot_localization/common/configuration_fingerprints.h>
+#include <dynamic_robot_localization/common/memory_usage.h>
+#include <dynamic_robot_localization/common/multi_sensor_synchronizer.h>
 #include <dynamic_robot_localization/common/performance_timer.h>
+#include <dynamic_robot_localization/common/tracer.h>
+#include <dynamic_robot_localization/common/pointcloud2_ingestion.h>
+#include <dynamic_robot_localization/common/reference_map_bundle.h>
+#include <dynamic_robot_localization/common/reference_map_publisher.h>
+#include <dynamic_robot_localization/common/tiled_reference_map.h>
+#include <dynamic_robot_localization/common/voxel_hash_search.h>
+
+#include <dynamic_robot_localization/localization/tracking_recovery_portfolio.h>
 
 // project msgs
 #include <dynamic_robot_localization/LocalizationDetailed.h>
 #include <dynamic_robot_localization/LocalizationDiagnostics.h>
 #include <dynamic_robot_localization/LocalizationTimes.h>
+#include <dynamic_robot_localization/LocalizationTracing.h>
 #include <dynamic_robot_localization/LocalizationConfiguration.h>
+#include <dynamic_robot_localization/PublishReferencePointCloud.h>
 #include <dynamic_robot_localization/ReloadLocalizationConfiguration.h>
 #include <dynamic_robot_localization/StartProcessingSensorData.h>
 #include <dynamic_robot_localization/StopProcessingSensorData.h>
@@ -143,6 +166,7 @@ class Localization : public ConfigurableObject {
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <usings>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 		using Ptr = std::shared_ptr< Localization<PointT> >;
 		using ConstPtr = std::shared_ptr< const Localization<PointT> >;
+		using PointCloud2Synchronizer = MultiSensorSynchronizer< sensor_msgs::PointCloud2ConstPtr >;
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </usings>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <enums>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
@@ -218,7 +242,32 @@ class Localization : public ConfigurableObject {
 		virtual bool reloadConfigurationFromParameterServerServiceCallback(dynamic_robot_localization::ReloadLocalizationConfiguration::Request& request, dynamic_robot_localization::ReloadLocalizationConfiguration::Response& response);
 		virtual bool startProcessingSensorDataServiceCallback(dynamic_robot_localization::StartProcessingSensorData::Request& request, dynamic_robot_localization::StartProcessingSensorData::Response& response);
 		virtual bool stopProcessingSensorDataServiceCallback(dynamic_robot_localization::StopProcessingSensorData::Request& request, dynamic_robot_localization::StopProcessingSensorData::Response& response);
+		/*! Publishes a full snapshot of the reference point cloud (and keypoints), ignoring the throttling of the reference_pointcloud_publisher. */
+		virtual bool publishReferencePointCloudServiceCallback(dynamic_robot_localization::PublishReferencePointCloud::Request& request, dynamic_robot_localization::PublishReferencePointCloud::Response& response);
 		virtual bool reloadConfigurationFromParameterServer(const dynamic_robot_localization::LocalizationConfiguration& localization_configuration);
+		/*! Reloads the requested modules whose fingerprint changed and rebuilds only the reference data that depends on them.
+		 * The modules and reference data are built in a separate instance without the sensor_data_ingestion_mutex_ and localization_mutex_, which are locked by this function only for swapping them with the active ones. */
+		virtual bool reloadConfigurationFromParameterServer(const dynamic_robot_localization::LocalizationConfiguration& localization_configuration, const ConfigurationFingerprints::FingerprintsMap& configuration_fingerprints);
+		/*! Pairs of module name and configuration namespace, in the order in which the modules must be setup. */
+		static void s_getConfigurationModulesNamespaces(const dynamic_robot_localization::LocalizationConfiguration& localization_configuration, std::vector< std::pair<std::string, std::string> >& modules_namespaces);
+		/*! Calls the setup function of the module (returns false for unknown modules). */
+		virtual bool setupConfigurationModuleFromParameterServer(const std::string& module_name, const std::string& configuration_namespace);
+		/*! Namespace of the reloaded module or, if it was not reloaded, the namespace from which it was last loaded. */
+		std::string getConfigurationModuleNamespace(const std::string& module_name, const std::map<std::string, std::string>& reloaded_modules_namespaces);
+		/*! Swaps the members that are setup by the modules with the ones of the reload instance (must be called with the sensor_data_ingestion_mutex_ and localization_mutex_ locked). */
+		virtual void swapConfigurationModules(Localization<PointT>& reload_instance, const std::set<std::string>& modules_names);
+		/*! Swaps the reference point clouds, their search methods and the tiled reference map with the ones of the reload instance (must be called with the localization_mutex_ locked). */
+		virtual void swapReferencePointCloud(Localization<PointT>& reload_instance);
+		/*! Points the filters to the TF collector of the current pose_to_tf_publisher_ (which is replaced when reloading the message_management). */
+		void updateCloudFiltersTfCollector();
+		/*! Computes the fingerprints of the requested modules (only reads the parameter server, which allows to call it without locking the localization_mutex_). */
+		virtual void computeConfigurationFingerprints(const dynamic_robot_localization::LocalizationConfiguration& localization_configuration, ConfigurationFingerprints::FingerprintsMap& configuration_fingerprints);
+		virtual void computeConfigurationFingerprint(const std::string& module_name, const std::string& configuration_namespace, const std::vector<std::string>& parameters_namespaces,
+				std::map<std::string, XmlRpc::XmlRpcValue>& configurations, ConfigurationFingerprints::FingerprintsMap& configuration_fingerprints);
+		/*! @return true if the module was requested and its fingerprint changed (or reload_unchanged_modules is true), without updating the stored fingerprint */
+		virtual bool checkIfConfigurationMustBeReloaded(const std::string& module_name, const std::string& configuration_namespace, const ConfigurationFingerprints::FingerprintsMap& configuration_fingerprints,
+				bool reload_unchanged_modules, std::string& configuration_namespace_parsed_out);
+		static void s_setLocalizationConfigurationNamespaces(dynamic_robot_localization::LocalizationConfiguration& localization_configuration, const std::string& configuration_namespace);
 		virtual void setupGeneralConfigurationsFromParameterServer(const std::string& configuration_namespace);
 		virtual void setupSubscribeTopicNamesFromParameterServer(const std::string &configuration_namespace);
 		virtual void setupServiceServersNamesFromParameterServer(const std::string &configuration_namespace);
@@ -227,6 +276,8 @@ class Localization : public ConfigurableObject {
 		virtual void setupInitialPoseFromParameterServer(bool update_last_accepted_pose_time = false);
 		virtual void setupInitialPoseFromParameterServer(const std::string& configuration_namespace, const ros::Time& time, bool use_latest_tf_time = false, bool update_last_accepted_pose_time = false);
 		virtual void setupTFPublisherFromParameterServer(const std::string& configuration_namespace);
+		virtual void setupTracingFromParameterServer(const std::string& configuration_namespace);
+		virtual void setupMemoryManagementFromParameterServer(const std::string& configuration_namespace);
 		virtual void setupMessageManagementFromParameterServer(const std::string& configuration_namespace);
 		virtual void setupReferencePointCloudFromParameterServer(const std::string& configuration_namespace);
 
@@ -252,6 +303,7 @@ class Localization : public ConfigurableObject {
 		virtual void setupInitialPoseEstimatorsPointMatchersFromParameterServer(const std::string& configuration_namespace);
 		virtual void setupTrackingMatchersFromParameterServer(const std::string& configuration_namespace);
 		virtual void setupTrackingRecoveryMatchersFromParameterServer(const std::string& configuration_namespace);
+		virtual void setupTrackingRecoveryPortfolioFromParameterServer(const std::string& configuration_namespace);
 		virtual void setupCloudMatchersFromParameterServer(std::vector< typename CloudMatcher<PointT>::Ptr >& pointcloud_matchers, const std::string& configuration_namespace);
 		static void s_setupCloudMatchersFromParameterServer(std::vector< typename CloudMatcher<PointT>::Ptr >& pointcloud_matchers, const std::string& configuration_namespace,
 															ros::NodeHandlePtr& node_handle, ros::NodeHandlePtr& private_node_handle);
@@ -291,9 +343,34 @@ class Localization : public ConfigurableObject {
 		virtual bool loadReferencePointCloudFromFile(const std::string& reference_pointcloud_filename, const std::string& reference_pointclouds_database_folder_path = std::string(""));
 		virtual void loadReferencePointCloudFromROSPointCloud(const sensor_msgs::PointCloud2ConstPtr& reference_pointcloud_msg);
 		virtual void loadReferencePointCloudFromROSOccupancyGrid(const nav_msgs::OccupancyGridConstPtr& occupancy_grid_msg);
+		/*! Marks the reference point cloud as changed (if update_msg is true) and publishes the pending changes allowed by the throttling of the reference_pointcloud_publisher. */
 		virtual void publishReferencePointCloud(const ros::Time& time_stamp, bool update_msg = true);
-		virtual bool updateLocalizationPipelineWithNewReferenceCloud(const ros::Time& time_stamp);
-		virtual void updateMatchersReferenceCloud();
+		virtual bool updateLocalizationPipelineWithNewReferenceCloud(const ros::Time& time_stamp, bool reference_pointcloud_preprocessed = false);
+		/*! Hash of the parameters that change the preprocessing of the reference point cloud, read from the given (parsed) configuration namespaces of each module. */
+		virtual std::uint64_t computeReferencePointCloudConfigurationHash(const std::string& reference_pointcloud_configuration_namespace, const std::string& filters_configuration_namespace,
+				const std::string& normal_estimators_configuration_namespace, const std::string& curvature_estimators_configuration_namespace, const std::string& keypoint_detectors_configuration_namespace);
+		/*! Swaps in the local map prepared by the tiles loading thread and requests the missing tiles around the given position
+		 * (if wait_for_tiles is true, the tiles are loaded and the matchers are updated in the calling thread). */
+		virtual bool updateReferencePointCloudTiles(double x, double y, const ros::Time& time_stamp, bool wait_for_tiles = false);
+		/*! Replaces the reference point cloud, keypoints and search method with the ones of the local map
+		 * (if local_map_prepared is true, the matchers start using the structures built for it in the tiles loading thread). */
+		virtual bool swapReferencePointCloudTilesLocalMap(const typename TiledReferenceMap<PointT>::LocalMap& local_map, const ros::Time& time_stamp, bool local_map_prepared);
+		virtual void updateMatchersReferenceCloud(bool update_initial_pose_estimators_feature_matchers = true, bool update_initial_pose_estimators_point_matchers = true,
+				bool update_tracking_matchers = true, bool update_tracking_recovery_matchers = true);
+		/*! Updates the structures shared by the matchers (correspondences lookup tables, covariances caches and voxel maps) only with the points appended to the reference point cloud
+		 * (falling back to their full update when they are not in sync with it) and defers the setup of the initial pose feature matchers until they are needed. */
+		virtual void updateMatchersReferenceCloudWithInsertedPoints(const std::vector<int>& inserted_points_indices);
+		/*! Collects the (shared) correspondences lookup tables, covariances caches and voxel maps of the point matchers. */
+		virtual void collectMatchersReferenceCloudStructures(std::vector< typename CorrespondencesLookupTableGrid<PointT>::Ptr >& correspondences_lookup_table_grids,
+				std::vector< typename GeneralizedCovariancesCache<PointT>::Ptr >& covariances_caches, std::vector< typename NormalDistributionsTransformVoxelMap<PointT>::Ptr >& voxel_maps);
+		/*! Gives the reference point cloud used for outlier detection to the outlier_detectors_ (to allow them to precompute data from the reference side). */
+		virtual void updateOutlierDetectorsReferenceCloud();
+		/*! Matchers whose correspondences lookup table grid has the same configuration as one in correspondences_lookup_table_grids use that grid (the others are added to it). */
+		static void s_shareCorrespondencesLookupTableGrids(std::vector< typename CloudMatcher<PointT>::Ptr >& matchers, std::vector< typename CorrespondencesLookupTableGrid<PointT>::Ptr >& correspondences_lookup_table_grids);
+		/*! Generalized ICP matchers whose covariances cache has the same configuration as one in covariances_caches use that cache (the others are added to it). */
+		static void s_shareGeneralizedCovariancesCaches(std::vector< typename CloudMatcher<PointT>::Ptr >& matchers, std::vector< typename GeneralizedCovariancesCache<PointT>::Ptr >& covariances_caches);
+		/*! Normal distributions transform matchers whose voxel map has the same configuration as one in voxel_maps use that voxel map (the others are added to it). */
+		static void s_shareNormalDistributionsTransformVoxelMaps(std::vector< typename CloudMatcher<PointT>::Ptr >& matchers, std::vector< typename NormalDistributionsTransformVoxelMap<PointT>::Ptr >& voxel_maps);
 
 		virtual bool setInitialPose(const geometry_msgs::Pose& pose, const std::string& frame_id, const ros::Time& pose_time);
 		virtual void setInitialPoseFromPose(const geometry_msgs::Pose& pose);
@@ -310,17 +387,46 @@ class Localization : public ConfigurableObject {
 		virtual void stopProcessingSensorData();
 		virtual void restartProcessingSensorData();
 		virtual void resetNumberOfProcessedPointclouds();
+		virtual void startProcessingPipeline();
+		virtual void stopProcessingPipeline();
+		virtual void clearProcessingPipelineQueues();
+		virtual void processingPipelineIngestWorker();
+		virtual void processingPipelineRegistrationWorker();
+		virtual void startMultiSensorSynchronization();
+		virtual void stopMultiSensorSynchronization();
+		virtual void multiSensorSynchronizationWorker();
+		/*! Ingests the point clouds of the set and concatenates them in the merge frame (a set with a single point cloud is kept in its sensor frame). The sensor_data_ingestion_mutex_ must be locked by the caller. */
+		virtual typename pcl::PointCloud<PointT>::Ptr mergeSynchronizedPointClouds(const PointCloud2Synchronizer::SynchronizedSet& synchronized_set);
+		virtual void updateMultiSensorSynchronizationDiagnostics();
 
 		virtual bool transformCloudToTFFrame(typename pcl::PointCloud<PointT>::Ptr& ambient_pointcloud, const ros::Time& timestamp, const std::string& target_frame_id);
 		virtual bool checkIfAmbientPointCloudShouldBeProcessed(const ros::Time& ambient_cloud_time, size_t number_of_points, bool check_if_pointcloud_subscribers_are_active = true, bool use_ros_console = true);
 		virtual bool checkIfTrackingIsLost();
 		virtual void processAmbientPointCloud(const sensor_msgs::PointCloud2ConstPtr& ambient_cloud_msg);
-		virtual bool processAmbientPointCloud(typename pcl::PointCloud<PointT>::Ptr& ambient_pointcloud, bool check_if_pointcloud_should_be_processed = true, bool check_if_pointcloud_subscribers_are_active = true);
+		virtual void processAmbientPointCloudFromSensor(const sensor_msgs::PointCloud2ConstPtr& ambient_cloud_msg, size_t sensor_index);
+		/*! override_pointcloud_timestamp must be false for the point clouds whose timestamp was already overridden when they were ingested by the processing pipeline or synchronized. */
+		virtual bool processAmbientPointCloud(typename pcl::PointCloud<PointT>::Ptr& ambient_pointcloud, bool check_if_pointcloud_should_be_processed = true, bool check_if_pointcloud_subscribers_are_active = true, bool override_pointcloud_timestamp = true);
 		virtual void resetPointCloudHeight(pcl::PointCloud<PointT>& pointcloud, float height = 0.0f);
-
-
-		virtual bool applyCloudFilters(std::vector< typename CloudFilter<PointT>::Ptr >& cloud_filters, typename pcl::PointCloud<PointT>::Ptr& pointcloud);
+		/*! Publishes the statistics of the tracer spans (throttled) and saves the spans of the processing if it took longer than the configured threshold. */
+		virtual void publishLocalizationTracing(const ros::Time& time_stamp, std::uint64_t processing_start_time_ns, double processing_time_ms);
+		/*! Point matchers of the initial pose estimation, tracking and tracking recovery (including the ones of the tracking recovery portfolio strategies). */
+		virtual void collectPointMatchers(std::vector< typename CloudMatcher<PointT>::Ptr >& matchers);
+		/*! Fills the memory fields of the diagnostics msg, accounting only once the objects shared between modules. @return estimated bytes of all modules */
+		virtual size_t updateMemoryUsageDiagnostics();
+		/*! Accounts the memory (throttled by the check period) and evicts caches, shrinks the circular buffer and / or downsamples the reference point cloud when the budgets are exceeded. */
+		virtual void enforceMemoryBudgets(const ros::Time& time_stamp);
+		/*! @return estimated number of released bytes */
+		virtual size_t clearMemoryCaches();
+		/*! @return estimated number of released bytes */
+		virtual size_t shrinkCircularBuffer(size_t number_of_bytes_to_release);
+		virtual bool downsampleReferencePointCloud(const ros::Time& time_stamp);
+
+
+		virtual bool applyCloudFilters(std::vector< typename CloudFilter<PointT>::Ptr >& cloud_filters, typename pcl::PointCloud<PointT>::Ptr& pointcloud,
+				const typename pcl::search::KdTree<PointT>::Ptr& pointcloud_search_method = typename pcl::search::KdTree<PointT>::Ptr());
 		static bool s_applyCloudFilters(std::vector< typename CloudFilter<PointT>::Ptr >& cloud_filters, typename pcl::PointCloud<PointT>::Ptr& pointcloud, int minimum_number_of_points_in_ambient_pointcloud);
+		static bool s_applyCloudFilters(std::vector< typename CloudFilter<PointT>::Ptr >& cloud_filters, typename pcl::PointCloud<PointT>::Ptr& pointcloud, int minimum_number_of_points_in_ambient_pointcloud, CloudFilterChain<PointT>& cloud_filter_chain,
+				const typename pcl::search::KdTree<PointT>::Ptr& pointcloud_search_method = typename pcl::search::KdTree<PointT>::Ptr());
 
 		virtual bool applyNormalEstimator(typename NormalEstimator<PointT>::Ptr& normal_estimator, typename CurvatureEstimator<PointT>::Ptr& curvature_estimator,
 										  typename pcl::PointCloud<PointT>::Ptr& pointcloud,
@@ -350,6 +456,13 @@ class Localization : public ConfigurableObject {
 										 int minimum_number_of_points_in_ambient_pointcloud, std::vector< tf2::Transform >& accepted_pose_corrections, int& number_of_registration_iterations_for_all_matchers,
 										 double& correspondence_estimation_time_for_all_matchers, double& transformation_estimation_time_for_all_matchers, double& transform_cloud_time_for_all_matchers, double& cloud_align_time_for_all_matchers,
 										 std::string& last_matcher_convergence_state, double& root_mean_square_error_of_last_registration_correspondences, int& number_correspondences_last_registration_algorithm);
+		/*! Uses the tracking recovery portfolio if it was configured or the tracking recovery matchers otherwise. */
+		virtual bool applyTrackingRecovery(typename pcl::PointCloud<PointT>::Ptr& ambient_pointcloud,
+										   typename pcl::search::KdTree<PointT>::Ptr& surface_search_method,
+										   typename pcl::PointCloud<PointT>::Ptr& pointcloud_keypoints,
+										   const tf2::Transform& pointcloud_pose_initial_guess, tf2::Transform& pose_corrections_in_out);
+		virtual bool validateTrackingRecoveryAttempt(const typename TrackingRecoveryPortfolio<PointT>::AttemptResult& attempt_result,
+													 const tf2::Transform& pointcloud_pose_initial_guess, const tf2::Transform& pose_corrections);
 
 		virtual bool applyTransformationAligner(const tf2::Transform& pointcloud_pose_initial_guess, const tf2::Transform& pointcloud_pose_corrected, tf2::Transform& new_pose_corrections_out, const ros::Time& pointcloud_time);
 		static bool s_applyTransformationAligner(const tf2::Transform& pointcloud_pose_initial_guess, const tf2::Transform& pointcloud_pose_corrected, tf2::Transform& new_pose_corrections_out, const ros::Time& pointcloud_time,
@@ -398,6 +511,7 @@ class Localization : public ConfigurableObject {
 		SensorDataProcessingStatus getSensorDataProcessingStatus() { return sensor_data_processing_status_; }
 		const std::vector< tf2::Transform >& getAcceptedPoseCorrections() { return accepted_pose_corrections_; }
 		const tf2::Transform& getAcceptedEstimatedPose() { return pose_tf2_transform_corrected_; }
+		const tf2::Transform& getLastAcceptedPoseBaseLinkToMap() { return last_accepted_pose_base_link_to_map_; }
 		const MapUpdateMode& getMapUpdateMode() { return map_update_mode_; }
 		bool ambientPointcloudIntegrationActive() { return !ambient_pointcloud_integration_filters_.empty() || !ambient_pointcloud_integration_filters_map_frame_.empty(); }
 		bool cloudMatchersActive() { return !initial_pose_estimators_feature_matchers_.empty() || !initial_pose_estimators_point_matchers_.empty() || !tracking_matchers_.empty() || !tracking_recovery_matchers_.empty(); }
@@ -410,6 +524,10 @@ class Localization : public ConfigurableObject {
 		std::string getSensorFrameId() { return sensor_frame_id_; }
 		int getLimitOfPointcloudsToProcess() { return limit_of_pointclouds_to_process_; }
 		size_t getNumberOfProcessedPointclouds() { return number_of_processed_pointclouds_; }
+		/*! Times of the last processed point cloud (including the accumulated times of all the matchers) */
+		LocalizationTimes getLocalizationTimes() const;
+		std::string getReferencePointCloudBundleFilename() const { return reference_pointcloud_bundle_filename_; }
+		double getTiledMapTileSize() const { return tiled_map_tile_size_; }
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </gets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <sets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
@@ -418,6 +536,12 @@ class Localization : public ConfigurableObject {
 		void setFilteredPointcloudSaveFilename(const std::string& filtered_pointcloud_save_filename) { filtered_pointcloud_save_filename_ = filtered_pointcloud_save_filename; }
 		void setFilteredPointcloudSaveFrameId(const std::string& filtered_pointcloud_save_frame_id) { filtered_pointcloud_save_frame_id_ = filtered_pointcloud_save_frame_id; }
 		void setLimitOfPointcloudsToProcess(int limit_of_pointclouds_to_process) { limit_of_pointclouds_to_process_ = limit_of_pointclouds_to_process; }
+		void setReferencePointCloudBundleFilename(const std::string& filename) { reference_pointcloud_bundle_filename_ = filename; }
+		void setReferencePointCloudBundleSave(bool save) { reference_pointcloud_bundle_save_ = save; }
+		/*! Allows to split the preprocessed reference map in tiles when they are missing or outdated (only done by the offline tools, the localization node uses the full reference map instead). */
+		void setReferencePointCloudTilesBuild(bool build) { reference_pointcloud_tiles_build_ = build; }
+		void setLastAcceptedPoseBaseLinkToMap(const tf2::Transform& pose) { last_accepted_pose_base_link_to_map_ = pose; }
+		void resetLocalizationTimes() { localization_times_msg_ = LocalizationTimes(); }
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </sets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 	// ========================================================================   </public-section>  ===========================================================================
 
@@ -437,6 +561,7 @@ class Localization : public ConfigurableObject {
 		std::string reload_localization_configuration_service_server_name_;
 		std::string start_processing_sensor_data_service_server_name_;
 		std::string stop_processing_sensor_data_service_server_name_;
+		std::string publish_reference_pointcloud_service_server_name_;
 
 		// publish topic names
 		std::string reference_pointcloud_publish_topic_;
@@ -456,12 +581,19 @@ class Localization : public ConfigurableObject {
 		std::string localization_detailed_publish_topic_;
 		std::string localization_diagnostics_publish_topic_;
 		std::string localization_times_publish_topic_;
+		std::string localization_tracing_publish_topic_;
 
 
 		// configuration fields
 		std::string reference_pointclouds_database_folder_path_;
 		std::string reference_pointcloud_filename_;
 		std::string reference_pointcloud_preprocessed_save_filename_;
+		std::string reference_pointcloud_bundle_filename_;
+		bool reference_pointcloud_bundle_save_;
+		double tiled_map_tile_size_;
+		double tiled_map_active_tiles_radius_;
+		std::string tiled_map_tiles_folder_path_;
+		bool reference_pointcloud_tiles_build_;
 		std::string reference_pointcloud_keypoints_filename_;
 		std::string reference_pointcloud_keypoints_save_filename_;
 		std::string ambient_pointcloud_integration_filters_preprocessed_pointcloud_save_filename_;
@@ -567,14 +699,15 @@ class Localization : public ConfigurableObject {
 		ros::ServiceServer reload_localization_configuration_service_server_;
 		ros::ServiceServer start_processing_sensor_data_service_server_;
 		ros::ServiceServer stop_processing_sensor_data_service_server_;
+		ros::ServiceServer publish_reference_pointcloud_service_server_;
 		std::vector< ros::Subscriber > ambient_pointcloud_subscribers_;
 		bool ambient_pointcloud_subscribers_active_;
 		int limit_of_pointclouds_to_process_;
 		size_t number_of_processed_pointclouds_;
 		ros::Subscriber costmap_subscriber_;
 		ros::Subscriber reference_pointcloud_subscriber_;
-		ros::Publisher reference_pointcloud_publisher_;
-		ros::Publisher reference_pointcloud_keypoints_publisher_;
+		typename ReferenceMapPublisher<PointT>::Ptr reference_pointcloud_publisher_;
+		typename ReferenceMapPublisher<PointT>::Ptr reference_pointcloud_keypoints_publisher_;
 		ros::Publisher filtered_pointcloud_publisher_;
 		ros::Publisher aligned_pointcloud_publisher_;
 		ros::Publisher aligned_pointcloud_global_outliers_publisher_;
@@ -590,20 +723,25 @@ class Localization : public ConfigurableObject {
 		ros::Publisher localization_detailed_publisher_;
 		ros::Publisher localization_diagnostics_publisher_;
 		ros::Publisher localization_times_publisher_;
+		ros::Publisher localization_tracing_publisher_;
 
 		// localization fields
 		typename pcl::PointCloud<PointT>::Ptr reference_pointcloud_;
 		typename pcl::PointCloud<PointT>::Ptr reference_pointcloud_for_outlier_detection_;
-		sensor_msgs::PointCloud2Ptr reference_pointcloud_msg_;
 		typename pcl::PointCloud<PointT>::Ptr reference_pointcloud_keypoints_;
-		sensor_msgs::PointCloud2Ptr reference_pointcloud_keypoints_msg_;
-		typename CircularBufferPointCloud<PointT>::Ptr ambient_pointcloud_with_circular_buffer_;
+		typename VoxelHashSearch<PointT>::Ptr reference_pointcloud_keypoints_voxel_hash_search_; // caps the keypoints integrated by the incremental map update
+		bool initial_pose_estimators_feature_matchers_reference_pointcloud_outdated_;
+		typename ChunkedCircularBufferPointCloud<PointT>::Ptr ambient_pointcloud_with_circular_buffer_;
 		bool circular_buffer_require_reception_of_pointcloud_msgs_from_all_topics_before_doing_registration_;
 		bool circular_buffer_clear_inserted_points_if_registration_fails_;
 		int minimum_number_points_ambient_pointcloud_circular_buffer_;
 		size_t last_number_points_inserted_in_circular_buffer_;
 		std::set<std::string> msg_frame_ids_with_data_in_circular_buffer_;
 		typename pcl::search::KdTree<PointT>::Ptr reference_pointcloud_search_method_;
+		typename TiledReferenceMap<PointT>::Ptr tiled_reference_map_;
+		std::vector< typename CorrespondencesLookupTableGrid<PointT>::Ptr > tiled_reference_map_correspondences_lookup_table_grids_; // being built for the local map requested to the tiles loading thread
+		std::vector< typename GeneralizedCovariancesCache<PointT>::Ptr > tiled_reference_map_covariances_caches_;
+		std::vector< typename NormalDistributionsTransformVoxelMap<PointT>::Ptr > tiled_reference_map_voxel_maps_;
 		typename pcl::search::KdTree<PointT>::Ptr reference_pointcloud_search_method_for_outlier_detection_;
 		std::vector< typename CloudFilter<PointT>::Ptr > reference_cloud_filters_;
 		std::vector< typename CloudFilter<PointT>::Ptr > ambient_pointcloud_integration_filters_;
@@ -616,6 +754,7 @@ class Localization : public ConfigurableObject {
 		std::vector< typename CloudFilter<PointT>::Ptr > ambient_pointcloud_feature_registration_filters_;
 		std::vector< typename CloudFilter<PointT>::Ptr > ambient_pointcloud_map_frame_feature_registration_filters_;
 		std::vector< typename CloudFilter<PointT>::Ptr > ambient_pointcloud_filters_after_normal_estimation_;
+		CloudFilterChain<PointT> cloud_filter_chain_; // all the filters are applied while holding localization_mutex_
 		typename NormalEstimator<PointT>::Ptr reference_cloud_normal_estimator_;
 		typename NormalEstimator<PointT>::Ptr ambient_cloud_normal_estimator_;
 		typename CurvatureEstimator<PointT>::Ptr reference_cloud_curvature_estimator_;
@@ -626,6 +765,7 @@ class Localization : public ConfigurableObject {
 		std::vector< typename CloudMatcher<PointT>::Ptr > initial_pose_estimators_point_matchers_;
 		std::vector< typename CloudMatcher<PointT>::Ptr > tracking_matchers_;
 		std::vector< typename CloudMatcher<PointT>::Ptr > tracking_recovery_matchers_;
+		typename TrackingRecoveryPortfolio<PointT>::Ptr tracking_recovery_portfolio_;
 		int number_of_registration_iterations_for_all_matchers_;
 		double correspondence_estimation_time_for_all_matchers_;
 		double transformation_estimation_time_for_all_matchers_;
@@ -657,9 +797,59 @@ class Localization : public ConfigurableObject {
 		std::vector< typename pcl::PointCloud<PointT>::Ptr > detected_inliers_reference_pointcloud_;
 		LocalizationDiagnostics localization_diagnostics_msg_;
 		LocalizationTimes localization_times_msg_;
+		LocalizationTracing localization_tracing_msg_;
 		bool publish_filtered_pointcloud_only_if_there_is_subscribers_;
 		bool publish_aligned_pointcloud_only_if_there_is_subscribers_;
 		TransformationAligner::Ptr transformation_aligner_;
+
+		// tracing fields
+		double tracing_statistics_time_window_in_seconds_;
+		ros::Duration tracing_statistics_publish_period_;
+		ros::Time tracing_statistics_last_publish_time_;
+		std::string tracing_chrome_trace_filename_;
+		std::string tracing_slow_processing_chrome_trace_filename_;
+		double tracing_slow_processing_time_threshold_ms_;
+
+		// reconfiguration fields
+		ConfigurationFingerprints configuration_fingerprints_;
+		std::string reference_pointcloud_configuration_namespace_;
+		std::string filters_configuration_namespace_;
+		std::string normal_estimators_configuration_namespace_;
+		std::string curvature_estimators_configuration_namespace_;
+		std::string keypoint_detectors_configuration_namespace_;
+		std::map<std::string, std::string> modules_configuration_namespaces_; // namespace from which each module was last loaded
+		bool configuration_reload_instance_; // instance in which a reload is built (it shares the publication thread and the tracer of the active instance)
+
+		// memory management fields (budgets with 0 bytes are disabled)
+		ros::Duration memory_management_check_period_;
+		ros::Time memory_management_last_check_time_;
+		size_t memory_budget_total_bytes_;
+		size_t memory_budget_reference_pointcloud_bytes_;
+		size_t memory_budget_circular_buffer_bytes_;
+		size_t memory_budget_caches_bytes_;
+		double reference_pointcloud_downsampling_leaf_size_;
+		double reference_pointcloud_downsampling_leaf_size_growth_factor_;
+		size_t circular_buffer_minimum_number_of_points_;
+
+		// ambient point cloud ingestion (used by the subscriber callback or by the ingest worker of the processing pipeline, never by both)
+		PointCloud2Ingestion<PointT> ambient_pointcloud_ingestion_;
+
+		// processing pipeline fields
+		bool processing_pipeline_enabled_;
+		BoundedQueue< sensor_msgs::PointCloud2ConstPtr > processing_pipeline_ingest_queue_;
+		BoundedQueue< typename pcl::PointCloud<PointT>::Ptr > processing_pipeline_registration_queue_;
+		std::vector< std::thread > processing_pipeline_threads_; // only changed by the ROS callbacks (or in the destructor), never by the workers
+		std::atomic<bool> processing_pipeline_running_; // read by the subscriber callbacks and workers without the localization mutex
+
+		// multi sensor synchronization fields (the synchronized point clouds replace the ingest queue of the processing pipeline)
+		bool multi_sensor_synchronization_enabled_;
+		int ambient_pointcloud_subscriber_queue_size_;
+		std::string multi_sensor_synchronization_merge_frame_id_;
+		PointCloud2Synchronizer multi_sensor_synchronizer_;
+		std::thread multi_sensor_synchronization_thread_;
+		std::mutex sensor_data_ingestion_mutex_; // held by the workers while ingesting and merging point clouds and by the reload (always locked before the localization_mutex_)
+		std::mutex localization_mutex_;
+		std::mutex configuration_reload_mutex_; // serializes the reloads, allowing them to read the fingerprints and modules namespaces without the other mutexes
 	// ========================================================================   </protected-section>  ========================================================================
 };
 
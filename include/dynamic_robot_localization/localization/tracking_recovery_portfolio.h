@@ -0,0 +1,161 @@
+#pragma once
+
+/**\file tracking_recovery_portfolio.h
+ * \brief Portfolio of pose tracking recovery attempts that run in parallel
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>  <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// std includes
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ROS includes
+#include <ros/ros.h>
+#include <tf2/LinearMath/Transform.h>
+
+// PCL includes
+#include <pcl/common/transforms.h>
+#include <pcl/point_cloud.h>
+#include <pcl/search/kdtree.h>
+
+// external libs includes
+#include <Eigen/Core>
+
+// project includes
+#include <dynamic_robot_localization/cloud_matchers/cloud_matcher.h>
+#include <dynamic_robot_localization/common/performance_timer.h>
+#include <laserscan_to_pointcloud/tf_rosmsg_eigen_conversions.h>
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+namespace dynamic_robot_localization {
+// ######################################################################   TrackingRecoveryPortfolio   #####################################################################
+/**
+ * \brief Runs several pose tracking recovery attempts in parallel over the same preprocessed ambient point cloud (normals and keypoints are computed only once).
+ * Each strategy has a chain of matchers per initial guess (the matchers are not thread safe, so each attempt has its own instances).
+ * The initial guess 0 is the current pose estimate, and the others are the last accepted poses (odom -> map) that are far enough from each other.
+ * An attempt is accepted when its registration succeeds and the validator returns true (the validator is called concurrently by the worker threads).
+ * As soon as one attempt is accepted, the attempts that did not start yet are cancelled (the ones already running finish, since the registration algorithms can not be interrupted).
+ * The reference point cloud search method is shared by all attempts and is only used for queries.
+ */
+template <typename PointT>
+class TrackingRecoveryPortfolio {
+	// ========================================================================   <public-section>   ===========================================================================
+	public:
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <usings>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		using Ptr = std::shared_ptr< TrackingRecoveryPortfolio<PointT> >;
+		using ConstPtr = std::shared_ptr< const TrackingRecoveryPortfolio<PointT> >;
+
+		struct Strategy {
+			std::string name;
+			std::vector< std::vector< typename CloudMatcher<PointT>::Ptr > > matchers_per_initial_guess;
+		};
+
+		struct AttemptResult {
+			std::string strategy_name;
+			size_t initial_guess_index = 0;
+			bool registration_successful = false;
+			bool accepted = false;
+			tf2::Transform pose_correction = tf2::Transform::getIdentity(); // includes the initial guess correction
+			typename pcl::PointCloud<PointT>::Ptr registered_pointcloud;
+			typename pcl::PointCloud<PointT>::Ptr registered_pointcloud_keypoints;
+			typename pcl::search::KdTree<PointT>::Ptr registered_pointcloud_search_method;
+			std::vector< tf2::Transform > accepted_pose_corrections;
+			int number_of_registration_iterations = 0;
+			double correspondence_estimation_time = 0.0;
+			double transformation_estimation_time = 0.0;
+			double transform_cloud_time = 0.0;
+			double cloud_align_time = 0.0;
+			std::string last_matcher_convergence_state;
+			double root_mean_square_error_of_last_registration_correspondences = -1.0;
+			int number_correspondences_last_registration_algorithm = -1;
+			double root_mean_square_error_inliers = -1.0; // computed with max_inliers_distance against the reference point cloud
+			double outliers_percentage = 1.0;
+			double elapsed_time_ms = 0.0;
+		};
+
+		using AttemptValidator = std::function< bool(const AttemptResult&) >;
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </usings>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <constructors-destructor>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		TrackingRecoveryPortfolio();
+		virtual ~TrackingRecoveryPortfolio() {}
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </constructors-destructor>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <TrackingRecoveryPortfolio-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		/*! The matchers of each initial guess are removed from publishing (only the accepted attempt is used by the localization pipeline). */
+		void addStrategy(const std::string& name, const std::vector< std::vector< typename CloudMatcher<PointT>::Ptr > >& matchers_per_initial_guess);
+		void clearStrategies() { strategies_.clear(); }
+
+		/*! Adds the pose to the initial guesses history if it is far enough from the last one added. */
+		void addAcceptedPose(const tf2::Transform& pose_odom_to_map);
+		void clearAcceptedPoses() { accepted_poses_odom_to_map_.clear(); }
+
+		void setupReferenceCloud(typename pcl::PointCloud<PointT>::Ptr& reference_cloud, typename pcl::PointCloud<PointT>::Ptr& reference_cloud_keypoints,
+				typename pcl::search::KdTree<PointT>::Ptr& search_method);
+		bool registrationRequiresNormalsOnAmbientPointCloud();
+
+		/*! Runs the attempts over the ambient point cloud (in map frame, transformed with the current_pose_odom_to_map).
+		 * Returns true if an attempt was accepted (result_out has the accepted attempt), or false otherwise (result_out has the successful registration with lower outliers percentage, if any). */
+		bool recoverTracking(const typename pcl::PointCloud<PointT>::Ptr& ambient_pointcloud, const typename pcl::PointCloud<PointT>::Ptr& ambient_pointcloud_keypoints,
+				const tf2::Transform& current_pose_odom_to_map, const typename pcl::search::KdTree<PointT>::Ptr& reference_pointcloud_search_method,
+				const AttemptValidator& attempt_validator, AttemptResult& result_out);
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </TrackingRecoveryPortfolio-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <gets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		inline bool empty() const { return strategies_.empty(); }
+		inline const std::vector<Strategy>& getStrategies() const { return strategies_; }
+		inline const std::deque<tf2::Transform>& getAcceptedPosesOdomToMap() const { return accepted_poses_odom_to_map_; }
+		inline int getNumberOfThreads() const { return number_of_threads_; }
+		inline size_t getMaximumNumberOfAcceptedPoses() const { return maximum_number_of_accepted_poses_; }
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </gets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <sets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		/*! If <= 0, std::thread::hardware_concurrency() is used. */
+		inline void setNumberOfThreads(int number_of_threads) { number_of_threads_ = number_of_threads; }
+		inline void setMaximumNumberOfAcceptedPoses(size_t maximum_number_of_accepted_poses) { maximum_number_of_accepted_poses_ = maximum_number_of_accepted_poses; }
+		inline void setMinimumTranslationBetweenInitialGuesses(double minimum_translation) { minimum_translation_between_initial_guesses_ = minimum_translation; }
+		inline void setMinimumRotationBetweenInitialGuesses(double minimum_rotation) { minimum_rotation_between_initial_guesses_ = minimum_rotation; }
+		inline void setMaxInliersDistance(double max_inliers_distance) { max_inliers_distance_ = max_inliers_distance; }
+		inline void setMinimumNumberOfPointsInAmbientPointCloud(int minimum_number_of_points) { minimum_number_of_points_in_ambient_pointcloud_ = minimum_number_of_points; }
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </sets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+	// ========================================================================   </public-section>  ===========================================================================
+
+	// ========================================================================   <protected-section>   ========================================================================
+	protected:
+		struct Attempt {
+			const Strategy* strategy;
+			size_t initial_guess_index;
+			tf2::Transform initial_guess_correction;
+		};
+
+		bool isFarFromInitialGuesses(const tf2::Transform& pose_correction, const std::vector<tf2::Transform>& initial_guesses_corrections) const;
+		void runAttempt(const Attempt& attempt, const typename pcl::PointCloud<PointT>::Ptr& ambient_pointcloud, const typename pcl::PointCloud<PointT>::Ptr& ambient_pointcloud_keypoints,
+				const typename pcl::search::KdTree<PointT>::Ptr& reference_pointcloud_search_method, AttemptResult& result);
+		void computeInliersStatistics(const typename pcl::search::KdTree<PointT>::Ptr& reference_pointcloud_search_method, AttemptResult& result);
+
+		std::vector<Strategy> strategies_;
+		std::deque<tf2::Transform> accepted_poses_odom_to_map_; // newest first
+		int number_of_threads_;
+		size_t maximum_number_of_accepted_poses_;
+		double minimum_translation_between_initial_guesses_;
+		double minimum_rotation_between_initial_guesses_;
+		double max_inliers_distance_;
+		int minimum_number_of_points_in_ambient_pointcloud_;
+	// ========================================================================   </protected-section>  ========================================================================
+};
+
+} /* namespace dynamic_robot_localization */
+
+
+#ifdef DRL_NO_PRECOMPILE
+#include <dynamic_robot_localization/localization/impl/tracking_recovery_portfolio.hpp>
+#endif
@@ -21,59 +21,40 @@ namespace dynamic_robot_localization {
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <NormalEstimatorSAC-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 template<typename PointT>
 void NormalEstimatorSAC<PointT>::setupConfigurationFromParameterServer(ros::NodeHandlePtr& node_handle, ros::NodeHandlePtr& private_node_handle, const std::string& configuration_namespace) {
-	int model_type = pcl::SACMODEL_LINE;
+	model_type_ = pcl::SACMODEL_LINE;
 	std::string model_type_str;
 	private_node_handle->param(configuration_namespace + "model_type", model_type_str, std::string("SACMODEL_LINE"));
 	if (model_type_str == "SACMODEL_PLANE") {
-		model_type = pcl::SACMODEL_PLANE;
+		model_type_ = pcl::SACMODEL_PLANE;
 	}
-	sac_segmentation_.setModelType(model_type);
 
-	int method_type = pcl::SAC_RANSAC;
+	method_type_ = pcl::SAC_RANSAC;
 	std::string method_type_str;
 	private_node_handle->param(configuration_namespace + "method_type", method_type_str, std::string("SAC_RANSAC"));
 	if (method_type_str == "SAC_LMEDS") {
-		method_type = pcl::SAC_LMEDS;
+		method_type_ = pcl::SAC_LMEDS;
 	} else if (method_type_str == "SAC_MSAC") {
-		method_type = pcl::SAC_MSAC;
+		method_type_ = pcl::SAC_MSAC;
 	} else if (method_type_str == "SAC_RRANSAC") {
-		method_type = pcl::SAC_RRANSAC;
+		method_type_ = pcl::SAC_RRANSAC;
 	} else if (method_type_str == "SAC_RMSAC") {
-		method_type = pcl::SAC_RMSAC;
+		method_type_ = pcl::SAC_RMSAC;
 	} else if (method_type_str == "SAC_MLESAC") {
-		method_type = pcl::SAC_MLESAC;
+		method_type_ = pcl::SAC_MLESAC;
 	} else if (method_type_str == "SAC_PROSAC") {
-		method_type = pcl::SAC_PROSAC;
-	}
-	sac_segmentation_.setMethodType(method_type);
-
-	double inlier_distance_threshold;
-	private_node_handle->param(configuration_namespace + "inlier_distance_threshold", inlier_distance_threshold, 0.025);
-	sac_segmentation_.setDistanceThreshold(inlier_distance_threshold);
-
-	int max_iterations;
-	private_node_handle->param(configuration_namespace + "max_iterations", max_iterations, 50);
-	sac_segmentation_.setMaxIterations(max_iterations);
-
-	double probability_of_sample_without_outliers;
-	private_node_handle->param(configuration_namespace + "probability_of_sample_without_outliers", probability_of_sample_without_outliers, 0.99);
-	sac_segmentation_.setProbability(probability_of_sample_without_outliers);
-
-	bool optimize_coefficients;
-	private_node_handle->param(configuration_namespace + "optimize_coefficients", optimize_coefficients, true);
-	sac_segmentation_.setOptimizeCoefficients(optimize_coefficients);
-
-	double min_model_radius;
-	double max_model_radius;
-	private_node_handle->param(configuration_namespace + "min_model_radius", min_model_radius, -std::numeric_limits<double>::max());
-	private_node_handle->param(configuration_namespace + "max_model_radius", max_model_radius, std::numeric_limits<double>::max());
-	if (min_model_radius > 0 && max_model_radius > 0) {
-		sac_segmentation_.setRadiusLimits(min_model_radius, max_model_radius);
+		method_type_ = pcl::SAC_PROSAC;
 	}
 
+	private_node_handle->param(configuration_namespace + "inlier_distance_threshold", inlier_distance_threshold_, 0.025);
+	private_node_handle->param(configuration_namespace + "max_iterations", max_iterations_, 50);
+	private_node_handle->param(configuration_namespace + "probability_of_sample_without_outliers", probability_of_sample_without_outliers_, 0.99);
+	private_node_handle->param(configuration_namespace + "optimize_coefficients", optimize_coefficients_, true);
 	private_node_handle->param(configuration_namespace + "random_samples_max_k", random_samples_max_k_, 5);
 	private_node_handle->param(configuration_namespace + "random_samples_max_radius", random_samples_max_radius_, 0.05);
 	private_node_handle->param(configuration_namespace + "minimum_inliers_percentage", minimum_inliers_percentage_, 0.5);
+	private_node_handle->param(configuration_namespace + "early_termination_inliers_percentage", early_termination_inliers_percentage_, -1.0);
+	private_node_handle->param(configuration_namespace + "random_number_generator_seed", random_number_generator_seed_, 12345);
+	private_node_handle->param(configuration_namespace + "number_of_threads", number_of_threads_, 0);
 
 	NormalEstimator<PointT>::setupConfigurationFromParameterServer(node_handle, private_node_handle, configuration_namespace);
 }
@@ -90,8 +71,15 @@ void NormalEstimatorSAC<PointT>::estimateNormals(typename pcl::PointCloud<PointT
 	if (pointcloud_original_size < 3) { return; }
 
 	pointcloud_with_normals_out = pointcloud;
-	sac_segmentation_.setSamplesMaxDist(random_samples_max_radius_, surface_search_method);
-	sac_segmentation_.setInputCloud(surface_search_method->getInputCloud());
+
+	int number_of_threads = 1;
+#ifdef _OPENMP
+	number_of_threads = (number_of_threads_ > 0) ? number_of_threads_ : omp_get_max_threads();
+#endif
+	std::vector<SACWorkspace> workspaces(number_of_threads);
+	for (size_t i = 0; i < workspaces.size(); ++i) {
+		setupSACWorkspace(workspaces[i], surface_search_method->getInputCloud(), surface_search_method);
+	}
 
 	float vp_x = viewpoint_guess.getOrigin().x();
 	float vp_y = viewpoint_guess.getOrigin().y();
@@ -108,26 +96,35 @@ void NormalEstimatorSAC<PointT>::estimateNormals(typename pcl::PointCloud<PointT
 			point_2_3.z - vp_z);
 	tf2::Vector3 normal_to_viewpoint = normal_1_3.cross(normal_2_3);
 
-	for (size_t i = 0; i < pointcloud_with_normals_out->size(); ++i) {
+	int pointcloud_size = (int)pointcloud_with_normals_out->size();
+	#pragma omp parallel for schedule(dynamic, 64) num_threads(number_of_threads)
+	for (int i = 0; i < pointcloud_size; ++i) {
+#ifdef _OPENMP
+		SACWorkspace& workspace = workspaces[omp_get_thread_num()];
+#else
+		SACWorkspace& workspace = workspaces[0];
+#endif
 		PointT& current_point = (*pointcloud_with_normals_out)[i];
-		pcl::IndicesPtr nn_indices(new std::vector<int>());
-		std::vector<float> nn_distances;
+		std::vector<int>& nn_indices = *workspace.neighbors_indices;
+		std::vector<float>& nn_distances = workspace.neighbors_distances;
+		nn_indices.clear();
+		nn_distances.clear();
 		if (random_samples_max_k_ > 0) {
-			surface_search_method->nearestKSearch(current_point, random_samples_max_k_, *nn_indices, nn_distances);
+			surface_search_method->nearestKSearch(current_point, random_samples_max_k_, nn_indices, nn_distances);
 		} else {
-			surface_search_method->radiusSearch(current_point, random_samples_max_radius_, *nn_indices, nn_distances);
+			surface_search_method->radiusSearch(current_point, random_samples_max_radius_, nn_indices, nn_distances);
 		}
 
 		bool orient_normal_towards_viewpoint = true;
-		if (nn_distances.size() > 2 && nn_indices->size() > 2) {
-			sac_segmentation_.setIndices(nn_indices);
-			pcl::ModelCoefficients coefficients;
-			pcl::PointIndices inliers;
-			sac_segmentation_.segment(inliers, coefficients);
-			if (!coefficients.values.empty() && inliers.indices.size() > 2 && ((double)nn_indices->size() / (double)inliers.indices.size()) > minimum_inliers_percentage_) {
-				if (sac_segmentation_.getModelType() == pcl::SACMODEL_LINE) {
-					if (coefficients.values.size() == 6) {
-						tf2::Vector3 line_vector(coefficients.values[3], coefficients.values[4], coefficients.values[5]);
+		if (nn_distances.size() > 2 && nn_indices.size() > 2) {
+			workspace.sac_model->setIndices(workspace.neighbors_indices);
+			workspace.reset_random_number_generators((unsigned int)random_number_generator_seed_);
+			bool model_computed = (early_termination_inliers_percentage_ > 0.0) ? computeSACModelWithEarlyTermination(workspace) : computeSACModel(workspace);
+			if (model_computed && workspace.inliers.size() > 2 && ((double)nn_indices.size() / (double)workspace.inliers.size()) > minimum_inliers_percentage_) {
+				const Eigen::VectorXf& coefficients = workspace.model_coefficients_refined;
+				if (model_type_ == pcl::SACMODEL_LINE) {
+					if (coefficients.size() == 6) {
+						tf2::Vector3 line_vector(coefficients[3], coefficients[4], coefficients[5]);
 						tf2::Vector3 line_normal = line_vector.cross(normal_to_viewpoint);
 						line_normal.normalize();
 						current_point.normal_x = line_normal.x();
@@ -136,11 +133,11 @@ void NormalEstimatorSAC<PointT>::estimateNormals(typename pcl::PointCloud<PointT
 						pcl::flipNormalTowardsViewpoint(current_point, vp_x, vp_y, vp_z, current_point.normal_x, current_point.normal_y, current_point.normal_z);
 						orient_normal_towards_viewpoint = false;
 					}
-				} else if(sac_segmentation_.getModelType() == pcl::SACMODEL_PLANE) {
-					if (coefficients.values.size() == 4) {
-						current_point.normal_x = coefficients.values[0];
-						current_point.normal_y = coefficients.values[1];
-						current_point.normal_z = coefficients.values[2];
+				} else if (model_type_ == pcl::SACMODEL_PLANE) {
+					if (coefficients.size() == 4) {
+						current_point.normal_x = coefficients[0];
+						current_point.normal_y = coefficients[1];
+						current_point.normal_z = coefficients[2];
 						pcl::flipNormalTowardsViewpoint(current_point, vp_x, vp_y, vp_z, current_point.normal_x, current_point.normal_y, current_point.normal_z);
 						orient_normal_towards_viewpoint = false;
 					}
@@ -186,7 +183,7 @@ void NormalEstimatorSAC<PointT>::estimateNormals(typename pcl::PointCloud<PointT
 		surface_search_method->setInputCloud(pointcloud_with_normals_out);
 	}
 
-	ROS_DEBUG_STREAM("NormalEstimatorSAC computed " << pointcloud_with_normals_out->size() << " normals from a cloud with " << pointcloud_original_size << " points");
+	ROS_DEBUG_STREAM("NormalEstimatorSAC computed " << pointcloud_with_normals_out->size() << " normals from a cloud with " << pointcloud_original_size << " points using " << number_of_threads << " threads");
 
 	NormalEstimator<PointT>::estimateNormals(pointcloud, surface, surface_search_method, viewpoint_guess, pointcloud_with_normals_out);
 }
@@ -194,6 +191,114 @@ void NormalEstimatorSAC<PointT>::estimateNormals(typename pcl::PointCloud<PointT
 // =============================================================================  </public-section>  ===========================================================================
 
 // =============================================================================   <protected-section>   =======================================================================
+template<typename PointT>
+template<typename SampleConsensusT>
+typename pcl::SampleConsensus<PointT>::Ptr NormalEstimatorSAC<PointT>::s_createSeededSampleConsensus(const typename pcl::SampleConsensusModel<PointT>::Ptr& sac_model, double inlier_distance_threshold,
+		std::function<void(unsigned int)>& reset_random_number_generator) {
+	std::shared_ptr< SeededSampleConsensus<SampleConsensusT> > sac_method(new SeededSampleConsensus<SampleConsensusT>(sac_model, inlier_distance_threshold));
+	SeededSampleConsensus<SampleConsensusT>* sac_method_raw_ptr = sac_method.get();
+	reset_random_number_generator = [sac_method_raw_ptr](unsigned int seed) { sac_method_raw_ptr->setSeed(seed); };
+	return sac_method;
+}
+
+template<typename PointT>
+void NormalEstimatorSAC<PointT>::setupSACWorkspace(SACWorkspace& workspace, const typename pcl::PointCloud<PointT>::ConstPtr& surface, typename pcl::search::KdTree<PointT>::Ptr& surface_search_method) {
+	workspace.neighbors_indices.reset(new std::vector<int>());
+
+	std::function<void(unsigned int)> reset_model_random_number_generator;
+	if (model_type_ == pcl::SACMODEL_PLANE) {
+		std::shared_ptr< SeededSampleConsensusModel< pcl::SampleConsensusModelPlane<PointT> > > sac_model(new SeededSampleConsensusModel< pcl::SampleConsensusModelPlane<PointT> >(surface));
+		SeededSampleConsensusModel< pcl::SampleConsensusModelPlane<PointT> >* sac_model_raw_ptr = sac_model.get();
+		reset_model_random_number_generator = [sac_model_raw_ptr](unsigned int seed) { sac_model_raw_ptr->setSeed(seed); };
+		workspace.sac_model = sac_model;
+	} else {
+		std::shared_ptr< SeededSampleConsensusModel< pcl::SampleConsensusModelLine<PointT> > > sac_model(new SeededSampleConsensusModel< pcl::SampleConsensusModelLine<PointT> >(surface));
+		SeededSampleConsensusModel< pcl::SampleConsensusModelLine<PointT> >* sac_model_raw_ptr = sac_model.get();
+		reset_model_random_number_generator = [sac_model_raw_ptr](unsigned int seed) { sac_model_raw_ptr->setSeed(seed); };
+		workspace.sac_model = sac_model;
+	}
+	workspace.sac_model->setSamplesMaxDist(random_samples_max_radius_, surface_search_method);
+
+	std::function<void(unsigned int)> reset_method_random_number_generator;
+	switch (method_type_) {
+		case pcl::SAC_LMEDS: { workspace.sac_method = s_createSeededSampleConsensus< pcl::LeastMedianSquares<PointT> >(workspace.sac_model, inlier_distance_threshold_, reset_method_random_number_generator); break; }
+		case pcl::SAC_MSAC: { workspace.sac_method = s_createSeededSampleConsensus< pcl::MEstimatorSampleConsensus<PointT> >(workspace.sac_model, inlier_distance_threshold_, reset_method_random_number_generator); break; }
+		case pcl::SAC_RRANSAC: { workspace.sac_method = s_createSeededSampleConsensus< pcl::RandomizedRandomSampleConsensus<PointT> >(workspace.sac_model, inlier_distance_threshold_, reset_method_random_number_generator); break; }
+		case pcl::SAC_RMSAC: { workspace.sac_method = s_createSeededSampleConsensus< pcl::RandomizedMEstimatorSampleConsensus<PointT> >(workspace.sac_model, inlier_distance_threshold_, reset_method_random_number_generator); break; }
+		case pcl::SAC_MLESAC: { workspace.sac_method = s_createSeededSampleConsensus< pcl::MaximumLikelihoodSampleConsensus<PointT> >(workspace.sac_model, inlier_distance_threshold_, reset_method_random_number_generator); break; }
+		case pcl::SAC_PROSAC: { workspace.sac_method = s_createSeededSampleConsensus< pcl::ProgressiveSampleConsensus<PointT> >(workspace.sac_model, inlier_distance_threshold_, reset_method_random_number_generator); break; }
+		default: { workspace.sac_method = s_createSeededSampleConsensus< pcl::RandomSampleConsensus<PointT> >(workspace.sac_model, inlier_distance_threshold_, reset_method_random_number_generator); break; }
+	}
+	workspace.sac_method->setMaxIterations(max_iterations_);
+	workspace.sac_method->setProbability(probability_of_sample_without_outliers_);
+
+	workspace.reset_random_number_generators = [reset_model_random_number_generator, reset_method_random_number_generator](unsigned int seed) {
+		reset_model_random_number_generator(seed);
+		reset_method_random_number_generator(seed);
+	};
+}
+
+template<typename PointT>
+bool NormalEstimatorSAC<PointT>::computeSACModel(SACWorkspace& workspace) {
+	if (!workspace.sac_method->computeModel(0)) { return false; }
+	workspace.sac_method->getInliers(workspace.inliers);
+	workspace.sac_method->getModelCoefficients(workspace.model_coefficients);
+	return refineSACModel(workspace);
+}
+
+template<typename PointT>
+bool NormalEstimatorSAC<PointT>::computeSACModelWithEarlyTermination(SACWorkspace& workspace) {
+	// same iterations as pcl::RandomSampleConsensus, but stopping as soon as a model has enough inliers
+	size_t number_of_neighbors = workspace.neighbors_indices->size();
+	int minimum_number_of_inliers = (int)std::ceil(early_termination_inliers_percentage_ * (double)number_of_neighbors);
+	double log_probability = std::log(1.0 - probability_of_sample_without_outliers_);
+	double one_over_indices = 1.0 / (double)number_of_neighbors;
+	int best_number_of_inliers = -1;
+	double number_of_iterations_needed = 1.0;
+	int number_of_iterations = 0;
+	int number_of_skipped_samples = 0;
+	int max_number_of_skipped_samples = max_iterations_ * 10;
+
+	while (number_of_iterations < number_of_iterations_needed && number_of_skipped_samples < max_number_of_skipped_samples) {
+		workspace.sac_model->getSamples(number_of_iterations, workspace.samples);
+		if (workspace.samples.empty()) { break; }
+
+		if (!workspace.sac_model->computeModelCoefficients(workspace.samples, workspace.model_coefficients_refined)) {
+			++number_of_skipped_samples;
+			continue;
+		}
+
+		int number_of_inliers = workspace.sac_model->countWithinDistance(workspace.model_coefficients_refined, inlier_distance_threshold_);
+		if (number_of_inliers > best_number_of_inliers) {
+			best_number_of_inliers = number_of_inliers;
+			workspace.model_coefficients = workspace.model_coefficients_refined;
+			if (number_of_inliers >= minimum_number_of_inliers) { break; }
+
+			double w = (double)best_number_of_inliers * one_over_indices;
+			double p_no_outliers = 1.0 - std::pow(w, (double)workspace.samples.size());
+			p_no_outliers = std::max(std::numeric_limits<double>::epsilon(), p_no_outliers);
+			p_no_outliers = std::min(1.0 - std::numeric_limits<double>::epsilon(), p_no_outliers);
+			number_of_iterations_needed = log_probability / std::log(p_no_outliers);
+		}
+
+		if (++number_of_iterations > max_iterations_) { break; }
+	}
+
+	if (best_number_of_inliers < 0) { return false; }
+	workspace.sac_model->selectWithinDistance(workspace.model_coefficients, inlier_distance_threshold_, workspace.inliers);
+	return refineSACModel(workspace);
+}
+
+template<typename PointT>
+bool NormalEstimatorSAC<PointT>::refineSACModel(SACWorkspace& workspace) {
+	if (optimize_coefficients_) {
+		workspace.sac_model->optimizeModelCoefficients(workspace.inliers, workspace.model_coefficients, workspace.model_coefficients_refined);
+		workspace.sac_model->selectWithinDistance(workspace.model_coefficients_refined, inlier_distance_threshold_, workspace.inliers);
+	} else {
+		workspace.model_coefficients_refined = workspace.model_coefficients;
+	}
+	return workspace.model_coefficients_refined.size() > 0;
+}
 // =============================================================================   </protected-section>  =======================================================================
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <template instantiations>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
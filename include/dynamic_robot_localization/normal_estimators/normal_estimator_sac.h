@@ -9,6 +9,9 @@
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>  <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 // std includes
+#include <algorithm>
+#include <cmath>
+#include <functional>
 #include <limits>
 #include <memory>
 #include <string>
@@ -23,7 +26,22 @@
 #include <pcl/point_types.h>
 #include <pcl/features/normal_3d.h>
 #include <pcl/filters/filter.h>
-#include <pcl/segmentation/sac_segmentation.h>
+#include <pcl/sample_consensus/lmeds.h>
+#include <pcl/sample_consensus/method_types.h>
+#include <pcl/sample_consensus/mlesac.h>
+#include <pcl/sample_consensus/model_types.h>
+#include <pcl/sample_consensus/msac.h>
+#include <pcl/sample_consensus/prosac.h>
+#include <pcl/sample_consensus/ransac.h>
+#include <pcl/sample_consensus/rmsac.h>
+#include <pcl/sample_consensus/rransac.h>
+#include <pcl/sample_consensus/sac_model_line.h>
+#include <pcl/sample_consensus/sac_model_plane.h>
+
+// external libs includes
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 // project includes
 #include <dynamic_robot_localization/normal_estimators/normal_estimator.h>
@@ -31,9 +49,32 @@
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 namespace dynamic_robot_localization {
+// ######################################################################   SeededSampleConsensusModel   ######################################################################
+/**
+ * \brief Sample consensus model whose random number generator can be reset, which allows to reuse the same model for many neighborhoods while drawing the same samples
+ * that a newly constructed model would draw (PCL seeds the models and methods with a fixed seed when they are not created in random mode).
+ */
+template <typename SampleConsensusModelT>
+class SeededSampleConsensusModel : public SampleConsensusModelT {
+	public:
+		using SampleConsensusModelT::SampleConsensusModelT;
+		void setSeed(unsigned int seed) { this->rng_alg_.seed(seed); }
+};
+
+template <typename SampleConsensusT>
+class SeededSampleConsensus : public SampleConsensusT {
+	public:
+		using SampleConsensusT::SampleConsensusT;
+		void setSeed(unsigned int seed) { this->rng_->base().seed(seed); }
+};
+
+
 // ###########################################################################   NormalEstimatorSAC   ##########################################################################
 /**
- * \brief Description...
+ * \brief Estimates the normal of each point by fitting a line or a plane to its neighbors with sample consensus.
+ * The points are processed in parallel with OpenMP and each thread reuses its sample consensus model, method and neighbors buffers.
+ * The random number generators are reset to the configured seed before each point, which makes the normals deterministic for a given seed and independent of the number of threads and of the order in which the points are processed.
+ * Older versions seeded the sample consensus with the time, so the normals are not expected to match the ones they computed.
  */
 template <typename PointT>
 class NormalEstimatorSAC : public NormalEstimator<PointT> {
@@ -46,10 +87,18 @@ class NormalEstimatorSAC : public NormalEstimator<PointT> {
 
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <constructors-destructor>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 		NormalEstimatorSAC() :
-			sac_segmentation_(true),
+			model_type_(pcl::SACMODEL_LINE),
+			method_type_(pcl::SAC_RANSAC),
+			inlier_distance_threshold_(0.025),
+			max_iterations_(50),
+			probability_of_sample_without_outliers_(0.99),
+			optimize_coefficients_(true),
 			random_samples_max_k_(5),
 			random_samples_max_radius_(0.05),
-			minimum_inliers_percentage_(0.5) {}
+			minimum_inliers_percentage_(0.5),
+			early_termination_inliers_percentage_(-1.0),
+			random_number_generator_seed_(12345),
+			number_of_threads_(0) {}
 
 		virtual ~NormalEstimatorSAC() {}
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </constructors-destructor>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
@@ -67,6 +116,8 @@ class NormalEstimatorSAC : public NormalEstimator<PointT> {
 		double getMinimumInliersPercentage() const { return minimum_inliers_percentage_; }
 		int getRandomSamplesMaxK() const { return random_samples_max_k_; }
 		double getRandomSamplesMaxRadius() const { return random_samples_max_radius_; }
+		double getEarlyTerminationInliersPercentage() const { return early_termination_inliers_percentage_; }
+		int getNumberOfThreads() const { return number_of_threads_; }
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </gets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <sets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
@@ -75,10 +126,38 @@ class NormalEstimatorSAC : public NormalEstimator<PointT> {
 
 	// ========================================================================   <protected-section>   ========================================================================
 	protected:
-		pcl::SACSegmentation<PointT> sac_segmentation_;
+		struct SACWorkspace {
+			typename pcl::SampleConsensusModel<PointT>::Ptr sac_model;
+			typename pcl::SampleConsensus<PointT>::Ptr sac_method;
+			std::function<void(unsigned int)> reset_random_number_generators;
+			pcl::IndicesPtr neighbors_indices;
+			std::vector<float> neighbors_distances;
+			std::vector<int> samples;
+			std::vector<int> inliers;
+			Eigen::VectorXf model_coefficients;
+			Eigen::VectorXf model_coefficients_refined;
+		};
+
+		template<typename SampleConsensusT>
+		static typename pcl::SampleConsensus<PointT>::Ptr s_createSeededSampleConsensus(const typename pcl::SampleConsensusModel<PointT>::Ptr& sac_model, double inlier_distance_threshold,
+				std::function<void(unsigned int)>& reset_random_number_generator);
+		void setupSACWorkspace(SACWorkspace& workspace, const typename pcl::PointCloud<PointT>::ConstPtr& surface, typename pcl::search::KdTree<PointT>::Ptr& surface_search_method);
+		bool computeSACModel(SACWorkspace& workspace);
+		bool computeSACModelWithEarlyTermination(SACWorkspace& workspace);
+		bool refineSACModel(SACWorkspace& workspace);
+
+		int model_type_;
+		int method_type_;
+		double inlier_distance_threshold_;
+		int max_iterations_;
+		double probability_of_sample_without_outliers_;
+		bool optimize_coefficients_;
 		int random_samples_max_k_;
 		double random_samples_max_radius_;
 		double minimum_inliers_percentage_;
+		double early_termination_inliers_percentage_;
+		int random_number_generator_seed_;
+		int number_of_threads_;
 	// ========================================================================   </protected-section>  ========================================================================
 };
 
@@ -11,6 +11,7 @@
 // std includes
 #include <algorithm>
 #include <cmath>
+#include <cstdint>
 #include <limits>
 #include <memory>
 #include <string>
@@ -22,6 +23,11 @@
 #include <pcl/point_types_conversion.h>
 #include <pcl/search/kdtree.h>
 
+// external libs includes
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 // project includes
 #include <dynamic_robot_localization/outlier_detectors/outlier_detector.h>
 #include <dynamic_robot_localization/common/pointcloud2_builder.h>
@@ -30,7 +36,9 @@
 namespace dynamic_robot_localization {
 // #######################################################################   euclidean_outlier_detector   ######################################################################
 /**
- * \brief Description...
+ * \brief Classifies the ambient points as inliers if they have a reference point within max_inliers_distance (that also passes the enabled curvature, normal and color validators).
+ * The points are classified in parallel (with per thread search buffers) and the inliers / outliers clouds are filled in a second pass using the positions computed from the classification,
+ * which gives the same clouds and root mean square error as a serial classification.
  */
 template <typename PointT>
 class EuclideanOutlierDetector : public OutlierDetector<PointT> {
@@ -53,6 +61,9 @@ class EuclideanOutlierDetector : public OutlierDetector<PointT> {
 		virtual bool checkIfHsvColorDifferenceValidationIsEnabled();
 		virtual size_t detectOutliers(typename pcl::search::KdTree<PointT>::Ptr reference_pointcloud_search_method, const pcl::PointCloud<PointT>& ambient_pointcloud,
 				typename pcl::PointCloud<PointT>::Ptr& outliers_out, typename pcl::PointCloud<PointT>::Ptr& inliers_out, double& root_mean_square_error_of_inliers_out);
+		/*! Caches the hsv colors of the reference point cloud (when the hsv validation is enabled), which are used while detectOutliers receives a search method over the same cloud. */
+		virtual void setupReferenceCloud(const typename pcl::PointCloud<PointT>::ConstPtr& reference_pointcloud);
+		virtual size_t accountMemoryUsage(MemoryUsage& memory_usage);
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </EuclideanOutlierDetector-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <gets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
@@ -64,6 +75,13 @@ class EuclideanOutlierDetector : public OutlierDetector<PointT> {
 
 	// ========================================================================   <protected-section>   ========================================================================
 	protected:
+		struct SearchBuffers {
+			std::vector<int> search_indices;
+			std::vector<float> search_sqr_distances;
+		};
+
+		void computeReferencePointCloudHsvColors(const pcl::PointCloud<PointT>& reference_pointcloud);
+
 		double max_inliers_distance_;
 		bool colorize_inliers_based_on_correspondence_distance_;
 		bool colorize_outliers_with_red_color_;
@@ -72,6 +90,13 @@ class EuclideanOutlierDetector : public OutlierDetector<PointT> {
 		double max_hsv_color_hue_difference_in_degrees_;
 		double max_hsv_color_saturation_difference_;
 		double max_hsv_color_value_difference_;
+		int number_of_threads_;
+		std::vector<SearchBuffers> threads_search_buffers_;
+		std::vector<float> points_distances_squared_; // < 0 -> outlier
+		std::vector<size_t> points_output_indices_;
+		std::vector<pcl::HSV> reference_pointcloud_hsv_colors_;
+		std::weak_ptr< const pcl::PointCloud<PointT> > reference_pointcloud_hsv_colors_source_; // does not keep the cloud alive, but a freed cloud can not be mistaken for a new one allocated at the same address
+		std::uint64_t reference_pointcloud_hsv_colors_source_stamp_; // the reference cloud is updated in place when integrating the ambient point clouds
 	// ========================================================================   </protected-section>  ========================================================================
 };
 
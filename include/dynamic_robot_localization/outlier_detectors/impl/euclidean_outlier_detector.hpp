@@ -17,7 +17,7 @@ namespace dynamic_robot_localization {
 // =============================================================================  <public-section>  ============================================================================
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <constructors-destructor>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 template<typename PointT>
-EuclideanOutlierDetector<PointT>::EuclideanOutlierDetector(const std::string& topics_configuration_prefix) : OutlierDetector<PointT>(topics_configuration_prefix), max_inliers_distance_(0.01) {}
+EuclideanOutlierDetector<PointT>::EuclideanOutlierDetector(const std::string& topics_configuration_prefix) : OutlierDetector<PointT>(topics_configuration_prefix), max_inliers_distance_(0.01), number_of_threads_(0), reference_pointcloud_hsv_colors_source_stamp_(0) {}
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </constructors-destructor>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <EuclideanOutlierDetector-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
@@ -31,6 +31,7 @@ void EuclideanOutlierDetector<PointT>::setupConfigurationFromParameterServer(ros
 	private_node_handle->param(configuration_namespace + "max_hsv_color_hue_difference_in_degrees", max_hsv_color_hue_difference_in_degrees_, -30.0);
 	private_node_handle->param(configuration_namespace + "max_hsv_color_saturation_difference", max_hsv_color_saturation_difference_, 0.3);
 	private_node_handle->param(configuration_namespace + "max_hsv_color_value_difference", max_hsv_color_value_difference_, 0.3);
+	private_node_handle->param(configuration_namespace + "number_of_threads", number_of_threads_, 0);
 	OutlierDetector<PointT>::setupConfigurationFromParameterServer(node_handle, private_node_handle, configuration_namespace);
 }
 
@@ -52,6 +53,30 @@ bool EuclideanOutlierDetector<PointT>::checkIfHsvColorDifferenceValidationIsEnab
 		max_hsv_color_value_difference_ > 0.0 && max_hsv_color_value_difference_ <= 1.0);
 }
 
+template<typename PointT>
+size_t EuclideanOutlierDetector<PointT>::accountMemoryUsage(MemoryUsage& memory_usage) {
+	if (!memory_usage.addObject(this)) { return 0; }
+	size_t bytes = sizeof(*this) + MemoryUsage::s_getVectorBytes(threads_search_buffers_) + MemoryUsage::s_getVectorBytes(points_distances_squared_)
+			+ MemoryUsage::s_getVectorBytes(points_output_indices_) + MemoryUsage::s_getVectorBytes(reference_pointcloud_hsv_colors_);
+	for (size_t i = 0; i < threads_search_buffers_.size(); ++i) {
+		bytes += MemoryUsage::s_getVectorBytes(threads_search_buffers_[i].search_indices) + MemoryUsage::s_getVectorBytes(threads_search_buffers_[i].search_sqr_distances);
+	}
+	return memory_usage.addBytes(bytes);
+}
+
+template<typename PointT>
+void EuclideanOutlierDetector<PointT>::setupReferenceCloud(const typename pcl::PointCloud<PointT>::ConstPtr& reference_pointcloud) {
+	if (reference_pointcloud && checkIfHsvColorDifferenceValidationIsEnabled()) {
+		computeReferencePointCloudHsvColors(*reference_pointcloud);
+		reference_pointcloud_hsv_colors_source_ = reference_pointcloud;
+		reference_pointcloud_hsv_colors_source_stamp_ = reference_pointcloud->header.stamp;
+	} else {
+		std::vector<pcl::HSV>().swap(reference_pointcloud_hsv_colors_);
+		reference_pointcloud_hsv_colors_source_.reset();
+		reference_pointcloud_hsv_colors_source_stamp_ = 0;
+	}
+}
+
 template<typename PointT>
 size_t EuclideanOutlierDetector<PointT>::detectOutliers(typename pcl::search::KdTree<PointT>::Ptr reference_pointcloud_search_method, const pcl::PointCloud<PointT>& ambient_pointcloud,
 		typename pcl::PointCloud<PointT>::Ptr& outliers_out, typename pcl::PointCloud<PointT>::Ptr& inliers_out, double& root_mean_square_error_of_inliers_out) {
@@ -72,11 +97,31 @@ size_t EuclideanOutlierDetector<PointT>::detectOutliers(typename pcl::search::Kd
 		reference_pointcloud_search_method->setSortedResults(true);
 	}
 
-	if (max_inliers_distance_ > 0.0) {
-		for (size_t i = 0; i < ambient_pointcloud.size(); ++i) {
-			PointT point = ambient_pointcloud.points[i];
-			std::vector<int> search_indices;
-			std::vector<float> search_sqr_distances;
+	if (max_inliers_distance_ > 0.0 && !ambient_pointcloud.empty()) {
+		typename pcl::PointCloud<PointT>::ConstPtr reference_pointcloud_ptr = reference_pointcloud_search_method->getInputCloud();
+		const pcl::PointCloud<PointT>& reference_pointcloud = *reference_pointcloud_ptr;
+		// the cached colors are only valid for the cloud given to setupReferenceCloud while its stamp is not changed (other clouds are converted to hsv for each neighbor)
+		bool use_precomputed_reference_hsv_colors = hsv_color_difference_validation_enabled && reference_pointcloud_hsv_colors_source_.lock() == reference_pointcloud_ptr
+				&& reference_pointcloud_hsv_colors_source_stamp_ == reference_pointcloud.header.stamp && reference_pointcloud_hsv_colors_.size() == reference_pointcloud.size();
+
+		int number_of_threads = 1;
+#ifdef _OPENMP
+		number_of_threads = (number_of_threads_ > 0) ? number_of_threads_ : omp_get_max_threads();
+#endif
+		if (threads_search_buffers_.size() < (size_t)number_of_threads) { threads_search_buffers_.resize(number_of_threads); }
+		points_distances_squared_.resize(ambient_pointcloud.size());
+
+		int ambient_pointcloud_size = (int)ambient_pointcloud.size();
+		#pragma omp parallel for schedule(dynamic, 256) num_threads(number_of_threads)
+		for (int i = 0; i < ambient_pointcloud_size; ++i) {
+#ifdef _OPENMP
+			SearchBuffers& search_buffers = threads_search_buffers_[omp_get_thread_num()];
+#else
+			SearchBuffers& search_buffers = threads_search_buffers_[0];
+#endif
+			const PointT& point = ambient_pointcloud.points[i];
+			std::vector<int>& search_indices = search_buffers.search_indices;
+			std::vector<float>& search_sqr_distances = search_buffers.search_sqr_distances;
 			int number_of_neighbors_found;
 
 			if (difference_validators_enabled) {
@@ -99,7 +144,7 @@ size_t EuclideanOutlierDetector<PointT>::detectOutliers(typename pcl::search::Kd
 						pcl::RGBtoHSV(point.r, point.g, point.b, point_hsv.h, point_hsv.s, point_hsv.v);
 					}
 					for (int j = 0; j < number_of_neighbors_found; ++j) {
-						const PointT& point_neighbor = reference_pointcloud_search_method->getInputCloud()->at(search_indices[j]);
+						const PointT& point_neighbor = reference_pointcloud[search_indices[j]];
 
 						if (curvature_difference_validation_enabled) {
 							valid_curvature = (std::abs(point.curvature - point_neighbor.curvature) <= max_curvature_difference_);
@@ -118,7 +163,11 @@ size_t EuclideanOutlierDetector<PointT>::detectOutliers(typename pcl::search::Kd
 						if (hsv_color_difference_validation_enabled) {
 							valid_hsv = false;
 							pcl::HSV neighbor_hsv;
-							pcl::RGBtoHSV(point_neighbor.r, point_neighbor.g, point_neighbor.b, neighbor_hsv.h, neighbor_hsv.s, neighbor_hsv.v);
+							if (use_precomputed_reference_hsv_colors) {
+								neighbor_hsv = reference_pointcloud_hsv_colors_[search_indices[j]];
+							} else {
+								pcl::RGBtoHSV(point_neighbor.r, point_neighbor.g, point_neighbor.b, neighbor_hsv.h, neighbor_hsv.s, neighbor_hsv.v);
+							}
 							float hsv_value_difference = std::abs(neighbor_hsv.v - point_hsv.v);
 							if (hsv_value_difference <= max_hsv_color_value_difference_) {
 								float hsv_saturation_difference = std::abs(neighbor_hsv.s - point_hsv.s);
@@ -152,23 +201,60 @@ size_t EuclideanOutlierDetector<PointT>::detectOutliers(typename pcl::search::Kd
 				}
 			}
 
-			if (point_is_inlier) {
-				if (point_distance_squared >= 0.0f && colorize_inliers_based_on_correspondence_distance_) {
-					float hue = (1.0f - (std::sqrt(point_distance_squared) / max_inliers_distance_)) * 120.0f;
-					pcl::HSVtoRGB(hue, 1.0f, 1.0f, point.r, point.g, point.b);
-				}
-			} else if (colorize_outliers_with_red_color_) {
-				point.r = 255;
-				point.g = 0;
-				point.b = 0;
-			}
+			points_distances_squared_[i] = point_is_inlier ? point_distance_squared : -1.0f;
+		}
 
-			if (point_is_inlier) {
-				if (save_inliers) { inliers_out->push_back(point); }
+		// serial pass (in the same order as the ambient points) to keep the sum of the squared errors identical to a serial classification
+		points_output_indices_.resize(ambient_pointcloud.size());
+		size_t number_outliers = 0;
+		for (size_t i = 0; i < ambient_pointcloud.size(); ++i) {
+			float point_distance_squared = points_distances_squared_[i];
+			if (point_distance_squared >= 0.0f) {
 				root_mean_square_error_of_inliers_out += point_distance_squared;
-				++number_inliers;
+				points_output_indices_[i] = number_inliers++;
 			} else {
-				if (save_outliers) { outliers_out->push_back(point); }
+				points_output_indices_[i] = number_outliers++;
+			}
+		}
+
+		size_t inliers_offset = 0;
+		size_t outliers_offset = 0;
+		if (save_inliers) {
+			inliers_offset = inliers_out->size();
+			inliers_out->points.resize(inliers_offset + number_inliers);
+			inliers_out->width = inliers_out->points.size();
+			inliers_out->height = 1;
+		}
+
+		if (save_outliers) {
+			outliers_offset = outliers_out->size();
+			outliers_out->points.resize(outliers_offset + number_outliers);
+			outliers_out->width = outliers_out->points.size();
+			outliers_out->height = 1;
+		}
+
+		if (save_inliers || save_outliers) {
+			#pragma omp parallel for schedule(static) num_threads(number_of_threads)
+			for (int i = 0; i < ambient_pointcloud_size; ++i) {
+				float point_distance_squared = points_distances_squared_[i];
+				bool point_is_inlier = point_distance_squared >= 0.0f;
+				if (point_is_inlier ? !save_inliers : !save_outliers) { continue; }
+
+				PointT point = ambient_pointcloud.points[i];
+				if (point_is_inlier) {
+					if (colorize_inliers_based_on_correspondence_distance_) {
+						float hue = (1.0f - (std::sqrt(point_distance_squared) / max_inliers_distance_)) * 120.0f;
+						pcl::HSVtoRGB(hue, 1.0f, 1.0f, point.r, point.g, point.b);
+					}
+					inliers_out->points[inliers_offset + points_output_indices_[i]] = point;
+				} else {
+					if (colorize_outliers_with_red_color_) {
+						point.r = 255;
+						point.g = 0;
+						point.b = 0;
+					}
+					outliers_out->points[outliers_offset + points_output_indices_[i]] = point;
+				}
 			}
 		}
 	}
@@ -186,6 +272,17 @@ size_t EuclideanOutlierDetector<PointT>::detectOutliers(typename pcl::search::Kd
 // =============================================================================  </public-section>  ===========================================================================
 
 // =============================================================================   <protected-section>   =======================================================================
+template<typename PointT>
+void EuclideanOutlierDetector<PointT>::computeReferencePointCloudHsvColors(const pcl::PointCloud<PointT>& reference_pointcloud) {
+	reference_pointcloud_hsv_colors_.resize(reference_pointcloud.size());
+	int reference_pointcloud_size = (int)reference_pointcloud.size();
+	#pragma omp parallel for schedule(static)
+	for (int i = 0; i < reference_pointcloud_size; ++i) {
+		const PointT& point = reference_pointcloud.points[i];
+		pcl::HSV& point_hsv = reference_pointcloud_hsv_colors_[i];
+		pcl::RGBtoHSV(point.r, point.g, point.b, point_hsv.h, point_hsv.s, point_hsv.v);
+	}
+}
 // =============================================================================   </protected-section>  =======================================================================
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <template instantiations>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
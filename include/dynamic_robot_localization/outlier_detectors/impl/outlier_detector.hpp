@@ -69,9 +69,7 @@ bool OutlierDetector<PointT>::isPublishingInliers() {
 template<typename PointT>
 void OutlierDetector<PointT>::publishOutliers(typename pcl::PointCloud<PointT>::Ptr& outliers) {
 	if (outliers && isPublishingOutliers()) {
-		sensor_msgs::PointCloud2Ptr outliers_msg(new sensor_msgs::PointCloud2());
-		pcl::toROSMsg(*outliers, *outliers_msg);
-		outliers_publisher_.publish(outliers_msg);
+		pointcloud_conversions::publishPointCloudAsynchronously<PointT>(outliers, outliers_publisher_, outliers->header.frame_id, false, "outliers");
 	} else {
 		if (!outliers_publisher_.getTopic().empty()) {
 			ROS_DEBUG_STREAM("Avoiding publishing pointcloud on topic " << outliers_publisher_.getTopic() << " because there is no subscribers");
@@ -83,9 +81,7 @@ void OutlierDetector<PointT>::publishOutliers(typename pcl::PointCloud<PointT>::
 template<typename PointT>
 void OutlierDetector<PointT>::publishInliers(typename pcl::PointCloud<PointT>::Ptr& inliers) {
 	if (inliers && isPublishingInliers()) {
-		sensor_msgs::PointCloud2Ptr inliers_msg(new sensor_msgs::PointCloud2());
-		pcl::toROSMsg(*inliers, *inliers_msg);
-		inliers_publisher_.publish(inliers_msg);
+		pointcloud_conversions::publishPointCloudAsynchronously<PointT>(inliers, inliers_publisher_, inliers->header.frame_id, false, "inliers");
 	} else {
 		if (!inliers_publisher_.getTopic().empty()) {
 			ROS_DEBUG_STREAM("Avoiding publishing pointcloud on topic " << inliers_publisher_.getTopic() << " because there is no subscribers");
@@ -23,6 +23,8 @@
 
 // project includes
 #include <dynamic_robot_localization/common/configurable_object.h>
+#include <dynamic_robot_localization/common/memory_usage.h>
+#include <dynamic_robot_localization/common/pointcloud_conversions.h>
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 namespace dynamic_robot_localization {
@@ -50,10 +52,14 @@ class OutlierDetector : public ConfigurableObject {
 		virtual void setupConfigurationFromParameterServer(ros::NodeHandlePtr& node_handle, ros::NodeHandlePtr& private_node_handle, const std::string& configuration_namespace);
 		virtual size_t detectOutliers(typename pcl::search::KdTree<PointT>::Ptr reference_pointcloud_search_method, const pcl::PointCloud<PointT>& ambient_pointcloud,
 				typename pcl::PointCloud<PointT>::Ptr& outliers_out, typename pcl::PointCloud<PointT>::Ptr& inliers_out, double& root_mean_square_error_of_inliers_out) = 0;
+		/*! Called when the reference point cloud that will be given (through its search method) to detectOutliers changes. */
+		virtual void setupReferenceCloud(const typename pcl::PointCloud<PointT>::ConstPtr& reference_pointcloud) {}
 		bool isPublishingOutliers();
 		bool isPublishingInliers();
 		void publishOutliers(typename pcl::PointCloud<PointT>::Ptr& outliers);
 		void publishInliers(typename pcl::PointCloud<PointT>::Ptr& inliers);
+		/*! Accounts the buffers kept between detections (the detected inliers / outliers are owned by the caller). */
+		virtual size_t accountMemoryUsage(MemoryUsage& memory_usage) { return memory_usage.addBytes(this, sizeof(*this)); }
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </OutlierDetector-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <gets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
@@ -25,6 +25,14 @@ void RegistrationCovarianceEstimator<PointT>::setupConfigurationFromParameterSer
 	private_node_handle->param(configuration_namespace + "sensor_std_dev_noise", sensor_std_dev_noise_, 0.01);
 	private_node_handle->param(configuration_namespace + "use_reciprocal_correspondences", use_reciprocal_correspondences_, false);
 
+	std::string covariance_formulation;
+	private_node_handle->param(configuration_namespace + "covariance_formulation", covariance_formulation, std::string("StreamingBlockAccumulation"));
+	if (covariance_formulation == "DenseJacobian") {
+		covariance_formulation_ = DenseJacobian;
+	} else {
+		covariance_formulation_ = StreamingBlockAccumulation;
+	}
+
 	int number_of_random_sampples;
 	private_node_handle->param(configuration_namespace + "random_sample/number_of_random_samples", number_of_random_sampples, -1);
 	if (number_of_random_sampples > 0) {
@@ -70,6 +78,19 @@ void RegistrationCovarianceEstimator<PointT>::setReferenceCloud(const typename p
 }
 
 
+template<typename PointT>
+size_t RegistrationCovarianceEstimator<PointT>::accountMemoryUsage(MemoryUsage& memory_usage) {
+	size_t bytes = memory_usage.addBytes(this, sizeof(*this));
+	if (correspondence_estimation_ && correspondence_estimation_->getInputTarget()) {
+		bytes += memory_usage.addPointCloud(correspondence_estimation_->getInputTarget().get()) + memory_usage.addKdTree(correspondence_estimation_->getSearchMethodTarget().get());
+		if (correspondence_estimation_->requiresTargetNormals()) { // pcl::PCLPointCloud2 copy of the reference point cloud given to setTargetNormals
+			bytes += memory_usage.addBytes(correspondence_estimation_.get(), correspondence_estimation_->getInputTarget()->size() * sizeof(PointT));
+		}
+	}
+	return bytes;
+}
+
+
 template<typename PointT>
 bool RegistrationCovarianceEstimator<PointT>::computeRegistrationCovariance(const typename pcl::PointCloud<PointT>::Ptr& cloud, const typename pcl::search::KdTree<PointT>::Ptr& search_method,
 		const Eigen::Matrix4f& registration_corrections, const Eigen::Transform<float, 3, Eigen::Affine>& transform_from_map_cloud_data_to_base_link,
@@ -115,17 +136,18 @@ bool RegistrationCovarianceEstimator<PointT>::computeRegistrationCovariance(cons
 
 	ROS_DEBUG_STREAM("Computing covariance for " << correspondences->size() << " correspondences");
 
-	pcl::PointCloud<PointT> reference_cloud_correspondences;
-	pcl::PointCloud<PointT> ambient_cloud_correspondences;
+	typename pcl::PointCloud<PointT>::Ptr reference_cloud_correspondences(new pcl::PointCloud<PointT>());
+	typename pcl::PointCloud<PointT>::Ptr ambient_cloud_correspondences(new pcl::PointCloud<PointT>());
 
-	pcl::transformPointCloudWithNormals(reference_cloud_correspondences_map_frame, reference_cloud_correspondences, transform_from_map_cloud_data_to_base_link);
-	pcl::transformPointCloudWithNormals(ambient_cloud_correspondences_map_frame, ambient_cloud_correspondences, transform_from_map_cloud_data_to_base_link);
+	pcl::transformPointCloudWithNormals(reference_cloud_correspondences_map_frame, *reference_cloud_correspondences, transform_from_map_cloud_data_to_base_link);
+	pcl::transformPointCloudWithNormals(ambient_cloud_correspondences_map_frame, *ambient_cloud_correspondences, transform_from_map_cloud_data_to_base_link);
 
-	reference_cloud_correspondences.header = cloud->header;
-	ambient_cloud_correspondences.header = cloud->header;
-	reference_cloud_correspondences.header.frame_id = base_link_frame_id;
-	ambient_cloud_correspondences.header.frame_id = base_link_frame_id;
+	reference_cloud_correspondences->header = cloud->header;
+	ambient_cloud_correspondences->header = cloud->header;
+	reference_cloud_correspondences->header.frame_id = base_link_frame_id;
+	ambient_cloud_correspondences->header.frame_id = base_link_frame_id;
 
+	// the correspondences clouds are shared with the publication thread, because they are not changed after this point
 	if (cloud_publisher_reference_cloud_) {
 		cloud_publisher_reference_cloud_->publishPointCloud(reference_cloud_correspondences);
 	}
@@ -134,12 +156,19 @@ bool RegistrationCovarianceEstimator<PointT>::computeRegistrationCovariance(cons
 		cloud_publisher_ambient_cloud_->publishPointCloud(ambient_cloud_correspondences);
 	}
 
-	return computeRegistrationCovariance(reference_cloud_correspondences, ambient_cloud_correspondences, registration_corrections, covariance_out, sensor_std_dev_noise_);
+	return computeRegistrationCovariance(*reference_cloud_correspondences, *ambient_cloud_correspondences, registration_corrections, covariance_out, sensor_std_dev_noise_);
 }
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </RegistrationCovarianceEstimator-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 // =============================================================================  </public-section>  ===========================================================================
 
 // =============================================================================   <protected-section>   =======================================================================
+template<typename PointT>
+void RegistrationCovarianceEstimator<PointT>::computeCovarianceFromAccumulatedBlocks(const Eigen::Matrix<double, 6, 6>& d2J_dX2, const Eigen::Matrix<double, 6, 6>& d2J_dZdX_squared_blocks_sum,
+		double sensor_std_dev_noise, Eigen::MatrixXd& covariance_out) {
+	Eigen::FullPivLU< Eigen::Matrix<double, 6, 6> > lu(d2J_dX2);
+	Eigen::Matrix<double, 6, 6> d2J_dX2_inverse = lu.inverse();
+	covariance_out = (sensor_std_dev_noise * sensor_std_dev_noise) * (d2J_dX2_inverse * d2J_dZdX_squared_blocks_sum * d2J_dX2_inverse);
+}
 // =============================================================================   </protected-section>  =======================================================================
 
 
@@ -40,10 +40,10 @@ bool RegistrationCovariancePointToPlane3D<PointT>::computeRegistrationCovariance
 	double cos_yaw = cos(correction_yaw);
 	double sin_yaw = sin(correction_yaw);
 
-	Eigen::MatrixXd d2J_dX2(6, 6);
-	d2J_dX2 = Eigen::MatrixXd::Zero(6, 6);
+	Eigen::Matrix<double, 6, 6> d2J_dX2 = Eigen::Matrix<double, 6, 6>::Zero();
 	size_t ambient_cloud_orrespondences_size = ambient_cloud_orrespondences.points.size();
 
+	#pragma omp parallel for reduction(+: d2J_dX2)
 	for (size_t s = 0; s < ambient_cloud_orrespondences_size; ++s) {
 		double pix = ambient_cloud_orrespondences[s].x;
 		double piy = ambient_cloud_orrespondences[s].y;
@@ -100,12 +100,19 @@ bool RegistrationCovariancePointToPlane3D<PointT>::computeRegistrationCovariance
 		d2J_dcda = (2 * niy * (piz * (sin_yaw * sin_roll + cos_yaw * cos_roll * sin_pitch) - piy * (cos_roll * sin_yaw - cos_yaw * sin_pitch * sin_roll) + pix * cos_yaw * cos_pitch) - 2 * nix * (piy * (cos_yaw * cos_roll + sin_yaw * sin_pitch * sin_roll) - piz * (cos_yaw * sin_roll - cos_roll * sin_yaw * sin_pitch) + pix * cos_pitch * sin_yaw)) * (nix * (piy * (sin_yaw * sin_roll + cos_yaw * cos_roll * sin_pitch) + piz * (cos_roll * sin_yaw - cos_yaw * sin_pitch * sin_roll)) - niy * (piy * (cos_yaw * sin_roll - cos_roll * sin_yaw * sin_pitch) + piz * (cos_yaw * cos_roll + sin_yaw * sin_pitch * sin_roll)) + niz * (piy * cos_pitch * cos_roll - piz * cos_pitch * sin_roll)) + (2 * nix * (piy * (cos_yaw * sin_roll - cos_roll * sin_yaw * sin_pitch) + piz * (cos_yaw * cos_roll + sin_yaw * sin_pitch * sin_roll)) + 2 * niy * (piy * (sin_yaw * sin_roll + cos_yaw * cos_roll * sin_pitch) + piz * (cos_roll * sin_yaw - cos_yaw * sin_pitch * sin_roll))) * (nix * (correction_x - qix - piy * (cos_roll * sin_yaw - cos_yaw * sin_pitch * sin_roll) + piz * (sin_yaw * sin_roll + cos_yaw * cos_roll * sin_pitch) + pix * cos_yaw * cos_pitch) + niy * (correction_y - qiy + piy * (cos_yaw * cos_roll + sin_yaw * sin_pitch * sin_roll) - piz * (cos_yaw * sin_roll - cos_roll * sin_yaw * sin_pitch) + pix * cos_pitch * sin_yaw) + niz * (correction_z - qiz - pix * sin_pitch + piz * cos_pitch * cos_roll + piy * cos_pitch * sin_roll));
 		d2J_dadc = (niy * (piz * (sin_yaw * sin_roll + cos_yaw * cos_roll * sin_pitch) - piy * (cos_roll * sin_yaw - cos_yaw * sin_pitch * sin_roll) + pix * cos_yaw * cos_pitch) - nix * (piy * (cos_yaw * cos_roll + sin_yaw * sin_pitch * sin_roll) - piz * (cos_yaw * sin_roll - cos_roll * sin_yaw * sin_pitch) + pix * cos_pitch * sin_yaw)) * (2 * nix * (piy * (sin_yaw * sin_roll + cos_yaw * cos_roll * sin_pitch) + piz * (cos_roll * sin_yaw - cos_yaw * sin_pitch * sin_roll)) - 2 * niy * (piy * (cos_yaw * sin_roll - cos_roll * sin_yaw * sin_pitch) + piz * (cos_yaw * cos_roll + sin_yaw * sin_pitch * sin_roll)) + 2 * niz * (piy * cos_pitch * cos_roll - piz * cos_pitch * sin_roll)) + (2 * nix * (piy * (cos_yaw * sin_roll - cos_roll * sin_yaw * sin_pitch) + piz * (cos_yaw * cos_roll + sin_yaw * sin_pitch * sin_roll)) + 2 * niy * (piy * (sin_yaw * sin_roll + cos_yaw * cos_roll * sin_pitch) + piz * (cos_roll * sin_yaw - cos_yaw * sin_pitch * sin_roll))) * (nix * (correction_x - qix - piy * (cos_roll * sin_yaw - cos_yaw * sin_pitch * sin_roll) + piz * (sin_yaw * sin_roll + cos_yaw * cos_roll * sin_pitch) + pix * cos_yaw * cos_pitch) + niy * (correction_y - qiy + piy * (cos_yaw * cos_roll + sin_yaw * sin_pitch * sin_roll) - piz * (cos_yaw * sin_roll - cos_roll * sin_yaw * sin_pitch) + pix * cos_pitch * sin_yaw) + niz * (correction_z - qiz - pix * sin_pitch + piz * cos_pitch * cos_roll + piy * cos_pitch * sin_roll));
 
-		Eigen::MatrixXd d2J_dX2_temp(6, 6);
+		Eigen::Matrix<double, 6, 6> d2J_dX2_temp;
 		d2J_dX2_temp << d2J_dx2, d2J_dydx, d2J_dzdx, d2J_dadx, d2J_dbdx, d2J_dzdx, d2J_dxdy, d2J_dy2, d2J_dzdy, d2J_dady, d2J_dbdy, d2J_dcdy, d2J_dxdz, d2J_dydz, d2J_dz2, d2J_dadz, d2J_dbdz, d2J_dcdz, d2J_dxda, d2J_dyda, d2J_dzda, d2J_da2, d2J_dbda, d2J_dcda, d2J_dxdb, d2J_dydb, d2J_dzdb, d2J_dadb, d2J_db2, d2J_dcdb, d2J_dxdc, d2J_dydc, d2J_dzdc, d2J_dadc, d2J_dbdc, d2J_dc2;
 		d2J_dX2 = d2J_dX2 + d2J_dX2_temp;
 	}
 
-	Eigen::MatrixXd d2J_dZdX(6, 6 * ambient_cloud_orrespondences_size);
+	bool use_dense_jacobian = (this->covariance_formulation_ == RegistrationCovarianceEstimator<PointT>::DenseJacobian);
+	Eigen::MatrixXd d2J_dZdX;
+	if (use_dense_jacobian) {
+		d2J_dZdX.resize(6, 6 * ambient_cloud_orrespondences_size);
+	}
+
+	Eigen::Matrix<double, 6, 6> d2J_dZdX_squared_blocks_sum = Eigen::Matrix<double, 6, 6>::Zero();
+	#pragma omp parallel for reduction(+: d2J_dZdX_squared_blocks_sum)
 	for (size_t k = 0; k < ambient_cloud_orrespondences_size; ++k) {
 		double pix = ambient_cloud_orrespondences.points[k].x;
 		double piy = ambient_cloud_orrespondences.points[k].y;
@@ -118,7 +125,7 @@ bool RegistrationCovariancePointToPlane3D<PointT>::computeRegistrationCovariance
 		double niy = reference_cloud_correspondences[k].normal_y;
 		double niz = reference_cloud_correspondences[k].normal_z;
 
-		Eigen::MatrixXd d2J_dZdX_temp(6, 6);
+		Eigen::Matrix<double, 6, 6> d2J_dZdX_temp;
 		double d2J_dpix_dx, d2J_dpiy_dx, d2J_dpiz_dx, d2J_dqix_dx, d2J_dqiy_dx, d2J_dqiz_dx, d2J_dpix_dy, d2J_dpiy_dy, d2J_dpiz_dy, d2J_dqix_dy, d2J_dqiy_dy, d2J_dqiz_dy, d2J_dpix_dz, d2J_dpiy_dz, d2J_dpiz_dz, d2J_dqix_dz, d2J_dqiy_dz, d2J_dqiz_dz, d2J_dpix_da, d2J_dpiy_da, d2J_dpiz_da, d2J_dqix_da, d2J_dqiy_da, d2J_dqiz_da, d2J_dpix_db, d2J_dpiy_db, d2J_dpiz_db, d2J_dqix_db, d2J_dqiy_db, d2J_dqiz_db, d2J_dpix_dc, d2J_dpiy_dc, d2J_dpiz_dc, d2J_dqix_dc, d2J_dqiy_dc, d2J_dqiz_dc;
 		d2J_dpix_dx = 2 * nix * (nix * cos_yaw * cos_pitch - niz * sin_pitch + niy * cos_pitch * sin_yaw);
 		d2J_dpix_dy = 2 * niy * (nix * cos_yaw * cos_pitch - niz * sin_pitch + niy * cos_pitch * sin_yaw);
@@ -157,14 +164,22 @@ bool RegistrationCovariancePointToPlane3D<PointT>::computeRegistrationCovariance
 		d2J_dqiz_db = -niz * (2 * niy * (piz * cos_pitch * cos_roll * sin_yaw - pix * sin_yaw * sin_pitch + piy * cos_pitch * sin_yaw * sin_roll) - 2 * niz * (pix * cos_pitch + piz * cos_roll * sin_pitch + piy * sin_pitch * sin_roll) + 2 * nix * (piz * cos_yaw * cos_pitch * cos_roll - pix * cos_yaw * sin_pitch + piy * cos_yaw * cos_pitch * sin_roll));
 		d2J_dqiz_dc =-niz * (2 * nix * (piy * (sin_yaw * sin_roll + cos_yaw * cos_roll * sin_pitch) + piz * (cos_roll * sin_yaw - cos_yaw * sin_pitch * sin_roll)) - 2 * niy * (piy * (cos_yaw * sin_roll - cos_roll * sin_yaw * sin_pitch) + piz * (cos_yaw * cos_roll + sin_yaw * sin_pitch * sin_roll)) + 2 * niz * (piy * cos_pitch * cos_roll - piz * cos_pitch * sin_roll));
 		d2J_dZdX_temp << d2J_dpix_dx, d2J_dpiy_dx, d2J_dpiz_dx, d2J_dqix_dx, d2J_dqiy_dx, d2J_dqiz_dx, d2J_dpix_dy, d2J_dpiy_dy, d2J_dpiz_dy, d2J_dqix_dy, d2J_dqiy_dy, d2J_dqiz_dy, d2J_dpix_dz, d2J_dpiy_dz, d2J_dpiz_dz, d2J_dqix_dz, d2J_dqiy_dz, d2J_dqiz_dz, d2J_dpix_da, d2J_dpiy_da, d2J_dpiz_da, d2J_dqix_da, d2J_dqiy_da, d2J_dqiz_da, d2J_dpix_db, d2J_dpiy_db, d2J_dpiz_db, d2J_dqix_db, d2J_dqiy_db, d2J_dqiz_db, d2J_dpix_dc, d2J_dpiy_dc, d2J_dpiz_dc, d2J_dqix_dc, d2J_dqiy_dc, d2J_dqiz_dc;
-		d2J_dZdX.block<6, 6>(0, 6 * k) = d2J_dZdX_temp;
+		if (use_dense_jacobian) {
+			d2J_dZdX.block<6, 6>(0, 6 * k) = d2J_dZdX_temp;
+		} else {
+			d2J_dZdX_squared_blocks_sum.noalias() += d2J_dZdX_temp * d2J_dZdX_temp.transpose();
+		}
 	}
 
-	Eigen::MatrixXd cov_z(6 * ambient_cloud_orrespondences_size, 6 * ambient_cloud_orrespondences_size);
-	cov_z = sensor_std_dev_noise * sensor_std_dev_noise * Eigen::MatrixXd::Identity(6 * ambient_cloud_orrespondences_size, 6 * ambient_cloud_orrespondences_size);
-	Eigen::FullPivLU<Eigen::MatrixXd> lu(d2J_dX2);
-	Eigen::MatrixXd d2J_dX2_inverse = lu.inverse();
-	covariance_out = d2J_dX2_inverse * d2J_dZdX * cov_z * d2J_dZdX.transpose() * d2J_dX2_inverse;
+	if (use_dense_jacobian) {
+		Eigen::MatrixXd cov_z(6 * ambient_cloud_orrespondences_size, 6 * ambient_cloud_orrespondences_size);
+		cov_z = sensor_std_dev_noise * sensor_std_dev_noise * Eigen::MatrixXd::Identity(6 * ambient_cloud_orrespondences_size, 6 * ambient_cloud_orrespondences_size);
+		Eigen::FullPivLU<Eigen::MatrixXd> lu(d2J_dX2);
+		Eigen::MatrixXd d2J_dX2_inverse = lu.inverse();
+		covariance_out = d2J_dX2_inverse * d2J_dZdX * cov_z * d2J_dZdX.transpose() * d2J_dX2_inverse;
+	} else {
+		this->computeCovarianceFromAccumulatedBlocks(d2J_dX2, d2J_dZdX_squared_blocks_sum, sensor_std_dev_noise, covariance_out);
+	}
 
 	return true;
 }
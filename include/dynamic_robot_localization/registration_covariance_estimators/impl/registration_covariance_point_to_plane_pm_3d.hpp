@@ -28,10 +28,16 @@ bool RegistrationCovariancePointToPlanePM3D<PointT>::computeRegistrationCovarian
 
 	size_t number_points = std::min(reference_cloud_correspondences.size(), ambient_cloud_orrespondences.size());
 
+	bool use_dense_jacobian = (this->covariance_formulation_ == RegistrationCovarianceEstimator<PointT>::DenseJacobian);
 	covariance_out = Eigen::MatrixXd(Eigen::MatrixXd::Zero(6,6));
-	Eigen::MatrixXd J_hessian(Eigen::MatrixXd::Zero(6,6));
-	Eigen::MatrixXd d2J_dReadingdX(Eigen::MatrixXd::Zero(6, number_points));
-	Eigen::MatrixXd d2J_dReferencedX(Eigen::MatrixXd::Zero(6, number_points));
+	Eigen::Matrix<double, 6, 6> J_hessian(Eigen::Matrix<double, 6, 6>::Zero());
+	Eigen::Matrix<double, 6, 6> d2J_dZdX_squared_blocks_sum(Eigen::Matrix<double, 6, 6>::Zero());
+	Eigen::MatrixXd d2J_dReadingdX;
+	Eigen::MatrixXd d2J_dReferencedX;
+	if (use_dense_jacobian) {
+		d2J_dReadingdX = Eigen::MatrixXd::Zero(6, number_points);
+		d2J_dReferencedX = Eigen::MatrixXd::Zero(6, number_points);
+	}
 
 	double correction_roll, correction_pitch, correction_yaw;
 	math_utils::getRollPitchYawFromMatrix(registration_corrections, correction_roll, correction_pitch, correction_yaw);
@@ -40,16 +46,17 @@ bool RegistrationCovariancePointToPlanePM3D<PointT>::computeRegistrationCovarian
 	double correction_y = registration_corrections(1,3);
 	double correction_z = registration_corrections(2,3);
 
-	Eigen::Matrix<double, Eigen::Dynamic, 1> tmp_vector_6(Eigen::Matrix<double, Eigen::Dynamic, 1>::Zero(6));
-
-	int valid_points_count = 0;
-	double reference_point_normal_x = 1.0;
-	double reference_point_normal_y = 1.0;
-	double reference_point_normal_z = 1.0;
+	int valid_points_count = (int)number_points;
 
+	#pragma omp parallel for reduction(+: J_hessian, d2J_dZdX_squared_blocks_sum)
 	for(size_t i = 0; i < number_points; ++i) {
 		const PointT& ambient_point = ambient_cloud_orrespondences[i];
 		const PointT& reference_point = reference_cloud_correspondences[i];
+		Eigen::Matrix<double, 6, 1> tmp_vector_6;
+
+		double reference_point_normal_x = 1.0;
+		double reference_point_normal_y = 1.0;
+		double reference_point_normal_z = 1.0;
 
 		if (use_normals_) {
 			reference_point_normal_x = reference_point.normal_x;
@@ -85,24 +92,34 @@ bool RegistrationCovariancePointToPlanePM3D<PointT>::computeRegistrationCovarian
 		tmp_vector_6 << reference_point_normal_x, reference_point_normal_y, reference_point_normal_z, reading_range * n_correction_roll, reading_range * n_correction_pitch, reading_range * n_correction_yaw;
 		J_hessian += tmp_vector_6 * tmp_vector_6.transpose();
 		tmp_vector_6 << reference_point_normal_x * N_reading, reference_point_normal_y * N_reading, reference_point_normal_z * N_reading, n_correction_roll * (E + reading_range * N_reading), n_correction_pitch * (E + reading_range * N_reading), n_correction_yaw * (E + reading_range * N_reading);
-		d2J_dReadingdX.block(0,valid_points_count,6,1) = tmp_vector_6;
+		if (use_dense_jacobian) {
+			d2J_dReadingdX.block(0,i,6,1) = tmp_vector_6;
+		} else {
+			d2J_dZdX_squared_blocks_sum.noalias() += tmp_vector_6 * tmp_vector_6.transpose();
+		}
 		tmp_vector_6 << reference_point_normal_x * N_reference, reference_point_normal_y * N_reference, reference_point_normal_z * N_reference, reference_range * n_correction_roll * N_reference, reference_range * n_correction_pitch * N_reference, reference_range * n_correction_yaw * N_reference;
-		d2J_dReferencedX.block(0,valid_points_count,6,1) = tmp_vector_6;
-
-		++valid_points_count;
+		if (use_dense_jacobian) {
+			d2J_dReferencedX.block(0,i,6,1) = tmp_vector_6;
+		} else {
+			d2J_dZdX_squared_blocks_sum.noalias() += tmp_vector_6 * tmp_vector_6.transpose();
+		}
 	}
 
-	Eigen::MatrixXd d2J_dZdX(Eigen::MatrixXd::Zero(6, 2 * valid_points_count));
-	d2J_dZdX.block(0,0,6,valid_points_count) = d2J_dReadingdX.block(0,0,6,valid_points_count);
-	d2J_dZdX.block(0,valid_points_count,6,valid_points_count) = d2J_dReferencedX.block(0,0,6,valid_points_count);
+	if (use_dense_jacobian) {
+		Eigen::MatrixXd d2J_dZdX(Eigen::MatrixXd::Zero(6, 2 * valid_points_count));
+		d2J_dZdX.block(0,0,6,valid_points_count) = d2J_dReadingdX.block(0,0,6,valid_points_count);
+		d2J_dZdX.block(0,valid_points_count,6,valid_points_count) = d2J_dReferencedX.block(0,0,6,valid_points_count);
 
-//	Eigen::MatrixXd inv_J_hessian = J_hessian.inverse();
-	Eigen::FullPivLU<Eigen::MatrixXd> lu(J_hessian);
-	Eigen::MatrixXd inv_J_hessian = lu.inverse();
+	//	Eigen::MatrixXd inv_J_hessian = J_hessian.inverse();
+		Eigen::FullPivLU<Eigen::MatrixXd> lu(J_hessian);
+		Eigen::MatrixXd inv_J_hessian = lu.inverse();
 
-	covariance_out = d2J_dZdX * d2J_dZdX.transpose();
-	covariance_out = inv_J_hessian * covariance_out * inv_J_hessian;
-	covariance_out = (sensor_std_dev_noise * sensor_std_dev_noise) * covariance_out;
+		covariance_out = d2J_dZdX * d2J_dZdX.transpose();
+		covariance_out = inv_J_hessian * covariance_out * inv_J_hessian;
+		covariance_out = (sensor_std_dev_noise * sensor_std_dev_noise) * covariance_out;
+	} else {
+		this->computeCovarianceFromAccumulatedBlocks(J_hessian, d2J_dZdX_squared_blocks_sum, sensor_std_dev_noise, covariance_out);
+	}
 
 	return true;
 }
@@ -27,14 +27,22 @@
 // external libs includes
 #include <Eigen/Core>
 #include <Eigen/Geometry>
+#include <Eigen/LU>
 
 // project includes
 #include <dynamic_robot_localization/common/configurable_object.h>
+#include <dynamic_robot_localization/common/memory_usage.h>
 #include <dynamic_robot_localization/cloud_filters/random_sample.h>
 #include <dynamic_robot_localization/common/cloud_publisher.h>
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 namespace dynamic_robot_localization {
+
+#ifdef _OPENMP
+// allows the accumulation of the 6 x 6 covariance blocks using OpenMP reductions
+#pragma omp declare reduction(+ : Eigen::Matrix<double, 6, 6> : omp_out += omp_in) initializer(omp_priv = Eigen::Matrix<double, 6, 6>::Zero())
+#endif
+
 // ####################################################################   RegistrationCovarianceEstimator   ####################################################################
 /**
  * \brief Description...
@@ -48,8 +56,15 @@ class RegistrationCovarianceEstimator : public ConfigurableObject {
 		using ConstPtr = std::shared_ptr< const RegistrationCovarianceEstimator<PointT> >;
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </usings>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <enums>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		enum CovarianceFormulation {
+			DenseJacobian,					// builds the 6 x 6N d2J_dZdX matrix and the 6N x 6N sensor noise matrix (memory and time quadratic in the number of correspondences)
+			StreamingBlockAccumulation		// accumulates the 6 x 6 d2J_dZdX * d2J_dZdX^T block of each correspondence (same result in linear time and constant extra memory)
+		};
+		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </enums>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <constructors-destructor>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
-		RegistrationCovarianceEstimator() : correspondence_distance_threshold_(0.05), sensor_std_dev_noise_(0.01), use_reciprocal_correspondences_(false) {}
+		RegistrationCovarianceEstimator() : correspondence_distance_threshold_(0.05), sensor_std_dev_noise_(0.01), use_reciprocal_correspondences_(false), covariance_formulation_(StreamingBlockAccumulation) {}
 		virtual ~RegistrationCovarianceEstimator() {}
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </constructors-destructor>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -61,22 +76,34 @@ class RegistrationCovarianceEstimator : public ConfigurableObject {
 		virtual bool computeRegistrationCovariance(const pcl::PointCloud<PointT>& reference_cloud_correspondences_map_frame,
 				const pcl::PointCloud<PointT>& ambient_cloud_orrespondences_map_frame, const Eigen::Matrix4f& registration_corrections,
 				Eigen::MatrixXd& covariance_out, double sensor_std_dev_noise = 0.01) = 0;
+		/*! Accounts the reference point cloud and k-d tree used by the correspondence estimation (usually shared with the matchers) and the copy of the reference normals. */
+		size_t accountMemoryUsage(MemoryUsage& memory_usage);
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </RegistrationCovarianceEstimator-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <gets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		inline CovarianceFormulation getCovarianceFormulation() const { return covariance_formulation_; }
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </gets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <sets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+		inline void setCovarianceFormulation(CovarianceFormulation covariance_formulation) { covariance_formulation_ = covariance_formulation; }
 		// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </sets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 	// ========================================================================   </public-section>  ===========================================================================
 
 	// ========================================================================   <protected-section>   ========================================================================
 	protected:
+		/*!
+		 * Computes d2J_dX2^-1 * d2J_dZdX * cov_z * d2J_dZdX^T * d2J_dX2^-1 with cov_z = sensor_std_dev_noise^2 * I,
+		 * given the sum of the d2J_dZdX * d2J_dZdX^T blocks of all correspondences
+		 */
+		static void computeCovarianceFromAccumulatedBlocks(const Eigen::Matrix<double, 6, 6>& d2J_dX2, const Eigen::Matrix<double, 6, 6>& d2J_dZdX_squared_blocks_sum,
+				double sensor_std_dev_noise, Eigen::MatrixXd& covariance_out);
+
 		typename pcl::registration::CorrespondenceEstimationBase<PointT, PointT>::Ptr correspondence_estimation_;
 		typename RandomSample<PointT>::Ptr random_sample_filter_;
 		double correspondence_distance_threshold_;
 		double sensor_std_dev_noise_;
 		bool use_reciprocal_correspondences_;
+		CovarianceFormulation covariance_formulation_;
 		typename CloudPublisher<PointT>::Ptr cloud_publisher_reference_cloud_;
 		typename CloudPublisher<PointT>::Ptr cloud_publisher_ambient_cloud_;
 	// ========================================================================   </protected-section>  ========================================================================
@@ -0,0 +1,189 @@
+/**\file async_cloud_publisher.cpp
+ * \brief Description...
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+#include <dynamic_robot_localization/common/async_cloud_publisher.h>
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+namespace dynamic_robot_localization {
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <imports>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </imports>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+// =============================================================================  <public-section>  ============================================================================
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <constructors-destructor>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+AsyncCloudPublisher& AsyncCloudPublisher::getInstance() {
+	static AsyncCloudPublisher async_cloud_publisher;
+	return async_cloud_publisher;
+}
+
+
+AsyncCloudPublisher::AsyncCloudPublisher() :
+	queued_bytes_(0),
+	maximum_queue_size_(8),
+	maximum_queued_bytes_(64 * 1024 * 1024),
+	number_of_dropped_messages_(0),
+	running_(false) {}
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </constructors-destructor>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <AsyncCloudPublisher-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+bool AsyncCloudPublisher::s_isPublishing(const ros::Publisher& publisher, bool publish_only_if_there_is_subscribers) {
+	return !publisher.getTopic().empty() && (!publish_only_if_there_is_subscribers || publisher.getNumSubscribers() > 0);
+}
+
+
+void AsyncCloudPublisher::start() {
+	std::lock_guard<std::mutex> lock(mutex_);
+	if (running_) { return; }
+	running_ = true;
+	publication_thread_ = std::thread(&AsyncCloudPublisher::publicationWorker, this);
+}
+
+
+void AsyncCloudPublisher::stop() {
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (!running_) { return; }
+		running_ = false;
+		requests_.clear();
+		queued_bytes_ = 0;
+	}
+	condition_variable_.notify_all();
+	if (publication_thread_.joinable()) { publication_thread_.join(); }
+}
+
+
+bool AsyncCloudPublisher::isRunning() {
+	std::lock_guard<std::mutex> lock(mutex_);
+	return running_;
+}
+
+
+bool AsyncCloudPublisher::publish(const ros::Publisher& publisher, const MessageBuilder& message_builder, size_t estimated_size_in_bytes) {
+	if (publisher.getTopic().empty()) { return false; }
+
+	bool dropped_messages = false;
+	{
+		std::unique_lock<std::mutex> lock(mutex_);
+		if (!running_) {
+			lock.unlock();
+			sensor_msgs::PointCloud2Ptr msg = message_builder();
+			if (msg) { publisher.publish(msg); }
+			return true;
+		}
+
+		bool replaced_request = false;
+		for (size_t i = 0; i < requests_.size(); ++i) {
+			if (requests_[i].publisher.getTopic() == publisher.getTopic()) {
+				queued_bytes_ -= requests_[i].estimated_size_in_bytes;
+				queued_bytes_ += estimated_size_in_bytes;
+				requests_[i].message_builder = message_builder;
+				requests_[i].estimated_size_in_bytes = estimated_size_in_bytes;
+				++number_of_dropped_messages_;
+				replaced_request = true;
+				dropped_messages = true;
+				break;
+			}
+		}
+
+		if (!replaced_request) {
+			requests_.push_back(PublicationRequest { publisher, message_builder, estimated_size_in_bytes });
+			queued_bytes_ += estimated_size_in_bytes;
+		}
+
+		std::uint64_t number_of_dropped_messages_before = number_of_dropped_messages_;
+		dropExcessRequests();
+		dropped_messages = dropped_messages || number_of_dropped_messages_ != number_of_dropped_messages_before;
+	}
+	condition_variable_.notify_one();
+
+	return !dropped_messages;
+}
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </AsyncCloudPublisher-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <gets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+size_t AsyncCloudPublisher::getQueueSize() {
+	std::lock_guard<std::mutex> lock(mutex_);
+	return requests_.size();
+}
+
+
+size_t AsyncCloudPublisher::getQueuedBytes() {
+	std::lock_guard<std::mutex> lock(mutex_);
+	return queued_bytes_;
+}
+
+
+std::uint64_t AsyncCloudPublisher::getNumberOfDroppedMessages() {
+	std::lock_guard<std::mutex> lock(mutex_);
+	return number_of_dropped_messages_;
+}
+
+
+size_t AsyncCloudPublisher::getMaximumQueueSize() {
+	std::lock_guard<std::mutex> lock(mutex_);
+	return maximum_queue_size_;
+}
+
+
+size_t AsyncCloudPublisher::getMaximumQueuedBytes() {
+	std::lock_guard<std::mutex> lock(mutex_);
+	return maximum_queued_bytes_;
+}
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </gets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <sets>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+void AsyncCloudPublisher::setMaximumQueueSize(size_t maximum_queue_size) {
+	std::lock_guard<std::mutex> lock(mutex_);
+	maximum_queue_size_ = maximum_queue_size > 0 ? maximum_queue_size : 1;
+	dropExcessRequests();
+}
+
+
+void AsyncCloudPublisher::setMaximumQueuedBytes(size_t maximum_queued_bytes) {
+	std::lock_guard<std::mutex> lock(mutex_);
+	maximum_queued_bytes_ = maximum_queued_bytes;
+	dropExcessRequests();
+}
+
+
+void AsyncCloudPublisher::resetNumberOfDroppedMessages() {
+	std::lock_guard<std::mutex> lock(mutex_);
+	number_of_dropped_messages_ = 0;
+}
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </sets>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// =============================================================================  </public-section>  ===========================================================================
+
+// =============================================================================   <protected-section>   =======================================================================
+void AsyncCloudPublisher::dropExcessRequests() {
+	while (!requests_.empty() && (requests_.size() > maximum_queue_size_ || (requests_.size() > 1 && queued_bytes_ > maximum_queued_bytes_))) {
+		queued_bytes_ -= requests_.front().estimated_size_in_bytes;
+		requests_.pop_front();
+		++number_of_dropped_messages_;
+	}
+}
+
+
+void AsyncCloudPublisher::publicationWorker() {
+	while (true) {
+		PublicationRequest request;
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			condition_variable_.wait(lock, [this] { return !running_ || !requests_.empty(); });
+			if (!running_) { return; }
+			request = std::move(requests_.front());
+			requests_.pop_front();
+			queued_bytes_ -= request.estimated_size_in_bytes;
+		}
+
+		sensor_msgs::PointCloud2Ptr msg = request.message_builder();
+		if (msg) { request.publisher.publish(msg); }
+	}
+}
+// =============================================================================   </protected-section>  =======================================================================
+
+} /* namespace dynamic_robot_localization */
@@ -0,0 +1,84 @@
+/**\file configuration_fingerprints.cpp
+ * \brief Description...
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+#include <dynamic_robot_localization/common/configuration_fingerprints.h>
+
+#include <sys/stat.h>
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+namespace dynamic_robot_localization {
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <imports>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </imports>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+// =============================================================================  <public-section>  ============================================================================
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <ConfigurationFingerprints-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+std::uint64_t ConfigurationFingerprints::s_computeHash(const std::string& data, std::uint64_t seed) {
+	// FNV-1a
+	std::uint64_t hash = seed;
+	for (size_t i = 0; i < data.size(); ++i) {
+		hash = (hash ^ (std::uint64_t)(unsigned char)data[i]) * 1099511628211ULL;
+	}
+	return hash;
+}
+
+
+std::uint64_t ConfigurationFingerprints::s_computeParametersFingerprint(XmlRpc::XmlRpcValue& configuration, const std::string& parameters_namespace, std::uint64_t seed) {
+	std::uint64_t fingerprint = s_computeHash(parameters_namespace, seed);
+	XmlRpc::XmlRpcValue* current_namespace = &configuration;
+	size_t name_start = 0;
+	while (name_start <= parameters_namespace.size()) {
+		if (current_namespace->getType() != XmlRpc::XmlRpcValue::TypeStruct) { return fingerprint; }
+
+		size_t name_end = parameters_namespace.find('/', name_start);
+		if (name_end == std::string::npos) { name_end = parameters_namespace.size(); }
+		std::string name = parameters_namespace.substr(name_start, name_end - name_start);
+		name_start = name_end + 1;
+		if (name.empty()) { continue; }
+
+		// inherited parameters (the child namespaces are not included because they belong to other modules)
+		for (XmlRpc::XmlRpcValue::iterator it = current_namespace->begin(); it != current_namespace->end(); ++it) {
+			if (it->second.getType() != XmlRpc::XmlRpcValue::TypeStruct) {
+				fingerprint = s_computeHash(it->first, fingerprint);
+				fingerprint = s_computeHash(it->second.toXml(), fingerprint);
+			}
+		}
+
+		if (!current_namespace->hasMember(name)) { return fingerprint; }
+		current_namespace = &((*current_namespace)[name]);
+	}
+
+	return s_computeHash(current_namespace->toXml(), fingerprint);
+}
+
+
+std::uint64_t ConfigurationFingerprints::s_computeFileFingerprint(const std::string& filepath, std::uint64_t seed) {
+	std::uint64_t fingerprint = s_computeHash(filepath, seed);
+	struct stat file_status;
+	if (stat(filepath.c_str(), &file_status) != 0) { return fingerprint; }
+	fingerprint = (fingerprint ^ (std::uint64_t)file_status.st_size) * 1099511628211ULL;
+	fingerprint = (fingerprint ^ (std::uint64_t)file_status.st_mtim.tv_sec) * 1099511628211ULL;
+	return (fingerprint ^ (std::uint64_t)file_status.st_mtim.tv_nsec) * 1099511628211ULL;
+}
+
+
+bool ConfigurationFingerprints::hasChanged(const std::string& module_name, std::uint64_t fingerprint) const {
+	FingerprintsMap::const_iterator it = fingerprints_.find(module_name);
+	return it == fingerprints_.end() || it->second != fingerprint;
+}
+
+
+bool ConfigurationFingerprints::update(const std::string& module_name, std::uint64_t fingerprint) {
+	bool changed = hasChanged(module_name, fingerprint);
+	fingerprints_[module_name] = fingerprint;
+	return changed;
+}
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </ConfigurationFingerprints-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// =============================================================================  </public-section>  ===========================================================================
+
+} /* namespace dynamic_robot_localization */
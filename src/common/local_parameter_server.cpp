@@ -0,0 +1,374 @@
+/**\file local_parameter_server.cpp
+ * \brief Description...
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+#include <dynamic_robot_localization/common/local_parameter_server.h>
+
+#include <cerrno>
+#include <cstdlib>
+#include <limits>
+#include <sstream>
+#include <unistd.h>
+
+#include <ros/console.h>
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+namespace dynamic_robot_localization {
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <imports>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </imports>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+// =============================================================================  <public-section>  ============================================================================
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <constructors-destructor>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+LocalParameterServer::LocalParameterServer() :
+	server_running_(false),
+	port_(0),
+	parameters_(s_createEmptyStruct()) {
+	registerMethods();
+}
+
+
+LocalParameterServer::~LocalParameterServer() {
+	stop();
+}
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </constructors-destructor>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <LocalParameterServer-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+bool LocalParameterServer::start() {
+	if (server_running_) { return true; }
+	if (!server_.bindAndListen(0)) { return false; }
+	port_ = server_.get_port();
+	server_running_ = true;
+	server_thread_ = std::thread([this]() {
+		while (server_running_) {
+			server_.work(0.1);
+		}
+	});
+	return true;
+}
+
+
+void LocalParameterServer::stop() {
+	if (!server_running_) { return; }
+	server_running_ = false;
+	if (server_thread_.joinable()) { server_thread_.join(); }
+	server_.shutdown();
+}
+
+
+std::string LocalParameterServer::getURI() const {
+	std::stringstream uri;
+	uri << "http://localhost:" << port_ << "/";
+	return uri.str();
+}
+
+
+bool LocalParameterServer::loadYAML(const std::string& filename, const std::string& parameters_namespace, bool overwrite_existing_parameters) {
+	YAML::Node yaml_root;
+	try {
+		yaml_root = YAML::LoadFile(filename);
+	} catch (const YAML::Exception& exception) {
+		ROS_ERROR_STREAM("Failed to load the parameters file " << filename << ": " << exception.what());
+		return false;
+	}
+
+	if (yaml_root.IsNull()) { return true; } // empty file
+	XmlRpc::XmlRpcValue yaml_parameters;
+	if (!yaml_root.IsMap() || !s_convertYAMLNode(yaml_root, yaml_parameters)) {
+		ROS_ERROR_STREAM("The parameters file " << filename << " must have a map of parameters in its root");
+		return false;
+	}
+
+	// wraps the parameters in the structs of the namespace
+	std::vector<std::string> namespace_names = s_splitKey(parameters_namespace);
+	for (std::vector<std::string>::reverse_iterator it = namespace_names.rbegin(); it != namespace_names.rend(); ++it) {
+		XmlRpc::XmlRpcValue parent_namespace = s_createEmptyStruct();
+		parent_namespace[*it] = yaml_parameters;
+		yaml_parameters = parent_namespace;
+	}
+
+	std::lock_guard<std::mutex> lock(parameters_mutex_);
+	s_mergeParameters(parameters_, yaml_parameters, overwrite_existing_parameters);
+	return true;
+}
+
+
+void LocalParameterServer::setParameter(const std::string& key, const XmlRpc::XmlRpcValue& value) {
+	std::vector<std::string> key_names = s_splitKey(key);
+	std::lock_guard<std::mutex> lock(parameters_mutex_);
+	if (key_names.empty()) {
+		if (value.getType() == XmlRpc::XmlRpcValue::TypeStruct) { parameters_ = value; }
+		return;
+	}
+
+	XmlRpc::XmlRpcValue* current_namespace = &parameters_;
+	for (size_t i = 0; i + 1 < key_names.size(); ++i) {
+		XmlRpc::XmlRpcValue& child_namespace = (*current_namespace)[key_names[i]];
+		if (child_namespace.getType() != XmlRpc::XmlRpcValue::TypeStruct) { child_namespace = s_createEmptyStruct(); }
+		current_namespace = &child_namespace;
+	}
+	(*current_namespace)[key_names.back()] = value;
+}
+
+
+bool LocalParameterServer::getParameter(const std::string& key, XmlRpc::XmlRpcValue& value) {
+	std::lock_guard<std::mutex> lock(parameters_mutex_);
+	XmlRpc::XmlRpcValue* parameter = findParameter(s_splitKey(key));
+	if (!parameter) { return false; }
+	value = *parameter;
+	return true;
+}
+
+
+bool LocalParameterServer::hasParameter(const std::string& key) {
+	std::lock_guard<std::mutex> lock(parameters_mutex_);
+	return findParameter(s_splitKey(key)) != nullptr;
+}
+
+
+bool LocalParameterServer::deleteParameter(const std::string& key) {
+	std::vector<std::string> key_names = s_splitKey(key);
+	if (key_names.empty()) { return false; }
+	std::string parameter_name = key_names.back();
+	key_names.pop_back();
+
+	std::lock_guard<std::mutex> lock(parameters_mutex_);
+	XmlRpc::XmlRpcValue* parameter_namespace = findParameter(key_names);
+	if (!parameter_namespace || parameter_namespace->getType() != XmlRpc::XmlRpcValue::TypeStruct || !parameter_namespace->hasMember(parameter_name)) { return false; }
+
+	XmlRpc::XmlRpcValue remaining_parameters = s_createEmptyStruct();
+	for (XmlRpc::XmlRpcValue::iterator it = parameter_namespace->begin(); it != parameter_namespace->end(); ++it) {
+		if (it->first != parameter_name) { remaining_parameters[it->first] = it->second; }
+	}
+	*parameter_namespace = remaining_parameters;
+	return true;
+}
+
+
+bool LocalParameterServer::searchParameter(const std::string& search_namespace, const std::string& key, std::string& found_key) {
+	std::vector<std::string> key_names = s_splitKey(key);
+	if (key_names.empty()) { return false; }
+	if (key[0] == '/') {
+		found_key = key;
+		return hasParameter(key);
+	}
+
+	// same as the ros master: a namespace without the trailing / is the name of a node (whose parent namespace is the first to be searched)
+	std::vector<std::string> namespace_names = s_splitKey(search_namespace);
+	if (!search_namespace.empty() && search_namespace.back() != '/' && !namespace_names.empty()) { namespace_names.pop_back(); }
+
+	std::lock_guard<std::mutex> lock(parameters_mutex_);
+	for (size_t number_of_namespaces = namespace_names.size() + 1; number_of_namespaces-- > 0;) {
+		std::vector<std::string> search_key_names(namespace_names.begin(), namespace_names.begin() + number_of_namespaces);
+		search_key_names.push_back(key_names[0]);
+		if (findParameter(search_key_names)) {
+			found_key.clear();
+			for (size_t i = 0; i < number_of_namespaces; ++i) { found_key += "/" + namespace_names[i]; }
+			for (size_t i = 0; i < key_names.size(); ++i) { found_key += "/" + key_names[i]; }
+			return true;
+		}
+	}
+	return false;
+}
+
+
+std::vector<std::string> LocalParameterServer::getParameterNames() {
+	std::vector<std::string> parameter_names;
+	std::lock_guard<std::mutex> lock(parameters_mutex_);
+	collectParameterNames(parameters_, "", parameter_names);
+	return parameter_names;
+}
+
+
+bool LocalParameterServer::s_convertYAMLNode(const YAML::Node& yaml_node, XmlRpc::XmlRpcValue& value) {
+	if (yaml_node.IsMap()) {
+		value = s_createEmptyStruct();
+		for (YAML::const_iterator it = yaml_node.begin(); it != yaml_node.end(); ++it) {
+			if (it->second.IsNull()) { continue; } // same as rosparam (parameters without value are not set)
+			XmlRpc::XmlRpcValue child_value;
+			if (!s_convertYAMLNode(it->second, child_value)) { return false; }
+			value[it->first.as<std::string>()] = child_value;
+		}
+		return true;
+	}
+
+	if (yaml_node.IsSequence()) {
+		value = XmlRpc::XmlRpcValue();
+		value.setSize((int)yaml_node.size());
+		for (size_t i = 0; i < yaml_node.size(); ++i) {
+			if (!s_convertYAMLNode(yaml_node[i], value[(int)i])) { return false; }
+		}
+		return true;
+	}
+
+	if (!yaml_node.IsScalar()) { return false; }
+
+	std::string scalar = yaml_node.Scalar();
+	if (yaml_node.Tag() == "!") { // quoted strings
+		value = scalar;
+		return true;
+	}
+
+	if (scalar == "true" || scalar == "True" || scalar == "TRUE") { value = true; return true; }
+	if (scalar == "false" || scalar == "False" || scalar == "FALSE") { value = false; return true; }
+
+	if (!scalar.empty()) {
+		char* number_end = nullptr;
+		errno = 0;
+		long int_number = std::strtol(scalar.c_str(), &number_end, 10);
+		if (errno == 0 && *number_end == '\0' && int_number >= std::numeric_limits<int>::min() && int_number <= std::numeric_limits<int>::max()) {
+			value = (int)int_number;
+			return true;
+		}
+
+		number_end = nullptr;
+		double double_number = std::strtod(scalar.c_str(), &number_end);
+		if (*number_end == '\0') {
+			value = double_number;
+			return true;
+		}
+	}
+
+	value = scalar;
+	return true;
+}
+
+
+void LocalParameterServer::s_mergeParameters(XmlRpc::XmlRpcValue& destination, XmlRpc::XmlRpcValue& source, bool overwrite_existing_parameters) {
+	if (destination.getType() != XmlRpc::XmlRpcValue::TypeStruct || source.getType() != XmlRpc::XmlRpcValue::TypeStruct) {
+		if (overwrite_existing_parameters || !destination.valid()) { destination = source; }
+		return;
+	}
+
+	for (XmlRpc::XmlRpcValue::iterator it = source.begin(); it != source.end(); ++it) {
+		if (destination.hasMember(it->first)) {
+			s_mergeParameters(destination[it->first], it->second, overwrite_existing_parameters);
+		} else {
+			destination[it->first] = it->second;
+		}
+	}
+}
+
+
+std::vector<std::string> LocalParameterServer::s_splitKey(const std::string& key) {
+	std::vector<std::string> key_names;
+	std::stringstream key_stream(key);
+	std::string name;
+	while (std::getline(key_stream, name, '/')) {
+		if (!name.empty()) { key_names.push_back(name); }
+	}
+	return key_names;
+}
+
+
+XmlRpc::XmlRpcValue LocalParameterServer::s_createEmptyStruct() {
+	int offset = 0;
+	return XmlRpc::XmlRpcValue(std::string("<value><struct></struct></value>"), &offset);
+}
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </LocalParameterServer-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// =============================================================================  </public-section>  ===========================================================================
+
+
+
+// =============================================================================   <protected-section>   =======================================================================
+void LocalParameterServer::registerMethods() {
+	// parameter server api
+	addMethod("getParam", [this](XmlRpc::XmlRpcValue& params, XmlRpc::XmlRpcValue& result) {
+		XmlRpc::XmlRpcValue value;
+		if (getParameter(params[1], value)) { s_setResponse(result, 1, "", value); }
+		else { s_setResponse(result, -1, "Parameter [" + std::string(params[1]) + "] is not set", 0); }
+	});
+	addMethod("setParam", [this](XmlRpc::XmlRpcValue& params, XmlRpc::XmlRpcValue& result) {
+		setParameter(params[1], params[2]);
+		s_setResponse(result, 1, "", 0);
+	});
+	addMethod("hasParam", [this](XmlRpc::XmlRpcValue& params, XmlRpc::XmlRpcValue& result) {
+		s_setResponse(result, 1, "", hasParameter(params[1]));
+	});
+	addMethod("deleteParam", [this](XmlRpc::XmlRpcValue& params, XmlRpc::XmlRpcValue& result) {
+		if (deleteParameter(params[1])) { s_setResponse(result, 1, "", 0); }
+		else { s_setResponse(result, -1, "Parameter [" + std::string(params[1]) + "] is not set", 0); }
+	});
+	addMethod("searchParam", [this](XmlRpc::XmlRpcValue& params, XmlRpc::XmlRpcValue& result) {
+		std::string found_key;
+		if (searchParameter(params[0], params[1], found_key)) { s_setResponse(result, 1, "", found_key); }
+		else { s_setResponse(result, -1, "Parameter [" + std::string(params[1]) + "] not found", 0); }
+	});
+	addMethod("subscribeParam", [this](XmlRpc::XmlRpcValue& params, XmlRpc::XmlRpcValue& result) {
+		XmlRpc::XmlRpcValue value;
+		if (!getParameter(params[2], value)) { value = s_createEmptyStruct(); } // same as the ros master (the parameter updates are never sent)
+		s_setResponse(result, 1, "", value);
+	});
+	addMethod("unsubscribeParam", [](XmlRpc::XmlRpcValue& params, XmlRpc::XmlRpcValue& result) { s_setResponse(result, 1, "", 1); });
+	addMethod("getParamNames", [this](XmlRpc::XmlRpcValue& params, XmlRpc::XmlRpcValue& result) {
+		std::vector<std::string> parameter_names = getParameterNames();
+		XmlRpc::XmlRpcValue names;
+		names.setSize((int)parameter_names.size());
+		for (size_t i = 0; i < parameter_names.size(); ++i) { names[(int)i] = parameter_names[i]; }
+		s_setResponse(result, 1, "", names);
+	});
+
+	// topics and services api (the registrations are accepted, but there are no other nodes to connect to)
+	XmlRpc::XmlRpcValue empty_list;
+	empty_list.setSize(0);
+	addMethod("registerPublisher", [empty_list](XmlRpc::XmlRpcValue& params, XmlRpc::XmlRpcValue& result) { s_setResponse(result, 1, "", empty_list); });
+	addMethod("unregisterPublisher", [](XmlRpc::XmlRpcValue& params, XmlRpc::XmlRpcValue& result) { s_setResponse(result, 1, "", 1); });
+	addMethod("registerSubscriber", [empty_list](XmlRpc::XmlRpcValue& params, XmlRpc::XmlRpcValue& result) { s_setResponse(result, 1, "", empty_list); });
+	addMethod("unregisterSubscriber", [](XmlRpc::XmlRpcValue& params, XmlRpc::XmlRpcValue& result) { s_setResponse(result, 1, "", 1); });
+	addMethod("registerService", [](XmlRpc::XmlRpcValue& params, XmlRpc::XmlRpcValue& result) { s_setResponse(result, 1, "", 0); });
+	addMethod("unregisterService", [](XmlRpc::XmlRpcValue& params, XmlRpc::XmlRpcValue& result) { s_setResponse(result, 1, "", 1); });
+	addMethod("lookupService", [](XmlRpc::XmlRpcValue& params, XmlRpc::XmlRpcValue& result) { s_setResponse(result, -1, "No provider", ""); });
+	addMethod("lookupNode", [](XmlRpc::XmlRpcValue& params, XmlRpc::XmlRpcValue& result) { s_setResponse(result, -1, "Unknown node", ""); });
+	addMethod("getPublishedTopics", [empty_list](XmlRpc::XmlRpcValue& params, XmlRpc::XmlRpcValue& result) { s_setResponse(result, 1, "", empty_list); });
+	addMethod("getTopicTypes", [empty_list](XmlRpc::XmlRpcValue& params, XmlRpc::XmlRpcValue& result) { s_setResponse(result, 1, "", empty_list); });
+	addMethod("getSystemState", [empty_list](XmlRpc::XmlRpcValue& params, XmlRpc::XmlRpcValue& result) {
+		XmlRpc::XmlRpcValue system_state;
+		system_state.setSize(3);
+		for (int i = 0; i < 3; ++i) { system_state[i] = empty_list; }
+		s_setResponse(result, 1, "", system_state);
+	});
+	addMethod("getUri", [this](XmlRpc::XmlRpcValue& params, XmlRpc::XmlRpcValue& result) { s_setResponse(result, 1, "", getURI()); });
+	addMethod("getPid", [](XmlRpc::XmlRpcValue& params, XmlRpc::XmlRpcValue& result) { s_setResponse(result, 1, "", (int)getpid()); });
+}
+
+
+void LocalParameterServer::addMethod(const std::string& name, const MethodFunction& function) {
+	methods_.push_back(std::unique_ptr<MasterMethod>(new MasterMethod(name, &server_, function)));
+}
+
+
+XmlRpc::XmlRpcValue* LocalParameterServer::findParameter(const std::vector<std::string>& key_names) {
+	XmlRpc::XmlRpcValue* parameter = &parameters_;
+	for (size_t i = 0; i < key_names.size(); ++i) {
+		if (parameter->getType() != XmlRpc::XmlRpcValue::TypeStruct || !parameter->hasMember(key_names[i])) { return nullptr; }
+		parameter = &((*parameter)[key_names[i]]);
+	}
+	return parameter;
+}
+
+
+void LocalParameterServer::collectParameterNames(XmlRpc::XmlRpcValue& parameters, const std::string& parameters_namespace, std::vector<std::string>& parameter_names) {
+	for (XmlRpc::XmlRpcValue::iterator it = parameters.begin(); it != parameters.end(); ++it) {
+		std::string parameter_name = parameters_namespace + "/" + it->first;
+		if (it->second.getType() == XmlRpc::XmlRpcValue::TypeStruct) {
+			collectParameterNames(it->second, parameter_name, parameter_names);
+		} else {
+			parameter_names.push_back(parameter_name);
+		}
+	}
+}
+
+
+void LocalParameterServer::s_setResponse(XmlRpc::XmlRpcValue& result, int status_code, const std::string& status_message, const XmlRpc::XmlRpcValue& value) {
+	result.setSize(3);
+	result[0] = status_code;
+	result[1] = status_message;
+	result[2] = value;
+}
+// =============================================================================   </protected-section>  =======================================================================
+
+} /* namespace dynamic_robot_localization */
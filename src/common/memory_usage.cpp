@@ -0,0 +1,43 @@
+/**\file memory_usage.cpp
+ * \brief Description...
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+#include <dynamic_robot_localization/common/memory_usage.h>
+
+#include <fstream>
+#include <unistd.h>
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+namespace dynamic_robot_localization {
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <imports>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </imports>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+// =============================================================================  <public-section>  ============================================================================
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <MemoryUsage-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+size_t MemoryUsage::s_estimateKdTreeBytes(size_t number_of_points, size_t number_of_dimensions) {
+	if (number_of_points == 0) { return 0; }
+	// nodes of KDTreeSingleIndex: 2 children pointers, split dimension / leaf indices range and split values
+	size_t number_of_nodes = 2 * (number_of_points / 15 + 1);
+	size_t node_bytes = 2 * sizeof(void*) + 2 * sizeof(int) + 2 * sizeof(float);
+	return number_of_points * (number_of_dimensions * sizeof(float) + 2 * sizeof(int)) + number_of_nodes * node_bytes;
+}
+
+
+size_t MemoryUsage::s_getProcessResidentBytes() {
+	std::ifstream statm("/proc/self/statm");
+	size_t total_pages = 0, resident_pages = 0;
+	if (statm >> total_pages >> resident_pages) {
+		long page_size = sysconf(_SC_PAGESIZE);
+		return resident_pages * (size_t)(page_size > 0 ? page_size : 4096);
+	}
+	return 0;
+}
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </MemoryUsage-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// =============================================================================  </public-section>  ===========================================================================
+
+} /* namespace dynamic_robot_localization */
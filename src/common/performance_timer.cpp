@@ -12,37 +12,20 @@ PerformanceTimer::~PerformanceTimer() {}
 
 void PerformanceTimer::start() {
 	stopped = 0;
-	#ifdef _WIN32
-		QueryPerformanceCounter(&startCountWin);
-	#else
-		gettimeofday(&startCount, NULL);
-	#endif
+	startCount = std::chrono::steady_clock::now();
 }
 
 
 void PerformanceTimer::stop() {
 	stopped = true;
-	
-	#ifdef _WIN32
-		QueryPerformanceCounter(&endCountWin);
-	#else
-		gettimeofday(&endCount, NULL);
-	#endif
-	
+	endCount = std::chrono::steady_clock::now();
 	calculateElapsedTimeMicroSec();
 }
 
 
 void PerformanceTimer::reset() {
-	#ifdef _WIN32
-		QueryPerformanceFrequency(&frequencyWin);
-		startCountWin.QuadPart = 0;
-		endCountWin.QuadPart = 0;
-	#else
-		startCount.tv_sec = startCount.tv_usec = 0;
-		endCount.tv_sec = endCount.tv_usec = 0;
-	#endif
-	
+	startCount = std::chrono::steady_clock::time_point();
+	endCount = std::chrono::steady_clock::time_point();
 	stopped = false;
 	elapsedTimeMicroSec = 0;
 }
@@ -66,11 +49,7 @@ double PerformanceTimer::getElapsedTimeInMilliSec() {
 
 double PerformanceTimer::getElapsedTimeInMicroSec() {
 	if (!stopped) {
-		#ifdef _WIN32
-				QueryPerformanceCounter(&endCountWin);
-		#else
-				gettimeofday(&endCount, NULL);
-		#endif
+		endCount = std::chrono::steady_clock::now();
 		calculateElapsedTimeMicroSec();
 	}
 	
@@ -79,11 +58,7 @@ double PerformanceTimer::getElapsedTimeInMicroSec() {
 
 
 void PerformanceTimer::calculateElapsedTimeMicroSec() {
-	#ifdef _WIN32
-		elapsedTimeMicroSec = (endCountWin.QuadPart - startCountWin.QuadPart) * 1000000.0 / frequencyWin.QuadPart;
-	#else
-		elapsedTimeMicroSec = (double)((endCount.tv_sec - startCount.tv_sec) * 1000000 + (endCount.tv_usec - startCount.tv_usec));
-	#endif
+	elapsedTimeMicroSec = std::chrono::duration<double, std::micro>(endCount - startCount).count();
 }
 
 
@@ -22,6 +22,9 @@ PCL_INSTANTIATE(DRLPointcloudConversionsFromROSMsg, DRL_POINT_TYPES)
 #define PCL_INSTANTIATE_DRLPointcloudConversionsPublishPointCloud(T) template bool dynamic_robot_localization::pointcloud_conversions::publishPointCloud<T>(pcl::PointCloud<T>&, ros::Publisher&, const std::string&, bool, const std::string&);
 PCL_INSTANTIATE(DRLPointcloudConversionsPublishPointCloud, DRL_POINT_TYPES)
 
+#define PCL_INSTANTIATE_DRLPointcloudConversionsPublishPointCloudAsynchronously(T) template bool dynamic_robot_localization::pointcloud_conversions::publishPointCloudAsynchronously<T>(const pcl::PointCloud<T>::ConstPtr&, const ros::Publisher&, const std::string&, bool, const std::string&);
+PCL_INSTANTIATE(DRLPointcloudConversionsPublishPointCloudAsynchronously, DRL_POINT_TYPES)
+
 #define PCL_INSTANTIATE_DRLPointcloudConversionsFlipPointCloudNormalsUsingOccpancyGrid(T) template size_t dynamic_robot_localization::pointcloud_conversions::flipPointCloudNormalsUsingOccpancyGrid<T>(const nav_msgs::OccupancyGrid&, pcl::PointCloud<T>&, int, float, bool);
 PCL_INSTANTIATE(DRLPointcloudConversionsFlipPointCloudNormalsUsingOccpancyGrid, DRL_POINT_TYPES)
 
@@ -40,6 +40,15 @@ PCL_INSTANTIATE(DRLPointCloudUtilsDistanceSquaredToOrigin, DRL_POINT_TYPES)
 namespace dynamic_robot_localization {
 namespace pointcloud_utils {
 
+void extractPointCloudClustersIndices(const std::vector<pcl::PointIndices>& cluster_indices, const std::vector<size_t>& selected_clusters, std::vector<int>& indices_out) {
+	indices_out.clear();
+	for (size_t cluster_index = 0; cluster_index < selected_clusters.size(); ++cluster_index) {
+		const std::vector<int>& indices = cluster_indices[selected_clusters[cluster_index]].indices;
+		indices_out.insert(indices_out.end(), indices.begin(), indices.end());
+	}
+	std::sort(indices_out.begin(), indices_out.end());
+}
+
 std::string getFileExtension(const std::string& filename) {
 	std::string extension;
 	if (!filename.empty()) {
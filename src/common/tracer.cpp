@@ -0,0 +1,221 @@
+/**\file tracer.cpp
+ * \brief Description...
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+#include <dynamic_robot_localization/common/tracer.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+
+#ifdef __GNUG__
+#include <cxxabi.h>
+#endif
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+namespace dynamic_robot_localization {
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <imports>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </imports>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+// =============================================================================  <public-section>  ============================================================================
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <constructors-destructor>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+Tracer& Tracer::getInstance() {
+	static Tracer tracer;
+	return tracer;
+}
+
+
+Tracer::Tracer() :
+	enabled_(false),
+	ring_buffer_size_(65536),
+	slots_(nullptr),
+	write_index_(0) {}
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </constructors-destructor>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <Tracer-functions>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+void Tracer::setEnabled(bool enabled) {
+	std::lock_guard<std::mutex> lock(configuration_mutex_);
+	if (enabled && !slots_.load(std::memory_order_relaxed)) {
+		slots_storage_.reset(new Slot[ring_buffer_size_]);
+		for (size_t i = 0; i < ring_buffer_size_; ++i) {
+			slots_storage_[i].sequence.store(0, std::memory_order_relaxed);
+		}
+		slots_.store(slots_storage_.get(), std::memory_order_release);
+	}
+	enabled_.store(enabled, std::memory_order_relaxed);
+}
+
+
+void Tracer::recordSpan(const char* name, std::uint64_t start_time_ns, std::uint64_t duration_ns) {
+	Slot* slots = slots_.load(std::memory_order_acquire);
+	if (!slots || !name) { return; }
+
+	std::uint64_t ticket = write_index_.fetch_add(1, std::memory_order_relaxed);
+	Slot& slot = slots[ticket & (ring_buffer_size_ - 1)];
+	slot.sequence.store(2 * ticket + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	slot.name.store(name, std::memory_order_relaxed);
+	slot.start_time_ns.store(start_time_ns, std::memory_order_relaxed);
+	slot.duration_ns.store(duration_ns, std::memory_order_relaxed);
+	slot.thread_id.store(s_getThreadId(), std::memory_order_relaxed);
+	slot.sequence.store(2 * ticket + 2, std::memory_order_release);
+}
+
+
+const char* Tracer::internSpanName(const std::string& span_name) {
+	std::lock_guard<std::mutex> lock(span_names_mutex_);
+	return span_names_.insert(span_name).first->c_str(); // the nodes of std::unordered_set are not moved when it is rehashed
+}
+
+
+const char* Tracer::getSpanName(const char* span_category, const std::type_info& type_info) {
+	std::pair<const char*, std::type_index> key(span_category, std::type_index(type_info));
+	{
+		std::lock_guard<std::mutex> lock(span_names_mutex_);
+		auto span_name_it = class_span_names_.find(key);
+		if (span_name_it != class_span_names_.end()) { return span_name_it->second; }
+	}
+
+	std::string class_name = type_info.name();
+#ifdef __GNUG__
+	int status = 0;
+	char* demangled_name = abi::__cxa_demangle(type_info.name(), nullptr, nullptr, &status);
+	if (status == 0 && demangled_name) { class_name = demangled_name; }
+	std::free(demangled_name);
+#endif
+
+	size_t template_start = class_name.find('<');
+	if (template_start != std::string::npos) { class_name.erase(template_start); }
+	size_t namespace_end = class_name.rfind("::");
+	if (namespace_end != std::string::npos) { class_name.erase(0, namespace_end + 2); }
+
+	const char* span_name = internSpanName(std::string(span_category) + "/" + class_name);
+	std::lock_guard<std::mutex> lock(span_names_mutex_);
+	class_span_names_[key] = span_name;
+	return span_name;
+}
+
+
+size_t Tracer::getSpans(std::vector<Span>& spans_out, std::uint64_t min_start_time_ns) const {
+	spans_out.clear();
+	Slot* slots = slots_.load(std::memory_order_acquire);
+	if (!slots) { return 0; }
+
+	std::uint64_t end_ticket = write_index_.load(std::memory_order_acquire);
+	std::uint64_t begin_ticket = (end_ticket > ring_buffer_size_) ? end_ticket - ring_buffer_size_ : 0;
+	spans_out.reserve(end_ticket - begin_ticket);
+
+	for (std::uint64_t ticket = begin_ticket; ticket < end_ticket; ++ticket) {
+		const Slot& slot = slots[ticket & (ring_buffer_size_ - 1)];
+		std::uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+		if (sequence != 2 * ticket + 2) { continue; } // still being written or already overwritten
+
+		Span span;
+		span.name = slot.name.load(std::memory_order_relaxed);
+		span.start_time_ns = slot.start_time_ns.load(std::memory_order_relaxed);
+		span.duration_ns = slot.duration_ns.load(std::memory_order_relaxed);
+		span.thread_id = slot.thread_id.load(std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (slot.sequence.load(std::memory_order_relaxed) != sequence) { continue; }
+
+		if (span.start_time_ns >= min_start_time_ns) { spans_out.push_back(span); }
+	}
+
+	std::sort(spans_out.begin(), spans_out.end(), [](const Span& first_span, const Span& second_span) { return first_span.start_time_ns < second_span.start_time_ns; });
+	return spans_out.size();
+}
+
+
+void Tracer::computeSpansStatistics(std::vector<SpanStatistics>& spans_statistics_out, double time_window_in_seconds) const {
+	spans_statistics_out.clear();
+	std::uint64_t current_time_ns = s_getTimeInNanoseconds();
+	std::uint64_t time_window_ns = (std::uint64_t)(std::max(time_window_in_seconds, 0.0) * 1e9);
+
+	std::vector<Span> spans;
+	getSpans(spans, (time_window_ns > 0 && current_time_ns > time_window_ns) ? current_time_ns - time_window_ns : 0);
+
+	std::map< std::string, std::vector<double> > spans_durations_ms;
+	for (size_t i = 0; i < spans.size(); ++i) {
+		spans_durations_ms[spans[i].name].push_back((double)spans[i].duration_ns * 1e-6);
+	}
+
+	for (auto& span_durations_ms : spans_durations_ms) {
+		std::vector<double>& durations_ms = span_durations_ms.second;
+		std::sort(durations_ms.begin(), durations_ms.end());
+
+		SpanStatistics span_statistics;
+		span_statistics.name = span_durations_ms.first;
+		span_statistics.number_of_spans = durations_ms.size();
+		double sum_durations_ms = 0.0;
+		for (size_t i = 0; i < durations_ms.size(); ++i) { sum_durations_ms += durations_ms[i]; }
+		span_statistics.mean_duration_ms = sum_durations_ms / (double)durations_ms.size();
+		span_statistics.p50_duration_ms = durations_ms[(size_t)(0.50 * (double)(durations_ms.size() - 1) + 0.5)];
+		span_statistics.p95_duration_ms = durations_ms[(size_t)(0.95 * (double)(durations_ms.size() - 1) + 0.5)];
+		span_statistics.p99_duration_ms = durations_ms[(size_t)(0.99 * (double)(durations_ms.size() - 1) + 0.5)];
+		span_statistics.max_duration_ms = durations_ms.back();
+		spans_statistics_out.push_back(span_statistics);
+	}
+}
+
+
+void Tracer::exportChromeTrace(std::ostream& output_stream, std::uint64_t min_start_time_ns) const {
+	std::vector<Span> spans;
+	getSpans(spans, min_start_time_ns);
+	std::uint64_t first_start_time_ns = spans.empty() ? 0 : spans.front().start_time_ns;
+
+	output_stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+	output_stream << std::fixed << std::setprecision(3);
+	for (size_t i = 0; i < spans.size(); ++i) {
+		if (i > 0) { output_stream << ","; }
+		output_stream << "\n{\"name\":\"";
+		for (const char* character = spans[i].name; *character != '\0'; ++character) {
+			if (*character == '"' || *character == '\\') { output_stream << '\\'; }
+			output_stream << *character;
+		}
+		output_stream << "\",\"cat\":\"drl\",\"ph\":\"X\",\"pid\":0,\"tid\":" << spans[i].thread_id
+				<< ",\"ts\":" << (double)(spans[i].start_time_ns - first_start_time_ns) * 1e-3
+				<< ",\"dur\":" << (double)spans[i].duration_ns * 1e-3 << "}";
+	}
+	output_stream << "\n]}\n";
+}
+
+
+bool Tracer::saveChromeTrace(const std::string& filename, std::uint64_t min_start_time_ns) const {
+	std::ofstream output_file(filename.c_str());
+	if (!output_file.is_open()) { return false; }
+	exportChromeTrace(output_file, min_start_time_ns);
+	return output_file.good();
+}
+
+
+std::uint64_t Tracer::getNumberOfOverwrittenSpans() const {
+	std::uint64_t number_of_recorded_spans = getNumberOfRecordedSpans();
+	return (number_of_recorded_spans > ring_buffer_size_) ? number_of_recorded_spans - ring_buffer_size_ : 0;
+}
+
+
+void Tracer::setRingBufferSize(size_t ring_buffer_size) {
+	std::lock_guard<std::mutex> lock(configuration_mutex_);
+	if (slots_.load(std::memory_order_relaxed)) { return; }
+
+	ring_buffer_size_ = 1;
+	while (ring_buffer_size_ < ring_buffer_size) { ring_buffer_size_ <<= 1; }
+}
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </Tracer-functions>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// =============================================================================  </public-section>  ===========================================================================
+
+// =============================================================================   <protected-section>   =======================================================================
+std::uint32_t Tracer::s_getThreadId() {
+	static std::atomic<std::uint32_t> s_number_of_threads(0);
+	thread_local std::uint32_t thread_id = s_number_of_threads.fetch_add(1, std::memory_order_relaxed);
+	return thread_id;
+}
+// =============================================================================   </protected-section>  =======================================================================
+
+} /* namespace dynamic_robot_localization */
@@ -0,0 +1,720 @@
+/**\file localization_replay.cpp
+ * \brief Replays recorded scans (from a rosbag or from a folder of pcd files) through the localization pipeline as fast as possible and writes a benchmark report
+ * with the latency percentiles of each processing stage, the throughput, the peak memory usage and the pose errors in relation to the ground truth.
+ * It can also generate a small synthetic dataset (reference map, scans and ground truth poses) for allowing to run the benchmark without recorded data.
+ * When yaml files are given as arguments, their parameters are loaded into the private namespace of the node and served in-process (no ros master is needed):
+ *   rosrun dynamic_robot_localization drl_localization_replay yaml/configs/replay/synthetic_3d.yaml [overrides.yaml ...] [_replay/maximum_number_of_scans:=100 ...]
+ * The files are applied in order (the last one has priority) and the private parameters given in the command line have priority over all of them.
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// std includes
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// system includes
+#include <dirent.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+// ROS includes
+#include <ros/ros.h>
+#include <rosbag/bag.h>
+#include <rosbag/view.h>
+#include <sensor_msgs/PointCloud2.h>
+#include <tf2/LinearMath/Quaternion.h>
+#include <tf2/LinearMath/Transform.h>
+
+// PCL includes
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+#include <pcl/common/transforms.h>
+#include <pcl/filters/filter.h>
+#include <pcl_conversions/pcl_conversions.h>
+
+// project includes
+#include <dynamic_robot_localization/localization/localization.h>
+#include <dynamic_robot_localization/common/local_parameter_server.h>
+#include <dynamic_robot_localization/common/performance_timer.h>
+#include <dynamic_robot_localization/common/pointcloud_conversions.h>
+#include <dynamic_robot_localization/common/verbosity_levels.h>
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+using PointT = pcl::PointXYZRGBNormal;
+using PointCloudT = pcl::PointCloud<PointT>;
+
+
+// ############################################################################   <data-structures>   ##########################################################################
+struct GroundTruthPose {
+	double time;
+	tf2::Transform pose;
+};
+
+struct ScanResult {
+	double time;
+	size_t number_of_points;
+	bool registration_successful;
+	std::string processing_status;
+	double loading_time;
+	double processing_time;
+	dynamic_robot_localization::LocalizationTimes localization_times;
+	tf2::Transform estimated_pose;
+	bool ground_truth_available;
+	double translation_error;
+	double rotation_error;
+};
+
+struct SyntheticDatasetConfiguration {
+	std::string folder;
+	int number_of_scans;
+	double time_between_scans;
+	double map_resolution;
+	double sensor_range;
+	double scan_points_sampling_probability;
+	double scan_points_noise_stddev;
+	unsigned int random_number_generator_seed;
+};
+// ############################################################################   </data-structures>   #########################################################################
+
+
+// ##############################################################################   <ground-truth>   ###########################################################################
+bool loadPosesCSV(const std::string& filename, std::vector<GroundTruthPose>& poses) {
+	std::ifstream file(filename);
+	if (!file.is_open()) {
+		ROS_ERROR_STREAM("Failed to open poses file " << filename);
+		return false;
+	}
+
+	poses.clear();
+	std::string line;
+	while (std::getline(file, line)) {
+		std::replace(line.begin(), line.end(), ',', ' ');
+		std::istringstream line_stream(line);
+		double time, x, y, z, qx, qy, qz, qw;
+		if (line.empty() || line[0] == '#' || !(line_stream >> time >> x >> y >> z >> qx >> qy >> qz >> qw))
+			continue;
+
+		tf2::Quaternion orientation(qx, qy, qz, qw);
+		orientation.normalize();
+		GroundTruthPose ground_truth_pose;
+		ground_truth_pose.time = time;
+		ground_truth_pose.pose = tf2::Transform(orientation, tf2::Vector3(x, y, z));
+		poses.push_back(ground_truth_pose);
+	}
+
+	std::stable_sort(poses.begin(), poses.end(), [](const GroundTruthPose& a, const GroundTruthPose& b) { return a.time < b.time; });
+	ROS_INFO_STREAM("Loaded " << poses.size() << " ground truth poses from " << filename);
+	return !poses.empty();
+}
+
+
+bool savePosesCSV(const std::string& filename, const std::vector<ScanResult>& scan_results) {
+	std::ofstream file(filename);
+	if (!file.is_open()) {
+		ROS_ERROR_STREAM("Failed to save estimated poses to " << filename);
+		return false;
+	}
+
+	file << "# timestamp, x, y, z, qx, qy, qz, qw\n" << std::fixed << std::setprecision(9);
+	for (size_t i = 0; i < scan_results.size(); ++i) {
+		const tf2::Vector3& position = scan_results[i].estimated_pose.getOrigin();
+		tf2::Quaternion orientation = scan_results[i].estimated_pose.getRotation();
+		file << scan_results[i].time << ", " << position.getX() << ", " << position.getY() << ", " << position.getZ() << ", "
+				<< orientation.getX() << ", " << orientation.getY() << ", " << orientation.getZ() << ", " << orientation.getW() << "\n";
+	}
+
+	return true;
+}
+
+
+const GroundTruthPose* findGroundTruthPose(const std::vector<GroundTruthPose>& poses, double time, double max_time_difference) {
+	if (poses.empty()) return nullptr;
+
+	auto pose_after = std::lower_bound(poses.begin(), poses.end(), time, [](const GroundTruthPose& pose, double t) { return pose.time < t; });
+	const GroundTruthPose* closest_pose = nullptr;
+	if (pose_after != poses.end())
+		closest_pose = &(*pose_after);
+	if (pose_after != poses.begin() && (!closest_pose || std::abs(std::prev(pose_after)->time - time) < std::abs(closest_pose->time - time)))
+		closest_pose = &(*std::prev(pose_after));
+
+	if (closest_pose && std::abs(closest_pose->time - time) <= max_time_difference)
+		return closest_pose;
+	return nullptr;
+}
+
+
+tf2::Transform generateNoiseTransform(std::mt19937& random_number_generator, double translation_stddev, double rotation_stddev, bool planar_noise) {
+	tf2::Transform noise = tf2::Transform::getIdentity();
+	if (translation_stddev > 0.0) {
+		std::normal_distribution<double> translation_distribution(0.0, translation_stddev);
+		double x = translation_distribution(random_number_generator);
+		double y = translation_distribution(random_number_generator);
+		double z = planar_noise ? 0.0 : translation_distribution(random_number_generator);
+		noise.setOrigin(tf2::Vector3(x, y, z));
+	}
+
+	if (rotation_stddev > 0.0) {
+		std::normal_distribution<double> rotation_distribution(0.0, rotation_stddev);
+		double roll = planar_noise ? 0.0 : rotation_distribution(random_number_generator);
+		double pitch = planar_noise ? 0.0 : rotation_distribution(random_number_generator);
+		double yaw = rotation_distribution(random_number_generator);
+		tf2::Quaternion orientation;
+		orientation.setRPY(roll, pitch, yaw);
+		noise.setRotation(orientation);
+	}
+
+	return noise;
+}
+// ##############################################################################   </ground-truth>   ##########################################################################
+
+
+// ##########################################################################   <synthetic-dataset>   ##########################################################################
+void addSyntheticPlane(PointCloudT& pointcloud, const tf2::Vector3& origin, const tf2::Vector3& u_axis, const tf2::Vector3& v_axis, const tf2::Vector3& normal, double resolution) {
+	int number_of_u_steps = std::max(1, (int)std::round(u_axis.length() / resolution));
+	int number_of_v_steps = std::max(1, (int)std::round(v_axis.length() / resolution));
+	for (int u = 0; u <= number_of_u_steps; ++u) {
+		for (int v = 0; v <= number_of_v_steps; ++v) {
+			tf2::Vector3 position = origin + u_axis * ((double)u / (double)number_of_u_steps) + v_axis * ((double)v / (double)number_of_v_steps);
+			PointT point;
+			point.x = (float)position.getX(); point.y = (float)position.getY(); point.z = (float)position.getZ();
+			point.normal_x = (float)normal.getX(); point.normal_y = (float)normal.getY(); point.normal_z = (float)normal.getZ();
+			point.r = (std::uint8_t)(127 + 127 * normal.getX()); point.g = (std::uint8_t)(127 + 127 * normal.getY()); point.b = (std::uint8_t)(127 + 127 * normal.getZ());
+			pointcloud.push_back(point);
+		}
+	}
+}
+
+
+void addSyntheticBox(PointCloudT& pointcloud, double min_x, double min_y, double max_x, double max_y, double height, double resolution) {
+	double size_x = max_x - min_x, size_y = max_y - min_y;
+	addSyntheticPlane(pointcloud, tf2::Vector3(min_x, min_y, 0.0), tf2::Vector3(size_x, 0.0, 0.0), tf2::Vector3(0.0, 0.0, height), tf2::Vector3(0.0, -1.0, 0.0), resolution);
+	addSyntheticPlane(pointcloud, tf2::Vector3(min_x, max_y, 0.0), tf2::Vector3(size_x, 0.0, 0.0), tf2::Vector3(0.0, 0.0, height), tf2::Vector3(0.0, 1.0, 0.0), resolution);
+	addSyntheticPlane(pointcloud, tf2::Vector3(min_x, min_y, 0.0), tf2::Vector3(0.0, size_y, 0.0), tf2::Vector3(0.0, 0.0, height), tf2::Vector3(-1.0, 0.0, 0.0), resolution);
+	addSyntheticPlane(pointcloud, tf2::Vector3(max_x, min_y, 0.0), tf2::Vector3(0.0, size_y, 0.0), tf2::Vector3(0.0, 0.0, height), tf2::Vector3(1.0, 0.0, 0.0), resolution);
+	addSyntheticPlane(pointcloud, tf2::Vector3(min_x, min_y, height), tf2::Vector3(size_x, 0.0, 0.0), tf2::Vector3(0.0, size_y, 0.0), tf2::Vector3(0.0, 0.0, 1.0), resolution);
+}
+
+
+/*!
+ * Generates a room of 16 x 10 x 3 meters with several boxes (for avoiding symmetries), a trajectory with one elliptical loop around the center of the room
+ * and the scans of a 3D sensor with limited range (without simulating occlusions) in the base_link frame, with random sampling and gaussian noise.
+ * The dataset only depends on the configuration (including the random seed), which makes the benchmark results comparable between runs.
+ */
+bool generateSyntheticDataset(const SyntheticDatasetConfiguration& configuration) {
+	std::string scans_folder = configuration.folder + "scans/";
+	if ((mkdir(configuration.folder.c_str(), 0755) != 0 && errno != EEXIST) || (mkdir(scans_folder.c_str(), 0755) != 0 && errno != EEXIST)) {
+		ROS_ERROR_STREAM("Failed to create the synthetic dataset folder " << configuration.folder);
+		return false;
+	}
+
+	double room_x = 16.0, room_y = 10.0, room_z = 3.0, resolution = configuration.map_resolution;
+	PointCloudT map;
+	addSyntheticPlane(map, tf2::Vector3(0.0, 0.0, 0.0), tf2::Vector3(room_x, 0.0, 0.0), tf2::Vector3(0.0, room_y, 0.0), tf2::Vector3(0.0, 0.0, 1.0), resolution);
+	addSyntheticPlane(map, tf2::Vector3(0.0, 0.0, 0.0), tf2::Vector3(room_x, 0.0, 0.0), tf2::Vector3(0.0, 0.0, room_z), tf2::Vector3(0.0, 1.0, 0.0), resolution);
+	addSyntheticPlane(map, tf2::Vector3(0.0, room_y, 0.0), tf2::Vector3(room_x, 0.0, 0.0), tf2::Vector3(0.0, 0.0, room_z), tf2::Vector3(0.0, -1.0, 0.0), resolution);
+	addSyntheticPlane(map, tf2::Vector3(0.0, 0.0, 0.0), tf2::Vector3(0.0, room_y, 0.0), tf2::Vector3(0.0, 0.0, room_z), tf2::Vector3(1.0, 0.0, 0.0), resolution);
+	addSyntheticPlane(map, tf2::Vector3(room_x, 0.0, 0.0), tf2::Vector3(0.0, room_y, 0.0), tf2::Vector3(0.0, 0.0, room_z), tf2::Vector3(-1.0, 0.0, 0.0), resolution);
+	addSyntheticBox(map, 7.5, 4.5, 8.5, 5.5, 2.0, resolution);
+	addSyntheticBox(map, 3.0, 2.0, 3.6, 2.8, 1.2, resolution);
+	addSyntheticBox(map, 12.0, 7.0, 13.5, 7.5, 0.8, resolution);
+	addSyntheticBox(map, 5.0, 8.0, 5.4, 8.4, 3.0, resolution);
+	addSyntheticBox(map, 10.5, 1.2, 11.5, 1.6, 1.0, resolution);
+	addSyntheticBox(map, 14.0, 3.0, 14.6, 4.2, 1.5, resolution);
+	map.width = map.size(); map.height = 1; map.is_dense = true;
+
+	if (!dynamic_robot_localization::pointcloud_conversions::toFile(configuration.folder + "map.pcd", map, true)) {
+		ROS_ERROR_STREAM("Failed to save the synthetic map to " << configuration.folder << "map.pcd");
+		return false;
+	}
+
+	std::ofstream poses_file(configuration.folder + "poses.csv");
+	if (!poses_file.is_open()) {
+		ROS_ERROR_STREAM("Failed to save the synthetic poses to " << configuration.folder << "poses.csv");
+		return false;
+	}
+	poses_file << "# timestamp, x, y, z, qx, qy, qz, qw\n" << std::fixed << std::setprecision(9);
+
+	std::mt19937 random_number_generator(configuration.random_number_generator_seed);
+	std::uniform_real_distribution<double> sampling_distribution(0.0, 1.0);
+	std::normal_distribution<double> noise_distribution(0.0, std::max(configuration.scan_points_noise_stddev, 1e-12));
+	double sensor_range_squared = configuration.sensor_range * configuration.sensor_range;
+
+	for (int i = 0; i < configuration.number_of_scans; ++i) {
+		double angle = 2.0 * M_PI * (double)i / (double)configuration.number_of_scans;
+		double center_x = room_x * 0.5, center_y = room_y * 0.5, radius_x = 5.0, radius_y = 3.0;
+		tf2::Quaternion orientation;
+		orientation.setRPY(0.0, 0.0, std::atan2(radius_y * std::cos(angle), -radius_x * std::sin(angle)));
+		tf2::Transform pose(orientation, tf2::Vector3(center_x + radius_x * std::cos(angle), center_y + radius_y * std::sin(angle), 0.0));
+		tf2::Transform pose_inverse = pose.inverse();
+		double time = 10.0 + configuration.time_between_scans * (double)i;
+
+		PointCloudT scan;
+		for (size_t p = 0; p < map.size(); ++p) {
+			tf2::Vector3 position_map(map[p].x, map[p].y, map[p].z);
+			if ((position_map - pose.getOrigin()).length2() > sensor_range_squared || sampling_distribution(random_number_generator) > configuration.scan_points_sampling_probability)
+				continue;
+
+			tf2::Vector3 position = pose_inverse * position_map;
+			tf2::Vector3 normal = pose_inverse.getBasis() * tf2::Vector3(map[p].normal_x, map[p].normal_y, map[p].normal_z);
+			PointT point = map[p];
+			point.x = (float)(position.getX() + (configuration.scan_points_noise_stddev > 0.0 ? noise_distribution(random_number_generator) : 0.0));
+			point.y = (float)(position.getY() + (configuration.scan_points_noise_stddev > 0.0 ? noise_distribution(random_number_generator) : 0.0));
+			point.z = (float)(position.getZ() + (configuration.scan_points_noise_stddev > 0.0 ? noise_distribution(random_number_generator) : 0.0));
+			point.normal_x = (float)normal.getX(); point.normal_y = (float)normal.getY(); point.normal_z = (float)normal.getZ();
+			scan.push_back(point);
+		}
+		scan.width = scan.size(); scan.height = 1; scan.is_dense = true;
+
+		std::ostringstream scan_filename;
+		scan_filename << scans_folder << "scan_" << std::setw(6) << std::setfill('0') << i << ".pcd";
+		if (!dynamic_robot_localization::pointcloud_conversions::toFile(scan_filename.str(), scan, true)) {
+			ROS_ERROR_STREAM("Failed to save the synthetic scan " << scan_filename.str());
+			return false;
+		}
+
+		poses_file << time << ", " << pose.getOrigin().getX() << ", " << pose.getOrigin().getY() << ", " << pose.getOrigin().getZ() << ", "
+				<< orientation.getX() << ", " << orientation.getY() << ", " << orientation.getZ() << ", " << orientation.getW() << "\n";
+	}
+
+	ROS_INFO_STREAM("Generated synthetic dataset in " << configuration.folder << " with a map of " << map.size() << " points and " << configuration.number_of_scans << " scans");
+	return true;
+}
+// ##########################################################################   </synthetic-dataset>   #########################################################################
+
+
+// ###############################################################################   <report>   #################################################################################
+bool listPCDFiles(const std::string& folder, std::vector<std::string>& filenames) {
+	DIR* directory = opendir(folder.c_str());
+	if (!directory) {
+		ROS_ERROR_STREAM("Failed to open the scans folder " << folder);
+		return false;
+	}
+
+	filenames.clear();
+	struct dirent* entry;
+	while ((entry = readdir(directory)) != nullptr) {
+		std::string filename(entry->d_name);
+		if (filename.size() > 4 && filename.compare(filename.size() - 4, 4, ".pcd") == 0)
+			filenames.push_back(folder + (folder.back() == '/' ? "" : "/") + filename);
+	}
+	closedir(directory);
+
+	std::sort(filenames.begin(), filenames.end());
+	return !filenames.empty();
+}
+
+
+long getPeakResidentSetSizeInKilobytes() {
+	struct rusage resource_usage;
+	if (getrusage(RUSAGE_SELF, &resource_usage) != 0) return -1;
+	return resource_usage.ru_maxrss;
+}
+
+
+double computePercentile(const std::vector<double>& sorted_values, double percentile) {
+	if (sorted_values.empty()) return 0.0;
+	size_t rank = (size_t)std::ceil(percentile / 100.0 * (double)sorted_values.size());
+	return sorted_values[std::min(sorted_values.size() - 1, rank > 0 ? rank - 1 : 0)];
+}
+
+
+void writeStatistics(std::ostream& report, const std::string& name, std::vector<double> values, const std::string& indentation, bool last_entry = false) {
+	std::sort(values.begin(), values.end());
+	double sum = 0.0, sum_squared = 0.0;
+	for (size_t i = 0; i < values.size(); ++i) { sum += values[i]; sum_squared += values[i] * values[i]; }
+	double mean = values.empty() ? 0.0 : sum / (double)values.size();
+	double root_mean_square = values.empty() ? 0.0 : std::sqrt(sum_squared / (double)values.size());
+
+	report << indentation << "\"" << name << "\": { \"count\": " << values.size()
+			<< ", \"mean\": " << mean
+			<< ", \"rms\": " << root_mean_square
+			<< ", \"min\": " << (values.empty() ? 0.0 : values.front())
+			<< ", \"p50\": " << computePercentile(values, 50.0)
+			<< ", \"p90\": " << computePercentile(values, 90.0)
+			<< ", \"p99\": " << computePercentile(values, 99.0)
+			<< ", \"max\": " << (values.empty() ? 0.0 : values.back())
+			<< " }" << (last_entry ? "\n" : ",\n");
+}
+
+
+std::vector< std::pair<std::string, double> > getLocalizationStageTimes(const ScanResult& scan_result) {
+	const dynamic_robot_localization::LocalizationTimes& times = scan_result.localization_times;
+	return {
+		{ "scan_loading_time", scan_result.loading_time },
+		{ "global_time", scan_result.processing_time },
+		{ "filtering_time", times.filtering_time },
+		{ "surface_normal_estimation_time", times.surface_normal_estimation_time },
+		{ "keypoint_selection_time", times.keypoint_selection_time },
+		{ "initial_pose_estimation_time", times.initial_pose_estimation_time },
+		{ "pointcloud_registration_time", times.pointcloud_registration_time },
+		{ "correspondence_estimation_time_for_all_matchers", times.correspondence_estimation_time_for_all_matchers },
+		{ "transformation_estimation_time_for_all_matchers", times.transformation_estimation_time_for_all_matchers },
+		{ "transform_cloud_time_for_all_matchers", times.transform_cloud_time_for_all_matchers },
+		{ "cloud_align_time_for_all_matchers", times.cloud_align_time_for_all_matchers },
+		{ "outlier_detection_time", times.outlier_detection_time },
+		{ "registered_points_angular_distribution_analysis_time", times.registered_points_angular_distribution_analysis_time },
+		{ "transformation_validators_time", times.transformation_validators_time },
+		{ "covariance_estimator_time", times.covariance_estimator_time },
+		{ "map_update_time", times.map_update_time }
+	};
+}
+
+
+bool writeReport(const std::string& filename, const std::string& dataset_type, const std::string& dataset_source, const std::vector<ScanResult>& scan_results,
+		size_t number_of_warmup_scans, double replay_wall_time) {
+	std::ofstream report(filename);
+	if (!report.is_open()) {
+		ROS_ERROR_STREAM("Failed to save the replay report to " << filename);
+		return false;
+	}
+
+	size_t number_of_successful_registrations = 0;
+	std::map<std::string, size_t> failures_by_status;
+	std::vector<std::string> stage_names;
+	std::vector< std::vector<double> > stage_times;
+	std::vector<double> number_of_points, translation_errors, rotation_errors;
+	double total_processing_time = 0.0;
+
+	for (size_t i = 0; i < scan_results.size(); ++i) {
+		const ScanResult& scan_result = scan_results[i];
+		if (scan_result.registration_successful) ++number_of_successful_registrations;
+		else ++failures_by_status[scan_result.processing_status];
+
+		if (scan_result.ground_truth_available) {
+			translation_errors.push_back(scan_result.translation_error);
+			rotation_errors.push_back(scan_result.rotation_error);
+		}
+
+		if (i < number_of_warmup_scans) continue;
+
+		std::vector< std::pair<std::string, double> > scan_stage_times = getLocalizationStageTimes(scan_result);
+		if (stage_names.empty()) {
+			for (size_t s = 0; s < scan_stage_times.size(); ++s) stage_names.push_back(scan_stage_times[s].first);
+			stage_times.resize(scan_stage_times.size());
+		}
+		for (size_t s = 0; s < scan_stage_times.size(); ++s) stage_times[s].push_back(scan_stage_times[s].second);
+		number_of_points.push_back((double)scan_result.number_of_points);
+		total_processing_time += scan_result.processing_time;
+	}
+
+	size_t number_of_measured_scans = number_of_points.size();
+	report << std::fixed << std::setprecision(6);
+	report << "{\n";
+	report << "  \"dataset\": { \"type\": \"" << dataset_type << "\", \"source\": \"" << dataset_source << "\" },\n";
+	report << "  \"number_of_scans\": " << scan_results.size() << ",\n";
+	report << "  \"number_of_warmup_scans\": " << std::min(number_of_warmup_scans, scan_results.size()) << ",\n";
+	report << "  \"number_of_successful_registrations\": " << number_of_successful_registrations << ",\n";
+	report << "  \"number_of_failed_registrations\": " << (scan_results.size() - number_of_successful_registrations) << ",\n";
+	report << "  \"failures_by_status\": {";
+	for (std::map<std::string, size_t>::const_iterator it = failures_by_status.begin(); it != failures_by_status.end(); ++it)
+		report << (it == failures_by_status.begin() ? " " : ", ") << "\"" << it->first << "\": " << it->second;
+	report << (failures_by_status.empty() ? "},\n" : " },\n");
+	report << "  \"replay_wall_time_seconds\": " << replay_wall_time << ",\n";
+	report << "  \"processing_time_seconds\": " << (total_processing_time / 1000.0) << ",\n";
+	report << "  \"throughput_scans_per_second\": " << (total_processing_time > 0.0 ? (double)number_of_measured_scans / (total_processing_time / 1000.0) : 0.0) << ",\n";
+	report << "  \"throughput_scans_per_second_including_loading\": " << (replay_wall_time > 0.0 ? (double)scan_results.size() / replay_wall_time : 0.0) << ",\n";
+	report << "  \"peak_resident_set_size_megabytes\": " << ((double)getPeakResidentSetSizeInKilobytes() / 1024.0) << ",\n";
+	writeStatistics(report, "number_of_points_per_scan", number_of_points, "  ");
+	report << "  \"stage_times_milliseconds\": {\n";
+	for (size_t s = 0; s < stage_names.size(); ++s)
+		writeStatistics(report, stage_names[s], stage_times[s], "    ", s + 1 == stage_names.size());
+	report << "  },\n";
+	report << "  \"pose_errors\": {\n";
+	writeStatistics(report, "translation_meters", translation_errors, "    ");
+	writeStatistics(report, "rotation_radians", rotation_errors, "    ", true);
+	report << "  }\n";
+	report << "}\n";
+
+	ROS_INFO_STREAM("Saved replay report to " << filename);
+	return true;
+}
+// ###############################################################################   </report>   ################################################################################
+
+
+
+// ###################################################################################   <main>   ##############################################################################
+int main(int argc, char** argv) {
+	std::vector<std::string> parameter_files;
+	for (int i = 1; i < argc; ++i) {
+		std::string argument(argv[i]);
+		if (argument.find(":=") == std::string::npos && ((argument.size() > 5 && argument.substr(argument.size() - 5) == ".yaml") || (argument.size() > 4 && argument.substr(argument.size() - 4) == ".yml"))) {
+			parameter_files.push_back(argument);
+		}
+	}
+
+	// the parameter server must be running before ros::init (which sets the private parameters given in the command line)
+	dynamic_robot_localization::LocalParameterServer local_parameter_server;
+	std::vector<std::string> arguments(argv, argv + argc);
+	if (!parameter_files.empty()) {
+		if (!local_parameter_server.start()) {
+			std::cerr << "Failed to start the local parameter server" << std::endl;
+			return 1;
+		}
+		arguments.push_back("__master:=" + local_parameter_server.getURI());
+	}
+
+	std::vector<char*> arguments_pointers;
+	for (size_t i = 0; i < arguments.size(); ++i) {
+		arguments_pointers.push_back(&arguments[i][0]);
+	}
+	int number_of_arguments = (int)arguments_pointers.size();
+	ros::init(number_of_arguments, arguments_pointers.data(), "drl_localization_replay");
+
+	// loaded from the last to the first file without overwriting the existing parameters, for giving priority to the last file and to the command line parameters
+	for (std::vector<std::string>::reverse_iterator it = parameter_files.rbegin(); it != parameter_files.rend(); ++it) {
+		if (!local_parameter_server.loadYAML(*it, ros::this_node::getName(), false)) { return 1; }
+		ROS_INFO_STREAM("Loaded the parameters file " << *it);
+	}
+
+	ros::NodeHandlePtr node_handle(new ros::NodeHandle());
+	ros::NodeHandlePtr private_node_handle(new ros::NodeHandle("~"));
+
+	std::string pcl_verbosity_level;
+	private_node_handle->param("pcl_verbosity_level", pcl_verbosity_level, std::string("ERROR"));
+	dynamic_robot_localization::verbosity_levels::setVerbosityLevelPCL(pcl_verbosity_level);
+
+	std::string ros_verbosity_level;
+	private_node_handle->param("ros_verbosity_level", ros_verbosity_level, std::string("INFO"));
+	dynamic_robot_localization::verbosity_levels::setVerbosityLevelROS(ros_verbosity_level);
+
+	std::string dataset_type, pcd_folder, poses_filename, rosbag_filename, rosbag_pointcloud_topics, report_filename, estimated_poses_filename;
+	private_node_handle->param("replay/dataset_type", dataset_type, std::string("synthetic"));
+	private_node_handle->param("replay/pcd_folder", pcd_folder, std::string(""));
+	private_node_handle->param("replay/poses_filename", poses_filename, std::string(""));
+	private_node_handle->param("replay/rosbag_filename", rosbag_filename, std::string(""));
+	private_node_handle->param("replay/rosbag_pointcloud_topics", rosbag_pointcloud_topics, std::string(""));
+	private_node_handle->param("replay/report_filename", report_filename, std::string("localization_replay_report.json"));
+	private_node_handle->param("replay/estimated_poses_filename", estimated_poses_filename, std::string(""));
+
+	int maximum_number_of_scans, number_of_warmup_scans, random_number_generator_seed;
+	double time_between_scans, ground_truth_max_time_difference, initial_guess_translation_noise_stddev, initial_guess_rotation_noise_stddev;
+	bool initial_guess_planar_noise;
+	private_node_handle->param("replay/maximum_number_of_scans", maximum_number_of_scans, -1);
+	private_node_handle->param("replay/number_of_warmup_scans", number_of_warmup_scans, 0);
+	private_node_handle->param("replay/time_between_scans", time_between_scans, 0.1);
+	private_node_handle->param("replay/ground_truth_max_time_difference", ground_truth_max_time_difference, 0.05);
+	private_node_handle->param("replay/random_number_generator_seed", random_number_generator_seed, 12345);
+	private_node_handle->param("replay/initial_guess_noise/translation_stddev", initial_guess_translation_noise_stddev, 0.0);
+	private_node_handle->param("replay/initial_guess_noise/rotation_stddev", initial_guess_rotation_noise_stddev, 0.0);
+	private_node_handle->param("replay/initial_guess_noise/planar", initial_guess_planar_noise, false);
+
+	double sensor_x, sensor_y, sensor_z, sensor_roll, sensor_pitch, sensor_yaw;
+	private_node_handle->param("replay/sensor_to_base_link/x", sensor_x, 0.0);
+	private_node_handle->param("replay/sensor_to_base_link/y", sensor_y, 0.0);
+	private_node_handle->param("replay/sensor_to_base_link/z", sensor_z, 0.0);
+	private_node_handle->param("replay/sensor_to_base_link/roll", sensor_roll, 0.0);
+	private_node_handle->param("replay/sensor_to_base_link/pitch", sensor_pitch, 0.0);
+	private_node_handle->param("replay/sensor_to_base_link/yaw", sensor_yaw, 0.0);
+	tf2::Quaternion sensor_orientation;
+	sensor_orientation.setRPY(sensor_roll, sensor_pitch, sensor_yaw);
+	tf2::Transform transform_sensor_to_base_link(sensor_orientation, tf2::Vector3(sensor_x, sensor_y, sensor_z));
+	bool transform_scans_to_base_link = (sensor_x != 0.0 || sensor_y != 0.0 || sensor_z != 0.0 || sensor_roll != 0.0 || sensor_pitch != 0.0 || sensor_yaw != 0.0);
+	Eigen::Transform<double, 3, Eigen::Affine> transform_sensor_to_base_link_eigen = laserscan_to_pointcloud::tf_rosmsg_eigen_conversions::transformTF2ToTransform<double>(transform_sensor_to_base_link);
+
+	if (dataset_type == "synthetic") {
+		SyntheticDatasetConfiguration synthetic_dataset_configuration;
+		bool overwrite_synthetic_dataset;
+		private_node_handle->param("replay/synthetic_dataset/folder", synthetic_dataset_configuration.folder, std::string("/tmp/drl_localization_replay_synthetic_dataset/"));
+		private_node_handle->param("replay/synthetic_dataset/overwrite", overwrite_synthetic_dataset, false);
+		private_node_handle->param("replay/synthetic_dataset/number_of_scans", synthetic_dataset_configuration.number_of_scans, 100);
+		private_node_handle->param("replay/synthetic_dataset/map_resolution", synthetic_dataset_configuration.map_resolution, 0.05);
+		private_node_handle->param("replay/synthetic_dataset/sensor_range", synthetic_dataset_configuration.sensor_range, 8.0);
+		private_node_handle->param("replay/synthetic_dataset/scan_points_sampling_probability", synthetic_dataset_configuration.scan_points_sampling_probability, 0.1);
+		private_node_handle->param("replay/synthetic_dataset/scan_points_noise_stddev", synthetic_dataset_configuration.scan_points_noise_stddev, 0.005);
+		synthetic_dataset_configuration.time_between_scans = time_between_scans;
+		synthetic_dataset_configuration.random_number_generator_seed = (unsigned int)random_number_generator_seed;
+		if (!synthetic_dataset_configuration.folder.empty() && synthetic_dataset_configuration.folder.back() != '/')
+			synthetic_dataset_configuration.folder += "/";
+
+		std::ifstream existing_poses_file(synthetic_dataset_configuration.folder + "poses.csv");
+		if ((overwrite_synthetic_dataset || !existing_poses_file.good()) && !generateSyntheticDataset(synthetic_dataset_configuration))
+			return 1;
+
+		pcd_folder = synthetic_dataset_configuration.folder + "scans/";
+		poses_filename = synthetic_dataset_configuration.folder + "poses.csv";
+		std::string reference_pointcloud_filename;
+		if (!private_node_handle->getParam("reference_pointclouds/reference_pointcloud_filename", reference_pointcloud_filename) || reference_pointcloud_filename.empty())
+			private_node_handle->setParam("reference_pointclouds/reference_pointcloud_filename", synthetic_dataset_configuration.folder + "map.pcd");
+	} else if (dataset_type != "pcd" && dataset_type != "rosbag") {
+		ROS_ERROR_STREAM("Unknown replay/dataset_type [" << dataset_type << "] (available types: synthetic | pcd | rosbag)");
+		return 1;
+	}
+
+	std::vector<GroundTruthPose> ground_truth_poses;
+	if (!poses_filename.empty() && !loadPosesCSV(poses_filename, ground_truth_poses))
+		return 1;
+
+	dynamic_robot_localization::Localization<PointT> localization;
+	localization.setupConfigurationFromParameterServer(node_handle, private_node_handle, "");
+	localization.setReferencePointCloudRequired(true);
+	if (!localization.loadReferencePointCloud() || !localization.referencePointCloudLoaded()) {
+		ROS_ERROR("Failed to load the reference point cloud (check the parameter [reference_pointclouds/reference_pointcloud_filename])");
+		return 1;
+	}
+
+	std::mt19937 random_number_generator((unsigned int)random_number_generator_seed);
+	std::vector<ScanResult> scan_results;
+	const GroundTruthPose* previous_ground_truth_pose = nullptr;
+	tf2::Transform previous_estimated_pose = localization.getLastAcceptedPoseBaseLinkToMap();
+	std::string base_link_frame_id = localization.getBaseLinkFrameId();
+	std::string map_frame_id = localization.getMapFrameId();
+
+	// The ros clock is driven by the scans timestamps, which makes the time based decisions of the localization pipeline (such as the tracking timeouts) independent of the processing speed
+	auto process_scan = [&](PointCloudT::Ptr& scan, double scan_time, double loading_time, const GroundTruthPose* ground_truth_pose) {
+		ros::Time time(scan_time);
+		ros::Time::setNow(time);
+
+		if (transform_scans_to_base_link)
+			pcl::transformPointCloudWithNormals(*scan, *scan, transform_sensor_to_base_link_eigen);
+		std::vector<int> indexes;
+		scan->is_dense = false;
+		pcl::removeNaNFromPointCloud(*scan, *scan, indexes);
+		scan->header.frame_id = base_link_frame_id;
+		scan->header.stamp = pcl_conversions::toPCL(time);
+
+		tf2::Transform pose_initial_guess = previous_estimated_pose;
+		if (ground_truth_pose) {
+			if (scan_results.empty()) {
+				pose_initial_guess = ground_truth_pose->pose * generateNoiseTransform(random_number_generator, initial_guess_translation_noise_stddev, initial_guess_rotation_noise_stddev, initial_guess_planar_noise);
+				geometry_msgs::Pose initial_pose;
+				laserscan_to_pointcloud::tf_rosmsg_eigen_conversions::transformTF2ToMsg(pose_initial_guess, initial_pose);
+				localization.setInitialPose(initial_pose, map_frame_id, time);
+			} else if (previous_ground_truth_pose) {
+				tf2::Transform odometry_displacement = previous_ground_truth_pose->pose.inverse() * ground_truth_pose->pose;
+				pose_initial_guess = previous_estimated_pose * odometry_displacement * generateNoiseTransform(random_number_generator, initial_guess_translation_noise_stddev, initial_guess_rotation_noise_stddev, initial_guess_planar_noise);
+			}
+		}
+		localization.setLastAcceptedPoseBaseLinkToMap(pose_initial_guess);
+		localization.resetLocalizationTimes();
+
+		ScanResult scan_result;
+		scan_result.time = scan_time;
+		scan_result.number_of_points = scan->size();
+		scan_result.loading_time = loading_time;
+
+		dynamic_robot_localization::PerformanceTimer performance_timer;
+		performance_timer.start();
+		tf2::Transform pose_corrected, pose_corrections;
+		PointCloudT::Ptr scan_keypoints(new PointCloudT());
+		scan_keypoints->header = scan->header;
+		try {
+			scan_result.registration_successful = localization.updateLocalizationWithAmbientPointCloud(scan, time, pose_initial_guess, pose_corrected, pose_corrections, scan_keypoints);
+			scan_result.processing_status = dynamic_robot_localization::Localization<PointT>::s_sensorDataProcessingStatusToStr(localization.getSensorDataProcessingStatus());
+		} catch (const std::exception& e) {
+			ROS_ERROR_STREAM("Exception when processing scan at time " << scan_time << ": " << e.what());
+			scan_result.registration_successful = false;
+			scan_result.processing_status = dynamic_robot_localization::Localization<PointT>::s_sensorDataProcessingStatusToStr(dynamic_robot_localization::Localization<PointT>::ExceptionRaised);
+		}
+		scan_result.processing_time = performance_timer.getElapsedTimeInMilliSec();
+		scan_result.localization_times = localization.getLocalizationTimes();
+		scan_result.estimated_pose = scan_result.registration_successful ? pose_corrected : pose_initial_guess;
+
+		scan_result.ground_truth_available = (ground_truth_pose != nullptr);
+		scan_result.translation_error = 0.0;
+		scan_result.rotation_error = 0.0;
+		if (ground_truth_pose) {
+			tf2::Transform pose_error = ground_truth_pose->pose.inverse() * scan_result.estimated_pose;
+			scan_result.translation_error = pose_error.getOrigin().length();
+			scan_result.rotation_error = pose_error.getRotation().getAngleShortestPath();
+		}
+
+		ROS_DEBUG_STREAM("Processed scan " << scan_results.size() << " with " << scan_result.number_of_points << " points in " << scan_result.processing_time << " ms [" << scan_result.processing_status << "]"
+				<< (ground_truth_pose ? " (translation error: " + std::to_string(scan_result.translation_error) + " m | rotation error: " + std::to_string(scan_result.rotation_error) + " rad)" : ""));
+
+		previous_estimated_pose = scan_result.estimated_pose;
+		previous_ground_truth_pose = ground_truth_pose;
+		scan_results.push_back(scan_result);
+	};
+
+	std::string dataset_source;
+	dynamic_robot_localization::PerformanceTimer replay_timer;
+	replay_timer.start();
+	if (dataset_type == "rosbag") {
+		dataset_source = rosbag_filename;
+		std::vector<std::string> topics;
+		std::istringstream topics_stream(rosbag_pointcloud_topics);
+		std::string topic;
+		while (topics_stream >> topic) topics.push_back(topic);
+
+		try {
+			rosbag::Bag bag(rosbag_filename, rosbag::bagmode::Read);
+			std::unique_ptr<rosbag::View> view(topics.empty() ? new rosbag::View(bag) : new rosbag::View(bag, rosbag::TopicQuery(topics)));
+			dynamic_robot_localization::PerformanceTimer loading_timer;
+			loading_timer.start();
+			for (const rosbag::MessageInstance& message : *view) {
+				if (!ros::ok() || (maximum_number_of_scans >= 0 && scan_results.size() >= (size_t)maximum_number_of_scans)) break;
+				sensor_msgs::PointCloud2ConstPtr pointcloud_msg = message.instantiate<sensor_msgs::PointCloud2>();
+				if (!pointcloud_msg) continue;
+
+				PointCloudT::Ptr scan(new PointCloudT());
+				pcl::fromROSMsg(*pointcloud_msg, *scan);
+				double scan_time = pointcloud_msg->header.stamp.toSec();
+				process_scan(scan, scan_time, loading_timer.getElapsedTimeInMilliSec(), findGroundTruthPose(ground_truth_poses, scan_time, ground_truth_max_time_difference));
+				loading_timer.restart();
+			}
+		} catch (const rosbag::BagException& e) {
+			ROS_ERROR_STREAM("Failed to read rosbag " << rosbag_filename << ": " << e.what());
+			return 1;
+		}
+	} else {
+		dataset_source = pcd_folder;
+		std::vector<std::string> scan_filenames;
+		if (!listPCDFiles(pcd_folder, scan_filenames)) {
+			ROS_ERROR_STREAM("No pcd files found in " << pcd_folder);
+			return 1;
+		}
+
+		bool ground_truth_matches_scans = !ground_truth_poses.empty();
+		if (ground_truth_matches_scans && ground_truth_poses.size() != scan_filenames.size()) {
+			ROS_WARN_STREAM("The number of ground truth poses (" << ground_truth_poses.size() << ") is different from the number of scans (" << scan_filenames.size() << "), ignoring ground truth");
+			ground_truth_matches_scans = false;
+		}
+
+		for (size_t i = 0; i < scan_filenames.size(); ++i) {
+			if (!ros::ok() || (maximum_number_of_scans >= 0 && scan_results.size() >= (size_t)maximum_number_of_scans)) break;
+			dynamic_robot_localization::PerformanceTimer loading_timer;
+			loading_timer.start();
+			PointCloudT::Ptr scan(new PointCloudT());
+			if (!dynamic_robot_localization::pointcloud_conversions::fromFile(*scan, scan_filenames[i])) {
+				ROS_WARN_STREAM("Skipping scan " << scan_filenames[i] << " because it could not be loaded");
+				continue;
+			}
+			double loading_time = loading_timer.getElapsedTimeInMilliSec();
+			const GroundTruthPose* ground_truth_pose = ground_truth_matches_scans ? &ground_truth_poses[i] : nullptr;
+			double scan_time = ground_truth_pose ? ground_truth_pose->time : 10.0 + time_between_scans * (double)i;
+			process_scan(scan, scan_time, loading_time, ground_truth_pose);
+		}
+	}
+	double replay_wall_time = replay_timer.getElapsedTimeInSec();
+
+	if (scan_results.empty()) {
+		ROS_ERROR("No scans were replayed");
+		return 1;
+	}
+
+	ROS_INFO_STREAM("Replayed " << scan_results.size() << " scans in " << replay_wall_time << " seconds");
+	if (!estimated_poses_filename.empty())
+		savePosesCSV(estimated_poses_filename, scan_results);
+
+	return writeReport(report_filename, dataset_type, dataset_source, scan_results, (size_t)std::max(0, number_of_warmup_scans), replay_wall_time) ? 0 : 1;
+}
+// ###################################################################################   </main>   #############################################################################
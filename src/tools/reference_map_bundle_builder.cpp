@@ -0,0 +1,50 @@
+/**\file reference_map_bundle_builder.cpp
+ * \brief Builds the reference map bundle and / or the reference map tiles using the localization configuration loaded in the parameter server (allows to preprocess large maps offline)
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+#include <ros/ros.h>
+#include <dynamic_robot_localization/localization/localization.h>
+#include <dynamic_robot_localization/common/verbosity_levels.h>
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>  <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+// ###################################################################################   <main>   ##############################################################################
+int main(int argc, char** argv) {
+	ros::init(argc, argv, "drl_reference_map_bundle_builder");
+
+	ros::NodeHandlePtr node_handle(new ros::NodeHandle());
+	ros::NodeHandlePtr private_node_handle(new ros::NodeHandle("~"));
+
+	std::string pcl_verbosity_level;
+	private_node_handle->param("pcl_verbosity_level", pcl_verbosity_level, std::string("ERROR"));
+	dynamic_robot_localization::verbosity_levels::setVerbosityLevelPCL(pcl_verbosity_level);
+
+	std::string ros_verbosity_level;
+	private_node_handle->param("ros_verbosity_level", ros_verbosity_level, std::string("INFO"));
+	dynamic_robot_localization::verbosity_levels::setVerbosityLevelROS(ros_verbosity_level);
+
+	dynamic_robot_localization::Localization<pcl::PointXYZRGBNormal> localization;
+	localization.setupConfigurationFromParameterServer(node_handle, private_node_handle, "");
+
+	if (localization.getReferencePointCloudBundleFilename().empty() && localization.getTiledMapTileSize() <= 0.0) {
+		ROS_ERROR("The parameter [reference_pointclouds/reference_pointcloud_bundle/filename] or [reference_pointclouds/tiled_map/tile_size] must be specified");
+		return 1;
+	}
+
+	localization.setReferencePointCloudRequired(true);
+	localization.setReferencePointCloudBundleSave(true);
+	localization.setReferencePointCloudTilesBuild(true);
+	if (!localization.loadReferencePointCloud() || !localization.referencePointCloudLoaded()) {
+		ROS_ERROR_STREAM("Failed to build the reference map bundle " << localization.getReferencePointCloudBundleFilename() << " / tiles");
+		return 1;
+	}
+
+	return 0;
+}
+// ###################################################################################   </main>   #############################################################################
@@ -0,0 +1,152 @@
+/**\file correspondences_lookup_table_grid_test.cpp
+ * \brief Checks that the incremental updates of the correspondences lookup table give the same correspondences as rebuilding it.
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// std includes
+#include <random>
+#include <vector>
+
+// PCL includes
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+#include <pcl/search/kdtree.h>
+
+// external libs includes
+#include <gtest/gtest.h>
+
+// project includes
+#include <dynamic_robot_localization/cloud_matchers/correspondences_lookup_table_grid.h>
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+using namespace dynamic_robot_localization;
+typedef pcl::PointXYZRGBNormal PointT;
+
+
+void addRandomPoints(size_t number_of_points, unsigned int seed, pcl::PointCloud<PointT>& pointcloud) {
+	std::mt19937 random_generator(seed);
+	std::uniform_real_distribution<float> position_distribution(0.0f, 1.0f);
+	for (size_t i = 0; i < number_of_points; ++i) {
+		PointT point;
+		point.getVector3fMap() = Eigen::Vector3f(position_distribution(random_generator), position_distribution(random_generator), position_distribution(random_generator));
+		pointcloud.push_back(point);
+	}
+}
+
+
+void setupGrid(CorrespondencesLookupTableGrid<PointT>& grid) {
+	grid.setFullRebuildRatio(1e6); // forces the incremental path of update
+	grid.setComputeDistanceFromQueryPointToClosestPoint(true);
+}
+
+
+/*! Compares the correspondences of the two grids for the query points in a lattice that covers the point clouds and their influence radius. */
+void expectSameCorrespondences(const CorrespondencesLookupTableGrid<PointT>& grid, const CorrespondencesLookupTableGrid<PointT>& rebuilt_grid, const pcl::PointCloud<PointT>& pointcloud) {
+	for (float x = -0.2f; x <= 1.2f; x += 0.033f) {
+		for (float y = -0.2f; y <= 1.2f; y += 0.033f) {
+			for (float z = -0.2f; z <= 1.2f; z += 0.033f) {
+				int index = -1, rebuilt_index = -1;
+				float squared_distance = 0.0f, rebuilt_squared_distance = 0.0f;
+				bool found = grid.getCorrespondence(x, y, z, index, squared_distance);
+				bool rebuilt_found = rebuilt_grid.getCorrespondence(x, y, z, rebuilt_index, rebuilt_squared_distance);
+				ASSERT_EQ(rebuilt_found, found) << "query " << x << " " << y << " " << z;
+				if (!found) { continue; }
+				ASSERT_GE(index, 0);
+				ASSERT_LT((size_t)index, pointcloud.size());
+				EXPECT_FLOAT_EQ(rebuilt_squared_distance, squared_distance) << "query " << x << " " << y << " " << z; // the indices may differ in ties
+			}
+		}
+	}
+}
+
+
+TEST(CorrespondencesLookupTableGrid, InsertPointsMatchesRebuild) {
+	pcl::PointCloud<PointT>::Ptr pointcloud(new pcl::PointCloud<PointT>());
+	addRandomPoints(400, 1, *pointcloud);
+	pcl::search::KdTree<PointT>::Ptr search_method(new pcl::search::KdTree<PointT>());
+	search_method->setInputCloud(pointcloud);
+	CorrespondencesLookupTableGrid<PointT> grid(0.05f, 0.2f);
+	setupGrid(grid);
+	ASSERT_TRUE(grid.update(pointcloud, search_method));
+
+	size_t number_of_points_before_insertion = pointcloud->size();
+	addRandomPoints(100, 2, *pointcloud);
+	std::vector<int> inserted_points_indices;
+	for (size_t i = number_of_points_before_insertion; i < pointcloud->size(); ++i) {
+		inserted_points_indices.push_back((int)i);
+	}
+	search_method->setInputCloud(pointcloud);
+	ASSERT_TRUE(grid.insertPoints(pointcloud, inserted_points_indices));
+	EXPECT_EQ(pointcloud->size(), grid.getNumberOfPoints());
+
+	pcl::PointCloud<PointT>::Ptr rebuilt_pointcloud(new pcl::PointCloud<PointT>(*pointcloud));
+	pcl::search::KdTree<PointT>::Ptr rebuilt_search_method(new pcl::search::KdTree<PointT>());
+	rebuilt_search_method->setInputCloud(rebuilt_pointcloud);
+	CorrespondencesLookupTableGrid<PointT> rebuilt_grid(0.05f, 0.2f);
+	setupGrid(rebuilt_grid);
+	ASSERT_TRUE(rebuilt_grid.update(rebuilt_pointcloud, rebuilt_search_method));
+	expectSameCorrespondences(grid, rebuilt_grid, *pointcloud);
+}
+
+
+TEST(CorrespondencesLookupTableGrid, RemovePointsMatchesRebuild) {
+	pcl::PointCloud<PointT>::Ptr pointcloud(new pcl::PointCloud<PointT>());
+	addRandomPoints(500, 3, *pointcloud);
+	pcl::search::KdTree<PointT>::Ptr search_method(new pcl::search::KdTree<PointT>());
+	search_method->setInputCloud(pointcloud);
+	CorrespondencesLookupTableGrid<PointT> grid(0.05f, 0.2f);
+	setupGrid(grid);
+	ASSERT_TRUE(grid.update(pointcloud, search_method));
+
+	// removing the last points keeps the indices of the remaining points
+	pcl::PointCloud<PointT> removed_points;
+	removed_points.insert(removed_points.end(), pointcloud->begin() + 400, pointcloud->end());
+	pointcloud->resize(400);
+	search_method->setInputCloud(pointcloud);
+	ASSERT_TRUE(grid.removePoints(pointcloud, removed_points, search_method));
+	EXPECT_EQ(pointcloud->size(), grid.getNumberOfPoints());
+
+	pcl::PointCloud<PointT>::Ptr rebuilt_pointcloud(new pcl::PointCloud<PointT>(*pointcloud));
+	pcl::search::KdTree<PointT>::Ptr rebuilt_search_method(new pcl::search::KdTree<PointT>());
+	rebuilt_search_method->setInputCloud(rebuilt_pointcloud);
+	CorrespondencesLookupTableGrid<PointT> rebuilt_grid(0.05f, 0.2f);
+	setupGrid(rebuilt_grid);
+	ASSERT_TRUE(rebuilt_grid.update(rebuilt_pointcloud, rebuilt_search_method));
+	expectSameCorrespondences(grid, rebuilt_grid, *pointcloud);
+}
+
+
+TEST(CorrespondencesLookupTableGrid, UpdateWithChangedPointsMatchesRebuild) {
+	pcl::PointCloud<PointT>::Ptr pointcloud(new pcl::PointCloud<PointT>());
+	addRandomPoints(500, 4, *pointcloud);
+	pcl::search::KdTree<PointT>::Ptr search_method(new pcl::search::KdTree<PointT>());
+	search_method->setInputCloud(pointcloud);
+	CorrespondencesLookupTableGrid<PointT> grid(0.05f, 0.2f);
+	setupGrid(grid);
+	ASSERT_TRUE(grid.update(pointcloud, search_method));
+
+	// new point cloud with some of the previous points removed and new points inserted (matched by position by update)
+	pcl::PointCloud<PointT>::Ptr changed_pointcloud(new pcl::PointCloud<PointT>());
+	changed_pointcloud->insert(changed_pointcloud->end(), pointcloud->begin() + 50, pointcloud->end());
+	addRandomPoints(50, 5, *changed_pointcloud);
+	search_method->setInputCloud(changed_pointcloud);
+	ASSERT_TRUE(grid.update(changed_pointcloud, search_method));
+	EXPECT_FALSE(grid.getLastUpdateWasFullRebuild());
+
+	pcl::PointCloud<PointT>::Ptr rebuilt_pointcloud(new pcl::PointCloud<PointT>(*changed_pointcloud));
+	pcl::search::KdTree<PointT>::Ptr rebuilt_search_method(new pcl::search::KdTree<PointT>());
+	rebuilt_search_method->setInputCloud(rebuilt_pointcloud);
+	CorrespondencesLookupTableGrid<PointT> rebuilt_grid(0.05f, 0.2f);
+	setupGrid(rebuilt_grid);
+	ASSERT_TRUE(rebuilt_grid.update(rebuilt_pointcloud, rebuilt_search_method));
+	expectSameCorrespondences(grid, rebuilt_grid, *changed_pointcloud);
+}
+
+
+int main(int argc, char** argv) {
+	testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
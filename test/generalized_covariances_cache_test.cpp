@@ -0,0 +1,133 @@
+/**\file generalized_covariances_cache_test.cpp
+ * \brief Checks that the cached and incrementally updated reference covariances are the same as the recomputed ones.
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// std includes
+#include <random>
+#include <vector>
+
+// PCL includes
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+#include <pcl/search/kdtree.h>
+
+// external libs includes
+#include <gtest/gtest.h>
+
+// project includes
+#include <dynamic_robot_localization/cloud_matchers/generalized_covariances_cache.h>
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+using namespace dynamic_robot_localization;
+typedef pcl::PointXYZRGBNormal PointT;
+
+
+/*! Adds random points inside the box [0, 2] x [0, 2] x [0, 0.5], starting at minimum_x. */
+void addRandomPoints(size_t number_of_points, unsigned int seed, float minimum_x, pcl::PointCloud<PointT>& pointcloud) {
+	std::mt19937 random_generator(seed);
+	std::uniform_real_distribution<float> x_distribution(minimum_x, 2.0f);
+	std::uniform_real_distribution<float> y_distribution(0.0f, 2.0f);
+	std::uniform_real_distribution<float> z_distribution(0.0f, 0.5f);
+	for (size_t i = 0; i < number_of_points; ++i) {
+		PointT point;
+		point.getVector3fMap() = Eigen::Vector3f(x_distribution(random_generator), y_distribution(random_generator), z_distribution(random_generator));
+		pointcloud.push_back(point);
+	}
+}
+
+
+void addRandomPoints(size_t number_of_points, unsigned int seed, pcl::PointCloud<PointT>& pointcloud) {
+	addRandomPoints(number_of_points, seed, 0.0f, pointcloud);
+}
+
+
+void setupCache(GeneralizedCovariancesCache<PointT>& cache) {
+	cache.setInvalidationVoxelSize(0.4); // larger than the distance to the farthest of the 20 closest points in the test point clouds (even in their corners)
+	cache.setFullRecomputationRatio(1e6); // forces the incremental path of updateReferenceCovariances
+	cache.setNumberOfThreads(1);
+}
+
+
+/*! Compares the covariances with the ones computed by a new cache for the same points. */
+void expectSameAsRecomputedCovariances(const GeneralizedCovariancesCache<PointT>::MatricesVectorPtr& covariances, const pcl::PointCloud<PointT>& pointcloud) {
+	pcl::PointCloud<PointT>::Ptr recomputed_pointcloud(new pcl::PointCloud<PointT>(pointcloud));
+	pcl::search::KdTree<PointT>::Ptr recomputed_search_method(new pcl::search::KdTree<PointT>());
+	recomputed_search_method->setInputCloud(recomputed_pointcloud);
+	GeneralizedCovariancesCache<PointT> recomputed_cache;
+	setupCache(recomputed_cache);
+	GeneralizedCovariancesCache<PointT>::MatricesVectorPtr recomputed_covariances = recomputed_cache.updateReferenceCovariances(recomputed_pointcloud, recomputed_search_method);
+
+	ASSERT_TRUE(covariances);
+	ASSERT_TRUE(recomputed_covariances);
+	ASSERT_EQ(recomputed_covariances->size(), covariances->size());
+	for (size_t i = 0; i < covariances->size(); ++i) {
+		EXPECT_TRUE((*covariances)[i].isApprox((*recomputed_covariances)[i], 1e-6)) << "point " << i << "\n" << (*covariances)[i] << "\n" << (*recomputed_covariances)[i];
+	}
+}
+
+
+TEST(GeneralizedCovariancesCache, CachedCovariancesMatchRecomputation) {
+	pcl::PointCloud<PointT>::Ptr pointcloud(new pcl::PointCloud<PointT>());
+	addRandomPoints(2000, 1, *pointcloud);
+	pcl::search::KdTree<PointT>::Ptr search_method(new pcl::search::KdTree<PointT>());
+	search_method->setInputCloud(pointcloud);
+	GeneralizedCovariancesCache<PointT> cache;
+	setupCache(cache);
+	GeneralizedCovariancesCache<PointT>::MatricesVectorPtr covariances = cache.updateReferenceCovariances(pointcloud, search_method);
+	EXPECT_EQ(covariances, cache.updateReferenceCovariances(pointcloud, search_method)); // shared cache that was already updated with the same point cloud
+	expectSameAsRecomputedCovariances(covariances, *pointcloud);
+}
+
+
+TEST(GeneralizedCovariancesCache, UpdatedCovariancesMatchRecomputation) {
+	pcl::PointCloud<PointT>::Ptr pointcloud(new pcl::PointCloud<PointT>());
+	addRandomPoints(2000, 2, *pointcloud);
+	pcl::search::KdTree<PointT>::Ptr search_method(new pcl::search::KdTree<PointT>());
+	search_method->setInputCloud(pointcloud);
+	GeneralizedCovariancesCache<PointT> cache;
+	setupCache(cache);
+	ASSERT_TRUE(cache.updateReferenceCovariances(pointcloud, search_method));
+
+	// new point cloud with the previous points near x = 2 removed and new points inserted there (matched by position by updateReferenceCovariances)
+	pcl::PointCloud<PointT>::Ptr changed_pointcloud(new pcl::PointCloud<PointT>());
+	for (size_t i = 0; i < pointcloud->size(); ++i) {
+		if ((*pointcloud)[i].x < 1.8f || i % 2 == 0) { changed_pointcloud->push_back((*pointcloud)[i]); }
+	}
+	addRandomPoints(50, 3, 1.8f, *changed_pointcloud);
+	search_method->setInputCloud(changed_pointcloud);
+	GeneralizedCovariancesCache<PointT>::MatricesVectorPtr covariances = cache.updateReferenceCovariances(changed_pointcloud, search_method);
+	EXPECT_LT(cache.getNumberOfRecomputedCovariancesInLastUpdate(), changed_pointcloud->size());
+	expectSameAsRecomputedCovariances(covariances, *changed_pointcloud);
+}
+
+
+TEST(GeneralizedCovariancesCache, InsertedPointsCovariancesMatchRecomputation) {
+	pcl::PointCloud<PointT>::Ptr pointcloud(new pcl::PointCloud<PointT>());
+	addRandomPoints(2000, 4, *pointcloud);
+	pcl::search::KdTree<PointT>::Ptr search_method(new pcl::search::KdTree<PointT>());
+	search_method->setInputCloud(pointcloud);
+	GeneralizedCovariancesCache<PointT> cache;
+	setupCache(cache);
+	ASSERT_TRUE(cache.updateReferenceCovariances(pointcloud, search_method));
+
+	size_t number_of_points_before_insertion = pointcloud->size();
+	addRandomPoints(20, 5, 1.8f, *pointcloud);
+	std::vector<int> inserted_points_indices;
+	for (size_t i = number_of_points_before_insertion; i < pointcloud->size(); ++i) {
+		inserted_points_indices.push_back((int)i);
+	}
+	search_method->setInputCloud(pointcloud);
+	GeneralizedCovariancesCache<PointT>::MatricesVectorPtr covariances = cache.insertReferencePoints(pointcloud, inserted_points_indices, search_method);
+	expectSameAsRecomputedCovariances(covariances, *pointcloud);
+	EXPECT_EQ(covariances, cache.updateReferenceCovariances(pointcloud, search_method)); // the insertion leaves the cache in sync with the point cloud
+}
+
+
+int main(int argc, char** argv) {
+	testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,150 @@
+/**\file normal_distributions_transform_voxel_map_test.cpp
+ * \brief Checks that the incrementally updated voxels of the normal distributions transform voxel map are the same as the rebuilt ones.
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// std includes
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+// PCL includes
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+
+// external libs includes
+#include <gtest/gtest.h>
+
+// project includes
+#include <dynamic_robot_localization/cloud_matchers/normal_distributions_transform_voxel_map.h>
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+using namespace dynamic_robot_localization;
+typedef pcl::PointXYZRGBNormal PointT;
+typedef NormalDistributionsTransformVoxelMap<PointT> VoxelMap;
+
+
+void addRandomPoints(size_t number_of_points, unsigned int seed, pcl::PointCloud<PointT>& pointcloud) {
+	std::mt19937 random_generator(seed);
+	std::uniform_real_distribution<float> position_distribution(0.0f, 1.0f);
+	for (size_t i = 0; i < number_of_points; ++i) {
+		PointT point;
+		point.getVector3fMap() = Eigen::Vector3f(position_distribution(random_generator), position_distribution(random_generator), position_distribution(random_generator));
+		pointcloud.push_back(point);
+	}
+}
+
+
+/*! Adds one planar and one volumetric layer (the layer indices are the same in all the voxel maps of the tests). */
+void setupVoxelMap(VoxelMap& voxel_map) {
+	voxel_map.setFullRecomputationRatio(1e6); // forces the incremental path of update
+	VoxelMap::LayerConfiguration planar_layer_configuration;
+	planar_layer_configuration.type = VoxelMap::PlanarLayer;
+	planar_layer_configuration.voxel_size = Eigen::Vector3d(0.2, 0.2, 0.2);
+	planar_layer_configuration.origin = Eigen::Vector3d::Zero();
+	voxel_map.addLayer(planar_layer_configuration);
+
+	VoxelMap::LayerConfiguration volumetric_layer_configuration;
+	volumetric_layer_configuration.type = VoxelMap::VolumetricLayer;
+	volumetric_layer_configuration.voxel_size = Eigen::Vector3d(0.25, 0.25, 0.25);
+	volumetric_layer_configuration.origin = Eigen::Vector3d::Zero();
+	voxel_map.addLayer(volumetric_layer_configuration);
+}
+
+
+/*! Compares the voxels of the voxel map with the voxels of a new voxel map built with the same points. */
+void expectSameAsRebuiltVoxels(const VoxelMap& voxel_map, const pcl::PointCloud<PointT>& pointcloud) {
+	pcl::PointCloud<PointT>::Ptr rebuilt_pointcloud(new pcl::PointCloud<PointT>(pointcloud));
+	VoxelMap rebuilt_voxel_map;
+	setupVoxelMap(rebuilt_voxel_map);
+	ASSERT_TRUE(rebuilt_voxel_map.update(rebuilt_pointcloud));
+
+	ASSERT_EQ(rebuilt_voxel_map.getNumberOfLayers(), voxel_map.getNumberOfLayers());
+	for (size_t layer_index = 0; layer_index < voxel_map.getNumberOfLayers(); ++layer_index) {
+		const VoxelMap::Layer& layer = voxel_map.getLayer(layer_index);
+		const VoxelMap::Layer& rebuilt_layer = rebuilt_voxel_map.getLayer(layer_index);
+
+		size_t number_of_voxels_with_points = 0;
+		for (std::unordered_map<VoxelMap::VoxelKey, VoxelMap::Voxel>::const_iterator voxel_it = layer.voxels.begin(); voxel_it != layer.voxels.end(); ++voxel_it) {
+			if (voxel_it->second.number_of_points == 0) { continue; } // voxels emptied by removals may be kept
+			++number_of_voxels_with_points;
+			std::unordered_map<VoxelMap::VoxelKey, VoxelMap::Voxel>::const_iterator rebuilt_voxel_it = rebuilt_layer.voxels.find(voxel_it->first);
+			ASSERT_TRUE(rebuilt_voxel_it != rebuilt_layer.voxels.end()) << "layer " << layer_index;
+
+			const VoxelMap::Voxel& voxel = voxel_it->second;
+			const VoxelMap::Voxel& rebuilt_voxel = rebuilt_voxel_it->second;
+			EXPECT_EQ(rebuilt_voxel.number_of_points, voxel.number_of_points);
+			EXPECT_EQ(rebuilt_voxel.valid, voxel.valid);
+			EXPECT_TRUE(voxel.sum_of_points.isApprox(rebuilt_voxel.sum_of_points, 1e-9));
+			if (voxel.valid && rebuilt_voxel.valid) {
+				EXPECT_TRUE(voxel.mean.isApprox(rebuilt_voxel.mean, 1e-9)) << "layer " << layer_index << "\n" << voxel.mean << "\n" << rebuilt_voxel.mean;
+				EXPECT_TRUE(voxel.covariance.isApprox(rebuilt_voxel.covariance, 1e-6)) << "layer " << layer_index << "\n" << voxel.covariance << "\n" << rebuilt_voxel.covariance;
+			}
+		}
+
+		size_t number_of_rebuilt_voxels_with_points = 0;
+		for (std::unordered_map<VoxelMap::VoxelKey, VoxelMap::Voxel>::const_iterator voxel_it = rebuilt_layer.voxels.begin(); voxel_it != rebuilt_layer.voxels.end(); ++voxel_it) {
+			if (voxel_it->second.number_of_points > 0) { ++number_of_rebuilt_voxels_with_points; }
+		}
+		EXPECT_EQ(number_of_rebuilt_voxels_with_points, number_of_voxels_with_points) << "layer " << layer_index;
+	}
+}
+
+
+TEST(NormalDistributionsTransformVoxelMap, InsertPointsMatchesRebuild) {
+	pcl::PointCloud<PointT>::Ptr pointcloud(new pcl::PointCloud<PointT>());
+	addRandomPoints(1000, 1, *pointcloud);
+	VoxelMap voxel_map;
+	setupVoxelMap(voxel_map);
+	ASSERT_TRUE(voxel_map.update(pointcloud));
+
+	size_t number_of_points_before_insertion = pointcloud->size();
+	addRandomPoints(200, 2, *pointcloud);
+	std::vector<int> inserted_points_indices;
+	for (size_t i = number_of_points_before_insertion; i < pointcloud->size(); ++i) {
+		inserted_points_indices.push_back((int)i);
+	}
+	ASSERT_TRUE(voxel_map.insertPoints(pointcloud, inserted_points_indices));
+	EXPECT_FALSE(voxel_map.update(pointcloud)); // the insertion leaves the voxel map in sync with the point cloud
+	expectSameAsRebuiltVoxels(voxel_map, *pointcloud);
+}
+
+
+TEST(NormalDistributionsTransformVoxelMap, RemovePointsMatchesRebuild) {
+	pcl::PointCloud<PointT>::Ptr pointcloud(new pcl::PointCloud<PointT>());
+	addRandomPoints(1200, 3, *pointcloud);
+	VoxelMap voxel_map;
+	setupVoxelMap(voxel_map);
+	ASSERT_TRUE(voxel_map.update(pointcloud));
+
+	pcl::PointCloud<PointT> removed_points;
+	removed_points.insert(removed_points.end(), pointcloud->begin() + 1000, pointcloud->end());
+	pointcloud->resize(1000);
+	ASSERT_TRUE(voxel_map.removePoints(pointcloud, removed_points));
+	expectSameAsRebuiltVoxels(voxel_map, *pointcloud);
+}
+
+
+TEST(NormalDistributionsTransformVoxelMap, UpdateWithChangedPointsMatchesRebuild) {
+	pcl::PointCloud<PointT>::Ptr pointcloud(new pcl::PointCloud<PointT>());
+	addRandomPoints(1000, 4, *pointcloud);
+	VoxelMap voxel_map;
+	setupVoxelMap(voxel_map);
+	ASSERT_TRUE(voxel_map.update(pointcloud));
+
+	// new point cloud with some of the previous points removed and new points inserted (matched by position by update)
+	pcl::PointCloud<PointT>::Ptr changed_pointcloud(new pcl::PointCloud<PointT>());
+	changed_pointcloud->insert(changed_pointcloud->end(), pointcloud->begin() + 100, pointcloud->end());
+	addRandomPoints(100, 5, *changed_pointcloud);
+	ASSERT_TRUE(voxel_map.update(changed_pointcloud));
+	expectSameAsRebuiltVoxels(voxel_map, *changed_pointcloud);
+}
+
+
+int main(int argc, char** argv) {
+	testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,95 @@
+/**\file registration_covariance_estimators_test.cpp
+ * \brief Checks that the streaming block accumulation gives the same registration covariance as the dense jacobian formulation.
+ *
+ * @version 1.0
+ * @author Carlos Miguel Correia da Costa
+ */
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   <includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+// std includes
+#include <cmath>
+#include <random>
+
+// PCL includes
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+
+// external libs includes
+#include <gtest/gtest.h>
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+
+// project includes
+#include <dynamic_robot_localization/registration_covariance_estimators/registration_covariance_point_to_point_3d.h>
+#include <dynamic_robot_localization/registration_covariance_estimators/registration_covariance_point_to_plane_3d.h>
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>   </includes>   <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+using namespace dynamic_robot_localization;
+typedef pcl::PointXYZRGBNormal PointT;
+
+
+/*! Small set of correspondences with normals, in which the ambient points are the reference points displaced by registration_corrections^-1 and by noise. */
+void createCorrespondences(size_t number_of_correspondences, pcl::PointCloud<PointT>& reference_correspondences, pcl::PointCloud<PointT>& ambient_correspondences, Eigen::Matrix4f& registration_corrections) {
+	std::mt19937 random_generator(42);
+	std::uniform_real_distribution<float> position_distribution(-2.0f, 2.0f);
+	std::normal_distribution<float> noise_distribution(0.0f, 0.005f);
+
+	Eigen::Affine3f corrections = Eigen::Translation3f(0.05f, -0.03f, 0.02f) * Eigen::AngleAxisf(0.03f, Eigen::Vector3f(0.2f, 0.3f, 1.0f).normalized());
+	registration_corrections = corrections.matrix();
+	Eigen::Affine3f corrections_inverse = corrections.inverse();
+
+	reference_correspondences.clear();
+	ambient_correspondences.clear();
+	for (size_t i = 0; i < number_of_correspondences; ++i) {
+		PointT reference_point;
+		reference_point.getVector3fMap() = Eigen::Vector3f(position_distribution(random_generator), position_distribution(random_generator), position_distribution(random_generator));
+		reference_point.getNormalVector3fMap() = Eigen::Vector3f(position_distribution(random_generator), position_distribution(random_generator), position_distribution(random_generator) + 3.0f).normalized();
+
+		PointT ambient_point = reference_point;
+		ambient_point.getVector3fMap() = corrections_inverse * reference_point.getVector3fMap() + Eigen::Vector3f(noise_distribution(random_generator), noise_distribution(random_generator), noise_distribution(random_generator));
+		ambient_point.getNormalVector3fMap() = corrections_inverse.linear() * reference_point.getNormalVector3fMap();
+
+		reference_correspondences.push_back(reference_point);
+		ambient_correspondences.push_back(ambient_point);
+	}
+}
+
+
+void expectSameCovariances(RegistrationCovarianceEstimator<PointT>& estimator) {
+	pcl::PointCloud<PointT> reference_correspondences, ambient_correspondences;
+	Eigen::Matrix4f registration_corrections;
+	createCorrespondences(50, reference_correspondences, ambient_correspondences, registration_corrections);
+
+	Eigen::MatrixXd dense_covariance, streaming_covariance;
+	estimator.setCovarianceFormulation(RegistrationCovarianceEstimator<PointT>::DenseJacobian);
+	ASSERT_TRUE(estimator.computeRegistrationCovariance(reference_correspondences, ambient_correspondences, registration_corrections, dense_covariance, 0.01));
+	estimator.setCovarianceFormulation(RegistrationCovarianceEstimator<PointT>::StreamingBlockAccumulation);
+	ASSERT_TRUE(estimator.computeRegistrationCovariance(reference_correspondences, ambient_correspondences, registration_corrections, streaming_covariance, 0.01));
+
+	ASSERT_EQ(dense_covariance.rows(), streaming_covariance.rows());
+	ASSERT_EQ(dense_covariance.cols(), streaming_covariance.cols());
+	double tolerance = 1e-6 * dense_covariance.cwiseAbs().maxCoeff(); // the covariances scale with sensor_std_dev_noise^2
+	for (Eigen::Index row = 0; row < dense_covariance.rows(); ++row) {
+		for (Eigen::Index col = 0; col < dense_covariance.cols(); ++col) {
+			EXPECT_NEAR(dense_covariance(row, col), streaming_covariance(row, col), tolerance) << "row " << row << " col " << col;
+		}
+	}
+}
+
+
+TEST(RegistrationCovarianceEstimators, PointToPointStreamingMatchesDense) {
+	RegistrationCovariancePointToPoint3D<PointT> estimator;
+	expectSameCovariances(estimator);
+}
+
+
+TEST(RegistrationCovarianceEstimators, PointToPlaneStreamingMatchesDense) {
+	RegistrationCovariancePointToPlane3D<PointT> estimator;
+	expectSameCovariances(estimator);
+}
+
+
+int main(int argc, char** argv) {
+	testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}